@@ -0,0 +1,115 @@
+// Mip downsample throughput: each kernel on whole 64KB tiles, then a full
+// MipChainBuilder pass over a 16x16x16-tile mip 0. --quick runs a few tiles
+// of each as a smoke test.
+#include "pch.h"
+#include "MipChainBuilder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t TILE_SIZE = 65536;
+
+struct KernelCase {
+	const char* name;
+	DXGI_FORMAT format;
+	uint32_t bytesPerPixel;
+	MipFilter filter;
+	MipTileShape shape;
+};
+
+double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	const bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+	const uint32_t kernelTiles = quick ? 16 : 4096;
+
+	std::vector<std::byte> child(TILE_SIZE);
+	uint32_t state = 1;
+	for (std::byte& b : child) {
+		state = state * 1664525u + 1013904223u;
+		// Keep packed floats finite: clear the top exponent bit of every texel
+		b = static_cast<std::byte>(state >> 24);
+	}
+	for (size_t i = 3; i < child.size(); i += 4) {
+		child[i] &= std::byte{ 0x3F };
+	}
+	std::vector<std::byte> parent(TILE_SIZE);
+
+	const KernelCase cases[] = {
+		{ "R8G8B8A8_UNORM",     DXGI_FORMAT_R8G8B8A8_UNORM,     4,  MipFilter::Average,  { 32, 32, 16 } },
+		{ "R16G16B16A16_FLOAT", DXGI_FORMAT_R16G16B16A16_FLOAT, 8,  MipFilter::Average,  { 32, 16, 16 } },
+		{ "R32_FLOAT",          DXGI_FORMAT_R32_FLOAT,          4,  MipFilter::Average,  { 32, 32, 16 } },
+		{ "R11G11B10_FLOAT",    DXGI_FORMAT_R11G11B10_FLOAT,    4,  MipFilter::Average,  { 32, 32, 16 } },
+		{ "R9G9B9E5_SHAREDEXP", DXGI_FORMAT_R9G9B9E5_SHAREDEXP, 4,  MipFilter::Average,  { 32, 32, 16 } },
+		{ "R32_UINT majority",  DXGI_FORMAT_R32_UINT,           4,  MipFilter::Majority, { 32, 32, 16 } },
+	};
+
+	int failures = 0;
+	std::printf("%-20s %12s %10s\n", "kernel", "tiles/s", "MB/s");
+	for (const KernelCase& c : cases) {
+		MipDownsampleKernel kernel = GetMipDownsampleKernel(c.format, c.bytesPerPixel, c.filter);
+		if (!kernel) {
+			std::fprintf(stderr, "%s: no kernel\n", c.name);
+			++failures;
+			continue;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < kernelTiles; ++i) {
+			kernel(child.data(), parent.data(), c.shape, i & 1, (i >> 1) & 1, (i >> 2) & 1);
+		}
+		const double seconds = SecondsSince(start);
+		std::printf("%-20s %12.0f %10.1f\n", c.name,
+			kernelTiles / seconds, kernelTiles * (TILE_SIZE / 1048576.0) / seconds);
+	}
+
+	// Whole chain, children in linear order so parents complete as they go
+	const uint32_t edge = quick ? 4 : 16;
+	ResourceTilingInfo tilingInfo = {};
+	tilingInfo.TileWidthInTexels = 32;
+	tilingInfo.TileHeightInTexels = 32;
+	tilingInfo.TileDepthInTexels = 16;
+	for (uint32_t e = edge, tile = 0; e >= 1; e /= 2) {
+		tilingInfo.subresourceTilingInfo.push_back({ e, e, e, tile });
+		tile += e * e * e;
+	}
+	tilingInfo.SubresourceCount = static_cast<unsigned int>(tilingInfo.subresourceTilingInfo.size());
+	tilingInfo.NumStandardMips = tilingInfo.SubresourceCount;
+
+	MipChainBuilder builder(tilingInfo,
+		GetMipDownsampleKernel(DXGI_FORMAT_R8G8B8A8_UNORM, 4, MipFilter::Average), TILE_SIZE);
+	std::vector<GeneratedMipTile> ready;
+	size_t generated = 0;
+	size_t maxPending = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t z = 0; z < edge; ++z)
+		for (uint32_t y = 0; y < edge; ++y)
+			for (uint32_t x = 0; x < edge; ++x) {
+				ready.clear();
+				builder.AddTile(0, x, y, z, child.data(), ready);
+				generated += ready.size();
+				maxPending = (std::max)(maxPending, builder.GetPendingParentCount());
+			}
+	const double seconds = SecondsSince(start);
+
+	size_t expected = 0;
+	for (uint32_t level = 1; level < tilingInfo.NumStandardMips; ++level) {
+		const SubresourceTilingInfo& info = tilingInfo.subresourceTilingInfo[level];
+		expected += size_t(info.WidthInTiles) * info.HeightInTiles * info.DepthInTiles;
+	}
+	failures += generated != expected || builder.GetPendingParentCount() != 0;
+
+	std::printf("\nchain %u^3 tiles: %zu generated in %.3f s (%.0f input tiles/s), max %zu pending\n",
+		edge, generated, seconds, edge * edge * edge / seconds, maxPending);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,330 @@
+// Residency solver: per-frame cost of working out the tiles a moving camera
+// wants, against a full rescan of the sphere's bounding box each frame (the
+// way the C# side did it), along recorded-style camera traces. Work lists
+// are applied to a simulated mapping, and every frame checks that the
+// mapping then matches the desired set and that solving again finds nothing
+// to do. Then one trace runs through the plugin on the software backend,
+// uploading and unmapping for real.
+// --quick runs a few frames of each trace as a smoke test.
+#include "pch.h"
+#include "RenderingPlugin.h"
+#include "ResidencySolver.h"
+#include "SoftwareBackend.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// R8_UNORM tiles are 64x32x32 texels, so mip 0 is 32x64x64 tiles. World
+// units are mip 0 texels.
+constexpr UINT VOLUME_SIZE = 2048;
+constexpr UINT MIP_COUNT = 4;
+const std::vector<float> MIP_RADII = { 192.0f, 384.0f, 768.0f };
+
+enum class Trace { Flythrough, Orbit, Hover };
+
+const char* TraceName(Trace trace)
+{
+	switch (trace)
+	{
+	case Trace::Flythrough: return "flythrough";
+	case Trace::Orbit:      return "orbit";
+	default:                return "hover";
+	}
+}
+
+// t runs from 0 to 1 over the trace
+void SampleTrace(Trace trace, float t, float outPosition[3])
+{
+	const float center = VOLUME_SIZE * 0.5f;
+	switch (trace)
+	{
+	case Trace::Flythrough:
+		outPosition[0] = 100.0f + t * (VOLUME_SIZE - 200.0f);
+		outPosition[1] = center + 200.0f * std::sin(t * 6.0f);
+		outPosition[2] = center;
+		break;
+	case Trace::Orbit:
+		outPosition[0] = center + 600.0f * std::cos(t * 6.2831853f);
+		outPosition[1] = center;
+		outPosition[2] = center + 600.0f * std::sin(t * 6.2831853f);
+		break;
+	case Trace::Hover:
+		outPosition[0] = center + 6.0f * std::sin(t * 97.0f);
+		outPosition[1] = center + 6.0f * std::cos(t * 61.0f);
+		outPosition[2] = center + 3.0f * std::sin(t * 37.0f);
+		break;
+	}
+}
+
+// What is mapped, one byte per tile per mip
+class MappedTiles {
+public:
+	explicit MappedTiles(const ResourceTilingInfo& tilingInfo)
+	{
+		for (UINT m = 0; m < MIP_COUNT; ++m) {
+			const SubresourceTilingInfo& sub = tilingInfo.subresourceTilingInfo[m];
+			m_counts.push_back({ sub.WidthInTiles, sub.HeightInTiles, sub.DepthInTiles });
+			m_tiles.emplace_back(size_t(sub.WidthInTiles) * sub.HeightInTiles * sub.DepthInTiles, uint8_t(0));
+		}
+	}
+
+	bool IsMapped(uint32_t sub, uint32_t x, uint32_t y, uint32_t z) const { return m_tiles[sub][Index(sub, x, y, z)] != 0; }
+	void Set(const SolverTile& tile, bool mapped) { m_tiles[tile.subresource][Index(tile.subresource, tile.x, tile.y, tile.z)] = mapped; }
+
+	size_t Count() const
+	{
+		size_t count = 0;
+		for (const std::vector<uint8_t>& mip : m_tiles)
+			for (uint8_t mapped : mip)
+				count += mapped;
+		return count;
+	}
+
+	void Apply(const ResidencyWorkList& work)
+	{
+		for (const SolverTile& tile : work.uploads) Set(tile, true);
+		for (const SolverTile& tile : work.unmaps) Set(tile, false);
+	}
+
+private:
+	size_t Index(uint32_t sub, uint32_t x, uint32_t y, uint32_t z) const
+	{
+		return (size_t(z) * m_counts[sub][1] + y) * m_counts[sub][0] + x;
+	}
+
+	std::vector<std::array<uint32_t, 3>> m_counts;
+	std::vector<std::vector<uint8_t>> m_tiles;
+};
+
+// The per-frame rescan: every tile in the sphere's bounding box, and in
+// last frame's, is tested and looked up
+class RescanSolver {
+public:
+	explicit RescanSolver(const ResourceTilingInfo& tilingInfo)
+		: m_tilingInfo(tilingInfo)
+	{
+		for (UINT m = 0; m < MIP_RADII.size(); ++m) {
+			const SubresourceTilingInfo& sub = tilingInfo.subresourceTilingInfo[m];
+			m_desired.emplace_back(size_t(sub.WidthInTiles) * sub.HeightInTiles * sub.DepthInTiles, uint8_t(0));
+			m_previous.push_back({ {}, {}, true });
+		}
+	}
+
+	void Solve(const float camera[3], const MappedTiles& mapped, ResidencyWorkList& outWork)
+	{
+		const uint32_t tileTexels[3] = {
+			m_tilingInfo.TileWidthInTexels, m_tilingInfo.TileHeightInTexels, m_tilingInfo.TileDepthInTexels };
+
+		for (UINT m = 0; m < MIP_RADII.size(); ++m) {
+			const SubresourceTilingInfo& sub = m_tilingInfo.subresourceTilingInfo[m];
+			const uint32_t counts[3] = { sub.WidthInTiles, sub.HeightInTiles, sub.DepthInTiles };
+			float tileSize[3];
+			Box box;
+			for (int a = 0; a < 3; ++a) {
+				tileSize[a] = float(tileTexels[a] << m);
+				const float lo = std::floor((camera[a] - MIP_RADII[m]) / tileSize[a]);
+				const float hi = std::floor((camera[a] + MIP_RADII[m]) / tileSize[a]);
+				box.min[a] = uint32_t((std::max)(lo, 0.0f));
+				box.max[a] = uint32_t((std::min)(hi, float(counts[a] - 1)));
+			}
+
+			Box scan = box;
+			if (!m_previous[m].empty) {
+				for (int a = 0; a < 3; ++a) {
+					scan.min[a] = (std::min)(scan.min[a], m_previous[m].min[a]);
+					scan.max[a] = (std::max)(scan.max[a], m_previous[m].max[a]);
+				}
+			}
+			m_previous[m] = box;
+
+			for (uint32_t z = scan.min[2]; z <= scan.max[2]; ++z)
+				for (uint32_t y = scan.min[1]; y <= scan.max[1]; ++y)
+					for (uint32_t x = scan.min[0]; x <= scan.max[0]; ++x) {
+						const uint32_t tile[3] = { x, y, z };
+						float gapSquared = 0.0f;
+						float centerSquared = 0.0f;
+						for (int a = 0; a < 3; ++a) {
+							const float lo = tile[a] * tileSize[a];
+							const float gap = (std::max)((std::max)(lo - camera[a], camera[a] - lo - tileSize[a]), 0.0f);
+							const float center = lo + tileSize[a] * 0.5f - camera[a];
+							gapSquared += gap * gap;
+							centerSquared += center * center;
+						}
+
+						uint8_t& desired = m_desired[m][(size_t(z) * counts[1] + y) * counts[0] + x];
+						const bool wanted = gapSquared <= MIP_RADII[m] * MIP_RADII[m];
+						const bool isMapped = mapped.IsMapped(m, x, y, z);
+						if (wanted && !isMapped) {
+							outWork.uploads.push_back({ m, x, y, z, std::sqrt(centerSquared) });
+						}
+						else if (!wanted && desired && isMapped) {
+							outWork.unmaps.push_back({ m, x, y, z, std::sqrt(centerSquared) });
+						}
+						desired = wanted;
+					}
+		}
+	}
+
+private:
+	struct Box {
+		uint32_t min[3];
+		uint32_t max[3];
+		bool empty = false;
+	};
+
+	const ResourceTilingInfo& m_tilingInfo;
+	std::vector<std::vector<uint8_t>> m_desired;
+	std::vector<Box> m_previous;
+};
+
+double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+ResidencySolverSettings MakeSettings()
+{
+	ResidencySolverSettings settings = {};
+	for (int a = 0; a < 3; ++a) {
+		settings.boundsMin[a] = 0.0f;
+		settings.boundsMax[a] = float(VOLUME_SIZE);
+		settings.volumeSize[a] = VOLUME_SIZE;
+	}
+	settings.mipRadii = MIP_RADII;
+	return settings;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	const bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+	const UINT frames = quick ? 8 : 600;
+
+	IUnityLog log;
+	log.quiet = true;
+	auto softwareBackend = std::make_unique<SoftwareBackend>(SoftwareBackendSettings{});
+	SoftwareBackend* backend = softwareBackend.get();
+	RenderingPlugin plugin(std::move(softwareBackend), &log);
+	VolumeHandle handle = plugin.CreateVolumetricResource(VOLUME_SIZE, VOLUME_SIZE, VOLUME_SIZE, true, MIP_COUNT, DXGI_FORMAT_R8_UNORM);
+	ReservedResource* resource = plugin.GetVolumetricResource(handle);
+	if (!resource) {
+		std::fprintf(stderr, "CreateVolumetricResource failed\n");
+		return 1;
+	}
+	const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+
+	int failures = 0;
+	std::printf("%-11s %9s %9s %12s %12s %8s\n", "trace", "desired", "work/frm", "solver us", "rescan us", "speedup");
+
+	for (Trace trace : { Trace::Flythrough, Trace::Orbit, Trace::Hover }) {
+		ResidencySolver solver(tilingInfo, MakeSettings());
+		RescanSolver rescan(tilingInfo);
+		MappedTiles solverMapped(tilingInfo);
+		MappedTiles rescanMapped(tilingInfo);
+		const TileResidencyQuery isMapped = [&solverMapped](uint32_t sub, uint32_t x, uint32_t y, uint32_t z) {
+			return solverMapped.IsMapped(sub, x, y, z);
+		};
+
+		double solverSeconds = 0;
+		double rescanSeconds = 0;
+		size_t desired = 0;
+		size_t work = 0;
+		for (UINT frame = 0; frame < frames; ++frame) {
+			float camera[3];
+			SampleTrace(trace, float(frame) / frames, camera);
+
+			ResidencyWorkList solved;
+			auto start = std::chrono::steady_clock::now();
+			solver.Solve(camera, isMapped, false, solved);
+			solverSeconds += SecondsSince(start);
+			solverMapped.Apply(solved);
+
+			ResidencyWorkList rescanned;
+			start = std::chrono::steady_clock::now();
+			rescan.Solve(camera, rescanMapped, rescanned);
+			rescanSeconds += SecondsSince(start);
+			rescanMapped.Apply(rescanned);
+
+			ResidencyWorkList again;
+			solver.Solve(camera, isMapped, false, again);
+			if (!again.uploads.empty() || !again.unmaps.empty() || solverMapped.Count() != solver.DesiredTileCount()) {
+				std::fprintf(stderr, "%s frame %u: mapping does not match the desired set\n", TraceName(trace), frame);
+				++failures;
+			}
+
+			desired += solver.DesiredTileCount();
+			work += solved.uploads.size() + solved.unmaps.size();
+		}
+
+		std::printf("%-11s %9zu %9zu %12.1f %12.1f %7.1fx\n",
+			TraceName(trace), desired / frames, work / frames,
+			solverSeconds * 1e6 / frames, rescanSeconds * 1e6 / frames,
+			rescanSeconds / solverSeconds);
+	}
+
+	// Through the plugin: the solver's uploads are mapped and staged for
+	// real, up to a per-frame budget, and unmaps are applied by the solve
+	const UINT uploadBudget = 256;
+	if (!plugin.EnableResidencySolver(resource, MakeSettings())) {
+		std::fprintf(stderr, "EnableResidencySolver failed\n");
+		return 1;
+	}
+
+	std::vector<std::byte> tile(SoftwareBackend::TILE_SIZE, std::byte{ 7 });
+	double solveSeconds = 0;
+	double uploadSeconds = 0;
+	size_t uploaded = 0;
+	float camera[3] = {};
+	for (UINT frame = 0; frame < frames; ++frame) {
+		SampleTrace(Trace::Flythrough, float(frame) / frames, camera);
+
+		ResidencyWorkList work;
+		auto start = std::chrono::steady_clock::now();
+		failures += !plugin.SolveResidency(resource, camera, true, work);
+		solveSeconds += SecondsSince(start);
+
+		start = std::chrono::steady_clock::now();
+		const size_t count = (std::min)(work.uploads.size(), size_t(uploadBudget));
+		for (size_t i = 0; i < count; ++i) {
+			const SolverTile& solverTile = work.uploads[i];
+			failures += !plugin.UploadDataToTile(resource, solverTile.subresource,
+				solverTile.x, solverTile.y, solverTile.z, std::span<std::byte>(tile));
+		}
+		uploadSeconds += SecondsSince(start);
+		uploaded += count;
+	}
+
+	// Catch up on the budget, then nothing is left to do
+	for (UINT pass = 0; pass < 64; ++pass) {
+		ResidencyWorkList work;
+		failures += !plugin.SolveResidency(resource, camera, true, work);
+		if (work.uploads.empty()) {
+			break;
+		}
+		for (const SolverTile& solverTile : work.uploads) {
+			failures += !plugin.UploadDataToTile(resource, solverTile.subresource,
+				solverTile.x, solverTile.y, solverTile.z, std::span<std::byte>(tile));
+		}
+	}
+	ResidencyWorkList settled;
+	failures += !plugin.SolveResidency(resource, camera, true, settled);
+	if (!settled.uploads.empty() || !settled.unmaps.empty()) {
+		std::fprintf(stderr, "plugin: %zu uploads and %zu unmaps left after settling\n",
+			settled.uploads.size(), settled.unmaps.size());
+		++failures;
+	}
+
+	std::printf("\nplugin flythrough: solve %.1f us/frame, %zu tiles uploaded (%.3f ms/frame), %llu tiles mapped at the end\n",
+		solveSeconds * 1e6 / frames, uploaded, uploadSeconds * 1000 / frames,
+		(unsigned long long)backend->GetStats().tilesMapped);
+
+	plugin.DestroyVolumetricResource(handle);
+	return failures == 0 ? 0 : 1;
+}
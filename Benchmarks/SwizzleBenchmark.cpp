@@ -0,0 +1,92 @@
+// Tile swizzle throughput, fast kernel against the reference, for every
+// texel size on a Morton layout (short runs) and a row-linear layout (long
+// runs, where the AVX2 copy applies). --quick runs a few tiles of each.
+#include "pch.h"
+#include "CpuFeatures.h"
+#include "TileSwizzle.h"
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t TILE_SIZE = 65536;
+
+struct Shape {
+	uint32_t bytesPerTexel, width, height, depth;
+};
+
+template <typename Convert>
+double MeasureGBps(uint32_t tiles, Convert convert)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < tiles; ++i) {
+		convert();
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return tiles * double(TILE_SIZE) / seconds / 1e9;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	const bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+	const uint32_t fastTiles = quick ? 8 : 4000;
+	const uint32_t referenceTiles = quick ? 2 : 200;
+
+	const Shape shapes[] = {
+		{ 1, 64, 32, 32 }, { 2, 32, 32, 32 }, { 4, 32, 32, 16 },
+		{ 8, 32, 16, 16 }, { 16, 16, 16, 16 },
+	};
+
+	std::vector<std::byte> linear(TILE_SIZE);
+	for (size_t i = 0; i < linear.size(); ++i) {
+		linear[i] = static_cast<std::byte>((i * 131 + 7) & 0xFF);
+	}
+	std::vector<std::byte> fast(TILE_SIZE);
+	std::vector<std::byte> reference(TILE_SIZE);
+	std::vector<std::byte> roundTrip(TILE_SIZE);
+
+	std::printf("AVX2: %s\n", CpuFeatures::HasAVX2() ? "yes" : "no");
+	std::printf("%-7s %-7s %10s %10s %10s\n", "bpp", "layout", "swizzle", "unswizzle", "reference");
+
+	int failures = 0;
+	for (const Shape& shape : shapes) {
+		const uint32_t xBits = std::countr_zero(shape.width);
+		const uint32_t yBits = std::countr_zero(shape.height);
+		const SwizzlePattern patterns[] = {
+			MakeMortonSwizzlePattern(shape.bytesPerTexel, shape.width, shape.height, shape.depth),
+			{ shape.bytesPerTexel, shape.width, shape.height, shape.depth,
+				shape.width - 1, (shape.height - 1) << xBits, (shape.depth - 1) << (xBits + yBits) },
+		};
+		const char* layoutNames[] = { "morton", "rows" };
+
+		for (uint32_t p = 0; p < 2; ++p) {
+			const SwizzlePattern& pattern = patterns[p];
+
+			SwizzleTile(linear.data(), fast.data(), pattern);
+			SwizzleTileReference(linear.data(), reference.data(), pattern);
+			UnswizzleTile(fast.data(), roundTrip.data(), pattern);
+			if (fast != reference || roundTrip != linear) {
+				std::fprintf(stderr, "%u bytes/texel %s: fast kernel disagrees with the reference\n",
+					shape.bytesPerTexel, layoutNames[p]);
+				++failures;
+				continue;
+			}
+
+			const double swizzle = MeasureGBps(fastTiles,
+				[&] { SwizzleTile(linear.data(), fast.data(), pattern); });
+			const double unswizzle = MeasureGBps(fastTiles,
+				[&] { UnswizzleTile(fast.data(), roundTrip.data(), pattern); });
+			const double referenceRate = MeasureGBps(referenceTiles,
+				[&] { SwizzleTileReference(linear.data(), reference.data(), pattern); });
+			std::printf("%-7u %-7s %8.2f GB/s %6.2f GB/s %6.2f GB/s\n",
+				shape.bytesPerTexel, layoutNames[p], swizzle, unswizzle, referenceRate);
+		}
+	}
+
+	return failures == 0 ? 0 : 1;
+}
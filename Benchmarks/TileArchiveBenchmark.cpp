@@ -0,0 +1,147 @@
+// Tile archive read throughput: bakes a raw and a compressed archive to a
+// temporary file, then times Open, a first sequential ReadTile pass (page
+// faults, each tile checked against the baked one), a warm shuffled pass,
+// and a box upload straight from the mapping through the plugin on the
+// software backend.
+// --quick uses a small archive as a smoke test.
+#include "pch.h"
+#include "RenderingPlugin.h"
+#include "SoftwareBackend.h"
+#include "TileArchive.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t TILE_SIZE = 65536;
+
+// The first half of the tiles are smooth runs and the rest noise, so
+// compression helps on some records and the raw path is exercised too
+std::vector<std::byte> MakeTile(uint32_t index, bool noise)
+{
+	std::vector<std::byte> tile(TILE_SIZE);
+	uint32_t state = index * 2654435761u + 1;
+	for (uint32_t i = 0; i < TILE_SIZE; ++i) {
+		if (noise) {
+			state = state * 1664525u + 1013904223u;
+			tile[i] = static_cast<std::byte>(state >> 24);
+		}
+		else {
+			tile[i] = static_cast<std::byte>((i / 211 + index) % 7);
+		}
+	}
+	return tile;
+}
+
+double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	const bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+	const uint32_t edge = quick ? 2 : 8;
+	const uint32_t tileCount = edge * edge * edge;
+
+	IUnityLog log;
+	log.quiet = true;
+	RenderingPlugin plugin(std::make_unique<SoftwareBackend>(SoftwareBackendSettings{}), &log);
+	VolumeHandle handle = plugin.CreateVolumetricResource(edge * 64, edge * 32, edge * 32, false, 1, DXGI_FORMAT_R8_UNORM);
+	ReservedResource* resource = plugin.GetVolumetricResource(handle);
+	if (!resource) {
+		std::fprintf(stderr, "CreateVolumetricResource failed\n");
+		return 1;
+	}
+
+	std::vector<std::vector<std::byte>> tiles;
+	for (uint32_t i = 0; i < tileCount; ++i) {
+		tiles.push_back(MakeTile(i, i >= tileCount / 2));
+	}
+
+	int failures = 0;
+	std::printf("%-10s %8s %10s %10s %12s %12s %12s\n",
+		"archive", "tiles", "MB", "open ms", "cold GB/s", "warm GB/s", "upload GB/s");
+
+	for (bool compress : { false, true }) {
+		const std::filesystem::path path = std::filesystem::temp_directory_path() /
+			(compress ? "TileArchiveBenchmark.packed.svta" : "TileArchiveBenchmark.raw.svta");
+		const std::string pathString = path.string();
+
+		TileArchiveWriter* writer = plugin.CreateTileArchiveWriter(pathString.c_str(), DXGI_FORMAT_R8_UNORM);
+		if (!writer) {
+			std::fprintf(stderr, "%s: cannot create\n", pathString.c_str());
+			++failures;
+			continue;
+		}
+		for (uint32_t i = 0; i < tileCount; ++i) {
+			const uint32_t x = i % edge, y = (i / edge) % edge, z = i / (edge * edge);
+			failures += !plugin.AddTileToArchive(writer, 0, x, y, z,
+				std::span<const std::byte>(tiles[i]), compress);
+		}
+		failures += !plugin.FinishTileArchive(writer);
+
+		auto start = std::chrono::steady_clock::now();
+		TileArchive* archive = plugin.OpenTileArchive(pathString.c_str());
+		const double openSeconds = SecondsSince(start);
+		if (!archive) {
+			std::fprintf(stderr, "%s: cannot open\n", pathString.c_str());
+			++failures;
+			continue;
+		}
+
+		std::vector<const TileArchiveEntry*> entries(tileCount);
+		for (uint32_t i = 0; i < tileCount; ++i) {
+			entries[i] = archive->Find(0, i % edge, (i / edge) % edge, i / (edge * edge));
+			failures += entries[i] == nullptr;
+		}
+		if (std::find(entries.begin(), entries.end(), nullptr) != entries.end()) {
+			plugin.CloseTileArchive(archive);
+			continue;
+		}
+
+		std::vector<std::byte> tile(TILE_SIZE);
+		start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < tileCount; ++i) {
+			failures += !archive->ReadTile(*entries[i], tile.data());
+			failures += tile != tiles[i];
+		}
+		const double sequentialSeconds = SecondsSince(start);
+
+		std::vector<uint32_t> order(tileCount);
+		for (uint32_t i = 0; i < tileCount; ++i) {
+			order[i] = i;
+		}
+		std::shuffle(order.begin(), order.end(), std::mt19937(7));
+		start = std::chrono::steady_clock::now();
+		for (uint32_t i : order) {
+			failures += !archive->ReadTile(*entries[i], tile.data());
+		}
+		const double randomSeconds = SecondsSince(start);
+
+		const TileBox box = { 0, 0, 0, 0, edge, edge, edge };
+		start = std::chrono::steady_clock::now();
+		failures += !plugin.UploadTileBoxFromArchive(resource, archive, box);
+		const double uploadSeconds = SecondsSince(start);
+		failures += !plugin.UnmapTileBox(resource, box);
+
+		const double bytes = double(tileCount) * TILE_SIZE;
+		std::printf("%-10s %8u %10.1f %10.3f %12.2f %12.2f %12.2f\n",
+			compress ? "packed" : "raw", tileCount,
+			std::filesystem::file_size(path) / 1048576.0, openSeconds * 1000,
+			bytes / sequentialSeconds / 1e9, bytes / randomSeconds / 1e9, bytes / uploadSeconds / 1e9);
+
+		plugin.CloseTileArchive(archive);
+		std::filesystem::remove(path);
+	}
+
+	plugin.DestroyVolumetricResource(handle);
+	return failures == 0 ? 0 : 1;
+}
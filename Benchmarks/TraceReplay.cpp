@@ -0,0 +1,201 @@
+// Replays recorded call traces (see CallTrace.h) through a RenderingPlugin
+// on the software backend, so production streaming sessions run through the
+// plugin's allocator, residency tracking and upload batching with no GPU.
+//
+//   TraceReplay [--timestamps] [--fence-latency <ns>] [--residency] trace.svct...
+//
+// --timestamps sleeps until each call's recorded start; --residency turns on
+// LRU eviction as the session would have with EnableResidencyManagement.
+// --quick with no traces records a short synthetic session and replays it,
+// as a smoke test.
+#include "pch.h"
+#include "CallReplay.h"
+#include "RenderingPlugin.h"
+#include "SoftwareBackend.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace {
+
+const char* STAGE_NAMES[PIPELINE_STAGE_COUNT] = {
+	"validate", "acquireSlot", "stageFill", "mapTiles", "recordCopy", "submit", "unmap"
+};
+
+// A volume streamed in boxes and single tiles, partly unmapped, then
+// destroyed; payloads are stand-ins seeded by their hash
+bool WriteSyntheticTrace(const std::string& path, std::string* outError)
+{
+	std::unique_ptr<CallTraceWriter> writer = CallTraceWriter::Create(path, CallPayloadMode::Hash, outError);
+	if (!writer) {
+		return false;
+	}
+
+	// R8_UNORM tiles are 64x32x32 texels, so the volume is 4x8x8 tiles
+	constexpr uint64_t VOLUME = 1;
+	constexpr uint64_t TILE_BYTES = 65536;
+	uint64_t timestamp = 0;
+	auto call = [&](CallOp op) {
+		CallRecord record;
+		record.op = op;
+		record.succeeded = true;
+		record.timestampNs = timestamp += 10000;
+		record.volume = VOLUME;
+		return record;
+	};
+
+	CallRecord create = call(CallOp::CreateVolume);
+	create.width = 256;
+	create.height = 256;
+	create.depth = 256;
+	create.mipCount = 1;
+	create.format = DXGI_FORMAT_R8_UNORM;
+	writer->Append(create);
+
+	for (uint32_t z = 0; z < 8; z += 2)
+		for (uint32_t y = 0; y < 8; y += 2) {
+			CallRecord box = call(CallOp::UploadTileBox);
+			box.y = y;
+			box.z = z;
+			box.width = 2;
+			box.height = 2;
+			box.depth = 2;
+			box.payloadSize = 8 * TILE_BYTES;
+			box.payloadHash = timestamp;
+			writer->Append(box);
+		}
+	for (uint32_t i = 0; i < 16; ++i) {
+		CallRecord tile = call(CallOp::UploadTile);
+		tile.x = 2 + (i & 1);
+		tile.y = (i >> 1) & 7;
+		tile.z = i >> 3;
+		tile.payloadSize = TILE_BYTES;
+		tile.payloadHash = timestamp;
+		writer->Append(tile);
+	}
+	for (uint32_t i = 0; i < 8; ++i) {
+		CallRecord unmap = call(CallOp::UnmapTile);
+		unmap.x = i & 1;
+		unmap.y = i >> 1;
+		writer->Append(unmap);
+	}
+	writer->Append(call(CallOp::DestroyVolume));
+	return writer->Flush(outError);
+}
+
+// strict: every call must succeed as recorded, for traces we wrote ourselves
+bool Replay(const std::string& path, const SoftwareBackendSettings& backendSettings, bool residency, const CallReplayOptions& options, bool strict)
+{
+	IUnityLog log;
+	log.quiet = true;
+	RenderingPlugin plugin(std::make_unique<SoftwareBackend>(backendSettings), &log);
+	if (residency && !plugin.EnableResidencyManagement(true)) {
+		std::fprintf(stderr, "%s: could not enable residency management\n", path.c_str());
+		return false;
+	}
+
+	std::string error;
+	std::unique_ptr<CallTraceReader> reader = CallTraceReader::Open(path, &error);
+	if (!reader) {
+		std::fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str());
+		return false;
+	}
+
+	PluginReplayTarget target(&plugin);
+	CallReplayStats stats = {};
+	const bool complete = ReplayCallTrace(*reader, target, options, &stats, &error);
+
+	const double seconds = stats.elapsedNs / 1e9;
+	std::printf("%s\n", path.c_str());
+	std::printf("  calls %llu, failed %llu, mismatched %llu, %.1f MB uploaded in %.3f s (%.1f MB/s)\n",
+		static_cast<unsigned long long>(stats.calls),
+		static_cast<unsigned long long>(stats.failedCalls),
+		static_cast<unsigned long long>(stats.resultMismatches),
+		stats.bytesUploaded / 1e6, seconds,
+		seconds > 0 ? stats.bytesUploaded / 1e6 / seconds : 0.0);
+
+	C_PipelineStats pipeline = {};
+	if (plugin.GetPipelineStats(pipeline)) {
+		std::printf("  %-12s %10s %10s %10s %10s\n", "stage", "count", "p50Ns", "p99Ns", "maxNs");
+		for (uint32_t stage = 0; stage < PIPELINE_STAGE_COUNT; ++stage) {
+			const C_PipelineStageStats& s = pipeline.stages[stage];
+			if (s.count == 0) {
+				continue;
+			}
+			std::printf("  %-12s %10llu %10llu %10llu %10llu\n", STAGE_NAMES[stage],
+				static_cast<unsigned long long>(s.count),
+				static_cast<unsigned long long>(s.p50Ns),
+				static_cast<unsigned long long>(s.p99Ns),
+				static_cast<unsigned long long>(s.maxNs));
+		}
+		std::printf("  tiles mapped %llu, unmapped %llu\n",
+			static_cast<unsigned long long>(pipeline.counters[static_cast<uint32_t>(PipelineCounter::TilesMapped)]),
+			static_cast<unsigned long long>(pipeline.counters[static_cast<uint32_t>(PipelineCounter::TilesUnmapped)]));
+	}
+
+	if (!complete) {
+		std::fprintf(stderr, "%s: %s after %llu calls\n", path.c_str(), error.c_str(),
+			static_cast<unsigned long long>(stats.calls));
+		return false;
+	}
+	return !strict || (stats.failedCalls == 0 && stats.resultMismatches == 0);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+	bool quick = false;
+	bool residency = false;
+	SoftwareBackendSettings backendSettings;
+	CallReplayOptions options;
+	std::vector<std::string> paths;
+	for (int i = 1; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--quick") == 0) {
+			quick = true;
+		}
+		else if (std::strcmp(argv[i], "--timestamps") == 0) {
+			options.honorTimestamps = true;
+		}
+		else if (std::strcmp(argv[i], "--residency") == 0) {
+			residency = true;
+		}
+		else if (std::strcmp(argv[i], "--fence-latency") == 0 && i + 1 < argc) {
+			backendSettings.fenceLatencyNs = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (argv[i][0] == '-') {
+			std::fprintf(stderr, "usage: %s [--timestamps] [--fence-latency <ns>] [--residency] trace.svct...\n", argv[0]);
+			return 2;
+		}
+		else {
+			paths.push_back(argv[i]);
+		}
+	}
+
+	std::string synthetic;
+	if (paths.empty()) {
+		if (!quick) {
+			std::fprintf(stderr, "usage: %s [--timestamps] [--fence-latency <ns>] [--residency] trace.svct...\n", argv[0]);
+			return 2;
+		}
+		std::string error;
+		synthetic = (std::filesystem::temp_directory_path() / "TraceReplayQuick.svct").string();
+		if (!WriteSyntheticTrace(synthetic, &error)) {
+			std::fprintf(stderr, "%s: %s\n", synthetic.c_str(), error.c_str());
+			return 1;
+		}
+		paths.push_back(synthetic);
+	}
+
+	int failures = 0;
+	for (const std::string& path : paths) {
+		failures += !Replay(path, backendSettings, residency, options, path == synthetic);
+	}
+	if (!synthetic.empty()) {
+		std::error_code ignored;
+		std::filesystem::remove(synthetic, ignored);
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+// Upload pipeline throughput and latency on the software backend, across
+// workloads, fence latencies and thread counts (see PipelineBenchmark.h).
+// --quick runs a few steps of each configuration as a smoke test.
+#include "pch.h"
+#include "PipelineBenchmark.h"
+#include "RenderingPlugin.h"
+#include "SoftwareBackend.h"
+#include <cstdio>
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+	const bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+
+	IUnityLog log;
+	log.quiet = true;
+
+	const char* workloadNames[] = { "single", "box", "mixed" };
+	const uint64_t fenceLatencies[] = { 0, 200000 };
+	const uint32_t threadCounts[] = { 1, 4 };
+
+	int failures = 0;
+	std::printf("%-8s %10s %7s %8s %8s %12s %10s %10s %10s\n",
+		"workload", "latencyNs", "threads", "calls", "failed", "tiles/s", "p50Ns", "p99Ns", "maxNs");
+	for (uint32_t workload = 0; workload < 3; ++workload)
+		for (uint64_t latency : fenceLatencies)
+			for (uint32_t threads : threadCounts) {
+				SoftwareBackendSettings backendSettings;
+				backendSettings.fenceLatencyNs = latency;
+				RenderingPlugin plugin(std::make_unique<SoftwareBackend>(backendSettings), &log);
+
+				PipelineBenchmarkSettings settings = {};
+				settings.workload = static_cast<BenchmarkWorkload>(workload);
+				settings.threads = threads;
+				settings.uploadsPerThread = quick ? 20 : 400;
+				settings.boxEdge = 2;
+				settings.fenceLatencyNs = latency;
+				settings.useSoftwareBackend = true;
+
+				PipelineBenchmarkResult result = {};
+				std::string error;
+				if (!RunPipelineBenchmark(plugin, settings, &result, &error)) {
+					std::fprintf(stderr, "%s: %s\n", workloadNames[workload], error.c_str());
+					++failures;
+					continue;
+				}
+				failures += result.failedCalls != 0;
+
+				std::printf("%-8s %10llu %7u %8llu %8llu %12.0f %10llu %10llu %10llu\n",
+					workloadNames[workload],
+					static_cast<unsigned long long>(latency),
+					threads,
+					static_cast<unsigned long long>(result.calls),
+					static_cast<unsigned long long>(result.failedCalls),
+					result.tilesPerSecond,
+					static_cast<unsigned long long>(result.p50Ns),
+					static_cast<unsigned long long>(result.p99Ns),
+					static_cast<unsigned long long>(result.maxNs));
+			}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,481 @@
+#include "pch.h"
+
+#include "BlockCompression.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// ---- 4-wide float lanes ----
+// A block is 16 texels, so every per-block pass is four lane operations.
+// SSE2 is baseline on x86-64, so no runtime dispatch is needed.
+// SPARSE_SCALAR_LANES forces the portable lanes (BlockCompressionTest builds
+// them alongside the SIMD ones).
+
+#if defined(SPARSE_X86) && !defined(SPARSE_SCALAR_LANES)
+using Lane = __m128;
+inline Lane Splat(float v) { return _mm_set1_ps(v); }
+inline Lane Load(const float* p) { return _mm_loadu_ps(p); }
+inline Lane Add(Lane a, Lane b) { return _mm_add_ps(a, b); }
+inline Lane Sub(Lane a, Lane b) { return _mm_sub_ps(a, b); }
+inline Lane Mul(Lane a, Lane b) { return _mm_mul_ps(a, b); }
+inline Lane Min(Lane a, Lane b) { return _mm_min_ps(a, b); }
+inline Lane Max(Lane a, Lane b) { return _mm_max_ps(a, b); }
+
+inline float HorizontalMin(Lane v)
+{
+	v = _mm_min_ps(v, _mm_movehl_ps(v, v));
+	return _mm_cvtss_f32(_mm_min_ss(v, _mm_shuffle_ps(v, v, 1)));
+}
+
+inline float HorizontalMax(Lane v)
+{
+	v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+	return _mm_cvtss_f32(_mm_max_ss(v, _mm_shuffle_ps(v, v, 1)));
+}
+
+inline float HorizontalSum(Lane v)
+{
+	v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+	return _mm_cvtss_f32(_mm_add_ss(v, _mm_shuffle_ps(v, v, 1)));
+}
+
+// Truncates after the caller has added 0.5 and clamped to >= 0
+inline void StoreIndices(Lane v, uint32_t* out)
+{
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_cvttps_epi32(v));
+}
+#elif defined(SPARSE_NEON) && !defined(SPARSE_SCALAR_LANES)
+using Lane = float32x4_t;
+inline Lane Splat(float v) { return vdupq_n_f32(v); }
+inline Lane Load(const float* p) { return vld1q_f32(p); }
+inline Lane Add(Lane a, Lane b) { return vaddq_f32(a, b); }
+inline Lane Sub(Lane a, Lane b) { return vsubq_f32(a, b); }
+inline Lane Mul(Lane a, Lane b) { return vmulq_f32(a, b); }
+inline Lane Min(Lane a, Lane b) { return vminq_f32(a, b); }
+inline Lane Max(Lane a, Lane b) { return vmaxq_f32(a, b); }
+inline float HorizontalMin(Lane v) { return vminvq_f32(v); }
+inline float HorizontalMax(Lane v) { return vmaxvq_f32(v); }
+inline float HorizontalSum(Lane v) { return vaddvq_f32(v); }
+inline void StoreIndices(Lane v, uint32_t* out) { vst1q_u32(out, vcvtq_u32_f32(v)); }
+#else
+struct Lane { float v[4]; };
+
+template <typename Op>
+inline Lane Apply(Lane a, Lane b, Op op)
+{
+	Lane r;
+	for (int i = 0; i < 4; ++i) {
+		r.v[i] = op(a.v[i], b.v[i]);
+	}
+	return r;
+}
+
+inline Lane Splat(float v) { return { { v, v, v, v } }; }
+inline Lane Load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+inline Lane Add(Lane a, Lane b) { return Apply(a, b, [](float x, float y) { return x + y; }); }
+inline Lane Sub(Lane a, Lane b) { return Apply(a, b, [](float x, float y) { return x - y; }); }
+inline Lane Mul(Lane a, Lane b) { return Apply(a, b, [](float x, float y) { return x * y; }); }
+inline Lane Min(Lane a, Lane b) { return Apply(a, b, [](float x, float y) { return (std::min)(x, y); }); }
+inline Lane Max(Lane a, Lane b) { return Apply(a, b, [](float x, float y) { return (std::max)(x, y); }); }
+inline float HorizontalMin(Lane v) { return (std::min)((std::min)(v.v[0], v.v[1]), (std::min)(v.v[2], v.v[3])); }
+inline float HorizontalMax(Lane v) { return (std::max)((std::max)(v.v[0], v.v[1]), (std::max)(v.v[2], v.v[3])); }
+inline float HorizontalSum(Lane v) { return (v.v[0] + v.v[1]) + (v.v[2] + v.v[3]); }
+
+inline void StoreIndices(Lane v, uint32_t* out)
+{
+	for (int i = 0; i < 4; ++i) {
+		out[i] = static_cast<uint32_t>(v.v[i]);
+	}
+}
+#endif
+
+// ---- Shared block analysis ----
+
+// One block's texels, channel-major so each channel loads as four lanes
+struct BlockTexels {
+	alignas(16) float channel[4][16];
+};
+
+template <uint32_t Channels>
+void LoadBlock(const std::byte* texels, BlockTexels& out)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(texels);
+	for (uint32_t i = 0; i < 16; ++i) {
+		for (uint32_t c = 0; c < Channels; ++c) {
+			out.channel[c][i] = static_cast<float>(bytes[i * Channels + c]);
+		}
+	}
+}
+
+void ChannelRange(const float* values, float* outMin, float* outMax)
+{
+	Lane lo = Load(values);
+	Lane hi = lo;
+	for (uint32_t i = 4; i < 16; i += 4) {
+		const Lane v = Load(values + i);
+		lo = Min(lo, v);
+		hi = Max(hi, v);
+	}
+	*outMin = HorizontalMin(lo);
+	*outMax = HorizontalMax(hi);
+}
+
+float Covariance(const float* a, float centerA, const float* b, float centerB)
+{
+	Lane sum = Splat(0.0f);
+	for (uint32_t i = 0; i < 16; i += 4) {
+		sum = Add(sum, Mul(Sub(Load(a + i), Splat(centerA)), Sub(Load(b + i), Splat(centerB))));
+	}
+	return HorizontalSum(sum);
+}
+
+// Bounding-box endpoints. The box has 2^(Channels-1) diagonals; pick the one
+// whose direction matches the sign of each channel's covariance with the
+// widest channel, then pull both ends in by insetFraction of the extent so the
+// extremes land between palette entries rather than on them.
+template <uint32_t Channels>
+void ChooseEndpoints(const BlockTexels& block, float insetFraction, float* outLow, float* outHigh)
+{
+	uint32_t widest = 0;
+	for (uint32_t c = 0; c < Channels; ++c) {
+		ChannelRange(block.channel[c], &outLow[c], &outHigh[c]);
+		if (outHigh[c] - outLow[c] > outHigh[widest] - outLow[widest]) {
+			widest = c;
+		}
+	}
+
+	const float widestCenter = (outLow[widest] + outHigh[widest]) * 0.5f;
+	for (uint32_t c = 0; c < Channels; ++c) {
+		const float inset = (outHigh[c] - outLow[c]) * insetFraction;
+		outLow[c] += inset;
+		outHigh[c] -= inset;
+
+		if (c != widest && Covariance(block.channel[c], (outLow[c] + outHigh[c]) * 0.5f,
+			block.channel[widest], widestCenter) < 0.0f) {
+			std::swap(outLow[c], outHigh[c]);
+		}
+	}
+}
+
+// Projects every texel onto start->end and rounds to steps + 1 evenly
+// spaced levels: 0 at start, steps at end.
+template <uint32_t Channels>
+void ProjectIndices(const BlockTexels& block, const float* start, const float* end, float steps, uint32_t* outIndices)
+{
+	float direction[Channels];
+	float lengthSquared = 0.0f;
+	for (uint32_t c = 0; c < Channels; ++c) {
+		direction[c] = end[c] - start[c];
+		lengthSquared += direction[c] * direction[c];
+	}
+
+	if (lengthSquared < 1e-6f) {
+		std::fill(outIndices, outIndices + 16, 0u);
+		return;
+	}
+
+	const Lane scale = Splat(steps / lengthSquared);
+	const Lane zero = Splat(0.0f);
+	const Lane half = Splat(0.5f);
+	const Lane maxLevel = Splat(steps);
+	for (uint32_t i = 0; i < 16; i += 4) {
+		Lane dot = zero;
+		for (uint32_t c = 0; c < Channels; ++c) {
+			dot = Add(dot, Mul(Sub(Load(block.channel[c] + i), Splat(start[c])), Splat(direction[c])));
+		}
+		const Lane level = Min(Max(Mul(dot, scale), zero), maxLevel);
+		StoreIndices(Add(level, half), outIndices + i);
+	}
+}
+
+// ---- BC1 ----
+
+uint16_t PackRGB565(const float* color)
+{
+	const uint32_t r = static_cast<uint32_t>(std::clamp(color[0], 0.0f, 255.0f) * (31.0f / 255.0f) + 0.5f);
+	const uint32_t g = static_cast<uint32_t>(std::clamp(color[1], 0.0f, 255.0f) * (63.0f / 255.0f) + 0.5f);
+	const uint32_t b = static_cast<uint32_t>(std::clamp(color[2], 0.0f, 255.0f) * (31.0f / 255.0f) + 0.5f);
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void UnpackRGB565(uint16_t packed, float* outColor)
+{
+	const uint32_t r = (packed >> 11) & 0x1F;
+	const uint32_t g = (packed >> 5) & 0x3F;
+	const uint32_t b = packed & 0x1F;
+	outColor[0] = static_cast<float>((r << 3) | (r >> 2));
+	outColor[1] = static_cast<float>((g << 2) | (g >> 4));
+	outColor[2] = static_cast<float>((b << 3) | (b >> 2));
+}
+
+// Four-colour mode only (color0 > color1); alpha is ignored
+void EncodeBC1Block(const std::byte* texels, std::byte* block)
+{
+	BlockTexels texelsF;
+	LoadBlock<4>(texels, texelsF);
+
+	float low[3], high[3];
+	ChooseEndpoints<3>(texelsF, 1.0f / 16.0f, low, high);
+
+	uint16_t color0 = PackRGB565(high);
+	uint16_t color1 = PackRGB565(low);
+	if (color0 < color1) {
+		std::swap(color0, color1);
+	}
+
+	uint32_t indexBits = 0;
+	if (color0 != color1) {
+		float end0[3], end1[3];
+		UnpackRGB565(color0, end0);
+		UnpackRGB565(color1, end1);
+
+		// Level 0..3 along color0 -> color1; palette order is 0, 1, 2/3, 1/3
+		static constexpr uint32_t levelToIndex[4] = { 0, 2, 3, 1 };
+		uint32_t levels[16];
+		ProjectIndices<3>(texelsF, end0, end1, 3.0f, levels);
+		for (uint32_t i = 0; i < 16; ++i) {
+			indexBits |= levelToIndex[levels[i]] << (2 * i);
+		}
+	}
+
+	std::memcpy(block, &color0, 2);
+	std::memcpy(block + 2, &color1, 2);
+	std::memcpy(block + 4, &indexBits, 4);
+}
+
+// ---- BC4 / BC5 ----
+
+// Eight-value mode only (red0 > red1)
+void EncodeBC4Channel(const float* values, std::byte* block)
+{
+	float low, high;
+	ChannelRange(values, &low, &high);
+
+	// Source values are whole bytes, so the range needs no rounding
+	const uint8_t red0 = static_cast<uint8_t>(high);
+	const uint8_t red1 = static_cast<uint8_t>(low);
+	uint64_t bits = static_cast<uint64_t>(red0) | (static_cast<uint64_t>(red1) << 8);
+
+	if (red0 != red1) {
+		BlockTexels single;
+		std::memcpy(single.channel[0], values, sizeof(single.channel[0]));
+
+		// Level 0..7 along red1 -> red0; index 0 is red0, 1 is red1, 2..7
+		// step back down from red0
+		static constexpr uint64_t levelToIndex[8] = { 1, 7, 6, 5, 4, 3, 2, 0 };
+		uint32_t levels[16];
+		ProjectIndices<1>(single, &low, &high, 7.0f, levels);
+		for (uint32_t i = 0; i < 16; ++i) {
+			bits |= levelToIndex[levels[i]] << (16 + 3 * i);
+		}
+	}
+
+	std::memcpy(block, &bits, 8);
+}
+
+void EncodeBC4Block(const std::byte* texels, std::byte* block)
+{
+	BlockTexels texelsF;
+	LoadBlock<1>(texels, texelsF);
+	EncodeBC4Channel(texelsF.channel[0], block);
+}
+
+void EncodeBC5Block(const std::byte* texels, std::byte* block)
+{
+	BlockTexels texelsF;
+	LoadBlock<2>(texels, texelsF);
+	EncodeBC4Channel(texelsF.channel[0], block);
+	EncodeBC4Channel(texelsF.channel[1], block + 8);
+}
+
+// ---- BC7 ----
+
+// Least-significant-bit-first writer for one 128-bit block
+struct BlockBitWriter {
+	uint64_t low = 0;
+	uint64_t high = 0;
+	uint32_t position = 0;
+
+	void Write(uint32_t value, uint32_t bitCount)
+	{
+		const uint64_t bits = value;
+		if (position < 64) {
+			low |= bits << position;
+			if (position + bitCount > 64) {
+				high |= bits >> (64 - position);
+			}
+		}
+		else {
+			high |= bits << (position - 64);
+		}
+		position += bitCount;
+	}
+};
+
+// Mode 6 endpoint: 7 bits per channel plus a p-bit shared by all four
+// channels. Picks the p-bit that reconstructs the endpoint more closely.
+void QuantizeMode6Endpoint(const float* endpoint, uint32_t* outQuantized, uint32_t* outPBit, float* outReconstructed)
+{
+	float bestError = -1.0f;
+	for (uint32_t pBit = 0; pBit < 2; ++pBit) {
+		uint32_t quantized[4];
+		float reconstructed[4];
+		float error = 0.0f;
+		for (uint32_t c = 0; c < 4; ++c) {
+			const float scaled = (std::clamp(endpoint[c], 0.0f, 255.0f) - static_cast<float>(pBit)) * 0.5f;
+			quantized[c] = static_cast<uint32_t>(std::clamp(scaled + 0.5f, 0.0f, 127.0f));
+			reconstructed[c] = static_cast<float>((quantized[c] << 1) | pBit);
+			const float delta = reconstructed[c] - endpoint[c];
+			error += delta * delta;
+		}
+
+		if (bestError < 0.0f || error < bestError) {
+			bestError = error;
+			*outPBit = pBit;
+			std::copy(quantized, quantized + 4, outQuantized);
+			std::copy(reconstructed, reconstructed + 4, outReconstructed);
+		}
+	}
+}
+
+// Mode 6 only: one subset, RGBA endpoints, 4-bit indices. It covers opaque
+// and alpha data with a single fast path at a small quality cost against a
+// full mode search.
+void EncodeBC7Block(const std::byte* texels, std::byte* block)
+{
+	BlockTexels texelsF;
+	LoadBlock<4>(texels, texelsF);
+
+	float low[4], high[4];
+	ChooseEndpoints<4>(texelsF, 1.0f / 32.0f, low, high);
+
+	uint32_t quantized[2][4];
+	uint32_t pBits[2];
+	float reconstructed[2][4];
+	QuantizeMode6Endpoint(low, quantized[0], &pBits[0], reconstructed[0]);
+	QuantizeMode6Endpoint(high, quantized[1], &pBits[1], reconstructed[1]);
+
+	// The 16 weights are close enough to even that projection picks the
+	// nearest one
+	uint32_t indices[16];
+	ProjectIndices<4>(texelsF, reconstructed[0], reconstructed[1], 15.0f, indices);
+
+	// Index 0's top bit is implicit zero; flip the block if it is set
+	if (indices[0] & 0x8) {
+		std::swap(quantized[0], quantized[1]);
+		std::swap(pBits[0], pBits[1]);
+		for (uint32_t& index : indices) {
+			index = 15 - index;
+		}
+	}
+
+	BlockBitWriter writer;
+	writer.Write(1u << 6, 7);
+	for (uint32_t c = 0; c < 4; ++c) {
+		writer.Write(quantized[0][c], 7);
+		writer.Write(quantized[1][c], 7);
+	}
+	writer.Write(pBits[0], 1);
+	writer.Write(pBits[1], 1);
+	writer.Write(indices[0], 3);
+	for (uint32_t i = 1; i < 16; ++i) {
+		writer.Write(indices[i], 4);
+	}
+
+	std::memcpy(block, &writer.low, 8);
+	std::memcpy(block + 8, &writer.high, 8);
+}
+
+} // namespace
+
+uint32_t GetBytesPerBlock(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+		return 8;
+
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return 16;
+
+	default:
+		return 0;
+	}
+}
+
+bool GetBlockEncoder(DXGI_FORMAT format, BlockEncoderInfo* outInfo)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+		*outInfo = { &EncodeBC1Block, 4, 8 };
+		return true;
+
+	case DXGI_FORMAT_BC4_UNORM:
+		*outInfo = { &EncodeBC4Block, 1, 8 };
+		return true;
+
+	case DXGI_FORMAT_BC5_UNORM:
+		*outInfo = { &EncodeBC5Block, 2, 16 };
+		return true;
+
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		*outInfo = { &EncodeBC7Block, 4, 16 };
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+void EncodeTileSlices(
+	const BlockEncoderInfo& encoder,
+	const std::byte* source,
+	std::byte* destination,
+	const MipTileShape& shape,
+	uint32_t firstSlice,
+	uint32_t sliceCount)
+{
+	const uint32_t bytesPerTexel = encoder.sourceBytesPerTexel;
+	const uint32_t blocksWide = shape.width / 4;
+	const uint32_t blocksHigh = shape.height / 4;
+	const size_t sourceRowPitch = static_cast<size_t>(shape.width) * bytesPerTexel;
+	const size_t sourceSlicePitch = sourceRowPitch * shape.height;
+	const size_t blockRowPitch = static_cast<size_t>(blocksWide) * encoder.bytesPerBlock;
+	const size_t blockSlicePitch = blockRowPitch * blocksHigh;
+	const size_t texelRowBytes = 4 * static_cast<size_t>(bytesPerTexel);
+
+	std::byte texels[16 * 4];
+	for (uint32_t z = firstSlice; z < firstSlice + sliceCount; ++z) {
+		const std::byte* sourceSlice = source + z * sourceSlicePitch;
+		std::byte* blockSlice = destination + z * blockSlicePitch;
+
+		for (uint32_t by = 0; by < blocksHigh; ++by) {
+			const std::byte* sourceRows = sourceSlice + static_cast<size_t>(by) * 4 * sourceRowPitch;
+			std::byte* blockRow = blockSlice + by * blockRowPitch;
+
+			for (uint32_t bx = 0; bx < blocksWide; ++bx) {
+				const std::byte* sourceBlock = sourceRows + bx * texelRowBytes;
+				for (uint32_t row = 0; row < 4; ++row) {
+					std::memcpy(texels + row * texelRowBytes, sourceBlock + row * sourceRowPitch, texelRowBytes);
+				}
+				encoder.kernel(texels, blockRow + static_cast<size_t>(bx) * encoder.bytesPerBlock);
+			}
+		}
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <dxgiformat.h>
+#include "MipKernels.h"
+
+// Bytes per 4x4 block for the BC formats volumes can use (BC1, BC4, BC5,
+// BC7 and their typeless/sRGB/signed variants), 0 for anything else.
+uint32_t GetBytesPerBlock(DXGI_FORMAT format);
+
+inline bool IsBlockCompressed(DXGI_FORMAT format)
+{
+	return GetBytesPerBlock(format) != 0;
+}
+
+// Encodes one 4x4 block. texels holds the 16 source texels in row order.
+using BlockEncodeKernel = void(*)(const std::byte* texels, std::byte* block);
+
+struct BlockEncoderInfo {
+	BlockEncodeKernel kernel;
+	uint32_t sourceBytesPerTexel;  // RGBA8 for BC1/BC7, R8 for BC4, R8G8 for BC5
+	uint32_t bytesPerBlock;
+};
+
+// Returns false for formats without an encoder (typeless and signed
+// variants can still be uploaded pre-compressed).
+bool GetBlockEncoder(DXGI_FORMAT format, BlockEncoderInfo* outInfo);
+
+// Encodes z-slices [firstSlice, firstSlice + sliceCount) of one linear tile
+// of uncompressed texels. source and destination point at the start of the
+// tile; the output is the tile's linear block layout (block x fastest, then
+// block y, then slice). Slices are independent, so callers split a tile
+// across threads by slice.
+void EncodeTileSlices(
+	const BlockEncoderInfo& encoder,
+	const std::byte* source,
+	std::byte* destination,
+	const MipTileShape& shape,
+	uint32_t firstSlice,
+	uint32_t sliceCount);
@@ -0,0 +1,167 @@
+#include "pch.h"
+#include "CallReplay.h"
+#include "RenderingPlugin.h"
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Deterministic filler for traces without payloads: the same hash always
+// produces the same bytes, so replays of one trace upload identical data
+void FillStandInPayload(uint64_t seed, std::byte* destination, size_t size)
+{
+	uint64_t state = seed | 1;
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		memcpy(destination + i, &state, 8);
+	}
+	for (; i < size; ++i) {
+		destination[i] = static_cast<std::byte>(state >> (8 * (i & 7)));
+	}
+}
+
+} // namespace
+
+uint64_t PluginReplayTarget::CreateVolume(const CallRecord& call)
+{
+	return m_plugin->CreateVolumetricResource(
+		call.width, call.height, call.depth,
+		call.useMipmaps, call.mipCount,
+		static_cast<DXGI_FORMAT>(call.format), call.flags);
+}
+
+bool PluginReplayTarget::DestroyVolume(uint64_t volume)
+{
+	return m_plugin->DestroyVolumetricResource(volume);
+}
+
+bool PluginReplayTarget::UploadTile(uint64_t volume, const CallRecord& call, const std::byte* payload)
+{
+	std::shared_ptr<ReservedResource> resource = m_plugin->PinVolumetricResource(volume);
+	if (!resource) {
+		return false;
+	}
+	// The upload paths take a mutable span but only read it
+	std::span<std::byte> data(const_cast<std::byte*>(payload), static_cast<size_t>(call.payloadSize));
+	return m_plugin->UploadDataToTile(resource.get(), call.subresource, call.x, call.y, call.z, data);
+}
+
+bool PluginReplayTarget::UploadTileBox(uint64_t volume, const CallRecord& call, const std::byte* payload)
+{
+	std::shared_ptr<ReservedResource> resource = m_plugin->PinVolumetricResource(volume);
+	if (!resource) {
+		return false;
+	}
+	TileBox box;
+	box.subResource = call.subresource;
+	box.startX = call.x;
+	box.startY = call.y;
+	box.startZ = call.z;
+	box.width = call.width;
+	box.height = call.height;
+	box.depth = call.depth;
+	std::span<std::byte> data(const_cast<std::byte*>(payload), static_cast<size_t>(call.payloadSize));
+	return m_plugin->UploadDataToTileBox(resource.get(), box, data);
+}
+
+bool PluginReplayTarget::UnmapTile(uint64_t volume, const CallRecord& call)
+{
+	std::shared_ptr<ReservedResource> resource = m_plugin->PinVolumetricResource(volume);
+	return resource && m_plugin->UnmapDataFromTile(resource.get(), call.subresource, call.x, call.y, call.z);
+}
+
+bool ReplayCallTrace(
+	CallTraceReader& reader,
+	ICallReplayTarget& target,
+	const CallReplayOptions& options,
+	CallReplayStats* outStats,
+	std::string* outError)
+{
+	*outStats = {};
+	outError->clear();
+	std::unordered_map<uint64_t, uint64_t> liveHandles;
+	std::vector<std::byte> standIn;
+	uint64_t standInSeed = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+	CallRecord call;
+	while (reader.Next(call, outError)) {
+		if (options.honorTimestamps) {
+			std::this_thread::sleep_until(start + std::chrono::nanoseconds(call.timestampNs));
+		}
+
+		auto found = liveHandles.find(call.volume);
+		const uint64_t volume = found != liveHandles.end() ? found->second : 0;
+
+		const std::byte* payload = call.payload;
+		if (!payload && call.payloadSize > 0) {
+			// Regenerate only when the size or hash changes; runs of
+			// same-sized hashless uploads reuse one buffer
+			const uint64_t seed = call.payloadHash;
+			if (standIn.size() != call.payloadSize || standInSeed != seed) {
+				standIn.resize(static_cast<size_t>(call.payloadSize));
+				FillStandInPayload(seed, standIn.data(), standIn.size());
+				standInSeed = seed;
+			}
+			payload = standIn.data();
+		}
+
+		bool succeeded = false;
+		switch (call.op) {
+		case CallOp::CreateVolume: {
+			const uint64_t created = target.CreateVolume(call);
+			succeeded = created != 0;
+			if (succeeded && call.volume != 0) {
+				liveHandles[call.volume] = created;
+			}
+			else if (succeeded) {
+				// The recording failed where the replay did not; nothing
+				// refers to this volume, so release it again
+				target.DestroyVolume(created);
+			}
+			break;
+		}
+		case CallOp::DestroyVolume:
+			succeeded = target.DestroyVolume(volume);
+			if (found != liveHandles.end()) {
+				liveHandles.erase(found);
+			}
+			break;
+		case CallOp::UploadTile:
+			succeeded = target.UploadTile(volume, call, payload);
+			break;
+		case CallOp::UploadTileBox:
+			succeeded = target.UploadTileBox(volume, call, payload);
+			break;
+		case CallOp::UnmapTile:
+			succeeded = target.UnmapTile(volume, call);
+			break;
+		}
+
+		outStats->calls++;
+		if (!succeeded) {
+			outStats->failedCalls++;
+		}
+		else if (call.op == CallOp::UploadTile || call.op == CallOp::UploadTileBox) {
+			outStats->bytesUploaded += call.payloadSize;
+		}
+		if (succeeded != call.succeeded) {
+			outStats->resultMismatches++;
+		}
+	}
+
+	// Volumes the recording never destroyed
+	for (const auto& [recorded, live] : liveHandles) {
+		target.DestroyVolume(live);
+	}
+
+	outStats->elapsedNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - start).count());
+	return outError->empty();
+}
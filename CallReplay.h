@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "CallTrace.h"
+
+// Whatever a trace is replayed against: the live plugin, or a CPU
+// stand-in that models the device for offline runs. Handles are the
+// target's own; the replay maps recorded handles onto them.
+class ICallReplayTarget {
+public:
+	virtual ~ICallReplayTarget() = default;
+
+	// Returns 0 on failure
+	virtual uint64_t CreateVolume(const CallRecord& call) = 0;
+	virtual bool DestroyVolume(uint64_t volume) = 0;
+
+	// payload holds call.payloadSize bytes: the recorded payload, or a
+	// stand-in when the trace only kept sizes or hashes
+	virtual bool UploadTile(uint64_t volume, const CallRecord& call, const std::byte* payload) = 0;
+	virtual bool UploadTileBox(uint64_t volume, const CallRecord& call, const std::byte* payload) = 0;
+	virtual bool UnmapTile(uint64_t volume, const CallRecord& call) = 0;
+};
+
+class RenderingPlugin;
+
+// Replays into RenderingPlugin directly, so replayed calls are not recorded.
+// The plugin may run on the device or on SoftwareBackend.
+class PluginReplayTarget : public ICallReplayTarget {
+public:
+	explicit PluginReplayTarget(RenderingPlugin* plugin) : m_plugin(plugin) {}
+
+	uint64_t CreateVolume(const CallRecord& call) override;
+	bool DestroyVolume(uint64_t volume) override;
+	bool UploadTile(uint64_t volume, const CallRecord& call, const std::byte* payload) override;
+	bool UploadTileBox(uint64_t volume, const CallRecord& call, const std::byte* payload) override;
+	bool UnmapTile(uint64_t volume, const CallRecord& call) override;
+
+private:
+	RenderingPlugin* m_plugin;
+};
+
+struct CallReplayOptions {
+	// Sleep until each call's recorded start time; otherwise replay
+	// back to back, as fast as the target allows
+	bool honorTimestamps = false;
+};
+
+struct CallReplayStats {
+	uint64_t calls;
+	uint64_t failedCalls;       // Calls the target failed
+	uint64_t resultMismatches;  // Calls whose result differs from the recording
+	uint64_t bytesUploaded;     // Payload bytes passed to successful uploads
+	uint64_t elapsedNs;
+};
+
+// Runs every call in the trace through the target, in recorded order. A
+// call on a volume whose recorded creation failed or was not replayed is
+// passed handle 0. Returns false with outError set if the trace cannot be
+// read; calls up to that point stay in outStats.
+bool ReplayCallTrace(
+	CallTraceReader& reader,
+	ICallReplayTarget& target,
+	const CallReplayOptions& options,
+	CallReplayStats* outStats,
+	std::string* outError);
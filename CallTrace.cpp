@@ -0,0 +1,387 @@
+#include "pch.h"
+#include "CallTrace.h"
+#include <bit>
+#include <cstring>
+#include <filesystem>
+
+namespace {
+
+std::filesystem::path PathFromUtf8(const std::string& utf8Path)
+{
+	return std::filesystem::path(std::u8string(utf8Path.begin(), utf8Path.end()));
+}
+
+constexpr uint8_t RECORD_FLAG_SUCCEEDED = 0x1;
+constexpr uint8_t RECORD_FLAG_USE_MIPMAPS = 0x2;
+
+bool IsUpload(CallOp op)
+{
+	return op == CallOp::UploadTile || op == CallOp::UploadTileBox;
+}
+
+uint64_t MixHash(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDull;
+	h ^= h >> 33;
+	h *= 0xC4CEB9FE1A85EC53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+} // namespace
+
+uint64_t HashCallPayload(const std::byte* data, size_t size)
+{
+	constexpr uint64_t K1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64_t K2 = 0xC2B2AE3D27D4EB4Full;
+
+	// Four independent lanes keep the multiplies from serializing
+	uint64_t lanes[4] = { K1, K2, ~K1, ~K2 };
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32) {
+		for (int lane = 0; lane < 4; ++lane) {
+			uint64_t word;
+			memcpy(&word, data + i + 8 * lane, 8);
+			lanes[lane] = std::rotl(lanes[lane] ^ (word * K1), 31) * K2;
+		}
+	}
+
+	uint64_t h = K2 ^ (static_cast<uint64_t>(size) * K1);
+	for (int lane = 0; lane < 4; ++lane) {
+		h = std::rotl(h ^ MixHash(lanes[lane]), 27) * K1;
+	}
+	for (; i + 8 <= size; i += 8) {
+		uint64_t word;
+		memcpy(&word, data + i, 8);
+		h = std::rotl(h ^ (word * K1), 31) * K2;
+	}
+	if (i < size) {
+		uint64_t tail = 0;
+		memcpy(&tail, data + i, size - i);
+		h = std::rotl(h ^ (tail * K1), 31) * K2;
+	}
+	return MixHash(h);
+}
+
+// ---- Writer ----
+
+std::unique_ptr<CallTraceWriter> CallTraceWriter::Create(
+	const std::string& utf8Path,
+	CallPayloadMode payloadMode,
+	std::string* outError)
+{
+	if (payloadMode > CallPayloadMode::Full) {
+		*outError = "unknown payload mode";
+		return nullptr;
+	}
+
+	std::unique_ptr<CallTraceWriter> writer(new CallTraceWriter());
+	writer->m_file.open(PathFromUtf8(utf8Path), std::ios::binary | std::ios::trunc);
+	if (!writer->m_file) {
+		*outError = "cannot create file";
+		return nullptr;
+	}
+	writer->m_payloadMode = payloadMode;
+
+	CallTraceHeader header = {};
+	header.magic = CALL_TRACE_MAGIC;
+	header.version = CALL_TRACE_VERSION;
+	header.payloadMode = static_cast<uint32_t>(payloadMode);
+	writer->m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (!writer->m_file) {
+		*outError = "cannot write header";
+		return nullptr;
+	}
+
+	writer->m_buffer.reserve(FLUSH_THRESHOLD);
+	return writer;
+}
+
+void CallTraceWriter::PutVarint(uint64_t value)
+{
+	while (value >= 0x80) {
+		m_buffer.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	m_buffer.push_back(static_cast<uint8_t>(value));
+}
+
+void CallTraceWriter::Append(const CallRecord& record)
+{
+	uint8_t flags = 0;
+	if (record.succeeded) flags |= RECORD_FLAG_SUCCEEDED;
+	if (record.useMipmaps) flags |= RECORD_FLAG_USE_MIPMAPS;
+
+	m_buffer.push_back(static_cast<uint8_t>(record.op));
+	m_buffer.push_back(flags);
+	PutVarint(record.timestampNs);
+	PutVarint(record.volume);
+
+	switch (record.op) {
+	case CallOp::CreateVolume:
+		PutVarint(record.width);
+		PutVarint(record.height);
+		PutVarint(record.depth);
+		PutVarint(record.mipCount);
+		PutVarint(record.format);
+		PutVarint(record.flags);
+		break;
+	case CallOp::DestroyVolume:
+		break;
+	case CallOp::UploadTile:
+	case CallOp::UnmapTile:
+		PutVarint(record.subresource);
+		PutVarint(record.x);
+		PutVarint(record.y);
+		PutVarint(record.z);
+		break;
+	case CallOp::UploadTileBox:
+		PutVarint(record.subresource);
+		PutVarint(record.x);
+		PutVarint(record.y);
+		PutVarint(record.z);
+		PutVarint(record.width);
+		PutVarint(record.height);
+		PutVarint(record.depth);
+		break;
+	}
+
+	if (IsUpload(record.op)) {
+		PutVarint(record.payloadSize);
+		if (m_payloadMode == CallPayloadMode::Hash) {
+			const size_t at = m_buffer.size();
+			m_buffer.resize(at + sizeof(uint64_t));
+			memcpy(m_buffer.data() + at, &record.payloadHash, sizeof(uint64_t));
+		}
+		else if (m_payloadMode == CallPayloadMode::Full && record.payloadSize > 0) {
+			// Large payloads skip the buffer
+			m_file.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+			m_buffer.clear();
+			m_file.write(reinterpret_cast<const char*>(record.payload), static_cast<std::streamsize>(record.payloadSize));
+		}
+	}
+
+	if (m_buffer.size() >= FLUSH_THRESHOLD) {
+		m_file.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+		m_buffer.clear();
+	}
+}
+
+bool CallTraceWriter::Flush(std::string* outError)
+{
+	m_file.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+	m_buffer.clear();
+	m_file.flush();
+	if (!m_file) {
+		*outError = "write failed";
+		return false;
+	}
+	return true;
+}
+
+// ---- Reader ----
+
+std::unique_ptr<CallTraceReader> CallTraceReader::Open(const std::string& utf8Path, std::string* outError)
+{
+	std::unique_ptr<CallTraceReader> reader(new CallTraceReader());
+	reader->m_file.open(PathFromUtf8(utf8Path), std::ios::binary);
+	if (!reader->m_file) {
+		*outError = "cannot open file";
+		return nullptr;
+	}
+
+	CallTraceHeader header = {};
+	reader->m_file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	if (!reader->m_file) {
+		*outError = "file is smaller than the trace header";
+		return nullptr;
+	}
+	if (header.magic != CALL_TRACE_MAGIC) {
+		*outError = "not a call trace";
+		return nullptr;
+	}
+	if (header.version != CALL_TRACE_VERSION) {
+		*outError = "unsupported trace version";
+		return nullptr;
+	}
+	if (header.payloadMode > static_cast<uint32_t>(CallPayloadMode::Full)) {
+		*outError = "unknown payload mode";
+		return nullptr;
+	}
+
+	reader->m_payloadMode = static_cast<CallPayloadMode>(header.payloadMode);
+	return reader;
+}
+
+bool CallTraceReader::GetVarint(uint64_t* outValue)
+{
+	uint64_t value = 0;
+	for (uint32_t shift = 0; shift < 64; shift += 7) {
+		const int byte = m_file.get();
+		if (byte == std::char_traits<char>::eof()) {
+			return false;
+		}
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			*outValue = value;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool CallTraceReader::GetVarint32(uint32_t* outValue)
+{
+	uint64_t value;
+	if (!GetVarint(&value) || value > UINT32_MAX) {
+		return false;
+	}
+	*outValue = static_cast<uint32_t>(value);
+	return true;
+}
+
+bool CallTraceReader::Next(CallRecord& outRecord, std::string* outError)
+{
+	const int op = m_file.get();
+	if (op == std::char_traits<char>::eof()) {
+		return false;
+	}
+	if (op < static_cast<int>(CallOp::CreateVolume) || op > static_cast<int>(CallOp::UnmapTile)) {
+		*outError = "unknown call op";
+		return false;
+	}
+
+	const int flags = m_file.get();
+	CallRecord record;
+	record.op = static_cast<CallOp>(op);
+	record.succeeded = (flags & RECORD_FLAG_SUCCEEDED) != 0;
+	record.useMipmaps = (flags & RECORD_FLAG_USE_MIPMAPS) != 0;
+
+	bool ok = flags != std::char_traits<char>::eof()
+		&& GetVarint(&record.timestampNs)
+		&& GetVarint(&record.volume);
+
+	switch (record.op) {
+	case CallOp::CreateVolume:
+		ok = ok && GetVarint32(&record.width) && GetVarint32(&record.height) && GetVarint32(&record.depth)
+			&& GetVarint32(&record.mipCount) && GetVarint32(&record.format) && GetVarint32(&record.flags);
+		break;
+	case CallOp::DestroyVolume:
+		break;
+	case CallOp::UploadTile:
+	case CallOp::UnmapTile:
+		ok = ok && GetVarint32(&record.subresource)
+			&& GetVarint32(&record.x) && GetVarint32(&record.y) && GetVarint32(&record.z);
+		break;
+	case CallOp::UploadTileBox:
+		ok = ok && GetVarint32(&record.subresource)
+			&& GetVarint32(&record.x) && GetVarint32(&record.y) && GetVarint32(&record.z)
+			&& GetVarint32(&record.width) && GetVarint32(&record.height) && GetVarint32(&record.depth);
+		break;
+	}
+
+	if (ok && IsUpload(record.op)) {
+		ok = GetVarint(&record.payloadSize);
+		if (ok && m_payloadMode == CallPayloadMode::Hash) {
+			m_file.read(reinterpret_cast<char*>(&record.payloadHash), sizeof(uint64_t));
+			ok = static_cast<bool>(m_file);
+		}
+		else if (ok && m_payloadMode == CallPayloadMode::Full) {
+			// A corrupt size would otherwise allocate without bound
+			constexpr uint64_t MAX_PAYLOAD = 1ull << 32;
+			ok = record.payloadSize <= MAX_PAYLOAD;
+			if (ok) {
+				m_payload.resize(static_cast<size_t>(record.payloadSize));
+				m_file.read(reinterpret_cast<char*>(m_payload.data()), static_cast<std::streamsize>(record.payloadSize));
+				ok = static_cast<bool>(m_file);
+				record.payload = m_payload.data();
+			}
+		}
+	}
+
+	if (!ok) {
+		*outError = "truncated or malformed record";
+		return false;
+	}
+
+	outRecord = record;
+	return true;
+}
+
+// ---- Recorder ----
+
+bool CallRecorder::Start(const std::string& utf8Path, CallPayloadMode payloadMode, std::string* outError)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_writer) {
+		*outError = "already recording";
+		return false;
+	}
+
+	m_writer = CallTraceWriter::Create(utf8Path, payloadMode, outError);
+	if (!m_writer) {
+		return false;
+	}
+
+	m_payloadMode.store(static_cast<uint32_t>(payloadMode), std::memory_order_relaxed);
+	m_originNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+	m_recording.store(true, std::memory_order_release);
+	return true;
+}
+
+bool CallRecorder::Stop(std::string* outError)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_recording.store(false, std::memory_order_relaxed);
+	if (!m_writer) {
+		*outError = "not recording";
+		return false;
+	}
+
+	const bool flushed = m_writer->Flush(outError);
+	m_writer.reset();
+	return flushed;
+}
+
+uint64_t CallRecorder::BeginCall() const
+{
+	if (!m_recording.load(std::memory_order_acquire)) {
+		return 0;
+	}
+
+	const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+	const int64_t origin = m_originNs.load(std::memory_order_relaxed);
+	return now > origin ? static_cast<uint64_t>(now - origin) : 0;
+}
+
+void CallRecorder::Record(CallRecord record)
+{
+	if (!m_recording.load(std::memory_order_acquire)) {
+		return;
+	}
+
+	const bool upload = IsUpload(record.op);
+	if (upload && !record.payload) {
+		// A payload that was not passed in is recorded as empty
+		record.payloadSize = 0;
+	}
+
+	bool hashed = false;
+	if (upload && m_payloadMode.load(std::memory_order_relaxed) == static_cast<uint32_t>(CallPayloadMode::Hash)) {
+		record.payloadHash = HashCallPayload(record.payload, static_cast<size_t>(record.payloadSize));
+		hashed = true;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_writer) {
+		return;
+	}
+	// Recording may have restarted in another mode since the check above
+	if (upload && !hashed && m_writer->PayloadMode() == CallPayloadMode::Hash) {
+		record.payloadHash = HashCallPayload(record.payload, static_cast<size_t>(record.payloadSize));
+	}
+	m_writer->Append(record);
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Binary log of exported API calls, for replaying production streaming
+// sessions offline.
+//
+//   [CallTraceHeader]
+//   [records]  one per call, in the order the calls returned:
+//              op (1 byte), flags (1 byte), then LEB128 varints: timestamp
+//              in ns since recording started (taken when the call began),
+//              then the op's fields (see CallTraceWriter::Append). Uploads
+//              end with the payload size and, depending on the payload
+//              mode, an 8-byte hash or the payload itself.
+//
+// All fields are little-endian.
+constexpr uint32_t CALL_TRACE_MAGIC = 0x54435653; // "SVCT"
+constexpr uint32_t CALL_TRACE_VERSION = 1;
+
+enum class CallPayloadMode : uint32_t {
+	None = 0,  // Payload sizes only
+	Hash = 1,  // Sizes plus a 64-bit hash of each payload
+	Full = 2   // Every payload byte
+};
+
+struct CallTraceHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t payloadMode;  // CallPayloadMode
+	uint32_t reserved;
+};
+static_assert(sizeof(CallTraceHeader) == 16, "call trace header is 16 bytes");
+
+enum class CallOp : uint8_t {
+	CreateVolume = 1,
+	DestroyVolume = 2,
+	UploadTile = 3,
+	UploadTileBox = 4,
+	UnmapTile = 5
+};
+
+// One call. Fields an op does not use stay zero.
+struct CallRecord {
+	CallOp op = CallOp::CreateVolume;
+	bool succeeded = false;
+	uint64_t timestampNs = 0;
+
+	// The handle passed in, or the one CreateVolume returned (0 on failure)
+	uint64_t volume = 0;
+
+	// CreateVolume: the volume size; uploads and unmaps: the tile or box
+	uint32_t subresource = 0;
+	uint32_t x = 0, y = 0, z = 0;
+	uint32_t width = 0, height = 0, depth = 0;
+
+	// CreateVolume only
+	bool useMipmaps = false;
+	uint32_t mipCount = 0;
+	uint32_t format = 0;
+	uint32_t flags = 0;
+
+	// Uploads only. payload is set for CallPayloadMode::Full; a reader's
+	// payload stays valid until its next Next call.
+	uint64_t payloadSize = 0;
+	uint64_t payloadHash = 0;
+	const std::byte* payload = nullptr;
+};
+
+// 64-bit hash of a payload, 32 bytes per step
+uint64_t HashCallPayload(const std::byte* data, size_t size);
+
+// Streams records to a new trace file. Not thread-safe; CallRecorder
+// serializes callers.
+class CallTraceWriter {
+public:
+	// Returns nullptr and sets outError if the file cannot be created
+	static std::unique_ptr<CallTraceWriter> Create(
+		const std::string& utf8Path,
+		CallPayloadMode payloadMode,
+		std::string* outError);
+
+	CallPayloadMode PayloadMode() const { return m_payloadMode; }
+
+	// Encodes the record per the payload mode: uploads need payloadHash
+	// set under Hash and payload under Full
+	void Append(const CallRecord& record);
+
+	// Flushes buffered records; the file holds every record appended so far
+	// once this succeeds
+	bool Flush(std::string* outError);
+
+private:
+	CallTraceWriter() = default;
+
+	void PutVarint(uint64_t value);
+
+	// Records collect here and go to disk in large writes
+	static constexpr size_t FLUSH_THRESHOLD = 1 << 20;
+
+	std::ofstream m_file;
+	CallPayloadMode m_payloadMode = CallPayloadMode::None;
+	std::vector<uint8_t> m_buffer;
+};
+
+// Reads a trace front to back without loading it whole, so traces with
+// full payloads can be larger than memory.
+class CallTraceReader {
+public:
+	// Returns nullptr and sets outError if the file is missing or its
+	// header is malformed
+	static std::unique_ptr<CallTraceReader> Open(const std::string& utf8Path, std::string* outError);
+
+	CallPayloadMode PayloadMode() const { return m_payloadMode; }
+
+	// False at the end of the trace, or with outError set if the trace is
+	// truncated or malformed
+	bool Next(CallRecord& outRecord, std::string* outError);
+
+private:
+	CallTraceReader() = default;
+
+	bool GetVarint(uint64_t* outValue);
+	bool GetVarint32(uint32_t* outValue);
+
+	std::ifstream m_file;
+	CallPayloadMode m_payloadMode = CallPayloadMode::None;
+	std::vector<std::byte> m_payload;
+};
+
+// Thread-safe front for the plugin's exports. While idle, BeginCall and
+// Record cost one relaxed load each.
+class CallRecorder {
+public:
+	bool Start(const std::string& utf8Path, CallPayloadMode payloadMode, std::string* outError);
+
+	// Flushes and closes the trace; false if it was not recording or the
+	// final flush failed
+	bool Stop(std::string* outError);
+
+	bool IsRecording() const { return m_recording.load(std::memory_order_relaxed); }
+
+	// Timestamp for a call about to start; pass it back in the record
+	uint64_t BeginCall() const;
+
+	// Hashes the payload if the mode asks for it, outside the lock. Drops
+	// the record if recording stopped since BeginCall.
+	void Record(CallRecord record);
+
+private:
+	std::atomic<bool> m_recording{ false };
+	std::atomic<uint32_t> m_payloadMode{ 0 };
+	std::atomic<int64_t> m_originNs{ 0 };  // steady_clock ticks in ns
+	std::unique_ptr<CallTraceWriter> m_writer;
+	std::mutex m_mutex;
+};
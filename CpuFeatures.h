@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SPARSE_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+#define SPARSE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// MSVC accepts any intrinsic without /arch flags; GCC and Clang need the
+// instruction set enabled per function for the runtime-dispatched paths.
+#if defined(__GNUC__) || defined(__clang__)
+#define SPARSE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SPARSE_TARGET(isa)
+#endif
+
+// Runtime CPU feature queries, evaluated once. Kernels compiled for an
+// extended instruction set must only be selected when these return true.
+namespace CpuFeatures {
+
+#if defined(SPARSE_X86)
+namespace Detail {
+
+inline void QueryCpuid(int leaf, int subleaf, int regs[4])
+{
+#if defined(_MSC_VER)
+	__cpuidex(regs, leaf, subleaf);
+#else
+	unsigned int a, b, c, d;
+	__cpuid_count(leaf, subleaf, a, b, c, d);
+	regs[0] = static_cast<int>(a);
+	regs[1] = static_cast<int>(b);
+	regs[2] = static_cast<int>(c);
+	regs[3] = static_cast<int>(d);
+#endif
+}
+
+struct Flags {
+	bool ssse3 = false;
+	bool sse41 = false;
+	bool f16c = false;
+	bool avx2 = false;
+
+	Flags()
+	{
+		int regs[4] = {};
+		QueryCpuid(0, 0, regs);
+		const int maxLeaf = regs[0];
+
+		QueryCpuid(1, 0, regs);
+		ssse3 = (regs[2] & (1 << 9)) != 0;
+		sse41 = (regs[2] & (1 << 19)) != 0;
+		const bool avx = (regs[2] & (1 << 28)) != 0;
+		const bool osxsave = (regs[2] & (1 << 27)) != 0;
+		f16c = avx && osxsave && (regs[2] & (1 << 29)) != 0;
+
+		if (maxLeaf >= 7 && avx && osxsave) {
+			QueryCpuid(7, 0, regs);
+			avx2 = (regs[1] & (1 << 5)) != 0;
+		}
+	}
+};
+
+inline const Flags& Get()
+{
+	static const Flags flags;
+	return flags;
+}
+
+} // namespace Detail
+
+inline bool HasSSSE3() { return Detail::Get().ssse3; }
+inline bool HasSSE41() { return Detail::Get().sse41; }
+inline bool HasF16C() { return Detail::Get().f16c; }
+inline bool HasAVX2() { return Detail::Get().avx2; }
+#else
+inline bool HasSSSE3() { return false; }
+inline bool HasSSE41() { return false; }
+inline bool HasF16C() { return false; }
+inline bool HasAVX2() { return false; }
+#endif
+
+} // namespace CpuFeatures
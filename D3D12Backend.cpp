@@ -0,0 +1,266 @@
+#include "pch.h"
+#include "D3D12Backend.h"
+#include "FixedHeap.h"
+#include "ReservedResource.h"
+#include <format>
+
+D3D12Backend::D3D12Backend(IUnityGraphicsD3D12v6* d3d12, IUnityLog* log)
+	: m_d3d12(d3d12), m_device(d3d12->GetDevice()), m_log(log)
+{
+}
+
+bool D3D12Backend::Initialize(UINT slotCount, UINT64 tileStagingBytes, UINT64 batchStagingBytes)
+{
+	HRESULT hr = m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence));
+	if (FAILED(hr) || !m_fence) {
+		UNITY_LOG_ERROR(m_log, "UploadDataToTile: CreateFence failed");
+		return false;
+	}
+
+	m_allocators.resize(slotCount);
+	for (UINT i = 0; i < slotCount; ++i) {
+		hr = m_device->CreateCommandAllocator(
+			D3D12_COMMAND_LIST_TYPE_DIRECT,
+			IID_PPV_ARGS(m_allocators[i].GetAddressOf())
+		);
+		if (FAILED(hr)) {
+			UNITY_LOG_ERROR(m_log, std::format("Failed to create command allocator {}: 0x{:08x}", i, hr).c_str());
+			return false;
+		}
+	}
+
+	return CreateStagingBuffers(StagingBuffer::Tile, slotCount, tileStagingBytes)
+		&& CreateStagingBuffers(StagingBuffer::Batch, slotCount, batchStagingBytes);
+}
+
+bool D3D12Backend::CreateStagingBuffers(StagingBuffer buffer, UINT slotCount, UINT64 sizeInBytes)
+{
+	const char* name = buffer == StagingBuffer::Tile ? "upload" : "batch upload";
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>>& resources = m_stagingBuffers[static_cast<UINT>(buffer)];
+	std::vector<std::byte*>& data = m_stagingData[static_cast<UINT>(buffer)];
+	resources.resize(slotCount);
+	data.assign(slotCount, nullptr);
+
+	D3D12_HEAP_PROPERTIES uploadHeapProps = {};
+	uploadHeapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+
+	D3D12_RESOURCE_DESC bufferDesc = {};
+	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	bufferDesc.Width = sizeInBytes;
+	bufferDesc.Height = 1;
+	bufferDesc.DepthOrArraySize = 1;
+	bufferDesc.MipLevels = 1;
+	bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+	bufferDesc.SampleDesc.Count = 1;
+	bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	for (UINT i = 0; i < slotCount; ++i) {
+		HRESULT hr = m_device->CreateCommittedResource(
+			&uploadHeapProps,
+			D3D12_HEAP_FLAG_NONE,
+			&bufferDesc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(&resources[i])
+		);
+
+		if (FAILED(hr)) {
+			UNITY_LOG_ERROR(m_log, std::format("Failed to create {} buffer {}: 0x{:08x}", name, i, hr).c_str());
+			return false;
+		}
+
+		D3D12_RANGE readRange = { 0, 0 };
+		void* mapped = nullptr;
+		hr = resources[i]->Map(0, &readRange, &mapped);
+		if (FAILED(hr) || !mapped) {
+			UNITY_LOG_ERROR(m_log, std::format("Failed to map {} buffer {}: 0x{:08x}", name, i, hr).c_str());
+			return false;
+		}
+		data[i] = static_cast<std::byte*>(mapped);
+	}
+
+	return true;
+}
+
+std::unique_ptr<IHeap> D3D12Backend::CreateTileHeap(UINT64 sizeInBytes)
+{
+	return std::make_unique<FixedHeap>(m_device, sizeInBytes);
+}
+
+std::unique_ptr<ReservedResource> D3D12Backend::CreateReservedResource(
+	UINT width, UINT height, UINT depth,
+	bool useMipMaps, UINT mipCount,
+	DXGI_FORMAT format,
+	D3D12_TEXTURE_LAYOUT layout)
+{
+	auto resource = std::make_unique<ReservedResource>(
+		width, height, depth,
+		useMipMaps, mipCount,
+		format, m_device, m_log,
+		layout);
+	if (!resource->D3D12Resource) {
+		return nullptr;
+	}
+	return resource;
+}
+
+void D3D12Backend::GetCopyableFootprints(
+	const D3D12_RESOURCE_DESC& desc,
+	UINT firstSubresource, UINT subresourceCount,
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT* outFootprints,
+	UINT* outRowCounts,
+	UINT64* outRowSizes,
+	UINT64* outTotalBytes)
+{
+	m_device->GetCopyableFootprints(
+		&desc,
+		firstSubresource, subresourceCount,
+		0,
+		outFootprints, outRowCounts, outRowSizes,
+		outTotalBytes);
+}
+
+std::byte* D3D12Backend::GetStagingMemory(StagingBuffer buffer, UINT slotIndex) const
+{
+	return m_stagingData[static_cast<UINT>(buffer)][slotIndex];
+}
+
+ID3D12Resource* D3D12Backend::GetStagingResource(StagingBuffer buffer, UINT slotIndex) const
+{
+	return m_stagingBuffers[static_cast<UINT>(buffer)][slotIndex].Get();
+}
+
+void D3D12Backend::UpdateTileMappings(
+	ReservedResource* resource,
+	UINT regionCount,
+	const D3D12_TILED_RESOURCE_COORDINATE* regionCoords,
+	const D3D12_TILE_REGION_SIZE* regionSizes,
+	IHeap* heap,
+	UINT rangeCount,
+	const D3D12_TILE_RANGE_FLAGS* rangeFlags,
+	const UINT* heapRangeStartOffsets,
+	const UINT* rangeTileCounts)
+{
+	m_d3d12->GetCommandQueue()->UpdateTileMappings(
+		resource->D3D12Resource.Get(),
+		regionCount,
+		regionCoords,
+		regionSizes,
+		heap ? heap->GetD3D12Heap() : nullptr,
+		rangeCount,
+		rangeFlags,
+		heapRangeStartOffsets,
+		rangeTileCounts,
+		D3D12_TILE_MAPPING_FLAG_NONE
+	);
+}
+
+bool D3D12Backend::ResetCommandList(ID3D12CommandAllocator* allocator)
+{
+	if (m_commandList) {
+		HRESULT hr = m_commandList->Reset(allocator, nullptr);
+		if (FAILED(hr)) {
+			UNITY_LOG_ERROR(m_log, std::format("Failed to reset command list: 0x{:08x}", hr).c_str());
+			return false;
+		}
+		return true;
+	}
+
+	// First time - create it
+	HRESULT hr = m_device->CreateCommandList(
+		0,
+		D3D12_COMMAND_LIST_TYPE_DIRECT,
+		allocator,
+		nullptr,
+		IID_PPV_ARGS(&m_commandList)
+	);
+
+	if (FAILED(hr)) {
+		UNITY_LOG_ERROR(m_log, std::format("Failed to create command list: 0x{:08x}", hr).c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool D3D12Backend::ExecuteCopies(const UploadSubmission* submissions, UINT allocatorSlot)
+{
+	if (!ResetCommandList(m_allocators[allocatorSlot].Get())) {
+		return false;
+	}
+
+	for (const UploadSubmission* s = submissions; s; s = s->next) {
+		ID3D12Resource* source = GetStagingResource(s->sourceBuffer, s->slotIndex);
+		if (s->footprintCount > 0) {
+			for (UINT i = 0; i < s->footprintCount; ++i) {
+				D3D12_TEXTURE_COPY_LOCATION dst = {};
+				dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+				if (s->footprintTarget) {
+					dst.pResource = s->footprintTarget;
+					dst.SubresourceIndex = 0;
+				}
+				else {
+					dst.pResource = s->resource->D3D12Resource.Get();
+					dst.SubresourceIndex = s->firstSubresource + i;
+				}
+
+				D3D12_TEXTURE_COPY_LOCATION src = {};
+				src.pResource = source;
+				src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+				src.PlacedFootprint = s->footprints[i];
+				src.PlacedFootprint.Offset += s->sourceOffset;
+
+				const UINT* offset = s->targetOffsets ? s->targetOffsets + 3 * i : nullptr;
+				m_commandList->CopyTextureRegion(&dst,
+					offset ? offset[0] : 0, offset ? offset[1] : 0, offset ? offset[2] : 0,
+					&src, nullptr);
+			}
+			continue;
+		}
+
+		m_commandList->CopyTiles(
+			s->resource->D3D12Resource.Get(),
+			&s->startCoord,
+			&s->regionSize,
+			source,
+			s->sourceOffset,
+			// Standard-swizzle payloads were swizzled while staging
+			s->resource->IsStandardSwizzle()
+				? D3D12_TILE_COPY_FLAG_NONE
+				: D3D12_TILE_COPY_FLAG_LINEAR_BUFFER_TO_SWIZZLED_TILED_RESOURCE
+		);
+	}
+
+	HRESULT hr = m_commandList->Close();
+	if (FAILED(hr)) {
+		UNITY_LOG_ERROR(m_log, "FlushSubmissionQueue: cmdList->Close failed");
+		return false;
+	}
+
+	ID3D12CommandList* lists[] = { m_commandList.Get() };
+	m_d3d12->GetCommandQueue()->ExecuteCommandLists(1, lists);
+	return true;
+}
+
+void D3D12Backend::ResetAllocator(UINT slotIndex)
+{
+	m_allocators[slotIndex]->Reset();
+}
+
+bool D3D12Backend::Signal(UINT64 fenceValue)
+{
+	return SUCCEEDED(m_d3d12->GetCommandQueue()->Signal(m_fence.Get(), fenceValue));
+}
+
+UINT64 D3D12Backend::GetCompletedFenceValue()
+{
+	return m_fence->GetCompletedValue();
+}
+
+void D3D12Backend::WaitForFence(UINT64 fenceValue)
+{
+	// A null event makes SetEventOnCompletion block until the fence is reached
+	if (m_fence->GetCompletedValue() < fenceValue) {
+		m_fence->SetEventOnCompletion(fenceValue, nullptr);
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <vector>
+#include "GpuBackend.h"
+#include "IUnityGraphicsD3D12.h"
+#include "IUnityLog.h"
+
+// Runs the upload pipeline on Unity's D3D12 device and command queue
+class D3D12Backend : public IGpuBackend {
+public:
+	D3D12Backend(IUnityGraphicsD3D12v6* d3d12, IUnityLog* log);
+
+	bool Initialize(UINT slotCount, UINT64 tileStagingBytes, UINT64 batchStagingBytes) override;
+
+	std::unique_ptr<IHeap> CreateTileHeap(UINT64 sizeInBytes) override;
+
+	std::unique_ptr<ReservedResource> CreateReservedResource(
+		UINT width, UINT height, UINT depth,
+		bool useMipMaps, UINT mipCount,
+		DXGI_FORMAT format,
+		D3D12_TEXTURE_LAYOUT layout) override;
+
+	void GetCopyableFootprints(
+		const D3D12_RESOURCE_DESC& desc,
+		UINT firstSubresource, UINT subresourceCount,
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT* outFootprints,
+		UINT* outRowCounts,
+		UINT64* outRowSizes,
+		UINT64* outTotalBytes) override;
+
+	std::byte* GetStagingMemory(StagingBuffer buffer, UINT slotIndex) const override;
+
+	void UpdateTileMappings(
+		ReservedResource* resource,
+		UINT regionCount,
+		const D3D12_TILED_RESOURCE_COORDINATE* regionCoords,
+		const D3D12_TILE_REGION_SIZE* regionSizes,
+		IHeap* heap,
+		UINT rangeCount,
+		const D3D12_TILE_RANGE_FLAGS* rangeFlags,
+		const UINT* heapRangeStartOffsets,
+		const UINT* rangeTileCounts) override;
+
+	bool ExecuteCopies(const UploadSubmission* submissions, UINT allocatorSlot) override;
+
+	void ResetAllocator(UINT slotIndex) override;
+
+	bool Signal(UINT64 fenceValue) override;
+	UINT64 GetCompletedFenceValue() override;
+	void WaitForFence(UINT64 fenceValue) override;
+
+	ID3D12Resource* GetStagingResource(StagingBuffer buffer, UINT slotIndex) const override;
+
+private:
+	bool CreateStagingBuffers(StagingBuffer buffer, UINT slotCount, UINT64 sizeInBytes);
+
+	// Resets the shared command list onto the allocator, creating it on
+	// first use
+	bool ResetCommandList(ID3D12CommandAllocator* allocator);
+
+	IUnityGraphicsD3D12v6* m_d3d12;
+	ID3D12Device* m_device;
+	IUnityLog* m_log;
+
+	Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
+	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_commandList;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> m_allocators;
+
+	// Indexed by StagingBuffer, then slot. Upload heaps stay mapped for
+	// their whole lifetime.
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_stagingBuffers[2];
+	std::vector<std::byte*> m_stagingData[2];
+};
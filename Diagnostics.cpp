@@ -2,6 +2,8 @@
 #include "Diagnostics.h"
 #include "IUnityGraphicsD3D12.h"
 #include <format>
+#include <algorithm>
+#include "TileSwizzle.h"
 
 namespace Diagnostics {
 
@@ -9,6 +11,10 @@ static constexpr UINT64 TILE_SIZE_BYTES = 65536;
 static constexpr UINT SMOKE_TEST_WIDTH = 64;
 static constexpr UINT SMOKE_TEST_HEIGHT = 64;
 static constexpr UINT SMOKE_TEST_DEPTH = 64;
+static constexpr UINT SMOKE_TEST_MIP_COUNT = 7;
+static constexpr UINT CHUNKED_TEST_WIDTH = 128;
+static constexpr UINT CHUNKED_TEST_HEIGHT = 128;
+static constexpr UINT CHUNKED_TEST_DEPTH = 64;
 
 DiagnosticResult CheckFeatureSupport(ID3D12Device* device, IUnityLog* log)
 {
@@ -140,6 +146,48 @@ DiagnosticResult CheckDeviceAndQueue(
         std::format("Device valid, command queue valid (type: {})", typeName) };
 }
 
+DiagnosticResult CheckSwizzleKernel(IUnityLog* /*log*/)
+{
+    // 64KB tile shapes for 1, 2, 4, 8 and 16 bytes per texel
+    struct Shape { UINT bytesPerTexel, width, height, depth; };
+    static constexpr Shape shapes[] = {
+        { 1, 64, 32, 32 }, { 2, 32, 32, 32 }, { 4, 32, 32, 16 },
+        { 8, 32, 16, 16 }, { 16, 16, 16, 16 },
+    };
+
+    std::vector<std::byte> linear(TILE_SIZE_BYTES);
+    std::vector<std::byte> fast(TILE_SIZE_BYTES);
+    std::vector<std::byte> reference(TILE_SIZE_BYTES);
+    std::vector<std::byte> roundTrip(TILE_SIZE_BYTES);
+    for (size_t i = 0; i < linear.size(); ++i)
+    {
+        linear[i] = static_cast<std::byte>((i * 131 + 7) & 0xFF);
+    }
+
+    for (const Shape& shape : shapes)
+    {
+        SwizzlePattern pattern = MakeMortonSwizzlePattern(
+            shape.bytesPerTexel, shape.width, shape.height, shape.depth);
+
+        SwizzleTile(linear.data(), fast.data(), pattern);
+        SwizzleTileReference(linear.data(), reference.data(), pattern);
+        if (fast != reference)
+        {
+            return { "Swizzle Kernel", false,
+                std::format("Swizzle mismatch at {} bytes/texel", shape.bytesPerTexel) };
+        }
+
+        UnswizzleTile(fast.data(), roundTrip.data(), pattern);
+        if (roundTrip != linear)
+        {
+            return { "Swizzle Kernel", false,
+                std::format("Unswizzle round trip failed at {} bytes/texel", shape.bytesPerTexel) };
+        }
+    }
+
+    return { "Swizzle Kernel", true, "Fast and reference swizzle agree for all texel sizes" };
+}
+
 std::vector<DiagnosticResult> RunStartupChecks(
     ID3D12Device* device,
     IHeap* heap,
@@ -149,12 +197,13 @@ std::vector<DiagnosticResult> RunStartupChecks(
     IUnityLog* log)
 {
     std::vector<DiagnosticResult> results;
-    results.reserve(4);
+    results.reserve(5);
 
     results.push_back(CheckDeviceAndQueue(device, graphicsD3D12, log));
     results.push_back(CheckFeatureSupport(device, log));
     results.push_back(CheckHeapIntegrity(heap, log));
     results.push_back(CheckUploadBuffers(uploadBuffers, uploadBufferCount, log));
+    results.push_back(CheckSwizzleKernel(log));
 
     return results;
 }
@@ -271,16 +320,132 @@ std::vector<DiagnosticResult> RunSmokeTest(
             std::format("Uploaded {} tiles ({}x{}x{} box) in one submission",
                 batchTileCount, boxW, boxH, boxD) });
 
-        // Unmap the batch tiles
-        for (UINT z = 0; z < boxD; ++z)
-            for (UINT y = 0; y < boxH; ++y)
-                for (UINT x = 0; x < boxW; ++x)
-                    ops.unmapTile(testResource, 0,
-                        1 + x, 0 + y, 0 + z);
+        // Unmap the batch tiles with a single box unmap
+        bool batchUnmapOk = ops.unmapTileBox(
+            testResource,
+            0,
+            1, 0, 0,
+            boxW, boxH, boxD);
+
+        if (!batchUnmapOk || testResource->IsTileMapped(0, 1, 0, 0))
+        {
+            results.push_back({ "Batch Unmap", false,
+                "UnmapTileBox failed for batch tiles" });
+            ops.destroyResource(testResource);
+            return results;
+        }
     }
 
     results.push_back({ "Batch Unmap", true,
-        "Unmapped all batch tiles" });
+        "Unmapped all batch tiles with one UnmapTileBox" });
+
+    // Chunked batch upload: a 4x4x4 box is larger than one 32-tile staging
+    // buffer and must be split into slabs by the plugin
+    {
+        ReservedResource* largeResource = ops.createResource(
+            CHUNKED_TEST_WIDTH, CHUNKED_TEST_HEIGHT, CHUNKED_TEST_DEPTH,
+            false, 1,
+            DXGI_FORMAT_R8G8B8A8_UNORM);
+
+        if (!largeResource)
+        {
+            results.push_back({ "Chunked Batch Upload", false,
+                "Failed to create chunked test resource" });
+            ops.destroyResource(testResource);
+            return results;
+        }
+
+        const SubresourceTilingInfo& grid =
+            largeResource->GetTilingInfo().subresourceTilingInfo[0];
+        UINT boxW = (std::min)(4u, grid.WidthInTiles);
+        UINT boxH = (std::min)(4u, grid.HeightInTiles);
+        UINT boxD = (std::min)(4u, grid.DepthInTiles);
+        UINT chunkedTileCount = boxW * boxH * boxD;
+
+        std::vector<std::byte> chunkedData(chunkedTileCount * TILE_SIZE_BYTES);
+        for (size_t i = 0; i < chunkedData.size(); ++i)
+            chunkedData[i] = static_cast<std::byte>((i + 2) & 0xFF);
+
+        bool chunkedOk = ops.uploadTileBox(
+            largeResource,
+            0,
+            0, 0, 0,
+            boxW, boxH, boxD,
+            chunkedData.data(),
+            static_cast<UINT>(chunkedData.size()));
+
+        ops.unmapTileBox(largeResource, 0, 0, 0, 0, boxW, boxH, boxD);
+        ops.destroyResource(largeResource);
+
+        if (!chunkedOk)
+        {
+            results.push_back({ "Chunked Batch Upload", false,
+                std::format("UploadDataToTileBox failed for {}x{}x{} box",
+                    boxW, boxH, boxD) });
+            ops.destroyResource(testResource);
+            return results;
+        }
+
+        results.push_back({ "Chunked Batch Upload", true,
+            std::format("Uploaded {} tiles ({}x{}x{} box) across staging slabs",
+                chunkedTileCount, boxW, boxH, boxD) });
+    }
+
+    // Packed mip tail: a full mip chain always ends in packed mips
+    {
+        ReservedResource* mippedResource = ops.createResource(
+            SMOKE_TEST_WIDTH, SMOKE_TEST_HEIGHT, SMOKE_TEST_DEPTH,
+            true, SMOKE_TEST_MIP_COUNT,
+            DXGI_FORMAT_R8G8B8A8_UNORM);
+
+        if (!mippedResource)
+        {
+            results.push_back({ "Packed Mip Upload", false,
+                "Failed to create mipmapped test resource" });
+            ops.destroyResource(testResource);
+            return results;
+        }
+
+        const ResourceTilingInfo& mipTiling = mippedResource->GetTilingInfo();
+        if (mipTiling.NumPackedMips == 0)
+        {
+            results.push_back({ "Packed Mip Upload", true,
+                "Skipped: device reports no packed mips" });
+        }
+        else
+        {
+            UINT64 packedSize = 0;
+            for (UINT mip = mipTiling.NumStandardMips; mip < mipTiling.SubresourceCount; ++mip)
+            {
+                packedSize += (UINT64)(std::max)(1u, SMOKE_TEST_WIDTH >> mip)
+                    * (std::max)(1u, SMOKE_TEST_HEIGHT >> mip)
+                    * (std::max)(1u, SMOKE_TEST_DEPTH >> mip) * 4;
+            }
+
+            std::vector<std::byte> packedData(packedSize, std::byte{ 0x7F });
+            bool packedOk = ops.uploadPackedMips(
+                mippedResource,
+                packedData.data(),
+                static_cast<UINT>(packedData.size()));
+
+            bool tailMapped = mippedResource->IsPackedMipTailMapped();
+            if (!packedOk || !tailMapped)
+            {
+                results.push_back({ "Packed Mip Upload", false,
+                    std::format("UploadPackedMips failed for {} packed mips ({} tiles)",
+                        mipTiling.NumPackedMips, mipTiling.NumTilesForPackedMips) });
+                ops.destroyResource(mippedResource);
+                ops.destroyResource(testResource);
+                return results;
+            }
+
+            results.push_back({ "Packed Mip Upload", true,
+                std::format("Mapped {} packed mips as {} tiles and uploaded {} bytes",
+                    mipTiling.NumPackedMips, mipTiling.NumTilesForPackedMips, packedSize) });
+        }
+
+        ops.destroyResource(mippedResource);
+    }
 
     // Clean up
     bool destroyOk = ops.destroyResource(testResource);
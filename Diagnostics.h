@@ -29,6 +29,9 @@ DiagnosticResult CheckUploadBuffers(
     UINT count,
     IUnityLog* log);
 
+// Compares the fast tile swizzler against the reference for every texel size
+DiagnosticResult CheckSwizzleKernel(IUnityLog* log);
+
 DiagnosticResult CheckDeviceAndQueue(
     ID3D12Device* device,
     IUnityGraphicsD3D12v6* graphicsD3D12,
@@ -50,6 +53,8 @@ struct SmokeTestOps {
     std::function<bool(ReservedResource*, UINT, UINT, UINT, UINT, void*, UINT)> uploadData;
     std::function<bool(ReservedResource*, UINT, UINT, UINT, UINT)> unmapTile;
     std::function<bool(ReservedResource*, UINT, UINT, UINT, UINT, UINT, UINT, UINT, void*, UINT)> uploadTileBox;
+    std::function<bool(ReservedResource*, UINT, UINT, UINT, UINT, UINT, UINT, UINT)> unmapTileBox;
+    std::function<bool(ReservedResource*, void*, UINT)> uploadPackedMips;
 };
 
 // Runs the full-pipeline smoke test using the provided callbacks
@@ -0,0 +1,229 @@
+#include "pch.h"
+#include "EventTracer.h"
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <string>
+
+namespace {
+	struct TraceEventInfo {
+		const char* name;
+		const char* category;
+		const char* argName;  // nullptr when the event has no argument
+		bool argIsTile;
+	};
+
+	constexpr TraceEventInfo EVENT_INFO[] = {
+		{ "Validate",          "pipeline", "tile",        true  },
+		{ "AcquireSlot",       "pipeline", nullptr,       false },
+		{ "StageFill",         "pipeline", "tile",        true  },
+		{ "MapTiles",          "pipeline", "tile",        true  },
+		{ "RecordCopy",        "pipeline", "submissions", false },
+		{ "Submit",            "pipeline", "tile",        true  },
+		{ "Unmap",             "pipeline", "tile",        true  },
+		{ "FenceWait",         "fence",    "fence",       false },
+		{ "FenceSignal",       "fence",    "fence",       false },
+		{ "FenceComplete",     "fence",    "fence",       false },
+		{ "AllocationFailure", "heap",     "tiles",       false },
+	};
+	static_assert(std::size(EVENT_INFO) == static_cast<size_t>(TraceEvent::Count));
+
+	// Tracers are told apart by id rather than address, so a thread's cached
+	// buffer is never reused by a tracer created where an old one lived
+	std::atomic<uint64_t> s_nextTracerId{ 1 };
+
+	// A thread's buffers for the last few tracers it wrote to, so threads
+	// shared by several plugin instances take no lock per event either
+	constexpr uint32_t CACHED_TRACERS = 4;
+
+	struct ThreadBufferCache {
+		struct Entry {
+			uint64_t tracerId = 0;
+			void* buffer = nullptr;
+		};
+		Entry entries[CACHED_TRACERS];
+		uint32_t next = 0;
+	};
+	thread_local ThreadBufferCache t_bufferCache;
+
+	// Chrome traces take microseconds; keep nanosecond precision
+	std::string FormatMicroseconds(uint64_t ns)
+	{
+		return std::format("{}.{:03}", ns / 1000, ns % 1000);
+	}
+}
+
+EventTracer::EventTracer()
+	: m_instanceId(s_nextTracerId.fetch_add(1, std::memory_order_relaxed)),
+	m_origin(std::chrono::steady_clock::now())
+{
+}
+
+uint64_t EventTracer::Now() const
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - m_origin).count());
+}
+
+void EventTracer::Complete(TraceEvent event, uint64_t startNs, uint64_t durationNs, uint64_t volume, uint64_t arg)
+{
+	Write(event, startNs, durationNs, volume, arg);
+}
+
+void EventTracer::Instant(TraceEvent event, uint64_t volume, uint64_t arg)
+{
+	// Instants carry no duration; UINT64_MAX marks them apart from zero-length phases
+	Write(event, Now(), UINT64_MAX, volume, arg);
+}
+
+EventTracer::ThreadBuffer* EventTracer::GetThreadBuffer()
+{
+	for (const ThreadBufferCache::Entry& entry : t_bufferCache.entries) {
+		if (entry.tracerId == m_instanceId) {
+			return static_cast<ThreadBuffer*>(entry.buffer);
+		}
+	}
+
+	// Evicted from the cache by other tracers, or this thread's first event:
+	// only the latter allocates
+	const std::thread::id self = std::this_thread::get_id();
+	std::lock_guard<std::mutex> lock(m_buffersMutex);
+	ThreadBuffer* buffer = nullptr;
+	for (const std::unique_ptr<ThreadBuffer>& existing : m_buffers) {
+		if (existing->owner == self) {
+			buffer = existing.get();
+			break;
+		}
+	}
+	if (!buffer && m_buffers.size() < MAX_THREADS) {
+		m_buffers.push_back(std::make_unique<ThreadBuffer>());
+		buffer = m_buffers.back().get();
+		buffer->owner = self;
+		buffer->threadIndex = static_cast<uint32_t>(m_buffers.size());
+	}
+
+	// A thread past the limit caches nullptr so it stops asking
+	ThreadBufferCache::Entry& entry = t_bufferCache.entries[t_bufferCache.next++ % CACHED_TRACERS];
+	entry.tracerId = m_instanceId;
+	entry.buffer = buffer;
+	return buffer;
+}
+
+void EventTracer::Write(TraceEvent event, uint64_t startNs, uint64_t durationNs, uint64_t volume, uint64_t arg)
+{
+	ThreadBuffer* buffer = GetThreadBuffer();
+	if (!buffer) {
+		m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	const uint64_t index = buffer->started.load(std::memory_order_relaxed);
+	buffer->started.store(index + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	Slot& slot = buffer->slots[index % EVENTS_PER_THREAD];
+	slot.start.store(startNs, std::memory_order_relaxed);
+	slot.duration.store(durationNs, std::memory_order_relaxed);
+	slot.volume.store(volume, std::memory_order_relaxed);
+	slot.arg.store(arg, std::memory_order_relaxed);
+	slot.event.store(static_cast<uint32_t>(event), std::memory_order_relaxed);
+
+	buffer->committed.store(index + 1, std::memory_order_release);
+}
+
+bool EventTracer::Dump(const char* path) const
+{
+	std::vector<Record> records;
+	uint32_t threadCount = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_buffersMutex);
+		threadCount = static_cast<uint32_t>(m_buffers.size());
+		records.reserve(m_buffers.size() * EVENTS_PER_THREAD);
+
+		for (const std::unique_ptr<ThreadBuffer>& buffer : m_buffers) {
+			const uint64_t committed = buffer->committed.load(std::memory_order_acquire);
+			const uint64_t first = committed > EVENTS_PER_THREAD ? committed - EVENTS_PER_THREAD : 0;
+			const size_t begin = records.size();
+
+			for (uint64_t i = first; i < committed; ++i) {
+				const Slot& slot = buffer->slots[i % EVENTS_PER_THREAD];
+				Record record;
+				record.start = slot.start.load(std::memory_order_relaxed);
+				record.duration = slot.duration.load(std::memory_order_relaxed);
+				record.volume = slot.volume.load(std::memory_order_relaxed);
+				record.arg = slot.arg.load(std::memory_order_relaxed);
+				record.event = slot.event.load(std::memory_order_relaxed);
+				record.threadIndex = buffer->threadIndex;
+				records.push_back(record);
+			}
+
+			// Slots the owner started rewriting while we copied are torn
+			std::atomic_thread_fence(std::memory_order_acquire);
+			const uint64_t started = buffer->started.load(std::memory_order_relaxed);
+			const uint64_t valid = started > EVENTS_PER_THREAD ? started - EVENTS_PER_THREAD : 0;
+			if (valid > first) {
+				const size_t torn = static_cast<size_t>((std::min)(valid, committed) - first);
+				records.erase(records.begin() + begin, records.begin() + begin + torn);
+			}
+		}
+	}
+
+	std::sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+		return a.start < b.start;
+	});
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+
+	std::string line;
+	file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"SparseVolumetricResource\"}}";
+	for (uint32_t thread = 1; thread <= threadCount; ++thread) {
+		file << std::format(",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"Plugin thread {}\"}}}}",
+			thread, thread);
+	}
+
+	for (const Record& record : records) {
+		if (record.event >= static_cast<uint32_t>(TraceEvent::Count)) {
+			continue;
+		}
+		const TraceEventInfo& info = EVENT_INFO[record.event];
+
+		line = std::format(",\n{{\"name\":\"{}\",\"cat\":\"{}\",\"pid\":1,\"tid\":{},\"ts\":{}",
+			info.name, info.category, record.threadIndex, FormatMicroseconds(record.start));
+		if (record.duration == UINT64_MAX) {
+			line += ",\"ph\":\"i\",\"s\":\"t\"";
+		}
+		else {
+			line += std::format(",\"ph\":\"X\",\"dur\":{}", FormatMicroseconds(record.duration));
+		}
+
+		// Handles can exceed 2^53, so they go out as strings
+		line += ",\"args\":{";
+		bool hasArgs = false;
+		if (record.volume != 0) {
+			line += std::format("\"volume\":\"{:#x}\"", record.volume);
+			hasArgs = true;
+		}
+		// Batch phases such as eviction have no single volume or tile
+		if (info.argName && !(info.argIsTile && record.volume == 0)) {
+			if (hasArgs) {
+				line += ',';
+			}
+			if (info.argIsTile) {
+				line += std::format("\"{}\":\"{}/{}/{}/{}\"", info.argName,
+					record.arg >> 48, (record.arg >> 32) & 0xFFFF, (record.arg >> 16) & 0xFFFF, record.arg & 0xFFFF);
+			}
+			else {
+				line += std::format("\"{}\":{}", info.argName, record.arg);
+			}
+		}
+		line += "}}";
+		file << line;
+	}
+
+	file << "\n]}\n";
+	return static_cast<bool>(file);
+}
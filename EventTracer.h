@@ -0,0 +1,151 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Define SPARSE_NO_EVENT_TRACE to compile the tracer out; DumpTrace then
+// reports failure.
+#if !defined(SPARSE_NO_EVENT_TRACE)
+#define SPARSE_EVENT_TRACE 1
+#endif
+
+enum class TraceEvent : uint32_t {
+	// Pipeline phases, recorded as complete events with a duration
+	Validate = 0,
+	AcquireSlot,
+	StageFill,
+	MapTiles,
+	RecordCopy,
+	Submit,
+	Unmap,
+	FenceWait,         // arg: fence value waited for
+	// Instants
+	FenceSignal,       // arg: fence value
+	FenceComplete,     // arg: completed fence value
+	AllocationFailure, // arg: tiles requested
+	Count
+};
+
+// Packs a tile coordinate into an event argument: 16 bits each of
+// subresource, x, y and z, subresource highest
+inline uint64_t PackTraceTile(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z)
+{
+	return (static_cast<uint64_t>(subresource & 0xFFFF) << 48)
+		| (static_cast<uint64_t>(x & 0xFFFF) << 32)
+		| (static_cast<uint64_t>(y & 0xFFFF) << 16)
+		| (z & 0xFFFF);
+}
+
+// Records timestamped events into one fixed-size ring buffer per thread
+// and writes them out as Chrome trace JSON (chrome://tracing, Perfetto).
+// A thread's first event allocates its buffer; after that recording takes
+// no locks and allocates nothing, and the oldest events are overwritten.
+// A thread writing to more tracers than it caches looks its buffer up again
+// under the tracer's lock, but still never gets a second one.
+// While disabled, recording costs one relaxed load.
+class EventTracer {
+public:
+	static constexpr uint32_t EVENTS_PER_THREAD = 8192;
+	static constexpr uint32_t MAX_THREADS = 64;
+
+	EventTracer();
+
+	void SetEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+	bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+	// Nanoseconds since the tracer was created
+	uint64_t Now() const;
+
+	void Complete(TraceEvent event, uint64_t startNs, uint64_t durationNs, uint64_t volume, uint64_t arg);
+	void Instant(TraceEvent event, uint64_t volume, uint64_t arg);
+
+	// Writes every buffered event, oldest first. Safe while other threads
+	// record; events overwritten during the dump are left out.
+	bool Dump(const char* path) const;
+
+	// Events lost because MAX_THREADS threads already had buffers
+	uint64_t DroppedEvents() const { return m_droppedEvents.load(std::memory_order_relaxed); }
+
+private:
+	// Fields are atomics so the dump can read a slot the owning thread is
+	// rewriting; the counter check afterwards discards such slots
+	struct Slot {
+		std::atomic<uint64_t> start;
+		std::atomic<uint64_t> duration;
+		std::atomic<uint64_t> volume;
+		std::atomic<uint64_t> arg;
+		std::atomic<uint32_t> event;
+	};
+
+	// A seqlock per buffer: started counts writes begun, committed writes
+	// finished. Only the owning thread writes.
+	struct ThreadBuffer {
+		std::thread::id owner;
+		uint32_t threadIndex = 0;
+		std::atomic<uint64_t> started{ 0 };
+		std::atomic<uint64_t> committed{ 0 };
+		Slot slots[EVENTS_PER_THREAD];
+	};
+
+	struct Record {
+		uint64_t start;
+		uint64_t duration;
+		uint64_t volume;
+		uint64_t arg;
+		uint32_t event;
+		uint32_t threadIndex;
+	};
+
+	ThreadBuffer* GetThreadBuffer();
+	void Write(TraceEvent event, uint64_t startNs, uint64_t durationNs, uint64_t volume, uint64_t arg);
+
+	const uint64_t m_instanceId;
+	const std::chrono::steady_clock::time_point m_origin;
+	std::atomic<bool> m_enabled{ false };
+	std::atomic<uint64_t> m_droppedEvents{ 0 };
+
+	std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+	mutable std::mutex m_buffersMutex;
+};
+
+// Records the lifetime of a scope as one complete event, if the tracer was
+// enabled when the scope was entered
+class TraceScope {
+public:
+	TraceScope(EventTracer& tracer, TraceEvent event, uint64_t volume, uint64_t arg)
+		: m_tracer(tracer), m_event(event), m_volume(volume), m_arg(arg),
+		m_start(tracer.IsEnabled() ? tracer.Now() : UINT64_MAX) {}
+
+	~TraceScope() {
+		if (m_start != UINT64_MAX) {
+			m_tracer.Complete(m_event, m_start, m_tracer.Now() - m_start, m_volume, m_arg);
+		}
+	}
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+	EventTracer& m_tracer;
+	TraceEvent m_event;
+	uint64_t m_volume;
+	uint64_t m_arg;
+	uint64_t m_start;
+};
+
+#define SPARSE_TRACE_CONCAT_INNER(a, b) a##b
+#define SPARSE_TRACE_CONCAT(a, b) SPARSE_TRACE_CONCAT_INNER(a, b)
+
+#if defined(SPARSE_EVENT_TRACE)
+#define SPARSE_TRACE_SCOPE(tracer, event, volume, arg) \
+	TraceScope SPARSE_TRACE_CONCAT(traceScope, __LINE__)((tracer), (event), (volume), (arg))
+#define SPARSE_TRACE_INSTANT(tracer, event, volume, arg) \
+	do { if ((tracer).IsEnabled()) (tracer).Instant((event), (volume), (arg)); } while (0)
+#else
+#define SPARSE_TRACE_SCOPE(tracer, event, volume, arg) ((void)0)
+#define SPARSE_TRACE_INSTANT(tracer, event, volume, arg) ((void)0)
+#endif
@@ -18,6 +18,12 @@ FixedHeap::FixedHeap(ID3D12Device* device, UINT64 sizeInBytes)
 	heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
 	heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
 
+	// Without a device only the allocator runs; the backend keeps the memory
+	if (!device) {
+		m_freeBlocks.push_back({ 0, m_totalTiles });
+		return;
+	}
+
 	HRESULT hr = device->CreateHeap(&heapDesc, IID_PPV_ARGS(&m_heap));
 
 	if (SUCCEEDED(hr)) {
@@ -72,6 +78,21 @@ void FixedHeap::FreeTiles(UINT offsetInTiles, UINT numTiles)
 	CoalesceFreeBlocks();
 }
 
+void FixedHeap::FreeTileRanges(const TileRange* ranges, UINT rangeCount)
+{
+	if (rangeCount == 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(m_heapMutex);
+	for (UINT i = 0; i < rangeCount; ++i)
+	{
+		m_usedTiles -= ranges[i].numTiles;
+		m_freeBlocks.push_back({ ranges[i].offsetInTiles, ranges[i].numTiles });
+	}
+
+	CoalesceFreeBlocks();
+}
+
 void FixedHeap::CoalesceFreeBlocks()
 {
 	if (m_freeBlocks.size() <= 1)
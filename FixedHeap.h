@@ -6,11 +6,13 @@
 
 class FixedHeap : public IHeap {
 public:
+	// A null device tracks allocations only, with no ID3D12Heap behind them
 	FixedHeap(ID3D12Device* device, UINT64 sizeInBytes);
 	~FixedHeap() override;
 
 	TileAllocation AllocateTiles(UINT numTiles) override;
 	void FreeTiles(UINT offsetInTiles, UINT numTiles) override;
+	void FreeTileRanges(const TileRange* ranges, UINT rangeCount) override;
 
 	ID3D12Heap* GetD3D12Heap() const override { return m_heap; }
 	UINT GetTotalCapacityInTiles() const override { return m_totalTiles; }
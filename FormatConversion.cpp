@@ -0,0 +1,341 @@
+#include "pch.h"
+
+#include "FormatConversion.h"
+#include "CpuFeatures.h"
+#include "HalfFloat.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// ---- Palette lookup ----
+
+#if defined(SPARSE_X86)
+// 4-byte texels, eight per gather
+SPARSE_TARGET("avx2")
+size_t ConvertPalette8To32AVX2(const uint8_t* indices, std::byte* destination, size_t texelCount, const std::byte* palette)
+{
+	const int* table = reinterpret_cast<const int*>(palette);
+	size_t i = 0;
+	for (; i + 8 <= texelCount; i += 8) {
+		const __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i * 4), _mm256_i32gather_epi32(table, idx, 4));
+	}
+	return i;
+}
+#endif
+
+template <uint32_t BytesPerTexel>
+void ConvertPalette8(const std::byte* source, std::byte* destination, size_t texelCount, const std::byte* palette)
+{
+	const uint8_t* indices = reinterpret_cast<const uint8_t*>(source);
+	size_t i = 0;
+#if defined(SPARSE_X86)
+	if constexpr (BytesPerTexel == 4) {
+		static const bool hasAVX2 = CpuFeatures::HasAVX2();
+		if (hasAVX2) {
+			i = ConvertPalette8To32AVX2(indices, destination, texelCount, palette);
+		}
+	}
+#endif
+	// Fixed-size copies compile to single moves
+	for (; i < texelCount; ++i) {
+		std::memcpy(destination + i * BytesPerTexel, palette + static_cast<size_t>(indices[i]) * BytesPerTexel, BytesPerTexel);
+	}
+}
+
+// ---- float32 -> float16 ----
+
+#if defined(SPARSE_X86)
+SPARSE_TARGET("avx,f16c")
+size_t ConvertFloatToHalfF16C(const float* source, uint16_t* destination, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(source + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), halves);
+	}
+	return i;
+}
+#endif
+
+void ConvertFloatToHalf(const std::byte* source, std::byte* destination, size_t count)
+{
+	const float* in = reinterpret_cast<const float*>(source);
+	uint16_t* out = reinterpret_cast<uint16_t*>(destination);
+	size_t i = 0;
+#if defined(SPARSE_X86)
+	static const bool hasF16C = CpuFeatures::HasF16C();
+	if (hasF16C) {
+		i = ConvertFloatToHalfF16C(in, out, count);
+	}
+#elif defined(SPARSE_NEON)
+	for (; i + 4 <= count; i += 4) {
+		vst1_u16(out + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(in + i))));
+	}
+#endif
+	for (; i < count; ++i) {
+		out[i] = HalfFloat::FromFloat(in[i]);
+	}
+}
+
+template <uint32_t Channels>
+void ConvertFloat32ToFloat16(const std::byte* source, std::byte* destination, size_t texelCount, const std::byte*)
+{
+	ConvertFloatToHalf(source, destination, texelCount * Channels);
+}
+
+// ---- RGB8 -> RGBA8 ----
+
+#if defined(SPARSE_X86)
+SPARSE_TARGET("ssse3")
+size_t ConvertRGB8ToRGBA8SSSE3(const uint8_t* source, uint8_t* destination, size_t texelCount)
+{
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+	// Each step reads 16 bytes but consumes 12, so stop while 16 are readable
+	size_t i = 0;
+	for (; i + 6 <= texelCount; i += 4) {
+		const __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 3));
+		const __m128i rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4), rgba);
+	}
+	return i;
+}
+#endif
+
+void ConvertRGB8ToRGBA8(const std::byte* source, std::byte* destination, size_t texelCount, const std::byte*)
+{
+	const uint8_t* in = reinterpret_cast<const uint8_t*>(source);
+	uint8_t* out = reinterpret_cast<uint8_t*>(destination);
+	size_t i = 0;
+#if defined(SPARSE_X86)
+	static const bool hasSSSE3 = CpuFeatures::HasSSSE3();
+	if (hasSSSE3) {
+		i = ConvertRGB8ToRGBA8SSSE3(in, out, texelCount);
+	}
+#elif defined(SPARSE_NEON)
+	const uint8x8_t opaque = vdup_n_u8(0xFF);
+	for (; i + 8 <= texelCount; i += 8) {
+		const uint8x8x3_t rgb = vld3_u8(in + i * 3);
+		const uint8x8x4_t rgba = { { rgb.val[0], rgb.val[1], rgb.val[2], opaque } };
+		vst4_u8(out + i * 4, rgba);
+	}
+#endif
+	for (; i < texelCount; ++i) {
+		out[i * 4 + 0] = in[i * 3 + 0];
+		out[i * 4 + 1] = in[i * 3 + 1];
+		out[i * 4 + 2] = in[i * 3 + 2];
+		out[i * 4 + 3] = 0xFF;
+	}
+}
+
+// ---- Packed HDR formats ----
+
+// Unsigned float with a 5-bit exponent (bias 15) and MantissaBits of
+// mantissa, as used by R11G11B10. Negative values and NaN clamp to zero,
+// values past the largest finite clamp to it, rounding is nearest-even.
+template <uint32_t MantissaBits>
+uint32_t FloatToUnsignedSmallFloat(float value)
+{
+	constexpr uint32_t shift = 23 - MantissaBits;
+	constexpr uint32_t maxFinite = (0x1Eu << MantissaBits) | ((1u << MantissaBits) - 1);
+
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	if ((bits & 0x80000000) || (bits & 0x7FFFFFFF) > 0x7F800000) {
+		return 0;
+	}
+	if (bits == 0x7F800000) {
+		return 0x1Fu << MantissaBits;
+	}
+
+	uint32_t result;
+	uint32_t remainder;
+	uint32_t halfway;
+	if (bits < 0x38800000) {
+		// Below the smallest normal: denormalize
+		const uint32_t exponent = bits >> 23;
+		const uint32_t denormShift = shift + (113 - exponent);
+		if (denormShift >= 32) {
+			return 0;
+		}
+		const uint32_t mantissa = (bits & 0x7FFFFF) | 0x800000;
+		result = mantissa >> denormShift;
+		remainder = mantissa & ((1u << denormShift) - 1);
+		halfway = 1u << (denormShift - 1);
+	}
+	else {
+		const uint32_t rebased = bits - 0x38000000;
+		result = rebased >> shift;
+		remainder = rebased & ((1u << shift) - 1);
+		halfway = 1u << (shift - 1);
+	}
+
+	if (remainder > halfway || (remainder == halfway && (result & 1))) {
+		++result;
+	}
+	return (std::min)(result, maxFinite);
+}
+
+template <uint32_t MantissaBits>
+float UnsignedSmallFloatToFloat(uint32_t value)
+{
+	const uint32_t mantissa = value & ((1u << MantissaBits) - 1);
+	const uint32_t exponent = (value >> MantissaBits) & 0x1F;
+	if (exponent == 0x1F) {
+		return mantissa ? std::nanf("") : INFINITY;
+	}
+	if (exponent == 0) {
+		return std::ldexp(static_cast<float>(mantissa), -14 - static_cast<int>(MantissaBits));
+	}
+	return std::ldexp(static_cast<float>(mantissa | (1u << MantissaBits)),
+		static_cast<int>(exponent) - 15 - static_cast<int>(MantissaBits));
+}
+
+void ConvertFloat32RGBToR11G11B10(const std::byte* source, std::byte* destination, size_t texelCount, const std::byte*)
+{
+	const float* in = reinterpret_cast<const float*>(source);
+	uint32_t* out = reinterpret_cast<uint32_t*>(destination);
+	for (size_t i = 0; i < texelCount; ++i) {
+		out[i] = PackR11G11B10Float(in[i * 3 + 0], in[i * 3 + 1], in[i * 3 + 2]);
+	}
+}
+
+void ConvertFloat32RGBToR9G9B9E5(const std::byte* source, std::byte* destination, size_t texelCount, const std::byte*)
+{
+	const float* in = reinterpret_cast<const float*>(source);
+	uint32_t* out = reinterpret_cast<uint32_t*>(destination);
+	for (size_t i = 0; i < texelCount; ++i) {
+		out[i] = PackR9G9B9E5SharedExp(in[i * 3 + 0], in[i * 3 + 1], in[i * 3 + 2]);
+	}
+}
+
+} // namespace
+
+uint32_t PackR11G11B10Float(float r, float g, float b)
+{
+	return FloatToUnsignedSmallFloat<6>(r)
+		| (FloatToUnsignedSmallFloat<6>(g) << 11)
+		| (FloatToUnsignedSmallFloat<5>(b) << 22);
+}
+
+void UnpackR11G11B10Float(uint32_t packed, float* outRGB)
+{
+	outRGB[0] = UnsignedSmallFloatToFloat<6>(packed & 0x7FF);
+	outRGB[1] = UnsignedSmallFloatToFloat<6>((packed >> 11) & 0x7FF);
+	outRGB[2] = UnsignedSmallFloatToFloat<5>(packed >> 22);
+}
+
+void UnpackR9G9B9E5SharedExp(uint32_t packed, float* outRGB)
+{
+	const int exponent = static_cast<int>(packed >> 27) - 15 - 9;
+	outRGB[0] = std::ldexp(static_cast<float>(packed & 0x1FF), exponent);
+	outRGB[1] = std::ldexp(static_cast<float>((packed >> 9) & 0x1FF), exponent);
+	outRGB[2] = std::ldexp(static_cast<float>((packed >> 18) & 0x1FF), exponent);
+}
+
+uint32_t PackR9G9B9E5SharedExp(float r, float g, float b)
+{
+	// Shared-exponent encoding as specified for DXGI_FORMAT_R9G9B9E5_SHAREDEXP
+	constexpr int mantissaBits = 9;
+	constexpr int exponentBias = 15;
+	constexpr float maxValue = 65408.0f; // (511 / 512) * 2^16
+
+	auto clampChannel = [maxValue](float v) {
+		// !(v > 0) also catches NaN
+		return !(v > 0.0f) ? 0.0f : (std::min)(v, maxValue);
+	};
+	r = clampChannel(r);
+	g = clampChannel(g);
+	b = clampChannel(b);
+
+	const float maxChannel = (std::max)(r, (std::max)(g, b));
+	int exponent = -exponentBias - 1;
+	if (maxChannel > 0.0f) {
+		uint32_t bits;
+		std::memcpy(&bits, &maxChannel, sizeof(bits));
+		exponent = (std::max)(-exponentBias - 1, static_cast<int>(bits >> 23) - 127);
+	}
+	int sharedExponent = exponent + 1 + exponentBias;
+
+	float scale = std::ldexp(1.0f, mantissaBits - (sharedExponent - exponentBias));
+	if (static_cast<uint32_t>(std::floor(maxChannel * scale + 0.5f)) == (1u << mantissaBits)) {
+		scale *= 0.5f;
+		++sharedExponent;
+	}
+
+	const uint32_t rm = static_cast<uint32_t>(std::floor(r * scale + 0.5f));
+	const uint32_t gm = static_cast<uint32_t>(std::floor(g * scale + 0.5f));
+	const uint32_t bm = static_cast<uint32_t>(std::floor(b * scale + 0.5f));
+	return rm | (gm << 9) | (bm << 18) | (static_cast<uint32_t>(sharedExponent) << 27);
+}
+
+bool GetConversionKernel(
+	UploadSourceFormat source,
+	DXGI_FORMAT destination,
+	uint32_t destinationBytesPerTexel,
+	ConversionInfo* outInfo)
+{
+	ConversionInfo info = { nullptr, 0 };
+
+	switch (source)
+	{
+	case UploadSourceFormat::Palette8:
+		info.sourceBytesPerTexel = 1;
+		switch (destinationBytesPerTexel)
+		{
+		case 1:  info.kernel = &ConvertPalette8<1>; break;
+		case 2:  info.kernel = &ConvertPalette8<2>; break;
+		case 4:  info.kernel = &ConvertPalette8<4>; break;
+		case 8:  info.kernel = &ConvertPalette8<8>; break;
+		case 16: info.kernel = &ConvertPalette8<16>; break;
+		default: break;
+		}
+		break;
+
+	case UploadSourceFormat::Float32:
+		switch (destination)
+		{
+		case DXGI_FORMAT_R16_FLOAT:
+			info = { &ConvertFloat32ToFloat16<1>, 4 };
+			break;
+		case DXGI_FORMAT_R16G16_FLOAT:
+			info = { &ConvertFloat32ToFloat16<2>, 8 };
+			break;
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:
+			info = { &ConvertFloat32ToFloat16<4>, 16 };
+			break;
+		default:
+			break;
+		}
+		break;
+
+	case UploadSourceFormat::RGB8:
+		if (destination == DXGI_FORMAT_R8G8B8A8_UNORM) {
+			info = { &ConvertRGB8ToRGBA8, 3 };
+		}
+		break;
+
+	case UploadSourceFormat::Float32RGB:
+		if (destination == DXGI_FORMAT_R11G11B10_FLOAT) {
+			info = { &ConvertFloat32RGBToR11G11B10, 12 };
+		}
+		else if (destination == DXGI_FORMAT_R9G9B9E5_SHAREDEXP) {
+			info = { &ConvertFloat32RGBToR9G9B9E5, 12 };
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	if (!info.kernel) {
+		return false;
+	}
+	*outInfo = info;
+	return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <dxgiformat.h>
+
+// Layout of a payload handed to the converting upload entry points. The
+// destination is always the resource's DXGI_FORMAT.
+enum class UploadSourceFormat : uint32_t {
+	Native = 0,      // Already in the destination format
+	Palette8 = 1,    // 1-byte indices into a palette of destination texels
+	Float32 = 2,     // 32-bit floats, one per channel -> R16/R16G16/R16G16B16A16_FLOAT
+	RGB8 = 3,        // 3-byte RGB -> R8G8B8A8_UNORM with opaque alpha
+	Float32RGB = 4,  // 3 floats -> R11G11B10_FLOAT or R9G9B9E5_SHAREDEXP
+	Uncompressed = 5 // Raw texels for a BC resource, block-encoded while staging
+};
+
+// Palettes are expanded to this many entries; missing entries read as zero
+constexpr uint32_t UPLOAD_PALETTE_SIZE = 256;
+
+// Converts texelCount texels. For Palette8, palette points at
+// UPLOAD_PALETTE_SIZE destination texels; other kernels ignore it.
+using ConversionKernel = void(*)(
+	const std::byte* source,
+	std::byte* destination,
+	size_t texelCount,
+	const std::byte* palette);
+
+struct ConversionInfo {
+	ConversionKernel kernel;
+	uint32_t sourceBytesPerTexel;
+};
+
+// Looks up the kernel for a source/destination pair. Returns false if the
+// pair is not supported (including Native, which needs no conversion).
+bool GetConversionKernel(
+	UploadSourceFormat source,
+	DXGI_FORMAT destination,
+	uint32_t destinationBytesPerTexel,
+	ConversionInfo* outInfo);
+
+// Scalar packers, exposed for reference checks
+uint32_t PackR11G11B10Float(float r, float g, float b);
+uint32_t PackR9G9B9E5SharedExp(float r, float g, float b);
+
+// Scalar unpackers; outRGB receives three floats
+void UnpackR11G11B10Float(uint32_t packed, float* outRGB);
+void UnpackR9G9B9E5SharedExp(uint32_t packed, float* outRGB);
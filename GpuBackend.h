@@ -0,0 +1,105 @@
+#pragma once
+#include <d3d12.h>
+#include <cstddef>
+#include <memory>
+#include "IHeap.h"
+
+class ReservedResource;
+
+// Which of a ring slot's two staging buffers a copy reads from
+enum class StagingBuffer : UINT {
+	Tile = 0,   // One tile
+	Batch = 1   // Box slabs, packed mips and residency map bricks
+};
+
+// One staged copy waiting to be recorded. Producers build these on their own
+// stack, push them to the submission queue and block on m_submitMutex; the
+// thread that drains the queue fills in the result fields.
+struct UploadSubmission {
+	ReservedResource* resource;
+	D3D12_TILED_RESOURCE_COORDINATE startCoord;
+	D3D12_TILE_REGION_SIZE regionSize;
+	StagingBuffer sourceBuffer;  // Of slot slotIndex
+	UINT64 sourceOffset;
+	UINT slotIndex;
+
+	// When footprintCount is non-zero the submission is a set of
+	// CopyTextureRegion calls (packed mips) instead of one CopyTiles
+	const D3D12_PLACED_SUBRESOURCE_FOOTPRINT* footprints = nullptr;
+	UINT firstSubresource = 0;
+	UINT footprintCount = 0;
+
+	// Set when the footprints go to subresource 0 of another texture, such
+	// as a residency map, each at its own (x, y, z) in targetOffsets
+	ID3D12Resource* footprintTarget = nullptr;
+	const UINT* targetOffsets = nullptr;
+
+	UINT64 fenceValue = 0;
+	bool succeeded = false;
+
+	UploadSubmission* next = nullptr;
+};
+
+// The device, queue, fence and heap operations the upload pipeline issues.
+// Tile tracking, heap allocation, the staging ring, batching and retirement
+// sit above it and are shared by every backend; D3D12Backend drives the
+// Unity device and SoftwareBackend simulates one on the CPU.
+class IGpuBackend {
+public:
+	virtual ~IGpuBackend() = default;
+
+	// Creates the fence, one command allocator per ring slot and each slot's
+	// persistently mapped staging buffers
+	virtual bool Initialize(UINT slotCount, UINT64 tileStagingBytes, UINT64 batchStagingBytes) = 0;
+
+	virtual std::unique_ptr<IHeap> CreateTileHeap(UINT64 sizeInBytes) = 0;
+
+	// Creates the reserved texture and reads its tiling; nullptr on failure
+	virtual std::unique_ptr<ReservedResource> CreateReservedResource(
+		UINT width, UINT height, UINT depth,
+		bool useMipMaps, UINT mipCount,
+		DXGI_FORMAT format,
+		D3D12_TEXTURE_LAYOUT layout) = 0;
+
+	// Same contract as ID3D12Device::GetCopyableFootprints
+	virtual void GetCopyableFootprints(
+		const D3D12_RESOURCE_DESC& desc,
+		UINT firstSubresource, UINT subresourceCount,
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT* outFootprints,
+		UINT* outRowCounts,
+		UINT64* outRowSizes,
+		UINT64* outTotalBytes) = 0;
+
+	virtual std::byte* GetStagingMemory(StagingBuffer buffer, UINT slotIndex) const = 0;
+
+	// Queue-ordered, with ID3D12CommandQueue::UpdateTileMappings semantics;
+	// heap is null for NULL mappings
+	virtual void UpdateTileMappings(
+		ReservedResource* resource,
+		UINT regionCount,
+		const D3D12_TILED_RESOURCE_COORDINATE* regionCoords,
+		const D3D12_TILE_REGION_SIZE* regionSizes,
+		IHeap* heap,
+		UINT rangeCount,
+		const D3D12_TILE_RANGE_FLAGS* rangeFlags,
+		const UINT* heapRangeStartOffsets,
+		const UINT* rangeTileCounts) = 0;
+
+	// Records every submission in the list on the slot's allocator and
+	// queues them as one batch. False if nothing was queued.
+	virtual bool ExecuteCopies(const UploadSubmission* submissions, UINT allocatorSlot) = 0;
+
+	// Called once the slot's last fence has passed
+	virtual void ResetAllocator(UINT slotIndex) = 0;
+
+	// Queues a fence signal behind everything queued so far
+	virtual bool Signal(UINT64 fenceValue) = 0;
+	virtual UINT64 GetCompletedFenceValue() = 0;
+
+	// Blocks until the fence reaches fenceValue
+	virtual void WaitForFence(UINT64 fenceValue) = 0;
+
+	// The staging buffer resources, for the startup checks; null for
+	// backends without a device
+	virtual ID3D12Resource* GetStagingResource(StagingBuffer buffer, UINT slotIndex) const = 0;
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+// Scalar IEEE 754 binary16 conversions. Used where F16C is unavailable and
+// for the tails of vectorized loops.
+namespace HalfFloat {
+
+inline float ToFloat(uint16_t half)
+{
+	const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+	uint32_t exponent = (half >> 10) & 0x1F;
+	uint32_t mantissa = half & 0x3FF;
+	uint32_t bits;
+
+	if (exponent == 0x1F) {
+		// Inf / NaN
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else if (exponent != 0) {
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else if (mantissa == 0) {
+		bits = sign;
+	}
+	else {
+		// Subnormal half -> normal float
+		exponent = 113;
+		while ((mantissa & 0x400) == 0) {
+			mantissa <<= 1;
+			--exponent;
+		}
+		bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+	}
+
+	float result;
+	std::memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+// Round-to-nearest-even, matching _mm_cvtps_ph with rounding mode 0
+inline uint16_t FromFloat(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+	const uint32_t absBits = bits & 0x7FFFFFFF;
+
+	if (absBits >= 0x7F800000) {
+		// Inf stays Inf, NaN stays a quiet NaN
+		return sign | (absBits > 0x7F800000 ? 0x7E00 : 0x7C00);
+	}
+	if (absBits >= 0x477FF000) {
+		// Rounds past the largest finite half
+		return sign | 0x7C00;
+	}
+	if (absBits < 0x38800000) {
+		// Result is subnormal or zero
+		if (absBits < 0x33000000) {
+			return sign;
+		}
+		const uint32_t exponent = absBits >> 23;
+		const uint32_t mantissa = (absBits & 0x7FFFFF) | 0x800000;
+		const uint32_t shift = 126 - exponent;
+		uint32_t halfMantissa = mantissa >> shift;
+		const uint32_t remainder = mantissa & ((1u << shift) - 1);
+		const uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (halfMantissa & 1))) {
+			++halfMantissa;
+		}
+		return sign | static_cast<uint16_t>(halfMantissa);
+	}
+
+	uint32_t rebased = absBits - 0x38000000;
+	const uint32_t remainder = rebased & 0x1FFF;
+	rebased >>= 13;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (rebased & 1))) {
+		++rebased;
+	}
+	return sign | static_cast<uint16_t>(rebased);
+}
+
+} // namespace HalfFloat
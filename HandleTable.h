@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Slot map owning values of T behind 64-bit handles: the slot index in the
+// low 32 bits, the slot's generation in the high 32. Removing a value bumps
+// its slot's generation, so handles to it stop resolving even once the slot
+// is reused. Insert, Get and Remove are O(1); live values are kept densely
+// for iteration, in no particular order. 0 is never a valid handle.
+// Values are shared so a lookup can Pin one and keep it alive past its
+// removal. Not thread-safe.
+template <typename T>
+class HandleTable {
+public:
+	uint64_t Insert(std::shared_ptr<T> value)
+	{
+		uint32_t slot;
+		if (!m_freeSlots.empty()) {
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else {
+			slot = static_cast<uint32_t>(m_slots.size());
+			m_slots.push_back({ 1, 0 });
+		}
+
+		m_slots[slot].denseIndex = static_cast<uint32_t>(m_values.size());
+		m_values.push_back(std::move(value));
+		m_denseSlots.push_back(slot);
+		return MakeHandle(slot, m_slots[slot].generation);
+	}
+
+	// nullptr if the handle is stale or was never issued
+	T* Get(uint64_t handle) const
+	{
+		const std::shared_ptr<T>* value = Find(handle);
+		return value ? value->get() : nullptr;
+	}
+
+	// As Get, sharing ownership with the table
+	std::shared_ptr<T> Pin(uint64_t handle) const
+	{
+		const std::shared_ptr<T>* value = Find(handle);
+		return value ? *value : nullptr;
+	}
+
+	// Hands the table's reference back to the caller; empty if the handle
+	// is stale
+	std::shared_ptr<T> Remove(uint64_t handle)
+	{
+		if (!Get(handle)) {
+			return nullptr;
+		}
+
+		const uint32_t slot = static_cast<uint32_t>(handle);
+		const uint32_t index = m_slots[slot].denseIndex;
+		std::shared_ptr<T> value = std::move(m_values[index]);
+
+		// Move the last value into the hole
+		m_values[index] = std::move(m_values.back());
+		m_denseSlots[index] = m_denseSlots.back();
+		m_slots[m_denseSlots[index]].denseIndex = index;
+		m_values.pop_back();
+		m_denseSlots.pop_back();
+
+		// Generation 0 is skipped so no handle is ever 0
+		if (++m_slots[slot].generation == 0) {
+			m_slots[slot].generation = 1;
+		}
+		m_freeSlots.push_back(slot);
+		return value;
+	}
+
+	size_t Size() const { return m_values.size(); }
+
+	// Live values and their handles, index for index
+	const std::vector<std::shared_ptr<T>>& Values() const { return m_values; }
+	uint64_t HandleAt(size_t index) const
+	{
+		const uint32_t slot = m_denseSlots[index];
+		return MakeHandle(slot, m_slots[slot].generation);
+	}
+
+private:
+	struct Slot {
+		uint32_t generation;
+		uint32_t denseIndex;
+	};
+
+	static uint64_t MakeHandle(uint32_t slot, uint32_t generation)
+	{
+		return (static_cast<uint64_t>(generation) << 32) | slot;
+	}
+
+	const std::shared_ptr<T>* Find(uint64_t handle) const
+	{
+		const uint32_t slot = static_cast<uint32_t>(handle);
+		if (slot >= m_slots.size() || m_slots[slot].generation != static_cast<uint32_t>(handle >> 32)) {
+			return nullptr;
+		}
+		return &m_values[m_slots[slot].denseIndex];
+	}
+
+	std::vector<Slot> m_slots;
+	std::vector<uint32_t> m_freeSlots;
+	std::vector<std::shared_ptr<T>> m_values;
+	std::vector<uint32_t> m_denseSlots;
+};
@@ -9,6 +9,12 @@ struct TileAllocation {
     bool success;
 };
 
+// A run of consecutive tiles in the heap
+struct TileRange {
+    UINT offsetInTiles;
+    UINT numTiles;
+};
+
 // Abstract interface for heap management
 class IHeap {
 public:
@@ -20,6 +26,9 @@ public:
     // Free tiles at the given offset
     virtual void FreeTiles(UINT offsetInTiles, UINT numTiles) = 0;
 
+    // Free several ranges at once, coalescing the free list a single time
+    virtual void FreeTileRanges(const TileRange* ranges, UINT rangeCount) = 0;
+
     // Get the underlying D3D12 heap
     virtual ID3D12Heap* GetD3D12Heap() const = 0;
 
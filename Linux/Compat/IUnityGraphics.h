@@ -0,0 +1,19 @@
+#pragma once
+#include "IUnityInterface.h"
+
+enum UnityGfxRenderer {
+	kUnityGfxRendererD3D12 = 18,
+};
+
+enum UnityGfxDeviceEventType {
+	kUnityGfxDeviceEventInitialize = 0,
+	kUnityGfxDeviceEventShutdown = 1,
+};
+
+typedef void (*IUnityGraphicsDeviceEventCallback)(UnityGfxDeviceEventType eventType);
+
+struct IUnityGraphics : IUnityInterface {
+	UnityGfxRenderer GetRenderer() { return kUnityGfxRendererD3D12; }
+	void RegisterDeviceEventCallback(IUnityGraphicsDeviceEventCallback) {}
+	void UnregisterDeviceEventCallback(IUnityGraphicsDeviceEventCallback) {}
+};
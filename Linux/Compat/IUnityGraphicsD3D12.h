@@ -0,0 +1,8 @@
+#pragma once
+#include "IUnityInterface.h"
+#include "d3d12.h"
+
+struct IUnityGraphicsD3D12v6 : IUnityInterface {
+	virtual ID3D12Device* GetDevice() = 0;
+	virtual ID3D12CommandQueue* GetCommandQueue() = 0;
+};
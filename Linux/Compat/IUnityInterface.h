@@ -0,0 +1,21 @@
+#pragma once
+// Linux build only: stands in for Unity's PluginAPI headers. No Unity
+// interfaces are available off Windows; GetInterface always fails.
+#include <cstdint>
+
+#define UNITY_INTERFACE_EXPORT
+#define UNITY_INTERFACE_API
+
+struct UnityInterfaceGUID {
+	uint64_t high;
+	uint64_t low;
+};
+
+struct IUnityInterface {};
+
+struct IUnityInterfaces {
+	IUnityInterface* GetInterface(UnityInterfaceGUID) { return nullptr; }
+
+	template <class T>
+	T* Get() { return nullptr; }
+};
@@ -0,0 +1,27 @@
+#pragma once
+// Linux build only: logs to stderr
+#include <cstdio>
+#include "IUnityInterface.h"
+
+enum UnityLogType {
+	kUnityLogTypeError = 0,
+	kUnityLogTypeWarning = 2,
+	kUnityLogTypeLog = 3,
+};
+
+struct IUnityLog : IUnityInterface {
+	// Drops every message, for benchmarks and for tests that provoke
+	// errors on purpose
+	bool quiet = false;
+
+	void Log(UnityLogType type, const char* message)
+	{
+		if (!quiet) {
+			std::fprintf(stderr, "[%s] %s\n", type == kUnityLogTypeError ? "error" : "log", message);
+		}
+	}
+};
+
+#define UNITY_LOG(PTR_, MSG_) (PTR_)->Log(kUnityLogTypeLog, MSG_)
+#define UNITY_LOG_WARNING(PTR_, MSG_) (PTR_)->Log(kUnityLogTypeWarning, MSG_)
+#define UNITY_LOG_ERROR(PTR_, MSG_) (PTR_)->Log(kUnityLogTypeError, MSG_)
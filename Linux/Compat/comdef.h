@@ -0,0 +1,2 @@
+#pragma once
+// Linux build only; nothing from comdef.h is used off Windows.
@@ -0,0 +1,79 @@
+#pragma once
+// Linux build only: the D3D12 declarations the core compiles against. The
+// interfaces are never implemented; off Windows every device operation goes
+// through SoftwareBackend.
+#include "windows.h"
+#include "dxgiformat.h"
+
+typedef UINT64 D3D12_GPU_VIRTUAL_ADDRESS;
+#define D3D12_TEXTURE_DATA_PITCH_ALIGNMENT 256
+#define D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT 512
+#define D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT 65536
+#define D3D12_PACKED_TILE 0xffffffff
+enum D3D12_RESOURCE_DIMENSION { D3D12_RESOURCE_DIMENSION_UNKNOWN, D3D12_RESOURCE_DIMENSION_BUFFER, D3D12_RESOURCE_DIMENSION_TEXTURE1D, D3D12_RESOURCE_DIMENSION_TEXTURE2D, D3D12_RESOURCE_DIMENSION_TEXTURE3D };
+enum D3D12_TEXTURE_LAYOUT { D3D12_TEXTURE_LAYOUT_UNKNOWN, D3D12_TEXTURE_LAYOUT_ROW_MAJOR, D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE, D3D12_TEXTURE_LAYOUT_64KB_STANDARD_SWIZZLE };
+enum D3D12_RESOURCE_FLAGS { D3D12_RESOURCE_FLAG_NONE };
+struct DXGI_SAMPLE_DESC { UINT Count; UINT Quality; };
+struct D3D12_RESOURCE_DESC { D3D12_RESOURCE_DIMENSION Dimension; UINT64 Alignment; UINT64 Width; UINT Height; UINT16 DepthOrArraySize; UINT16 MipLevels; DXGI_FORMAT Format; DXGI_SAMPLE_DESC SampleDesc; D3D12_TEXTURE_LAYOUT Layout; D3D12_RESOURCE_FLAGS Flags; };
+struct D3D12_SUBRESOURCE_FOOTPRINT { DXGI_FORMAT Format; UINT Width; UINT Height; UINT Depth; UINT RowPitch; };
+struct D3D12_PLACED_SUBRESOURCE_FOOTPRINT { UINT64 Offset; D3D12_SUBRESOURCE_FOOTPRINT Footprint; };
+struct D3D12_TILED_RESOURCE_COORDINATE { UINT X; UINT Y; UINT Z; UINT Subresource; };
+struct D3D12_TILE_REGION_SIZE { UINT NumTiles; BOOL UseBox; UINT Width; UINT16 Height; UINT16 Depth; };
+enum D3D12_TILE_RANGE_FLAGS { D3D12_TILE_RANGE_FLAG_NONE = 0, D3D12_TILE_RANGE_FLAG_NULL = 1, D3D12_TILE_RANGE_FLAG_SKIP = 2, D3D12_TILE_RANGE_FLAG_REUSE_SINGLE_TILE = 4 };
+enum D3D12_TILE_MAPPING_FLAGS { D3D12_TILE_MAPPING_FLAG_NONE };
+enum D3D12_TILE_COPY_FLAGS { D3D12_TILE_COPY_FLAG_NONE = 0, D3D12_TILE_COPY_FLAG_LINEAR_BUFFER_TO_SWIZZLED_TILED_RESOURCE = 2 };
+struct D3D12_PACKED_MIP_INFO { UINT8 NumStandardMips; UINT8 NumPackedMips; UINT NumTilesForPackedMips; UINT StartTileIndexInOverallResource; };
+struct D3D12_TILE_SHAPE { UINT WidthInTexels; UINT HeightInTexels; UINT DepthInTexels; };
+struct D3D12_SUBRESOURCE_TILING { UINT WidthInTiles; UINT16 HeightInTiles; UINT16 DepthInTiles; UINT StartTileIndexInOverallResource; };
+enum D3D12_HEAP_TYPE { D3D12_HEAP_TYPE_DEFAULT = 1, D3D12_HEAP_TYPE_UPLOAD, D3D12_HEAP_TYPE_READBACK };
+enum D3D12_CPU_PAGE_PROPERTY { D3D12_CPU_PAGE_PROPERTY_UNKNOWN };
+enum D3D12_MEMORY_POOL { D3D12_MEMORY_POOL_UNKNOWN };
+struct D3D12_HEAP_PROPERTIES { D3D12_HEAP_TYPE Type; D3D12_CPU_PAGE_PROPERTY CPUPageProperty; D3D12_MEMORY_POOL MemoryPoolPreference; UINT CreationNodeMask; UINT VisibleNodeMask; };
+enum D3D12_HEAP_FLAGS { D3D12_HEAP_FLAG_NONE = 0, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES = 0x84, D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES = 0 };
+struct D3D12_HEAP_DESC { UINT64 SizeInBytes; D3D12_HEAP_PROPERTIES Properties; UINT64 Alignment; D3D12_HEAP_FLAGS Flags; };
+enum D3D12_RESOURCE_STATES { D3D12_RESOURCE_STATE_COMMON = 0, D3D12_RESOURCE_STATE_COPY_DEST = 0x400, D3D12_RESOURCE_STATE_GENERIC_READ = 0xac3 };
+struct D3D12_RANGE { SIZE_T Begin; SIZE_T End; };
+enum D3D12_FENCE_FLAGS { D3D12_FENCE_FLAG_NONE };
+enum D3D12_COMMAND_LIST_TYPE { D3D12_COMMAND_LIST_TYPE_DIRECT = 0, D3D12_COMMAND_LIST_TYPE_COMPUTE = 2, D3D12_COMMAND_LIST_TYPE_COPY = 3 };
+struct D3D12_COMMAND_QUEUE_DESC { D3D12_COMMAND_LIST_TYPE Type; int Priority; int Flags; UINT NodeMask; };
+enum D3D12_FEATURE { D3D12_FEATURE_D3D12_OPTIONS = 0, D3D12_FEATURE_D3D12_OPTIONS5 = 27 };
+enum D3D12_RESOURCE_HEAP_TIER { D3D12_RESOURCE_HEAP_TIER_1 = 1, D3D12_RESOURCE_HEAP_TIER_2 = 2 };
+enum D3D12_TILED_RESOURCES_TIER { D3D12_TILED_RESOURCES_TIER_NOT_SUPPORTED = 0, D3D12_TILED_RESOURCES_TIER_1, D3D12_TILED_RESOURCES_TIER_2, D3D12_TILED_RESOURCES_TIER_3 };
+struct D3D12_FEATURE_DATA_D3D12_OPTIONS { BOOL StandardSwizzle64KBSupported; D3D12_TILED_RESOURCES_TIER TiledResourcesTier; D3D12_RESOURCE_HEAP_TIER ResourceHeapTier; };
+struct D3D12_FEATURE_DATA_D3D12_OPTIONS5 { BOOL SRVOnlyTiledResourceTier3; };
+enum D3D12_RESOURCE_BARRIER_TYPE { D3D12_RESOURCE_BARRIER_TYPE_TRANSITION, D3D12_RESOURCE_BARRIER_TYPE_ALIASING };
+struct ID3D12Resource;
+struct D3D12_RESOURCE_ALIASING_BARRIER { ID3D12Resource* pResourceBefore; ID3D12Resource* pResourceAfter; };
+struct D3D12_RESOURCE_TRANSITION_BARRIER { ID3D12Resource* pResource; UINT Subresource; D3D12_RESOURCE_STATES StateBefore; D3D12_RESOURCE_STATES StateAfter; };
+struct D3D12_RESOURCE_BARRIER { D3D12_RESOURCE_BARRIER_TYPE Type; int Flags; union { D3D12_RESOURCE_TRANSITION_BARRIER Transition; D3D12_RESOURCE_ALIASING_BARRIER Aliasing; }; };
+enum D3D12_TEXTURE_COPY_TYPE { D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX, D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT };
+struct D3D12_TEXTURE_COPY_LOCATION { ID3D12Resource* pResource; D3D12_TEXTURE_COPY_TYPE Type; union { D3D12_PLACED_SUBRESOURCE_FOOTPRINT PlacedFootprint; UINT SubresourceIndex; }; };
+struct D3D12_BOX { UINT left, top, front, right, bottom, back; };
+struct ID3D12Pageable : IUnknown {};
+struct ID3D12Heap : ID3D12Pageable {};
+struct ID3D12Resource : ID3D12Pageable { virtual D3D12_RESOURCE_DESC GetDesc() = 0; virtual HRESULT Map(UINT, const D3D12_RANGE*, void**) = 0; virtual void Unmap(UINT, const D3D12_RANGE*) = 0; virtual D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() = 0; };
+struct ID3D12Fence : ID3D12Pageable { virtual UINT64 GetCompletedValue() = 0; virtual HRESULT SetEventOnCompletion(UINT64, HANDLE) = 0; };
+struct ID3D12CommandAllocator : ID3D12Pageable { virtual HRESULT Reset() = 0; };
+struct ID3D12CommandList : IUnknown {};
+struct ID3D12GraphicsCommandList : ID3D12CommandList {
+	virtual HRESULT Close() = 0; virtual HRESULT Reset(ID3D12CommandAllocator*, void*) = 0;
+	virtual void CopyTiles(ID3D12Resource*, const D3D12_TILED_RESOURCE_COORDINATE*, const D3D12_TILE_REGION_SIZE*, ID3D12Resource*, UINT64, D3D12_TILE_COPY_FLAGS) = 0;
+	virtual void CopyTextureRegion(const D3D12_TEXTURE_COPY_LOCATION*, UINT, UINT, UINT, const D3D12_TEXTURE_COPY_LOCATION*, const D3D12_BOX*) = 0;
+	virtual void CopyBufferRegion(ID3D12Resource*, UINT64, ID3D12Resource*, UINT64, UINT64) = 0;
+	virtual void ResourceBarrier(UINT, const D3D12_RESOURCE_BARRIER*) = 0; };
+struct ID3D12CommandQueue : ID3D12Pageable { virtual D3D12_COMMAND_QUEUE_DESC GetDesc() = 0;
+	virtual void UpdateTileMappings(ID3D12Resource*, UINT, const D3D12_TILED_RESOURCE_COORDINATE*, const D3D12_TILE_REGION_SIZE*, ID3D12Heap*, UINT, const D3D12_TILE_RANGE_FLAGS*, const UINT*, const UINT*, D3D12_TILE_MAPPING_FLAGS) = 0;
+	virtual void ExecuteCommandLists(UINT, ID3D12CommandList* const*) = 0;
+	virtual HRESULT Signal(ID3D12Fence*, UINT64) = 0; };
+struct ID3D12Device : IUnknown {
+	virtual HRESULT CreateFence(UINT64, D3D12_FENCE_FLAGS, const IID&, void**) = 0;
+	virtual HRESULT CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE, const IID&, void**) = 0;
+	virtual HRESULT CreateCommandList(UINT, D3D12_COMMAND_LIST_TYPE, ID3D12CommandAllocator*, void*, const IID&, void**) = 0;
+	virtual HRESULT CreateCommandQueue(const D3D12_COMMAND_QUEUE_DESC*, const IID&, void**) = 0;
+	virtual HRESULT CreateCommittedResource(const D3D12_HEAP_PROPERTIES*, D3D12_HEAP_FLAGS, const D3D12_RESOURCE_DESC*, D3D12_RESOURCE_STATES, const void*, const IID&, void**) = 0;
+	virtual HRESULT CreateHeap(const D3D12_HEAP_DESC*, const IID&, void**) = 0;
+	virtual HRESULT CreatePlacedResource(ID3D12Heap*, UINT64, const D3D12_RESOURCE_DESC*, D3D12_RESOURCE_STATES, const void*, const IID&, void**) = 0;
+	virtual HRESULT CreateReservedResource(const D3D12_RESOURCE_DESC*, D3D12_RESOURCE_STATES, const void*, const IID&, void**) = 0;
+	virtual void GetResourceTiling(ID3D12Resource*, UINT*, D3D12_PACKED_MIP_INFO*, D3D12_TILE_SHAPE*, UINT*, UINT, D3D12_SUBRESOURCE_TILING*) = 0;
+	virtual void GetCopyableFootprints(const D3D12_RESOURCE_DESC*, UINT, UINT, UINT64, D3D12_PLACED_SUBRESOURCE_FOOTPRINT*, UINT*, UINT64*, UINT64*) = 0;
+	virtual HRESULT CheckFeatureSupport(D3D12_FEATURE, void*, UINT) = 0; };
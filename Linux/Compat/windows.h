@@ -0,0 +1,51 @@
+#pragma once
+// Linux build only: the Win32 types and macros the device-independent core
+// uses. See CMakeLists.txt.
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+typedef unsigned int UINT;
+typedef uint8_t UINT8;
+typedef uint16_t UINT16;
+typedef uint64_t UINT64;
+typedef int64_t INT64;
+typedef int32_t LONG;
+typedef uint32_t DWORD;
+typedef uint64_t SIZE_T;
+typedef int BOOL;
+typedef int32_t HRESULT;
+typedef void* HANDLE;
+typedef void* HMODULE;
+typedef const wchar_t* LPCWSTR;
+
+#define TRUE 1
+#define FALSE 0
+#define APIENTRY
+#define __stdcall
+
+#define S_OK ((HRESULT)0)
+#define E_FAIL ((HRESULT)0x80004005)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+
+struct GUID {
+	uint32_t data;
+};
+typedef GUID IID;
+
+template <class T>
+inline const IID& CompatInterfaceId()
+{
+	static const IID id = {};
+	return id;
+}
+
+#define IID_PPV_ARGS(pp) \
+	CompatInterfaceId<std::remove_pointer_t<std::remove_pointer_t<decltype(pp)>>>(), reinterpret_cast<void**>(pp)
+
+struct IUnknown {
+	virtual UINT AddRef() { return 1; }
+	virtual UINT Release() { return 0; }
+	virtual ~IUnknown() = default;
+};
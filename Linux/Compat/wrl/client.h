@@ -0,0 +1,43 @@
+#pragma once
+// Linux build only: enough of ComPtr for the core's members
+#include <cstddef>
+
+namespace Microsoft {
+namespace WRL {
+
+template <class T>
+class ComPtr {
+public:
+	ComPtr() = default;
+	ComPtr(std::nullptr_t) {}
+	ComPtr(T* pointer) : m_pointer(pointer) { if (m_pointer) m_pointer->AddRef(); }
+	ComPtr(const ComPtr& other) : m_pointer(other.m_pointer) { if (m_pointer) m_pointer->AddRef(); }
+	~ComPtr() { if (m_pointer) m_pointer->Release(); }
+
+	ComPtr& operator=(const ComPtr& other)
+	{
+		if (other.m_pointer) other.m_pointer->AddRef();
+		if (m_pointer) m_pointer->Release();
+		m_pointer = other.m_pointer;
+		return *this;
+	}
+
+	ComPtr& operator=(std::nullptr_t)
+	{
+		if (m_pointer) m_pointer->Release();
+		m_pointer = nullptr;
+		return *this;
+	}
+
+	T* Get() const { return m_pointer; }
+	T* operator->() const { return m_pointer; }
+	T** GetAddressOf() { return &m_pointer; }
+	T** operator&() { return &m_pointer; }
+	explicit operator bool() const { return m_pointer != nullptr; }
+
+private:
+	T* m_pointer = nullptr;
+};
+
+} // namespace WRL
+} // namespace Microsoft
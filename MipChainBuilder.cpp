@@ -0,0 +1,124 @@
+#include "pch.h"
+
+#include "MipChainBuilder.h"
+#include <algorithm>
+
+MipChainBuilder::MipChainBuilder(
+	const ResourceTilingInfo& tilingInfo,
+	MipDownsampleKernel kernel,
+	uint32_t tileSizeInBytes,
+	uint32_t maxPendingParents)
+	: m_tilingInfo(tilingInfo),
+	m_kernel(kernel),
+	m_shape{ tilingInfo.TileWidthInTexels, tilingInfo.TileHeightInTexels, tilingInfo.TileDepthInTexels },
+	m_tileSizeInBytes(tileSizeInBytes),
+	m_maxPendingParents((std::max)(maxPendingParents, 1u))
+{
+}
+
+uint8_t MipChainBuilder::GetExpectedChildren(uint32_t childSubresource, uint32_t parentX, uint32_t parentY, uint32_t parentZ) const
+{
+	// Edge parents of odd-sized levels only have children on one side
+	const SubresourceTilingInfo& child = m_tilingInfo.subresourceTilingInfo[childSubresource];
+	uint8_t mask = 0;
+	for (uint32_t octant = 0; octant < 8; ++octant) {
+		const uint32_t cx = parentX * 2 + (octant & 1);
+		const uint32_t cy = parentY * 2 + ((octant >> 1) & 1);
+		const uint32_t cz = parentZ * 2 + ((octant >> 2) & 1);
+		if (cx < child.WidthInTiles && cy < child.HeightInTiles && cz < child.DepthInTiles) {
+			mask |= static_cast<uint8_t>(1u << octant);
+		}
+	}
+	return mask;
+}
+
+MipChainBuilder::PendingParent& MipChainBuilder::AcquireParent(uint64_t key)
+{
+	auto it = m_parents.find(key);
+	if (it != m_parents.end()) {
+		m_recency.splice(m_recency.begin(), m_recency, it->second.recency);
+		return it->second;
+	}
+
+	if (m_parents.size() >= m_maxPendingParents) {
+		m_parents.erase(m_recency.back());
+		m_recency.pop_back();
+		++m_droppedParents;
+	}
+
+	m_recency.push_front(key);
+	PendingParent& parent = m_parents[key];
+	parent.data.resize(m_tileSizeInBytes);
+	parent.recency = m_recency.begin();
+	return parent;
+}
+
+void MipChainBuilder::AddTile(
+	uint32_t subresource,
+	uint32_t x, uint32_t y, uint32_t z,
+	const std::byte* data,
+	std::vector<GeneratedMipTile>& outReady)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const std::byte* childData = data;
+	while (subresource + 1 < m_tilingInfo.NumStandardMips) {
+		const uint32_t px = x / 2, py = y / 2, pz = z / 2;
+		const uint32_t octantX = x & 1, octantY = y & 1, octantZ = z & 1;
+
+		const uint64_t key = GetTileKey(subresource + 1, px, py, pz);
+		PendingParent& parent = AcquireParent(key);
+
+		m_kernel(childData, parent.data.data(), m_shape, octantX, octantY, octantZ);
+		parent.presentChildren |= static_cast<uint8_t>(1u << (octantX | (octantY << 1) | (octantZ << 2)));
+
+		const uint8_t expected = GetExpectedChildren(subresource, px, py, pz);
+		if ((parent.presentChildren & expected) != expected) {
+			break;
+		}
+
+		// Complete: hand the buffer over and forget the parent
+		outReady.push_back({ subresource + 1, px, py, pz, std::move(parent.data) });
+		m_recency.erase(parent.recency);
+		m_parents.erase(key);
+		childData = outReady.back().data.data();
+
+		++subresource;
+		x = px;
+		y = py;
+		z = pz;
+	}
+}
+
+void MipChainBuilder::RemoveTile(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z)
+{
+	if (subresource + 1 >= m_tilingInfo.NumStandardMips) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto it = m_parents.find(GetTileKey(subresource + 1, x / 2, y / 2, z / 2));
+	if (it == m_parents.end()) {
+		return;
+	}
+
+	PendingParent& parent = it->second;
+	parent.presentChildren &= static_cast<uint8_t>(~(1u << ((x & 1) | ((y & 1) << 1) | ((z & 1) << 2))));
+	if (parent.presentChildren == 0) {
+		m_recency.erase(parent.recency);
+		m_parents.erase(it);
+	}
+}
+
+size_t MipChainBuilder::GetPendingParentCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_parents.size();
+}
+
+uint64_t MipChainBuilder::GetDroppedParentCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_droppedParents;
+}
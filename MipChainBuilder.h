@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "MipKernels.h"
+#include "TilingInfo.h"
+
+// Parents held at once while waiting for their remaining children. At 64KB
+// each this caps a builder at 32MB; the least recently touched parent is
+// dropped when the cap is reached.
+constexpr uint32_t MIP_CHAIN_MAX_PENDING_PARENTS = 512;
+
+// A coarser-mip tile whose children are all present, ready to be uploaded
+struct GeneratedMipTile {
+	uint32_t subresource;
+	uint32_t x, y, z;
+	std::vector<std::byte> data;
+};
+
+// Builds a resource's standard mip chain on the CPU from uploaded tiles.
+// Each child tile is downsampled straight into its octant of a pending
+// parent tile; once every existing child of a parent has been seen, the
+// parent is emitted and fed upward in turn. The packed mip tail is not
+// addressable by tile and is left to UploadPackedMips.
+//
+// A parent is forgotten as soon as it is emitted, so re-uploading one child
+// of a completed parent regenerates it only after its siblings have been
+// uploaded again. Unmapping a child withdraws its octant from the pending
+// parent, so a parent is never built from tiles that are no longer mapped.
+class MipChainBuilder {
+public:
+	MipChainBuilder(
+		const ResourceTilingInfo& tilingInfo,
+		MipDownsampleKernel kernel,
+		uint32_t tileSizeInBytes,
+		uint32_t maxPendingParents = MIP_CHAIN_MAX_PENDING_PARENTS);
+
+	// Feeds one uploaded tile and appends every coarser tile it completes
+	void AddTile(
+		uint32_t subresource,
+		uint32_t x, uint32_t y, uint32_t z,
+		const std::byte* data,
+		std::vector<GeneratedMipTile>& outReady
+	);
+
+	// Withdraws an unmapped tile from its pending parent
+	void RemoveTile(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z);
+
+	size_t GetPendingParentCount() const;
+
+	// Parents dropped incomplete because the pending cap was reached
+	uint64_t GetDroppedParentCount() const;
+
+private:
+	struct PendingParent {
+		std::vector<std::byte> data;
+		uint8_t presentChildren = 0;
+		std::list<uint64_t>::iterator recency;
+	};
+
+	uint8_t GetExpectedChildren(uint32_t childSubresource, uint32_t parentX, uint32_t parentY, uint32_t parentZ) const;
+	PendingParent& AcquireParent(uint64_t key);
+
+	static uint64_t GetTileKey(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z) {
+		return ((uint64_t)subresource << 48) | ((uint64_t)x << 32) | ((uint64_t)y << 16) | z;
+	}
+
+	ResourceTilingInfo m_tilingInfo;
+	MipDownsampleKernel m_kernel;
+	MipTileShape m_shape;
+	uint32_t m_tileSizeInBytes;
+	uint32_t m_maxPendingParents;
+
+	// Most recently touched parent at the front
+	std::list<uint64_t> m_recency;
+	std::unordered_map<uint64_t, PendingParent> m_parents;
+	uint64_t m_droppedParents = 0;
+	mutable std::mutex m_mutex;
+};
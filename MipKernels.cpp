@@ -0,0 +1,414 @@
+#include "pch.h"
+
+#include "MipKernels.h"
+#include "CpuFeatures.h"
+#include "FormatConversion.h"
+#include "HalfFloat.h"
+#include <array>
+#include <bit>
+
+namespace {
+
+// Widest child row across the supported formats: 32 RGBA8 texels
+constexpr uint32_t MAX_ROW_ELEMENTS = 128;
+
+// Average filters work one parent row at a time. SumRows adds the four child
+// rows of a 2x2 (y, z) neighbourhood element by element, which is where the
+// SIMD width pays off; Finish then folds two horizontally adjacent sums into
+// one parent channel value.
+
+struct Unorm8Traits {
+	using Element = uint8_t;
+	using Accum = uint16_t;
+
+	static void SumRows(const uint8_t* a, const uint8_t* b, const uint8_t* c, const uint8_t* d,
+		uint16_t* out, uint32_t count)
+	{
+		uint32_t i = 0;
+#if defined(SPARSE_X86)
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 16 <= count; i += 16) {
+			const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+			const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+			const __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i));
+			const __m128i vd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i));
+
+			const __m128i lo = _mm_add_epi16(
+				_mm_add_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero)),
+				_mm_add_epi16(_mm_unpacklo_epi8(vc, zero), _mm_unpacklo_epi8(vd, zero)));
+			const __m128i hi = _mm_add_epi16(
+				_mm_add_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero)),
+				_mm_add_epi16(_mm_unpackhi_epi8(vc, zero), _mm_unpackhi_epi8(vd, zero)));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), lo);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), hi);
+		}
+#elif defined(SPARSE_NEON)
+		for (; i + 16 <= count; i += 16) {
+			uint16x8_t lo = vaddl_u8(vld1_u8(a + i), vld1_u8(b + i));
+			lo = vaddw_u8(vaddw_u8(lo, vld1_u8(c + i)), vld1_u8(d + i));
+			uint16x8_t hi = vaddl_u8(vld1_u8(a + i + 8), vld1_u8(b + i + 8));
+			hi = vaddw_u8(vaddw_u8(hi, vld1_u8(c + i + 8)), vld1_u8(d + i + 8));
+			vst1q_u16(out + i, lo);
+			vst1q_u16(out + i + 8, hi);
+		}
+#endif
+		for (; i < count; ++i) {
+			out[i] = static_cast<uint16_t>(a[i] + b[i] + c[i] + d[i]);
+		}
+	}
+
+	static uint8_t Finish(uint16_t left, uint16_t right)
+	{
+		// Round to nearest
+		return static_cast<uint8_t>((left + right + 4) >> 3);
+	}
+};
+
+struct Float32Traits {
+	using Element = float;
+	using Accum = float;
+
+	static void SumRows(const float* a, const float* b, const float* c, const float* d,
+		float* out, uint32_t count)
+	{
+		uint32_t i = 0;
+#if defined(SPARSE_X86)
+		for (; i + 4 <= count; i += 4) {
+			const __m128 sum = _mm_add_ps(
+				_mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)),
+				_mm_add_ps(_mm_loadu_ps(c + i), _mm_loadu_ps(d + i)));
+			_mm_storeu_ps(out + i, sum);
+		}
+#elif defined(SPARSE_NEON)
+		for (; i + 4 <= count; i += 4) {
+			const float32x4_t sum = vaddq_f32(
+				vaddq_f32(vld1q_f32(a + i), vld1q_f32(b + i)),
+				vaddq_f32(vld1q_f32(c + i), vld1q_f32(d + i)));
+			vst1q_f32(out + i, sum);
+		}
+#endif
+		for (; i < count; ++i) {
+			out[i] = (a[i] + b[i]) + (c[i] + d[i]);
+		}
+	}
+
+	static float Finish(float left, float right)
+	{
+		return (left + right) * 0.125f;
+	}
+};
+
+#if defined(SPARSE_X86)
+SPARSE_TARGET("avx,f16c")
+uint32_t SumHalfRowsF16C(const uint16_t* a, const uint16_t* b, const uint16_t* c, const uint16_t* d,
+	float* out, uint32_t count)
+{
+	uint32_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128 va = _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + i)));
+		const __m128 vb = _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(b + i)));
+		const __m128 vc = _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(c + i)));
+		const __m128 vd = _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(d + i)));
+		_mm_storeu_ps(out + i, _mm_add_ps(_mm_add_ps(va, vb), _mm_add_ps(vc, vd)));
+	}
+	return i;
+}
+#endif
+
+struct Float16Traits {
+	using Element = uint16_t;
+	using Accum = float;
+
+	static void SumRows(const uint16_t* a, const uint16_t* b, const uint16_t* c, const uint16_t* d,
+		float* out, uint32_t count)
+	{
+		uint32_t i = 0;
+#if defined(SPARSE_X86)
+		static const bool hasF16C = CpuFeatures::HasF16C();
+		if (hasF16C) {
+			i = SumHalfRowsF16C(a, b, c, d, out, count);
+		}
+#elif defined(SPARSE_NEON)
+		for (; i + 4 <= count; i += 4) {
+			const float32x4_t va = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(a + i)));
+			const float32x4_t vb = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(b + i)));
+			const float32x4_t vc = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(c + i)));
+			const float32x4_t vd = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(d + i)));
+			vst1q_f32(out + i, vaddq_f32(vaddq_f32(va, vb), vaddq_f32(vc, vd)));
+		}
+#endif
+		for (; i < count; ++i) {
+			out[i] = (HalfFloat::ToFloat(a[i]) + HalfFloat::ToFloat(b[i]))
+				+ (HalfFloat::ToFloat(c[i]) + HalfFloat::ToFloat(d[i]));
+		}
+	}
+
+	static uint16_t Finish(float left, float right)
+	{
+		return HalfFloat::FromFloat((left + right) * 0.125f);
+	}
+};
+
+// R11G11B10_FLOAT and R9G9B9E5_SHAREDEXP pack three channels into one 32-bit
+// texel, so they are averaged a whole texel at a time in float
+struct Float3 {
+	float r, g, b;
+};
+
+template <void (*Unpack)(uint32_t, float*), uint32_t (*Pack)(float, float, float)>
+struct PackedFloat3Traits {
+	using Element = uint32_t;
+	using Accum = Float3;
+
+	static void SumRows(const uint32_t* a, const uint32_t* b, const uint32_t* c, const uint32_t* d,
+		Float3* out, uint32_t count)
+	{
+		float va[3], vb[3], vc[3], vd[3];
+		for (uint32_t i = 0; i < count; ++i) {
+			Unpack(a[i], va);
+			Unpack(b[i], vb);
+			Unpack(c[i], vc);
+			Unpack(d[i], vd);
+			out[i] = {
+				(va[0] + vb[0]) + (vc[0] + vd[0]),
+				(va[1] + vb[1]) + (vc[1] + vd[1]),
+				(va[2] + vb[2]) + (vc[2] + vd[2]) };
+		}
+	}
+
+	static uint32_t Finish(const Float3& left, const Float3& right)
+	{
+		return Pack(
+			(left.r + right.r) * 0.125f,
+			(left.g + right.g) * 0.125f,
+			(left.b + right.b) * 0.125f);
+	}
+};
+
+using R11G11B10Traits = PackedFloat3Traits<&UnpackR11G11B10Float, &PackR11G11B10Float>;
+using R9G9B9E5Traits = PackedFloat3Traits<&UnpackR9G9B9E5SharedExp, &PackR9G9B9E5SharedExp>;
+
+template <typename Traits, uint32_t Channels>
+void DownsampleAverage(const std::byte* child, std::byte* parent, const MipTileShape& shape,
+	uint32_t octantX, uint32_t octantY, uint32_t octantZ)
+{
+	using Element = typename Traits::Element;
+
+	const uint32_t rowElements = shape.width * Channels;
+	const uint32_t sliceElements = rowElements * shape.height;
+	const uint32_t halfWidth = shape.width / 2;
+	const uint32_t halfHeight = shape.height / 2;
+	const uint32_t halfDepth = shape.depth / 2;
+
+	if (rowElements > MAX_ROW_ELEMENTS) {
+		return;
+	}
+
+	const Element* src = reinterpret_cast<const Element*>(child);
+	Element* dst = reinterpret_cast<Element*>(parent)
+		+ octantZ * halfDepth * sliceElements
+		+ octantY * halfHeight * rowElements
+		+ octantX * halfWidth * Channels;
+
+	std::array<typename Traits::Accum, MAX_ROW_ELEMENTS> sums;
+
+	for (uint32_t z = 0; z < halfDepth; ++z) {
+		for (uint32_t y = 0; y < halfHeight; ++y) {
+			const Element* row00 = src + (2 * z) * sliceElements + (2 * y) * rowElements;
+			const Element* row01 = row00 + rowElements;
+			const Element* row10 = row00 + sliceElements;
+			const Element* row11 = row10 + rowElements;
+			Traits::SumRows(row00, row01, row10, row11, sums.data(), rowElements);
+
+			Element* out = dst + z * sliceElements + y * rowElements;
+			for (uint32_t x = 0; x < halfWidth; ++x) {
+				const uint32_t left = (2 * x) * Channels;
+				for (uint32_t c = 0; c < Channels; ++c) {
+					out[x * Channels + c] = Traits::Finish(sums[left + c], sums[left + Channels + c]);
+				}
+			}
+		}
+	}
+}
+
+// 128-bit texel compared as a whole for the majority filter
+struct Texel128 {
+	uint64_t lo;
+	uint64_t hi;
+
+	bool operator==(const Texel128& other) const { return lo == other.lo && hi == other.hi; }
+};
+
+// Returns the index of the most frequent of 8 values. Ties go to the value
+// that appears first, so the result is deterministic.
+template <typename T>
+uint32_t MostFrequent(const T (&values)[8])
+{
+	uint32_t bestIndex = 0;
+	uint32_t bestCount = 0;
+	for (uint32_t i = 0; i < 8 && bestCount * 2 <= 8; ++i) {
+		uint32_t count = 0;
+		for (uint32_t j = 0; j < 8; ++j) {
+			count += values[i] == values[j] ? 1 : 0;
+		}
+		if (count > bestCount) {
+			bestCount = count;
+			bestIndex = i;
+		}
+	}
+	return bestIndex;
+}
+
+#if defined(SPARSE_X86)
+// Texels up to 32 bits: widen once, then each candidate costs two compares
+// and a popcount instead of eight scalar compares.
+template <typename T>
+	requires (sizeof(T) <= 4)
+uint32_t MostFrequentSimd(const T (&values)[8])
+{
+	alignas(16) uint32_t wide[8];
+	for (uint32_t i = 0; i < 8; ++i) {
+		wide[i] = static_cast<uint32_t>(values[i]);
+	}
+	const __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(wide));
+	const __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(wide + 4));
+
+	uint32_t bestIndex = 0;
+	uint32_t bestCount = 0;
+	uint32_t visited = 0;
+	for (uint32_t i = 0; i < 8; ++i) {
+		if (visited & (1u << i)) {
+			continue;
+		}
+		const __m128i candidate = _mm_set1_epi32(static_cast<int>(wide[i]));
+		const uint32_t mask =
+			static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(lo, candidate))))
+			| (static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(hi, candidate)))) << 4);
+		visited |= mask;
+
+		const uint32_t count = static_cast<uint32_t>(std::popcount(mask));
+		if (count > bestCount) {
+			bestCount = count;
+			bestIndex = i;
+			if (count * 2 > 8) {
+				break;
+			}
+		}
+	}
+	return bestIndex;
+}
+#endif
+
+template <typename T>
+void DownsampleMajority(const std::byte* child, std::byte* parent, const MipTileShape& shape,
+	uint32_t octantX, uint32_t octantY, uint32_t octantZ)
+{
+	const uint32_t rowTexels = shape.width;
+	const uint32_t sliceTexels = rowTexels * shape.height;
+	const uint32_t halfWidth = shape.width / 2;
+	const uint32_t halfHeight = shape.height / 2;
+	const uint32_t halfDepth = shape.depth / 2;
+
+	const T* src = reinterpret_cast<const T*>(child);
+	T* dst = reinterpret_cast<T*>(parent)
+		+ octantZ * halfDepth * sliceTexels
+		+ octantY * halfHeight * rowTexels
+		+ octantX * halfWidth;
+
+	T values[8];
+	for (uint32_t z = 0; z < halfDepth; ++z) {
+		for (uint32_t y = 0; y < halfHeight; ++y) {
+			const T* row00 = src + (2 * z) * sliceTexels + (2 * y) * rowTexels;
+			const T* row01 = row00 + rowTexels;
+			const T* row10 = row00 + sliceTexels;
+			const T* row11 = row10 + rowTexels;
+			T* out = dst + z * sliceTexels + y * rowTexels;
+
+			for (uint32_t x = 0; x < halfWidth; ++x) {
+				const uint32_t sx = 2 * x;
+				values[0] = row00[sx]; values[1] = row00[sx + 1];
+				values[2] = row01[sx]; values[3] = row01[sx + 1];
+				values[4] = row10[sx]; values[5] = row10[sx + 1];
+				values[6] = row11[sx]; values[7] = row11[sx + 1];
+
+#if defined(SPARSE_X86)
+				if constexpr (sizeof(T) <= 4) {
+					out[x] = values[MostFrequentSimd(values)];
+				}
+				else {
+					out[x] = values[MostFrequent(values)];
+				}
+#else
+				out[x] = values[MostFrequent(values)];
+#endif
+			}
+		}
+	}
+}
+
+bool IsIntegerFormat(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R32_UINT:
+	case DXGI_FORMAT_R32_SINT:
+	case DXGI_FORMAT_R16_UINT:
+	case DXGI_FORMAT_R16_SINT:
+	case DXGI_FORMAT_R8_UINT:
+	case DXGI_FORMAT_R8_SINT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+} // namespace
+
+MipFilter ResolveMipFilter(DXGI_FORMAT format, MipFilter filter)
+{
+	if (filter != MipFilter::Auto) {
+		return filter;
+	}
+	return IsIntegerFormat(format) ? MipFilter::Majority : MipFilter::Average;
+}
+
+MipDownsampleKernel GetMipDownsampleKernel(DXGI_FORMAT format, uint32_t bytesPerPixel, MipFilter filter)
+{
+	switch (ResolveMipFilter(format, filter))
+	{
+	case MipFilter::Average:
+		switch (format)
+		{
+		case DXGI_FORMAT_R8_UNORM:           return &DownsampleAverage<Unorm8Traits, 1>;
+		case DXGI_FORMAT_R8G8_UNORM:         return &DownsampleAverage<Unorm8Traits, 2>;
+		case DXGI_FORMAT_R8G8B8A8_UNORM:     return &DownsampleAverage<Unorm8Traits, 4>;
+		case DXGI_FORMAT_R16_FLOAT:          return &DownsampleAverage<Float16Traits, 1>;
+		case DXGI_FORMAT_R16G16_FLOAT:       return &DownsampleAverage<Float16Traits, 2>;
+		case DXGI_FORMAT_R16G16B16A16_FLOAT: return &DownsampleAverage<Float16Traits, 4>;
+		case DXGI_FORMAT_R32_FLOAT:          return &DownsampleAverage<Float32Traits, 1>;
+		case DXGI_FORMAT_R32G32_FLOAT:       return &DownsampleAverage<Float32Traits, 2>;
+		case DXGI_FORMAT_R32G32B32A32_FLOAT: return &DownsampleAverage<Float32Traits, 4>;
+		case DXGI_FORMAT_R11G11B10_FLOAT:    return &DownsampleAverage<R11G11B10Traits, 1>;
+		case DXGI_FORMAT_R9G9B9E5_SHAREDEXP: return &DownsampleAverage<R9G9B9E5Traits, 1>;
+		default:
+			// Averaging integer IDs produces values that were never written
+			return nullptr;
+		}
+
+	case MipFilter::Majority:
+		// Majority only compares whole texels, so any format works by size
+		switch (bytesPerPixel)
+		{
+		case 1:  return &DownsampleMajority<uint8_t>;
+		case 2:  return &DownsampleMajority<uint16_t>;
+		case 4:  return &DownsampleMajority<uint32_t>;
+		case 8:  return &DownsampleMajority<uint64_t>;
+		case 16: return &DownsampleMajority<Texel128>;
+		default: return nullptr;
+		}
+
+	default:
+		return nullptr;
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <dxgiformat.h>
+
+// Filter used to reduce each 2x2x2 block of child texels to one parent texel
+enum class MipFilter : uint32_t {
+	None = 0,
+	Average = 1,   // Box filter, for continuous data such as lighting or density
+	Majority = 2,  // Most frequent value, for categorical data such as block IDs
+	Auto = 3       // Majority for integer formats, Average otherwise
+};
+
+// Texel dimensions of one 64KB tile for a given format
+struct MipTileShape {
+	uint32_t width;
+	uint32_t height;
+	uint32_t depth;
+};
+
+// Downsamples a whole child tile into one octant of its parent tile. Both
+// tiles are linear (x fastest, then y, then z) and share the same shape;
+// octantX/Y/Z select which half of the parent the child covers.
+using MipDownsampleKernel = void(*)(
+	const std::byte* child,
+	std::byte* parent,
+	const MipTileShape& shape,
+	uint32_t octantX, uint32_t octantY, uint32_t octantZ);
+
+// Replaces Auto with the concrete filter for this format
+MipFilter ResolveMipFilter(DXGI_FORMAT format, MipFilter filter);
+
+// Returns the kernel for a format/filter pair, or nullptr if the pair is not
+// supported (e.g. Average on an integer format)
+MipDownsampleKernel GetMipDownsampleKernel(DXGI_FORMAT format, uint32_t bytesPerPixel, MipFilter filter);
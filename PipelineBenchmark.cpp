@@ -0,0 +1,222 @@
+#include "pch.h"
+#include "PipelineBenchmark.h"
+#include "PipelineStats.h"
+#include "RenderingPlugin.h"
+#include <bitset>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr UINT VOLUME_TILES = 8;
+constexpr UINT TILE_BYTES = 65536;
+constexpr uint32_t MAX_THREADS = 16;
+
+// xorshift64; each thread seeds its own so runs are repeatable
+uint64_t NextRandom(uint64_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+TileBox RandomBox(uint64_t& state, UINT edge)
+{
+	const UINT positions = VOLUME_TILES - edge + 1;
+	TileBox box = {};
+	box.subResource = 0;
+	box.startX = static_cast<UINT>(NextRandom(state) % positions);
+	box.startY = static_cast<UINT>(NextRandom(state) % positions);
+	box.startZ = static_cast<UINT>(NextRandom(state) % positions);
+	box.width = edge;
+	box.height = edge;
+	box.depth = edge;
+	return box;
+}
+
+// Which tiles of a thread's volume are mapped, so box uploads, which fail
+// on mapped tiles, can be aimed at free space
+class Occupancy {
+public:
+	bool IsFree(const TileBox& box) const
+	{
+		bool free = true;
+		ForEachTile(box, [&](UINT index) { free = free && !m_mapped[index]; });
+		return free;
+	}
+
+	void Set(const TileBox& box, bool mapped)
+	{
+		ForEachTile(box, [&](UINT index) { m_mapped[index] = mapped; });
+	}
+
+private:
+	template <typename F>
+	static void ForEachTile(const TileBox& box, F&& f)
+	{
+		for (UINT z = box.startZ; z < box.startZ + box.depth; ++z)
+			for (UINT y = box.startY; y < box.startY + box.height; ++y)
+				for (UINT x = box.startX; x < box.startX + box.width; ++x)
+					f((z * VOLUME_TILES + y) * VOLUME_TILES + x);
+	}
+
+	std::bitset<VOLUME_TILES * VOLUME_TILES * VOLUME_TILES> m_mapped;
+};
+
+struct ThreadTotals {
+	uint64_t calls = 0;
+	uint64_t failedCalls = 0;
+	uint64_t tiles = 0;
+};
+
+void RunWorkload(
+	RenderingPlugin& plugin,
+	ReservedResource* resource,
+	const PipelineBenchmarkSettings& settings,
+	uint32_t threadIndex,
+	LatencyHistogram& latency,
+	ThreadTotals& totals)
+{
+	using Clock = std::chrono::steady_clock;
+	const UINT boxTiles = settings.boxEdge * settings.boxEdge * settings.boxEdge;
+	std::vector<std::byte> payload(static_cast<size_t>(boxTiles) * TILE_BYTES);
+	for (size_t i = 0; i < payload.size(); ++i) {
+		payload[i] = static_cast<std::byte>(i * 31 + threadIndex);
+	}
+	std::span<std::byte> tileData(payload.data(), TILE_BYTES);
+	std::span<std::byte> boxData(payload);
+
+	Occupancy occupancy;
+	auto timedCall = [&](auto&& call, UINT tiles) {
+		const Clock::time_point start = Clock::now();
+		const bool ok = call();
+		latency.Record(static_cast<uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+		++totals.calls;
+		if (ok) {
+			totals.tiles += tiles;
+		}
+		else {
+			++totals.failedCalls;
+		}
+		return ok;
+	};
+
+	uint64_t state = 0x9E3779B97F4A7C15ull * (threadIndex + 1);
+	for (uint32_t i = 0; i < settings.uploadsPerThread; ++i) {
+		UINT roll = 0;
+		switch (settings.workload) {
+		case BenchmarkWorkload::SingleTile: roll = 0; break;
+		case BenchmarkWorkload::TileBox: roll = 70; break;
+		case BenchmarkWorkload::Mixed: roll = static_cast<UINT>(NextRandom(state) % 100); break;
+		}
+
+		if (roll < 70) {
+			// Re-uploading a mapped tile is allowed and reuses its page
+			const TileBox tile = RandomBox(state, 1);
+			if (timedCall([&] { return plugin.UploadDataToTile(resource, 0, tile.startX, tile.startY, tile.startZ, tileData); }, 1)) {
+				occupancy.Set(tile, true);
+			}
+		}
+		else if (roll < 90) {
+			TileBox box = RandomBox(state, settings.boxEdge);
+			for (UINT attempt = 0; attempt < 8 && !occupancy.IsFree(box); ++attempt) {
+				box = RandomBox(state, settings.boxEdge);
+			}
+			// Nowhere free: evict the box first, as a streamer would. The
+			// unmap is timed and counted as a call of its own.
+			if (!occupancy.IsFree(box) && timedCall([&] { return plugin.UnmapTileBox(resource, box); }, 0)) {
+				occupancy.Set(box, false);
+			}
+			if (timedCall([&] { return plugin.UploadDataToTileBox(resource, box, boxData); }, boxTiles)) {
+				occupancy.Set(box, true);
+			}
+		}
+		else {
+			const TileBox box = RandomBox(state, settings.boxEdge);
+			if (timedCall([&] { return plugin.UnmapTileBox(resource, box); }, 0)) {
+				occupancy.Set(box, false);
+			}
+		}
+	}
+}
+
+} // namespace
+
+bool RunPipelineBenchmark(
+	RenderingPlugin& plugin,
+	const PipelineBenchmarkSettings& settings,
+	PipelineBenchmarkResult* outResult,
+	std::string* outError)
+{
+	*outResult = {};
+	outError->clear();
+
+	if (settings.workload > BenchmarkWorkload::Mixed) {
+		*outError = std::format("unknown workload {}", static_cast<uint32_t>(settings.workload));
+		return false;
+	}
+	if (settings.threads == 0 || settings.threads > MAX_THREADS) {
+		*outError = std::format("threads must be 1 to {}, got {}", MAX_THREADS, settings.threads);
+		return false;
+	}
+	if (settings.boxEdge == 0 || settings.boxEdge > VOLUME_TILES) {
+		*outError = std::format("boxEdge must be 1 to {}, got {}", VOLUME_TILES, settings.boxEdge);
+		return false;
+	}
+
+	// At 8x8x8 tiles, 16 volumes exactly fill the 512MB tile heap
+	std::vector<VolumeHandle> volumes;
+	std::vector<ReservedResource*> resources;
+	for (uint32_t i = 0; i < settings.threads; ++i) {
+		const VolumeHandle handle = plugin.CreateVolumetricResource(
+			VOLUME_TILES * 32, VOLUME_TILES * 32, VOLUME_TILES * 16,
+			false, 1, DXGI_FORMAT_R8G8B8A8_UNORM);
+		if (!handle) {
+			*outError = std::format("failed to create volume {}", i);
+			break;
+		}
+		volumes.push_back(handle);
+		resources.push_back(plugin.GetVolumetricResource(handle));
+	}
+
+	if (outError->empty()) {
+		LatencyHistogram latency;
+		std::vector<ThreadTotals> totals(settings.threads);
+		std::vector<std::thread> workers;
+		workers.reserve(settings.threads);
+
+		const auto start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < settings.threads; ++i) {
+			workers.emplace_back([&, i] {
+				RunWorkload(plugin, resources[i], settings, i, latency, totals[i]);
+			});
+		}
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+		outResult->elapsedNs = static_cast<uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+		for (const ThreadTotals& t : totals) {
+			outResult->calls += t.calls;
+			outResult->failedCalls += t.failedCalls;
+			outResult->tiles += t.tiles;
+		}
+		outResult->tilesPerSecond = outResult->elapsedNs
+			? static_cast<double>(outResult->tiles) * 1e9 / static_cast<double>(outResult->elapsedNs)
+			: 0.0;
+		outResult->p50Ns = latency.Percentile(0.50);
+		outResult->p99Ns = latency.Percentile(0.99);
+		outResult->maxNs = latency.Max();
+	}
+
+	for (VolumeHandle handle : volumes) {
+		plugin.DestroyVolumetricResource(handle);
+	}
+	return outError->empty();
+}
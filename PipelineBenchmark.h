@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+class RenderingPlugin;
+
+enum class BenchmarkWorkload : uint32_t {
+	SingleTile = 0,   // UploadDataToTile, one tile per call
+	TileBox = 1,      // UploadDataToTileBox, boxEdge^3 tiles per call
+	Mixed = 2         // Random mix: 70% single tiles, 20% boxes, 10% box unmaps
+};
+
+struct PipelineBenchmarkSettings {
+	BenchmarkWorkload workload;
+	uint32_t threads;            // 1 to 16; each thread drives its own volume
+	uint32_t uploadsPerThread;   // Workload steps per thread (see RunPipelineBenchmark)
+	uint32_t boxEdge;            // Box edge in tiles, 1 to 8
+	uint64_t fenceLatencyNs;     // Software backend only
+	bool useSoftwareBackend;     // Otherwise runs against the live device
+};
+
+struct PipelineBenchmarkResult {
+	uint64_t calls;
+	uint64_t failedCalls;
+	uint64_t tiles;              // Tiles uploaded by successful calls
+	uint64_t elapsedNs;
+	double tilesPerSecond;
+
+	// Per-call latency across all threads
+	uint64_t p50Ns;
+	uint64_t p99Ns;
+	uint64_t maxNs;
+};
+
+// Drives the upload pipeline end to end from settings.threads threads, each
+// against its own 256x256x128 RGBA8 volume (8x8x8 tiles), and reports
+// throughput and call latency. Box uploads are aimed at unmapped space;
+// when a few random tries find none, the box is unmapped first, which adds
+// a call to that step. Every call, unmaps included, is timed. Volumes are
+// destroyed before returning.
+// Returns false with outError set if the settings are invalid or a volume
+// cannot be created; failed calls are only counted.
+bool RunPipelineBenchmark(
+	RenderingPlugin& plugin,
+	const PipelineBenchmarkSettings& settings,
+	PipelineBenchmarkResult* outResult,
+	std::string* outError);
@@ -0,0 +1,99 @@
+#include "pch.h"
+#include "PipelineStats.h"
+#include <algorithm>
+#include <bit>
+
+uint32_t LatencyHistogram::BucketIndex(uint64_t value)
+{
+	if (value < SUB_BUCKETS) {
+		return static_cast<uint32_t>(value);
+	}
+
+	// The leading bit picks the power of two, the next bits the sub-bucket
+	const uint32_t exponent = static_cast<uint32_t>(std::bit_width(value)) - 1;
+	const uint32_t sub = static_cast<uint32_t>(value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+	return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::BucketLowerBound(uint32_t index)
+{
+	if (index < SUB_BUCKETS) {
+		return index;
+	}
+
+	const uint32_t exponent = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+	const uint64_t sub = index % SUB_BUCKETS;
+	return (SUB_BUCKETS + sub) << (exponent - SUB_BUCKET_BITS);
+}
+
+void LatencyHistogram::Record(uint64_t value)
+{
+	m_buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+	m_count.fetch_add(1, std::memory_order_relaxed);
+	m_total.fetch_add(value, std::memory_order_relaxed);
+
+	uint64_t max = m_max.load(std::memory_order_relaxed);
+	while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+	}
+}
+
+void LatencyHistogram::Reset()
+{
+	for (std::atomic<uint64_t>& bucket : m_buckets) {
+		bucket.store(0, std::memory_order_relaxed);
+	}
+	m_count.store(0, std::memory_order_relaxed);
+	m_total.store(0, std::memory_order_relaxed);
+	m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Percentile(double fraction) const
+{
+	// Sum the buckets rather than trusting m_count, which may be a few
+	// records ahead of them
+	uint64_t total = 0;
+	for (const std::atomic<uint64_t>& bucket : m_buckets) {
+		total += bucket.load(std::memory_order_relaxed);
+	}
+	if (total == 0) {
+		return 0;
+	}
+
+	const uint64_t rank = (std::max)(static_cast<uint64_t>(fraction * static_cast<double>(total) + 0.5), uint64_t{ 1 });
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+		seen += m_buckets[i].load(std::memory_order_relaxed);
+		if (seen >= rank) {
+			const uint64_t upper = i + 1 < BUCKET_COUNT ? BucketLowerBound(i + 1) - 1 : UINT64_MAX;
+			return (std::min)(upper, Max());
+		}
+	}
+	return Max();
+}
+
+void PipelineStats::Snapshot(C_PipelineStats& outStats) const
+{
+	for (uint32_t i = 0; i < PIPELINE_STAGE_COUNT; ++i) {
+		const LatencyHistogram& histogram = m_stages[i];
+		C_PipelineStageStats& stage = outStats.stages[i];
+		stage.count = histogram.Count();
+		stage.totalNs = histogram.Total();
+		stage.maxNs = histogram.Max();
+		stage.p50Ns = histogram.Percentile(0.50);
+		stage.p90Ns = histogram.Percentile(0.90);
+		stage.p99Ns = histogram.Percentile(0.99);
+	}
+	for (uint32_t i = 0; i < PIPELINE_COUNTER_COUNT; ++i) {
+		outStats.counters[i] = m_counters[i].load(std::memory_order_relaxed);
+	}
+}
+
+void PipelineStats::Reset()
+{
+	for (LatencyHistogram& histogram : m_stages) {
+		histogram.Reset();
+	}
+	for (std::atomic<uint64_t>& counter : m_counters) {
+		counter.store(0, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Define SPARSE_NO_PIPELINE_STATS to compile the instrumentation out; the
+// snapshot exports then report failure.
+#if !defined(SPARSE_NO_PIPELINE_STATS)
+#define SPARSE_PIPELINE_STATS 1
+#endif
+
+enum class PipelineStage : uint32_t {
+	Validate = 0,      // Parameter and size validation
+	AcquireSlot,       // Ring slot acquire, including its fence wait
+	StageFill,         // Writing payloads into staging memory
+	MapTiles,          // UpdateTileMappings for newly mapped tiles
+	RecordCopy,        // Recording a batch of copies into the command list
+	Submit,            // SubmitUpload, including waiting for the submit lock
+	Unmap,             // NULL mappings, including the residency map flush
+	Count
+};
+
+enum class PipelineCounter : uint32_t {
+	BytesUploaded = 0,
+	TilesMapped,
+	TilesUnmapped,
+	Count
+};
+
+constexpr uint32_t PIPELINE_STAGE_COUNT = static_cast<uint32_t>(PipelineStage::Count);
+constexpr uint32_t PIPELINE_COUNTER_COUNT = static_cast<uint32_t>(PipelineCounter::Count);
+
+// Log-linear histogram of nanosecond durations. Values below 8 get a bucket
+// each; above that every power of two is split into 8 buckets, so a bucket
+// is at most 12.5% wide. Lock-free; concurrent Records only contend on the
+// cache lines they touch.
+class LatencyHistogram {
+public:
+	static constexpr uint32_t SUB_BUCKET_BITS = 3;
+	static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+	static constexpr uint32_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+	static uint32_t BucketIndex(uint64_t value);
+	static uint64_t BucketLowerBound(uint32_t index);
+
+	void Record(uint64_t value);
+	void Reset();
+
+	uint64_t Count() const { return m_count.load(std::memory_order_relaxed); }
+	uint64_t Total() const { return m_total.load(std::memory_order_relaxed); }
+	uint64_t Max() const { return m_max.load(std::memory_order_relaxed); }
+	uint64_t Bucket(uint32_t index) const { return m_buckets[index].load(std::memory_order_relaxed); }
+
+	// Upper bound of the bucket holding the given fraction of samples,
+	// capped at the largest sample; 0 when empty
+	uint64_t Percentile(double fraction) const;
+
+private:
+	std::atomic<uint64_t> m_buckets[BUCKET_COUNT] = {};
+	std::atomic<uint64_t> m_count{ 0 };
+	std::atomic<uint64_t> m_total{ 0 };
+	std::atomic<uint64_t> m_max{ 0 };
+};
+
+struct C_PipelineStageStats {
+	uint64_t count;
+	uint64_t totalNs;
+	uint64_t maxNs;
+	uint64_t p50Ns;
+	uint64_t p90Ns;
+	uint64_t p99Ns;
+};
+
+struct C_PipelineStats {
+	C_PipelineStageStats stages[PIPELINE_STAGE_COUNT];
+	uint64_t counters[PIPELINE_COUNTER_COUNT];
+};
+
+// Wall-time histograms per upload/map pipeline stage plus running counters.
+// Snapshots read while other threads record are not atomic as a whole, but
+// each value in them is.
+class PipelineStats {
+public:
+	void Record(PipelineStage stage, uint64_t nanoseconds) {
+		m_stages[static_cast<uint32_t>(stage)].Record(nanoseconds);
+	}
+
+	void Add(PipelineCounter counter, uint64_t value) {
+		m_counters[static_cast<uint32_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+	}
+
+	const LatencyHistogram& Histogram(PipelineStage stage) const {
+		return m_stages[static_cast<uint32_t>(stage)];
+	}
+
+	void Snapshot(C_PipelineStats& outStats) const;
+	void Reset();
+
+private:
+	LatencyHistogram m_stages[PIPELINE_STAGE_COUNT];
+	std::atomic<uint64_t> m_counters[PIPELINE_COUNTER_COUNT] = {};
+};
+
+// Records the lifetime of a scope under one stage
+class PipelineTimer {
+public:
+	PipelineTimer(PipelineStats& stats, PipelineStage stage)
+		: m_stats(stats), m_stage(stage), m_start(std::chrono::steady_clock::now()) {}
+
+	~PipelineTimer() {
+		const auto elapsed = std::chrono::steady_clock::now() - m_start;
+		m_stats.Record(m_stage, static_cast<uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+	}
+
+	PipelineTimer(const PipelineTimer&) = delete;
+	PipelineTimer& operator=(const PipelineTimer&) = delete;
+
+private:
+	PipelineStats& m_stats;
+	PipelineStage m_stage;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+#define SPARSE_STATS_CONCAT_INNER(a, b) a##b
+#define SPARSE_STATS_CONCAT(a, b) SPARSE_STATS_CONCAT_INNER(a, b)
+
+#if defined(SPARSE_PIPELINE_STATS)
+#define SPARSE_STATS_SCOPE(stats, stage) \
+	PipelineTimer SPARSE_STATS_CONCAT(pipelineTimer, __LINE__)((stats), (stage))
+#define SPARSE_STATS_ADD(stats, counter, value) (stats).Add((counter), (value))
+#else
+#define SPARSE_STATS_SCOPE(stats, stage) ((void)0)
+#define SPARSE_STATS_ADD(stats, counter, value) ((void)0)
+#endif
@@ -9,8 +9,12 @@
 #include "FixedHeap.h"
 #include <string>
 #include <memory>
+#include <format>
+#include <algorithm>
+#include <cstring>
 #include "RenderingPlugin.h"
 #include "Diagnostics.h"
+#include "SoftwareBackend.h"
 
 // Unity interfaces
 static IUnityInterfaces* s_UnityInterfaces = nullptr;
@@ -23,6 +27,9 @@ static void UNITY_INTERFACE_API OnGraphicsDeviceEvent(UnityGfxDeviceEventType ev
 
 static std::unique_ptr<RenderingPlugin> g_RenderPlugin;
 
+// Records calls into the exports below while StartCallRecording is active
+static CallRecorder s_CallRecorder;
+
 // This function is called when the plugin is loaded
 extern "C" void UNITY_INTERFACE_EXPORT UNITY_INTERFACE_API
 UnityPluginLoad(IUnityInterfaces* unityInterfaces)
@@ -77,10 +84,41 @@ static void UNITY_INTERFACE_API OnGraphicsDeviceEvent(UnityGfxDeviceEventType ev
 	}
 }
 
-ReservedResource* UNITY_INTERFACE_API CreateVolumetricResource(UINT width, UINT height, UINT depth, bool useMipmaps, UINT mipmapCount, DXGI_FORMAT format)
+// Looks up the volume behind a handle; nullptr, with an error logged, if it
+// has been destroyed. Exports hold the pin for the whole call, so a
+// concurrent DestroyVolumetricResource waits for them instead of freeing
+// the volume underneath.
+static std::shared_ptr<ReservedResource> ResolveVolume(VolumeHandle volume)
+{
+	return g_RenderPlugin ? g_RenderPlugin->PinVolumetricResource(volume) : nullptr;
+}
+
+static void RecordCreateCall(
+	uint64_t callStart,
+	UINT width, UINT height, UINT depth,
+	bool useMipmaps, UINT mipmapCount,
+	DXGI_FORMAT format, UINT flags,
+	VolumeHandle result)
+{
+	CallRecord call;
+	call.op = CallOp::CreateVolume;
+	call.timestampNs = callStart;
+	call.volume = result;
+	call.succeeded = result != 0;
+	call.width = width;
+	call.height = height;
+	call.depth = depth;
+	call.useMipmaps = useMipmaps;
+	call.mipCount = mipmapCount;
+	call.format = static_cast<uint32_t>(format);
+	call.flags = flags;
+	s_CallRecorder.Record(call);
+}
+
+static VolumeHandle CreateVolumetricResourceImpl(UINT width, UINT height, UINT depth, bool useMipmaps, UINT mipmapCount, DXGI_FORMAT format)
 {
 	try {
-		ReservedResource* newResource = g_RenderPlugin->CreateVolumetricResource(
+		VolumeHandle newResource = g_RenderPlugin->CreateVolumetricResource(
 			width, height, depth,
 			useMipmaps, mipmapCount,
 			format
@@ -89,19 +127,61 @@ ReservedResource* UNITY_INTERFACE_API CreateVolumetricResource(UINT width, UINT
 	}
 	catch (const std::exception& ex) {
 		UNITY_LOG(s_Log, ex.what());
-		return nullptr;
+		return 0;
+	}
+	return 0;
+}
+
+VolumeHandle UNITY_INTERFACE_API CreateVolumetricResource(UINT width, UINT height, UINT depth, bool useMipmaps, UINT mipmapCount, DXGI_FORMAT format)
+{
+	if (!s_CallRecorder.IsRecording()) {
+		return CreateVolumetricResourceImpl(width, height, depth, useMipmaps, mipmapCount, format);
+	}
+	const uint64_t callStart = s_CallRecorder.BeginCall();
+	const VolumeHandle result = CreateVolumetricResourceImpl(width, height, depth, useMipmaps, mipmapCount, format);
+	RecordCreateCall(callStart, width, height, depth, useMipmaps, mipmapCount, format, VOLUME_CREATE_FLAG_NONE, result);
+	return result;
+}
+
+static VolumeHandle CreateVolumetricResourceExImpl(UINT width, UINT height, UINT depth, bool useMipmaps, UINT mipmapCount, DXGI_FORMAT format, UINT flags)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "CreateVolumetricResourceEx: plugin not initialized");
+			return 0;
+		}
+		return g_RenderPlugin->CreateVolumetricResource(
+			width, height, depth,
+			useMipmaps, mipmapCount,
+			format, flags
+		);
 	}
-	return nullptr;
+	catch (const std::exception& ex) {
+		UNITY_LOG(s_Log, ex.what());
+		return 0;
+	}
+}
+
+VolumeHandle UNITY_INTERFACE_API CreateVolumetricResourceEx(UINT width, UINT height, UINT depth, bool useMipmaps, UINT mipmapCount, DXGI_FORMAT format, UINT flags)
+{
+	if (!s_CallRecorder.IsRecording()) {
+		return CreateVolumetricResourceExImpl(width, height, depth, useMipmaps, mipmapCount, format, flags);
+	}
+	const uint64_t callStart = s_CallRecorder.BeginCall();
+	const VolumeHandle result = CreateVolumetricResourceExImpl(width, height, depth, useMipmaps, mipmapCount, format, flags);
+	RecordCreateCall(callStart, width, height, depth, useMipmaps, mipmapCount, format, flags, result);
+	return result;
 }
 
-bool UNITY_INTERFACE_API DestroyVolumetricResource(ReservedResource* resource)
+static bool DestroyVolumetricResourceImpl(VolumeHandle volume)
 {
 	try {
 		if (!g_RenderPlugin)
 		{
 			return true;
 		}
-		return g_RenderPlugin->DestroyVolumetricResource(resource);
+		return g_RenderPlugin->DestroyVolumetricResource(volume);
 	}
 	catch (const std::exception& ex) {
 		UNITY_LOG(s_Log, ex.what());
@@ -110,9 +190,24 @@ bool UNITY_INTERFACE_API DestroyVolumetricResource(ReservedResource* resource)
 	return false;
 }
 
-ID3D12Resource* UNITY_INTERFACE_API GetPointerToD3D12Resource(ReservedResource* resource)
+bool UNITY_INTERFACE_API DestroyVolumetricResource(VolumeHandle volume)
+{
+	if (!s_CallRecorder.IsRecording()) {
+		return DestroyVolumetricResourceImpl(volume);
+	}
+	CallRecord call;
+	call.op = CallOp::DestroyVolume;
+	call.timestampNs = s_CallRecorder.BeginCall();
+	call.volume = volume;
+	call.succeeded = DestroyVolumetricResourceImpl(volume);
+	s_CallRecorder.Record(call);
+	return call.succeeded;
+}
+
+ID3D12Resource* UNITY_INTERFACE_API GetPointerToD3D12Resource(VolumeHandle volume)
 {
 	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
 		if (resource == nullptr)
 		{
 			UNITY_LOG_ERROR(s_Log, "Supplied ReservedResource object is null");
@@ -127,8 +222,9 @@ ID3D12Resource* UNITY_INTERFACE_API GetPointerToD3D12Resource(ReservedResource*
 	}
 }
 
-UNITY_INTERFACE_EXPORT void GetResourceTilingInfo(ReservedResource* resource, C_ResourceTilingInfo* outInfo) {
+UNITY_INTERFACE_EXPORT void GetResourceTilingInfo(VolumeHandle volume, C_ResourceTilingInfo* outInfo) {
 	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
 		if (resource == nullptr)
 		{
 			return;
@@ -148,15 +244,36 @@ UNITY_INTERFACE_EXPORT void GetResourceTilingInfo(ReservedResource* resource, C_
 	}
 }
 
+UNITY_INTERFACE_EXPORT void GetPackedMipInfo(VolumeHandle volume, C_PackedMipInfo* outInfo) {
+	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
+		if (resource == nullptr || outInfo == nullptr)
+		{
+			return;
+		}
+		const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+		outInfo->NumStandardMips = tilingInfo.NumStandardMips;
+		outInfo->NumPackedMips = tilingInfo.NumPackedMips;
+		outInfo->NumTilesForPackedMips = tilingInfo.NumTilesForPackedMips;
+		outInfo->StartTileIndexInOverallResource = tilingInfo.PackedMipStartTileIndex;
+	}
+	catch (const std::exception& ex)
+	{
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return;
+	}
+}
 
-UNITY_INTERFACE_EXPORT bool UploadDataToTile(
-	ReservedResource* tiledResource,
+
+static bool UploadDataToTileImpl(
+	VolumeHandle volume,
 	UINT subResource,
 	UINT tileX, UINT tileY, UINT tileZ,
 	void* sourceData,
 	UINT dataSize
 ) {
 	try {
+		std::shared_ptr<ReservedResource> tiledResource = ResolveVolume(volume);
 		if (!g_RenderPlugin)
 		{
 			UNITY_LOG_ERROR(s_Log, "UploadDataToTile: plugin not initialized");
@@ -173,7 +290,7 @@ UNITY_INTERFACE_EXPORT bool UploadDataToTile(
 		);
 
 		return g_RenderPlugin->UploadDataToTile(
-			tiledResource,
+			tiledResource.get(),
 			subResource,
 			tileX, tileY, tileZ,
 			dataSpan
@@ -188,6 +305,100 @@ UNITY_INTERFACE_EXPORT bool UploadDataToTile(
 
 }
 
+UNITY_INTERFACE_EXPORT bool UploadDataToTile(
+	VolumeHandle volume,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ,
+	void* sourceData,
+	UINT dataSize
+) {
+	if (!s_CallRecorder.IsRecording()) {
+		return UploadDataToTileImpl(volume, subResource, tileX, tileY, tileZ, sourceData, dataSize);
+	}
+	CallRecord call;
+	call.op = CallOp::UploadTile;
+	call.timestampNs = s_CallRecorder.BeginCall();
+	call.volume = volume;
+	call.subresource = subResource;
+	call.x = tileX;
+	call.y = tileY;
+	call.z = tileZ;
+	call.payload = static_cast<const std::byte*>(sourceData);
+	call.payloadSize = dataSize;
+	call.succeeded = UploadDataToTileImpl(volume, subResource, tileX, tileY, tileZ, sourceData, dataSize);
+	s_CallRecorder.Record(call);
+	return call.succeeded;
+}
+
+UNITY_INTERFACE_EXPORT bool SwizzleTileData(
+	VolumeHandle volume,
+	const void* linearData,
+	void* swizzledData,
+	UINT dataSize
+) {
+	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "SwizzleTileData: plugin not initialized");
+			return false;
+		}
+		if (!linearData || !swizzledData)
+		{
+			UNITY_LOG_ERROR(s_Log, "SwizzleTileData: null data pointer");
+			return false;
+		}
+
+		return g_RenderPlugin->SwizzleTileData(
+			resource.get(),
+			std::span<const std::byte>(static_cast<const std::byte*>(linearData), dataSize),
+			std::span<std::byte>(static_cast<std::byte*>(swizzledData), dataSize));
+	}
+	catch (const std::exception& ex)
+	{
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UploadSwizzledDataToTile(
+	VolumeHandle volume,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ,
+	void* sourceData,
+	UINT dataSize
+) {
+	try {
+		std::shared_ptr<ReservedResource> tiledResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadSwizzledDataToTile: plugin not initialized");
+			return false;
+		}
+		if (tiledResource == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "Reserved resource is not assigned");
+			return false;
+		}
+
+		std::span<std::byte> dataSpan(
+			static_cast<std::byte*>(sourceData), dataSize
+		);
+
+		return g_RenderPlugin->UploadSwizzledDataToTile(
+			tiledResource.get(),
+			subResource,
+			tileX, tileY, tileZ,
+			dataSpan
+		);
+	}
+	catch (const std::exception& ex)
+	{
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
 UNITY_INTERFACE_EXPORT bool RunDiagnostics()
 {
 	try {
@@ -205,8 +416,8 @@ UNITY_INTERFACE_EXPORT bool RunDiagnostics()
 	}
 }
 
-UNITY_INTERFACE_EXPORT bool UploadDataToTileBox(
-	ReservedResource* tiledResource,
+static bool UploadDataToTileBoxImpl(
+	VolumeHandle volume,
 	UINT subResource,
 	UINT startX, UINT startY, UINT startZ,
 	UINT width, UINT height, UINT depth,
@@ -215,6 +426,7 @@ UNITY_INTERFACE_EXPORT bool UploadDataToTileBox(
 )
 {
 	try {
+		std::shared_ptr<ReservedResource> tiledResource = ResolveVolume(volume);
 		if (!g_RenderPlugin)
 		{
 			UNITY_LOG_ERROR(s_Log, "UploadDataToTileBox: plugin not initialized");
@@ -238,7 +450,7 @@ UNITY_INTERFACE_EXPORT bool UploadDataToTileBox(
 		std::span<std::byte> dataSpan(
 			static_cast<std::byte*>(sourceData), totalDataSize);
 
-		return g_RenderPlugin->UploadDataToTileBox(tiledResource, box, dataSpan);
+		return g_RenderPlugin->UploadDataToTileBox(tiledResource.get(), box, dataSpan);
 	}
 	catch (const std::exception& ex) {
 		UNITY_LOG_ERROR(s_Log, ex.what());
@@ -246,21 +458,1786 @@ UNITY_INTERFACE_EXPORT bool UploadDataToTileBox(
 	}
 }
 
-UNITY_INTERFACE_EXPORT bool UnmapTile(
-	ReservedResource* resource,
+UNITY_INTERFACE_EXPORT bool UploadDataToTileBox(
+	VolumeHandle volume,
 	UINT subResource,
-	UINT tileX, UINT tileY, UINT tileZ
+	UINT startX, UINT startY, UINT startZ,
+	UINT width, UINT height, UINT depth,
+	void* sourceData,
+	UINT totalDataSize
+)
+{
+	if (!s_CallRecorder.IsRecording()) {
+		return UploadDataToTileBoxImpl(volume, subResource, startX, startY, startZ, width, height, depth, sourceData, totalDataSize);
+	}
+	CallRecord call;
+	call.op = CallOp::UploadTileBox;
+	call.timestampNs = s_CallRecorder.BeginCall();
+	call.volume = volume;
+	call.subresource = subResource;
+	call.x = startX;
+	call.y = startY;
+	call.z = startZ;
+	call.width = width;
+	call.height = height;
+	call.depth = depth;
+	call.payload = static_cast<const std::byte*>(sourceData);
+	call.payloadSize = totalDataSize;
+	call.succeeded = UploadDataToTileBoxImpl(volume, subResource, startX, startY, startZ, width, height, depth, sourceData, totalDataSize);
+	s_CallRecorder.Record(call);
+	return call.succeeded;
+}
+
+static bool UploadDataToTileBoxesImpl(
+	const C_TileBoxUpload* uploads,
+	UINT uploadCount
 )
 {
 	try {
 		if (!g_RenderPlugin)
 		{
-			UNITY_LOG_ERROR(s_Log, "UnmapTile: plugin not initialized");
+			UNITY_LOG_ERROR(s_Log, "UploadDataToTileBoxes: plugin not initialized");
+			return false;
+		}
+		if (!uploads || uploadCount == 0)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadDataToTileBoxes: no uploads");
 			return false;
 		}
-		return g_RenderPlugin->UnmapDataFromTile(resource, subResource, tileX, tileY, tileZ);
 
-	} catch (const std::exception& ex) {
+		std::vector<TileBoxUpload> batch(uploadCount);
+		std::vector<std::shared_ptr<ReservedResource>> pins(uploadCount);
+		for (UINT i = 0; i < uploadCount; ++i)
+		{
+			const C_TileBoxUpload& upload = uploads[i];
+			pins[i] = ResolveVolume(upload.volume);
+			batch[i].resource = pins[i].get();
+			if (!batch[i].resource)
+			{
+				UNITY_LOG_ERROR(s_Log, std::format("UploadDataToTileBoxes: reserved resource {} is null", i).c_str());
+				return false;
+			}
+			batch[i].box.subResource = upload.subResource;
+			batch[i].box.startX = upload.startX;
+			batch[i].box.startY = upload.startY;
+			batch[i].box.startZ = upload.startZ;
+			batch[i].box.width = upload.width;
+			batch[i].box.height = upload.height;
+			batch[i].box.depth = upload.depth;
+			batch[i].sourceData = std::span<std::byte>(
+				static_cast<std::byte*>(upload.sourceData), upload.totalDataSize);
+		}
+
+		return g_RenderPlugin->UploadDataToTileBoxes(batch);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UploadDataToTileBoxes(
+	const C_TileBoxUpload* uploads,
+	UINT uploadCount
+)
+{
+	if (!s_CallRecorder.IsRecording()) {
+		return UploadDataToTileBoxesImpl(uploads, uploadCount);
+	}
+	const uint64_t timestampNs = s_CallRecorder.BeginCall();
+	const bool succeeded = UploadDataToTileBoxesImpl(uploads, uploadCount);
+
+	// The trace has no batch op; replaying the boxes one by one maps and
+	// uploads the same tiles
+	for (UINT i = 0; uploads && i < uploadCount; ++i) {
+		CallRecord call;
+		call.op = CallOp::UploadTileBox;
+		call.timestampNs = timestampNs;
+		call.volume = uploads[i].volume;
+		call.subresource = uploads[i].subResource;
+		call.x = uploads[i].startX;
+		call.y = uploads[i].startY;
+		call.z = uploads[i].startZ;
+		call.width = uploads[i].width;
+		call.height = uploads[i].height;
+		call.depth = uploads[i].depth;
+		call.payload = static_cast<const std::byte*>(uploads[i].sourceData);
+		call.payloadSize = uploads[i].totalDataSize;
+		call.succeeded = succeeded;
+		s_CallRecorder.Record(call);
+	}
+	return succeeded;
+}
+
+UNITY_INTERFACE_EXPORT VolumeSetHandle CreateVolumeSet(const VolumeHandle* volumes, UINT volumeCount)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "CreateVolumeSet: plugin not initialized");
+			return 0;
+		}
+		if (!volumes)
+		{
+			UNITY_LOG_ERROR(s_Log, "CreateVolumeSet: null volume list");
+			return 0;
+		}
+		return g_RenderPlugin->CreateVolumeSet(std::span<const VolumeHandle>(volumes, volumeCount));
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return 0;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool DestroyVolumeSet(VolumeSetHandle set)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "DestroyVolumeSet: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->DestroyVolumeSet(set);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+// outMembers, if set, receives the member handles of a set that resolved
+static bool UploadVolumeSetTileBoxImpl(
+	VolumeSetHandle set,
+	UINT subResource,
+	UINT startX, UINT startY, UINT startZ,
+	UINT width, UINT height, UINT depth,
+	void* const* memberData,
+	UINT memberCount,
+	UINT memberDataSize,
+	std::vector<VolumeHandle>* outMembers
+)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadVolumeSetTileBox: plugin not initialized");
+			return false;
+		}
+		if (!memberData)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadVolumeSetTileBox: null payload list");
+			return false;
+		}
+
+		TileBox box;
+		box.subResource = subResource;
+		box.startX = startX;
+		box.startY = startY;
+		box.startZ = startZ;
+		box.width = width;
+		box.height = height;
+		box.depth = depth;
+
+		std::vector<std::span<std::byte>> payloads;
+		for (UINT i = 0; i < memberCount; ++i)
+		{
+			payloads.emplace_back(static_cast<std::byte*>(memberData[i]), memberDataSize);
+		}
+
+		std::shared_ptr<VolumeSet> volumeSet = g_RenderPlugin->PinVolumeSet(set);
+		if (volumeSet && outMembers)
+		{
+			for (const ReservedResource* member : volumeSet->GetMembers())
+			{
+				outMembers->push_back(member->handle);
+			}
+		}
+		return g_RenderPlugin->UploadVolumeSetTileBox(volumeSet.get(), box, payloads);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UploadVolumeSetTileBox(
+	VolumeSetHandle set,
+	UINT subResource,
+	UINT startX, UINT startY, UINT startZ,
+	UINT width, UINT height, UINT depth,
+	void* const* memberData,
+	UINT memberCount,
+	UINT memberDataSize
+)
+{
+	if (!s_CallRecorder.IsRecording()) {
+		return UploadVolumeSetTileBoxImpl(set, subResource, startX, startY, startZ, width, height, depth,
+			memberData, memberCount, memberDataSize, nullptr);
+	}
+	const uint64_t timestampNs = s_CallRecorder.BeginCall();
+	std::vector<VolumeHandle> members;
+	const bool succeeded = UploadVolumeSetTileBoxImpl(set, subResource, startX, startY, startZ, width, height, depth,
+		memberData, memberCount, memberDataSize, &members);
+
+	// The trace has no set ops; replaying the members' boxes one by one
+	// uploads the same tiles, without the shared heap runs
+	for (size_t i = 0; i < members.size() && i < memberCount; ++i) {
+		CallRecord call;
+		call.op = CallOp::UploadTileBox;
+		call.timestampNs = timestampNs;
+		call.volume = members[i];
+		call.subresource = subResource;
+		call.x = startX;
+		call.y = startY;
+		call.z = startZ;
+		call.width = width;
+		call.height = height;
+		call.depth = depth;
+		call.payload = static_cast<const std::byte*>(memberData[i]);
+		call.payloadSize = memberDataSize;
+		call.succeeded = succeeded;
+		s_CallRecorder.Record(call);
+	}
+	return succeeded;
+}
+
+UNITY_INTERFACE_EXPORT bool UnmapVolumeSetTileBox(
+	VolumeSetHandle set,
+	UINT subResource,
+	UINT startX, UINT startY, UINT startZ,
+	UINT width, UINT height, UINT depth
+)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UnmapVolumeSetTileBox: plugin not initialized");
+			return false;
+		}
+
+		TileBox box;
+		box.subResource = subResource;
+		box.startX = startX;
+		box.startY = startY;
+		box.startZ = startZ;
+		box.width = width;
+		box.height = height;
+		box.depth = depth;
+
+		std::shared_ptr<VolumeSet> volumeSet = g_RenderPlugin->PinVolumeSet(set);
+		return g_RenderPlugin->UnmapVolumeSetTileBox(volumeSet.get(), box);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool EnableWrapAddressing(VolumeHandle volume, bool enable)
+{
+	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "EnableWrapAddressing: plugin not initialized");
+			return false;
+		}
+		if (resource == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "EnableWrapAddressing: reserved resource is null");
+			return false;
+		}
+		return g_RenderPlugin->EnableWrapAddressing(resource.get(), enable);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool ScrollVolume(
+	VolumeHandle volume,
+	INT64 dx, INT64 dy, INT64 dz,
+	WrapBox* outBoxes,
+	UINT capacity,
+	UINT* outBoxCount
+) {
+	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "ScrollVolume: plugin not initialized");
+			return false;
+		}
+		if (resource == nullptr || outBoxes == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "ScrollVolume: null argument");
+			return false;
+		}
+
+		// Checked before scrolling: once the window has moved, boxes that
+		// did not fit could not be asked for again
+		if (capacity < WrapWindow::MAX_ENTERING_BOXES)
+		{
+			UNITY_LOG_ERROR(s_Log, std::format(
+				"ScrollVolume: capacity {} is below the {} boxes a scroll can return",
+				capacity, WrapWindow::MAX_ENTERING_BOXES).c_str());
+			return false;
+		}
+
+		std::vector<WrapBox> entering;
+		if (!g_RenderPlugin->ScrollVolume(resource.get(), dx, dy, dz, &entering)) {
+			return false;
+		}
+
+		const UINT count = static_cast<UINT>(entering.size());
+		std::copy_n(entering.begin(), count, outBoxes);
+		if (outBoxCount) {
+			*outBoxCount = count;
+		}
+		return true;
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool GetWrapOffset(VolumeHandle volume, UINT* outTexelOffset)
+{
+	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "GetWrapOffset: plugin not initialized");
+			return false;
+		}
+		if (resource == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "GetWrapOffset: reserved resource is null");
+			return false;
+		}
+		return g_RenderPlugin->GetWrapOffset(resource.get(), outTexelOffset);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UploadConvertedDataToTile(
+	VolumeHandle volume,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ,
+	void* sourceData,
+	UINT dataSize,
+	UINT sourceFormat,
+	const void* palette,
+	UINT paletteSize
+) {
+	try {
+		std::shared_ptr<ReservedResource> tiledResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadConvertedDataToTile: plugin not initialized");
+			return false;
+		}
+		if (tiledResource == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadConvertedDataToTile: reserved resource is null");
+			return false;
+		}
+
+		std::span<std::byte> dataSpan(
+			static_cast<std::byte*>(sourceData), dataSize);
+		std::span<const std::byte> paletteSpan(
+			static_cast<const std::byte*>(palette), palette ? paletteSize : 0);
+
+		return g_RenderPlugin->UploadConvertedDataToTile(
+			tiledResource.get(),
+			subResource,
+			tileX, tileY, tileZ,
+			dataSpan,
+			static_cast<UploadSourceFormat>(sourceFormat),
+			paletteSpan);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UploadConvertedDataToTileBox(
+	VolumeHandle volume,
+	UINT subResource,
+	UINT startX, UINT startY, UINT startZ,
+	UINT width, UINT height, UINT depth,
+	void* sourceData,
+	UINT totalDataSize,
+	UINT sourceFormat,
+	const void* palette,
+	UINT paletteSize
+) {
+	try {
+		std::shared_ptr<ReservedResource> tiledResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadConvertedDataToTileBox: plugin not initialized");
+			return false;
+		}
+		if (tiledResource == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadConvertedDataToTileBox: reserved resource is null");
+			return false;
+		}
+
+		TileBox box;
+		box.subResource = subResource;
+		box.startX = startX;
+		box.startY = startY;
+		box.startZ = startZ;
+		box.width = width;
+		box.height = height;
+		box.depth = depth;
+
+		std::span<std::byte> dataSpan(
+			static_cast<std::byte*>(sourceData), totalDataSize);
+		std::span<const std::byte> paletteSpan(
+			static_cast<const std::byte*>(palette), palette ? paletteSize : 0);
+
+		return g_RenderPlugin->UploadConvertedDataToTileBox(
+			tiledResource.get(), box, dataSpan,
+			static_cast<UploadSourceFormat>(sourceFormat),
+			paletteSpan);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UploadEncodedDataToTile(
+	VolumeHandle volume,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ,
+	const void* payload,
+	UINT payloadSize
+) {
+	try {
+		std::shared_ptr<ReservedResource> tiledResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadEncodedDataToTile: plugin not initialized");
+			return false;
+		}
+		if (tiledResource == nullptr || payload == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadEncodedDataToTile: reserved resource or payload is null");
+			return false;
+		}
+
+		std::span<const std::byte> payloadSpan(
+			static_cast<const std::byte*>(payload), payloadSize);
+
+		return g_RenderPlugin->UploadEncodedDataToTile(
+			tiledResource.get(),
+			subResource,
+			tileX, tileY, tileZ,
+			payloadSpan);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UploadEncodedDataToTileBox(
+	VolumeHandle volume,
+	UINT subResource,
+	UINT startX, UINT startY, UINT startZ,
+	UINT width, UINT height, UINT depth,
+	const void* payload,
+	UINT payloadSize
+) {
+	try {
+		std::shared_ptr<ReservedResource> tiledResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadEncodedDataToTileBox: plugin not initialized");
+			return false;
+		}
+		if (tiledResource == nullptr || payload == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadEncodedDataToTileBox: reserved resource or payload is null");
+			return false;
+		}
+
+		TileBox box;
+		box.subResource = subResource;
+		box.startX = startX;
+		box.startY = startY;
+		box.startZ = startZ;
+		box.width = width;
+		box.height = height;
+		box.depth = depth;
+
+		std::span<const std::byte> payloadSpan(
+			static_cast<const std::byte*>(payload), payloadSize);
+
+		return g_RenderPlugin->UploadEncodedDataToTileBox(tiledResource.get(), box, payloadSpan);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT UINT EncodeTileData(
+	VolumeHandle volume,
+	const void* tileData,
+	UINT tileSize,
+	void* output,
+	UINT outputCapacity
+) {
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "EncodeTileData: plugin not initialized");
+			return 0;
+		}
+		if (reservedResource == nullptr || tileData == nullptr || output == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "EncodeTileData: null argument");
+			return 0;
+		}
+
+		std::vector<std::byte> encoded;
+		std::span<const std::byte> tileSpan(static_cast<const std::byte*>(tileData), tileSize);
+		if (!g_RenderPlugin->EncodeTileData(reservedResource.get(), tileSpan, encoded))
+		{
+			return 0;
+		}
+
+		if (encoded.size() > outputCapacity)
+		{
+			UNITY_LOG_ERROR(s_Log, std::format(
+				"EncodeTileData: encoded tile needs {} bytes, output holds {}",
+				encoded.size(), outputCapacity).c_str());
+			return 0;
+		}
+
+		memcpy(output, encoded.data(), encoded.size());
+		return static_cast<UINT>(encoded.size());
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return 0;
+	}
+}
+
+UNITY_INTERFACE_EXPORT TileArchive* OpenTileArchive(const char* path)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "OpenTileArchive: plugin not initialized");
+			return nullptr;
+		}
+		return g_RenderPlugin->OpenTileArchive(path);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return nullptr;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool CloseTileArchive(TileArchive* archive)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "CloseTileArchive: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->CloseTileArchive(archive);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UploadTileFromArchive(
+	VolumeHandle volume,
+	TileArchive* archive,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ
+) {
+	try {
+		std::shared_ptr<ReservedResource> tiledResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadTileFromArchive: plugin not initialized");
+			return false;
+		}
+		if (tiledResource == nullptr || archive == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadTileFromArchive: reserved resource or archive is null");
+			return false;
+		}
+
+		return g_RenderPlugin->UploadTileFromArchive(
+			tiledResource.get(),
+			archive,
+			subResource,
+			tileX, tileY, tileZ);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UploadTileBoxFromArchive(
+	VolumeHandle volume,
+	TileArchive* archive,
+	UINT subResource,
+	UINT startX, UINT startY, UINT startZ,
+	UINT width, UINT height, UINT depth
+) {
+	try {
+		std::shared_ptr<ReservedResource> tiledResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadTileBoxFromArchive: plugin not initialized");
+			return false;
+		}
+		if (tiledResource == nullptr || archive == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadTileBoxFromArchive: reserved resource or archive is null");
+			return false;
+		}
+
+		TileBox box;
+		box.subResource = subResource;
+		box.startX = startX;
+		box.startY = startY;
+		box.startZ = startZ;
+		box.width = width;
+		box.height = height;
+		box.depth = depth;
+
+		return g_RenderPlugin->UploadTileBoxFromArchive(tiledResource.get(), archive, box);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT TileArchiveWriter* CreateTileArchiveWriter(const char* path, UINT format)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "CreateTileArchiveWriter: plugin not initialized");
+			return nullptr;
+		}
+		return g_RenderPlugin->CreateTileArchiveWriter(path, static_cast<DXGI_FORMAT>(format));
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return nullptr;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool AddTileToArchive(
+	TileArchiveWriter* writer,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ,
+	const void* tileData,
+	UINT tileSize,
+	bool compress
+) {
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "AddTileToArchive: plugin not initialized");
+			return false;
+		}
+		if (writer == nullptr || tileData == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "AddTileToArchive: writer or tile data is null");
+			return false;
+		}
+
+		std::span<const std::byte> tileSpan(static_cast<const std::byte*>(tileData), tileSize);
+		return g_RenderPlugin->AddTileToArchive(writer, subResource, tileX, tileY, tileZ, tileSpan, compress);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool FinishTileArchive(TileArchiveWriter* writer)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "FinishTileArchive: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->FinishTileArchive(writer);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool EnableTilePrefetch(
+	VolumeHandle volume,
+	const float* mipRadii,
+	UINT mipRadiusCount,
+	UINT lookaheadFrames,
+	UINT maxTilesPerFrame,
+	float viewWeight,
+	TileArchive* archive,
+	TileSourceCallback callback,
+	void* userData
+) {
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "EnableTilePrefetch: plugin not initialized");
+			return false;
+		}
+		if (reservedResource == nullptr || mipRadii == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "EnableTilePrefetch: reserved resource or mip radii is null");
+			return false;
+		}
+
+		PrefetchSettings settings;
+		settings.lookaheadFrames = lookaheadFrames;
+		settings.mipRadii.assign(mipRadii, mipRadii + mipRadiusCount);
+		settings.viewWeight = viewWeight;
+		settings.maxTilesPerFrame = maxTilesPerFrame;
+
+		TilePrefetchSource source;
+		if (archive)
+		{
+			source.archive = g_RenderPlugin->FindTileArchive(archive);
+			if (!source.archive)
+			{
+				UNITY_LOG_ERROR(s_Log, "EnableTilePrefetch: archive is not open");
+				return false;
+			}
+		}
+		source.callback = callback;
+		source.userData = userData;
+
+		return g_RenderPlugin->EnableTilePrefetch(reservedResource.get(), settings, source);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool DisableTilePrefetch(VolumeHandle volume)
+{
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "DisableTilePrefetch: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->DisableTilePrefetch(reservedResource.get());
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT UINT UpdateTilePrefetch(
+	VolumeHandle volume,
+	const float* position,
+	const float* velocity,
+	const float* viewDirection,
+	float deltaTime
+) {
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UpdateTilePrefetch: plugin not initialized");
+			return 0;
+		}
+		if (reservedResource == nullptr || position == nullptr || velocity == nullptr || viewDirection == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "UpdateTilePrefetch: null argument");
+			return 0;
+		}
+
+		PrefetchCamera camera;
+		for (int a = 0; a < 3; ++a) {
+			camera.position[a] = position[a];
+			camera.velocity[a] = velocity[a];
+			camera.viewDirection[a] = viewDirection[a];
+		}
+		camera.deltaTime = deltaTime;
+
+		return g_RenderPlugin->UpdateTilePrefetch(reservedResource.get(), camera);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return 0;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool EnableResidencyManagement(bool enable)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "EnableResidencyManagement: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->EnableResidencyManagement(enable);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool AdvanceResidencyFrame()
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "AdvanceResidencyFrame: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->AdvanceResidencyFrame();
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool MarkTileBoxUsed(
+	VolumeHandle volume,
+	UINT subResource,
+	UINT startX, UINT startY, UINT startZ,
+	UINT width, UINT height, UINT depth
+) {
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "MarkTileBoxUsed: plugin not initialized");
+			return false;
+		}
+
+		TileBox box;
+		box.subResource = subResource;
+		box.startX = startX;
+		box.startY = startY;
+		box.startZ = startZ;
+		box.width = width;
+		box.height = height;
+		box.depth = depth;
+
+		return g_RenderPlugin->MarkTileBoxUsed(reservedResource.get(), box);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool PinTileBox(
+	VolumeHandle volume,
+	UINT subResource,
+	UINT startX, UINT startY, UINT startZ,
+	UINT width, UINT height, UINT depth,
+	bool pinned
+) {
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "PinTileBox: plugin not initialized");
+			return false;
+		}
+
+		TileBox box;
+		box.subResource = subResource;
+		box.startX = startX;
+		box.startY = startY;
+		box.startZ = startZ;
+		box.width = width;
+		box.height = height;
+		box.depth = depth;
+
+		return g_RenderPlugin->PinTileBox(reservedResource.get(), box, pinned);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool SetResidencyPriority(VolumeHandle volume, float weight)
+{
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "SetResidencyPriority: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->SetResidencyPriority(reservedResource.get(), weight);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT UINT64 ScheduleUploadToTile(
+	VolumeHandle volume,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ,
+	const void* sourceData,
+	UINT dataSize,
+	float priority
+) {
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "ScheduleUploadToTile: plugin not initialized");
+			return 0;
+		}
+		if (reservedResource == nullptr || sourceData == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "ScheduleUploadToTile: reserved resource or source data is null");
+			return 0;
+		}
+
+		std::span<const std::byte> dataSpan(static_cast<const std::byte*>(sourceData), dataSize);
+		return g_RenderPlugin->ScheduleUploadToTile(
+			reservedResource.get(),
+			subResource,
+			tileX, tileY, tileZ,
+			dataSpan,
+			priority);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return 0;
+	}
+}
+
+UNITY_INTERFACE_EXPORT UINT64 ScheduleUploadToTileBox(
+	VolumeHandle volume,
+	UINT subResource,
+	UINT startX, UINT startY, UINT startZ,
+	UINT width, UINT height, UINT depth,
+	const void* sourceData,
+	UINT totalDataSize,
+	float priority
+) {
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "ScheduleUploadToTileBox: plugin not initialized");
+			return 0;
+		}
+		if (reservedResource == nullptr || sourceData == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "ScheduleUploadToTileBox: reserved resource or source data is null");
+			return 0;
+		}
+
+		TileBox box;
+		box.subResource = subResource;
+		box.startX = startX;
+		box.startY = startY;
+		box.startZ = startZ;
+		box.width = width;
+		box.height = height;
+		box.depth = depth;
+
+		std::span<const std::byte> dataSpan(static_cast<const std::byte*>(sourceData), totalDataSize);
+		return g_RenderPlugin->ScheduleUploadToTileBox(reservedResource.get(), box, dataSpan, priority);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return 0;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool ReprioritizeUpload(UINT64 requestId, float priority)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "ReprioritizeUpload: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->ReprioritizeUpload(requestId, priority);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool CancelUpload(UINT64 requestId)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "CancelUpload: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->CancelUpload(requestId);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool ConfigureStreaming(
+	UINT64 maxBytesPerFrame,
+	UINT maxOperationsPerFrame,
+	float agingPerFrame
+) {
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "ConfigureStreaming: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->ConfigureStreaming(maxBytesPerFrame, maxOperationsPerFrame, agingPerFrame);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT UINT ProcessStreamingQueue(
+	UINT64* outRequestIds,
+	bool* outSucceeded,
+	UINT capacity
+) {
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "ProcessStreamingQueue: plugin not initialized");
+			return 0;
+		}
+
+		std::vector<StreamingResult> results;
+		const UINT processed = g_RenderPlugin->ProcessStreamingQueue(results);
+
+		const UINT reported = (std::min)(capacity, static_cast<UINT>(results.size()));
+		for (UINT i = 0; i < reported; ++i) {
+			if (outRequestIds) outRequestIds[i] = results[i].id;
+			if (outSucceeded) outSucceeded[i] = results[i].succeeded;
+		}
+		return processed;
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return 0;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool EnableResidencySolver(
+	VolumeHandle volume,
+	const float* boundsMin,
+	const float* boundsMax,
+	const float* mipRadii,
+	UINT mipRadiusCount
+) {
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "EnableResidencySolver: plugin not initialized");
+			return false;
+		}
+		if (reservedResource == nullptr || boundsMin == nullptr || boundsMax == nullptr || mipRadii == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "EnableResidencySolver: null argument");
+			return false;
+		}
+
+		ResidencySolverSettings settings = {};
+		for (int a = 0; a < 3; ++a) {
+			settings.boundsMin[a] = boundsMin[a];
+			settings.boundsMax[a] = boundsMax[a];
+		}
+		settings.mipRadii.assign(mipRadii, mipRadii + mipRadiusCount);
+
+		return g_RenderPlugin->EnableResidencySolver(reservedResource.get(), settings);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool DisableResidencySolver(VolumeHandle volume)
+{
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "DisableResidencySolver: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->DisableResidencySolver(reservedResource.get());
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool SolveResidency(
+	VolumeHandle volume,
+	const float* cameraPosition,
+	bool applyUnmaps,
+	UINT* outUploadTiles,
+	UINT uploadCapacity,
+	UINT* outUploadCount,
+	UINT* outUnmapTiles,
+	UINT unmapCapacity,
+	UINT* outUnmapCount
+) {
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "SolveResidency: plugin not initialized");
+			return false;
+		}
+		if (reservedResource == nullptr || cameraPosition == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "SolveResidency: null argument");
+			return false;
+		}
+
+		ResidencyWorkList work;
+		if (!g_RenderPlugin->SolveResidency(reservedResource.get(), cameraPosition, applyUnmaps, work))
+		{
+			return false;
+		}
+
+		auto writeTiles = [](const std::vector<SolverTile>& tiles, UINT* outTiles, UINT capacity) {
+			if (!outTiles) return;
+			const UINT written = (std::min)(capacity, static_cast<UINT>(tiles.size()));
+			for (UINT i = 0; i < written; ++i) {
+				outTiles[i * 4 + 0] = tiles[i].subresource;
+				outTiles[i * 4 + 1] = tiles[i].x;
+				outTiles[i * 4 + 2] = tiles[i].y;
+				outTiles[i * 4 + 3] = tiles[i].z;
+			}
+		};
+		writeTiles(work.uploads, outUploadTiles, uploadCapacity);
+		writeTiles(work.unmaps, outUnmapTiles, unmapCapacity);
+		if (outUploadCount) *outUploadCount = static_cast<UINT>(work.uploads.size());
+		if (outUnmapCount) *outUnmapCount = static_cast<UINT>(work.unmaps.size());
+		return true;
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool EnableUsageFeedback(VolumeHandle volume)
+{
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "EnableUsageFeedback: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->EnableUsageFeedback(reservedResource.get());
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool DisableUsageFeedback(VolumeHandle volume)
+{
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "DisableUsageFeedback: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->DisableUsageFeedback(reservedResource.get());
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT UINT64 GetUsageFeedbackSize(VolumeHandle volume, UINT format)
+{
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "GetUsageFeedbackSize: plugin not initialized");
+			return 0;
+		}
+		return g_RenderPlugin->GetUsageFeedbackSize(reservedResource.get(), static_cast<FeedbackFormat>(format));
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return 0;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool ProcessUsageFeedback(
+	VolumeHandle volume,
+	UINT format,
+	const void* data,
+	UINT64 size,
+	UINT idleFrames,
+	UINT* outRequestTiles,
+	UINT requestCapacity,
+	UINT* outRequestCount,
+	UINT* outCandidateTiles,
+	UINT candidateCapacity,
+	UINT* outCandidateCount
+) {
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "ProcessUsageFeedback: plugin not initialized");
+			return false;
+		}
+
+		FeedbackWork work;
+		if (!g_RenderPlugin->ProcessUsageFeedback(reservedResource.get(), static_cast<FeedbackFormat>(format),
+			data, static_cast<size_t>(size), idleFrames, work))
+		{
+			return false;
+		}
+
+		auto writeTiles = [](const std::vector<FeedbackTile>& tiles, UINT* outTiles, UINT capacity) {
+			if (!outTiles) return;
+			const UINT written = (std::min)(capacity, static_cast<UINT>(tiles.size()));
+			for (UINT i = 0; i < written; ++i) {
+				outTiles[i * 4 + 0] = tiles[i].subresource;
+				outTiles[i * 4 + 1] = tiles[i].x;
+				outTiles[i * 4 + 2] = tiles[i].y;
+				outTiles[i * 4 + 3] = tiles[i].z;
+			}
+		};
+		writeTiles(work.requests, outRequestTiles, requestCapacity);
+		writeTiles(work.evictionCandidates, outCandidateTiles, candidateCapacity);
+		if (outRequestCount) *outRequestCount = static_cast<UINT>(work.requests.size());
+		if (outCandidateCount) *outCandidateCount = static_cast<UINT>(work.evictionCandidates.size());
+		return true;
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool EnableResidencyMap(VolumeHandle volume)
+{
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "EnableResidencyMap: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->EnableResidencyMap(reservedResource.get());
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool DisableResidencyMap(VolumeHandle volume)
+{
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "DisableResidencyMap: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->DisableResidencyMap(reservedResource.get());
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UpdateResidencyMap(VolumeHandle volume)
+{
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UpdateResidencyMap: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->UpdateResidencyMap(reservedResource.get());
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT ID3D12Resource* GetResidencyMapTexture(VolumeHandle volume)
+{
+	try {
+		std::shared_ptr<ReservedResource> reservedResource = ResolveVolume(volume);
+		if (reservedResource == nullptr)
+		{
+			UNITY_LOG_ERROR(s_Log, "GetResidencyMapTexture: null resource");
+			return nullptr;
+		}
+		return reservedResource->GetResidencyMapTexture();
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return nullptr;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool GetPipelineStats(C_PipelineStats* outStats)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "GetPipelineStats: plugin not initialized");
+			return false;
+		}
+		if (!outStats)
+		{
+			UNITY_LOG_ERROR(s_Log, "GetPipelineStats: null output");
+			return false;
+		}
+		return g_RenderPlugin->GetPipelineStats(*outStats);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool GetPipelineHistogram(
+	UINT stage,
+	UINT64* outBuckets,
+	UINT capacity,
+	UINT* outBucketCount
+) {
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "GetPipelineHistogram: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->GetPipelineHistogram(
+			static_cast<PipelineStage>(stage), outBuckets, capacity, outBucketCount);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool ResetPipelineStats()
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "ResetPipelineStats: plugin not initialized");
+			return false;
+		}
+		g_RenderPlugin->ResetPipelineStats();
+		return true;
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool StartCallRecording(const char* path, UINT payloadMode)
+{
+	try {
+		if (!path)
+		{
+			UNITY_LOG_ERROR(s_Log, "StartCallRecording: null path");
+			return false;
+		}
+		std::string error;
+		if (!s_CallRecorder.Start(path, static_cast<CallPayloadMode>(payloadMode), &error))
+		{
+			UNITY_LOG_ERROR(s_Log, std::format("StartCallRecording: {}", error).c_str());
+			return false;
+		}
+		return true;
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool StopCallRecording()
+{
+	try {
+		std::string error;
+		if (!s_CallRecorder.Stop(&error))
+		{
+			UNITY_LOG_ERROR(s_Log, std::format("StopCallRecording: {}", error).c_str());
+			return false;
+		}
+		return true;
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool ReplayCallRecording(
+	const char* path,
+	bool honorTimestamps,
+	CallReplayStats* outStats
+) {
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "ReplayCallRecording: plugin not initialized");
+			return false;
+		}
+		if (!path || !outStats)
+		{
+			UNITY_LOG_ERROR(s_Log, "ReplayCallRecording: null path or output");
+			return false;
+		}
+
+		std::string error;
+		std::unique_ptr<CallTraceReader> reader = CallTraceReader::Open(path, &error);
+		if (!reader)
+		{
+			UNITY_LOG_ERROR(s_Log, std::format("ReplayCallRecording: {}", error).c_str());
+			return false;
+		}
+
+		PluginReplayTarget target(g_RenderPlugin.get());
+		CallReplayOptions options;
+		options.honorTimestamps = honorTimestamps;
+		if (!ReplayCallTrace(*reader, target, options, outStats, &error))
+		{
+			UNITY_LOG_ERROR(s_Log, std::format("ReplayCallRecording: {} after {} calls", error, outStats->calls).c_str());
+			return false;
+		}
+		return true;
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool BenchmarkUploadPipeline(
+	const PipelineBenchmarkSettings* settings,
+	PipelineBenchmarkResult* outResult
+) {
+	try {
+		if (!settings || !outResult)
+		{
+			UNITY_LOG_ERROR(s_Log, "BenchmarkUploadPipeline: null settings or output");
+			return false;
+		}
+
+		std::unique_ptr<RenderingPlugin> softwarePlugin;
+		RenderingPlugin* plugin = g_RenderPlugin.get();
+		if (settings->useSoftwareBackend)
+		{
+			SoftwareBackendSettings backendSettings;
+			backendSettings.fenceLatencyNs = settings->fenceLatencyNs;
+			softwarePlugin = std::make_unique<RenderingPlugin>(
+				std::make_unique<SoftwareBackend>(backendSettings), s_Log);
+			plugin = softwarePlugin.get();
+		}
+		if (!plugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "BenchmarkUploadPipeline: plugin not initialized");
+			return false;
+		}
+
+		std::string error;
+		if (!RunPipelineBenchmark(*plugin, *settings, outResult, &error))
+		{
+			UNITY_LOG_ERROR(s_Log, std::format("BenchmarkUploadPipeline: {}", error).c_str());
+			return false;
+		}
+		return true;
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool SetTracingEnabled(bool enabled)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "SetTracingEnabled: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->SetTracingEnabled(enabled);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool DumpTrace(const char* path)
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "DumpTrace: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->DumpTrace(path);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+static bool UnmapTileImpl(
+	VolumeHandle volume,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ
+)
+{
+	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UnmapTile: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->UnmapDataFromTile(resource.get(), subResource, tileX, tileY, tileZ);
+
+	} catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UnmapTile(
+	VolumeHandle volume,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ
+)
+{
+	if (!s_CallRecorder.IsRecording()) {
+		return UnmapTileImpl(volume, subResource, tileX, tileY, tileZ);
+	}
+	CallRecord call;
+	call.op = CallOp::UnmapTile;
+	call.timestampNs = s_CallRecorder.BeginCall();
+	call.volume = volume;
+	call.subresource = subResource;
+	call.x = tileX;
+	call.y = tileY;
+	call.z = tileZ;
+	call.succeeded = UnmapTileImpl(volume, subResource, tileX, tileY, tileZ);
+	s_CallRecorder.Record(call);
+	return call.succeeded;
+}
+
+UNITY_INTERFACE_EXPORT bool UnmapTileBox(
+	VolumeHandle volume,
+	UINT subResource,
+	UINT startX, UINT startY, UINT startZ,
+	UINT width, UINT height, UINT depth
+)
+{
+	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UnmapTileBox: plugin not initialized");
+			return false;
+		}
+
+		TileBox box;
+		box.subResource = subResource;
+		box.startX = startX;
+		box.startY = startY;
+		box.startZ = startZ;
+		box.width = width;
+		box.height = height;
+		box.depth = depth;
+
+		return g_RenderPlugin->UnmapTileBox(resource.get(), box);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UnmapSubresource(
+	VolumeHandle volume,
+	UINT subResource
+)
+{
+	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UnmapSubresource: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->UnmapSubresource(resource.get(), subResource);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT UINT ReleaseRetiredTiles()
+{
+	try {
+		if (!g_RenderPlugin)
+		{
+			return 0;
+		}
+		return g_RenderPlugin->ReleaseRetiredTiles();
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return 0;
+	}
+}
+
+// Returns false on a stale or null handle
+UNITY_INTERFACE_EXPORT bool IsTileMapped(
+	VolumeHandle volume,
+	UINT subresource,
+	UINT tileX, UINT tileY, UINT tileZ
+) {
+	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
+		return resource && resource->IsTileMapped(subresource, tileX, tileY, tileZ);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UploadPackedMips(
+	VolumeHandle volume,
+	void* sourceData,
+	UINT dataSize
+)
+{
+	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UploadPackedMips: plugin not initialized");
+			return false;
+		}
+
+		std::span<std::byte> dataSpan(
+			static_cast<std::byte*>(sourceData), dataSize);
+
+		return g_RenderPlugin->UploadPackedMips(resource.get(), dataSpan);
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool SetMipGenerationMode(VolumeHandle volume, UINT mode)
+{
+	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "SetMipGenerationMode: plugin not initialized");
+			return false;
+		}
+		if (mode > static_cast<UINT>(MipFilter::Auto))
+		{
+			UNITY_LOG_ERROR(s_Log, "SetMipGenerationMode: unknown mode");
+			return false;
+		}
+		return g_RenderPlugin->SetMipGenerationMode(resource.get(), static_cast<MipFilter>(mode));
+	}
+	catch (const std::exception& ex) {
+		UNITY_LOG_ERROR(s_Log, ex.what());
+		return false;
+	}
+}
+
+UNITY_INTERFACE_EXPORT bool UnmapPackedMips(VolumeHandle volume)
+{
+	try {
+		std::shared_ptr<ReservedResource> resource = ResolveVolume(volume);
+		if (!g_RenderPlugin)
+		{
+			UNITY_LOG_ERROR(s_Log, "UnmapPackedMips: plugin not initialized");
+			return false;
+		}
+		return g_RenderPlugin->UnmapPackedMips(resource.get());
+	}
+	catch (const std::exception& ex) {
 		UNITY_LOG_ERROR(s_Log, ex.what());
 		return false;
 	}
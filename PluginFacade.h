@@ -8,54 +8,510 @@
 #include "IUnityGraphics.h"
 #include "TilingInfo.h"
 #include "ReservedResource.h"
+#include "SparseTextureInterface.h"
+#include "PipelineStats.h"
+#include "CallReplay.h"
+#include "PipelineBenchmark.h"
 
 
-struct SparseTextureFunctionTable;
+class TileArchive;
+class TileArchiveWriter;
 
-// C-style interface for C# to call into.
+// One box of UploadDataToTileBoxes, laid out as for UploadDataToTileBox
+struct C_TileBoxUpload {
+    VolumeHandle volume;
+    UINT subResource;
+    UINT startX, startY, startZ;
+    UINT width, height, depth;
+    void* sourceData;
+    UINT totalDataSize;
+};
+
+// C-style interface for C# to call into. Volumes are passed as handles
+// from CreateVolumetricResource; stale ones are rejected with an error.
 extern "C"
 {
-    UNITY_INTERFACE_EXPORT ReservedResource* CreateVolumetricResource(UINT width, UINT height, UINT depth, bool useMipmaps, UINT mipmapCount, DXGI_FORMAT format);
+    UNITY_INTERFACE_EXPORT VolumeHandle CreateVolumetricResource(UINT width, UINT height, UINT depth, bool useMipmaps, UINT mipmapCount, DXGI_FORMAT format);
+
+    // flags: VolumeCreateFlags (1 = standard swizzle)
+    UNITY_INTERFACE_EXPORT VolumeHandle CreateVolumetricResourceEx(UINT width, UINT height, UINT depth, bool useMipmaps, UINT mipmapCount, DXGI_FORMAT format, UINT flags);
 
     UNITY_INTERFACE_EXPORT bool TiledResourceSupport();
 
     // This function will release the native resource.
-    UNITY_INTERFACE_EXPORT bool DestroyVolumetricResource(ReservedResource* resource);
+    UNITY_INTERFACE_EXPORT bool DestroyVolumetricResource(VolumeHandle volume);
+
+    UNITY_INTERFACE_EXPORT void GetResourceTilingInfo(VolumeHandle volume, C_ResourceTilingInfo* outInfo);
 
-    UNITY_INTERFACE_EXPORT void GetResourceTilingInfo(ReservedResource* resource, C_ResourceTilingInfo* outInfo);
+    UNITY_INTERFACE_EXPORT void GetPackedMipInfo(VolumeHandle volume, C_PackedMipInfo* outInfo);
 
-    UNITY_INTERFACE_EXPORT ID3D12Resource* GetPointerToD3D12Resource(ReservedResource* resource);
+    UNITY_INTERFACE_EXPORT ID3D12Resource* GetPointerToD3D12Resource(VolumeHandle volume);
 
     UNITY_INTERFACE_EXPORT bool UploadDataToTile(
-        ReservedResource* reservedResource,
+        VolumeHandle volume,
+        UINT subResource,
+        UINT tileX, UINT tileY, UINT tileZ,
+        void* sourceData,
+        UINT dataSize);
+
+    // Standard-swizzle resources only. Converts one 64KB linear tile to the
+    // resource's swizzled layout; thread-safe and GPU-free, so callers can
+    // run it on worker threads and pass the result to UploadSwizzledDataToTile.
+    UNITY_INTERFACE_EXPORT bool SwizzleTileData(
+        VolumeHandle volume,
+        const void* linearData,
+        void* swizzledData,
+        UINT dataSize);
+
+    UNITY_INTERFACE_EXPORT bool UploadSwizzledDataToTile(
+        VolumeHandle volume,
         UINT subResource,
         UINT tileX, UINT tileY, UINT tileZ,
         void* sourceData,
         UINT dataSize);
 
     UNITY_INTERFACE_EXPORT bool UnmapTile(
-        ReservedResource* reservedResource,
+        VolumeHandle volume,
         UINT subresource,
         UINT tileX, UINT tileY, UINT tileZ
     );
 
+    // Unmaps every mapped tile in the box with a single mapping update.
+    UNITY_INTERFACE_EXPORT bool UnmapTileBox(
+        VolumeHandle volume,
+        UINT subResource,
+        UINT startX, UINT startY, UINT startZ,
+        UINT width, UINT height, UINT depth
+    );
+
+    UNITY_INTERFACE_EXPORT bool UnmapSubresource(
+        VolumeHandle volume,
+        UINT subResource
+    );
+
+    // Maps the packed mip tail as one unit and uploads all packed mips.
+    // sourceData holds each packed mip tightly packed, finest first.
+    UNITY_INTERFACE_EXPORT bool UploadPackedMips(
+        VolumeHandle volume,
+        void* sourceData,
+        UINT dataSize
+    );
+
+    UNITY_INTERFACE_EXPORT bool UnmapPackedMips(VolumeHandle volume);
+
+    // mode: 0 = off, 1 = average, 2 = majority, 3 = auto (majority for
+    // integer formats). While on, uploads also build and upload coarser mips.
+    // Fails for volume set members.
+    UNITY_INTERFACE_EXPORT bool SetMipGenerationMode(
+        VolumeHandle volume,
+        UINT mode
+    );
+
+    // Unmapped tiles are only reusable once the GPU has passed them. Call
+    // once per frame to return them to the heap; returns the tile count.
+    UNITY_INTERFACE_EXPORT UINT ReleaseRetiredTiles();
+
     UNITY_INTERFACE_EXPORT bool IsTileMapped(
-        ReservedResource* resource,
+        VolumeHandle volume,
         UINT subresource,
         UINT tileX, UINT tileY, UINT tileZ);
 
     UNITY_INTERFACE_EXPORT void GetFunctionTable(
-        ReservedResource* resource,
+        VolumeHandle volume,
         SparseTextureFunctionTable* outTable);
 
     UNITY_INTERFACE_EXPORT bool RunDiagnostics();
 
     UNITY_INTERFACE_EXPORT bool UploadDataToTileBox(
-        ReservedResource* reservedResource,
+        VolumeHandle volume,
         UINT subResource,
         UINT startX, UINT startY, UINT startZ,
         UINT width, UINT height, UINT depth,
         void* sourceData,
         UINT totalDataSize
     );
+
+    // Uploads boxes into several volumes, such as the channels of one
+    // chunk, with one UpdateTileMappings per volume and a single submit
+    // and fence. All or nothing. Recorded as one UploadDataToTileBox call
+    // per box.
+    UNITY_INTERFACE_EXPORT bool UploadDataToTileBoxes(
+        const C_TileBoxUpload* uploads,
+        UINT uploadCount
+    );
+
+    // Volume sets: channel volumes with a shared tile grid whose standard
+    // tiles are mapped, unmapped and evicted together (see VolumeSet.h).
+    // Members must have no standard tiles mapped yet; while grouped, their
+    // per-volume uploads, unmaps and DestroyVolumetricResource fail.
+    // Residency calls on any member apply to the whole set. Members cannot
+    // have CPU mip generation enabled, since set uploads do not build mips.
+    // Call recording logs set uploads as one UploadDataToTileBox call per
+    // member; creating, destroying and unmapping sets is not recorded.
+    // Returns 0 on failure.
+    UNITY_INTERFACE_EXPORT VolumeSetHandle CreateVolumeSet(const VolumeHandle* volumes, UINT volumeCount);
+
+    // Members stand alone again and keep their mapped tiles
+    UNITY_INTERFACE_EXPORT bool DestroyVolumeSet(VolumeSetHandle set);
+
+    // memberData[i] is member i's payload, laid out as for
+    // UploadDataToTileBox; every payload is memberDataSize bytes
+    UNITY_INTERFACE_EXPORT bool UploadVolumeSetTileBox(
+        VolumeSetHandle set,
+        UINT subResource,
+        UINT startX, UINT startY, UINT startZ,
+        UINT width, UINT height, UINT depth,
+        void* const* memberData,
+        UINT memberCount,
+        UINT memberDataSize
+    );
+
+    UNITY_INTERFACE_EXPORT bool UnmapVolumeSetTileBox(
+        VolumeSetHandle set,
+        UINT subResource,
+        UINT startX, UINT startY, UINT startZ,
+        UINT width, UINT height, UINT depth
+    );
+
+    // Toroidal addressing for clipmap-style windows (see WrapWindow.h).
+    // Volumes need a single mip and whole-tile dimensions. Wrap calls are
+    // not recorded by call recording.
+    UNITY_INTERFACE_EXPORT bool EnableWrapAddressing(VolumeHandle volume, bool enable);
+
+    // Moves the window by whole tiles, unmapping only the tiles that leave
+    // it. Copies the entering boxes, at most 24, into outBoxes and their
+    // count into outBoxCount; fails without moving the window if capacity
+    // is below 24. Upload each box's data for its world coordinates to its
+    // physical box with UploadDataToTileBox.
+    UNITY_INTERFACE_EXPORT bool ScrollVolume(
+        VolumeHandle volume,
+        INT64 dx, INT64 dy, INT64 dz,
+        WrapBox* outBoxes,
+        UINT capacity,
+        UINT* outBoxCount
+    );
+
+    // outTexelOffset receives 3 values. Shaders sample
+    // frac(windowUVW + offset / size) with a wrapping sampler.
+    UNITY_INTERFACE_EXPORT bool GetWrapOffset(VolumeHandle volume, UINT* outTexelOffset);
+
+    // Converting uploads. sourceFormat is an UploadSourceFormat:
+    //   1 = 8-bit palette indices (palette: up to 256 destination texels)
+    //   2 = float32 per channel -> R16/R16G16/R16G16B16A16_FLOAT
+    //   3 = RGB8 -> R8G8B8A8_UNORM
+    //   4 = float32 RGB -> R11G11B10_FLOAT or R9G9B9E5_SHAREDEXP
+    //   5 = uncompressed texels for a BC volume, encoded on upload:
+    //       RGBA8 for BC1/BC7, R8 for BC4, R8G8 for BC5
+    // dataSize is in source-format bytes. palette may be null otherwise.
+    UNITY_INTERFACE_EXPORT bool UploadConvertedDataToTile(
+        VolumeHandle volume,
+        UINT subResource,
+        UINT tileX, UINT tileY, UINT tileZ,
+        void* sourceData,
+        UINT dataSize,
+        UINT sourceFormat,
+        const void* palette,
+        UINT paletteSize
+    );
+
+    UNITY_INTERFACE_EXPORT bool UploadConvertedDataToTileBox(
+        VolumeHandle volume,
+        UINT subResource,
+        UINT startX, UINT startY, UINT startZ,
+        UINT width, UINT height, UINT depth,
+        void* sourceData,
+        UINT totalDataSize,
+        UINT sourceFormat,
+        const void* palette,
+        UINT paletteSize
+    );
+
+    // Encoded uploads: payload is one TileCodec-encoded tile per tile (see
+    // TileCodec.h), in x-fastest order for boxes.
+    UNITY_INTERFACE_EXPORT bool UploadEncodedDataToTile(
+        VolumeHandle volume,
+        UINT subResource,
+        UINT tileX, UINT tileY, UINT tileZ,
+        const void* payload,
+        UINT payloadSize
+    );
+
+    UNITY_INTERFACE_EXPORT bool UploadEncodedDataToTileBox(
+        VolumeHandle volume,
+        UINT subResource,
+        UINT startX, UINT startY, UINT startZ,
+        UINT width, UINT height, UINT depth,
+        const void* payload,
+        UINT payloadSize
+    );
+
+    // Encodes one 64KB linear tile in the resource's format. Returns the
+    // encoded size, or 0 if encoding fails or the result does not fit in
+    // outputCapacity (64KB + 8 always fits).
+    UNITY_INTERFACE_EXPORT UINT EncodeTileData(
+        VolumeHandle volume,
+        const void* tileData,
+        UINT tileSize,
+        void* output,
+        UINT outputCapacity
+    );
+
+    // Tile archives (see TileArchive.h). Paths are UTF-8. Close an archive
+    // only after uploads from it have completed.
+    UNITY_INTERFACE_EXPORT TileArchive* OpenTileArchive(const char* path);
+    UNITY_INTERFACE_EXPORT bool CloseTileArchive(TileArchive* archive);
+
+    UNITY_INTERFACE_EXPORT bool UploadTileFromArchive(
+        VolumeHandle volume,
+        TileArchive* archive,
+        UINT subResource,
+        UINT tileX, UINT tileY, UINT tileZ
+    );
+
+    UNITY_INTERFACE_EXPORT bool UploadTileBoxFromArchive(
+        VolumeHandle volume,
+        TileArchive* archive,
+        UINT subResource,
+        UINT startX, UINT startY, UINT startZ,
+        UINT width, UINT height, UINT depth
+    );
+
+    // Bake-time archive writer, for editor scripts. tileData is one 64KB
+    // linear tile; compress stores it TileCodec-encoded when that is
+    // smaller. FinishTileArchive releases the writer either way.
+    UNITY_INTERFACE_EXPORT TileArchiveWriter* CreateTileArchiveWriter(const char* path, UINT format);
+
+    UNITY_INTERFACE_EXPORT bool AddTileToArchive(
+        TileArchiveWriter* writer,
+        UINT subResource,
+        UINT tileX, UINT tileY, UINT tileZ,
+        const void* tileData,
+        UINT tileSize,
+        bool compress
+    );
+
+    UNITY_INTERFACE_EXPORT bool FinishTileArchive(TileArchiveWriter* writer);
+
+    // Camera-driven prefetching. mipRadii holds one radius per mip, in mip 0
+    // texels; pass exactly one of archive or callback. The archive stays
+    // mapped until prefetching is disabled, even if it is closed first.
+    // Camera vectors are three floats in mip 0 texel space, velocity in
+    // texels per second.
+    UNITY_INTERFACE_EXPORT bool EnableTilePrefetch(
+        VolumeHandle volume,
+        const float* mipRadii,
+        UINT mipRadiusCount,
+        UINT lookaheadFrames,
+        UINT maxTilesPerFrame,
+        float viewWeight,
+        TileArchive* archive,
+        TileSourceCallback callback,
+        void* userData
+    );
+
+    UNITY_INTERFACE_EXPORT bool DisableTilePrefetch(VolumeHandle volume);
+
+    // Queues this frame's most urgent tiles on the streaming scheduler behind
+    // demand uploads; ProcessStreamingQueue uploads them, calling the source
+    // callback from that thread. Returns the number of tiles newly queued.
+    UNITY_INTERFACE_EXPORT UINT UpdateTilePrefetch(
+        VolumeHandle volume,
+        const float* position,
+        const float* velocity,
+        const float* viewDirection,
+        float deltaTime
+    );
+
+    // LRU residency management: when the heap is full, allocations evict
+    // the least recently used unpinned tiles instead of failing. Call
+    // AdvanceResidencyFrame once per frame and MarkTileBoxUsed for tiles
+    // that were needed. Tiles used in the current frame are never evicted,
+    // so nothing is until the first AdvanceResidencyFrame.
+    UNITY_INTERFACE_EXPORT bool EnableResidencyManagement(bool enable);
+
+    UNITY_INTERFACE_EXPORT bool AdvanceResidencyFrame();
+
+    UNITY_INTERFACE_EXPORT bool MarkTileBoxUsed(
+        VolumeHandle volume,
+        UINT subResource,
+        UINT startX, UINT startY, UINT startZ,
+        UINT width, UINT height, UINT depth
+    );
+
+    UNITY_INTERFACE_EXPORT bool PinTileBox(
+        VolumeHandle volume,
+        UINT subResource,
+        UINT startX, UINT startY, UINT startZ,
+        UINT width, UINT height, UINT depth,
+        bool pinned
+    );
+
+    // weight > 0; idle tiles of a weight-2 resource outlive weight-1 tiles twice over
+    UNITY_INTERFACE_EXPORT bool SetResidencyPriority(VolumeHandle volume, float weight);
+
+    // Scheduled uploads: queued by priority (lower first, e.g. camera
+    // distance) and run by ProcessStreamingQueue within the per-frame
+    // budget. Data is copied. Return a request id, or 0 on failure.
+    UNITY_INTERFACE_EXPORT UINT64 ScheduleUploadToTile(
+        VolumeHandle volume,
+        UINT subResource,
+        UINT tileX, UINT tileY, UINT tileZ,
+        const void* sourceData,
+        UINT dataSize,
+        float priority
+    );
+
+    UNITY_INTERFACE_EXPORT UINT64 ScheduleUploadToTileBox(
+        VolumeHandle volume,
+        UINT subResource,
+        UINT startX, UINT startY, UINT startZ,
+        UINT width, UINT height, UINT depth,
+        const void* sourceData,
+        UINT totalDataSize,
+        float priority
+    );
+
+    UNITY_INTERFACE_EXPORT bool ReprioritizeUpload(UINT64 requestId, float priority);
+    UNITY_INTERFACE_EXPORT bool CancelUpload(UINT64 requestId);
+
+    UNITY_INTERFACE_EXPORT bool ConfigureStreaming(
+        UINT64 maxBytesPerFrame,
+        UINT maxOperationsPerFrame,
+        float agingPerFrame
+    );
+
+    // Call once per frame. Writes the id and outcome of up to capacity of
+    // the requests it ran (capacity >= maxOperationsPerFrame sees them all)
+    // and returns how many ran.
+    UNITY_INTERFACE_EXPORT UINT ProcessStreamingQueue(
+        UINT64* outRequestIds,
+        bool* outSucceeded,
+        UINT capacity
+    );
+
+    // Desired-residency solving: every tile within mipRadii[m] (world
+    // units) of the camera is wanted at mip m. The volume fills the world
+    // box boundsMin..boundsMax (three floats each).
+    UNITY_INTERFACE_EXPORT bool EnableResidencySolver(
+        VolumeHandle volume,
+        const float* boundsMin,
+        const float* boundsMax,
+        const float* mipRadii,
+        UINT mipRadiusCount
+    );
+
+    UNITY_INTERFACE_EXPORT bool DisableResidencySolver(VolumeHandle volume);
+
+    // Call once per frame. Tiles are written as four UINTs (subresource,
+    // x, y, z), up to each capacity; the counts are the full list sizes.
+    // Uploads come coarsest mip and nearest tile first and are listed again
+    // every frame until mapped. With applyUnmaps set, the listed unmaps
+    // have already been applied.
+    UNITY_INTERFACE_EXPORT bool SolveResidency(
+        VolumeHandle volume,
+        const float* cameraPosition,
+        bool applyUnmaps,
+        UINT* outUploadTiles,
+        UINT uploadCapacity,
+        UINT* outUploadCount,
+        UINT* outUnmapTiles,
+        UINT unmapCapacity,
+        UINT* outUnmapCount
+    );
+
+    // GPU usage feedback. format 0 is a tile bitmask, 1 a MinMip grid (see
+    // UsageFeedback.h); read the buffer back and pass one per frame. Tiles
+    // are written as four UINTs (subresource, x, y, z), up to each
+    // capacity; the counts are the full list sizes. Sampled mapped tiles
+    // count as used for residency management.
+    UNITY_INTERFACE_EXPORT bool EnableUsageFeedback(VolumeHandle volume);
+
+    UNITY_INTERFACE_EXPORT bool DisableUsageFeedback(VolumeHandle volume);
+
+    UNITY_INTERFACE_EXPORT UINT64 GetUsageFeedbackSize(VolumeHandle volume, UINT format);
+
+    UNITY_INTERFACE_EXPORT bool ProcessUsageFeedback(
+        VolumeHandle volume,
+        UINT format,
+        const void* data,
+        UINT64 size,
+        UINT idleFrames,
+        UINT* outRequestTiles,
+        UINT requestCapacity,
+        UINT* outRequestCount,
+        UINT* outCandidateTiles,
+        UINT candidateCapacity,
+        UINT* outCandidateCount
+    );
+
+    // Residency map: a Texture3D (R8_UINT) with one texel per mip 0 tile
+    // holding the finest mip resident over it, through the packed tail, or
+    // the mip count where nothing is. Clamp the sampling LOD to it. Call
+    // UpdateResidencyMap once per frame after the frame's uploads, and wrap
+    // the texture with Texture3D.CreateExternalTexture.
+    UNITY_INTERFACE_EXPORT bool EnableResidencyMap(VolumeHandle volume);
+
+    UNITY_INTERFACE_EXPORT bool DisableResidencyMap(VolumeHandle volume);
+
+    UNITY_INTERFACE_EXPORT bool UpdateResidencyMap(VolumeHandle volume);
+
+    UNITY_INTERFACE_EXPORT ID3D12Resource* GetResidencyMapTexture(VolumeHandle volume);
+
+    // Pipeline stats: wall-time latency per stage (PipelineStage order:
+    // validate, acquire slot, staging fill, map tiles, record copy, submit,
+    // unmap) and counters (bytes uploaded, tiles mapped, tiles unmapped),
+    // accumulated since the last reset. Percentiles are accurate to 12.5%.
+    // Both getters return false when the plugin was built with
+    // SPARSE_NO_PIPELINE_STATS.
+    UNITY_INTERFACE_EXPORT bool GetPipelineStats(C_PipelineStats* outStats);
+
+    // Raw nanosecond histogram of one stage. Bucket i < 8 holds the value
+    // i; above that bucket i starts at (8 + i % 8) << (i / 8 - 1).
+    // outBucketCount receives the full bucket count (496).
+    UNITY_INTERFACE_EXPORT bool GetPipelineHistogram(
+        UINT stage,
+        UINT64* outBuckets,
+        UINT capacity,
+        UINT* outBucketCount
+    );
+
+    UNITY_INTERFACE_EXPORT bool ResetPipelineStats();
+
+    // Event tracing: while enabled, pipeline phases, fence waits, signals
+    // and completions, and heap allocation failures are recorded into
+    // fixed-size per-thread ring buffers (the last 8192 events per thread).
+    // DumpTrace writes them as Chrome trace JSON, loadable in
+    // chrome://tracing or ui.perfetto.dev. Both return false when the
+    // plugin was built with SPARSE_NO_EVENT_TRACE.
+    UNITY_INTERFACE_EXPORT bool SetTracingEnabled(bool enabled);
+
+    UNITY_INTERFACE_EXPORT bool DumpTrace(const char* path);
+
+    // Call recording: logs CreateVolumetricResource(Ex),
+    // DestroyVolumetricResource, UploadDataToTile, UploadDataToTileBox and
+    // UnmapTile calls, with their start times and results, to a compact
+    // binary trace (see CallTrace.h). Batch and volume set uploads are
+    // logged as one UploadDataToTileBox call per box. payloadMode is a CallPayloadMode:
+    // 0 = sizes only, 1 = 64-bit payload hashes, 2 = full payloads.
+    UNITY_INTERFACE_EXPORT bool StartCallRecording(const char* path, UINT payloadMode);
+
+    UNITY_INTERFACE_EXPORT bool StopCallRecording();
+
+    // Replays a recorded trace against this plugin. Calls go straight to
+    // the plugin and are not themselves recorded. Traces without payloads
+    // upload deterministic filler of the recorded size.
+    UNITY_INTERFACE_EXPORT bool ReplayCallRecording(
+        const char* path,
+        bool honorTimestamps,
+        CallReplayStats* outStats
+    );
+
+    // Runs the upload benchmark (see PipelineBenchmark.h). With
+    // useSoftwareBackend set it runs on a private plugin over a simulated
+    // device and needs no graphics device; otherwise it runs on the live
+    // plugin, in volumes of its own that it destroys afterwards.
+    UNITY_INTERFACE_EXPORT bool BenchmarkUploadPipeline(
+        const PipelineBenchmarkSettings* settings,
+        PipelineBenchmarkResult* outResult
+    );
 }
\ No newline at end of file
@@ -1,13 +1,36 @@
 #include "pch.h"
 #include <stdexcept>
-#include "FixedHeap.h"
+#include "D3D12Backend.h"
 #include <format>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
 #include "RenderingPlugin.h"
 
 
 
+RenderingPlugin::RenderingPlugin(std::unique_ptr<IGpuBackend> backend, IUnityLog* log)
+	: s_UnityInterfaces(nullptr), s_Graphics(nullptr), s_D3D12(nullptr), s_Log(log), s_Device(nullptr)
+{
+	try {
+		InitializeBackend(std::move(backend));
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+	}
+}
+
+RenderingPlugin::~RenderingPlugin()
+{
+	// Volumes still registered are freed along with the plugin, without
+	// unmapping their tiles one by one
+	m_shuttingDown.store(true, std::memory_order_release);
+}
+
 RenderingPlugin::RenderingPlugin(IUnityInterfaces* unityInterface) : s_UnityInterfaces(unityInterface) {
 
 
@@ -62,39 +85,11 @@ void RenderingPlugin::InitializeGraphicsDevice()
 			return;
 		}
 
-		// Create tile heap
-		g_tileHeap = std::make_unique<FixedHeap>(s_Device, 512 * 1024 * 1024);
-
-
-		// Create fence object
-		HRESULT hr = s_Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_uploadFence));
-		if (FAILED(hr) || !m_uploadFence) {
-			LogError("UploadDataToTile: CreateFence failed");
-		}
-
-		// Create allocator pool
-		for (UINT i = 0; i < ALLOCATOR_POOL_SIZE; ++i) {
-			s_Device->CreateCommandAllocator(
-				D3D12_COMMAND_LIST_TYPE_DIRECT,
-				IID_PPV_ARGS(m_uploadAllocators[i].GetAddressOf())
-			);
-			m_allocatorFenceValues[i] = 0;
-		}
-
-		if (!InitializeUploadBuffers()) {
-			LogError("Failed to initialize upload buffers");
-			initialized.store(false, std::memory_order_release);
-			return;
-		}
-
-		if (!InitializeBatchUploadBuffers()) {
-			LogError("Failed to initialize batch upload buffers");
-			initialized.store(false, std::memory_order_release);
+		if (!InitializeBackend(std::make_unique<D3D12Backend>(s_D3D12, s_Log))) {
 			return;
 		}
 
 		Log("Found appropriate D3D12 device");
-		initialized.store(true, std::memory_order_release);
 
 		RunDiagnostics(false);
 
@@ -105,6 +100,28 @@ void RenderingPlugin::InitializeGraphicsDevice()
 	}
 }
 
+bool RenderingPlugin::InitializeBackend(std::unique_ptr<IGpuBackend> backend)
+{
+	// Fence, allocator pool and staging ring
+	if (!backend->Initialize(ALLOCATOR_POOL_SIZE, UPLOAD_TILE_SIZE, BATCH_UPLOAD_BYTE_SIZE)) {
+		LogError("Failed to initialize upload buffers");
+		initialized.store(false, std::memory_order_release);
+		return false;
+	}
+
+	// Staging memory stays mapped so producers can stage without Map/Unmap
+	for (UINT i = 0; i < ALLOCATOR_POOL_SIZE; ++i) {
+		m_uploadBufferData[i] = backend->GetStagingMemory(StagingBuffer::Tile, i);
+		m_batchUploadBufferData[i] = backend->GetStagingMemory(StagingBuffer::Batch, i);
+		m_allocatorFenceValues[i] = 0;
+	}
+
+	g_tileHeap = backend->CreateTileHeap(TILE_HEAP_BYTE_SIZE);
+	m_backend = std::move(backend);
+	initialized.store(true, std::memory_order_release);
+	return true;
+}
+
 void RenderingPlugin::Log(const std::string& message)
 {
 	UNITY_LOG(s_Log, message.c_str());
@@ -115,55 +132,373 @@ void RenderingPlugin::LogError(const std::string& message)
 	UNITY_LOG_ERROR(s_Log, message.c_str());
 }
 
-ReservedResource* RenderingPlugin::CreateVolumetricResource(
+VolumeHandle RenderingPlugin::CreateVolumetricResource(
 	UINT width, UINT height, UINT depth,
 	bool useMipmaps,
 	UINT mipmapCount,
-	DXGI_FORMAT format
+	DXGI_FORMAT format,
+	UINT flags
 ) {
 	if (!initialized.load(std::memory_order_acquire)) {
 		LogError("CreateVolumetricResource called before plugin initialised with D3D12 device");
-		return nullptr;
+		return 0;
 	}
 	try {
+		const bool standardSwizzle = (flags & VOLUME_CREATE_FLAG_STANDARD_SWIZZLE) != 0;
+		if (standardSwizzle)
+		{
+			// Calibrating the layout needs a real device
+			D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+			if (!s_Device
+				|| FAILED(s_Device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)))
+				|| !options.StandardSwizzle64KBSupported)
+			{
+				LogError("CreateVolumetricResource: 64KB standard swizzle is not supported by this device");
+				return 0;
+			}
+			if (GetBytesPerPixel(format) == 0)
+			{
+				LogError("CreateVolumetricResource: standard swizzle needs an uncompressed format");
+				return 0;
+			}
+		}
+
+		if (IsBlockCompressed(format) && (width % 4 != 0 || height % 4 != 0))
+		{
+			LogError(std::format(
+				"CreateVolumetricResource: block-compressed volumes need a width and height divisible by 4, got {}x{}",
+				width, height));
+			return 0;
+		}
 
-		g_resources.push_back(std::make_unique<ReservedResource>(
+		std::unique_ptr<ReservedResource> resource = m_backend->CreateReservedResource(
 			width, height, depth,
 			useMipmaps,
 			static_cast<UINT>(useMipmaps ? mipmapCount : 1),
-			format, s_Device, s_Log
-		));
+			format,
+			standardSwizzle
+				? D3D12_TEXTURE_LAYOUT_64KB_STANDARD_SWIZZLE
+				: D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE
+		);
+		if (!resource)
+		{
+			return 0;
+		}
+
+		if (standardSwizzle)
+		{
+			SwizzlePattern pattern;
+			if (!GetStandardSwizzlePattern(format, resource->GetTilingInfo(), &pattern))
+			{
+				return 0;
+			}
+			resource->SetSwizzlePattern(pattern);
+		}
+
+		resource->SetResidencyManager(GetResidencyManager());
+
+		// The table and every pin share ownership; the last one to let go
+		// tears the volume down (see ReleaseVolume)
+		ReservedResource* inserted = resource.get();
+		std::shared_ptr<ReservedResource> owned(resource.release(), [this](ReservedResource* released) {
+			ReleaseVolume(released);
+		});
 
-		return g_resources.back().get();
+		std::lock_guard<std::mutex> lock(m_resourceMutex);
+		inserted->handle = m_resources.Insert(std::move(owned));
+		return inserted->handle;
 	}
 	catch (const std::runtime_error& ex)
 	{
 		LogError(ex.what());
+		return 0;
+	}
+}
+
+ReservedResource* RenderingPlugin::GetVolumetricResource(VolumeHandle handle)
+{
+	if (handle == 0) {
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(m_resourceMutex);
+	ReservedResource* resource = m_resources.Get(handle);
+	if (!resource) {
+		LogError(std::format("Volume handle {:#x} is stale or invalid", handle));
+	}
+	return resource;
+}
+
+std::shared_ptr<ReservedResource> RenderingPlugin::PinVolumetricResource(VolumeHandle handle)
+{
+	if (handle == 0) {
 		return nullptr;
 	}
+
+	std::lock_guard<std::mutex> lock(m_resourceMutex);
+	std::shared_ptr<ReservedResource> resource = m_resources.Pin(handle);
+	if (!resource) {
+		LogError(std::format("Volume handle {:#x} is stale or invalid", handle));
+	}
+	return resource;
 }
 
-bool RenderingPlugin::DestroyVolumetricResource(ReservedResource* resource)
+bool RenderingPlugin::DestroyVolumetricResource(VolumeHandle handle)
 {
 	try {
-		auto it = std::find_if(g_resources.begin(), g_resources.end(),
-			[resource](const std::unique_ptr<ReservedResource>& p) {
-				return p.get() == resource;
-			});
-		if (it != g_resources.end())
+		// Taken out of the table first, so the handle stops resolving and no
+		// new pins can be taken
+		std::shared_ptr<ReservedResource> owned;
 		{
-			g_resources.erase(it);
-			return true;
+			std::lock_guard<std::mutex> lock(m_resourceMutex);
+			ReservedResource* member = m_resources.Get(handle);
+			if (member && member->GetVolumeSet())
+			{
+				LogError(std::format(
+					"DestroyVolumetricResource: volume {:#x} belongs to set {:#x}; destroy the set first",
+					handle, member->GetVolumeSet()->handle));
+				return false;
+			}
+			owned = m_resources.Remove(handle);
 		}
-		else {
-			LogError("Reserved resource not found");
+		if (!owned)
+		{
+			LogError(std::format("DestroyVolumetricResource: volume handle {:#x} is stale or invalid", handle));
 			return false;
 		}
+
+		// Queued uploads and prefetches hold pins; dropping them here leaves
+		// only calls already running, and the last of those tears the volume
+		// down as it returns. Nothing waits, so this may run from inside such
+		// a call.
+		std::shared_ptr<TilePrefetcher> prefetcher = owned->GetTilePrefetcher();
+		owned->SetTilePrefetcher(nullptr);
+		if (prefetcher) {
+			CancelPrefetchRequests(*prefetcher);
+		}
+		m_streamingScheduler.CancelOwner(owned.get());
+		return true;
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+void RenderingPlugin::ReleaseVolume(ReservedResource* resource)
+{
+	std::unique_ptr<ReservedResource> owned(resource);
+	if (m_shuttingDown.load(std::memory_order_acquire)) {
+		return;
+	}
+
+	try {
+		// Hand any tiles still mapped back to the heap via the retirement list
+		if (initialized.load(std::memory_order_acquire)) {
+			const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+			const UINT tiledSubresources = tilingInfo.NumPackedMips > 0
+				? tilingInfo.NumStandardMips + 1
+				: tilingInfo.SubresourceCount;
+			for (UINT sub = 0; sub < tiledSubresources; ++sub) {
+				UnmapSubresource(resource, sub);
+			}
+		}
+
+		// Forget its pins and priority along with anything left mapped
+		resource->SetResidencyManager(nullptr);
 	}
 	catch (const std::exception& ex) {
 		LogError(ex.what());
+	}
+}
+
+std::shared_ptr<ReservedResource> RenderingPlugin::PinResource(ReservedResource* resource)
+{
+	std::lock_guard<std::mutex> lock(m_resourceMutex);
+	std::shared_ptr<ReservedResource> pinned = m_resources.Pin(resource->handle);
+	if (pinned.get() != resource) {
+		LogError(std::format("Volume {:#x} has been destroyed", resource->handle));
+		return nullptr;
+	}
+	return pinned;
+}
+
+StreamingRequestId RenderingPlugin::EnqueueStreamingWork(
+	const std::shared_ptr<ReservedResource>& resource,
+	float priority,
+	uint64_t bytes,
+	std::function<bool()> work
+) {
+	const StreamingRequestId id = m_streamingScheduler.Enqueue(resource.get(), priority, bytes, std::move(work));
+
+	// DestroyVolumetricResource takes the volume out of the table before it
+	// cancels the volume's queue, so work queued after that cancel would
+	// hold its pin until it ran; drop it now instead
+	bool registered;
+	{
+		std::lock_guard<std::mutex> lock(m_resourceMutex);
+		registered = m_resources.Get(resource->handle) == resource.get();
+	}
+	if (!registered) {
+		m_streamingScheduler.Cancel(id);
+		LogError(std::format("Volume {:#x} was destroyed while its upload was being queued", resource->handle));
+		return 0;
+	}
+	return id;
+}
+
+VolumeSetHandle RenderingPlugin::CreateVolumeSet(std::span<const VolumeHandle> members)
+{
+	if (!initialized.load(std::memory_order_acquire)) {
+		LogError("CreateVolumeSet: plugin not initialized");
+		return 0;
+	}
+	try {
+		std::lock_guard<std::mutex> mappingLock(m_mappingMutex);
+		std::lock_guard<std::mutex> lock(m_resourceMutex);
+
+		std::vector<std::shared_ptr<ReservedResource>> resources;
+		for (size_t i = 0; i < members.size(); ++i)
+		{
+			std::shared_ptr<ReservedResource> resource = m_resources.Pin(members[i]);
+			if (!resource)
+			{
+				LogError(std::format("CreateVolumeSet: volume handle {:#x} is stale or invalid", members[i]));
+				return 0;
+			}
+			if (resource->GetVolumeSet())
+			{
+				LogError(std::format(
+					"CreateVolumeSet: volume {:#x} already belongs to set {:#x}",
+					members[i], resource->GetVolumeSet()->handle));
+				return 0;
+			}
+			if (resource->GetMipChainBuilder())
+			{
+				LogError(std::format(
+					"CreateVolumeSet: volume {:#x} generates CPU mips, which set uploads do not build",
+					members[i]));
+				return 0;
+			}
+
+			// Tiles mapped on their own have no heap run to join
+			std::vector<FeedbackTile> mapped;
+			resource->GetMappedStandardTiles(mapped);
+			if (!mapped.empty())
+			{
+				LogError(std::format(
+					"CreateVolumeSet: volume {:#x} already has {} standard tiles mapped",
+					members[i], mapped.size()));
+				return 0;
+			}
+			resources.push_back(std::move(resource));
+		}
+
+		std::string error;
+		std::unique_ptr<VolumeSet> set = VolumeSet::Create(std::move(resources), &error);
+		if (!set)
+		{
+			LogError(std::format("CreateVolumeSet: {}", error));
+			return 0;
+		}
+
+		VolumeSet* inserted = set.get();
+		inserted->handle = m_volumeSets.Insert(std::move(set));
+		for (ReservedResource* member : inserted->GetMembers())
+		{
+			member->SetVolumeSet(inserted, member == inserted->GetPrimary());
+		}
+		return inserted->handle;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return 0;
+	}
+}
+
+bool RenderingPlugin::DestroyVolumeSet(VolumeSetHandle handle)
+{
+	try {
+		std::lock_guard<std::mutex> mappingLock(m_mappingMutex);
+		std::lock_guard<std::mutex> lock(m_resourceMutex);
+		std::shared_ptr<VolumeSet> set = m_volumeSets.Remove(handle);
+		if (!set)
+		{
+			LogError(std::format("DestroyVolumeSet: set handle {:#x} is stale or invalid", handle));
+			return false;
+		}
+
+		// Each member's tiles stay registered with the member, so they
+		// unmap and retire one by one from here on
+		for (ReservedResource* member : set->GetMembers())
+		{
+			member->SetVolumeSet(nullptr, true);
+		}
+		return true;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+VolumeSet* RenderingPlugin::GetVolumeSet(VolumeSetHandle handle)
+{
+	if (handle == 0) {
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(m_resourceMutex);
+	VolumeSet* set = m_volumeSets.Get(handle);
+	if (!set) {
+		LogError(std::format("Volume set handle {:#x} is stale or invalid", handle));
+	}
+	return set;
+}
+
+std::shared_ptr<VolumeSet> RenderingPlugin::PinVolumeSet(VolumeSetHandle handle)
+{
+	if (handle == 0) {
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(m_resourceMutex);
+	std::shared_ptr<VolumeSet> set = m_volumeSets.Pin(handle);
+	if (!set) {
+		LogError(std::format("Volume set handle {:#x} is stale or invalid", handle));
+	}
+	return set;
+}
+
+bool RenderingPlugin::RejectDestroyedSet(const char* caller, const VolumeSet* set)
+{
+	if (set->GetPrimary()->GetVolumeSet() == set) {
+		return false;
+	}
+
+	LogError(std::format("{}: set {:#x} has been destroyed", caller, set->handle));
+	return true;
+}
+
+bool RenderingPlugin::RejectSetMember(const char* caller, const ReservedResource* resource)
+{
+	VolumeSet* set = resource ? resource->GetVolumeSet() : nullptr;
+	if (!set) {
 		return false;
 	}
+
+	LogError(std::format(
+		"{}: volume {:#x} belongs to set {:#x}; map and unmap it through the set",
+		caller, resource->handle, set->handle));
+	return true;
+}
+
+ReservedResource* RenderingPlugin::GetResidencyOwner(ReservedResource* resource)
+{
+	VolumeSet* set = resource->GetVolumeSet();
+	return set ? set->GetPrimary() : resource;
 }
 
 bool RenderingPlugin::MapTileToHeap(
@@ -176,10 +511,9 @@ bool RenderingPlugin::MapTileToHeap(
 		return false;
 	}
 	try {
-		std::lock_guard<std::mutex> lock(m_mutex);
 		if (g_tileHeap == nullptr) return false;
-
-		ID3D12CommandQueue* queue = s_D3D12->GetCommandQueue();
+		SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::MapTiles);
+		SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::MapTiles, resource->handle, PackTraceTile(subResource, tileX, tileY, tileZ));
 
 		D3D12_TILED_RESOURCE_COORDINATE startCoord = {};
 		startCoord.X = tileX;
@@ -196,18 +530,18 @@ bool RenderingPlugin::MapTileToHeap(
 
 
 
-		queue->UpdateTileMappings(
-			resource->D3D12Resource.Get(),
+		m_backend->UpdateTileMappings(
+			resource,
 			1,
 			&startCoord,
 			&regionSize,
-			g_tileHeap->GetD3D12Heap(),
+			g_tileHeap.get(),
 			1,
 			&rangeFlags,
 			&tileOffsetInHeap,
-			&rangeTileCount,
-			D3D12_TILE_MAPPING_FLAG_NONE
+			&rangeTileCount
 		);
+		SPARSE_STATS_ADD(m_pipelineStats, PipelineCounter::TilesMapped, 1);
 
 		return true;
 	}
@@ -227,11 +561,14 @@ bool RenderingPlugin::UnmapDataFromTile(
 		return false;
 	}
 	try {
-		std::lock_guard<std::mutex> lock(m_mutex);
+		std::lock_guard<std::mutex> lock(m_mappingMutex);
 		if (!resource) {
 			LogError("UnmapDataFromTile: null resource");
 			return false;
 		}
+		if (!resource->GetTilingInfo().IsPackedMip(subResource) && RejectSetMember("UnmapDataFromTile", resource)) {
+			return false;
+		}
 
 		// Check if tile is actually mapped
 		if (!resource->IsTileMapped(subResource, tileX, tileY, tileZ)) {
@@ -246,17 +583,20 @@ bool RenderingPlugin::UnmapDataFromTile(
 			return false;
 		}
 
+		// Unregister from tracking first, so the residency map drops the
+		// tile before the GPU does
+		resource->UnregisterMappedTile(subResource, tileX, tileY, tileZ);
+
 		// Unmap from GPU
 		if (!UnmapTileFromHeap(subResource, tileX, tileY, tileZ, heapOffset, resource)) {
 			LogError("UnmapDataFromTile: failed to unmap tile from heap");
+			resource->RegisterMappedTile(subResource, tileX, tileY, tileZ, heapOffset);
 			return false;
 		}
 
-		// Free heap memory
-		g_tileHeap->FreeTiles(heapOffset, 1);
-
-		// Unregister from tracking
-		resource->UnregisterMappedTile(subResource, tileX, tileY, tileZ);
+		// Heap memory returns to the allocator once the GPU is past this point
+		TileRange freed = { heapOffset, 1 };
+		RetireTiles(&freed, 1);
 
 		return true;
 	}
@@ -272,9 +612,9 @@ bool RenderingPlugin::UnmapTileFromHeap(
 	UINT tileOffsetInHeap,
 	ReservedResource* resource) {
 	try {
-		if (!s_D3D12) return false;
-
-		ID3D12CommandQueue* queue = s_D3D12->GetCommandQueue();
+		if (!m_backend) return false;
+		SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::Unmap);
+		SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::Unmap, resource->handle, PackTraceTile(subResource, tileX, tileY, tileZ));
 
 		D3D12_TILED_RESOURCE_COORDINATE startCoord = {};
 		startCoord.X = tileX;
@@ -288,8 +628,9 @@ bool RenderingPlugin::UnmapTileFromHeap(
 
 		D3D12_TILE_RANGE_FLAGS rangeFlags = D3D12_TILE_RANGE_FLAG_NULL;
 
-		queue->UpdateTileMappings(
-			resource->D3D12Resource.Get(),
+		FlushResidencyMap(resource);
+		m_backend->UpdateTileMappings(
+			resource,
 			1,
 			&startCoord,
 			&regionSize,
@@ -297,8 +638,7 @@ bool RenderingPlugin::UnmapTileFromHeap(
 			1,
 			&rangeFlags,
 			nullptr,
-			nullptr,
-			D3D12_TILE_MAPPING_FLAG_NONE
+			nullptr
 		);
 
 		return true;
@@ -317,6 +657,9 @@ bool RenderingPlugin::AllocateTileToHeap(UINT* outHeapOffset) {
 		}
 
 		TileAllocation alloc = g_tileHeap->AllocateTiles(1);
+		if (!alloc.success && ReleaseRetiredTiles() > 0) {
+			alloc = g_tileHeap->AllocateTiles(1);
+		}
 
 		if (alloc.success) {
 			*outHeapOffset = alloc.heapOffsetInTiles;
@@ -325,6 +668,7 @@ bool RenderingPlugin::AllocateTileToHeap(UINT* outHeapOffset) {
 
 
 		Log("Failed to allocate tile");
+		SPARSE_TRACE_INSTANT(m_eventTracer, TraceEvent::AllocationFailure, 0, 1);
 
 		return false;
 	}
@@ -339,85 +683,121 @@ bool RenderingPlugin::UploadDataToTile(
 	UINT subResource,
 	UINT tileX, UINT tileY, UINT tileZ,
 	const std::span<std::byte>& sourceData
+) {
+	if (!ValidateSourceSize("UploadDataToTile", resource, sourceData.size_bytes(), 1, 0)) {
+		return false;
+	}
+
+	if (!UploadSingleTile(resource, subResource, tileX, tileY, tileZ,
+		MakeLinearStagingFill(resource, sourceData.data()), nullptr)) {
+		return false;
+	}
+
+	try {
+		std::shared_ptr<MipChainBuilder> builder = resource->GetMipChainBuilder();
+		if (!builder) {
+			return true;
+		}
+
+		std::vector<GeneratedMipTile> generated;
+		builder->AddTile(subResource, tileX, tileY, tileZ, sourceData.data(), generated);
+		return UploadGeneratedMips(resource, generated, nullptr);
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::UploadSingleTile(
+	ReservedResource* resource,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ,
+	const StagingFill& fill,
+	UINT64* outCompletionFence
 ) {
 	if (!initialized.load(std::memory_order_acquire)) {
 		LogError("UploadDataToTile: plugin not initialized");
 		return false;
 	}
 	try {
-		std::lock_guard<std::mutex> lock(m_mutex);
 		D3D12_RESOURCE_DESC desc;
 		ResourceTilingInfo tilingInfo;
-		ValidateTileUploadParams(resource, subResource, sourceData, &desc, &tilingInfo);
-
-		// Acquire a ring slot (allocator + upload buffer) up front
-		UINT allocatorIndex;
-		ID3D12CommandAllocator* allocator = GetAvailableAllocator(allocatorIndex);
-		if (!allocator) {
-			LogError("UploadDataToTile: no available allocator");
+		if (!ValidateTileUploadParams(resource, subResource, &desc, &tilingInfo)) {
 			return false;
 		}
-
-		ID3D12Resource* uploadBuffer = FillUploadBuffer(
-			m_uploadBuffers[allocatorIndex].Get(),
-			sourceData
-		);
-
-		if (!uploadBuffer) {
-			LogError("UploadDataToTile: FillUploadBuffer returned null");
-			m_allocatorFenceValues[allocatorIndex] = 0;
-			return false;
+		// Map the tile first; the queue executes UpdateTileMappings in call
+		// order, so the mapping lands before the copy submitted below.
+		if (!resource->IsTileMapped(subResource, tileX, tileY, tileZ)) {
+			PrepareHeapSpace(1);
 		}
 
-
 		TileMapping mapping;
-		bool tileAlreadyMapped = resource->IsTileMapped(subResource, tileX, tileY, tileZ);
-		if (tileAlreadyMapped) {
-			UINT existingHeapOffset;
-			if (!resource->GetMappedTileOffset(subResource, tileX, tileY, tileZ, &existingHeapOffset)) {
-				LogError("Tile reported as mapped but couldn't get heap offset");
-				m_allocatorFenceValues[allocatorIndex] = 0;
+		bool tileAlreadyMapped;
+		{
+			std::lock_guard<std::mutex> lock(m_mappingMutex);
+			if (!tilingInfo.IsPackedMip(subResource) && RejectSetMember("UploadDataToTile", resource)) {
 				return false;
 			}
-
-			mapping.success = true;
-			mapping.heapOffset = existingHeapOffset;
-		}
-		else {
-			mapping = AllocateAndMapTileToHeap(resource, subResource, tileX, tileY, tileZ);
-
-			if (!mapping.success) {
-				LogError("Couldn't find space for tile on heap");
-				m_allocatorFenceValues[allocatorIndex] = 0;
-				return false;
+			tileAlreadyMapped = resource->GetMappedTileOffset(
+				subResource, tileX, tileY, tileZ, &mapping.heapOffset);
+			if (tileAlreadyMapped) {
+				mapping.success = true;
+			}
+			else {
+				mapping = AllocateAndMapTileToHeap(resource, subResource, tileX, tileY, tileZ);
 			}
-
 		}
 
 		if (!mapping.success)
 		{
 			LogError("Couldn't find space for tile on heap");
-			m_allocatorFenceValues[allocatorIndex] = 0;
 			return false;
 		}
 
-		bool success = ExecuteTileCopy(
-			uploadBuffer,
-			resource,
-			subResource,
-			tileX, tileY, tileZ,
-			tilingInfo,
-			allocatorIndex
-		);
-		if (!success)
+		// Stage into this thread's ring slot without holding any shared lock
+		RingSlotLease slot(*this);
+		{
+			SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::StageFill);
+			SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::StageFill, resource->handle, PackTraceTile(subResource, tileX, tileY, tileZ));
+			fill(m_uploadBufferData[slot.Index()], 0, 1);
+		}
+
+		UploadSubmission submission = {};
+		submission.resource = resource;
+		submission.startCoord.X = tileX;
+		submission.startCoord.Y = tileY;
+		submission.startCoord.Z = tileZ;
+		submission.startCoord.Subresource = subResource;
+		submission.regionSize.NumTiles = 1;
+		submission.regionSize.UseBox = TRUE;
+		submission.regionSize.Width = 1;
+		submission.regionSize.Height = 1;
+		submission.regionSize.Depth = 1;
+		submission.sourceBuffer = StagingBuffer::Tile;
+		submission.sourceOffset = 0;
+		submission.slotIndex = slot.Index();
+
+		slot.HandOff();
+		bool success = SubmitUpload(submission);
+		if (!success && !tileAlreadyMapped)
 		{
-			if (!tileAlreadyMapped) {
-				resource->UnregisterMappedTile(subResource, tileX, tileY, tileZ);
-				UnmapTileFromHeap(subResource, tileX, tileY, tileZ, mapping.heapOffset, resource);
-				g_tileHeap->FreeTiles(mapping.heapOffset, 1);
+			// Eviction may have taken the tile back already; whoever
+			// unregisters a tile retires its heap offset
+			std::lock_guard<std::mutex> lock(m_mappingMutex);
+			std::vector<UINT> heapOffsets;
+			resource->UnregisterMappedTileBox(subResource, tileX, tileY, tileZ, 1, 1, 1, heapOffsets);
+			if (!heapOffsets.empty()) {
+				UnmapTileFromHeap(subResource, tileX, tileY, tileZ, heapOffsets[0], resource);
+				TileRange freed = { heapOffsets[0], 1 };
+				RetireTiles(&freed, 1);
 			}
 		}
 
+		if (success && outCompletionFence) {
+			*outCompletionFence = (std::max)(*outCompletionFence, submission.fenceValue);
+		}
+
 		return success;
 
 	}
@@ -431,43 +811,109 @@ bool RenderingPlugin::UploadDataToTile(
 bool RenderingPlugin::ValidateTileUploadParams(
 	const ReservedResource* resource,
 	UINT subresource,
-	const std::span<std::byte>& sourceData,
 	D3D12_RESOURCE_DESC* outResourceDesc,
 	ResourceTilingInfo* outResourceTilingInfo
 ) {
-	if (sourceData.size_bytes() != 65536)
+	SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::Validate);
+	SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::Validate, resource ? resource->handle : 0, PackTraceTile(subresource, 0, 0, 0));
+	if (!initialized.load(std::memory_order_acquire))
 	{
-		LogError(std::format("Tried uploading data of size {} bytes, expected 65536 bytes", sourceData.size_bytes()));
+		LogError("Plugin not initialized");
 		return false;
 	}
-	if (!initialized.load(std::memory_order_acquire))
+	if (!resource)
 	{
-		LogError("Plugin not initialized");
+		LogError("Reserved resource is null");
 		return false;
 	}
 
 	// Get tile size info
-	*outResourceDesc = resource->D3D12Resource->GetDesc();
+	*outResourceDesc = resource->GetDesc();
 	*outResourceTilingInfo = resource->GetTilingInfo();
-	UINT bytesPerPixel = GetBytesPerPixel(outResourceDesc->Format);
-	if (bytesPerPixel == 0)
+	if (subresource >= outResourceTilingInfo->SubresourceCount)
 	{
-		LogError("Unsupported texture format");
+		LogError(std::format("Subresource {} out of range (max {})",
+			subresource, outResourceTilingInfo->SubresourceCount - 1));
 		return false;
 	}
-	UINT unalignedRowSize = outResourceTilingInfo->TileWidthInTexels * bytesPerPixel;
-
-	UINT64 unalignedTotalSize = (UINT64)unalignedRowSize * outResourceTilingInfo->TileHeightInTexels * outResourceTilingInfo->TileDepthInTexels;
-	if (sourceData.size_bytes() != (UINT)unalignedTotalSize)
+	if (outResourceTilingInfo->IsPackedMip(subresource))
+	{
+		LogError(std::format("Subresource {} is a packed mip; use UploadPackedMips", subresource));
+		return false;
+	}
+	if (!IsSupportedTileFormat(outResourceDesc->Format))
 	{
-		LogError(std::format("Expected {} bytes, got {}", unalignedTotalSize, sourceData.size_bytes()));
+		LogError("Unsupported texture format");
 		return false;
 	}
 	return true;
 }
 
-TileMetrics RenderingPlugin::CalculateTileMetrics(
-	const D3D12_RESOURCE_DESC& desc,
+bool RenderingPlugin::ValidateSourceSize(
+	const char* caller,
+	const ReservedResource* resource,
+	UINT64 sourceSize,
+	UINT tileCount,
+	UINT sourceBytesPerTexel
+) {
+	SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::Validate);
+	SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::Validate, resource ? resource->handle : 0, 0);
+	if (!resource)
+	{
+		LogError(std::format("{}: null resource", caller));
+		return false;
+	}
+
+	const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+	const UINT64 texelsPerTile = static_cast<UINT64>(tilingInfo.TileWidthInTexels)
+		* tilingInfo.TileHeightInTexels * tilingInfo.TileDepthInTexels;
+
+	UINT64 bytesPerTile = texelsPerTile * sourceBytesPerTexel;
+	if (sourceBytesPerTexel == 0)
+	{
+		// BC tile shapes are whole 4x4x1 blocks
+		const UINT bytesPerBlock = GetBytesPerBlock(resource->textureFormat);
+		bytesPerTile = bytesPerBlock != 0
+			? texelsPerTile / 16 * bytesPerBlock
+			: texelsPerTile * GetBytesPerPixel(resource->textureFormat);
+	}
+
+	const UINT64 expectedSize = bytesPerTile * tileCount;
+	if (expectedSize == 0 || sourceSize != expectedSize)
+	{
+		LogError(std::format(
+			"{}: expected {} bytes for {} tile(s), got {}",
+			caller, expectedSize, tileCount, sourceSize));
+		return false;
+	}
+	return true;
+}
+
+StagingFill RenderingPlugin::MakeLinearStagingFill(
+	const ReservedResource* resource,
+	const std::byte* sourceData
+) {
+	if (resource->IsStandardSwizzle())
+	{
+		return [sourceData, &pattern = resource->GetSwizzlePattern()](std::byte* destination, UINT firstTile, UINT tileCount) {
+			for (UINT i = 0; i < tileCount; ++i) {
+				SwizzleTile(
+					sourceData + static_cast<size_t>(firstTile + i) * UPLOAD_TILE_SIZE,
+					destination + static_cast<size_t>(i) * UPLOAD_TILE_SIZE,
+					pattern);
+			}
+		};
+	}
+
+	return [sourceData](std::byte* destination, UINT firstTile, UINT tileCount) {
+		memcpy(destination,
+			sourceData + static_cast<size_t>(firstTile) * UPLOAD_TILE_SIZE,
+			static_cast<size_t>(tileCount) * UPLOAD_TILE_SIZE);
+	};
+}
+
+TileMetrics RenderingPlugin::CalculateTileMetrics(
+	const D3D12_RESOURCE_DESC& desc,
 	const ResourceTilingInfo& tilingInfo,
 	UINT subResource
 ) {
@@ -481,27 +927,6 @@ TileMetrics RenderingPlugin::CalculateTileMetrics(
 	return out;
 }
 
-ID3D12Resource* RenderingPlugin::FillUploadBuffer(
-	ID3D12Resource* uploadBuffer,
-	const std::span<std::byte>& sourceData
-) {
-	if (!uploadBuffer) {
-		LogError("Upload buffer is null");
-		return nullptr;
-	}
-
-	// Copy data to D3D12 resource
-	void* mapped = nullptr;
-	HRESULT hr = uploadBuffer->Map(0, nullptr, &mapped);
-	if (FAILED(hr) || !mapped) {
-		LogError(std::format("UploadDataToTile: Map failed 0x{:08x}", hr));
-		throw std::exception("UploadDataToTile: Map failed ");
-	}
-	memcpy(mapped, sourceData.data(), sourceData.size_bytes());
-	uploadBuffer->Unmap(0, nullptr);
-	return uploadBuffer;
-}
-
 TileMapping RenderingPlugin::AllocateAndMapTileToHeap(
 	ReservedResource* resource,
 	UINT subResource,
@@ -511,21 +936,15 @@ TileMapping RenderingPlugin::AllocateAndMapTileToHeap(
 	UINT heapOffsetInTiles = 0;
 	if (!AllocateTileToHeap(&heapOffsetInTiles)) {
 		LogError("UploadDataToTile: AllocateTilesFromHeap failed");
-		throw std::exception("UploadDataToTile: AllocateTilesFromHeap failed");
+		throw std::runtime_error("UploadDataToTile: AllocateTilesFromHeap failed");
 	}
 
 
-	ID3D12Heap* tileHeap = g_tileHeap->GetD3D12Heap();
-	if (!tileHeap) {
-		LogError("UploadDataToTile: GetTileHeap returned null");
-		throw std::exception("UploadDataToTile: GetTileHeap returned null");
-	}
-
 	// Map the single tile of the resource to the heap offset we allocated.
 
 	if (!MapTileToHeap(subResource, tileX, tileY, tileZ, heapOffsetInTiles, resource)) {
 		LogError("UploadDataToTile: MapTilesToHeap failed");
-		throw std::exception("UploadDataToTile: MapTilesToHeap failed");
+		throw std::runtime_error("UploadDataToTile: MapTilesToHeap failed");
 	}
 
 	TileMapping mapping;
@@ -537,201 +956,366 @@ TileMapping RenderingPlugin::AllocateAndMapTileToHeap(
 	return mapping;
 }
 
-bool RenderingPlugin::ExecuteTileCopy(
-	ID3D12Resource* uploadBuffer,
-	ReservedResource* resource,
-	UINT subResource,
-	UINT tileX, UINT tileY, UINT tileZ,
-	const ResourceTilingInfo& tilingInfo,
-	UINT allocatorIndex
-) {
-	ID3D12CommandAllocator* allocator = m_uploadAllocators[allocatorIndex].Get();
-	if (!EnsureCommandListExists(allocator)) {
-		return false;
-	}
-
-	// Set up tile region to copy
-	D3D12_TILED_RESOURCE_COORDINATE tileCoord = {};
-	tileCoord.X = tileX;
-	tileCoord.Y = tileY;
-	tileCoord.Z = tileZ;
-	tileCoord.Subresource = subResource;
+bool RenderingPlugin::SubmitUpload(UploadSubmission& submission) {
+	UploadSubmission* submissions[] = { &submission };
+	return SubmitUploads(submissions, 1);
+}
 
+bool RenderingPlugin::SubmitUploads(UploadSubmission* const* submissions, UINT count) {
+	SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::Submit);
+	SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::Submit, submissions[0]->resource->handle, PackTraceTile(submissions[0]->startCoord.Subresource, submissions[0]->startCoord.X, submissions[0]->startCoord.Y, submissions[0]->startCoord.Z));
+	m_submissionQueue.PushAll(submissions, count);
 
-	D3D12_TILE_REGION_SIZE regionSize = {};
-	regionSize.NumTiles = 1;
-	regionSize.UseBox = TRUE;
-	regionSize.Width = 1;   // 1 tile wide
-	regionSize.Height = 1;  // 1 tile tall
-	regionSize.Depth = 1;
-
-	m_uploadCommandList->CopyTiles(
-		resource->D3D12Resource.Get(),
-		&tileCoord,
-		&regionSize,
-		uploadBuffer,
-		0,  // offset in upload buffer
-		D3D12_TILE_COPY_FLAG_LINEAR_BUFFER_TO_SWIZZLED_TILED_RESOURCE
-	);
+	// Whoever holds the lock drains every queued submission, so by the time
+	// we acquire it our own entries have either been recorded or are still
+	// queued. They were pushed together, so they land in the same batch.
+	std::lock_guard<std::mutex> lock(m_submitMutex);
+	FlushSubmissionQueue();
 
-	HRESULT hr = m_uploadCommandList->Close();
-	if (FAILED(hr)) {
-		LogError("ExecuteTileCopy: cmdList->Close failed");
+	if (!submissions[0]->succeeded) {
+		LogError("SubmitUpload: failed to record or execute copy");
 		return false;
 	}
 
+#if defined(SPARSE_PIPELINE_STATS)
+	UINT64 bytes = 0;
+	for (UINT s = 0; s < count; ++s) {
+		const UploadSubmission& submission = *submissions[s];
+		if (submission.footprintCount > 0) {
+			for (UINT i = 0; i < submission.footprintCount; ++i) {
+				const D3D12_SUBRESOURCE_FOOTPRINT& footprint = submission.footprints[i].Footprint;
+				bytes += static_cast<UINT64>(footprint.RowPitch) * footprint.Height * footprint.Depth;
+			}
+		}
+		else {
+			bytes += static_cast<UINT64>(submission.regionSize.NumTiles) * UPLOAD_TILE_SIZE;
+		}
+	}
+	m_pipelineStats.Add(PipelineCounter::BytesUploaded, bytes);
+#endif
+	return true;
+}
 
-	ID3D12CommandQueue* queue = s_D3D12->GetCommandQueue();
-	ID3D12CommandList* lists[] = { m_uploadCommandList.Get() };
-	queue->ExecuteCommandLists(1, lists);
+void RenderingPlugin::FlushSubmissionQueue() {
+	UploadSubmission* pending = m_submissionQueue.PopAll();
+	if (!pending) {
+		return;
+	}
 
-	const UINT64 nextFenceValue = ++m_fenceValue;
-	hr = queue->Signal(m_uploadFence.Get(), nextFenceValue);
-	if (FAILED(hr))
+	// Record the whole batch on the first slot's allocator; every slot in the
+	// batch is retired by the same fence value.
+	bool executed;
 	{
-		LogError("queue->Signal failed in UploadDataToTile");
-		return false;
+		SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::RecordCopy);
+#if defined(SPARSE_EVENT_TRACE)
+		UINT64 batchSize = 0;
+		for (const UploadSubmission* s = pending; s; s = s->next) {
+			++batchSize;
+		}
+		SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::RecordCopy, 0, batchSize);
+#endif
+		executed = m_backend->ExecuteCopies(pending, pending->slotIndex);
 	}
 
-	m_allocatorFenceValues[allocatorIndex] = nextFenceValue;
+	UINT64 fenceValue = m_fenceValue;
+	if (executed) {
+		fenceValue = ++m_fenceValue;
+		if (!m_backend->Signal(fenceValue)) {
+			LogError("FlushSubmissionQueue: queue->Signal failed");
+			executed = false;
+		}
+		else {
+			SPARSE_TRACE_INSTANT(m_eventTracer, TraceEvent::FenceSignal, 0, fenceValue);
+		}
+	}
 
-	return true;
+	{
+		std::lock_guard<std::mutex> ringLock(m_ringMutex);
+		UploadSubmission* s = pending;
+		while (s) {
+			// Read next before publishing the result; the producer may
+			// reclaim its stack entry as soon as it observes it.
+			UploadSubmission* next = s->next;
+			m_allocatorFenceValues[s->slotIndex] = fenceValue;
+			m_slotInUse[s->slotIndex] = false;
+			s->fenceValue = fenceValue;
+			s->succeeded = executed;
+			s = next;
+		}
+	}
+	m_slotAvailable.notify_all();
 }
 
-ID3D12CommandAllocator* RenderingPlugin::GetAvailableAllocator(UINT& outAllocatorIndex) {
-	// Start searching from the slot after the last-used one
-	UINT startIndex = (m_currentAllocatorIndex + 1) % ALLOCATOR_POOL_SIZE;
-	for (UINT i = 0; i < ALLOCATOR_POOL_SIZE; i++) {
-		UINT index = (startIndex + i) % ALLOCATOR_POOL_SIZE;
+void RenderingPlugin::RetireTiles(const TileRange* ranges, UINT rangeCount) {
+	if (rangeCount == 0) {
+		return;
+	}
 
-		if (m_allocatorFenceValues[index] == 0) {
-			m_currentAllocatorIndex = index;
-			outAllocatorIndex = index;
-			return m_uploadAllocators[index].Get();
-		}
+	std::lock_guard<std::mutex> lock(m_submitMutex);
 
-		if (m_uploadFence->GetCompletedValue() >= m_allocatorFenceValues[index]) {
-			m_uploadAllocators[index]->Reset();
-			m_currentAllocatorIndex = index;
-			outAllocatorIndex = index;
-			return m_uploadAllocators[index].Get();
-		}
+	// The signal lands behind the NULL mappings and any earlier GPU work
+	// that may still read or write these tiles
+	const UINT64 fenceValue = ++m_fenceValue;
+	if (!m_backend->Signal(fenceValue)) {
+		// A later signal still covers this value; the tiles just wait longer
+		LogError("RetireTiles: queue->Signal failed");
 	}
-
-	// All slots in flight — wait for the oldest
-	UINT oldestIndex = startIndex;
-	UINT64 oldestFenceValue = m_allocatorFenceValues[oldestIndex];
-	if (m_uploadFence->GetCompletedValue() < oldestFenceValue) {
-		m_uploadFence->SetEventOnCompletion(oldestFenceValue, m_fenceEvent.get());
-		WaitForSingleObject(m_fenceEvent.get(), INFINITE);
+	else {
+		SPARSE_TRACE_INSTANT(m_eventTracer, TraceEvent::FenceSignal, 0, fenceValue);
 	}
 
-	m_uploadAllocators[oldestIndex]->Reset();
-	m_currentAllocatorIndex = oldestIndex;
-	outAllocatorIndex = oldestIndex;
-	return m_uploadAllocators[oldestIndex].Get();
+	std::lock_guard<std::mutex> retireLock(m_retireMutex);
+	for (UINT i = 0; i < rangeCount; ++i) {
+		m_retiredTiles.push_back({ ranges[i], fenceValue });
+		SPARSE_STATS_ADD(m_pipelineStats, PipelineCounter::TilesUnmapped, ranges[i].numTiles);
+	}
 }
 
-bool RenderingPlugin::EnsureCommandListExists(ID3D12CommandAllocator* allocator) {
-	if (m_uploadCommandList) {
-		HRESULT hr = m_uploadCommandList->Reset(allocator, nullptr);
-		if (FAILED(hr)) {
-			LogError(std::format("Failed to reset command list: 0x{:08x}", hr));
-			return false;
+UINT RenderingPlugin::ReleaseRetiredTiles() {
+	if (!g_tileHeap || !m_backend) {
+		return 0;
+	}
+
+	const UINT64 completedValue = m_backend->GetCompletedFenceValue();
+	std::vector<TileRange> released;
+	UINT releasedTiles = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_retireMutex);
+		while (!m_retiredTiles.empty() && m_retiredTiles.front().fenceValue <= completedValue) {
+			released.push_back(m_retiredTiles.front().range);
+			releasedTiles += m_retiredTiles.front().range.numTiles;
+			m_retiredTiles.pop_front();
 		}
-		return true;
+	}
+	if (!released.empty()) {
+		SPARSE_TRACE_INSTANT(m_eventTracer, TraceEvent::FenceComplete, 0, completedValue);
 	}
 
-	// First time - create it
-	HRESULT hr = s_Device->CreateCommandList(
-		0,
-		D3D12_COMMAND_LIST_TYPE_DIRECT,
-		allocator,
-		nullptr,
-		IID_PPV_ARGS(&m_uploadCommandList)
-	);
+	g_tileHeap->FreeTileRanges(released.data(), static_cast<UINT>(released.size()));
+	return releasedTiles;
+}
 
-	if (FAILED(hr)) {
-		LogError(std::format("Failed to create command list: 0x{:08x}", hr));
-		return false;
+UINT RenderingPlugin::WaitForRetiredTiles() {
+	if (!m_backend) {
+		return 0;
 	}
 
-	return true;
+	UINT64 waitValue = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_retireMutex);
+		if (m_retiredTiles.empty()) {
+			return 0;
+		}
+		waitValue = m_retiredTiles.back().fenceValue;
+	}
+
+	if (m_backend->GetCompletedFenceValue() < waitValue) {
+		SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::FenceWait, 0, waitValue);
+		m_backend->WaitForFence(waitValue);
+	}
+	return ReleaseRetiredTiles();
 }
 
-bool RenderingPlugin::InitializeUploadBuffers() {
-	D3D12_HEAP_PROPERTIES uploadHeapProps = {};
-	uploadHeapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+UINT RenderingPlugin::GetRetiredTileCount() {
+	std::lock_guard<std::mutex> lock(m_retireMutex);
+	UINT tiles = 0;
+	for (const RetiredTileRange& retired : m_retiredTiles) {
+		tiles += retired.range.numTiles;
+	}
+	return tiles;
+}
 
-	D3D12_RESOURCE_DESC bufferDesc = {};
-	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	bufferDesc.Width = UPLOAD_TILE_SIZE;
-	bufferDesc.Height = 1;
-	bufferDesc.DepthOrArraySize = 1;
-	bufferDesc.MipLevels = 1;
-	bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
-	bufferDesc.SampleDesc.Count = 1;
-	bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+UINT RenderingPlugin::GetFreeHeapTiles() {
+	return g_tileHeap ? g_tileHeap->GetFreeTiles() : 0;
+}
 
-	for (UINT i = 0; i < ALLOCATOR_POOL_SIZE; ++i) {
-		HRESULT hr = s_Device->CreateCommittedResource(
-			&uploadHeapProps,
-			D3D12_HEAP_FLAG_NONE,
-			&bufferDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(&m_uploadBuffers[i])
-		);
+bool RenderingPlugin::EvictForAllocation(UINT tileCount) {
+	std::shared_ptr<ResidencyManager> residency = GetResidencyManager();
+	if (!residency) {
+		return false;
+	}
 
-		if (FAILED(hr)) {
-			LogError(std::format("Failed to create upload buffer {}: 0x{:08x}", i, hr));
+	size_t evicted = 0;
+	while (!g_tileHeap->CanAllocate(tileCount)) {
+		if (ReleaseRetiredTiles() > 0) {
+			continue;
+		}
+
+		// Tiles unmapped earlier, by eviction or otherwise, come back once
+		// the GPU is past them; count them rather than wait here. A box
+		// needs contiguous space, so fragmentation can leave it short even
+		// when enough tiles are free; keep evicting in batches.
+		const UINT retiredTiles = GetRetiredTileCount();
+		const UINT freeTiles = g_tileHeap->GetFreeTiles() + retiredTiles;
+		if (retiredTiles > 0 && freeTiles >= tileCount) {
+			return true;
+		}
+		const UINT shortfall = tileCount > freeTiles ? tileCount - freeTiles : 1;
+		std::vector<ResidentTile> victims;
+		const uint32_t selected = residency->SelectVictims((std::max)(shortfall, RESIDENCY_EVICTION_BATCH), victims);
+		if (selected < shortfall) {
+			if (!victims.empty()) {
+				EvictTilesLocked(victims);
+			}
+			LogError(std::format(
+				"EvictForAllocation: {} tiles short of {} ({} evicted); tiles "
+				"used this frame and pinned tiles are not evicted",
+				shortfall - selected, tileCount, evicted + victims.size()));
 			return false;
 		}
-	}
 
+		EvictTilesLocked(victims);
+		evicted += victims.size();
+	}
 	return true;
 }
 
-bool RenderingPlugin::InitializeBatchUploadBuffers() {
-	D3D12_HEAP_PROPERTIES uploadHeapProps = {};
-	uploadHeapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+void RenderingPlugin::PrepareHeapSpace(UINT tileCount) {
+	if (g_tileHeap->CanAllocate(tileCount) || !GetResidencyManager()) {
+		return;
+	}
 
-	D3D12_RESOURCE_DESC bufferDesc = {};
-	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-	bufferDesc.Width = BATCH_UPLOAD_BYTE_SIZE;
-	bufferDesc.Height = 1;
-	bufferDesc.DepthOrArraySize = 1;
-	bufferDesc.MipLevels = 1;
-	bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
-	bufferDesc.SampleDesc.Count = 1;
-	bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	// Evict under the mapping lock, then wait for the evicted tiles with it
+	// released so other threads keep mapping and unmapping meanwhile
+	for (;;) {
+		{
+			std::lock_guard<std::mutex> lock(m_mappingMutex);
+			if (g_tileHeap->CanAllocate(tileCount) || !EvictForAllocation(tileCount)) {
+				return;
+			}
+		}
+		if (WaitForRetiredTiles() == 0) {
+			return;
+		}
+	}
+}
 
-	for (UINT i = 0; i < ALLOCATOR_POOL_SIZE; ++i) {
-		HRESULT hr = s_Device->CreateCommittedResource(
-			&uploadHeapProps,
-			D3D12_HEAP_FLAG_NONE,
-			&bufferDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
+UINT RenderingPlugin::EvictTilesLocked(const std::vector<ResidentTile>& victims) {
+	std::unordered_map<void*, std::vector<D3D12_TILED_RESOURCE_COORDINATE>> coordsByResource;
+	std::vector<UINT> heapOffsets;
+	heapOffsets.reserve(victims.size());
+
+	for (const ResidentTile& tile : victims) {
+		// A set's primary stands for the coordinate in every member
+		ReservedResource* owner = static_cast<ReservedResource*>(tile.owner);
+		VolumeSet* set = owner->GetVolumeSet();
+		std::vector<ReservedResource*> resources = { owner };
+		if (set) {
+			std::vector<UINT> runStarts;
+			set->UnregisterBox(tile.subresource, tile.x, tile.y, tile.z, 1, 1, 1, runStarts);
+			resources = set->GetMembers();
+		}
+
+		for (ReservedResource* resource : resources) {
+			const size_t before = heapOffsets.size();
+			resource->UnregisterMappedTileBox(tile.subresource, tile.x, tile.y, tile.z, 1, 1, 1, heapOffsets);
+			if (heapOffsets.size() == before) {
+				continue;
+			}
+
+			D3D12_TILED_RESOURCE_COORDINATE coord = {};
+			coord.X = tile.x;
+			coord.Y = tile.y;
+			coord.Z = tile.z;
+			coord.Subresource = tile.subresource;
+			coordsByResource[resource].push_back(coord);
+		}
+	}
+
+	SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::Unmap);
+	SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::Unmap, 0, 0);
+	for (auto& [owner, coords] : coordsByResource) {
+		// One region per tile, all pointing at a single NULL range
+		const UINT regionCount = static_cast<UINT>(coords.size());
+		std::vector<D3D12_TILE_REGION_SIZE> regionSizes(regionCount);
+		for (D3D12_TILE_REGION_SIZE& size : regionSizes) {
+			size.NumTiles = 1;
+			size.UseBox = FALSE;
+		}
+
+		D3D12_TILE_RANGE_FLAGS rangeFlags = D3D12_TILE_RANGE_FLAG_NULL;
+		UINT rangeTileCount = regionCount;
+
+		FlushResidencyMap(static_cast<ReservedResource*>(owner));
+		m_backend->UpdateTileMappings(
+			static_cast<ReservedResource*>(owner),
+			regionCount,
+			coords.data(),
+			regionSizes.data(),
+			nullptr,
+			1,
+			&rangeFlags,
 			nullptr,
-			IID_PPV_ARGS(&m_batchUploadBuffers[i])
+			&rangeTileCount
 		);
+	}
 
-		if (FAILED(hr)) {
-			LogError(std::format("Failed to create batch upload buffer {}: 0x{:08x}", i, hr));
-			return false;
+	std::vector<TileRange> ranges = CoalesceTileRanges(heapOffsets);
+	RetireTiles(ranges.data(), static_cast<UINT>(ranges.size()));
+	return static_cast<UINT>(heapOffsets.size());
+}
+
+std::shared_ptr<ResidencyManager> RenderingPlugin::GetResidencyManager() {
+	std::lock_guard<std::mutex> lock(m_residencyMutex);
+	return m_residencyManager;
+}
+
+UINT RenderingPlugin::AcquireRingSlot() {
+	SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::AcquireSlot);
+	SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::AcquireSlot, 0, 0);
+	UINT index = 0;
+	UINT64 waitValue = 0;
+	{
+		std::unique_lock<std::mutex> lock(m_ringMutex);
+		m_slotAvailable.wait(lock, [this] {
+			return std::find(std::begin(m_slotInUse), std::end(m_slotInUse), false)
+				!= std::end(m_slotInUse);
+		});
+
+		// The idle slot with the lowest fence value is the most likely to
+		// have retired already.
+		bool found = false;
+		for (UINT i = 0; i < ALLOCATOR_POOL_SIZE; ++i) {
+			if (m_slotInUse[i]) continue;
+			if (!found || m_allocatorFenceValues[i] < m_allocatorFenceValues[index]) {
+				index = i;
+				found = true;
+			}
 		}
+
+		m_slotInUse[index] = true;
+		waitValue = m_allocatorFenceValues[index];
 	}
 
-	return true;
+	// Wait without holding the ring lock so other producers keep staging
+	if (m_backend->GetCompletedFenceValue() < waitValue) {
+		{
+			SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::FenceWait, 0, waitValue);
+			m_backend->WaitForFence(waitValue);
+		}
+		SPARSE_TRACE_INSTANT(m_eventTracer, TraceEvent::FenceComplete, 0, waitValue);
+	}
+
+	m_backend->ResetAllocator(index);
+	return index;
+}
+
+void RenderingPlugin::ReleaseRingSlot(UINT slotIndex) {
+	{
+		std::lock_guard<std::mutex> lock(m_ringMutex);
+		m_slotInUse[slotIndex] = false;
+	}
+	m_slotAvailable.notify_one();
 }
 
 bool RenderingPlugin::ValidateTileBoxParams(
 	const ReservedResource* resource,
 	const TileBox& box,
-	const std::span<std::byte>& sourceData,
 	D3D12_RESOURCE_DESC* outResourceDesc,
 	ResourceTilingInfo* outResourceTilingInfo
 ) {
+	SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::Validate);
+	SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::Validate, resource ? resource->handle : 0, PackTraceTile(box.subResource, box.startX, box.startY, box.startZ));
 	if (!initialized.load(std::memory_order_acquire))
 	{
 		LogError("UploadDataToTileBox: plugin not initialized");
@@ -750,18 +1334,8 @@ bool RenderingPlugin::ValidateTileBoxParams(
 		return false;
 	}
 
-	UINT tileCount = box.TileCount();
-	UINT64 expectedSize = static_cast<UINT64>(tileCount) * UPLOAD_TILE_SIZE;
-	if (sourceData.size_bytes() != expectedSize)
-	{
-		LogError(std::format(
-			"UploadDataToTileBox: expected {} bytes for {} tiles, got {}",
-			expectedSize, tileCount, sourceData.size_bytes()));
-		return false;
-	}
-
 	// Validate box is within subresource tile grid
-	*outResourceDesc = resource->D3D12Resource->GetDesc();
+	*outResourceDesc = resource->GetDesc();
 	*outResourceTilingInfo = resource->GetTilingInfo();
 
 	if (box.subResource >= outResourceTilingInfo->SubresourceCount)
@@ -772,6 +1346,14 @@ bool RenderingPlugin::ValidateTileBoxParams(
 		return false;
 	}
 
+	if (outResourceTilingInfo->IsPackedMip(box.subResource))
+	{
+		LogError(std::format(
+			"UploadDataToTileBox: subResource {} is a packed mip; use UploadPackedMips",
+			box.subResource));
+		return false;
+	}
+
 	const SubresourceTilingInfo& subInfo =
 		outResourceTilingInfo->subresourceTilingInfo[box.subResource];
 
@@ -791,8 +1373,7 @@ bool RenderingPlugin::ValidateTileBoxParams(
 		return false;
 	}
 
-	UINT bytesPerPixel = GetBytesPerPixel(outResourceDesc->Format);
-	if (bytesPerPixel == 0)
+	if (!IsSupportedTileFormat(outResourceDesc->Format))
 	{
 		LogError("UploadDataToTileBox: unsupported texture format");
 		return false;
@@ -801,13 +1382,12 @@ bool RenderingPlugin::ValidateTileBoxParams(
 	return true;
 }
 
-void RenderingPlugin::RollbackTileBoxMapping(
+void RenderingPlugin::NullMapTileBox(
 	ReservedResource* resource,
-	const TileBox& box,
-	UINT heapOffsetInTiles,
-	UINT tileCount
+	const TileBox& box
 ) {
-	ID3D12CommandQueue* queue = s_D3D12->GetCommandQueue();
+	SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::Unmap);
+	SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::Unmap, resource->handle, PackTraceTile(box.subResource, box.startX, box.startY, box.startZ));
 
 	D3D12_TILED_RESOURCE_COORDINATE startCoord = {};
 	startCoord.X = box.startX;
@@ -816,7 +1396,7 @@ void RenderingPlugin::RollbackTileBoxMapping(
 	startCoord.Subresource = box.subResource;
 
 	D3D12_TILE_REGION_SIZE regionSize = {};
-	regionSize.NumTiles = tileCount;
+	regionSize.NumTiles = box.TileCount();
 	regionSize.UseBox = TRUE;
 	regionSize.Width = box.width;
 	regionSize.Height = box.height;
@@ -824,220 +1404,3402 @@ void RenderingPlugin::RollbackTileBoxMapping(
 
 	D3D12_TILE_RANGE_FLAGS nullFlags = D3D12_TILE_RANGE_FLAG_NULL;
 
-	queue->UpdateTileMappings(
-		resource->D3D12Resource.Get(),
+	FlushResidencyMap(resource);
+	m_backend->UpdateTileMappings(
+		resource,
 		1, &startCoord, &regionSize,
 		nullptr,
 		1, &nullFlags,
-		nullptr, nullptr,
-		D3D12_TILE_MAPPING_FLAG_NONE
+		nullptr, nullptr
 	);
+}
 
-	// Unregister all tiles in the box
-	for (UINT z = box.startZ; z < box.startZ + box.depth; ++z)
-		for (UINT y = box.startY; y < box.startY + box.height; ++y)
-			for (UINT x = box.startX; x < box.startX + box.width; ++x)
-				resource->UnregisterMappedTile(box.subResource, x, y, z);
+std::vector<TileRange> RenderingPlugin::CoalesceTileRanges(std::vector<UINT>& heapOffsets)
+{
+	std::vector<TileRange> ranges;
+	std::sort(heapOffsets.begin(), heapOffsets.end());
 
-	// Return heap space
-	g_tileHeap->FreeTiles(heapOffsetInTiles, tileCount);
+	for (UINT offset : heapOffsets) {
+		if (!ranges.empty() && ranges.back().offsetInTiles + ranges.back().numTiles == offset) {
+			ranges.back().numTiles++;
+		}
+		else {
+			ranges.push_back({ offset, 1 });
+		}
+	}
+	return ranges;
 }
 
-bool RenderingPlugin::UploadDataToTileBox(
+void RenderingPlugin::UnmapTileBoxLocked(
 	ReservedResource* resource,
-	const TileBox& box,
-	const std::span<std::byte>& sourceData
+	const TileBox& box
+) {
+	std::vector<UINT> heapOffsets;
+	resource->UnregisterMappedTileBox(
+		box.subResource,
+		box.startX, box.startY, box.startZ,
+		box.width, box.height, box.depth,
+		heapOffsets);
+
+	if (heapOffsets.empty()) {
+		return;
+	}
+
+	// NULL-mapping the unmapped holes in the box is harmless and keeps this
+	// to a single UpdateTileMappings call
+	NullMapTileBox(resource, box);
+
+	std::vector<TileRange> ranges = CoalesceTileRanges(heapOffsets);
+	RetireTiles(ranges.data(), static_cast<UINT>(ranges.size()));
+}
+
+bool RenderingPlugin::UnmapTileBox(
+	ReservedResource* resource,
+	const TileBox& box
 ) {
 	if (!initialized.load(std::memory_order_acquire)) {
-		LogError("UploadDataToTileBox: plugin not initialized");
+		LogError("UnmapTileBox: plugin not initialized");
 		return false;
 	}
 	try {
-		std::lock_guard<std::mutex> lock(m_mutex);
-		// Validation
-		D3D12_RESOURCE_DESC desc;
-		ResourceTilingInfo tilingInfo;
-		if (!ValidateTileBoxParams(resource, box, sourceData, &desc, &tilingInfo))
+		if (!resource) {
+			LogError("UnmapTileBox: null resource");
 			return false;
+		}
+		if (box.width == 0 || box.height == 0 || box.depth == 0) {
+			LogError("UnmapTileBox: zero-dimension box");
+			return false;
+		}
 
-		UINT tileCount = box.TileCount();
-
-		// Pre-check for pre-existing mappings
-		for (UINT z = box.startZ; z < box.startZ + box.depth; ++z)
-			for (UINT y = box.startY; y < box.startY + box.height; ++y)
-				for (UINT x = box.startX; x < box.startX + box.width; ++x)
-					if (resource->IsTileMapped(box.subResource, x, y, z))
-					{
-						LogError(std::format(
-							"UploadDataToTileBox: tile ({},{},{}) already mapped",
-							x, y, z));
-						return false;
-					}
-
-		// Pre-check capacity
-		if (!g_tileHeap->CanAllocate(tileCount))
-		{
+		const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+		if (box.subResource >= tilingInfo.SubresourceCount) {
 			LogError(std::format(
-				"UploadDataToTileBox: heap cannot allocate {} tiles "
-				"(free: {}, used: {})",
-				tileCount, g_tileHeap->GetFreeTiles(), g_tileHeap->GetUsedTiles()));
+				"UnmapTileBox: subResource {} out of range (max {})",
+				box.subResource, tilingInfo.SubresourceCount - 1));
 			return false;
 		}
 
-		// Allocate contiguous heap space for the entire box
-		TileAllocation alloc = g_tileHeap->AllocateTiles(tileCount);
-		if (!alloc.success)
+		const SubresourceTilingInfo& subInfo = tilingInfo.subresourceTilingInfo[box.subResource];
+		if (box.startX + box.width > subInfo.WidthInTiles ||
+			box.startY + box.height > subInfo.HeightInTiles ||
+			box.startZ + box.depth > subInfo.DepthInTiles)
 		{
-			LogError("UploadDataToTileBox: AllocateTiles failed");
+			LogError("UnmapTileBox: box exceeds subresource bounds");
 			return false;
 		}
 
-		// Map the box region with one UpdateTileMappings call
-		{
-			ID3D12CommandQueue* queue = s_D3D12->GetCommandQueue();
+		std::lock_guard<std::mutex> lock(m_mappingMutex);
+		if (RejectSetMember("UnmapTileBox", resource)) {
+			return false;
+		}
+		UnmapTileBoxLocked(resource, box);
+		return true;
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::UnmapSubresource(
+	ReservedResource* resource,
+	UINT subResource
+) {
+	if (!initialized.load(std::memory_order_acquire)) {
+		LogError("UnmapSubresource: plugin not initialized");
+		return false;
+	}
+	try {
+		if (!resource) {
+			LogError("UnmapSubresource: null resource");
+			return false;
+		}
 
-			D3D12_TILED_RESOURCE_COORDINATE startCoord = {};
-			startCoord.X = box.startX;
-			startCoord.Y = box.startY;
-			startCoord.Z = box.startZ;
-			startCoord.Subresource = box.subResource;
+		const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+		if (subResource >= tilingInfo.SubresourceCount) {
+			LogError(std::format(
+				"UnmapSubresource: subResource {} out of range (max {})",
+				subResource, tilingInfo.SubresourceCount - 1));
+			return false;
+		}
 
-			D3D12_TILE_REGION_SIZE regionSize = {};
-			regionSize.NumTiles = tileCount;
-			regionSize.UseBox = TRUE;
-			regionSize.Width = box.width;
-			regionSize.Height = box.height;
-			regionSize.Depth = box.depth;
+		const SubresourceTilingInfo& subInfo = tilingInfo.subresourceTilingInfo[subResource];
 
-			D3D12_TILE_RANGE_FLAGS rangeFlags = D3D12_TILE_RANGE_FLAG_NONE;
+		std::lock_guard<std::mutex> lock(m_mappingMutex);
 
-			queue->UpdateTileMappings(
-				resource->D3D12Resource.Get(),
-				1, &startCoord, &regionSize,
-				g_tileHeap->GetD3D12Heap(),
-				1, &rangeFlags,
-				&alloc.heapOffsetInTiles,
-				&tileCount,
-				D3D12_TILE_MAPPING_FLAG_NONE
-			);
+		if (tilingInfo.IsPackedMip(subResource)) {
+			UnmapPackedMipTailLocked(resource);
+			return true;
+		}
+		if (RejectSetMember("UnmapSubresource", resource)) {
+			return false;
 		}
 
-		// Register all tiles with sequential heap offsets
+		std::vector<UINT> heapOffsets;
+		resource->UnregisterSubresourceTiles(subResource, heapOffsets);
+		if (heapOffsets.empty()) {
+			return true;
+		}
+
+		TileBox wholeSubresource = {};
+		wholeSubresource.subResource = subResource;
+		wholeSubresource.width = subInfo.WidthInTiles;
+		wholeSubresource.height = subInfo.HeightInTiles;
+		wholeSubresource.depth = subInfo.DepthInTiles;
+		NullMapTileBox(resource, wholeSubresource);
+
+		std::vector<TileRange> ranges = CoalesceTileRanges(heapOffsets);
+		RetireTiles(ranges.data(), static_cast<UINT>(ranges.size()));
+		return true;
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+TileMapping RenderingPlugin::AllocateAndMapPackedMipTail(ReservedResource* resource)
+{
+	const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+	UINT tileCount = tilingInfo.NumTilesForPackedMips;
+
+	TileMapping mapping = { 0, false };
+	TileAllocation alloc = g_tileHeap->AllocateTiles(tileCount);
+	if (!alloc.success && ReleaseRetiredTiles() > 0) {
+		alloc = g_tileHeap->AllocateTiles(tileCount);
+	}
+	if (!alloc.success) {
+		LogError(std::format("AllocateAndMapPackedMipTail: heap cannot allocate {} tiles", tileCount));
+		SPARSE_TRACE_INSTANT(m_eventTracer, TraceEvent::AllocationFailure, resource->handle, tileCount);
+		return mapping;
+	}
+
+	// Packed tiles are addressed by index along X of the first packed mip
+	D3D12_TILED_RESOURCE_COORDINATE startCoord = {};
+	startCoord.Subresource = tilingInfo.NumStandardMips;
+
+	D3D12_TILE_REGION_SIZE regionSize = {};
+	regionSize.NumTiles = tileCount;
+	regionSize.UseBox = FALSE;
+
+	D3D12_TILE_RANGE_FLAGS rangeFlags = D3D12_TILE_RANGE_FLAG_NONE;
+
+	{
+		SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::MapTiles);
+		SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::MapTiles, resource->handle, PackTraceTile(tilingInfo.NumStandardMips, 0, 0, 0));
+		m_backend->UpdateTileMappings(
+			resource,
+			1, &startCoord, &regionSize,
+			g_tileHeap.get(),
+			1, &rangeFlags,
+			&alloc.heapOffsetInTiles,
+			&tileCount
+		);
+	}
+	SPARSE_STATS_ADD(m_pipelineStats, PipelineCounter::TilesMapped, tileCount);
+
+	for (UINT i = 0; i < tileCount; ++i) {
+		resource->RegisterMappedTile(tilingInfo.NumStandardMips, i, 0, 0, alloc.heapOffsetInTiles + i);
+	}
+
+	mapping.heapOffset = alloc.heapOffsetInTiles;
+	mapping.success = true;
+	return mapping;
+}
+
+void RenderingPlugin::UnmapPackedMipTailLocked(ReservedResource* resource)
+{
+	const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+	if (tilingInfo.NumPackedMips == 0) {
+		return;
+	}
+
+	std::vector<UINT> heapOffsets;
+	resource->UnregisterSubresourceTiles(tilingInfo.NumStandardMips, heapOffsets);
+	if (heapOffsets.empty()) {
+		return;
+	}
+
+	D3D12_TILED_RESOURCE_COORDINATE startCoord = {};
+	startCoord.Subresource = tilingInfo.NumStandardMips;
+
+	D3D12_TILE_REGION_SIZE regionSize = {};
+	regionSize.NumTiles = tilingInfo.NumTilesForPackedMips;
+	regionSize.UseBox = FALSE;
+
+	D3D12_TILE_RANGE_FLAGS nullFlags = D3D12_TILE_RANGE_FLAG_NULL;
+
+	{
+		SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::Unmap);
+		SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::Unmap, resource->handle, PackTraceTile(tilingInfo.NumStandardMips, 0, 0, 0));
+		FlushResidencyMap(resource);
+		m_backend->UpdateTileMappings(
+			resource,
+			1, &startCoord, &regionSize,
+			nullptr,
+			1, &nullFlags,
+			nullptr, nullptr
+		);
+	}
+
+	std::vector<TileRange> ranges = CoalesceTileRanges(heapOffsets);
+	RetireTiles(ranges.data(), static_cast<UINT>(ranges.size()));
+}
+
+UINT64 RenderingPlugin::CalculatePackedMipDataSize(const ReservedResource* resource)
+{
+	const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+	const UINT bytesPerBlock = GetBytesPerBlock(resource->textureFormat);
+	const UINT bytesPerPixel = GetBytesPerPixel(resource->textureFormat);
+
+	UINT64 totalSize = 0;
+	for (UINT mip = tilingInfo.NumStandardMips; mip < tilingInfo.SubresourceCount; ++mip) {
+		UINT64 mipWidth = (std::max)(1u, resource->width >> mip);
+		UINT64 mipHeight = (std::max)(1u, resource->height >> mip);
+		UINT64 mipDepth = (std::max)(1u, resource->depth >> mip);
+		if (bytesPerBlock != 0) {
+			// Mips smaller than a block still occupy a whole one
+			totalSize += ((mipWidth + 3) / 4) * ((mipHeight + 3) / 4) * mipDepth * bytesPerBlock;
+		}
+		else {
+			totalSize += mipWidth * mipHeight * mipDepth * bytesPerPixel;
+		}
+	}
+	return totalSize;
+}
+
+bool RenderingPlugin::UploadPackedMips(
+	ReservedResource* resource,
+	const std::span<std::byte>& sourceData
+) {
+	if (!initialized.load(std::memory_order_acquire)) {
+		LogError("UploadPackedMips: plugin not initialized");
+		return false;
+	}
+	try {
+		if (!resource) {
+			LogError("UploadPackedMips: null resource");
+			return false;
+		}
+
+		const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+		if (tilingInfo.NumPackedMips == 0) {
+			LogError("UploadPackedMips: resource has no packed mips");
+			return false;
+		}
+
+		if (!IsSupportedTileFormat(resource->textureFormat)) {
+			LogError("UploadPackedMips: unsupported texture format");
+			return false;
+		}
+
+		UINT64 expectedSize = CalculatePackedMipDataSize(resource);
+		if (sourceData.size_bytes() != expectedSize) {
+			LogError(std::format(
+				"UploadPackedMips: expected {} bytes for {} packed mips, got {}",
+				expectedSize, tilingInfo.NumPackedMips, sourceData.size_bytes()));
+			return false;
+		}
+
+		// Row pitches in the staging buffer must follow the copyable footprints
+		const D3D12_RESOURCE_DESC& desc = resource->GetDesc();
+		std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(tilingInfo.NumPackedMips);
+		std::vector<UINT> rowCounts(tilingInfo.NumPackedMips);
+		std::vector<UINT64> rowSizes(tilingInfo.NumPackedMips);
+		UINT64 stagingSize = 0;
+		m_backend->GetCopyableFootprints(
+			desc,
+			tilingInfo.NumStandardMips, tilingInfo.NumPackedMips,
+			footprints.data(), rowCounts.data(), rowSizes.data(),
+			&stagingSize);
+
+		if (stagingSize > BATCH_UPLOAD_BYTE_SIZE) {
+			LogError(std::format(
+				"UploadPackedMips: packed mips need {} staging bytes (max {})",
+				stagingSize, BATCH_UPLOAD_BYTE_SIZE));
+			return false;
+		}
+
+		if (!resource->IsPackedMipTailMapped()) {
+			PrepareHeapSpace(tilingInfo.NumTilesForPackedMips);
+		}
+
+		TileMapping mapping;
+		bool tailAlreadyMapped;
+		{
+			std::lock_guard<std::mutex> lock(m_mappingMutex);
+			tailAlreadyMapped = resource->IsPackedMipTailMapped();
+			mapping = tailAlreadyMapped
+				? TileMapping{ 0, true }
+				: AllocateAndMapPackedMipTail(resource);
+		}
+
+		if (!mapping.success) {
+			return false;
+		}
+
+		// The tail is mapped by now, so a throw while staging unmaps it like
+		// a failed submit
+		bool submitted = false;
+		try {
+			RingSlotLease slot(*this);
+			std::byte* staging = m_batchUploadBufferData[slot.Index()];
+			const std::byte* source = sourceData.data();
+
+			SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::StageFill);
+			SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::StageFill, resource->handle, PackTraceTile(tilingInfo.NumStandardMips, 0, 0, 0));
+			for (UINT i = 0; i < tilingInfo.NumPackedMips; ++i) {
+				const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = footprints[i];
+				const size_t rowSize = static_cast<size_t>(rowSizes[i]);
+				for (UINT slice = 0; slice < footprint.Footprint.Depth; ++slice) {
+					for (UINT row = 0; row < rowCounts[i]; ++row) {
+						std::byte* destination = staging + footprint.Offset
+							+ (static_cast<UINT64>(slice) * rowCounts[i] + row) * footprint.Footprint.RowPitch;
+						memcpy(destination, source, rowSize);
+						source += rowSize;
+					}
+				}
+			}
+
+			UploadSubmission submission = {};
+			submission.resource = resource;
+			submission.sourceBuffer = StagingBuffer::Batch;
+			submission.sourceOffset = 0;
+			submission.slotIndex = slot.Index();
+			submission.footprints = footprints.data();
+			submission.firstSubresource = tilingInfo.NumStandardMips;
+			submission.footprintCount = tilingInfo.NumPackedMips;
+
+			slot.HandOff();
+			submitted = SubmitUpload(submission);
+		}
+		catch (const std::exception& ex) {
+			LogError(ex.what());
+		}
+		if (!submitted) {
+			if (!tailAlreadyMapped) {
+				std::lock_guard<std::mutex> lock(m_mappingMutex);
+				UnmapPackedMipTailLocked(resource);
+			}
+			return false;
+		}
+
+		return true;
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::UnmapPackedMips(ReservedResource* resource)
+{
+	if (!initialized.load(std::memory_order_acquire)) {
+		LogError("UnmapPackedMips: plugin not initialized");
+		return false;
+	}
+	try {
+		if (!resource) {
+			LogError("UnmapPackedMips: null resource");
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mappingMutex);
+		UnmapPackedMipTailLocked(resource);
+		return true;
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+void RenderingPlugin::RollbackTileBoxMapping(
+	ReservedResource* resource,
+	const TileBox& box,
+	UINT heapOffsetInTiles,
+	UINT tileCount
+) {
+	// Only retire what is still registered: eviction may already have
+	// unmapped and retired part of the box
+	std::vector<UINT> heapOffsets;
+	resource->UnregisterMappedTileBox(
+		box.subResource,
+		box.startX, box.startY, box.startZ,
+		box.width, box.height, box.depth,
+		heapOffsets);
+
+	NullMapTileBox(resource, box);
+
+	// Earlier slabs may still be copying into these tiles
+	if (heapOffsets.size() == tileCount) {
+		TileRange freed = { heapOffsetInTiles, tileCount };
+		RetireTiles(&freed, 1);
+	}
+	else {
+		std::vector<TileRange> ranges = CoalesceTileRanges(heapOffsets);
+		RetireTiles(ranges.data(), static_cast<UINT>(ranges.size()));
+	}
+}
+
+std::vector<TileBox> RenderingPlugin::SplitIntoSlabs(const TileBox& box, UINT maxTiles)
+{
+	std::vector<TileBox> slabs;
+	const UINT planeTiles = box.width * box.height;
+
+	if (box.TileCount() <= maxTiles) {
+		slabs.push_back(box);
+	}
+	else if (planeTiles <= maxTiles) {
+		// Whole z-planes per slab
+		const UINT planesPerSlab = maxTiles / planeTiles;
+		for (UINT z = 0; z < box.depth; z += planesPerSlab) {
+			TileBox slab = box;
+			slab.startZ = box.startZ + z;
+			slab.depth = (std::min)(planesPerSlab, box.depth - z);
+			slabs.push_back(slab);
+		}
+	}
+	else if (box.width <= maxTiles) {
+		// Whole rows of a single plane per slab
+		const UINT rowsPerSlab = maxTiles / box.width;
+		for (UINT z = 0; z < box.depth; ++z) {
+			for (UINT y = 0; y < box.height; y += rowsPerSlab) {
+				TileBox slab = box;
+				slab.startY = box.startY + y;
+				slab.startZ = box.startZ + z;
+				slab.height = (std::min)(rowsPerSlab, box.height - y);
+				slab.depth = 1;
+				slabs.push_back(slab);
+			}
+		}
+	}
+	else {
+		// Row segments
+		for (UINT z = 0; z < box.depth; ++z) {
+			for (UINT y = 0; y < box.height; ++y) {
+				for (UINT x = 0; x < box.width; x += maxTiles) {
+					TileBox slab = box;
+					slab.startX = box.startX + x;
+					slab.startY = box.startY + y;
+					slab.startZ = box.startZ + z;
+					slab.width = (std::min)(maxTiles, box.width - x);
+					slab.height = 1;
+					slab.depth = 1;
+					slabs.push_back(slab);
+				}
+			}
+		}
+	}
+
+	return slabs;
+}
+
+bool RenderingPlugin::StageAndSubmitTileBox(
+	ReservedResource* resource,
+	const TileBox& box,
+	const StagingFill& fill,
+	UINT64* outCompletionFence
+) {
+	UINT firstTile = 0;
+	UINT64 completionFence = 0;
+
+	for (const TileBox& slab : SplitIntoSlabs(box, BATCH_UPLOAD_TILE_COUNT)) {
+		const UINT slabTiles = slab.TileCount();
+
+		// Slots only wait on fences from earlier slabs, so the GPU keeps
+		// copying while this thread stages the next one.
+		RingSlotLease slot(*this);
+		{
+			SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::StageFill);
+			SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::StageFill, resource->handle, PackTraceTile(slab.subResource, slab.startX, slab.startY, slab.startZ));
+			fill(m_batchUploadBufferData[slot.Index()], firstTile, slabTiles);
+		}
+
+		UploadSubmission submission = {};
+		submission.resource = resource;
+		submission.startCoord.X = slab.startX;
+		submission.startCoord.Y = slab.startY;
+		submission.startCoord.Z = slab.startZ;
+		submission.startCoord.Subresource = slab.subResource;
+		submission.regionSize.NumTiles = slabTiles;
+		submission.regionSize.UseBox = TRUE;
+		submission.regionSize.Width = slab.width;
+		submission.regionSize.Height = slab.height;
+		submission.regionSize.Depth = slab.depth;
+		submission.sourceBuffer = StagingBuffer::Batch;
+		submission.sourceOffset = 0;
+		submission.slotIndex = slot.Index();
+
+		slot.HandOff();
+		if (!SubmitUpload(submission)) {
+			return false;
+		}
+
+		// The queue retires work in order, so the last slab's fence covers the box
+		completionFence = submission.fenceValue;
+		firstTile += slabTiles;
+	}
+
+	if (outCompletionFence) {
+		*outCompletionFence = completionFence;
+	}
+	return true;
+}
+
+bool RenderingPlugin::UploadDataToTileBox(
+	ReservedResource* resource,
+	const TileBox& box,
+	const std::span<std::byte>& sourceData,
+	UINT64* outCompletionFence
+) {
+	if (!initialized.load(std::memory_order_acquire)) {
+		LogError("UploadDataToTileBox: plugin not initialized");
+		return false;
+	}
+	try {
+		if (!ValidateSourceSize("UploadDataToTileBox", resource, sourceData.size_bytes(), box.TileCount(), 0))
+			return false;
+
+		if (!UploadTileBoxWithFill(resource, box, MakeLinearStagingFill(resource, sourceData.data()), outCompletionFence))
+			return false;
+
+		return UploadTileBoxMips(resource, box, sourceData.data(), outCompletionFence);
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::UploadTileBoxMips(
+	ReservedResource* resource,
+	const TileBox& box,
+	const std::byte* sourceData,
+	UINT64* outCompletionFence
+) {
+	std::shared_ptr<MipChainBuilder> builder = resource->GetMipChainBuilder();
+	if (!builder)
+		return true;
+
+	// Feed the box to the mip chain in the same x-fastest order as the source
+	std::vector<GeneratedMipTile> generated;
+	const std::byte* tileData = sourceData;
+	for (UINT z = box.startZ; z < box.startZ + box.depth; ++z)
+		for (UINT y = box.startY; y < box.startY + box.height; ++y)
+			for (UINT x = box.startX; x < box.startX + box.width; ++x)
+			{
+				builder->AddTile(box.subResource, x, y, z, tileData, generated);
+				tileData += UPLOAD_TILE_SIZE;
+			}
+
+	return UploadGeneratedMips(resource, generated, outCompletionFence);
+}
+
+bool RenderingPlugin::UploadDataToTileBoxes(
+	const std::span<const TileBoxUpload>& uploads,
+	UINT64* outCompletionFence
+) {
+	if (!initialized.load(std::memory_order_acquire)) {
+		LogError("UploadDataToTileBoxes: plugin not initialized");
+		return false;
+	}
+	try {
+		if (uploads.empty())
+		{
+			LogError("UploadDataToTileBoxes: no uploads");
+			return false;
+		}
+
+		UINT totalTiles = 0;
+		for (const TileBoxUpload& upload : uploads)
+		{
+			D3D12_RESOURCE_DESC desc;
+			ResourceTilingInfo tilingInfo;
+			if (!ValidateTileBoxParams(upload.resource, upload.box, &desc, &tilingInfo))
+				return false;
+			if (!ValidateSourceSize("UploadDataToTileBoxes", upload.resource, upload.sourceData.size_bytes(), upload.box.TileCount(), 0))
+				return false;
+			totalTiles += upload.box.TileCount();
+		}
+		PrepareHeapSpace(totalTiles);
+
+		std::vector<UINT> heapOffsets;
+		{
+			std::lock_guard<std::mutex> lock(m_mappingMutex);
+			for (const TileBoxUpload& upload : uploads)
+			{
+				if (RejectSetMember("UploadDataToTileBoxes", upload.resource))
+					return false;
+			}
+			if (!MapTileBoxesLocked(uploads, heapOffsets))
+				return false;
+		}
+
+		// A throw leaves the boxes mapped, so it rolls back like a failure
+		bool staged = false;
+		try {
+			staged = StageAndSubmitTileBoxes(uploads, outCompletionFence);
+		}
+		catch (const std::exception& ex) {
+			LogError(ex.what());
+		}
+		if (!staged)
+		{
+			std::lock_guard<std::mutex> lock(m_mappingMutex);
+			for (size_t i = 0; i < uploads.size(); ++i)
+			{
+				RollbackTileBoxMapping(
+					uploads[i].resource, uploads[i].box, heapOffsets[i], uploads[i].box.TileCount());
+			}
+			return false;
+		}
+
+		bool success = true;
+		for (const TileBoxUpload& upload : uploads)
+		{
+			success &= UploadTileBoxMips(upload.resource, upload.box, upload.sourceData.data(), outCompletionFence);
+		}
+		return success;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::MapTileBoxesLocked(
+	const std::span<const TileBoxUpload>& uploads,
+	std::vector<UINT>& outHeapOffsets
+) {
+	auto overlaps = [](const TileBox& a, const TileBox& b) {
+		return a.subResource == b.subResource &&
+			a.startX < b.startX + b.width && b.startX < a.startX + a.width &&
+			a.startY < b.startY + b.height && b.startY < a.startY + a.height &&
+			a.startZ < b.startZ + b.depth && b.startZ < a.startZ + a.depth;
+	};
+
+	// Pre-check for pre-existing mappings and boxes that collide with an
+	// earlier box of the same upload
+	UINT totalTiles = 0;
+	for (size_t i = 0; i < uploads.size(); ++i)
+	{
+		const TileBoxUpload& upload = uploads[i];
+		const TileBox& box = upload.box;
+		for (UINT z = box.startZ; z < box.startZ + box.depth; ++z)
+			for (UINT y = box.startY; y < box.startY + box.height; ++y)
+				for (UINT x = box.startX; x < box.startX + box.width; ++x)
+					if (upload.resource->IsTileMapped(box.subResource, x, y, z))
+					{
+						LogError(std::format(
+							"UploadDataToTileBoxes: box {} tile ({},{},{}) already mapped",
+							i, x, y, z));
+						return false;
+					}
+
+		for (size_t j = 0; j < i; ++j)
+		{
+			if (uploads[j].resource == upload.resource && overlaps(uploads[j].box, box))
+			{
+				LogError(std::format("UploadDataToTileBoxes: boxes {} and {} overlap", j, i));
+				return false;
+			}
+		}
+		totalTiles += box.TileCount();
+	}
+
+	// Pre-check capacity, reclaiming retired tiles if needed
+	if (!g_tileHeap->CanAllocate(totalTiles))
+	{
+		ReleaseRetiredTiles();
+	}
+	if (!g_tileHeap->CanAllocate(totalTiles))
+	{
+		LogError(std::format(
+			"UploadDataToTileBoxes: heap cannot allocate {} tiles "
+			"(free: {}, used: {})",
+			totalTiles, g_tileHeap->GetFreeTiles(), g_tileHeap->GetUsedTiles()));
+		SPARSE_TRACE_INSTANT(m_eventTracer, TraceEvent::AllocationFailure, uploads[0].resource->handle, totalTiles);
+		return false;
+	}
+
+	// One reservation for every box, carved up in upload order
+	TileAllocation alloc = g_tileHeap->AllocateTiles(totalTiles);
+	if (!alloc.success)
+	{
+		LogError("UploadDataToTileBoxes: AllocateTiles failed");
+		return false;
+	}
+
+	outHeapOffsets.resize(uploads.size());
+	UINT nextOffset = alloc.heapOffsetInTiles;
+	for (size_t i = 0; i < uploads.size(); ++i)
+	{
+		outHeapOffsets[i] = nextOffset;
+		nextOffset += uploads[i].box.TileCount();
+	}
+
+	// One UpdateTileMappings per resource, with a region and a heap range
+	// per box
+	{
+		SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::MapTiles);
+		SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::MapTiles, uploads[0].resource->handle, uploads.size());
+
+		std::vector<bool> mapped(uploads.size(), false);
+		std::vector<D3D12_TILED_RESOURCE_COORDINATE> startCoords;
+		std::vector<D3D12_TILE_REGION_SIZE> regionSizes;
+		std::vector<D3D12_TILE_RANGE_FLAGS> rangeFlags;
+		std::vector<UINT> rangeOffsets;
+		std::vector<UINT> rangeTileCounts;
+		for (size_t i = 0; i < uploads.size(); ++i)
+		{
+			if (mapped[i])
+				continue;
+
+			startCoords.clear();
+			regionSizes.clear();
+			rangeOffsets.clear();
+			rangeTileCounts.clear();
+			for (size_t j = i; j < uploads.size(); ++j)
+			{
+				if (uploads[j].resource != uploads[i].resource)
+					continue;
+				mapped[j] = true;
+
+				const TileBox& box = uploads[j].box;
+				D3D12_TILED_RESOURCE_COORDINATE startCoord = {};
+				startCoord.X = box.startX;
+				startCoord.Y = box.startY;
+				startCoord.Z = box.startZ;
+				startCoord.Subresource = box.subResource;
+				startCoords.push_back(startCoord);
+
+				D3D12_TILE_REGION_SIZE regionSize = {};
+				regionSize.NumTiles = box.TileCount();
+				regionSize.UseBox = TRUE;
+				regionSize.Width = box.width;
+				regionSize.Height = box.height;
+				regionSize.Depth = box.depth;
+				regionSizes.push_back(regionSize);
+
+				rangeOffsets.push_back(outHeapOffsets[j]);
+				rangeTileCounts.push_back(box.TileCount());
+			}
+			rangeFlags.assign(startCoords.size(), D3D12_TILE_RANGE_FLAG_NONE);
+
+			const UINT regionCount = static_cast<UINT>(startCoords.size());
+			m_backend->UpdateTileMappings(
+				uploads[i].resource,
+				regionCount, startCoords.data(), regionSizes.data(),
+				g_tileHeap.get(),
+				regionCount, rangeFlags.data(),
+				rangeOffsets.data(),
+				rangeTileCounts.data()
+			);
+		}
+	}
+	SPARSE_STATS_ADD(m_pipelineStats, PipelineCounter::TilesMapped, totalTiles);
+
+	// Register all tiles with sequential heap offsets
+	for (size_t i = 0; i < uploads.size(); ++i)
+	{
+		const TileBox& box = uploads[i].box;
+		UINT heapOffset = outHeapOffsets[i];
+		for (UINT z = box.startZ; z < box.startZ + box.depth; ++z)
+			for (UINT y = box.startY; y < box.startY + box.height; ++y)
+				for (UINT x = box.startX; x < box.startX + box.width; ++x)
+					uploads[i].resource->RegisterMappedTile(
+						box.subResource, x, y, z, heapOffset++);
+	}
+	return true;
+}
+
+bool RenderingPlugin::UploadVolumeSetTileBox(
+	VolumeSet* set,
+	const TileBox& box,
+	std::span<const std::span<std::byte>> memberData,
+	UINT64* outCompletionFence
+) {
+	if (!initialized.load(std::memory_order_acquire)) {
+		LogError("UploadVolumeSetTileBox: plugin not initialized");
+		return false;
+	}
+	try {
+		if (!set)
+		{
+			LogError("UploadVolumeSetTileBox: null set");
+			return false;
+		}
+
+		const std::vector<ReservedResource*>& members = set->GetMembers();
+		if (memberData.size() != members.size())
+		{
+			LogError(std::format(
+				"UploadVolumeSetTileBox: {} payloads for {} members",
+				memberData.size(), members.size()));
+			return false;
+		}
+
+		std::vector<TileBoxUpload> uploads;
+		for (size_t i = 0; i < members.size(); ++i)
+		{
+			D3D12_RESOURCE_DESC desc;
+			ResourceTilingInfo tilingInfo;
+			if (!ValidateTileBoxParams(members[i], box, &desc, &tilingInfo))
+				return false;
+			if (!ValidateSourceSize("UploadVolumeSetTileBox", members[i], memberData[i].size_bytes(), box.TileCount(), 0))
+				return false;
+			uploads.push_back({ members[i], box, memberData[i] });
+		}
+		PrepareHeapSpace(box.TileCount() * static_cast<UINT>(members.size()));
+
+		{
+			std::lock_guard<std::mutex> lock(m_mappingMutex);
+			if (RejectDestroyedSet("UploadVolumeSetTileBox", set))
+				return false;
+			if (!MapVolumeSetBoxLocked(*set, box))
+				return false;
+		}
+
+		// A throw leaves the boxes mapped, so it rolls back like a failure
+		bool staged = false;
+		try {
+			staged = StageAndSubmitTileBoxes(uploads, outCompletionFence);
+		}
+		catch (const std::exception& ex) {
+			LogError(ex.what());
+		}
+		if (!staged)
+		{
+			std::lock_guard<std::mutex> lock(m_mappingMutex);
+			UnmapVolumeSetBoxLocked(*set, box);
+			return false;
+		}
+		return true;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::UnmapVolumeSetTileBox(
+	VolumeSet* set,
+	const TileBox& box
+) {
+	if (!initialized.load(std::memory_order_acquire)) {
+		LogError("UnmapVolumeSetTileBox: plugin not initialized");
+		return false;
+	}
+	try {
+		if (!set) {
+			LogError("UnmapVolumeSetTileBox: null set");
+			return false;
+		}
+
+		// Members share the primary's tile grid
+		D3D12_RESOURCE_DESC desc;
+		ResourceTilingInfo tilingInfo;
+		if (!ValidateTileBoxParams(set->GetPrimary(), box, &desc, &tilingInfo)) {
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mappingMutex);
+		if (RejectDestroyedSet("UnmapVolumeSetTileBox", set)) {
+			return false;
+		}
+		UnmapVolumeSetBoxLocked(*set, box);
+		return true;
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::MapVolumeSetBoxLocked(VolumeSet& set, const TileBox& box)
+{
+	const std::vector<ReservedResource*>& members = set.GetMembers();
+	const UINT memberCount = set.MemberCount();
+
+	for (UINT z = box.startZ; z < box.startZ + box.depth; ++z)
+		for (UINT y = box.startY; y < box.startY + box.height; ++y)
+			for (UINT x = box.startX; x < box.startX + box.width; ++x)
+				if (set.IsMapped(box.subResource, x, y, z))
+				{
+					LogError(std::format(
+						"UploadVolumeSetTileBox: tile ({},{},{}) already mapped",
+						x, y, z));
+					return false;
+				}
+
+	// Pre-check capacity, reclaiming retired tiles if needed
+	const UINT tileCount = box.TileCount() * memberCount;
+	if (!g_tileHeap->CanAllocate(tileCount))
+	{
+		ReleaseRetiredTiles();
+	}
+	if (!g_tileHeap->CanAllocate(tileCount))
+	{
+		LogError(std::format(
+			"UploadVolumeSetTileBox: heap cannot allocate {} tiles "
+			"(free: {}, used: {})",
+			tileCount, g_tileHeap->GetFreeTiles(), g_tileHeap->GetUsedTiles()));
+		SPARSE_TRACE_INSTANT(m_eventTracer, TraceEvent::AllocationFailure, set.GetPrimary()->handle, tileCount);
+		return false;
+	}
+
+	// Coordinate-major: each coordinate's run holds one tile per member, so
+	// unmapping or evicting a coordinate frees one contiguous range
+	TileAllocation alloc = g_tileHeap->AllocateTiles(tileCount);
+	if (!alloc.success)
+	{
+		LogError("UploadVolumeSetTileBox: AllocateTiles failed");
+		return false;
+	}
+
+	{
+		SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::MapTiles);
+		SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::MapTiles, set.GetPrimary()->handle, PackTraceTile(box.subResource, box.startX, box.startY, box.startZ));
+
+		D3D12_TILED_RESOURCE_COORDINATE startCoord = {};
+		startCoord.X = box.startX;
+		startCoord.Y = box.startY;
+		startCoord.Z = box.startZ;
+		startCoord.Subresource = box.subResource;
+
+		D3D12_TILE_REGION_SIZE regionSize = {};
+		regionSize.NumTiles = box.TileCount();
+		regionSize.UseBox = TRUE;
+		regionSize.Width = box.width;
+		regionSize.Height = box.height;
+		regionSize.Depth = box.depth;
+
+		// One single-tile range per coordinate, strided by the member count
+		std::vector<D3D12_TILE_RANGE_FLAGS> rangeFlags(box.TileCount(), D3D12_TILE_RANGE_FLAG_NONE);
+		std::vector<UINT> rangeOffsets(box.TileCount());
+		std::vector<UINT> rangeTileCounts(box.TileCount(), 1);
+		for (UINT m = 0; m < memberCount; ++m)
+		{
+			for (UINT i = 0; i < box.TileCount(); ++i)
+			{
+				rangeOffsets[i] = alloc.heapOffsetInTiles + i * memberCount + m;
+			}
+			m_backend->UpdateTileMappings(
+				members[m],
+				1, &startCoord, &regionSize,
+				g_tileHeap.get(),
+				box.TileCount(), rangeFlags.data(),
+				rangeOffsets.data(),
+				rangeTileCounts.data()
+			);
+		}
+	}
+	SPARSE_STATS_ADD(m_pipelineStats, PipelineCounter::TilesMapped, tileCount);
+
+	UINT runStart = alloc.heapOffsetInTiles;
+	for (UINT z = box.startZ; z < box.startZ + box.depth; ++z)
+		for (UINT y = box.startY; y < box.startY + box.height; ++y)
+			for (UINT x = box.startX; x < box.startX + box.width; ++x)
+			{
+				set.Register(box.subResource, x, y, z, runStart);
+				for (UINT m = 0; m < memberCount; ++m)
+				{
+					members[m]->RegisterMappedTile(box.subResource, x, y, z, runStart + m);
+				}
+				runStart += memberCount;
+			}
+	return true;
+}
+
+void RenderingPlugin::UnmapVolumeSetBoxLocked(VolumeSet& set, const TileBox& box)
+{
+	std::vector<UINT> runStarts;
+	set.UnregisterBox(
+		box.subResource,
+		box.startX, box.startY, box.startZ,
+		box.width, box.height, box.depth,
+		runStarts);
+	if (runStarts.empty()) {
+		return;
+	}
+
+	// Each member's registration holds its own tile of every run
+	std::vector<UINT> heapOffsets;
+	for (ReservedResource* member : set.GetMembers()) {
+		member->UnregisterMappedTileBox(
+			box.subResource,
+			box.startX, box.startY, box.startZ,
+			box.width, box.height, box.depth,
+			heapOffsets);
+		NullMapTileBox(member, box);
+	}
+
+	std::vector<TileRange> ranges = CoalesceTileRanges(heapOffsets);
+	RetireTiles(ranges.data(), static_cast<UINT>(ranges.size()));
+}
+
+bool RenderingPlugin::EnableWrapAddressing(ReservedResource* resource, bool enable)
+{
+	if (!initialized.load(std::memory_order_acquire)) {
+		LogError("EnableWrapAddressing: plugin not initialized");
+		return false;
+	}
+	try {
+		if (!resource) {
+			LogError("EnableWrapAddressing: null resource");
+			return false;
+		}
+		std::lock_guard<std::mutex> lock(m_mappingMutex);
+		if (RejectSetMember("EnableWrapAddressing", resource)) {
+			return false;
+		}
+		if (!enable) {
+			resource->SetWrapWindow(nullptr);
+			return true;
+		}
+		if (resource->GetWrapWindow()) {
+			return true;
+		}
+
+		// Coarser mips would scroll by fractions of a tile, and a partial
+		// last tile would wrap at a different texel than the tile grid
+		const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+		if (tilingInfo.SubresourceCount != 1 || tilingInfo.NumStandardMips != 1) {
+			LogError("EnableWrapAddressing: resource must have a single, unpacked mip");
+			return false;
+		}
+		const SubresourceTilingInfo& subInfo = tilingInfo.subresourceTilingInfo[0];
+		if (resource->width != subInfo.WidthInTiles * tilingInfo.TileWidthInTexels ||
+			resource->height != subInfo.HeightInTiles * tilingInfo.TileHeightInTexels ||
+			resource->depth != subInfo.DepthInTiles * tilingInfo.TileDepthInTexels)
+		{
+			LogError(std::format(
+				"EnableWrapAddressing: {}x{}x{} is not a whole number of {}x{}x{} tiles",
+				resource->width, resource->height, resource->depth,
+				tilingInfo.TileWidthInTexels, tilingInfo.TileHeightInTexels, tilingInfo.TileDepthInTexels));
+			return false;
+		}
+
+		resource->SetWrapWindow(std::make_shared<WrapWindow>(
+			subInfo.WidthInTiles, subInfo.HeightInTiles, subInfo.DepthInTiles));
+		return true;
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::ScrollVolume(
+	ReservedResource* resource,
+	INT64 dx, INT64 dy, INT64 dz,
+	std::vector<WrapBox>* outEntering
+) {
+	if (!initialized.load(std::memory_order_acquire)) {
+		LogError("ScrollVolume: plugin not initialized");
+		return false;
+	}
+	try {
+		if (!resource) {
+			LogError("ScrollVolume: null resource");
+			return false;
+		}
+		std::lock_guard<std::mutex> lock(m_mappingMutex);
+		if (RejectSetMember("ScrollVolume", resource)) {
+			return false;
+		}
+		std::shared_ptr<WrapWindow> window = resource->GetWrapWindow();
+		if (!window) {
+			LogError("ScrollVolume: wrap addressing is not enabled");
+			return false;
+		}
+
+		std::vector<WrapBox> entering;
+		window->Scroll(dx, dy, dz, entering);
+
+		// The entering boxes are exactly the physical tiles that left the
+		// window; everything else stays mapped where it is
+		std::vector<UINT> heapOffsets;
+		for (const WrapBox& wrapBox : entering) {
+			const size_t previousCount = heapOffsets.size();
+			resource->UnregisterMappedTileBox(
+				0,
+				wrapBox.startX, wrapBox.startY, wrapBox.startZ,
+				wrapBox.width, wrapBox.height, wrapBox.depth,
+				heapOffsets);
+			if (heapOffsets.size() != previousCount) {
+				NullMapTileBox(resource, {
+					0,
+					wrapBox.startX, wrapBox.startY, wrapBox.startZ,
+					wrapBox.width, wrapBox.height, wrapBox.depth });
+			}
+		}
+
+		if (!heapOffsets.empty()) {
+			std::vector<TileRange> ranges = CoalesceTileRanges(heapOffsets);
+			RetireTiles(ranges.data(), static_cast<UINT>(ranges.size()));
+		}
+
+		if (outEntering) {
+			outEntering->insert(outEntering->end(), entering.begin(), entering.end());
+		}
+		return true;
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::GetWrapOffset(ReservedResource* resource, UINT outTexelOffset[3])
+{
+	if (!resource || !outTexelOffset) {
+		LogError("GetWrapOffset: null argument");
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mappingMutex);
+	std::shared_ptr<WrapWindow> window = resource->GetWrapWindow();
+	if (!window) {
+		LogError("GetWrapOffset: wrap addressing is not enabled");
+		return false;
+	}
+
+	const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+	window->GetOffset(outTexelOffset);
+	outTexelOffset[0] *= tilingInfo.TileWidthInTexels;
+	outTexelOffset[1] *= tilingInfo.TileHeightInTexels;
+	outTexelOffset[2] *= tilingInfo.TileDepthInTexels;
+	return true;
+}
+
+bool RenderingPlugin::StageAndSubmitTileBoxes(
+	const std::span<const TileBoxUpload>& uploads,
+	UINT64* outCompletionFence
+) {
+	struct PendingSlab {
+		size_t upload;
+		TileBox box;
+		UINT firstTile;   // In the upload's source order
+	};
+
+	std::vector<StagingFill> fills;
+	std::vector<PendingSlab> slabs;
+	for (size_t i = 0; i < uploads.size(); ++i)
+	{
+		fills.push_back(MakeLinearStagingFill(uploads[i].resource, uploads[i].sourceData.data()));
+		UINT firstTile = 0;
+		for (const TileBox& slab : SplitIntoSlabs(uploads[i].box, BATCH_UPLOAD_TILE_COUNT))
+		{
+			slabs.push_back({ i, slab, firstTile });
+			firstTile += slab.TileCount();
+		}
+	}
+
+	UINT64 completionFence = 0;
+	size_t begin = 0;
+	while (begin < slabs.size())
+	{
+		// As many whole slabs as one staging buffer holds; every slab fits
+		// on its own
+		size_t end = begin;
+		UINT groupTiles = 0;
+		while (end < slabs.size() && groupTiles + slabs[end].box.TileCount() <= BATCH_UPLOAD_TILE_COUNT)
+		{
+			groupTiles += slabs[end].box.TileCount();
+			++end;
+		}
+
+		RingSlotLease slot(*this);
+		std::vector<UploadSubmission> submissions(end - begin);
+		std::vector<UploadSubmission*> pending;
+		UINT stagedTiles = 0;
+		for (size_t i = begin; i < end; ++i)
+		{
+			const PendingSlab& slab = slabs[i];
+			const UINT slabTiles = slab.box.TileCount();
+			{
+				SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::StageFill);
+				SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::StageFill, uploads[slab.upload].resource->handle, PackTraceTile(slab.box.subResource, slab.box.startX, slab.box.startY, slab.box.startZ));
+				fills[slab.upload](
+					m_batchUploadBufferData[slot.Index()] + static_cast<size_t>(stagedTiles) * UPLOAD_TILE_SIZE,
+					slab.firstTile, slabTiles);
+			}
+
+			UploadSubmission& submission = submissions[i - begin];
+			submission.resource = uploads[slab.upload].resource;
+			submission.startCoord.X = slab.box.startX;
+			submission.startCoord.Y = slab.box.startY;
+			submission.startCoord.Z = slab.box.startZ;
+			submission.startCoord.Subresource = slab.box.subResource;
+			submission.regionSize.NumTiles = slabTiles;
+			submission.regionSize.UseBox = TRUE;
+			submission.regionSize.Width = slab.box.width;
+			submission.regionSize.Height = slab.box.height;
+			submission.regionSize.Depth = slab.box.depth;
+			submission.sourceBuffer = StagingBuffer::Batch;
+			submission.sourceOffset = static_cast<UINT64>(stagedTiles) * UPLOAD_TILE_SIZE;
+			submission.slotIndex = slot.Index();
+			pending.push_back(&submission);
+
+			stagedTiles += slabTiles;
+		}
+
+		slot.HandOff();
+		if (!SubmitUploads(pending.data(), static_cast<UINT>(pending.size())))
+			return false;
+
+		completionFence = submissions.back().fenceValue;
+		begin = end;
+	}
+
+	if (outCompletionFence)
+	{
+		*outCompletionFence = completionFence;
+	}
+	return true;
+}
+
+bool RenderingPlugin::UploadTileBoxWithFill(
+	ReservedResource* resource,
+	const TileBox& box,
+	const StagingFill& fill,
+	UINT64* outCompletionFence
+) {
+	try {
+		// Validation
+		D3D12_RESOURCE_DESC desc;
+		ResourceTilingInfo tilingInfo;
+		if (!ValidateTileBoxParams(resource, box, &desc, &tilingInfo))
+			return false;
+		UINT tileCount = box.TileCount();
+		TileAllocation alloc;
+		PrepareHeapSpace(tileCount);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mappingMutex);
+			if (RejectSetMember("UploadDataToTileBox", resource))
+				return false;
+
+			// Pre-check for pre-existing mappings
+			for (UINT z = box.startZ; z < box.startZ + box.depth; ++z)
+				for (UINT y = box.startY; y < box.startY + box.height; ++y)
+					for (UINT x = box.startX; x < box.startX + box.width; ++x)
+						if (resource->IsTileMapped(box.subResource, x, y, z))
+						{
+							LogError(std::format(
+								"UploadDataToTileBox: tile ({},{},{}) already mapped",
+								x, y, z));
+							return false;
+						}
+
+			// Pre-check capacity, reclaiming retired tiles if needed
+			if (!g_tileHeap->CanAllocate(tileCount))
+			{
+				ReleaseRetiredTiles();
+			}
+			if (!g_tileHeap->CanAllocate(tileCount))
+			{
+				LogError(std::format(
+					"UploadDataToTileBox: heap cannot allocate {} tiles "
+					"(free: {}, used: {})",
+					tileCount, g_tileHeap->GetFreeTiles(), g_tileHeap->GetUsedTiles()));
+				SPARSE_TRACE_INSTANT(m_eventTracer, TraceEvent::AllocationFailure, resource->handle, tileCount);
+				return false;
+			}
+
+			// Allocate contiguous heap space for the entire box
+			alloc = g_tileHeap->AllocateTiles(tileCount);
+			if (!alloc.success)
+			{
+				LogError("UploadDataToTileBox: AllocateTiles failed");
+				return false;
+			}
+
+			// Map the box region with one UpdateTileMappings call
+			{
+				SPARSE_STATS_SCOPE(m_pipelineStats, PipelineStage::MapTiles);
+				SPARSE_TRACE_SCOPE(m_eventTracer, TraceEvent::MapTiles, resource->handle, PackTraceTile(box.subResource, box.startX, box.startY, box.startZ));
+
+				D3D12_TILED_RESOURCE_COORDINATE startCoord = {};
+				startCoord.X = box.startX;
+				startCoord.Y = box.startY;
+				startCoord.Z = box.startZ;
+				startCoord.Subresource = box.subResource;
+
+				D3D12_TILE_REGION_SIZE regionSize = {};
+				regionSize.NumTiles = tileCount;
+				regionSize.UseBox = TRUE;
+				regionSize.Width = box.width;
+				regionSize.Height = box.height;
+				regionSize.Depth = box.depth;
+
+				D3D12_TILE_RANGE_FLAGS rangeFlags = D3D12_TILE_RANGE_FLAG_NONE;
+
+				m_backend->UpdateTileMappings(
+					resource,
+					1, &startCoord, &regionSize,
+					g_tileHeap.get(),
+					1, &rangeFlags,
+					&alloc.heapOffsetInTiles,
+					&tileCount
+				);
+			}
+			SPARSE_STATS_ADD(m_pipelineStats, PipelineCounter::TilesMapped, tileCount);
+
+			// Register all tiles with sequential heap offsets
+			{
+				UINT i = 0;
+				for (UINT z = box.startZ; z < box.startZ + box.depth; ++z)
+					for (UINT y = box.startY; y < box.startY + box.height; ++y)
+						for (UINT x = box.startX; x < box.startX + box.width; ++x)
+							resource->RegisterMappedTile(
+								box.subResource, x, y, z,
+								alloc.heapOffsetInTiles + i++);
+			}
+		}
+
+		// Stage outside the mapping lock; slabs are contiguous in the source.
+		// The box is mapped by now, so a throw rolls it back like a failure.
+		bool staged = false;
+		try {
+			staged = StageAndSubmitTileBox(resource, box, fill, outCompletionFence);
+		}
+		catch (const std::exception& ex) {
+			LogError(ex.what());
+		}
+		if (!staged)
+		{
+			std::lock_guard<std::mutex> lock(m_mappingMutex);
+			RollbackTileBoxMapping(
+				resource, box, alloc.heapOffsetInTiles, tileCount);
+			return false;
+		}
+
+		return true;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::PrepareConversion(
+	const char* caller,
+	const ReservedResource* resource,
+	UploadSourceFormat sourceFormat,
+	const std::span<const std::byte>& palette,
+	ConversionInfo* outInfo,
+	std::vector<std::byte>& outPalette
+) {
+	if (!resource)
+	{
+		LogError(std::format("{}: null resource", caller));
+		return false;
+	}
+
+	const UINT bytesPerPixel = GetBytesPerPixel(resource->textureFormat);
+	if (!GetConversionKernel(sourceFormat, resource->textureFormat, bytesPerPixel, outInfo))
+	{
+		LogError(std::format(
+			"{}: cannot convert source format {} to DXGI format {}",
+			caller, static_cast<UINT>(sourceFormat), static_cast<UINT>(resource->textureFormat)));
+		return false;
+	}
+
+	if (sourceFormat == UploadSourceFormat::Palette8)
+	{
+		const size_t tableSize = static_cast<size_t>(UPLOAD_PALETTE_SIZE) * bytesPerPixel;
+		if (palette.empty() || palette.size_bytes() % bytesPerPixel != 0 || palette.size_bytes() > tableSize)
+		{
+			LogError(std::format(
+				"{}: palette must hold 1 to {} entries of {} bytes, got {} bytes",
+				caller, UPLOAD_PALETTE_SIZE, bytesPerPixel, palette.size_bytes()));
+			return false;
+		}
+
+		// Pad to a full table so any index byte is a valid lookup
+		outPalette.assign(tableSize, std::byte{ 0 });
+		memcpy(outPalette.data(), palette.data(), palette.size_bytes());
+	}
+
+	return true;
+}
+
+bool RenderingPlugin::PrepareBlockEncoding(
+	const char* caller,
+	const ReservedResource* resource,
+	BlockEncoderInfo* outInfo
+) {
+	if (!resource)
+	{
+		LogError(std::format("{}: null resource", caller));
+		return false;
+	}
+
+	if (!GetBlockEncoder(resource->textureFormat, outInfo))
+	{
+		LogError(std::format(
+			"{}: no block encoder for DXGI format {}; upload pre-compressed blocks instead",
+			caller, static_cast<UINT>(resource->textureFormat)));
+		return false;
+	}
+
+	return true;
+}
+
+StagingFill RenderingPlugin::MakeBlockEncodeFill(
+	const ReservedResource* resource,
+	const BlockEncoderInfo& encoder,
+	const std::byte* sourceData
+) {
+	const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+	const MipTileShape shape = {
+		tilingInfo.TileWidthInTexels,
+		tilingInfo.TileHeightInTexels,
+		tilingInfo.TileDepthInTexels
+	};
+	const size_t sourceBytesPerTile = static_cast<size_t>(shape.width) * shape.height * shape.depth
+		* encoder.sourceBytesPerTexel;
+	WorkerPool* pool = &GetStagingPool();
+
+	return [=](std::byte* destination, UINT firstTile, UINT tileCount) {
+		// Splitting by slice keeps every worker busy even for one tile
+		pool->ParallelFor(tileCount * shape.depth, [&](uint32_t item) {
+			const uint32_t tile = item / shape.depth;
+			EncodeTileSlices(
+				encoder,
+				sourceData + (firstTile + tile) * sourceBytesPerTile,
+				destination + tile * UPLOAD_TILE_SIZE,
+				shape,
+				item % shape.depth,
+				1);
+		});
+	};
+}
+
+WorkerPool& RenderingPlugin::GetStagingPool()
+{
+	std::call_once(m_stagingPoolOnce, [this] {
+		// The calling upload thread works too, so leave it a core
+		const UINT cores = std::thread::hardware_concurrency();
+		m_stagingPool = std::make_unique<WorkerPool>((std::min)(cores > 1 ? cores - 1 : 0u, MAX_STAGING_WORKERS));
+	});
+	return *m_stagingPool;
+}
+
+bool RenderingPlugin::UploadConvertedDataToTile(
+	ReservedResource* resource,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ,
+	const std::span<std::byte>& sourceData,
+	UploadSourceFormat sourceFormat,
+	const std::span<const std::byte>& palette
+) {
+	if (sourceFormat == UploadSourceFormat::Native) {
+		return UploadDataToTile(resource, subResource, tileX, tileY, tileZ, sourceData);
+	}
+
+	try {
+		if (sourceFormat == UploadSourceFormat::Uncompressed)
+		{
+			// BC resources have neither swizzle nor mip generation, so the
+			// encoder always writes straight into staging
+			BlockEncoderInfo encoder;
+			if (!PrepareBlockEncoding("UploadConvertedDataToTile", resource, &encoder) ||
+				!ValidateSourceSize("UploadConvertedDataToTile", resource, sourceData.size_bytes(), 1, encoder.sourceBytesPerTexel)) {
+				return false;
+			}
+			return UploadSingleTile(resource, subResource, tileX, tileY, tileZ,
+				MakeBlockEncodeFill(resource, encoder, sourceData.data()), nullptr);
+		}
+
+		ConversionInfo conversion;
+		std::vector<std::byte> paletteTable;
+		if (!PrepareConversion("UploadConvertedDataToTile", resource, sourceFormat, palette, &conversion, paletteTable) ||
+			!ValidateSourceSize("UploadConvertedDataToTile", resource, sourceData.size_bytes(), 1, conversion.sourceBytesPerTexel)) {
+			return false;
+		}
+
+		const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+		const size_t texelsPerTile = static_cast<size_t>(tilingInfo.TileWidthInTexels)
+			* tilingInfo.TileHeightInTexels * tilingInfo.TileDepthInTexels;
+
+		// Swizzling and mip generation both want the converted linear tile
+		if (resource->IsStandardSwizzle() || resource->GetMipChainBuilder())
+		{
+			std::vector<std::byte> converted(UPLOAD_TILE_SIZE);
+			conversion.kernel(sourceData.data(), converted.data(), texelsPerTile, paletteTable.data());
+			return UploadDataToTile(resource, subResource, tileX, tileY, tileZ, converted);
+		}
+
+		StagingFill fill = [&](std::byte* destination, UINT, UINT) {
+			conversion.kernel(sourceData.data(), destination, texelsPerTile, paletteTable.data());
+		};
+		return UploadSingleTile(resource, subResource, tileX, tileY, tileZ, fill, nullptr);
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::UploadConvertedDataToTileBox(
+	ReservedResource* resource,
+	const TileBox& box,
+	const std::span<std::byte>& sourceData,
+	UploadSourceFormat sourceFormat,
+	const std::span<const std::byte>& palette,
+	UINT64* outCompletionFence
+) {
+	if (sourceFormat == UploadSourceFormat::Native) {
+		return UploadDataToTileBox(resource, box, sourceData, outCompletionFence);
+	}
+
+	try {
+		if (sourceFormat == UploadSourceFormat::Uncompressed)
+		{
+			BlockEncoderInfo encoder;
+			if (!PrepareBlockEncoding("UploadConvertedDataToTileBox", resource, &encoder) ||
+				!ValidateSourceSize("UploadConvertedDataToTileBox", resource, sourceData.size_bytes(), box.TileCount(), encoder.sourceBytesPerTexel)) {
+				return false;
+			}
+			return UploadTileBoxWithFill(resource, box,
+				MakeBlockEncodeFill(resource, encoder, sourceData.data()), outCompletionFence);
+		}
+
+		ConversionInfo conversion;
+		std::vector<std::byte> paletteTable;
+		if (!PrepareConversion("UploadConvertedDataToTileBox", resource, sourceFormat, palette, &conversion, paletteTable) ||
+			!ValidateSourceSize("UploadConvertedDataToTileBox", resource, sourceData.size_bytes(), box.TileCount(), conversion.sourceBytesPerTexel)) {
+			return false;
+		}
+
+		const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+		const size_t texelsPerTile = static_cast<size_t>(tilingInfo.TileWidthInTexels)
+			* tilingInfo.TileHeightInTexels * tilingInfo.TileDepthInTexels;
+		const size_t sourceBytesPerTile = texelsPerTile * conversion.sourceBytesPerTexel;
+
+		if (resource->IsStandardSwizzle() || resource->GetMipChainBuilder())
+		{
+			std::vector<std::byte> converted(static_cast<size_t>(box.TileCount()) * UPLOAD_TILE_SIZE);
+			conversion.kernel(sourceData.data(), converted.data(), texelsPerTile * box.TileCount(), paletteTable.data());
+			return UploadDataToTileBox(resource, box, converted, outCompletionFence);
+		}
+
+		// Source tiles are contiguous, so each slab converts as one run
+		StagingFill fill = [&](std::byte* destination, UINT firstTile, UINT tileCount) {
+			conversion.kernel(
+				sourceData.data() + firstTile * sourceBytesPerTile,
+				destination,
+				texelsPerTile * tileCount,
+				paletteTable.data());
+		};
+		return UploadTileBoxWithFill(resource, box, fill, outCompletionFence);
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::ParseEncodedPayload(
+	const char* caller,
+	const ReservedResource* resource,
+	const std::span<const std::byte>& payload,
+	UINT tileCount,
+	std::vector<EncodedTileView>& outTiles
+) {
+	if (!resource)
+	{
+		LogError(std::format("{}: null resource", caller));
+		return false;
+	}
+
+	const UINT elementSize = GetTileElementSize(resource->textureFormat);
+	if (elementSize == 0)
+	{
+		LogError(std::format("{}: unsupported texture format", caller));
+		return false;
+	}
+
+	outTiles.resize(tileCount);
+	size_t offset = 0;
+	for (UINT i = 0; i < tileCount; ++i)
+	{
+		if (!ReadEncodedTile(payload.data(), payload.size_bytes(), &offset, elementSize, &outTiles[i]) ||
+			!ValidateEncodedTile(outTiles[i], elementSize, UPLOAD_TILE_SIZE))
+		{
+			LogError(std::format(
+				"{}: encoded tile {} of {} is malformed or truncated (element size {})",
+				caller, i, tileCount, elementSize));
+			return false;
+		}
+	}
+
+	if (offset != payload.size_bytes())
+	{
+		LogError(std::format(
+			"{}: {} trailing bytes after {} encoded tile(s)",
+			caller, payload.size_bytes() - offset, tileCount));
+		return false;
+	}
+
+	return true;
+}
+
+bool RenderingPlugin::UploadEncodedDataToTile(
+	ReservedResource* resource,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ,
+	const std::span<const std::byte>& payload
+) {
+	try {
+		std::vector<EncodedTileView> tiles;
+		if (!ParseEncodedPayload("UploadEncodedDataToTile", resource, payload, 1, tiles)) {
+			return false;
+		}
+
+		const UINT elementSize = GetTileElementSize(resource->textureFormat);
+
+		// Swizzling and mip generation both want the decoded linear tile
+		if (resource->IsStandardSwizzle() || resource->GetMipChainBuilder())
+		{
+			std::vector<std::byte> decoded(UPLOAD_TILE_SIZE);
+			DecodeTile(tiles[0], elementSize, decoded.data(), UPLOAD_TILE_SIZE);
+			return UploadDataToTile(resource, subResource, tileX, tileY, tileZ, decoded);
+		}
+
+		StagingFill fill = [&](std::byte* destination, UINT, UINT) {
+			DecodeTile(tiles[0], elementSize, destination, UPLOAD_TILE_SIZE);
+		};
+		return UploadSingleTile(resource, subResource, tileX, tileY, tileZ, fill, nullptr);
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::UploadEncodedDataToTileBox(
+	ReservedResource* resource,
+	const TileBox& box,
+	const std::span<const std::byte>& payload,
+	UINT64* outCompletionFence
+) {
+	try {
+		std::vector<EncodedTileView> tiles;
+		if (!ParseEncodedPayload("UploadEncodedDataToTileBox", resource, payload, box.TileCount(), tiles)) {
+			return false;
+		}
+
+		const UINT elementSize = GetTileElementSize(resource->textureFormat);
+		WorkerPool& pool = GetStagingPool();
+
+		if (resource->IsStandardSwizzle() || resource->GetMipChainBuilder())
+		{
+			std::vector<std::byte> decoded(static_cast<size_t>(box.TileCount()) * UPLOAD_TILE_SIZE);
+			pool.ParallelFor(box.TileCount(), [&](uint32_t i) {
+				DecodeTile(tiles[i], elementSize, decoded.data() + i * UPLOAD_TILE_SIZE, UPLOAD_TILE_SIZE);
+			});
+			return UploadDataToTileBox(resource, box, decoded, outCompletionFence);
+		}
+
+		StagingFill fill = [&](std::byte* destination, UINT firstTile, UINT tileCount) {
+			pool.ParallelFor(tileCount, [&](uint32_t i) {
+				DecodeTile(tiles[firstTile + i], elementSize, destination + i * UPLOAD_TILE_SIZE, UPLOAD_TILE_SIZE);
+			});
+		};
+		return UploadTileBoxWithFill(resource, box, fill, outCompletionFence);
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::EncodeTileData(
+	const ReservedResource* resource,
+	const std::span<const std::byte>& tile,
+	std::vector<std::byte>& outPayload
+) {
+	if (!resource)
+	{
+		LogError("EncodeTileData: null resource");
+		return false;
+	}
+
+	const UINT elementSize = GetTileElementSize(resource->textureFormat);
+	if (elementSize == 0 || tile.size_bytes() != UPLOAD_TILE_SIZE)
+	{
+		LogError(std::format(
+			"EncodeTileData: expected one {}-byte tile of a supported format, got {} bytes",
+			UPLOAD_TILE_SIZE, tile.size_bytes()));
+		return false;
+	}
+
+	try {
+		EncodeTile(tile.data(), tile.size_bytes(), elementSize, outPayload);
+		return true;
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+TileArchive* RenderingPlugin::OpenTileArchive(const char* utf8Path)
+{
+	if (!utf8Path)
+	{
+		LogError("OpenTileArchive: null path");
+		return nullptr;
+	}
+
+	try {
+		std::string error;
+		std::unique_ptr<TileArchive> archive = TileArchive::Open(utf8Path, &error);
+		if (!archive)
+		{
+			LogError(std::format("OpenTileArchive: {}: {}", utf8Path, error));
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(m_archiveMutex);
+		m_archives.push_back(std::move(archive));
+		return m_archives.back().get();
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return nullptr;
+	}
+}
+
+bool RenderingPlugin::CloseTileArchive(TileArchive* archive)
+{
+	std::lock_guard<std::mutex> lock(m_archiveMutex);
+	auto it = std::find_if(m_archives.begin(), m_archives.end(),
+		[archive](const std::shared_ptr<TileArchive>& p) {
+			return p.get() == archive;
+		});
+	if (it == m_archives.end())
+	{
+		LogError("CloseTileArchive: archive not found");
+		return false;
+	}
+
+	// Prefetchers reading from it keep it mapped until they are disabled
+	m_archives.erase(it);
+	return true;
+}
+
+std::shared_ptr<TileArchive> RenderingPlugin::FindTileArchive(const TileArchive* archive)
+{
+	std::lock_guard<std::mutex> lock(m_archiveMutex);
+	auto it = std::find_if(m_archives.begin(), m_archives.end(),
+		[archive](const std::shared_ptr<TileArchive>& p) {
+			return p.get() == archive;
+		});
+	return it != m_archives.end() ? *it : nullptr;
+}
+
+bool RenderingPlugin::FindArchiveTiles(
+	const char* caller,
+	const ReservedResource* resource,
+	const TileArchive* archive,
+	const TileBox& box,
+	std::vector<const TileArchiveEntry*>& outEntries
+) {
+	if (!resource || !archive)
+	{
+		LogError(std::format("{}: null resource or archive", caller));
+		return false;
+	}
+
+	const TileArchiveHeader& header = archive->Header();
+	if (header.format != static_cast<uint32_t>(resource->textureFormat))
+	{
+		LogError(std::format(
+			"{}: archive was baked for DXGI format {}, resource is {}",
+			caller, header.format, static_cast<UINT>(resource->textureFormat)));
+		return false;
+	}
+	if (header.elementSize != GetTileElementSize(resource->textureFormat))
+	{
+		LogError(std::format("{}: archive element size {} does not match the resource", caller, header.elementSize));
+		return false;
+	}
+
+	outEntries.clear();
+	outEntries.reserve(box.TileCount());
+	for (UINT z = 0; z < box.depth; ++z) {
+		for (UINT y = 0; y < box.height; ++y) {
+			for (UINT x = 0; x < box.width; ++x) {
+				const UINT tileX = box.startX + x;
+				const UINT tileY = box.startY + y;
+				const UINT tileZ = box.startZ + z;
+				const TileArchiveEntry* entry = archive->Find(box.subResource, tileX, tileY, tileZ);
+				if (!entry || !archive->ValidateRecord(*entry))
+				{
+					LogError(std::format(
+						"{}: tile ({}, {}, {}) of subresource {} is {} in the archive",
+						caller, tileX, tileY, tileZ, box.subResource, entry ? "corrupt" : "missing"));
+					return false;
+				}
+				outEntries.push_back(entry);
+			}
+		}
+	}
+
+	return true;
+}
+
+bool RenderingPlugin::UploadTileFromArchive(
+	ReservedResource* resource,
+	TileArchive* archive,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ
+) {
+	try {
+		const TileBox box = { subResource, tileX, tileY, tileZ, 1, 1, 1 };
+		std::vector<const TileArchiveEntry*> entries;
+		if (!FindArchiveTiles("UploadTileFromArchive", resource, archive, box, entries)) {
+			return false;
+		}
+
+		// Swizzling and mip generation both want the linear tile
+		if (resource->IsStandardSwizzle() || resource->GetMipChainBuilder())
+		{
+			std::vector<std::byte> linear(UPLOAD_TILE_SIZE);
+			archive->ReadTile(*entries[0], linear.data());
+			return UploadDataToTile(resource, subResource, tileX, tileY, tileZ, linear);
+		}
+
+		StagingFill fill = [&](std::byte* destination, UINT, UINT) {
+			archive->ReadTile(*entries[0], destination);
+		};
+		return UploadSingleTile(resource, subResource, tileX, tileY, tileZ, fill, nullptr);
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::UploadTileBoxFromArchive(
+	ReservedResource* resource,
+	TileArchive* archive,
+	const TileBox& box,
+	UINT64* outCompletionFence
+) {
+	try {
+		std::vector<const TileArchiveEntry*> entries;
+		if (!FindArchiveTiles("UploadTileBoxFromArchive", resource, archive, box, entries)) {
+			return false;
+		}
+
+		// Start reading the whole box before the first slab is staged, so
+		// later slabs find their pages already resident
+		archive->Prefetch(entries.data(), entries.size());
+
+		// Records were validated above; worker threads fault pages in
+		// concurrently, which keeps several disk reads in flight
+		WorkerPool& pool = GetStagingPool();
+		StagingFill fill = [&](std::byte* destination, UINT firstTile, UINT tileCount) {
+			pool.ParallelFor(tileCount, [&](uint32_t i) {
+				archive->ReadTile(*entries[firstTile + i], destination + i * UPLOAD_TILE_SIZE);
+			});
+		};
+
+		if (resource->IsStandardSwizzle() || resource->GetMipChainBuilder())
+		{
+			std::vector<std::byte> linear(static_cast<size_t>(box.TileCount()) * UPLOAD_TILE_SIZE);
+			fill(linear.data(), 0, box.TileCount());
+			return UploadDataToTileBox(resource, box, linear, outCompletionFence);
+		}
+
+		return UploadTileBoxWithFill(resource, box, fill, outCompletionFence);
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+TileArchiveWriter* RenderingPlugin::CreateTileArchiveWriter(const char* utf8Path, DXGI_FORMAT format)
+{
+	if (!utf8Path)
+	{
+		LogError("CreateTileArchiveWriter: null path");
+		return nullptr;
+	}
+
+	try {
+		const UINT elementSize = GetTileElementSize(format);
+		if (elementSize == 0)
+		{
+			LogError(std::format("CreateTileArchiveWriter: unsupported DXGI format {}", static_cast<UINT>(format)));
+			return nullptr;
+		}
+
+		std::string error;
+		std::unique_ptr<TileArchiveWriter> writer = TileArchiveWriter::Create(
+			utf8Path, static_cast<uint32_t>(format), elementSize, &error);
+		if (!writer)
+		{
+			LogError(std::format("CreateTileArchiveWriter: {}: {}", utf8Path, error));
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(m_archiveMutex);
+		m_archiveWriters.push_back(std::move(writer));
+		return m_archiveWriters.back().get();
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return nullptr;
+	}
+}
+
+bool RenderingPlugin::AddTileToArchive(
+	TileArchiveWriter* writer,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ,
+	const std::span<const std::byte>& tileData,
+	bool compress
+) {
+	if (!writer || tileData.size_bytes() != UPLOAD_TILE_SIZE)
+	{
+		LogError(std::format(
+			"AddTileToArchive: expected a writer and {} bytes of tile data, got {} bytes",
+			UPLOAD_TILE_SIZE, tileData.size_bytes()));
+		return false;
+	}
+
+	try {
+		std::string error;
+		if (!writer->AddTile(subResource, tileX, tileY, tileZ, tileData.data(), compress, &error))
+		{
+			LogError(std::format("AddTileToArchive: {}", error));
+			return false;
+		}
+		return true;
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::FinishTileArchive(TileArchiveWriter* writer)
+{
+	std::unique_ptr<TileArchiveWriter> owned;
+	{
+		std::lock_guard<std::mutex> lock(m_archiveMutex);
+		auto it = std::find_if(m_archiveWriters.begin(), m_archiveWriters.end(),
+			[writer](const std::unique_ptr<TileArchiveWriter>& p) {
+				return p.get() == writer;
+			});
+		if (it == m_archiveWriters.end())
+		{
+			LogError("FinishTileArchive: writer not found");
+			return false;
+		}
+		owned = std::move(*it);
+		m_archiveWriters.erase(it);
+	}
+
+	try {
+		std::string error;
+		if (!owned->Finish(&error))
+		{
+			LogError(std::format("FinishTileArchive: {}", error));
+			return false;
+		}
+		return true;
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::EnableTilePrefetch(
+	ReservedResource* resource,
+	const PrefetchSettings& settings,
+	const TilePrefetchSource& source
+) {
+	if (!initialized.load(std::memory_order_acquire))
+	{
+		LogError("EnableTilePrefetch: plugin not initialized");
+		return false;
+	}
+
+	try
+	{
+		if (!resource)
+		{
+			LogError("EnableTilePrefetch: null resource");
+			return false;
+		}
+
+		if ((source.archive == nullptr) == (source.callback == nullptr))
+		{
+			LogError("EnableTilePrefetch: expected exactly one of an archive or a callback");
+			return false;
+		}
+
+		if (source.archive)
+		{
+			const TileArchiveHeader& header = source.archive->Header();
+			if (header.format != static_cast<uint32_t>(resource->textureFormat) ||
+				header.elementSize != GetTileElementSize(resource->textureFormat))
+			{
+				LogError(std::format(
+					"EnableTilePrefetch: archive was baked for DXGI format {}, resource is {}",
+					header.format, static_cast<UINT>(resource->textureFormat)));
+				return false;
+			}
+		}
+
+		const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+		if (settings.mipRadii.empty() || settings.mipRadii.size() > tilingInfo.NumStandardMips)
+		{
+			LogError(std::format(
+				"EnableTilePrefetch: expected 1 to {} mip radii, got {}",
+				tilingInfo.NumStandardMips, settings.mipRadii.size()));
+			return false;
+		}
+
+		std::shared_ptr<TilePrefetcher> previous = resource->GetTilePrefetcher();
+		resource->SetTilePrefetcher(std::make_shared<TilePrefetcher>(tilingInfo, settings, source));
+		if (previous) {
+			CancelPrefetchRequests(*previous);
+		}
+		return true;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::DisableTilePrefetch(ReservedResource* resource)
+{
+	if (!resource)
+	{
+		LogError("DisableTilePrefetch: null resource");
+		return false;
+	}
+
+	std::shared_ptr<TilePrefetcher> prefetcher = resource->GetTilePrefetcher();
+	resource->SetTilePrefetcher(nullptr);
+	if (prefetcher) {
+		CancelPrefetchRequests(*prefetcher);
+	}
+	return true;
+}
+
+void RenderingPlugin::CancelPrefetchRequests(TilePrefetcher& prefetcher)
+{
+	for (const auto& [key, id] : prefetcher.TakeQueuedRequests()) {
+		m_streamingScheduler.Cancel(id);
+	}
+}
+
+UINT RenderingPlugin::UpdateTilePrefetch(
+	ReservedResource* resource,
+	const PrefetchCamera& camera
+) {
+	if (!initialized.load(std::memory_order_acquire))
+	{
+		LogError("UpdateTilePrefetch: plugin not initialized");
+		return 0;
+	}
+
+	try
+	{
+		if (!resource)
+		{
+			LogError("UpdateTilePrefetch: null resource");
+			return 0;
+		}
+
+		std::shared_ptr<TilePrefetcher> prefetcher = resource->GetTilePrefetcher();
+		if (!prefetcher)
+		{
+			LogError("UpdateTilePrefetch: prefetching is not enabled for this resource");
+			return 0;
+		}
+
+		std::shared_ptr<ReservedResource> pinned = PinResource(resource);
+		if (!pinned) {
+			return 0;
+		}
+
+		std::vector<PrefetchRequest> queue;
+		prefetcher->Predict(camera,
+			[resource](uint32_t sub, uint32_t x, uint32_t y, uint32_t z) {
+				return resource->IsTileMapped(sub, x, y, z);
+			},
+			queue);
+
+		// Tiles still wanted keep their place and age in the scheduler; a
+		// request that already ran or was drained is simply queued again
+		std::unordered_map<uint64_t, StreamingRequestId> previous = prefetcher->TakeQueuedRequests();
+		const size_t budget = (std::min)(queue.size(), static_cast<size_t>(prefetcher->Settings().maxTilesPerFrame));
+		const float basePriority = prefetcher->Settings().basePriority;
+		UINT queued = 0;
+		for (size_t i = 0; i < budget; ++i) {
+			const PrefetchRequest& request = queue[i];
+			const float priority = basePriority + request.score;
+
+			auto it = previous.find(TilePrefetcher::GetTileKey(request.subresource, request.x, request.y, request.z));
+			if (it != previous.end()) {
+				const StreamingRequestId id = it->second;
+				previous.erase(it);
+				if (m_streamingScheduler.Reprioritize(id, priority)) {
+					prefetcher->SetQueuedRequest(request, id);
+					continue;
+				}
+			}
+
+			// The work pins the volume and holds the prefetcher, and with it
+			// the archive
+			const StreamingRequestId id = EnqueueStreamingWork(pinned, priority, UPLOAD_TILE_SIZE,
+				[this, pinned, prefetcher, request]() {
+					if (pinned->IsTileMapped(request.subresource, request.x, request.y, request.z)) {
+						return true;
+					}
+					bool unavailable = false;
+					if (PrefetchTile(pinned.get(), prefetcher->Source(), request, &unavailable)) {
+						return true;
+					}
+					if (unavailable) {
+						prefetcher->MarkUnavailable(request.subresource, request.x, request.y, request.z);
+					}
+					return false;
+				});
+			if (id == 0) {
+				break;
+			}
+			prefetcher->SetQueuedRequest(request, id);
+			++queued;
+		}
+
+		// The camera moved on from these
+		for (const auto& [key, id] : previous) {
+			m_streamingScheduler.Cancel(id);
+		}
+		return queued;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return 0;
+	}
+}
+
+bool RenderingPlugin::PrefetchTile(
+	ReservedResource* resource,
+	const TilePrefetchSource& source,
+	const PrefetchRequest& request,
+	bool* outUnavailable
+) {
+	*outUnavailable = false;
+
+	if (source.archive)
+	{
+		// Archives usually leave out empty regions, so a missing tile is
+		// expected here rather than an error
+		if (!source.archive->Find(request.subresource, request.x, request.y, request.z))
+		{
+			*outUnavailable = true;
+			return false;
+		}
+		return UploadTileFromArchive(resource, source.archive.get(), request.subresource, request.x, request.y, request.z);
+	}
+
+	std::vector<std::byte> tile(UPLOAD_TILE_SIZE);
+	if (!source.callback(source.userData, request.subresource, request.x, request.y, request.z,
+		tile.data(), static_cast<uint32_t>(UPLOAD_TILE_SIZE)))
+	{
+		*outUnavailable = true;
+		return false;
+	}
+	return UploadDataToTile(resource, request.subresource, request.x, request.y, request.z, tile);
+}
+
+bool RenderingPlugin::EnableResidencyManagement(bool enable)
+{
+	if (!initialized.load(std::memory_order_acquire))
+	{
+		LogError("EnableResidencyManagement: plugin not initialized");
+		return false;
+	}
+
+	try
+	{
+		std::shared_ptr<ResidencyManager> manager;
+		{
+			std::lock_guard<std::mutex> lock(m_residencyMutex);
+			if (enable == (m_residencyManager != nullptr)) {
+				return true;
+			}
+			if (enable) {
+				m_residencyManager = std::make_shared<ResidencyManager>();
+			}
+			else {
+				m_residencyManager.reset();
+			}
+			manager = m_residencyManager;
+		}
+
+		// Tiles mapped before this point are tracked from now on
+		std::lock_guard<std::mutex> lock(m_resourceMutex);
+		for (const std::shared_ptr<ReservedResource>& resource : m_resources.Values()) {
+			resource->SetResidencyManager(manager);
+		}
+		return true;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::AdvanceResidencyFrame()
+{
+	std::shared_ptr<ResidencyManager> residency = GetResidencyManager();
+	if (!residency)
+	{
+		LogError("AdvanceResidencyFrame: residency management is not enabled");
+		return false;
+	}
+
+	residency->AdvanceFrame();
+	return true;
+}
+
+bool RenderingPlugin::MarkTileBoxUsed(
+	ReservedResource* resource,
+	const TileBox& box
+) {
+	std::shared_ptr<ResidencyManager> residency = GetResidencyManager();
+	if (!residency || !resource)
+	{
+		LogError("MarkTileBoxUsed: residency management is not enabled or resource is null");
+		return false;
+	}
+
+	try
+	{
+		// Unmapped tiles in the box are not tracked and are skipped
+		ReservedResource* owner = GetResidencyOwner(resource);
+		for (UINT z = box.startZ; z < box.startZ + box.depth; ++z)
+			for (UINT y = box.startY; y < box.startY + box.height; ++y)
+				for (UINT x = box.startX; x < box.startX + box.width; ++x)
+					residency->Touch({ owner, box.subResource, x, y, z });
+		return true;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::PinTileBox(
+	ReservedResource* resource,
+	const TileBox& box,
+	bool pinned
+) {
+	std::shared_ptr<ResidencyManager> residency = GetResidencyManager();
+	if (!residency || !resource)
+	{
+		LogError("PinTileBox: residency management is not enabled or resource is null");
+		return false;
+	}
+
+	try
+	{
+		ReservedResource* owner = GetResidencyOwner(resource);
+		for (UINT z = box.startZ; z < box.startZ + box.depth; ++z)
+			for (UINT y = box.startY; y < box.startY + box.height; ++y)
+				for (UINT x = box.startX; x < box.startX + box.width; ++x)
+					residency->SetPinned({ owner, box.subResource, x, y, z }, pinned);
+		return true;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::SetResidencyPriority(
+	ReservedResource* resource,
+	float weight
+) {
+	std::shared_ptr<ResidencyManager> residency = GetResidencyManager();
+	if (!residency || !resource)
+	{
+		LogError("SetResidencyPriority: residency management is not enabled or resource is null");
+		return false;
+	}
+
+	if (!(weight > 0.0f) || !std::isfinite(weight))
+	{
+		LogError(std::format("SetResidencyPriority: weight must be positive, got {}", weight));
+		return false;
+	}
+
+	try
+	{
+		residency->SetOwnerWeight(GetResidencyOwner(resource), weight);
+		return true;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+StreamingRequestId RenderingPlugin::ScheduleUploadToTile(
+	ReservedResource* resource,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ,
+	const std::span<const std::byte>& sourceData,
+	float priority
+) {
+	if (!initialized.load(std::memory_order_acquire))
+	{
+		LogError("ScheduleUploadToTile: plugin not initialized");
+		return 0;
+	}
+
+	try
+	{
+		if (!resource)
+		{
+			LogError("ScheduleUploadToTile: null resource");
+			return 0;
+		}
+		if (!ValidateSourceSize("ScheduleUploadToTile", resource, sourceData.size_bytes(), 1, 0)) {
+			return 0;
+		}
+
+		// The queued work holds a pin, so the volume outlives a destroy that
+		// races the upload
+		std::shared_ptr<ReservedResource> pinned = PinResource(resource);
+		if (!pinned) {
+			return 0;
+		}
+
+		std::vector<std::byte> data(sourceData.begin(), sourceData.end());
+		return EnqueueStreamingWork(pinned, priority, UPLOAD_TILE_SIZE,
+			[this, pinned, subResource, tileX, tileY, tileZ, data = std::move(data)]() mutable {
+				return UploadDataToTile(pinned.get(), subResource, tileX, tileY, tileZ, data);
+			});
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return 0;
+	}
+}
+
+StreamingRequestId RenderingPlugin::ScheduleUploadToTileBox(
+	ReservedResource* resource,
+	const TileBox& box,
+	const std::span<const std::byte>& sourceData,
+	float priority
+) {
+	if (!initialized.load(std::memory_order_acquire))
+	{
+		LogError("ScheduleUploadToTileBox: plugin not initialized");
+		return 0;
+	}
+
+	try
+	{
+		if (!resource)
+		{
+			LogError("ScheduleUploadToTileBox: null resource");
+			return 0;
+		}
+		if (!ValidateSourceSize("ScheduleUploadToTileBox", resource, sourceData.size_bytes(), box.TileCount(), 0)) {
+			return 0;
+		}
+
+		std::shared_ptr<ReservedResource> pinned = PinResource(resource);
+		if (!pinned) {
+			return 0;
+		}
+
+		std::vector<std::byte> data(sourceData.begin(), sourceData.end());
+		return EnqueueStreamingWork(pinned, priority, box.TileCount() * UPLOAD_TILE_SIZE,
+			[this, pinned, box, data = std::move(data)]() mutable {
+				return UploadDataToTileBox(pinned.get(), box, data);
+			});
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return 0;
+	}
+}
+
+bool RenderingPlugin::ReprioritizeUpload(StreamingRequestId id, float priority)
+{
+	return m_streamingScheduler.Reprioritize(id, priority);
+}
+
+bool RenderingPlugin::CancelUpload(StreamingRequestId id)
+{
+	return m_streamingScheduler.Cancel(id);
+}
+
+bool RenderingPlugin::ConfigureStreaming(
+	UINT64 maxBytesPerFrame,
+	UINT maxOperationsPerFrame,
+	float agingPerFrame
+) {
+	if (maxOperationsPerFrame == 0 || !(agingPerFrame >= 0.0f) || !std::isfinite(agingPerFrame))
+	{
+		LogError(std::format(
+			"ConfigureStreaming: expected at least one operation per frame and a non-negative aging rate, got {} and {}",
+			maxOperationsPerFrame, agingPerFrame));
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_streamingMutex);
+		m_streamingBudget.maxBytes = maxBytesPerFrame;
+		m_streamingBudget.maxOperations = maxOperationsPerFrame;
+	}
+	m_streamingScheduler.SetAgingPerFrame(agingPerFrame);
+	return true;
+}
+
+UINT RenderingPlugin::ProcessStreamingQueue(std::vector<StreamingResult>& outResults)
+{
+	if (!initialized.load(std::memory_order_acquire))
+	{
+		LogError("ProcessStreamingQueue: plugin not initialized");
+		return 0;
+	}
+
+	StreamingBudget budget;
+	{
+		std::lock_guard<std::mutex> lock(m_streamingMutex);
+		budget = m_streamingBudget;
+	}
+
+	// Drained work keeps its volume pinned until this returns, so a volume
+	// destroyed meanwhile is torn down after its last upload here
+	std::vector<ScheduledWork> work;
+	m_streamingScheduler.Drain(budget, work);
+
+	// Each upload logs its own failure; a throw here only loses that request
+	for (ScheduledWork& item : work) {
+		bool succeeded = false;
+		try {
+			succeeded = item.work();
+		}
+		catch (const std::exception& ex) {
+			LogError(ex.what());
+		}
+		outResults.push_back({ item.id, succeeded });
+	}
+	return static_cast<UINT>(work.size());
+}
+
+bool RenderingPlugin::EnableResidencySolver(
+	ReservedResource* resource,
+	const ResidencySolverSettings& settings
+) {
+	if (!initialized.load(std::memory_order_acquire))
+	{
+		LogError("EnableResidencySolver: plugin not initialized");
+		return false;
+	}
+
+	try
+	{
+		if (!resource)
+		{
+			LogError("EnableResidencySolver: null resource");
+			return false;
+		}
+
+		const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+		if (settings.mipRadii.empty() || settings.mipRadii.size() > tilingInfo.NumStandardMips)
+		{
+			LogError(std::format(
+				"EnableResidencySolver: expected 1 to {} mip radii, got {}",
+				tilingInfo.NumStandardMips, settings.mipRadii.size()));
+			return false;
+		}
+
+		for (int a = 0; a < 3; ++a) {
+			if (!(settings.boundsMax[a] > settings.boundsMin[a]))
+			{
+				LogError("EnableResidencySolver: volume bounds are empty");
+				return false;
+			}
+		}
+
+		ResidencySolverSettings resolved = settings;
+		resolved.volumeSize[0] = resource->width;
+		resolved.volumeSize[1] = resource->height;
+		resolved.volumeSize[2] = resource->depth;
+
+		auto solver = std::make_shared<ResidencySolver>(tilingInfo, resolved);
+		solver->SetMappingGeneration(resource->GetUnmapGeneration());
+		resource->SetResidencySolver(std::move(solver));
+		return true;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::DisableResidencySolver(ReservedResource* resource)
+{
+	if (!resource)
+	{
+		LogError("DisableResidencySolver: null resource");
+		return false;
+	}
+
+	resource->SetResidencySolver(nullptr);
+	return true;
+}
+
+bool RenderingPlugin::SolveResidency(
+	ReservedResource* resource,
+	const float cameraPosition[3],
+	bool applyUnmaps,
+	ResidencyWorkList& outWork
+) {
+	if (!initialized.load(std::memory_order_acquire))
+	{
+		LogError("SolveResidency: plugin not initialized");
+		return false;
+	}
+
+	try
+	{
+		if (!resource)
+		{
+			LogError("SolveResidency: null resource");
+			return false;
+		}
+
+		std::shared_ptr<ResidencySolver> solver = resource->GetResidencySolver();
+		if (!solver)
+		{
+			LogError("SolveResidency: residency solving is not enabled for this resource");
+			return false;
+		}
+
+		std::lock_guard<std::mutex> solveLock(m_solverMutex);
+
+		// Tiles the solver still counts as mapped may have been evicted or
+		// unmapped by the caller since; if anything was unmapped that the
+		// solver did not ask for, look every desired tile up again
+		const UINT64 generation = resource->GetUnmapGeneration();
+		const bool recheckMapped = generation != solver->MappingGeneration();
+
+		const size_t firstUnmap = outWork.unmaps.size();
+		solver->Solve(cameraPosition,
+			[resource](uint32_t sub, uint32_t x, uint32_t y, uint32_t z) {
+				return resource->IsTileMapped(sub, x, y, z);
+			},
+			recheckMapped,
+			outWork);
+
+		UINT64 expected = generation;
+		if (applyUnmaps && outWork.unmaps.size() > firstUnmap)
+		{
+			std::vector<ResidentTile> tiles;
+			tiles.reserve(outWork.unmaps.size() - firstUnmap);
+			for (size_t i = firstUnmap; i < outWork.unmaps.size(); ++i) {
+				const SolverTile& tile = outWork.unmaps[i];
+				tiles.push_back({ resource, tile.subresource, tile.x, tile.y, tile.z });
+			}
+
+			std::lock_guard<std::mutex> lock(m_mappingMutex);
+			expected += EvictTilesLocked(tiles);
+		}
+
+		// Anything unmapped by others from here on moves the generation past
+		// this baseline and triggers a recheck next time
+		solver->SetMappingGeneration(expected);
+		return true;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::EnableUsageFeedback(ReservedResource* resource)
+{
+	if (!initialized.load(std::memory_order_acquire))
+	{
+		LogError("EnableUsageFeedback: plugin not initialized");
+		return false;
+	}
+
+	try
+	{
+		if (!resource)
+		{
+			LogError("EnableUsageFeedback: null resource");
+			return false;
+		}
+
+		resource->SetUsageFeedback(std::make_shared<UsageFeedback>(resource->GetTilingInfo()));
+		return true;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::DisableUsageFeedback(ReservedResource* resource)
+{
+	if (!resource)
+	{
+		LogError("DisableUsageFeedback: null resource");
+		return false;
+	}
+
+	resource->SetUsageFeedback(nullptr);
+	return true;
+}
+
+UINT64 RenderingPlugin::GetUsageFeedbackSize(ReservedResource* resource, FeedbackFormat format)
+{
+	if (!resource)
+	{
+		LogError("GetUsageFeedbackSize: null resource");
+		return 0;
+	}
+
+	std::shared_ptr<UsageFeedback> feedback = resource->GetUsageFeedback();
+	if (!feedback)
+	{
+		LogError("GetUsageFeedbackSize: usage feedback is not enabled for this resource");
+		return 0;
+	}
+	return feedback->GetBufferSize(format);
+}
+
+bool RenderingPlugin::ProcessUsageFeedback(
+	ReservedResource* resource,
+	FeedbackFormat format,
+	const void* data,
+	size_t size,
+	UINT idleFrames,
+	FeedbackWork& outWork
+) {
+	if (!initialized.load(std::memory_order_acquire))
+	{
+		LogError("ProcessUsageFeedback: plugin not initialized");
+		return false;
+	}
+
+	try
+	{
+		if (!resource || !data)
+		{
+			LogError("ProcessUsageFeedback: null resource or data");
+			return false;
+		}
+
+		if (format != FeedbackFormat::TileBitmask && format != FeedbackFormat::MinMipGrid)
+		{
+			LogError(std::format("ProcessUsageFeedback: unknown format {}", static_cast<UINT>(format)));
+			return false;
+		}
+
+		std::shared_ptr<UsageFeedback> feedback = resource->GetUsageFeedback();
+		if (!feedback)
+		{
+			LogError("ProcessUsageFeedback: usage feedback is not enabled for this resource");
+			return false;
+		}
+
+		std::vector<FeedbackTile> mappedTiles;
+		resource->GetMappedStandardTiles(mappedTiles);
+
+		std::vector<FeedbackTile> usedMapped;
+		if (!feedback->Process(format, data, size, mappedTiles, idleFrames, usedMapped, outWork))
+		{
+			LogError(std::format(
+				"ProcessUsageFeedback: expected {} bytes, got {}",
+				feedback->GetBufferSize(format), size));
+			return false;
+		}
+
+		// Occluded tiles are never touched, so LRU eviction picks them first.
+		// A set member's tiles are tracked under the set's primary.
+		if (std::shared_ptr<ResidencyManager> residency = GetResidencyManager())
+		{
+			ReservedResource* owner = GetResidencyOwner(resource);
+			for (const FeedbackTile& tile : usedMapped) {
+				residency->Touch({ owner, tile.subresource, tile.x, tile.y, tile.z });
+			}
+		}
+		return true;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::EnableResidencyMap(ReservedResource* resource)
+{
+	if (!initialized.load(std::memory_order_acquire))
+	{
+		LogError("EnableResidencyMap: plugin not initialized");
+		return false;
+	}
+
+	try
+	{
+		if (!resource)
+		{
+			LogError("EnableResidencyMap: null resource");
+			return false;
+		}
+		if (!s_Device)
+		{
+			LogError("EnableResidencyMap: the residency map texture needs a D3D12 device");
+			return false;
+		}
+
+		auto map = std::make_shared<ResidencyMap>(resource->GetTilingInfo());
+		const uint32_t* size = map->Size();
+
+		D3D12_HEAP_PROPERTIES heapProps = {};
+		heapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+		D3D12_RESOURCE_DESC desc = {};
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+		desc.Width = size[0];
+		desc.Height = size[1];
+		desc.DepthOrArraySize = static_cast<UINT16>(size[2]);
+		desc.MipLevels = 1;
+		desc.Format = DXGI_FORMAT_R8_UINT;
+		desc.SampleDesc.Count = 1;
+		desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+		Microsoft::WRL::ComPtr<ID3D12Resource> texture;
+		HRESULT hr = s_Device->CreateCommittedResource(
+			&heapProps,
+			D3D12_HEAP_FLAG_NONE,
+			&desc,
+			D3D12_RESOURCE_STATE_COMMON,
+			nullptr,
+			IID_PPV_ARGS(&texture)
+		);
+		if (FAILED(hr))
+		{
+			LogError(std::format("EnableResidencyMap: texture creation failed: 0x{:08x}", hr));
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mappingMutex);
+		resource->SetResidencyMap(map, texture);
+
+		// Whatever is mapped already has been uploaded
+		map->PublishMapped();
+		return FlushResidencyMap(resource);
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::DisableResidencyMap(ReservedResource* resource)
+{
+	if (!resource)
+	{
+		LogError("DisableResidencyMap: null resource");
+		return false;
+	}
+
+	Microsoft::WRL::ComPtr<ID3D12Resource> texture;
+	{
+		std::lock_guard<std::mutex> lock(m_mappingMutex);
+		texture = resource->GetResidencyMapTexture();
+		resource->SetResidencyMap(nullptr, nullptr);
+	}
+
+	// Release the texture only once copies into it are done
+	UINT64 lastCopy;
+	{
+		std::lock_guard<std::mutex> lock(m_submitMutex);
+		lastCopy = m_fenceValue;
+	}
+	if (texture && m_backend) {
+		m_backend->WaitForFence(lastCopy);
+	}
+	return true;
+}
+
+bool RenderingPlugin::UpdateResidencyMap(ReservedResource* resource)
+{
+	if (!initialized.load(std::memory_order_acquire))
+	{
+		LogError("UpdateResidencyMap: plugin not initialized");
+		return false;
+	}
+
+	try
+	{
+		if (!resource)
+		{
+			LogError("UpdateResidencyMap: null resource");
+			return false;
+		}
+
+		std::shared_ptr<ResidencyMap> map = resource->GetResidencyMap();
+		if (!map)
+		{
+			LogError("UpdateResidencyMap: residency map is not enabled for this resource");
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mappingMutex);
+		map->PublishMapped();
+		return FlushResidencyMap(resource);
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::FlushResidencyMap(ReservedResource* resource)
+{
+	std::shared_ptr<ResidencyMap> map = resource->GetResidencyMap();
+	ID3D12Resource* texture = resource->GetResidencyMapTexture();
+	if (!map || !texture || !map->HasChanges()) {
+		return true;
+	}
+
+	// One footprint per brick. A brick's rows fill a whole pitch-aligned
+	// row, and its size keeps every footprint placement aligned.
+	constexpr UINT rowPitch = D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
+	constexpr UINT64 brickStride = static_cast<UINT64>(rowPitch) * ResidencyMap::BRICK_SIZE[1] * ResidencyMap::BRICK_SIZE[2];
+	static_assert(ResidencyMap::BRICK_SIZE[0] <= rowPitch);
+	static_assert(brickStride % D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT == 0);
+	constexpr size_t maxBricks = static_cast<size_t>(BATCH_UPLOAD_BYTE_SIZE / brickStride);
+
+	std::vector<ResidencyMapRegion> regions;
+	std::vector<uint8_t> cells;
+	std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints;
+	std::vector<UINT> targetOffsets;
+
+	for (;;) {
+		regions.clear();
+		cells.clear();
+		const size_t brickCount = map->TakeChanges(maxBricks, regions, cells);
+		if (brickCount == 0) {
+			return true;
+		}
+
+		RingSlotLease slot(*this);
+		std::byte* staging = m_batchUploadBufferData[slot.Index()];
+		footprints.resize(brickCount);
+		targetOffsets.resize(brickCount * 3);
+
+		const uint8_t* source = cells.data();
+		for (size_t i = 0; i < brickCount; ++i) {
+			const ResidencyMapRegion& region = regions[i];
+			const UINT width = region.max[0] - region.min[0];
+			const UINT height = region.max[1] - region.min[1];
+			const UINT depth = region.max[2] - region.min[2];
+
+			D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = footprints[i];
+			footprint.Offset = i * brickStride;
+			footprint.Footprint.Format = DXGI_FORMAT_R8_UINT;
+			footprint.Footprint.Width = width;
+			footprint.Footprint.Height = height;
+			footprint.Footprint.Depth = depth;
+			footprint.Footprint.RowPitch = rowPitch;
+
+			for (UINT row = 0; row < height * depth; ++row) {
+				memcpy(staging + footprint.Offset + static_cast<UINT64>(row) * rowPitch, source, width);
+				source += width;
+			}
+
+			targetOffsets[3 * i + 0] = region.min[0];
+			targetOffsets[3 * i + 1] = region.min[1];
+			targetOffsets[3 * i + 2] = region.min[2];
+		}
+
+		UploadSubmission submission = {};
+		submission.resource = resource;
+		submission.sourceBuffer = StagingBuffer::Batch;
+		submission.sourceOffset = 0;
+		submission.slotIndex = slot.Index();
+		submission.footprints = footprints.data();
+		submission.footprintCount = static_cast<UINT>(brickCount);
+		submission.footprintTarget = texture;
+		submission.targetOffsets = targetOffsets.data();
+
+		slot.HandOff();
+		if (!SubmitUpload(submission)) {
+			// The taken bricks never reached the texture
+			map->MarkAllChanged();
+			LogError("FlushResidencyMap: failed to upload residency map changes");
+			return false;
+		}
+	}
+}
+
+bool RenderingPlugin::UploadGeneratedMips(
+	ReservedResource* resource,
+	std::vector<GeneratedMipTile>& tiles,
+	UINT64* outCompletionFence
+) {
+	bool success = true;
+	for (GeneratedMipTile& tile : tiles)
+	{
+		if (!UploadSingleTile(resource, tile.subresource, tile.x, tile.y, tile.z,
+			MakeLinearStagingFill(resource, tile.data.data()), outCompletionFence))
 		{
-			UINT i = 0;
-			for (UINT z = box.startZ; z < box.startZ + box.depth; ++z)
-				for (UINT y = box.startY; y < box.startY + box.height; ++y)
-					for (UINT x = box.startX; x < box.startX + box.width; ++x)
-						resource->RegisterMappedTile(
-							box.subResource, x, y, z,
-							alloc.heapOffsetInTiles + i++);
+			LogError(std::format(
+				"Mip generation: failed to upload tile ({}, {}, {}) of subresource {}",
+				tile.x, tile.y, tile.z, tile.subresource));
+			success = false;
 		}
+	}
+	return success;
+}
+
+bool RenderingPlugin::SetMipGenerationMode(
+	ReservedResource* resource,
+	MipFilter filter
+) {
+	if (!initialized.load(std::memory_order_acquire))
+	{
+		LogError("SetMipGenerationMode: plugin not initialized");
+		return false;
+	}
 
-		// Acquire ring slot for the copy
-		UINT allocatorIndex;
-		ID3D12CommandAllocator* cmdAllocator =
-			GetAvailableAllocator(allocatorIndex);
-		if (!cmdAllocator || !EnsureCommandListExists(cmdAllocator))
+	try
+	{
+		if (!resource)
 		{
-			RollbackTileBoxMapping(
-				resource, box, alloc.heapOffsetInTiles, tileCount);
+			LogError("SetMipGenerationMode: null resource");
 			return false;
 		}
 
-		// Fill batch upload buffer
-		ID3D12Resource* batchBuffer =
-			m_batchUploadBuffers[allocatorIndex].Get();
-		if (!batchBuffer)
+		if (filter == MipFilter::None)
 		{
-			RollbackTileBoxMapping(
-				resource, box, alloc.heapOffsetInTiles, tileCount);
+			resource->SetMipChainBuilder(nullptr);
+			return true;
+		}
+
+		const ResourceTilingInfo& tilingInfo = resource->GetTilingInfo();
+		if (tilingInfo.NumStandardMips < 2)
+		{
+			LogError("SetMipGenerationMode: resource has no tiled mips above mip 0");
 			return false;
 		}
 
+		MipDownsampleKernel kernel = GetMipDownsampleKernel(
+			resource->textureFormat,
+			GetBytesPerPixel(resource->textureFormat),
+			filter);
+		if (!kernel)
 		{
-			void* mapped = nullptr;
-			HRESULT hr = batchBuffer->Map(0, nullptr, &mapped);
-			if (FAILED(hr) || !mapped)
-			{
-				LogError(std::format(
-					"UploadDataToTileBox: Map failed 0x{:08x}", hr));
-				RollbackTileBoxMapping(
-					resource, box, alloc.heapOffsetInTiles, tileCount);
-				return false;
-			}
-			memcpy(mapped, sourceData.data(), sourceData.size_bytes());
-			batchBuffer->Unmap(0, nullptr);
-		}
-
-		// Copy entire box with one CopyTiles call
-		{
-			D3D12_TILED_RESOURCE_COORDINATE startCoord = {};
-			startCoord.X = box.startX;
-			startCoord.Y = box.startY;
-			startCoord.Z = box.startZ;
-			startCoord.Subresource = box.subResource;
-
-			D3D12_TILE_REGION_SIZE regionSize = {};
-			regionSize.NumTiles = tileCount;
-			regionSize.UseBox = TRUE;
-			regionSize.Width = box.width;
-			regionSize.Height = box.height;
-			regionSize.Depth = box.depth;
-
-			m_uploadCommandList->CopyTiles(
-				resource->D3D12Resource.Get(),
-				&startCoord,
-				&regionSize,
-				batchBuffer,
-				0,
-				D3D12_TILE_COPY_FLAG_LINEAR_BUFFER_TO_SWIZZLED_TILED_RESOURCE
-			);
+			LogError(std::format(
+				"SetMipGenerationMode: filter {} is not supported for format {}",
+				static_cast<UINT>(filter), static_cast<UINT>(resource->textureFormat)));
+			return false;
 		}
 
-		HRESULT hr = m_uploadCommandList->Close();
-		if (FAILED(hr))
+		std::shared_ptr<MipChainBuilder> builder = std::make_shared<MipChainBuilder>(
+			tilingInfo, kernel, static_cast<uint32_t>(UPLOAD_TILE_SIZE));
+
+		// CreateVolumeSet refuses volumes with a builder under the same lock
+		std::lock_guard<std::mutex> lock(m_mappingMutex);
+		if (RejectSetMember("SetMipGenerationMode", resource))
 		{
-			LogError("UploadDataToTileBox: cmdList->Close failed");
-			RollbackTileBoxMapping(
-				resource, box, alloc.heapOffsetInTiles, tileCount);
 			return false;
 		}
+		resource->SetMipChainBuilder(std::move(builder));
+		return true;
+	}
+	catch (const std::exception& ex)
+	{
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::UploadSwizzledDataToTile(
+	ReservedResource* resource,
+	UINT subResource,
+	UINT tileX, UINT tileY, UINT tileZ,
+	const std::span<std::byte>& sourceData
+) {
+	if (!resource || !resource->IsStandardSwizzle())
+	{
+		LogError("UploadSwizzledDataToTile: resource was not created with standard swizzle");
+		return false;
+	}
+
+	if (!ValidateSourceSize("UploadSwizzledDataToTile", resource, sourceData.size_bytes(), 1, 0)) {
+		return false;
+	}
+
+	// Already in the resource's layout: stage as a raw page
+	StagingFill fill = [&sourceData](std::byte* destination, UINT, UINT) {
+		memcpy(destination, sourceData.data(), UPLOAD_TILE_SIZE);
+	};
+	if (!UploadSingleTile(resource, subResource, tileX, tileY, tileZ, fill, nullptr)) {
+		return false;
+	}
+
+	try {
+		std::shared_ptr<MipChainBuilder> builder = resource->GetMipChainBuilder();
+		if (!builder) {
+			return true;
+		}
+
+		// The mip kernels work on linear tiles
+		std::vector<std::byte> linear(UPLOAD_TILE_SIZE);
+		UnswizzleTile(sourceData.data(), linear.data(), resource->GetSwizzlePattern());
+
+		std::vector<GeneratedMipTile> generated;
+		builder->AddTile(subResource, tileX, tileY, tileZ, linear.data(), generated);
+		return UploadGeneratedMips(resource, generated, nullptr);
+	}
+	catch (const std::exception& ex) {
+		LogError(ex.what());
+		return false;
+	}
+}
+
+bool RenderingPlugin::SwizzleTileData(
+	const ReservedResource* resource,
+	const std::span<const std::byte>& linearData,
+	const std::span<std::byte>& swizzledData
+) {
+	if (!resource || !resource->IsStandardSwizzle())
+	{
+		LogError("SwizzleTileData: resource was not created with standard swizzle");
+		return false;
+	}
+
+	if (linearData.size_bytes() != UPLOAD_TILE_SIZE || swizzledData.size_bytes() != UPLOAD_TILE_SIZE)
+	{
+		LogError(std::format(
+			"SwizzleTileData: expected {} bytes in and out, got {} and {}",
+			UPLOAD_TILE_SIZE, linearData.size_bytes(), swizzledData.size_bytes()));
+		return false;
+	}
+
+	SwizzleTile(linearData.data(), swizzledData.data(), resource->GetSwizzlePattern());
+	return true;
+}
 
+bool RenderingPlugin::GetStandardSwizzlePattern(
+	DXGI_FORMAT format,
+	const ResourceTilingInfo& tilingInfo,
+	SwizzlePattern* outPattern
+) {
+	const UINT bytesPerPixel = GetBytesPerPixel(format);
+
+	{
+		std::lock_guard<std::mutex> lock(m_swizzleMutex);
+		auto it = m_swizzlePatterns.find(bytesPerPixel);
+		if (it != m_swizzlePatterns.end())
 		{
-			ID3D12CommandQueue* queue = s_D3D12->GetCommandQueue();
-			ID3D12CommandList* lists[] = { m_uploadCommandList.Get() };
-			queue->ExecuteCommandLists(1, lists);
+			*outPattern = it->second;
+			return true;
+		}
+	}
+
+	// Calibration waits on a GPU fence, so it runs without m_swizzleMutex;
+	// racing first creates for one texel size each calibrate and the first
+	// pattern stored wins (they are identical).
+	SwizzlePattern pattern;
+	if (!CalibrateStandardSwizzle(format, tilingInfo, &pattern))
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_swizzleMutex);
+	*outPattern = m_swizzlePatterns.try_emplace(bytesPerPixel, pattern).first->second;
+	return true;
+}
+
+bool RenderingPlugin::CalibrateStandardSwizzle(
+	DXGI_FORMAT format,
+	const ResourceTilingInfo& tilingInfo,
+	SwizzlePattern* outPattern
+) {
+	const UINT bytesPerPixel = GetBytesPerPixel(format);
+	const UINT tileWidth = tilingInfo.TileWidthInTexels;
+	const UINT tileHeight = tilingInfo.TileHeightInTexels;
+	const UINT tileDepth = tilingInfo.TileDepthInTexels;
+	const UINT addressBits = static_cast<UINT>(std::countr_zero(UPLOAD_TILE_SIZE / bytesPerPixel));
+
+	D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+	HRESULT hr = s_Device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options));
+	if (FAILED(hr) || options.ResourceHeapTier < D3D12_RESOURCE_HEAP_TIER_2)
+	{
+		LogError("CalibrateStandardSwizzle: resource heap tier 2 is required");
+		return false;
+	}
+
+	// One 64KB heap holding the texture and a buffer over the same bytes
+	D3D12_HEAP_DESC heapDesc = {};
+	heapDesc.SizeInBytes = UPLOAD_TILE_SIZE;
+	heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+	heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES;
+
+	Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+	hr = s_Device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap));
+	if (FAILED(hr))
+	{
+		LogError(std::format("CalibrateStandardSwizzle: CreateHeap failed: 0x{:08x}", hr));
+		return false;
+	}
+
+	D3D12_RESOURCE_DESC textureDesc = {};
+	textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+	textureDesc.Width = tileWidth;
+	textureDesc.Height = tileHeight;
+	textureDesc.DepthOrArraySize = static_cast<UINT16>(tileDepth);
+	textureDesc.MipLevels = 1;
+	textureDesc.Format = format;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.Layout = D3D12_TEXTURE_LAYOUT_64KB_STANDARD_SWIZZLE;
+
+	D3D12_RESOURCE_DESC bufferDesc = {};
+	bufferDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	bufferDesc.Width = UPLOAD_TILE_SIZE;
+	bufferDesc.Height = 1;
+	bufferDesc.DepthOrArraySize = 1;
+	bufferDesc.MipLevels = 1;
+	bufferDesc.Format = DXGI_FORMAT_UNKNOWN;
+	bufferDesc.SampleDesc.Count = 1;
+	bufferDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+	Microsoft::WRL::ComPtr<ID3D12Resource> texture;
+	Microsoft::WRL::ComPtr<ID3D12Resource> aliasBuffer;
+	hr = s_Device->CreatePlacedResource(heap.Get(), 0, &textureDesc,
+		D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&texture));
+	if (SUCCEEDED(hr))
+	{
+		hr = s_Device->CreatePlacedResource(heap.Get(), 0, &bufferDesc,
+			D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&aliasBuffer));
+	}
+	if (FAILED(hr))
+	{
+		LogError(std::format("CalibrateStandardSwizzle: CreatePlacedResource failed: 0x{:08x}", hr));
+		return false;
+	}
+
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+	UINT rowCount;
+	UINT64 rowSize;
+	UINT64 uploadSize;
+	s_Device->GetCopyableFootprints(&textureDesc, 0, 1, 0, &footprint, &rowCount, &rowSize, &uploadSize);
+
+	D3D12_HEAP_PROPERTIES uploadHeapProps = {};
+	uploadHeapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+	D3D12_HEAP_PROPERTIES readbackHeapProps = {};
+	readbackHeapProps.Type = D3D12_HEAP_TYPE_READBACK;
+
+	Microsoft::WRL::ComPtr<ID3D12Resource> uploadBuffer;
+	Microsoft::WRL::ComPtr<ID3D12Resource> readbackBuffer;
+	D3D12_RESOURCE_DESC uploadDesc = bufferDesc;
+	uploadDesc.Width = uploadSize;
+	hr = s_Device->CreateCommittedResource(&uploadHeapProps, D3D12_HEAP_FLAG_NONE, &uploadDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&uploadBuffer));
+	if (SUCCEEDED(hr))
+	{
+		hr = s_Device->CreateCommittedResource(&readbackHeapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc,
+			D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&readbackBuffer));
+	}
+	if (FAILED(hr))
+	{
+		LogError(std::format("CalibrateStandardSwizzle: staging buffer creation failed: 0x{:08x}", hr));
+		return false;
+	}
+
+	Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList;
+	Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+	hr = s_Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator));
+	if (SUCCEEDED(hr))
+	{
+		hr = s_Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, allocator.Get(), nullptr, IID_PPV_ARGS(&commandList));
+	}
+	if (SUCCEEDED(hr))
+	{
+		hr = s_Device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence));
+	}
+	if (FAILED(hr))
+	{
+		LogError(std::format("CalibrateStandardSwizzle: command list creation failed: 0x{:08x}", hr));
+		return false;
+	}
+
+	// Every texel holds its own linear index. 8-bit texels cannot hold a
+	// 16-bit index, so they take one pass per index byte.
+	const UINT passCount = bytesPerPixel >= 2 ? 1 : 2;
+	const UINT valueBytes = (std::min)(bytesPerPixel, 4u);
+	const UINT64 slicePitch = static_cast<UINT64>(footprint.Footprint.RowPitch) * rowCount;
+	std::vector<uint32_t> linearIndexAtBit(addressBits, 0);
 
-			const UINT64 nextFenceValue = ++m_fenceValue;
-			hr = queue->Signal(m_uploadFence.Get(), nextFenceValue);
-			if (FAILED(hr))
+	for (UINT pass = 0; pass < passCount; ++pass)
+	{
+		std::byte* mapped = nullptr;
+		hr = uploadBuffer->Map(0, nullptr, reinterpret_cast<void**>(&mapped));
+		if (FAILED(hr) || !mapped)
+		{
+			LogError("CalibrateStandardSwizzle: failed to map upload buffer");
+			return false;
+		}
+		for (UINT z = 0; z < tileDepth; ++z)
+			for (UINT y = 0; y < tileHeight; ++y)
 			{
-				LogError("UploadDataToTileBox: queue->Signal failed");
-				RollbackTileBoxMapping(
-					resource, box, alloc.heapOffsetInTiles, tileCount);
-				return false;
+				std::byte* row = mapped + footprint.Offset + z * slicePitch + y * footprint.Footprint.RowPitch;
+				memset(row, 0, static_cast<size_t>(tileWidth) * bytesPerPixel);
+				for (UINT x = 0; x < tileWidth; ++x)
+				{
+					const uint32_t value = (x + tileWidth * (y + tileHeight * z)) >> (8 * pass);
+					memcpy(row + static_cast<size_t>(x) * bytesPerPixel, &value, valueBytes);
+				}
 			}
+		uploadBuffer->Unmap(0, nullptr);
 
-			m_allocatorFenceValues[allocatorIndex] = nextFenceValue;
+		if (pass > 0)
+		{
+			allocator->Reset();
+			commandList->Reset(allocator.Get(), nullptr);
 		}
 
-		return true;
+		D3D12_TEXTURE_COPY_LOCATION dst = {};
+		dst.pResource = texture.Get();
+		dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+		dst.SubresourceIndex = 0;
+
+		D3D12_TEXTURE_COPY_LOCATION src = {};
+		src.pResource = uploadBuffer.Get();
+		src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+		src.PlacedFootprint = footprint;
+
+		commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+
+		D3D12_RESOURCE_BARRIER barrier = {};
+		barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+		barrier.Aliasing.pResourceBefore = texture.Get();
+		barrier.Aliasing.pResourceAfter = aliasBuffer.Get();
+		commandList->ResourceBarrier(1, &barrier);
+
+		commandList->CopyBufferRegion(readbackBuffer.Get(), 0, aliasBuffer.Get(), 0, UPLOAD_TILE_SIZE);
+
+		barrier.Aliasing.pResourceBefore = aliasBuffer.Get();
+		barrier.Aliasing.pResourceAfter = texture.Get();
+		commandList->ResourceBarrier(1, &barrier);
+
+		hr = commandList->Close();
+		if (FAILED(hr))
+		{
+			LogError("CalibrateStandardSwizzle: cmdList->Close failed");
+			return false;
+		}
+
+		ID3D12CommandQueue* queue = s_D3D12->GetCommandQueue();
+		ID3D12CommandList* lists[] = { commandList.Get() };
+		queue->ExecuteCommandLists(1, lists);
+		queue->Signal(fence.Get(), pass + 1);
+		fence->SetEventOnCompletion(pass + 1, nullptr);
+
+		void* readbackData = nullptr;
+		D3D12_RANGE readRange = { 0, static_cast<SIZE_T>(UPLOAD_TILE_SIZE) };
+		hr = readbackBuffer->Map(0, &readRange, &readbackData);
+		if (FAILED(hr) || !readbackData)
+		{
+			LogError("CalibrateStandardSwizzle: failed to map readback buffer");
+			return false;
+		}
+		const std::byte* readback = static_cast<const std::byte*>(readbackData);
+		for (UINT k = 0; k < addressBits; ++k)
+		{
+			uint32_t value = 0;
+			memcpy(&value, readback + (static_cast<size_t>(1) << k) * bytesPerPixel, valueBytes);
+			if (passCount > 1)
+			{
+				value &= 0xFF;
+			}
+			linearIndexAtBit[k] |= value << (8 * pass);
+		}
+		D3D12_RANGE writtenRange = { 0, 0 };
+		readbackBuffer->Unmap(0, &writtenRange);
 	}
-	catch (const std::exception& ex)
+
+	if (!BuildSwizzlePattern(linearIndexAtBit.data(), bytesPerPixel, tileWidth, tileHeight, tileDepth, outPattern))
 	{
-		LogError(ex.what());
+		LogError(std::format(
+			"CalibrateStandardSwizzle: layout for {} bytes/texel is not a bit interleave",
+			bytesPerPixel));
 		return false;
 	}
+
+	Log(std::format(
+		"Standard swizzle for {} bytes/texel: x mask {:#06x}, y mask {:#06x}, z mask {:#06x}",
+		bytesPerPixel, outPattern->xMask, outPattern->yMask, outPattern->zMask));
+	return true;
 }
 
 std::vector<DiagnosticResult> RenderingPlugin::RunDiagnostics(bool includeSmokeTest)
 {
+	if (!s_Device || !m_backend)
+	{
+		LogError("RunDiagnostics: no D3D12 device");
+		return {};
+	}
+
 	Log("Running diagnostics...");
 
 	ID3D12Resource* rawBuffers[ALLOCATOR_POOL_SIZE];
 	for (UINT i = 0; i < ALLOCATOR_POOL_SIZE; ++i)
 	{
-		rawBuffers[i] = m_uploadBuffers[i].Get();
+		rawBuffers[i] = m_backend->GetStagingResource(StagingBuffer::Tile, i);
 	}
 
 	auto results = Diagnostics::RunStartupChecks(
@@ -1054,17 +4816,31 @@ std::vector<DiagnosticResult> RenderingPlugin::RunDiagnostics(bool includeSmokeT
 	{
 		Log("Tier-1 checks passed — running smoke test");
 
+		// The smoke test works on resources; remember their handles
+		auto handles = std::make_shared<std::unordered_map<ReservedResource*, VolumeHandle>>();
+
 		Diagnostics::SmokeTestOps ops;
-		ops.createResource = [this](
+		ops.createResource = [this, handles](
 			UINT w, UINT h, UINT d,
 			bool mips, UINT mipCount,
 			DXGI_FORMAT fmt) -> ReservedResource*
 		{
-			return this->CreateVolumetricResource(w, h, d, mips, mipCount, fmt);
+			VolumeHandle handle = this->CreateVolumetricResource(w, h, d, mips, mipCount, fmt);
+			ReservedResource* resource = this->GetVolumetricResource(handle);
+			if (resource) {
+				(*handles)[resource] = handle;
+			}
+			return resource;
 		};
-		ops.destroyResource = [this](ReservedResource* r) -> bool
+		ops.destroyResource = [this, handles](ReservedResource* r) -> bool
 		{
-			return this->DestroyVolumetricResource(r);
+			auto it = handles->find(r);
+			if (it == handles->end()) {
+				return false;
+			}
+			VolumeHandle handle = it->second;
+			handles->erase(it);
+			return this->DestroyVolumetricResource(handle);
 		};
 		ops.uploadData = [this](
 			ReservedResource* r,
@@ -1083,6 +4859,26 @@ std::vector<DiagnosticResult> RenderingPlugin::RunDiagnostics(bool includeSmokeT
 		{
 			return this->UnmapDataFromTile(r, subRes, tx, ty, tz);
 		};
+		ops.unmapTileBox = [this](
+			ReservedResource* r,
+			UINT subRes,
+			UINT sx, UINT sy, UINT sz,
+			UINT w, UINT h, UINT d) -> bool
+		{
+			TileBox box;
+			box.subResource = subRes;
+			box.startX = sx; box.startY = sy; box.startZ = sz;
+			box.width = w; box.height = h; box.depth = d;
+			return this->UnmapTileBox(r, box);
+		};
+		ops.uploadPackedMips = [this](
+			ReservedResource* r,
+			void* data, UINT size) -> bool
+		{
+			std::span<std::byte> dataSpan(
+				static_cast<std::byte*>(data), size);
+			return this->UploadPackedMips(r, dataSpan);
+		};
 		ops.uploadTileBox = [this](
 			ReservedResource* r,
 			UINT subRes,
@@ -1115,6 +4911,94 @@ std::vector<DiagnosticResult> RenderingPlugin::RunDiagnostics(bool includeSmokeT
 	return results;
 }
 
+bool RenderingPlugin::GetPipelineStats(C_PipelineStats& outStats)
+{
+#if defined(SPARSE_PIPELINE_STATS)
+	m_pipelineStats.Snapshot(outStats);
+	return true;
+#else
+	outStats = {};
+	return false;
+#endif
+}
+
+bool RenderingPlugin::GetPipelineHistogram(
+	PipelineStage stage,
+	UINT64* outBuckets,
+	UINT capacity,
+	UINT* outBucketCount)
+{
+	if (stage >= PipelineStage::Count)
+	{
+		LogError(std::format("GetPipelineHistogram: stage {} out of range", static_cast<UINT>(stage)));
+		return false;
+	}
+#if defined(SPARSE_PIPELINE_STATS)
+	const LatencyHistogram& histogram = m_pipelineStats.Histogram(stage);
+	const UINT count = (std::min)(capacity, LatencyHistogram::BUCKET_COUNT);
+	for (UINT i = 0; i < count && outBuckets; ++i)
+	{
+		outBuckets[i] = histogram.Bucket(i);
+	}
+	if (outBucketCount)
+	{
+		*outBucketCount = LatencyHistogram::BUCKET_COUNT;
+	}
+	return true;
+#else
+	(void)outBuckets;
+	(void)capacity;
+	if (outBucketCount)
+	{
+		*outBucketCount = 0;
+	}
+	return false;
+#endif
+}
+
+void RenderingPlugin::ResetPipelineStats()
+{
+#if defined(SPARSE_PIPELINE_STATS)
+	m_pipelineStats.Reset();
+#endif
+}
+
+bool RenderingPlugin::SetTracingEnabled(bool enabled)
+{
+#if defined(SPARSE_EVENT_TRACE)
+	m_eventTracer.SetEnabled(enabled);
+	return true;
+#else
+	(void)enabled;
+	return false;
+#endif
+}
+
+bool RenderingPlugin::DumpTrace(const char* path)
+{
+	if (!path)
+	{
+		LogError("DumpTrace: null path");
+		return false;
+	}
+#if defined(SPARSE_EVENT_TRACE)
+	if (!m_eventTracer.Dump(path))
+	{
+		LogError(std::format("DumpTrace: failed to write {}", path));
+		return false;
+	}
+	if (m_eventTracer.DroppedEvents() > 0)
+	{
+		Log(std::format("DumpTrace: {} events dropped from threads past the {}-thread limit",
+			m_eventTracer.DroppedEvents(), EventTracer::MAX_THREADS));
+	}
+	return true;
+#else
+	LogError("DumpTrace: built with SPARSE_NO_EVENT_TRACE");
+	return false;
+#endif
+}
+
 void RenderingPlugin::LogDiagnosticResults(
 	const std::vector<DiagnosticResult>& results)
 {
@@ -9,11 +9,28 @@
 #include <vector>
 #include <atomic>
 #include <mutex>
+#include <deque>
+#include <condition_variable>
 #include "IHeap.h"
+#include "GpuBackend.h"
 #include "ReservedResource.h"
 #include "Diagnostics.h"
-#include <wil/resource.h>
+#include "SubmissionQueue.h"
+#include "FormatConversion.h"
+#include "BlockCompression.h"
+#include "WorkerPool.h"
+#include "TileCodec.h"
+#include "TileArchive.h"
+#include "ResidencyManager.h"
+#include "StreamingScheduler.h"
+#include "HandleTable.h"
+#include "VolumeSet.h"
+#include "PipelineStats.h"
+#include "EventTracer.h"
+#include "SparseTextureInterface.h"
 #include <string>
+#include <functional>
+#include <unordered_map>
 
 struct TileMetrics {
 	UINT bytesPerPixel;
@@ -33,19 +50,44 @@ struct TileBox {
 	UINT TileCount() const { return width * height * depth; }
 };
 
+// One box of a multi-resource upload; sourceData is laid out as for
+// UploadDataToTileBox
+struct TileBoxUpload {
+	ReservedResource* resource;
+	TileBox box;
+	std::span<std::byte> sourceData;
+};
+
+// Writes the linear payload for `tileCount` consecutive tiles, starting at
+// tile `firstTile` in the box's x-fastest order, into staging memory.
+using StagingFill = std::function<void(std::byte* destination, UINT firstTile, UINT tileCount)>;
+
 class RenderingPlugin {
 public:
 	RenderingPlugin(IUnityInterfaces* unityInterface);
 
+	// A plugin on a backend of the caller's choosing, ready without
+	// InitializeGraphicsDevice; features that need the Unity device
+	// (standard swizzle, residency map textures, diagnostics) fail on it
+	RenderingPlugin(std::unique_ptr<IGpuBackend> backend, IUnityLog* log);
+
+	// Volumes must not be pinned past this
+	~RenderingPlugin();
+
 	void InitializeGraphicsDevice();
 
-	ReservedResource* CreateVolumetricResource(
+	// flags: VolumeCreateFlags. Standard swizzle needs device support and a
+	// one-time calibration per texel size (see CalibrateStandardSwizzle).
+	// Returns 0 on failure.
+	VolumeHandle CreateVolumetricResource(
 		UINT width, UINT height, UINT depth,
 		bool useMipmaps,
 		UINT mipmapCount,
-		DXGI_FORMAT format
+		DXGI_FORMAT format,
+		UINT flags = VOLUME_CREATE_FLAG_NONE
 	);
 
+	// Caller must hold m_mappingMutex.
 	bool MapTileToHeap(
 		UINT subResource,
 		UINT tileX, UINT tileY, UINT tileZ,
@@ -58,11 +100,51 @@ public:
 		UINT tileX, UINT tileY, UINT tileZ
 	);
 
+	// Null-maps the whole box with one UpdateTileMappings and retires every
+	// mapped tile inside it in one batch. Unmapped tiles are skipped.
+	bool UnmapTileBox(
+		ReservedResource* resource,
+		const TileBox& box
+	);
+
+	// Unmaps every tile of a subresource. Packed mips unmap the whole tail.
+	bool UnmapSubresource(
+		ReservedResource* resource,
+		UINT subResource
+	);
+
+	// Maps the packed mip tail if needed and uploads every packed mip in one
+	// submission. sourceData holds the packed mips back to back, each tightly
+	// packed (row = width * bytesPerPixel, slice = row * height).
+	bool UploadPackedMips(
+		ReservedResource* resource,
+		const std::span<std::byte>& sourceData
+	);
+
+	bool UnmapPackedMips(ReservedResource* resource);
 
+
+	// Caller must hold m_mappingMutex.
 	bool AllocateTileToHeap(UINT* outHeapOffset);
 
+	// Returns retired tiles whose fence has passed to the heap in one pass.
+	// Intended to run once per frame; allocation also calls it on demand.
+	UINT ReleaseRetiredTiles();
+
+	// Blocks until every retired tile has passed its fence, then returns
+	// them to the heap.
+	UINT WaitForRetiredTiles();
+
+	// Tiles retired but not yet past their fence
+	UINT GetRetiredTileCount();
+
+	// Heap tiles free to allocate now, not counting retired ones
+	UINT GetFreeHeapTiles();
+
 	bool GetTiledResourceSupportStatus();
 
+	// With mip generation enabled, also uploads every coarser tile the new
+	// tile completes.
 	bool UploadDataToTile(
 		ReservedResource* resource,
 		UINT subResource,
@@ -70,16 +152,368 @@ public:
 		const std::span<std::byte>& sourceData
 	);
 
+	// Standard-swizzle resources only. sourceData is one tile already in
+	// swizzled order (see SwizzleTileData) and is copied as a raw 64KB page.
+	bool UploadSwizzledDataToTile(
+		ReservedResource* resource,
+		UINT subResource,
+		UINT tileX, UINT tileY, UINT tileZ,
+		const std::span<std::byte>& sourceData
+	);
+
+	// Swizzles one linear tile for a standard-swizzle resource. Touches no
+	// GPU state, so it can run on worker threads ahead of the upload.
+	bool SwizzleTileData(
+		const ReservedResource* resource,
+		const std::span<const std::byte>& linearData,
+		const std::span<std::byte>& swizzledData
+	);
+
+	// Like UploadDataToTile, but the payload is in a compact source format
+	// and is converted to the resource format while staging. palette holds
+	// up to UPLOAD_PALETTE_SIZE destination texels (Palette8 only).
+	bool UploadConvertedDataToTile(
+		ReservedResource* resource,
+		UINT subResource,
+		UINT tileX, UINT tileY, UINT tileZ,
+		const std::span<std::byte>& sourceData,
+		UploadSourceFormat sourceFormat,
+		const std::span<const std::byte>& palette = {}
+	);
+
+	bool UploadConvertedDataToTileBox(
+		ReservedResource* resource,
+		const TileBox& box,
+		const std::span<std::byte>& sourceData,
+		UploadSourceFormat sourceFormat,
+		const std::span<const std::byte>& palette = {},
+		UINT64* outCompletionFence = nullptr
+	);
+
+	// Payloads in the TileCodec wire format: one encoded tile per tile, in
+	// the box's x-fastest order. Tiles are decoded on the staging pool
+	// straight into upload memory.
+	bool UploadEncodedDataToTile(
+		ReservedResource* resource,
+		UINT subResource,
+		UINT tileX, UINT tileY, UINT tileZ,
+		const std::span<const std::byte>& payload
+	);
+
+	bool UploadEncodedDataToTileBox(
+		ReservedResource* resource,
+		const TileBox& box,
+		const std::span<const std::byte>& payload,
+		UINT64* outCompletionFence = nullptr
+	);
+
+	// Appends the smallest TileCodec encoding of one linear tile in the
+	// resource's format.
+	bool EncodeTileData(
+		const ReservedResource* resource,
+		const std::span<const std::byte>& tile,
+		std::vector<std::byte>& outPayload
+	);
+
+	// Tile archives (see TileArchive.h). Close an archive only when no
+	// direct upload from it is in flight; prefetchers hold their own
+	// reference and keep it mapped until they are disabled.
+	TileArchive* OpenTileArchive(const char* utf8Path);
+	bool CloseTileArchive(TileArchive* archive);
+
+	// The owning reference to an open archive, or nullptr if it is not open
+	std::shared_ptr<TileArchive> FindTileArchive(const TileArchive* archive);
+
+	// Streams tiles from the archive mapping straight into staging. Every
+	// tile of the box must be in the archive, baked for the resource's
+	// format.
+	bool UploadTileFromArchive(
+		ReservedResource* resource,
+		TileArchive* archive,
+		UINT subResource,
+		UINT tileX, UINT tileY, UINT tileZ
+	);
+
+	bool UploadTileBoxFromArchive(
+		ReservedResource* resource,
+		TileArchive* archive,
+		const TileBox& box,
+		UINT64* outCompletionFence = nullptr
+	);
+
+	// Bake-time writer for tile archives; FinishTileArchive releases it
+	// whether or not it succeeds.
+	TileArchiveWriter* CreateTileArchiveWriter(const char* utf8Path, DXGI_FORMAT format);
+	bool AddTileToArchive(
+		TileArchiveWriter* writer,
+		UINT subResource,
+		UINT tileX, UINT tileY, UINT tileZ,
+		const std::span<const std::byte>& tileData,
+		bool compress
+	);
+	bool FinishTileArchive(TileArchiveWriter* writer);
+
+	// Camera-driven prefetching (see TilePrefetcher.h). Exactly one of
+	// source.archive and source.callback must be set. Disable prefetching
+	// before closing the archive it reads from.
+	bool EnableTilePrefetch(
+		ReservedResource* resource,
+		const PrefetchSettings& settings,
+		const TilePrefetchSource& source
+	);
+
+	bool DisableTilePrefetch(ReservedResource* resource);
+
+	// Predicts from this frame's camera and keeps up to maxTilesPerFrame of
+	// the most urgent unmapped tiles queued on the streaming scheduler at
+	// basePriority + score: tiles still wanted are reprioritized, tiles no
+	// longer wanted are cancelled. ProcessStreamingQueue runs them and
+	// reports them among its results. Returns the number newly queued.
+	UINT UpdateTilePrefetch(
+		ReservedResource* resource,
+		const PrefetchCamera& camera
+	);
+
+	// Optional LRU residency management (see ResidencyManager.h). While
+	// enabled, an allocation that finds the heap full evicts the least
+	// recently used unpinned tiles instead of failing. Tiles used in the
+	// current frame are not evicted.
+	bool EnableResidencyManagement(bool enable);
+
+	// Call once per frame
+	bool AdvanceResidencyFrame();
+
+	// Marks every mapped tile in the box as used this frame
+	bool MarkTileBoxUsed(
+		ReservedResource* resource,
+		const TileBox& box
+	);
+
+	// Pins apply to tiles that are not mapped yet, too
+	bool PinTileBox(
+		ReservedResource* resource,
+		const TileBox& box,
+		bool pinned
+	);
+
+	// Idle tiles of a resource with weight w outlive weight-1 tiles w times
+	bool SetResidencyPriority(
+		ReservedResource* resource,
+		float weight
+	);
+
+	// Scheduled uploads (see StreamingScheduler.h) wait in a priority queue,
+	// lower priority values first, and run from ProcessStreamingQueue within
+	// the per-frame budget. The payload is copied, so the caller may reuse
+	// its buffer at once. Returns the request id, or 0 on failure.
+	StreamingRequestId ScheduleUploadToTile(
+		ReservedResource* resource,
+		UINT subResource,
+		UINT tileX, UINT tileY, UINT tileZ,
+		const std::span<const std::byte>& sourceData,
+		float priority
+	);
+
+	StreamingRequestId ScheduleUploadToTileBox(
+		ReservedResource* resource,
+		const TileBox& box,
+		const std::span<const std::byte>& sourceData,
+		float priority
+	);
+
+	// Both return false once the request has run or been cancelled
+	bool ReprioritizeUpload(StreamingRequestId id, float priority);
+	bool CancelUpload(StreamingRequestId id);
+
+	// agingPerFrame is subtracted from a queued request's priority for each
+	// frame it waits
+	bool ConfigureStreaming(
+		UINT64 maxBytesPerFrame,
+		UINT maxOperationsPerFrame,
+		float agingPerFrame
+	);
+
+	// Runs this frame's share of the queue on the calling thread and
+	// appends the outcome of every request it ran. Returns the number run.
+	UINT ProcessStreamingQueue(std::vector<StreamingResult>& outResults);
+
+	// Desired-residency solving (see ResidencySolver.h). boundsMin/Max and
+	// mipRadii are in world units; settings.volumeSize is taken from the
+	// resource.
+	bool EnableResidencySolver(
+		ReservedResource* resource,
+		const ResidencySolverSettings& settings
+	);
+
+	bool DisableResidencySolver(ReservedResource* resource);
+
+	// Diffs the tiles the camera wants against what is mapped. With
+	// applyUnmaps set, tiles no longer wanted are unmapped here in one batch
+	// and still reported in outWork.unmaps; the caller uploads
+	// outWork.uploads however it likes (directly, scheduled or from an
+	// archive), since mapping happens as part of every upload.
+	bool SolveResidency(
+		ReservedResource* resource,
+		const float cameraPosition[3],
+		bool applyUnmaps,
+		ResidencyWorkList& outWork
+	);
+
+	// GPU usage feedback (see UsageFeedback.h), read back by the caller
+	bool EnableUsageFeedback(ReservedResource* resource);
+	bool DisableUsageFeedback(ReservedResource* resource);
+
+	// Size in bytes ProcessUsageFeedback expects for format, 0 on error
+	UINT64 GetUsageFeedbackSize(ReservedResource* resource, FeedbackFormat format);
+
+	// Decodes one frame of feedback. Sampled tiles that are mapped count as
+	// used for residency management; the rest are returned as requests.
+	// Mapped tiles not sampled for idleFrames are returned as eviction
+	// candidates. Nothing is mapped or unmapped here.
+	bool ProcessUsageFeedback(
+		ReservedResource* resource,
+		FeedbackFormat format,
+		const void* data,
+		size_t size,
+		UINT idleFrames,
+		FeedbackWork& outWork
+	);
+
+	// Residency map (see ResidencyMap.h): an R8_UINT Texture3D with one
+	// texel per mip 0 tile, for shaders to clamp their LOD with
+	bool EnableResidencyMap(ReservedResource* resource);
+
+	// Unity must have stopped sampling the texture
+	bool DisableResidencyMap(ReservedResource* resource);
+
+	// Call once per frame after the frame's uploads have been submitted:
+	// tiles mapped since the last call enter the map, and every change is
+	// copied to the texture ahead of the frame's rendering
+	bool UpdateResidencyMap(ReservedResource* resource);
+
+	// Opt-in per resource. Once enabled, tile and box uploads downsample
+	// into cached parent tiles and upload each parent as soon as all of its
+	// 2x2x2 children have been uploaded. MipFilter::None disables it.
+	// Volume set members cannot enable it.
+	bool SetMipGenerationMode(
+		ReservedResource* resource,
+		MipFilter filter
+	);
+
+	// Boxes of any size are accepted; anything larger than one staging
+	// buffer is split into slabs that are pipelined across ring slots.
+	// outCompletionFence receives the fence value that retires the whole box.
 	bool UploadDataToTileBox(
 		ReservedResource* resource,
 		const TileBox& box,
-		const std::span<std::byte>& sourceData
+		const std::span<std::byte>& sourceData,
+		UINT64* outCompletionFence = nullptr
 	);
 
-	bool DestroyVolumetricResource(ReservedResource* resource);
+	// Uploads boxes into several resources as one batch, such as the channel
+	// volumes of a streamed chunk. Each resource's boxes are mapped with one
+	// UpdateTileMappings call from a single heap reservation, and the copies
+	// share one ring slot, command list and fence for as long as they fit
+	// one staging buffer; larger batches take one slot per buffer's worth.
+	// Boxes must not overlap each other or mapped tiles. All or nothing: if
+	// any box fails, every box is unmapped again.
+	bool UploadDataToTileBoxes(
+		const std::span<const TileBoxUpload>& uploads,
+		UINT64* outCompletionFence = nullptr
+	);
+
+	// Groups volumes into a lockstep set (see VolumeSet.h). Members must
+	// have no standard tiles mapped and belong to no other set. From then
+	// on their standard tiles are mapped and unmapped only through the set:
+	// per-volume uploads, unmaps and DestroyVolumetricResource fail on a
+	// member. Set uploads do not build CPU mips, so members must not have
+	// mip generation enabled, and enabling it on a member fails. Returns 0
+	// on failure.
+	VolumeSetHandle CreateVolumeSet(std::span<const VolumeHandle> members);
+
+	// Members stand alone again and keep their mapped tiles
+	bool DestroyVolumeSet(VolumeSetHandle handle);
+
+	// nullptr, with an error logged for a non-zero handle, if the set has
+	// been destroyed. The pointer is only good until the set is destroyed;
+	// callers that may race DestroyVolumeSet pin it.
+	VolumeSet* GetVolumeSet(VolumeSetHandle handle);
+
+	// As GetVolumeSet, keeping the set and its members alive while held.
+	// Set calls on a pinned set that has since been destroyed fail.
+	std::shared_ptr<VolumeSet> PinVolumeSet(VolumeSetHandle handle);
+
+	// Maps the box in every member, one heap run per coordinate, and
+	// uploads memberData[i] to member i as one batch (see
+	// UploadDataToTileBoxes). Every coordinate must be unmapped.
+	bool UploadVolumeSetTileBox(
+		VolumeSet* set,
+		const TileBox& box,
+		std::span<const std::span<std::byte>> memberData,
+		UINT64* outCompletionFence = nullptr
+	);
+
+	// Unmaps the box in every member and returns each coordinate's heap run
+	// in one batch. Unmapped coordinates are skipped.
+	bool UnmapVolumeSetTileBox(
+		VolumeSet* set,
+		const TileBox& box
+	);
+
+	// Toroidal addressing for clipmap-style windows (see WrapWindow.h).
+	// The volume must have a single mip and dimensions that are whole
+	// tiles, and must not belong to a set. Enabling starts the window at
+	// world tile (0, 0, 0); mapped tiles are kept either way.
+	bool EnableWrapAddressing(ReservedResource* resource, bool enable);
+
+	// Moves the window by whole tiles. Only the tiles leaving it are
+	// unmapped, in one batch; every other tile keeps its mapping and data.
+	// outEntering receives the physical boxes the entering tiles now
+	// occupy, which the caller uploads with the data for their world
+	// coordinates.
+	bool ScrollVolume(
+		ReservedResource* resource,
+		INT64 dx, INT64 dy, INT64 dz,
+		std::vector<WrapBox>* outEntering = nullptr
+	);
+
+	// Texel offset of the window's first texel in the physical volume, for
+	// shaders to add before wrapping
+	bool GetWrapOffset(ReservedResource* resource, UINT outTexelOffset[3]);
+
+	// nullptr, with an error logged for a non-zero handle, if the volume
+	// has been destroyed. The pointer is only good until the volume is
+	// destroyed; callers that may race DestroyVolumetricResource pin it.
+	ReservedResource* GetVolumetricResource(VolumeHandle handle);
+
+	// As GetVolumetricResource, keeping the volume alive while held
+	std::shared_ptr<ReservedResource> PinVolumetricResource(VolumeHandle handle);
+
+	// The handle stops resolving at once and queued uploads and prefetches
+	// of the volume are cancelled. Its tiles are unmapped and the volume
+	// freed as soon as nothing pins it: here, or when the last call that
+	// pinned it returns.
+	// Never blocks, so it may be called from a streamed upload's callback.
+	bool DestroyVolumetricResource(VolumeHandle handle);
 
 	std::vector<DiagnosticResult> RunDiagnostics(bool includeSmokeTest = false);
 
+	// Pipeline stage latencies and counters since the last reset (see
+	// PipelineStats.h). Both getters fail when stats are compiled out.
+	bool GetPipelineStats(C_PipelineStats& outStats);
+
+	// Copies up to capacity bucket counts; outBucketCount receives the
+	// number of buckets in a full histogram
+	bool GetPipelineHistogram(PipelineStage stage, UINT64* outBuckets, UINT capacity, UINT* outBucketCount);
+
+	void ResetPipelineStats();
+
+	// Event tracing (see EventTracer.h), off until enabled. DumpTrace writes
+	// Chrome trace JSON for chrome://tracing or Perfetto. Both fail when
+	// tracing is compiled out.
+	bool SetTracingEnabled(bool enabled);
+	bool DumpTrace(const char* path);
+
 private:
 
 	void LogDiagnosticResults(const std::vector<DiagnosticResult>& results);
@@ -95,18 +529,247 @@ private:
 		ReservedResource* resource);
 
 
-	ID3D12CommandAllocator* GetAvailableAllocator(UINT& outAllocatorIndex);
+	// Claims an idle ring slot (allocator + upload buffers), waiting on its
+	// fence outside the ring lock if the GPU is still using it.
+	UINT AcquireRingSlot();
+
+	// Returns a slot that was acquired but never submitted.
+	void ReleaseRingSlot(UINT slotIndex);
+
+	// Holds an acquired ring slot until HandOff passes it to the submit
+	// path, which frees it once the batch is recorded. A slot still held
+	// when the lease goes out of scope, because staging threw, goes back to
+	// the ring instead of leaking.
+	class RingSlotLease {
+	public:
+		explicit RingSlotLease(RenderingPlugin& plugin)
+			: m_plugin(&plugin), m_index(plugin.AcquireRingSlot()) {}
+		~RingSlotLease() { if (m_plugin) m_plugin->ReleaseRingSlot(m_index); }
+
+		RingSlotLease(const RingSlotLease&) = delete;
+		RingSlotLease& operator=(const RingSlotLease&) = delete;
+
+		UINT Index() const { return m_index; }
+
+		// Call just before SubmitUpload or SubmitUploads
+		void HandOff() { m_plugin = nullptr; }
+
+	private:
+		RenderingPlugin* m_plugin;
+		UINT m_index;
+	};
+
+	// Pushes a staged copy and records it, together with anything other
+	// producers queued meanwhile, into one command list.
+	bool SubmitUpload(UploadSubmission& submission);
+
+	// SubmitUpload for several copies that must share a command list and
+	// fence; they are queued atomically and succeed or fail together.
+	bool SubmitUploads(UploadSubmission* const* submissions, UINT count);
+
+	// Caller must hold m_submitMutex.
+	void FlushSubmissionQueue();
+
+	// Hands tiles whose NULL mappings were just queued to the retirement
+	// list, tagged with a fence signalled behind those mappings. The heap
+	// only sees them again once the backend's fence passes that value.
+	void RetireTiles(const TileRange* ranges, UINT rangeCount);
+
+	// Evicts least recently used tiles until the heap can allocate
+	// tileCount contiguous tiles once the retired tiles come back. Never
+	// waits on the GPU. Returns false if residency management is off or too
+	// few evictable tiles are left. Caller must hold m_mappingMutex.
+	bool EvictForAllocation(UINT tileCount);
+
+	// Makes room for tileCount tiles before an upload takes m_mappingMutex:
+	// evicts under the lock, then waits for the evicted tiles with it
+	// released. Does nothing if residency management is off. Another thread
+	// can still take the space, in which case the upload fails as usual.
+	// Caller must not hold m_mappingMutex.
+	void PrepareHeapSpace(UINT tileCount);
+
+	// NULL-maps the victims with one UpdateTileMappings per resource and
+	// retires them in one batch. Returns the number of tiles that were
+	// still mapped. Caller must hold m_mappingMutex.
+	UINT EvictTilesLocked(const std::vector<ResidentTile>& victims);
+
+	std::shared_ptr<ResidencyManager> GetResidencyManager();
+
+	// Sets up the staging ring and tile heap on the backend and marks the
+	// plugin initialized
+	bool InitializeBackend(std::unique_ptr<IGpuBackend> backend);
+
+	// Maps one tile and stages it with fill, without touching the mip chain.
+	bool UploadSingleTile(
+		ReservedResource* resource,
+		UINT subResource,
+		UINT tileX, UINT tileY, UINT tileZ,
+		const StagingFill& fill,
+		UINT64* outCompletionFence
+	);
+
+	// Maps a box in one allocation and stages it slab by slab with fill.
+	bool UploadTileBoxWithFill(
+		ReservedResource* resource,
+		const TileBox& box,
+		const StagingFill& fill,
+		UINT64* outCompletionFence
+	);
+
+	// Feeds an uploaded box to the resource's mip chain, if it has one, and
+	// uploads the coarser tiles it completes.
+	bool UploadTileBoxMips(
+		ReservedResource* resource,
+		const TileBox& box,
+		const std::byte* sourceData,
+		UINT64* outCompletionFence
+	);
+
+	// Maps every box of a multi-resource upload from one heap reservation,
+	// with one UpdateTileMappings per resource. outHeapOffsets receives each
+	// box's first heap tile. Caller must hold m_mappingMutex.
+	bool MapTileBoxesLocked(
+		const std::span<const TileBoxUpload>& uploads,
+		std::vector<UINT>& outHeapOffsets
+	);
+
+	// Stages the mapped boxes of a multi-resource upload, packing slabs of
+	// different boxes into the same ring slot and submission batch.
+	bool StageAndSubmitTileBoxes(
+		const std::span<const TileBoxUpload>& uploads,
+		UINT64* outCompletionFence
+	);
+
+	// Stages linear tiles in the destination format, swizzling them for
+	// standard-swizzle resources. sourceData must outlive the fill.
+	StagingFill MakeLinearStagingFill(
+		const ReservedResource* resource,
+		const std::byte* sourceData
+	);
+
+	// Checks a payload holds tileCount tiles of sourceBytesPerTexel texels
+	// (0 = the resource's own format, i.e. whole blocks for BC formats).
+	bool ValidateSourceSize(
+		const char* caller,
+		const ReservedResource* resource,
+		UINT64 sourceSize,
+		UINT tileCount,
+		UINT sourceBytesPerTexel
+	);
+
+	// Resolves the block encoder for an Uncompressed upload to a BC resource.
+	bool PrepareBlockEncoding(
+		const char* caller,
+		const ReservedResource* resource,
+		BlockEncoderInfo* outInfo
+	);
+
+	// Block-encodes uncompressed tiles into staging, one pool work item per
+	// tile slice. sourceData must outlive the fill.
+	StagingFill MakeBlockEncodeFill(
+		const ReservedResource* resource,
+		const BlockEncoderInfo& encoder,
+		const std::byte* sourceData
+	);
+
+	// CPU work done while staging (block encoding, payload decoding). Created
+	// on first use so plain uploads never start threads.
+	WorkerPool& GetStagingPool();
+
+	// Splits a TileCodec payload into exactly tileCount validated tiles.
+	bool ParseEncodedPayload(
+		const char* caller,
+		const ReservedResource* resource,
+		const std::span<const std::byte>& payload,
+		UINT tileCount,
+		std::vector<EncodedTileView>& outTiles
+	);
 
-	bool EnsureCommandListExists(ID3D12CommandAllocator* allocator);
+	// Looks up and validates every tile of the box, in x-fastest order.
+	bool FindArchiveTiles(
+		const char* caller,
+		const ReservedResource* resource,
+		const TileArchive* archive,
+		const TileBox& box,
+		std::vector<const TileArchiveEntry*>& outEntries
+	);
 
-	bool InitializeUploadBuffers();
+	// Uploads one predicted tile from the prefetch source. outUnavailable is
+	// set when the source has no data for the tile.
+	bool PrefetchTile(
+		ReservedResource* resource,
+		const TilePrefetchSource& source,
+		const PrefetchRequest& request,
+		bool* outUnavailable
+	);
 
-	bool InitializeBatchUploadBuffers();
+	// Cancels every request the prefetcher still has queued
+	void CancelPrefetchRequests(TilePrefetcher& prefetcher);
+
+	// Deleter of every registered volume: unmaps what is still mapped and
+	// frees it. Runs on whichever thread drops the last reference, which is
+	// never done under the plugin's own locks.
+	void ReleaseVolume(ReservedResource* resource);
+
+	// Pin for a volume passed in by pointer; nullptr, with an error logged,
+	// if it has been destroyed
+	std::shared_ptr<ReservedResource> PinResource(ReservedResource* resource);
+
+	// Queues work that holds a pin on resource, or returns 0 if the volume
+	// was destroyed before the work made it onto the queue
+	StreamingRequestId EnqueueStreamingWork(
+		const std::shared_ptr<ReservedResource>& resource,
+		float priority,
+		uint64_t bytes,
+		std::function<bool()> work
+	);
+
+	// TileCodec element: one texel, or one 4x4 block for BC formats
+	UINT GetTileElementSize(DXGI_FORMAT format)
+	{
+		const UINT bytesPerBlock = GetBytesPerBlock(format);
+		return bytesPerBlock != 0 ? bytesPerBlock : GetBytesPerPixel(format);
+	}
+
+	// Resolves the kernel for a converting upload and expands the palette
+	// into outPalette.
+	bool PrepareConversion(
+		const char* caller,
+		const ReservedResource* resource,
+		UploadSourceFormat sourceFormat,
+		const std::span<const std::byte>& palette,
+		ConversionInfo* outInfo,
+		std::vector<std::byte>& outPalette
+	);
+
+	// Returns the cached standard-swizzle pattern for the format's texel
+	// size, calibrating it on first use.
+	bool GetStandardSwizzlePattern(
+		DXGI_FORMAT format,
+		const ResourceTilingInfo& tilingInfo,
+		SwizzlePattern* outPattern
+	);
+
+	// Reads the layout back from the device: writes each texel's linear
+	// index into a standard-swizzle texture, then copies the raw bytes out
+	// through a buffer placed over the same memory. Needs heap tier 2.
+	bool CalibrateStandardSwizzle(
+		DXGI_FORMAT format,
+		const ResourceTilingInfo& tilingInfo,
+		SwizzlePattern* outPattern
+	);
+
+	// Uploads tiles emitted by a MipChainBuilder, raising outCompletionFence
+	// (if given) to cover them.
+	bool UploadGeneratedMips(
+		ReservedResource* resource,
+		std::vector<GeneratedMipTile>& tiles,
+		UINT64* outCompletionFence
+	);
 
 	bool ValidateTileUploadParams(
 		const ReservedResource* resource,
 		UINT subresource,
-		const std::span<std::byte>& sourceData,
 		D3D12_RESOURCE_DESC* outResourceDesc,
 		ResourceTilingInfo* outResourceTilingInfo
 	);
@@ -117,34 +780,89 @@ private:
 		UINT subResource
 	);
 
-	ID3D12Resource* FillUploadBuffer(
-		ID3D12Resource* uploadBuffer,
-		const std::span<std::byte>& sourceData
-	);
-
+	// Caller must hold m_mappingMutex.
 	TileMapping AllocateAndMapTileToHeap(
 		ReservedResource* resource,
 		UINT subResource,
 		UINT tileX, UINT tileY, UINT tileZ
 	);
 
-	bool ExecuteTileCopy(
-		ID3D12Resource* uploadBuffer,
-		ReservedResource* resource,
-		UINT subResource,
-		UINT tileX, UINT tileY, UINT tileZ,
-		const ResourceTilingInfo& tilingInfo,
-		UINT allocatorIndex
-	);
-
 	bool ValidateTileBoxParams(
 		const ReservedResource* resource,
 		const TileBox& box,
-		const std::span<std::byte>& sourceData,
 		D3D12_RESOURCE_DESC* outResourceDesc,
 		ResourceTilingInfo* outResourceTilingInfo
 	);
 
+	// Splits a box into sub-boxes of at most maxTiles tiles whose payloads
+	// are contiguous in the box's x-fastest order.
+	static std::vector<TileBox> SplitIntoSlabs(const TileBox& box, UINT maxTiles);
+
+	// Copies an already-mapped box slab by slab: filling slab N+1 overlaps
+	// the GPU copying slab N. Returns the fence of the last slab.
+	bool StageAndSubmitTileBox(
+		ReservedResource* resource,
+		const TileBox& box,
+		const StagingFill& fill,
+		UINT64* outCompletionFence
+	);
+
+	// Copies the residency map's changes to its texture, if the resource has
+	// one. The unmap paths call it before queueing NULL mappings, so shaders
+	// stop sampling tiles before they go away. Caller must hold
+	// m_mappingMutex, which keeps the copies in order.
+	bool FlushResidencyMap(ReservedResource* resource);
+
+	// Queues one NULL UpdateTileMappings covering the box.
+	void NullMapTileBox(
+		ReservedResource* resource,
+		const TileBox& box
+	);
+
+	// Unregisters and retires all mapped tiles in the box.
+	// Caller must hold m_mappingMutex.
+	void UnmapTileBoxLocked(
+		ReservedResource* resource,
+		const TileBox& box
+	);
+
+	// Caller must hold m_mappingMutex.
+	TileMapping AllocateAndMapPackedMipTail(ReservedResource* resource);
+
+	// Caller must hold m_mappingMutex.
+	void UnmapPackedMipTailLocked(ReservedResource* resource);
+
+	// Bytes of the tightly packed linear layout UploadPackedMips expects.
+	UINT64 CalculatePackedMipDataSize(const ReservedResource* resource);
+
+	// Sorts heap offsets and merges them into runs of consecutive tiles.
+	static std::vector<TileRange> CoalesceTileRanges(std::vector<UINT>& heapOffsets);
+
+	// Logs and returns true if the resource belongs to a volume set, whose
+	// standard tiles only the set may map or unmap. Caller must hold
+	// m_mappingMutex, which CreateVolumeSet holds while it checks and joins
+	// the members, so the answer holds until the lock is released.
+	bool RejectSetMember(const char* caller, const ReservedResource* resource);
+
+	// Logs and returns true if DestroyVolumeSet has dissolved the set since
+	// it was pinned. Called under m_mappingMutex, which DestroyVolumeSet
+	// holds while it releases the members.
+	bool RejectDestroyedSet(const char* caller, const VolumeSet* set);
+
+	// Tiles of a set member are tracked under the set's primary
+	static ReservedResource* GetResidencyOwner(ReservedResource* resource);
+
+	// Maps the box in every member of the set from one heap reservation,
+	// coordinate by coordinate, with one UpdateTileMappings per member.
+	// Caller must hold m_mappingMutex.
+	bool MapVolumeSetBoxLocked(VolumeSet& set, const TileBox& box);
+
+	// Unregisters the box's coordinates from the set and its members,
+	// NULL-maps the box in each member and retires the runs in one batch.
+	// Caller must hold m_mappingMutex.
+	void UnmapVolumeSetBoxLocked(VolumeSet& set, const TileBox& box);
+
+	// Caller must hold m_mappingMutex.
 	void RollbackTileBoxMapping(
 		ReservedResource* resource,
 		const TileBox& box,
@@ -159,31 +877,103 @@ private:
 	IUnityLog* s_Log;
 	ID3D12Device* s_Device;
 
+	std::unique_ptr<IGpuBackend> m_backend;
 	std::unique_ptr<IHeap> g_tileHeap;
 
-	std::atomic<bool> initialized{false};
-	std::mutex m_mutex;
+	static constexpr UINT64 TILE_HEAP_BYTE_SIZE = 512 * 1024 * 1024;
 
-	Microsoft::WRL::ComPtr<ID3D12Fence> m_uploadFence;
+	std::atomic<bool> initialized{false};
 
+	// Upload pipeline phases, each with its own synchronization:
+	//   mapping  - heap allocation, tile tracking and UpdateTileMappings
+	//   ring     - claiming/releasing staging slots (fence waits happen unlocked)
+	//   submit   - command-list recording, ExecuteCommandLists and Signal
+	// Lock order when nested: mapping -> submit -> ring.
+	std::mutex m_mappingMutex;
+	std::mutex m_ringMutex;
+	std::condition_variable m_slotAvailable;
+	std::mutex m_submitMutex;
+	SubmissionQueue<UploadSubmission> m_submissionQueue;
+
+	// Guarded by m_submitMutex
 	UINT64 m_fenceValue = 0;
-	wil::unique_event m_fenceEvent = nullptr;
 
+	struct RetiredTileRange {
+		TileRange range;
+		UINT64 fenceValue;
+	};
 
-	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_uploadCommandList;
+	// Ordered by fence value; pushed under m_submitMutex
+	std::deque<RetiredTileRange> m_retiredTiles;
+	std::mutex m_retireMutex;
 
-	static constexpr UINT ALLOCATOR_POOL_SIZE = 4;
+	static constexpr UINT ALLOCATOR_POOL_SIZE = 8;
 
-	Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_uploadAllocators[ALLOCATOR_POOL_SIZE];
-	Microsoft::WRL::ComPtr<ID3D12Resource> m_uploadBuffers[ALLOCATOR_POOL_SIZE];
-	Microsoft::WRL::ComPtr<ID3D12Resource> m_batchUploadBuffers[ALLOCATOR_POOL_SIZE];
+	// The backend's staging memory for each ring slot
+	std::byte* m_uploadBufferData[ALLOCATOR_POOL_SIZE] = { nullptr };
+	std::byte* m_batchUploadBufferData[ALLOCATOR_POOL_SIZE] = { nullptr };
+
+	// Guarded by m_ringMutex
 	UINT64 m_allocatorFenceValues[ALLOCATOR_POOL_SIZE] = { 0 };
-	UINT m_currentAllocatorIndex = 0;
+	bool m_slotInUse[ALLOCATOR_POOL_SIZE] = { false };
 
 	static constexpr UINT64 UPLOAD_TILE_SIZE = 65536;
 	static constexpr UINT64 BATCH_UPLOAD_BYTE_SIZE = 32 * 65536; // 2 MiB
+	static constexpr UINT BATCH_UPLOAD_TILE_COUNT = static_cast<UINT>(BATCH_UPLOAD_BYTE_SIZE / UPLOAD_TILE_SIZE);
+
+	// Set once destruction starts, so volumes freed with the plugin skip
+	// their teardown. Declared ahead of m_resources so it outlives the table.
+	std::atomic<bool> m_shuttingDown{ false };
+
+	HandleTable<ReservedResource> m_resources;
+	std::mutex m_resourceMutex;
+
+	// Guarded by m_resourceMutex; membership changes also take
+	// m_mappingMutex
+	HandleTable<VolumeSet> m_volumeSets;
+
+	// Standard-swizzle patterns keyed by bytes per texel. m_swizzleMutex
+	// guards the map only and is never held across calibration.
+	std::unordered_map<UINT, SwizzlePattern> m_swizzlePatterns;
+	std::mutex m_swizzleMutex;
+
+	std::vector<std::shared_ptr<TileArchive>> m_archives;
+	std::vector<std::unique_ptr<TileArchiveWriter>> m_archiveWriters;
+	std::mutex m_archiveMutex;
+
+	std::shared_ptr<ResidencyManager> m_residencyManager;
+	std::mutex m_residencyMutex;
+
+	// Lower bound on tiles evicted per pass, so a run of single-tile
+	// allocations does not wait on the GPU once per tile
+	static constexpr UINT RESIDENCY_EVICTION_BATCH = 64;
 
-	std::vector<std::unique_ptr<ReservedResource>> g_resources;
+	static constexpr float DEFAULT_STREAMING_AGING = 1.0f;
+	StreamingScheduler m_streamingScheduler{ DEFAULT_STREAMING_AGING };
+
+	// Guarded by m_streamingMutex
+	StreamingBudget m_streamingBudget = { 8 * 1024 * 1024, 64 };
+	std::mutex m_streamingMutex;
+
+	// Serializes SolveResidency; a solver keeps state between solves
+	std::mutex m_solverMutex;
+
+	static constexpr UINT MAX_STAGING_WORKERS = 8;
+	std::unique_ptr<WorkerPool> m_stagingPool;
+	std::once_flag m_stagingPoolOnce;
+
+#if defined(SPARSE_PIPELINE_STATS)
+	PipelineStats m_pipelineStats;
+#endif
+#if defined(SPARSE_EVENT_TRACE)
+	EventTracer m_eventTracer;
+#endif
+
+	// Formats the tile upload paths accept: whole texels or whole BC blocks
+	bool IsSupportedTileFormat(DXGI_FORMAT format)
+	{
+		return GetBytesPerPixel(format) != 0 || IsBlockCompressed(format);
+	}
 
 	UINT GetBytesPerPixel(DXGI_FORMAT format)
 	{
@@ -197,6 +987,8 @@ private:
 			return 8;
 
 		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_R11G11B10_FLOAT:
+		case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
 		case DXGI_FORMAT_R16G16_FLOAT:
 		case DXGI_FORMAT_R32_FLOAT:
 		case DXGI_FORMAT_R32_UINT:
@@ -3,25 +3,13 @@
 #include <format>
 
 
-ReservedResource::ReservedResource(UINT width, UINT height, UINT depth, bool useMipMaps, UINT mipmapCount, DXGI_FORMAT format, ID3D12Device* device, IUnityLog* logger) :
-	width(width), height(height), depth(depth), useMipMaps(useMipMaps), mipMapCount(mipmapCount), textureFormat(format), device(device), logger(logger)
+ReservedResource::ReservedResource(UINT width, UINT height, UINT depth, bool useMipMaps, UINT mipmapCount, DXGI_FORMAT format, ID3D12Device* device, IUnityLog* logger,
+	D3D12_TEXTURE_LAYOUT layout) :
+	width(width), height(height), depth(depth), useMipMaps(useMipMaps), mipMapCount(mipmapCount), textureFormat(format), textureLayout(layout), device(device), logger(logger),
+	m_desc(MakeDesc(width, height, depth, useMipMaps ? mipmapCount : 1, format, layout))
 {
-
-	D3D12_RESOURCE_DESC desc = {};
-
-	desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
-	desc.Alignment = 0;
-	desc.Width = static_cast<UINT64>(width);
-	desc.Height = static_cast<UINT>(height);
-	desc.DepthOrArraySize = static_cast<UINT16>(depth);
-	desc.MipLevels = useMipMaps ? mipmapCount : 1;
-	desc.Format = static_cast<DXGI_FORMAT>(format);
-	desc.SampleDesc.Count = 1;
-	desc.Layout = D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE;
-	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
-
 	HRESULT hr = device->CreateReservedResource(
-		&desc,
+		&m_desc,
 		D3D12_RESOURCE_STATE_COMMON,
 		nullptr,
 		IID_PPV_ARGS(&D3D12Resource)
@@ -56,6 +44,9 @@ ReservedResource::ReservedResource(UINT width, UINT height, UINT depth, bool use
 	tilingInfo.TileDepthInTexels= resourceTileShape.DepthInTexels;
 	tilingInfo.SubresourceCount = numSubresources;
 	tilingInfo.NumPackedMips = packedMipInfo.NumPackedMips;
+	tilingInfo.NumStandardMips = packedMipInfo.NumStandardMips;
+	tilingInfo.NumTilesForPackedMips = packedMipInfo.NumTilesForPackedMips;
+	tilingInfo.PackedMipStartTileIndex = packedMipInfo.StartTileIndexInOverallResource;
 	for (int i = 0; i < subresourceTilings.size(); i++)
 	{
 		tilingInfo.subresourceTilingInfo.emplace_back(SubresourceTilingInfo(
@@ -67,6 +58,30 @@ ReservedResource::ReservedResource(UINT width, UINT height, UINT depth, bool use
 	}
 }
 
+ReservedResource::ReservedResource(UINT width, UINT height, UINT depth, bool useMipMaps, UINT mipmapCount, DXGI_FORMAT format,
+	const ResourceTilingInfo& tiling, D3D12_TEXTURE_LAYOUT layout) :
+	width(width), height(height), depth(depth), useMipMaps(useMipMaps), mipMapCount(mipmapCount), textureFormat(format), textureLayout(layout), device(nullptr), logger(nullptr),
+	m_desc(MakeDesc(width, height, depth, useMipMaps ? mipmapCount : 1, format, layout)), tilingInfo(tiling)
+{
+}
+
+D3D12_RESOURCE_DESC ReservedResource::MakeDesc(UINT width, UINT height, UINT depth, UINT mipLevels, DXGI_FORMAT format, D3D12_TEXTURE_LAYOUT layout)
+{
+	D3D12_RESOURCE_DESC desc = {};
+
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+	desc.Alignment = 0;
+	desc.Width = static_cast<UINT64>(width);
+	desc.Height = static_cast<UINT>(height);
+	desc.DepthOrArraySize = static_cast<UINT16>(depth);
+	desc.MipLevels = static_cast<UINT16>(mipLevels);
+	desc.Format = format;
+	desc.SampleDesc.Count = 1;
+	desc.Layout = layout;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+	return desc;
+}
+
 const ResourceTilingInfo& ReservedResource::GetTilingInfo() const {
 	return tilingInfo;
 }
@@ -84,6 +99,19 @@ void ReservedResource::RegisterMappedTile(UINT subresource, UINT x, UINT y, UINT
 	tile.tileZ = z;
 
 	mappedTiles[key] = tile;
+
+	if (m_residencyManager && m_tracksResidency && !tilingInfo.IsPackedMip(subresource)) {
+		m_residencyManager->AddTile({ this, subresource, x, y, z });
+	}
+
+	if (m_residencyMap) {
+		if (tilingInfo.IsPackedMip(subresource)) {
+			m_residencyMap->SetPackedTailMapped(true);
+		}
+		else {
+			m_residencyMap->SetTileMapped(subresource, x, y, z, true);
+		}
+	}
 }
 
 bool ReservedResource::GetMappedTileOffset(UINT subresource, UINT x, UINT y, UINT z, UINT* outOffset) const {
@@ -107,7 +135,74 @@ void ReservedResource::UnregisterMappedTile(UINT subresource, UINT x, UINT y, UI
 	std::lock_guard<std::mutex> lock(m_tileMutex);
 
 	UINT64 key = GetTileKey(subresource, x, y, z);
-	mappedTiles.erase(key);
+	auto it = mappedTiles.find(key);
+	if (it != mappedTiles.end()) {
+		NotifyTileUnmapped(it->second);
+		mappedTiles.erase(it);
+	}
+}
+
+void ReservedResource::UnregisterMappedTileBox(
+	UINT subresource,
+	UINT startX, UINT startY, UINT startZ,
+	UINT boxWidth, UINT boxHeight, UINT boxDepth,
+	std::vector<UINT>& outHeapOffsets
+) {
+	std::lock_guard<std::mutex> lock(m_tileMutex);
+
+	const UINT64 boxTiles = (UINT64)boxWidth * boxHeight * boxDepth;
+
+	// A sparsely populated box is cheaper to find by walking what is mapped
+	if (boxTiles > mappedTiles.size()) {
+		for (auto it = mappedTiles.begin(); it != mappedTiles.end();) {
+			const MappedTile& tile = it->second;
+			if (tile.subResource == subresource &&
+				tile.tileX >= startX && tile.tileX < startX + boxWidth &&
+				tile.tileY >= startY && tile.tileY < startY + boxHeight &&
+				tile.tileZ >= startZ && tile.tileZ < startZ + boxDepth) {
+				outHeapOffsets.push_back(tile.heapOffset);
+				NotifyTileUnmapped(tile);
+				it = mappedTiles.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+		return;
+	}
+
+	for (UINT z = startZ; z < startZ + boxDepth; ++z)
+		for (UINT y = startY; y < startY + boxHeight; ++y)
+			for (UINT x = startX; x < startX + boxWidth; ++x) {
+				auto it = mappedTiles.find(GetTileKey(subresource, x, y, z));
+				if (it != mappedTiles.end()) {
+					outHeapOffsets.push_back(it->second.heapOffset);
+					NotifyTileUnmapped(it->second);
+					mappedTiles.erase(it);
+				}
+			}
+}
+
+void ReservedResource::UnregisterSubresourceTiles(UINT subresource, std::vector<UINT>& outHeapOffsets) {
+	std::lock_guard<std::mutex> lock(m_tileMutex);
+
+	for (auto it = mappedTiles.begin(); it != mappedTiles.end();) {
+		if (it->second.subResource == subresource) {
+			outHeapOffsets.push_back(it->second.heapOffset);
+			NotifyTileUnmapped(it->second);
+			it = mappedTiles.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+bool ReservedResource::IsPackedMipTailMapped() const {
+	if (tilingInfo.NumPackedMips == 0) {
+		return false;
+	}
+	return IsTileMapped(tilingInfo.NumStandardMips, 0, 0, 0);
 }
 
 bool ReservedResource::IsTileMapped(UINT subresource, UINT x, UINT y, UINT z) const {
@@ -115,4 +210,185 @@ bool ReservedResource::IsTileMapped(UINT subresource, UINT x, UINT y, UINT z) co
 
 	UINT64 key = GetTileKey(subresource, x, y, z);
 	return mappedTiles.find(key) != mappedTiles.end();
-}
\ No newline at end of file
+}
+
+void ReservedResource::SetSwizzlePattern(const SwizzlePattern& pattern) {
+	m_swizzlePattern = pattern;
+}
+
+const SwizzlePattern& ReservedResource::GetSwizzlePattern() const {
+	return m_swizzlePattern;
+}
+
+void ReservedResource::SetMipChainBuilder(std::shared_ptr<MipChainBuilder> builder) {
+	std::lock_guard<std::mutex> lock(m_mipMutex);
+	m_mipChainBuilder = std::move(builder);
+}
+
+std::shared_ptr<MipChainBuilder> ReservedResource::GetMipChainBuilder() const {
+	std::lock_guard<std::mutex> lock(m_mipMutex);
+	return m_mipChainBuilder;
+}
+
+void ReservedResource::SetTilePrefetcher(std::shared_ptr<TilePrefetcher> prefetcher) {
+	std::lock_guard<std::mutex> lock(m_prefetchMutex);
+	m_tilePrefetcher = std::move(prefetcher);
+}
+
+std::shared_ptr<TilePrefetcher> ReservedResource::GetTilePrefetcher() const {
+	std::lock_guard<std::mutex> lock(m_prefetchMutex);
+	return m_tilePrefetcher;
+}
+
+void ReservedResource::SetWrapWindow(std::shared_ptr<WrapWindow> window) {
+	std::lock_guard<std::mutex> lock(m_wrapMutex);
+	m_wrapWindow = std::move(window);
+}
+
+std::shared_ptr<WrapWindow> ReservedResource::GetWrapWindow() const {
+	std::lock_guard<std::mutex> lock(m_wrapMutex);
+	return m_wrapWindow;
+}
+
+void ReservedResource::SetResidencyManager(std::shared_ptr<ResidencyManager> manager) {
+	std::lock_guard<std::mutex> lock(m_tileMutex);
+	if (m_residencyManager == manager) {
+		return;
+	}
+
+	if (m_residencyManager) {
+		m_residencyManager->RemoveOwner(this);
+	}
+
+	m_residencyManager = std::move(manager);
+	if (!m_residencyManager || !m_tracksResidency) {
+		return;
+	}
+
+	for (const auto& [key, tile] : mappedTiles) {
+		if (!tilingInfo.IsPackedMip(tile.subResource)) {
+			m_residencyManager->AddTile({ this, tile.subResource, tile.tileX, tile.tileY, tile.tileZ });
+		}
+	}
+}
+
+std::shared_ptr<ResidencyManager> ReservedResource::GetResidencyManager() const {
+	std::lock_guard<std::mutex> lock(m_tileMutex);
+	return m_residencyManager;
+}
+
+void ReservedResource::SetVolumeSet(VolumeSet* set, bool tracksResidency) {
+	std::lock_guard<std::mutex> lock(m_tileMutex);
+	m_volumeSet = set;
+	if (m_tracksResidency == tracksResidency) {
+		return;
+	}
+
+	m_tracksResidency = tracksResidency;
+	if (!m_residencyManager) {
+		return;
+	}
+
+	if (!m_tracksResidency) {
+		m_residencyManager->RemoveOwner(this);
+		return;
+	}
+
+	for (const auto& [key, tile] : mappedTiles) {
+		if (!tilingInfo.IsPackedMip(tile.subResource)) {
+			m_residencyManager->AddTile({ this, tile.subResource, tile.tileX, tile.tileY, tile.tileZ });
+		}
+	}
+}
+
+VolumeSet* ReservedResource::GetVolumeSet() const {
+	std::lock_guard<std::mutex> lock(m_tileMutex);
+	return m_volumeSet;
+}
+
+void ReservedResource::SetResidencySolver(std::shared_ptr<ResidencySolver> solver) {
+	std::lock_guard<std::mutex> lock(m_solverMutex);
+	m_residencySolver = std::move(solver);
+}
+
+std::shared_ptr<ResidencySolver> ReservedResource::GetResidencySolver() const {
+	std::lock_guard<std::mutex> lock(m_solverMutex);
+	return m_residencySolver;
+}
+
+UINT64 ReservedResource::GetUnmapGeneration() const {
+	std::lock_guard<std::mutex> lock(m_tileMutex);
+	return m_unmapGeneration;
+}
+
+void ReservedResource::SetUsageFeedback(std::shared_ptr<UsageFeedback> feedback) {
+	std::lock_guard<std::mutex> lock(m_feedbackMutex);
+	m_usageFeedback = std::move(feedback);
+}
+
+std::shared_ptr<UsageFeedback> ReservedResource::GetUsageFeedback() const {
+	std::lock_guard<std::mutex> lock(m_feedbackMutex);
+	return m_usageFeedback;
+}
+
+void ReservedResource::GetMappedStandardTiles(std::vector<FeedbackTile>& outTiles) const {
+	std::lock_guard<std::mutex> lock(m_tileMutex);
+
+	outTiles.reserve(outTiles.size() + mappedTiles.size());
+	for (const auto& [key, tile] : mappedTiles) {
+		if (!tilingInfo.IsPackedMip(tile.subResource)) {
+			outTiles.push_back({ tile.subResource, tile.tileX, tile.tileY, tile.tileZ });
+		}
+	}
+}
+
+void ReservedResource::SetResidencyMap(std::shared_ptr<ResidencyMap> map, Microsoft::WRL::ComPtr<ID3D12Resource> texture) {
+	std::lock_guard<std::mutex> lock(m_tileMutex);
+
+	m_residencyMap = std::move(map);
+	m_residencyMapTexture = m_residencyMap ? std::move(texture) : nullptr;
+	if (!m_residencyMap) {
+		return;
+	}
+
+	for (const auto& [key, tile] : mappedTiles) {
+		if (tilingInfo.IsPackedMip(tile.subResource)) {
+			m_residencyMap->SetPackedTailMapped(true);
+		}
+		else {
+			m_residencyMap->SetTileMapped(tile.subResource, tile.tileX, tile.tileY, tile.tileZ, true);
+		}
+	}
+}
+
+std::shared_ptr<ResidencyMap> ReservedResource::GetResidencyMap() const {
+	std::lock_guard<std::mutex> lock(m_tileMutex);
+	return m_residencyMap;
+}
+
+ID3D12Resource* ReservedResource::GetResidencyMapTexture() const {
+	std::lock_guard<std::mutex> lock(m_tileMutex);
+	return m_residencyMapTexture.Get();
+}
+
+void ReservedResource::NotifyTileUnmapped(const MappedTile& tile) {
+	++m_unmapGeneration;
+	if (m_residencyManager && m_tracksResidency) {
+		m_residencyManager->RemoveTile({ this, tile.subResource, tile.tileX, tile.tileY, tile.tileZ });
+	}
+	if (m_residencyMap) {
+		if (tilingInfo.IsPackedMip(tile.subResource)) {
+			m_residencyMap->SetPackedTailMapped(false);
+		}
+		else {
+			m_residencyMap->SetTileMapped(tile.subResource, tile.tileX, tile.tileY, tile.tileZ, false);
+		}
+	}
+	if (!tilingInfo.IsPackedMip(tile.subResource)) {
+		// m_tileMutex -> m_mipMutex; the builder never calls back in
+		std::lock_guard<std::mutex> lock(m_mipMutex);
+		if (m_mipChainBuilder) {
+			m_mipChainBuilder->RemoveTile(tile.subResource, tile.tileX, tile.tileY, tile.tileZ);
+		}
+	}
+}
@@ -4,11 +4,28 @@
 #include "IUnityLog.h"
 #include <memory>
 #include "TilingInfo.h"
+#include "MipChainBuilder.h"
+#include "TileSwizzle.h"
+#include "TilePrefetcher.h"
+#include "ResidencyManager.h"
+#include "ResidencySolver.h"
+#include "UsageFeedback.h"
+#include "ResidencyMap.h"
+#include "WrapWindow.h"
 #include <wrl/client.h>
 #include <span>
 #include <unordered_map>
 #include <mutex>
 
+class VolumeSet;
+
+enum VolumeCreateFlags : UINT {
+	VOLUME_CREATE_FLAG_NONE = 0,
+	// Use D3D12_TEXTURE_LAYOUT_64KB_STANDARD_SWIZZLE so tile payloads can be
+	// swizzled on the CPU and copied without a GPU layout conversion
+	VOLUME_CREATE_FLAG_STANDARD_SWIZZLE = 0x1,
+};
+
 class ReservedResource {
 public:
 	// Texture properties
@@ -18,10 +35,24 @@ public:
 	const bool useMipMaps;
 	const UINT mipMapCount;
 	const DXGI_FORMAT textureFormat;
+	const D3D12_TEXTURE_LAYOUT textureLayout;
 	Microsoft::WRL::ComPtr<ID3D12Resource> D3D12Resource;
 
+	// Volume handle, set once when the resource is registered; identifies
+	// it in event traces
+	UINT64 handle = 0;
+
+
+	ReservedResource(UINT width, UINT height, UINT depth, bool useMipMaps, UINT mipmapCount, DXGI_FORMAT format, ID3D12Device* device, IUnityLog* logger,
+		D3D12_TEXTURE_LAYOUT layout = D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE);
 
-	ReservedResource(UINT width, UINT height, UINT depth, bool useMipMaps, UINT mipmapCount, DXGI_FORMAT format, ID3D12Device* device, IUnityLog* logger);
+	// No D3D12 resource behind it: the tiling comes from a backend that
+	// simulates the device (see SoftwareBackend.h)
+	ReservedResource(UINT width, UINT height, UINT depth, bool useMipMaps, UINT mipmapCount, DXGI_FORMAT format,
+		const ResourceTilingInfo& tiling, D3D12_TEXTURE_LAYOUT layout = D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE);
+
+	// The description the resource was created with
+	const D3D12_RESOURCE_DESC& GetDesc() const { return m_desc; }
 
 	const ResourceTilingInfo& GetTilingInfo() const;
 	
@@ -42,11 +73,88 @@ public:
 		UINT x, UINT y, UINT z
 	);
 
+	// Unregisters every mapped tile inside the box under a single lock and
+	// appends their heap offsets. Unmapped coordinates are skipped.
+	void UnregisterMappedTileBox(
+		UINT subresource,
+		UINT startX, UINT startY, UINT startZ,
+		UINT boxWidth, UINT boxHeight, UINT boxDepth,
+		std::vector<UINT>& outHeapOffsets
+	);
+
+	// Unregisters every mapped tile of a subresource and appends their heap offsets.
+	void UnregisterSubresourceTiles(
+		UINT subresource,
+		std::vector<UINT>& outHeapOffsets
+	);
+
 	bool IsTileMapped(
 		UINT subresource, 
 		UINT x, UINT y, UINT z
 	) const;
 
+	// The packed tail is tracked as tiles (NumStandardMips, i, 0, 0) and is
+	// always mapped or unmapped as a whole.
+	bool IsPackedMipTailMapped() const;
+
+	bool IsStandardSwizzle() const {
+		return textureLayout == D3D12_TEXTURE_LAYOUT_64KB_STANDARD_SWIZZLE;
+	}
+
+	// Set once at creation for standard-swizzle resources, before the
+	// resource is handed out
+	void SetSwizzlePattern(const SwizzlePattern& pattern);
+	const SwizzlePattern& GetSwizzlePattern() const;
+
+	// Opt-in CPU mip generation. A null builder disables it.
+	void SetMipChainBuilder(std::shared_ptr<MipChainBuilder> builder);
+	std::shared_ptr<MipChainBuilder> GetMipChainBuilder() const;
+
+	// Opt-in camera-driven prefetching. A null prefetcher disables it.
+	void SetTilePrefetcher(std::shared_ptr<TilePrefetcher> prefetcher);
+	std::shared_ptr<TilePrefetcher> GetTilePrefetcher() const;
+
+	// Opt-in toroidal addressing (see WrapWindow.h). A null window disables
+	// it; standard tile coordinates are physical either way.
+	void SetWrapWindow(std::shared_ptr<WrapWindow> window);
+	std::shared_ptr<WrapWindow> GetWrapWindow() const;
+
+	// Reports every mapped tile outside the packed tail to the manager, now
+	// and as tiles are registered and unregistered. Packed tiles are never
+	// evicted. A null manager detaches the resource.
+	void SetResidencyManager(std::shared_ptr<ResidencyManager> manager);
+	std::shared_ptr<ResidencyManager> GetResidencyManager() const;
+
+	// Membership of a lockstep volume set (see VolumeSet.h); null when the
+	// volume stands alone. Members other than the primary pass
+	// tracksResidency false and leave residency tracking to it, dropping
+	// their own pins and priority; standing alone again re-reports every
+	// mapped tile.
+	void SetVolumeSet(VolumeSet* set, bool tracksResidency);
+	VolumeSet* GetVolumeSet() const;
+
+	// Opt-in desired-residency solving. A null solver disables it.
+	void SetResidencySolver(std::shared_ptr<ResidencySolver> solver);
+	std::shared_ptr<ResidencySolver> GetResidencySolver() const;
+
+	// Counts every tile ever unregistered, so callers can tell whether
+	// anything was unmapped since they last looked
+	UINT64 GetUnmapGeneration() const;
+
+	// Opt-in GPU usage feedback processing. A null processor disables it.
+	void SetUsageFeedback(std::shared_ptr<UsageFeedback> feedback);
+	std::shared_ptr<UsageFeedback> GetUsageFeedback() const;
+
+	// Appends every mapped tile outside the packed tail
+	void GetMappedStandardTiles(std::vector<FeedbackTile>& outTiles) const;
+
+	// Feeds every mapped tile to the map, now and as tiles are registered
+	// and unregistered; texture is the GPU copy the map is uploaded to. A
+	// null map detaches it.
+	void SetResidencyMap(std::shared_ptr<ResidencyMap> map, Microsoft::WRL::ComPtr<ID3D12Resource> texture);
+	std::shared_ptr<ResidencyMap> GetResidencyMap() const;
+	ID3D12Resource* GetResidencyMapTexture() const;
+
 private:
 	struct MappedTile {
 		UINT heapOffset;
@@ -56,11 +164,42 @@ private:
 	std::unordered_map<UINT64, MappedTile> mappedTiles;
 	mutable std::mutex m_tileMutex;
 
+	// Guarded by m_tileMutex
+	std::shared_ptr<ResidencyManager> m_residencyManager;
+	VolumeSet* m_volumeSet = nullptr;
+	bool m_tracksResidency = true;
+	UINT64 m_unmapGeneration = 0;
+	std::shared_ptr<ResidencyMap> m_residencyMap;
+	Microsoft::WRL::ComPtr<ID3D12Resource> m_residencyMapTexture;
+
+	// Caller must hold m_tileMutex.
+	void NotifyTileUnmapped(const MappedTile& tile);
+
+	SwizzlePattern m_swizzlePattern = {};
+
+	std::shared_ptr<MipChainBuilder> m_mipChainBuilder;
+	mutable std::mutex m_mipMutex;
+
+	std::shared_ptr<TilePrefetcher> m_tilePrefetcher;
+	mutable std::mutex m_prefetchMutex;
+
+	std::shared_ptr<WrapWindow> m_wrapWindow;
+	mutable std::mutex m_wrapMutex;
+
+	std::shared_ptr<ResidencySolver> m_residencySolver;
+	mutable std::mutex m_solverMutex;
+
+	std::shared_ptr<UsageFeedback> m_usageFeedback;
+	mutable std::mutex m_feedbackMutex;
+
 	UINT64 GetTileKey(UINT subresource, UINT x, UINT y, UINT z) const {
 		return ((UINT64)subresource << 48) | ((UINT64)x << 32) | ((UINT64)y << 16) | z;
 	}
 
+	static D3D12_RESOURCE_DESC MakeDesc(UINT width, UINT height, UINT depth, UINT mipLevels, DXGI_FORMAT format, D3D12_TEXTURE_LAYOUT layout);
+
 	ID3D12Device* device;
 	IUnityLog* logger;
+	D3D12_RESOURCE_DESC m_desc;
 	ResourceTilingInfo tilingInfo;
 };
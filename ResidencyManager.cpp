@@ -0,0 +1,233 @@
+#include "pch.h"
+#include "ResidencyManager.h"
+
+void ResidencyManager::AdvanceFrame()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	++m_frame;
+}
+
+uint64_t ResidencyManager::CurrentFrame() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_frame;
+}
+
+void ResidencyManager::SetOwnerWeight(void* owner, float weight)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_owners[owner].weight = weight;
+}
+
+void ResidencyManager::RemoveOwner(void* owner)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (auto it = m_index.begin(); it != m_index.end();) {
+		if (it->first.owner == owner) {
+			FreeNode(it->second);
+			it = m_index.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	for (auto it = m_pins.begin(); it != m_pins.end();) {
+		it = it->owner == owner ? m_pins.erase(it) : std::next(it);
+	}
+
+	m_owners.erase(owner);
+}
+
+void ResidencyManager::AddTile(const ResidentTile& tile)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const TileId id = GetTileId(tile);
+	auto found = m_index.find(id);
+	if (found != m_index.end()) {
+		Node& node = m_nodes[found->second];
+		if (node.lastUse != m_frame) {
+			node.lastUse = m_frame;
+			if (!node.pinned) {
+				Unlink(found->second);
+				Link(found->second);
+			}
+		}
+		return;
+	}
+
+	uint32_t index;
+	if (!m_freeNodes.empty()) {
+		index = m_freeNodes.back();
+		m_freeNodes.pop_back();
+	}
+	else {
+		index = static_cast<uint32_t>(m_nodes.size());
+		m_nodes.emplace_back();
+	}
+
+	Node& node = m_nodes[index];
+	node.tile = tile;
+	node.lastUse = m_frame;
+	node.prev = NIL;
+	node.next = NIL;
+	node.list = &m_owners[tile.owner];
+	node.pinned = m_pins.count(id) != 0;
+	if (!node.pinned) {
+		Link(index);
+	}
+
+	m_index.emplace(id, index);
+}
+
+void ResidencyManager::RemoveTile(const ResidentTile& tile)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto found = m_index.find(GetTileId(tile));
+	if (found == m_index.end()) {
+		return;
+	}
+
+	FreeNode(found->second);
+	m_index.erase(found);
+}
+
+bool ResidencyManager::Touch(const ResidentTile& tile)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto found = m_index.find(GetTileId(tile));
+	if (found == m_index.end()) {
+		return false;
+	}
+
+	// Lists only need ordering by frame, so repeat touches within a frame
+	// leave the tile where it is
+	Node& node = m_nodes[found->second];
+	if (node.lastUse == m_frame) {
+		return true;
+	}
+	node.lastUse = m_frame;
+	if (!node.pinned) {
+		Unlink(found->second);
+		Link(found->second);
+	}
+	return true;
+}
+
+void ResidencyManager::SetPinned(const ResidentTile& tile, bool pinned)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const TileId id = GetTileId(tile);
+	if (pinned) {
+		m_pins.insert(id);
+	}
+	else {
+		m_pins.erase(id);
+	}
+
+	auto found = m_index.find(id);
+	if (found == m_index.end()) {
+		return;
+	}
+
+	Node& node = m_nodes[found->second];
+	if (node.pinned == pinned) {
+		return;
+	}
+
+	node.pinned = pinned;
+	if (pinned) {
+		Unlink(found->second);
+	}
+	else {
+		// Count the unpin as a use so the tile is not evicted straight away
+		node.lastUse = m_frame;
+		Link(found->second);
+	}
+}
+
+uint32_t ResidencyManager::SelectVictims(uint32_t count, std::vector<ResidentTile>& outVictims)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (uint32_t i = 0; i < count; ++i) {
+		uint32_t victim = NIL;
+		float victimScore = -1.0f;
+		for (const auto& [owner, list] : m_owners) {
+			// The head is the owner's least recent tile; if it was used this
+			// frame, so was the rest of the list
+			if (list.head == NIL || m_nodes[list.head].lastUse == m_frame) {
+				continue;
+			}
+			const float idleFrames = static_cast<float>(m_frame - m_nodes[list.head].lastUse);
+			const float score = (idleFrames + 1.0f) / list.weight;
+			if (score > victimScore) {
+				victimScore = score;
+				victim = list.head;
+			}
+		}
+
+		if (victim == NIL) {
+			return i;
+		}
+
+		outVictims.push_back(m_nodes[victim].tile);
+		m_index.erase(GetTileId(m_nodes[victim].tile));
+		FreeNode(victim);
+	}
+	return count;
+}
+
+size_t ResidencyManager::TrackedTileCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_index.size();
+}
+
+void ResidencyManager::Link(uint32_t index)
+{
+	Node& node = m_nodes[index];
+	OwnerList& list = *node.list;
+	node.prev = list.tail;
+	node.next = NIL;
+	if (list.tail != NIL) {
+		m_nodes[list.tail].next = index;
+	}
+	else {
+		list.head = index;
+	}
+	list.tail = index;
+}
+
+void ResidencyManager::Unlink(uint32_t index)
+{
+	Node& node = m_nodes[index];
+	OwnerList& list = *node.list;
+	if (node.prev != NIL) {
+		m_nodes[node.prev].next = node.next;
+	}
+	else {
+		list.head = node.next;
+	}
+	if (node.next != NIL) {
+		m_nodes[node.next].prev = node.prev;
+	}
+	else {
+		list.tail = node.prev;
+	}
+	node.prev = NIL;
+	node.next = NIL;
+}
+
+void ResidencyManager::FreeNode(uint32_t index)
+{
+	if (!m_nodes[index].pinned) {
+		Unlink(index);
+	}
+	m_freeNodes.push_back(index);
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// A mapped tile; owner is the ReservedResource it belongs to
+struct ResidentTile {
+	void* owner;
+	uint32_t subresource;
+	uint32_t x, y, z;
+};
+
+// Tracks when each mapped tile was last used and picks eviction victims.
+//
+// Every owner keeps its unpinned tiles in an intrusive list ordered by last
+// use, so touching a tile just relinks it at the tail. Victims are the list
+// heads with the longest idle time divided by the owner's weight; that
+// costs one comparison per owner, however many tiles are tracked.
+class ResidencyManager {
+public:
+	// Call once per frame; tiles touched since count as used this frame
+	void AdvanceFrame();
+	uint64_t CurrentFrame() const;
+
+	// Tiles of an owner with weight w may sit idle w times as long as tiles
+	// of a weight-1 owner before they are evicted. Weights must be positive.
+	void SetOwnerWeight(void* owner, float weight);
+
+	// Forgets every tile and pin of owner
+	void RemoveOwner(void* owner);
+
+	// A newly mapped tile counts as used this frame. Adding a tracked tile
+	// touches it.
+	void AddTile(const ResidentTile& tile);
+	void RemoveTile(const ResidentTile& tile);
+
+	// Returns false if the tile is not tracked
+	bool Touch(const ResidentTile& tile);
+
+	// Pinned tiles are never chosen as victims. A pin outlives unmapping, so
+	// tiles can be pinned before they are loaded.
+	void SetPinned(const ResidentTile& tile, bool pinned);
+
+	// Stops tracking up to count unpinned tiles, least recently used by
+	// weighted idle time first, and appends them to outVictims. The caller
+	// unmaps them. Tiles used this frame are never chosen, so this returns
+	// fewer than count once only those are left.
+	uint32_t SelectVictims(uint32_t count, std::vector<ResidentTile>& outVictims);
+
+	size_t TrackedTileCount() const;
+
+private:
+	static constexpr uint32_t NIL = UINT32_MAX;
+
+	struct TileId {
+		void* owner;
+		uint64_t key;
+		bool operator==(const TileId& other) const { return owner == other.owner && key == other.key; }
+	};
+
+	struct TileIdHash {
+		size_t operator()(const TileId& id) const {
+			const uint64_t h = id.key * 0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t>(id.owner);
+			return static_cast<size_t>(h ^ (h >> 29));
+		}
+	};
+
+	struct OwnerList {
+		float weight = 1.0f;
+		uint32_t head = NIL;
+		uint32_t tail = NIL;
+	};
+
+	struct Node {
+		ResidentTile tile;
+		uint64_t lastUse;
+		uint32_t prev, next;
+		OwnerList* list;
+		bool pinned;
+	};
+
+	static TileId GetTileId(const ResidentTile& tile) {
+		return { tile.owner, ((uint64_t)tile.subresource << 48) | ((uint64_t)tile.x << 32) | ((uint64_t)tile.y << 16) | tile.z };
+	}
+
+	void Link(uint32_t index);
+	void Unlink(uint32_t index);
+	void FreeNode(uint32_t index);
+
+	uint64_t m_frame = 0;
+
+	std::vector<Node> m_nodes;
+	std::vector<uint32_t> m_freeNodes;
+	std::unordered_map<TileId, uint32_t, TileIdHash> m_index;
+
+	// Node-based, so OwnerList pointers held by nodes stay valid
+	std::unordered_map<void*, OwnerList> m_owners;
+	std::unordered_set<TileId, TileIdHash> m_pins;
+
+	mutable std::mutex m_mutex;
+};
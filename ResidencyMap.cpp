@@ -0,0 +1,241 @@
+#include "pch.h"
+#include "ResidencyMap.h"
+#include <algorithm>
+
+ResidencyMap::ResidencyMap(const ResourceTilingInfo& tilingInfo)
+	: m_standardMips(tilingInfo.NumPackedMips > 0 ? tilingInfo.NumStandardMips : tilingInfo.SubresourceCount)
+	, m_subresourceCount(tilingInfo.SubresourceCount)
+	, m_hasPackedTail(tilingInfo.NumPackedMips > 0)
+{
+	const uint32_t mipCount = m_standardMips;
+	m_mips.resize((std::max)(mipCount, 1u));
+
+	for (uint32_t m = 0; m < m_mips.size(); ++m) {
+		MipState& mip = m_mips[m];
+		if (m < mipCount) {
+			const SubresourceTilingInfo& sub = tilingInfo.subresourceTilingInfo[m];
+			mip.tileCounts[0] = sub.WidthInTiles;
+			mip.tileCounts[1] = sub.HeightInTiles;
+			mip.tileCounts[2] = sub.DepthInTiles;
+		}
+		else {
+			// Everything is packed; one cell stands for the whole tail
+			mip.tileCounts[0] = mip.tileCounts[1] = mip.tileCounts[2] = 1;
+		}
+
+		const size_t tileCount = static_cast<size_t>(mip.tileCounts[0]) * mip.tileCounts[1] * mip.tileCounts[2];
+		mip.mapped.assign((tileCount + 63) / 64, 0);
+		mip.values.assign(tileCount, static_cast<uint8_t>(m_subresourceCount));
+	}
+
+	const uint32_t* size = m_mips[0].tileCounts;
+	for (int a = 0; a < 3; ++a) {
+		m_brickCounts[a] = (size[a] + BRICK_SIZE[a] - 1) / BRICK_SIZE[a];
+	}
+
+	// The texture starts out undefined, so its first upload is the whole grid
+	MarkAllChanged();
+}
+
+void ResidencyMap::SetTileMapped(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z, bool mapped)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (subresource >= m_standardMips) {
+		return;
+	}
+
+	if (mapped) {
+		m_pending.push_back({ subresource, x, y, z });
+		return;
+	}
+
+	// Drop any pending publish of the same tile first
+	std::erase_if(m_pending, [&](const PendingTile& tile) {
+		return tile.subresource == subresource && tile.x == x && tile.y == y && tile.z == z;
+	});
+	SetMappedBit(subresource, x, y, z, false);
+}
+
+void ResidencyMap::SetPackedTailMapped(bool mapped)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_hasPackedTail) {
+		return;
+	}
+
+	m_tailPending = mapped;
+	if (!mapped) {
+		ApplyTail(false);
+	}
+}
+
+void ResidencyMap::ApplyTail(bool mapped)
+{
+	if (m_tailMapped == mapped) {
+		return;
+	}
+	m_tailMapped = mapped;
+
+	const uint32_t coarsest = static_cast<uint32_t>(m_mips.size() - 1);
+	const MipState& mip = m_mips[coarsest];
+	for (uint32_t z = 0; z < mip.tileCounts[2]; ++z)
+		for (uint32_t y = 0; y < mip.tileCounts[1]; ++y)
+			for (uint32_t x = 0; x < mip.tileCounts[0]; ++x)
+				Update(coarsest, x, y, z);
+}
+
+void ResidencyMap::PublishMapped()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_tailPending) {
+		ApplyTail(true);
+		m_tailPending = false;
+	}
+	for (const PendingTile& tile : m_pending) {
+		SetMappedBit(tile.subresource, tile.x, tile.y, tile.z, true);
+	}
+	m_pending.clear();
+}
+
+bool ResidencyMap::HasChanges() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return !m_changedBricks.empty();
+}
+
+void ResidencyMap::MarkAllChanged()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const uint32_t brickCount = m_brickCounts[0] * m_brickCounts[1] * m_brickCounts[2];
+	m_brickChanged.assign(brickCount, 1);
+	m_changedBricks.resize(brickCount);
+	for (uint32_t i = 0; i < brickCount; ++i) {
+		m_changedBricks[i] = brickCount - 1 - i;
+	}
+}
+
+size_t ResidencyMap::TakeChanges(size_t maxRegions, std::vector<ResidencyMapRegion>& outRegions, std::vector<uint8_t>& outCells)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const MipState& mip0 = m_mips[0];
+	size_t taken = 0;
+	while (taken < maxRegions && !m_changedBricks.empty()) {
+		const uint32_t brick = m_changedBricks.back();
+		m_changedBricks.pop_back();
+		m_brickChanged[brick] = 0;
+
+		const uint32_t coord[3] = {
+			brick % m_brickCounts[0],
+			(brick / m_brickCounts[0]) % m_brickCounts[1],
+			brick / (m_brickCounts[0] * m_brickCounts[1])
+		};
+		ResidencyMapRegion region;
+		for (int a = 0; a < 3; ++a) {
+			region.min[a] = coord[a] * BRICK_SIZE[a];
+			region.max[a] = (std::min)(region.min[a] + BRICK_SIZE[a], mip0.tileCounts[a]);
+		}
+		outRegions.push_back(region);
+
+		const uint32_t width = region.max[0] - region.min[0];
+		for (uint32_t z = region.min[2]; z < region.max[2]; ++z) {
+			for (uint32_t y = region.min[1]; y < region.max[1]; ++y) {
+				const uint8_t* row = mip0.values.data() + GetIndex(mip0, region.min[0], y, z);
+				outCells.insert(outCells.end(), row, row + width);
+			}
+		}
+		++taken;
+	}
+	return taken;
+}
+
+uint8_t ResidencyMap::GetCell(uint32_t x, uint32_t y, uint32_t z) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_mips[0].values[GetIndex(m_mips[0], x, y, z)];
+}
+
+void ResidencyMap::SetMappedBit(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z, bool mapped)
+{
+	MipState& mip = m_mips[subresource];
+	if (x >= mip.tileCounts[0] || y >= mip.tileCounts[1] || z >= mip.tileCounts[2]) {
+		return;
+	}
+
+	const size_t index = GetIndex(mip, x, y, z);
+	const uint64_t bit = 1ull << (index % 64);
+	if (mapped) {
+		mip.mapped[index / 64] |= bit;
+	}
+	else {
+		mip.mapped[index / 64] &= ~bit;
+	}
+	Update(subresource, x, y, z);
+}
+
+void ResidencyMap::Update(uint32_t mip, uint32_t x, uint32_t y, uint32_t z)
+{
+	MipState& state = m_mips[mip];
+	const size_t index = GetIndex(state, x, y, z);
+
+	uint8_t parentValue;
+	if (mip + 1 < m_mips.size()) {
+		const MipState& parent = m_mips[mip + 1];
+		parentValue = parent.values[GetIndex(parent,
+			(std::min)(x >> 1, parent.tileCounts[0] - 1),
+			(std::min)(y >> 1, parent.tileCounts[1] - 1),
+			(std::min)(z >> 1, parent.tileCounts[2] - 1))];
+	}
+	else {
+		parentValue = GetTailValue();
+	}
+
+	const uint8_t value = (IsMapped(state, index) && parentValue == mip + 1)
+		? static_cast<uint8_t>(mip)
+		: parentValue;
+	if (value == state.values[index]) {
+		return;
+	}
+	state.values[index] = value;
+
+	if (mip == 0) {
+		MarkChanged(x, y, z);
+		return;
+	}
+
+	// Children whose parent is this tile; at the far edge of an odd-sized
+	// mip the last tile also covers the child beyond its pair
+	const MipState& child = m_mips[mip - 1];
+	uint32_t lo[3], hi[3];
+	const uint32_t tile[3] = { x, y, z };
+	for (int a = 0; a < 3; ++a) {
+		lo[a] = (std::min)(tile[a] * 2, child.tileCounts[a] - 1);
+		hi[a] = tile[a] == state.tileCounts[a] - 1 ? child.tileCounts[a] - 1 : (std::min)(tile[a] * 2 + 1, child.tileCounts[a] - 1);
+	}
+	for (uint32_t cz = lo[2]; cz <= hi[2]; ++cz)
+		for (uint32_t cy = lo[1]; cy <= hi[1]; ++cy)
+			for (uint32_t cx = lo[0]; cx <= hi[0]; ++cx)
+				Update(mip - 1, cx, cy, cz);
+}
+
+uint8_t ResidencyMap::GetTailValue() const
+{
+	// Without a packed tail the chain simply ends below the coarsest mip
+	if (!m_hasPackedTail) {
+		return static_cast<uint8_t>(m_standardMips);
+	}
+	return static_cast<uint8_t>(m_tailMapped ? m_standardMips : m_subresourceCount);
+}
+
+void ResidencyMap::MarkChanged(uint32_t x, uint32_t y, uint32_t z)
+{
+	const uint32_t brick = ((z / BRICK_SIZE[2]) * m_brickCounts[1] + y / BRICK_SIZE[1]) * m_brickCounts[0] + x / BRICK_SIZE[0];
+	if (!m_brickChanged[brick]) {
+		m_brickChanged[brick] = 1;
+		m_changedBricks.push_back(brick);
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "TilingInfo.h"
+
+// Cell range of a residency map, inclusive min, exclusive max
+struct ResidencyMapRegion {
+	uint32_t min[3];
+	uint32_t max[3];
+};
+
+// One byte per mip 0 tile holding the finest mip m such that mips m and
+// coarser, through the packed tail, are all resident over that tile; the
+// subresource count where nothing is. Shaders clamp their LOD to it so they
+// never sample an unmapped tile.
+//
+// Each mip keeps the same value per tile, and a tile's value only depends
+// on whether it is mapped and on its parent's value, so a change is pushed
+// down to the children whose value actually changes and stops there.
+//
+// Newly mapped tiles, and the packed tail, are held back until
+// PublishMapped, so the map only claims data the caller knows has been
+// uploaded. Unmapped tiles leave the map at once.
+//
+// Changes are tracked per brick of BRICK_SIZE cells, so scattered updates
+// upload a few small boxes rather than one box spanning all of them.
+class ResidencyMap {
+public:
+	static constexpr uint32_t BRICK_SIZE[3] = { 32, 4, 4 };
+
+	explicit ResidencyMap(const ResourceTilingInfo& tilingInfo);
+
+	// Grid size in cells, the mip 0 tile counts
+	const uint32_t* Size() const { return m_mips[0].tileCounts; }
+
+	void SetTileMapped(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z, bool mapped);
+	void SetPackedTailMapped(bool mapped);
+
+	// Applies the tiles mapped since the last call
+	void PublishMapped();
+
+	bool HasChanges() const;
+
+	// Counts the whole grid as changed again, for when an upload of taken
+	// changes failed
+	void MarkAllChanged();
+
+	// Takes up to maxRegions changed bricks: appends their regions, and
+	// their cells to outCells region after region, x fastest, then y, then
+	// z. Returns the number taken. Until the first calls have taken
+	// everything, the whole grid counts as changed.
+	size_t TakeChanges(size_t maxRegions, std::vector<ResidencyMapRegion>& outRegions, std::vector<uint8_t>& outCells);
+
+	uint8_t GetCell(uint32_t x, uint32_t y, uint32_t z) const;
+
+private:
+	struct MipState {
+		uint32_t tileCounts[3];
+		std::vector<uint64_t> mapped;   // Published mapping, bit per tile
+		std::vector<uint8_t> values;
+	};
+
+	struct PendingTile {
+		uint32_t subresource;
+		uint32_t x, y, z;
+	};
+
+	size_t GetIndex(const MipState& mip, uint32_t x, uint32_t y, uint32_t z) const {
+		return (static_cast<size_t>(z) * mip.tileCounts[1] + y) * mip.tileCounts[0] + x;
+	}
+
+	bool IsMapped(const MipState& mip, size_t index) const {
+		return (mip.mapped[index / 64] >> (index % 64)) & 1;
+	}
+
+	void SetMappedBit(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z, bool mapped);
+
+	// Recomputes one tile's value and pushes a change down to its children
+	void Update(uint32_t mip, uint32_t x, uint32_t y, uint32_t z);
+
+	void ApplyTail(bool mapped);
+	uint8_t GetTailValue() const;
+
+	void MarkChanged(uint32_t x, uint32_t y, uint32_t z);
+
+	std::vector<MipState> m_mips;
+	uint32_t m_standardMips;
+	uint32_t m_subresourceCount;
+	bool m_hasPackedTail;
+	bool m_tailMapped = false;
+	bool m_tailPending = false;
+
+	std::vector<PendingTile> m_pending;
+
+	uint32_t m_brickCounts[3];
+	std::vector<uint8_t> m_brickChanged;
+	std::vector<uint32_t> m_changedBricks;
+
+	mutable std::mutex m_mutex;
+};
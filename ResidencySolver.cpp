@@ -0,0 +1,255 @@
+#include "pch.h"
+#include "ResidencySolver.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+ResidencySolver::ResidencySolver(const ResourceTilingInfo& tilingInfo, const ResidencySolverSettings& settings)
+{
+	const uint32_t tileTexels[3] = {
+		tilingInfo.TileWidthInTexels,
+		tilingInfo.TileHeightInTexels,
+		tilingInfo.TileDepthInTexels
+	};
+
+	for (int a = 0; a < 3; ++a) {
+		m_boundsMin[a] = settings.boundsMin[a];
+	}
+
+	const uint32_t mipCount = tilingInfo.NumPackedMips > 0 ? tilingInfo.NumStandardMips : tilingInfo.SubresourceCount;
+	m_mips.resize(mipCount);
+
+	for (uint32_t m = 0; m < mipCount; ++m) {
+		const SubresourceTilingInfo& sub = tilingInfo.subresourceTilingInfo[m];
+		MipState& mip = m_mips[m];
+		mip.tileCounts[0] = sub.WidthInTiles;
+		mip.tileCounts[1] = sub.HeightInTiles;
+		mip.tileCounts[2] = sub.DepthInTiles;
+		mip.rowWords = (sub.WidthInTiles + 63) / 64;
+		mip.radius = m < settings.mipRadii.size() ? settings.mipRadii[m] : 0.0f;
+
+		for (int a = 0; a < 3; ++a) {
+			const uint32_t mipTexels = (std::max)(1u, settings.volumeSize[a] >> m);
+			mip.tileSize[a] = (settings.boundsMax[a] - settings.boundsMin[a]) * tileTexels[a] / mipTexels;
+		}
+
+		if (mip.radius <= 0.0f) {
+			continue;
+		}
+
+		const size_t words = static_cast<size_t>(mip.rowWords) * sub.HeightInTiles * sub.DepthInTiles;
+		mip.desired.assign(words, 0);
+		mip.missing.assign(words, 0);
+		mip.nextRow.assign(mip.rowWords, 0);
+	}
+}
+
+void ResidencySolver::Solve(
+	const float cameraPosition[3],
+	const TileResidencyQuery& isMapped,
+	bool recheckMapped,
+	ResidencyWorkList& outWork)
+{
+	const uint32_t mipCount = static_cast<uint32_t>(m_mips.size());
+
+	for (uint32_t m = 0; m < mipCount; ++m) {
+		SolveMip(m_mips[m], m, cameraPosition, isMapped, recheckMapped);
+	}
+
+	// Coarse mips first: they cover the most screen per tile and are what
+	// sampling falls back to while finer tiles load
+	for (uint32_t m = mipCount; m-- > 0;) {
+		MipState& mip = m_mips[m];
+		outWork.uploads.insert(outWork.uploads.end(), mip.uploads.begin(), mip.uploads.end());
+		mip.uploads.clear();
+	}
+	for (uint32_t m = 0; m < mipCount; ++m) {
+		MipState& mip = m_mips[m];
+		outWork.unmaps.insert(outWork.unmaps.end(), mip.unmaps.begin(), mip.unmaps.end());
+		mip.unmaps.clear();
+	}
+}
+
+size_t ResidencySolver::DesiredTileCount() const
+{
+	size_t count = 0;
+	for (const MipState& mip : m_mips) {
+		for (uint64_t word : mip.desired) {
+			count += std::popcount(word);
+		}
+	}
+	return count;
+}
+
+void ResidencySolver::SolveMip(MipState& mip, uint32_t subresource, const float* camera, const TileResidencyQuery& isMapped, bool recheckMapped)
+{
+	if (mip.radius <= 0.0f) {
+		return;
+	}
+
+	const TileRegion region = GetSphereRegion(mip, camera);
+	const TileRegion& previous = mip.region;
+
+	// Every row whose desired bits can change lies in one of the two regions
+	if (!region.empty || !previous.empty) {
+		TileRegion rows;
+		for (int a = 0; a < 3; ++a) {
+			if (region.empty) {
+				rows.min[a] = previous.min[a];
+				rows.max[a] = previous.max[a];
+			}
+			else if (previous.empty) {
+				rows.min[a] = region.min[a];
+				rows.max[a] = region.max[a];
+			}
+			else {
+				rows.min[a] = (std::min)(region.min[a], previous.min[a]);
+				rows.max[a] = (std::max)(region.max[a], previous.max[a]);
+			}
+		}
+
+		const uint32_t firstWord = rows.min[0] / 64;
+		const uint32_t lastWord = rows.max[0] / 64;
+		uint64_t* next = mip.nextRow.data();
+
+		for (uint32_t z = rows.min[2]; z <= rows.max[2]; ++z) {
+			for (uint32_t y = rows.min[1]; y <= rows.max[1]; ++y) {
+				std::fill(next + firstWord, next + lastWord + 1, 0ull);
+				if (!region.empty &&
+					y >= region.min[1] && y <= region.max[1] &&
+					z >= region.min[2] && z <= region.max[2]) {
+					BuildRow(mip, camera, y, z, next);
+				}
+
+				const size_t rowBase = (static_cast<size_t>(z) * mip.tileCounts[1] + y) * mip.rowWords;
+				for (uint32_t w = firstWord; w <= lastWord; ++w) {
+					uint64_t& desired = mip.desired[rowBase + w];
+					uint64_t& missing = mip.missing[rowBase + w];
+					const uint64_t added = next[w] & ~desired;
+					uint64_t removed = desired & ~next[w];
+					desired = next[w];
+					missing = (missing | added) & ~removed;
+
+					while (removed) {
+						const uint32_t x = w * 64 + std::countr_zero(removed);
+						removed &= removed - 1;
+						if (isMapped(subresource, x, y, z)) {
+							mip.unmaps.push_back({ subresource, x, y, z, TileDistance(mip, camera, x, y, z) });
+						}
+					}
+				}
+			}
+		}
+	}
+	mip.region = region;
+
+	if (region.empty) {
+		return;
+	}
+
+	// Desired bits only exist inside the current region
+	const uint32_t firstWord = region.min[0] / 64;
+	const uint32_t lastWord = region.max[0] / 64;
+	for (uint32_t z = region.min[2]; z <= region.max[2]; ++z) {
+		for (uint32_t y = region.min[1]; y <= region.max[1]; ++y) {
+			const size_t rowBase = (static_cast<size_t>(z) * mip.tileCounts[1] + y) * mip.rowWords;
+			for (uint32_t w = firstWord; w <= lastWord; ++w) {
+				uint64_t& missing = mip.missing[rowBase + w];
+				if (recheckMapped) {
+					missing = mip.desired[rowBase + w];
+				}
+
+				uint64_t bits = missing;
+				while (bits) {
+					const uint32_t bit = std::countr_zero(bits);
+					bits &= bits - 1;
+					const uint32_t x = w * 64 + bit;
+					if (isMapped(subresource, x, y, z)) {
+						missing &= ~(1ull << bit);
+					}
+					else {
+						mip.uploads.push_back({ subresource, x, y, z, TileDistance(mip, camera, x, y, z) });
+					}
+				}
+			}
+		}
+	}
+
+	std::sort(mip.uploads.begin(), mip.uploads.end(), [](const SolverTile& a, const SolverTile& b) {
+		return a.distance < b.distance;
+	});
+	std::sort(mip.unmaps.begin(), mip.unmaps.end(), [](const SolverTile& a, const SolverTile& b) {
+		return a.distance > b.distance;
+	});
+}
+
+ResidencySolver::TileRegion ResidencySolver::GetSphereRegion(const MipState& mip, const float* camera) const
+{
+	TileRegion region;
+	for (int a = 0; a < 3; ++a) {
+		const float lo = std::floor((camera[a] - mip.radius - m_boundsMin[a]) / mip.tileSize[a]);
+		const float hi = std::floor((camera[a] + mip.radius - m_boundsMin[a]) / mip.tileSize[a]);
+		if (hi < 0.0f || lo >= static_cast<float>(mip.tileCounts[a])) {
+			return region;
+		}
+		region.min[a] = static_cast<uint32_t>((std::max)(lo, 0.0f));
+		region.max[a] = static_cast<uint32_t>((std::min)(hi, static_cast<float>(mip.tileCounts[a] - 1)));
+	}
+	region.empty = false;
+	return region;
+}
+
+void ResidencySolver::BuildRow(const MipState& mip, const float* camera, uint32_t y, uint32_t z, uint64_t* row) const
+{
+	// Distance from the camera to the row's slab in y and z; what is left
+	// of the radius is the half-chord the row covers in x
+	auto axisGap = [&](int a, uint32_t tile) {
+		const float lo = m_boundsMin[a] + tile * mip.tileSize[a];
+		const float hi = lo + mip.tileSize[a];
+		return (std::max)((std::max)(lo - camera[a], camera[a] - hi), 0.0f);
+	};
+
+	const float dy = axisGap(1, y);
+	const float dz = axisGap(2, z);
+	const float remaining = mip.radius * mip.radius - dy * dy - dz * dz;
+	if (remaining < 0.0f) {
+		return;
+	}
+
+	const float halfChord = std::sqrt(remaining);
+	const float lo = std::floor((camera[0] - halfChord - m_boundsMin[0]) / mip.tileSize[0]);
+	const float hi = std::floor((camera[0] + halfChord - m_boundsMin[0]) / mip.tileSize[0]);
+	if (hi < 0.0f || lo >= static_cast<float>(mip.tileCounts[0])) {
+		return;
+	}
+
+	const uint32_t first = static_cast<uint32_t>((std::max)(lo, 0.0f));
+	const uint32_t last = static_cast<uint32_t>((std::min)(hi, static_cast<float>(mip.tileCounts[0] - 1)));
+
+	// Fill [first, last] a word at a time
+	const uint32_t firstWord = first / 64;
+	const uint32_t lastWord = last / 64;
+	const uint64_t firstMask = ~0ull << (first % 64);
+	const uint64_t lastMask = ~0ull >> (63 - last % 64);
+	if (firstWord == lastWord) {
+		row[firstWord] |= firstMask & lastMask;
+		return;
+	}
+	row[firstWord] |= firstMask;
+	for (uint32_t w = firstWord + 1; w < lastWord; ++w) {
+		row[w] = ~0ull;
+	}
+	row[lastWord] |= lastMask;
+}
+
+float ResidencySolver::TileDistance(const MipState& mip, const float* camera, uint32_t x, uint32_t y, uint32_t z) const
+{
+	const uint32_t tile[3] = { x, y, z };
+	float distanceSquared = 0.0f;
+	for (int a = 0; a < 3; ++a) {
+		const float center = m_boundsMin[a] + (tile[a] + 0.5f) * mip.tileSize[a];
+		const float d = center - camera[a];
+		distanceSquared += d * d;
+	}
+	return std::sqrt(distanceSquared);
+}
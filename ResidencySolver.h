@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "TilingInfo.h"
+#include "TilePrefetcher.h"
+
+struct SolverTile {
+	uint32_t subresource;
+	uint32_t x, y, z;
+	float distance;   // Camera to tile center, world units
+};
+
+struct ResidencyWorkList {
+	// Desired but not mapped, listed by every solve until they are: coarser
+	// mips first, then nearest first
+	std::vector<SolverTile> uploads;
+
+	// Mapped but no longer desired: finer mips first, then farthest first
+	std::vector<SolverTile> unmaps;
+};
+
+struct ResidencySolverSettings {
+	// World-space box the volume fills, and its mip 0 size in texels
+	float boundsMin[3];
+	float boundsMax[3];
+	uint32_t volumeSize[3];
+
+	// Per mip, in world units. Tiles touching the sphere around the camera
+	// are desired. Mips without a positive radius, and the packed tail, are
+	// left alone.
+	std::vector<float> mipRadii;
+};
+
+// Keeps the set of tiles the camera wants resident as one bitset per mip,
+// a row of tiles per run of 64-bit words. Each solve only rebuilds the rows
+// under last frame's sphere and this frame's: a row's span comes straight
+// from the sphere's chord, and the old and new rows are diffed a word (64
+// tiles) at a time. Desired tiles that are not yet mapped stay in a second
+// bitset and are checked against the resource until they are, so a solve
+// costs rows touched plus tiles still missing, not the size of the sphere.
+class ResidencySolver {
+public:
+	ResidencySolver(const ResourceTilingInfo& tilingInfo, const ResidencySolverSettings& settings);
+
+	// cameraPosition is in world space. With recheckMapped set, every
+	// desired tile is looked up again; use it when tiles may have been
+	// unmapped outside the solver (eviction, explicit unmaps).
+	void Solve(
+		const float cameraPosition[3],
+		const TileResidencyQuery& isMapped,
+		bool recheckMapped,
+		ResidencyWorkList& outWork
+	);
+
+	size_t DesiredTileCount() const;
+
+	// Resource unmap count the last solve's results were based on; kept
+	// here for the caller
+	uint64_t MappingGeneration() const { return m_mappingGeneration; }
+	void SetMappingGeneration(uint64_t generation) { m_mappingGeneration = generation; }
+
+private:
+	struct TileRegion {
+		uint32_t min[3];
+		uint32_t max[3];   // Inclusive
+		bool empty = true;
+	};
+
+	struct MipState {
+		uint32_t tileCounts[3];
+		uint32_t rowWords;
+		float tileSize[3];   // World size of one tile
+		float radius;
+
+		std::vector<uint64_t> desired;
+		std::vector<uint64_t> missing;
+		std::vector<uint64_t> nextRow;
+		TileRegion region;   // Sphere footprint of the last solve
+
+		std::vector<SolverTile> uploads;
+		std::vector<SolverTile> unmaps;
+	};
+
+	void SolveMip(MipState& mip, uint32_t subresource, const float* camera, const TileResidencyQuery& isMapped, bool recheckMapped);
+
+	TileRegion GetSphereRegion(const MipState& mip, const float* camera) const;
+
+	// Sets the bits of the tiles in row (y, z) that touch the sphere
+	void BuildRow(const MipState& mip, const float* camera, uint32_t y, uint32_t z, uint64_t* row) const;
+
+	float TileDistance(const MipState& mip, const float* camera, uint32_t x, uint32_t y, uint32_t z) const;
+
+	std::vector<MipState> m_mips;
+	float m_boundsMin[3];
+	uint64_t m_mappingGeneration = 0;
+};
@@ -0,0 +1,503 @@
+#include "pch.h"
+#include "SoftwareBackend.h"
+#include "BlockCompression.h"
+#include "FixedHeap.h"
+#include "ReservedResource.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <thread>
+
+namespace {
+
+// One texel, or one 4x4 block for BC formats
+struct ElementInfo {
+	UINT bytes;      // 0 for formats volumes cannot use
+	UINT blockSize;  // Texels per element along x and y
+};
+
+ElementInfo GetElementInfo(DXGI_FORMAT format)
+{
+	const uint32_t bytesPerBlock = GetBytesPerBlock(format);
+	if (bytesPerBlock != 0) {
+		return { bytesPerBlock, 4 };
+	}
+
+	switch (format) {
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		return { 16, 1 };
+
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R32G32_FLOAT:
+		return { 8, 1 };
+
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R11G11B10_FLOAT:
+	case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+	case DXGI_FORMAT_R16G16_FLOAT:
+	case DXGI_FORMAT_R32_FLOAT:
+	case DXGI_FORMAT_R32_UINT:
+	case DXGI_FORMAT_R32_SINT:
+		return { 4, 1 };
+
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_R16_UINT:
+	case DXGI_FORMAT_R16_SINT:
+	case DXGI_FORMAT_R8G8_UNORM:
+		return { 2, 1 };
+
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_R8_UINT:
+	case DXGI_FORMAT_R8_SINT:
+		return { 1, 1 };
+
+	default:
+		return { 0, 1 };
+	}
+}
+
+// Standard 64KB tile shapes for 3D textures, in elements
+void GetTileShape(UINT bytesPerElement, UINT* outWidth, UINT* outHeight, UINT* outDepth)
+{
+	switch (bytesPerElement) {
+	case 1:  *outWidth = 64; *outHeight = 32; *outDepth = 32; break;
+	case 2:  *outWidth = 32; *outHeight = 32; *outDepth = 32; break;
+	case 4:  *outWidth = 32; *outHeight = 32; *outDepth = 16; break;
+	case 8:  *outWidth = 32; *outHeight = 16; *outDepth = 16; break;
+	default: *outWidth = 16; *outHeight = 16; *outDepth = 16; break;
+	}
+}
+
+UINT64 AlignUp(UINT64 value, UINT64 alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+UINT CeilDivide(UINT value, UINT divisor)
+{
+	return (value + divisor - 1) / divisor;
+}
+
+} // namespace
+
+SoftwareBackend::SoftwareBackend(const SoftwareBackendSettings& settings)
+	: m_settings(settings)
+{
+}
+
+bool SoftwareBackend::Initialize(UINT slotCount, UINT64 tileStagingBytes, UINT64 batchStagingBytes)
+{
+	const UINT64 sizes[2] = { tileStagingBytes, batchStagingBytes };
+	for (UINT buffer = 0; buffer < 2; ++buffer) {
+		m_staging[buffer].clear();
+		for (UINT i = 0; i < slotCount; ++i) {
+			m_staging[buffer].push_back(std::make_unique<std::byte[]>(static_cast<size_t>(sizes[buffer])));
+		}
+	}
+	return true;
+}
+
+std::unique_ptr<IHeap> SoftwareBackend::CreateTileHeap(UINT64 sizeInBytes)
+{
+	auto heap = std::make_unique<FixedHeap>(nullptr, sizeInBytes);
+
+	// Left uninitialized, so the OS only commits pages copies touch
+	std::lock_guard<std::mutex> lock(m_mappingMutex);
+	m_heapSize = static_cast<UINT64>(heap->GetTotalCapacityInTiles()) * TILE_SIZE;
+	m_heapMemory.reset(new std::byte[static_cast<size_t>(m_heapSize)]);
+	m_pageTables.clear();
+	m_stats.tilesMapped = 0;
+	return heap;
+}
+
+std::unique_ptr<ReservedResource> SoftwareBackend::CreateReservedResource(
+	UINT width, UINT height, UINT depth,
+	bool useMipMaps, UINT mipCount,
+	DXGI_FORMAT format,
+	D3D12_TEXTURE_LAYOUT layout)
+{
+	const ElementInfo element = GetElementInfo(format);
+	if (element.bytes == 0 || width == 0 || height == 0 || depth == 0 || mipCount == 0) {
+		return nullptr;
+	}
+
+	UINT tileWidth, tileHeight, tileDepth;
+	GetTileShape(element.bytes, &tileWidth, &tileHeight, &tileDepth);
+
+	ResourceTilingInfo tiling;
+	tiling.TileWidthInTexels = tileWidth * element.blockSize;
+	tiling.TileHeightInTexels = tileHeight * element.blockSize;
+	tiling.TileDepthInTexels = tileDepth;
+	tiling.SubresourceCount = mipCount;
+
+	// Mips stay standard while they cover at least one whole tile; the
+	// first one that does not starts the packed tail
+	UINT tileCount = 0;
+	UINT standardMips = 0;
+	for (UINT mip = 0; mip < mipCount; ++mip) {
+		const UINT mipWidth = (std::max)(1u, width >> mip);
+		const UINT mipHeight = (std::max)(1u, height >> mip);
+		const UINT mipDepth = (std::max)(1u, depth >> mip);
+
+		if (standardMips == mip
+			&& mipWidth >= tiling.TileWidthInTexels
+			&& mipHeight >= tiling.TileHeightInTexels
+			&& mipDepth >= tiling.TileDepthInTexels) {
+			SubresourceTilingInfo subresource = {
+				CeilDivide(mipWidth, tiling.TileWidthInTexels),
+				CeilDivide(mipHeight, tiling.TileHeightInTexels),
+				CeilDivide(mipDepth, tiling.TileDepthInTexels),
+				tileCount
+			};
+			tileCount += subresource.WidthInTiles * subresource.HeightInTiles * subresource.DepthInTiles;
+			tiling.subresourceTilingInfo.push_back(subresource);
+			++standardMips;
+		}
+		else {
+			tiling.subresourceTilingInfo.push_back({ 0, 0, 0, D3D12_PACKED_TILE });
+		}
+	}
+
+	tiling.NumStandardMips = standardMips;
+	tiling.NumPackedMips = mipCount - standardMips;
+	tiling.PackedMipStartTileIndex = tileCount;
+	tiling.NumTilesForPackedMips = 0;
+	if (tiling.NumPackedMips > 0) {
+		// The tail holds the packed mips in their copyable footprint layout
+		D3D12_RESOURCE_DESC desc = {};
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+		desc.Width = width;
+		desc.Height = height;
+		desc.DepthOrArraySize = static_cast<UINT16>(depth);
+		desc.MipLevels = static_cast<UINT16>(mipCount);
+		desc.Format = format;
+
+		UINT64 tailBytes = 0;
+		GetCopyableFootprints(desc, standardMips, tiling.NumPackedMips, nullptr, nullptr, nullptr, &tailBytes);
+		tiling.NumTilesForPackedMips = static_cast<UINT>(AlignUp(tailBytes, TILE_SIZE) / TILE_SIZE);
+	}
+
+	return std::make_unique<ReservedResource>(
+		width, height, depth,
+		useMipMaps, mipCount,
+		format, tiling, layout);
+}
+
+void SoftwareBackend::GetCopyableFootprints(
+	const D3D12_RESOURCE_DESC& desc,
+	UINT firstSubresource, UINT subresourceCount,
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT* outFootprints,
+	UINT* outRowCounts,
+	UINT64* outRowSizes,
+	UINT64* outTotalBytes)
+{
+	const ElementInfo element = GetElementInfo(desc.Format);
+	UINT64 offset = 0;
+	UINT64 totalBytes = 0;
+
+	for (UINT i = 0; i < subresourceCount; ++i) {
+		const UINT mip = firstSubresource + i;
+		const UINT mipWidth = (std::max)(1u, static_cast<UINT>(desc.Width >> mip));
+		const UINT mipHeight = (std::max)(1u, desc.Height >> mip);
+		const UINT mipDepth = (std::max)(1u, static_cast<UINT>(desc.DepthOrArraySize) >> mip);
+
+		const UINT elementsWide = CeilDivide(mipWidth, element.blockSize);
+		const UINT rowCount = CeilDivide(mipHeight, element.blockSize);
+		const UINT64 rowSize = static_cast<UINT64>(elementsWide) * element.bytes;
+		const UINT rowPitch = static_cast<UINT>(AlignUp(rowSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT));
+		offset = AlignUp(offset, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+		if (outFootprints) {
+			D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = outFootprints[i];
+			footprint.Offset = offset;
+			footprint.Footprint.Format = desc.Format;
+			footprint.Footprint.Width = elementsWide * element.blockSize;
+			footprint.Footprint.Height = rowCount * element.blockSize;
+			footprint.Footprint.Depth = mipDepth;
+			footprint.Footprint.RowPitch = rowPitch;
+		}
+		if (outRowCounts) {
+			outRowCounts[i] = rowCount;
+		}
+		if (outRowSizes) {
+			outRowSizes[i] = rowSize;
+		}
+
+		// The last row of a subresource needs no padding
+		const UINT64 rows = static_cast<UINT64>(rowCount) * mipDepth;
+		totalBytes = offset + (rows - 1) * rowPitch + rowSize;
+		offset += rows * rowPitch;
+	}
+
+	if (outTotalBytes) {
+		*outTotalBytes = totalBytes;
+	}
+}
+
+std::byte* SoftwareBackend::GetStagingMemory(StagingBuffer buffer, UINT slotIndex) const
+{
+	return m_staging[static_cast<UINT>(buffer)][slotIndex].get();
+}
+
+UINT SoftwareBackend::ResourceTileIndex(const ReservedResource* resource, const D3D12_TILED_RESOURCE_COORDINATE& coord)
+{
+	const ResourceTilingInfo& tiling = resource->GetTilingInfo();
+	if (coord.Subresource >= tiling.SubresourceCount) {
+		return UINT_MAX;
+	}
+
+	// Packed tiles are addressed by index along X of the first packed mip
+	if (tiling.IsPackedMip(coord.Subresource)) {
+		return coord.X < tiling.NumTilesForPackedMips && coord.Y == 0 && coord.Z == 0
+			? tiling.PackedMipStartTileIndex + coord.X
+			: UINT_MAX;
+	}
+
+	const SubresourceTilingInfo& subresource = tiling.subresourceTilingInfo[coord.Subresource];
+	if (coord.X >= subresource.WidthInTiles || coord.Y >= subresource.HeightInTiles || coord.Z >= subresource.DepthInTiles) {
+		return UINT_MAX;
+	}
+	return subresource.StartTileIndex
+		+ coord.X + subresource.WidthInTiles * (coord.Y + subresource.HeightInTiles * coord.Z);
+}
+
+void SoftwareBackend::AppendRegionTiles(
+	const ReservedResource* resource,
+	const D3D12_TILED_RESOURCE_COORDINATE& coord,
+	const D3D12_TILE_REGION_SIZE& size,
+	std::vector<UINT>& outTiles)
+{
+	if (size.UseBox) {
+		for (UINT z = 0; z < size.Depth; ++z) {
+			for (UINT y = 0; y < size.Height; ++y) {
+				for (UINT x = 0; x < size.Width; ++x) {
+					D3D12_TILED_RESOURCE_COORDINATE tile = coord;
+					tile.X += x;
+					tile.Y += y;
+					tile.Z += z;
+					outTiles.push_back(ResourceTileIndex(resource, tile));
+				}
+			}
+		}
+		return;
+	}
+
+	// Without a box, tiles run on in the resource's overall tile order
+	const ResourceTilingInfo& tiling = resource->GetTilingInfo();
+	const UINT totalTiles = tiling.PackedMipStartTileIndex + tiling.NumTilesForPackedMips;
+	const UINT first = ResourceTileIndex(resource, coord);
+	for (UINT i = 0; i < size.NumTiles; ++i) {
+		outTiles.push_back(first != UINT_MAX && first + i < totalTiles ? first + i : UINT_MAX);
+	}
+}
+
+void SoftwareBackend::UpdateTileMappings(
+	ReservedResource* resource,
+	UINT regionCount,
+	const D3D12_TILED_RESOURCE_COORDINATE* regionCoords,
+	const D3D12_TILE_REGION_SIZE* regionSizes,
+	IHeap* heap,
+	UINT rangeCount,
+	const D3D12_TILE_RANGE_FLAGS* rangeFlags,
+	const UINT* heapRangeStartOffsets,
+	const UINT* rangeTileCounts)
+{
+	std::vector<UINT> tiles;
+	for (UINT region = 0; region < regionCount; ++region) {
+		AppendRegionTiles(resource, regionCoords[region], regionSizes[region], tiles);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mappingMutex);
+	std::unordered_map<UINT, UINT>& pageTable = m_pageTables[resource];
+	const UINT heapTiles = static_cast<UINT>(m_heapSize / TILE_SIZE);
+
+	// Ranges consume the regions' tiles in order; without counts, a single
+	// range covers all of them
+	size_t next = 0;
+	for (UINT range = 0; range < rangeCount && next < tiles.size(); ++range) {
+		const D3D12_TILE_RANGE_FLAGS flags = rangeFlags ? rangeFlags[range] : D3D12_TILE_RANGE_FLAG_NONE;
+		const UINT count = rangeTileCounts ? rangeTileCounts[range] : static_cast<UINT>(tiles.size() - next);
+
+		for (UINT i = 0; i < count && next < tiles.size(); ++i, ++next) {
+			const UINT tile = tiles[next];
+			if (tile == UINT_MAX || (flags & D3D12_TILE_RANGE_FLAG_SKIP)) {
+				continue;
+			}
+			if (flags & D3D12_TILE_RANGE_FLAG_NULL) {
+				m_stats.tilesMapped -= pageTable.erase(tile);
+				continue;
+			}
+			if (!heap || !heapRangeStartOffsets) {
+				continue;
+			}
+
+			const UINT heapTile = heapRangeStartOffsets[range]
+				+ ((flags & D3D12_TILE_RANGE_FLAG_REUSE_SINGLE_TILE) ? 0 : i);
+			if (heapTile < heapTiles && pageTable.insert_or_assign(tile, heapTile).second) {
+				m_stats.tilesMapped++;
+			}
+		}
+	}
+
+	if (pageTable.empty()) {
+		m_pageTables.erase(resource);
+	}
+}
+
+void SoftwareBackend::WriteTiles(const ReservedResource* resource, UINT firstTile, UINT64 byteOffset, const std::byte* source, UINT64 size)
+{
+	auto pageTable = m_pageTables.find(resource);
+	while (size > 0) {
+		const UINT tile = firstTile + static_cast<UINT>(byteOffset / TILE_SIZE);
+		const UINT64 offsetInTile = byteOffset % TILE_SIZE;
+		const UINT64 chunk = (std::min)(size, TILE_SIZE - offsetInTile);
+
+		if (pageTable != m_pageTables.end()) {
+			auto page = pageTable->second.find(tile);
+			if (page != pageTable->second.end()) {
+				memcpy(m_heapMemory.get() + page->second * TILE_SIZE + offsetInTile, source, static_cast<size_t>(chunk));
+				m_stats.bytesCopied += chunk;
+			}
+		}
+
+		source += chunk;
+		byteOffset += chunk;
+		size -= chunk;
+	}
+}
+
+bool SoftwareBackend::ExecuteCopies(const UploadSubmission* submissions, UINT /*allocatorSlot*/)
+{
+	std::vector<UINT> tiles;
+	std::lock_guard<std::mutex> lock(m_mappingMutex);
+
+	for (const UploadSubmission* s = submissions; s; s = s->next) {
+		const std::byte* source = GetStagingMemory(s->sourceBuffer, s->slotIndex) + s->sourceOffset;
+
+		if (s->footprintCount > 0) {
+			// Residency map textures have no backing here
+			if (s->footprintTarget) {
+				continue;
+			}
+
+			// Packed mips land in the tail at their footprint offsets
+			const ResourceTilingInfo& tiling = s->resource->GetTilingInfo();
+			const UINT64 base = s->footprints[0].Offset;
+			for (UINT i = 0; i < s->footprintCount; ++i) {
+				const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = s->footprints[i];
+				const ElementInfo element = GetElementInfo(footprint.Footprint.Format);
+				const UINT64 rows = static_cast<UINT64>(footprint.Footprint.Height / element.blockSize) * footprint.Footprint.Depth;
+				const UINT64 rowSize = static_cast<UINT64>(footprint.Footprint.Width / element.blockSize) * element.bytes;
+				const UINT64 size = (rows - 1) * footprint.Footprint.RowPitch + rowSize;
+				WriteTiles(s->resource, tiling.PackedMipStartTileIndex, footprint.Offset - base, source + footprint.Offset, size);
+			}
+			continue;
+		}
+
+		tiles.clear();
+		AppendRegionTiles(s->resource, s->startCoord, s->regionSize, tiles);
+		auto pageTable = m_pageTables.find(s->resource);
+		for (size_t i = 0; i < tiles.size(); ++i) {
+			// Like the GPU, writes to unmapped tiles go nowhere
+			if (pageTable == m_pageTables.end()) {
+				m_stats.tilesDropped++;
+				continue;
+			}
+			auto page = pageTable->second.find(tiles[i]);
+			if (page == pageTable->second.end()) {
+				m_stats.tilesDropped++;
+				continue;
+			}
+			memcpy(m_heapMemory.get() + page->second * TILE_SIZE, source + i * TILE_SIZE, TILE_SIZE);
+			m_stats.tilesCopied++;
+			m_stats.bytesCopied += TILE_SIZE;
+		}
+	}
+
+	return true;
+}
+
+void SoftwareBackend::RetireDueSignals(Clock::time_point now)
+{
+	while (!m_pendingSignals.empty() && m_pendingSignals.front().due <= now) {
+		m_completedValue = (std::max)(m_completedValue, m_pendingSignals.front().value);
+		m_pendingSignals.pop_front();
+	}
+}
+
+bool SoftwareBackend::Signal(UINT64 fenceValue)
+{
+	std::lock_guard<std::mutex> lock(m_fenceMutex);
+	const Clock::time_point now = Clock::now();
+	Clock::time_point due = now + std::chrono::nanoseconds(m_settings.fenceLatencyNs);
+	if (!m_pendingSignals.empty()) {
+		due = (std::max)(due, m_pendingSignals.back().due);
+	}
+	m_pendingSignals.push_back({ fenceValue, due });
+	RetireDueSignals(now);
+	return true;
+}
+
+UINT64 SoftwareBackend::GetCompletedFenceValue()
+{
+	std::lock_guard<std::mutex> lock(m_fenceMutex);
+	RetireDueSignals(Clock::now());
+	return m_completedValue;
+}
+
+void SoftwareBackend::WaitForFence(UINT64 fenceValue)
+{
+	Clock::time_point due;
+	{
+		std::lock_guard<std::mutex> lock(m_fenceMutex);
+		RetireDueSignals(Clock::now());
+		if (m_completedValue >= fenceValue) {
+			return;
+		}
+
+		auto signal = std::find_if(m_pendingSignals.begin(), m_pendingSignals.end(),
+			[fenceValue](const PendingSignal& pending) { return pending.value >= fenceValue; });
+		if (signal == m_pendingSignals.end()) {
+			// Never signalled; a device would wait forever
+			return;
+		}
+		due = signal->due;
+	}
+
+	std::this_thread::sleep_until(due);
+
+	std::lock_guard<std::mutex> lock(m_fenceMutex);
+	RetireDueSignals(Clock::now());
+}
+
+bool SoftwareBackend::ReadTile(
+	const ReservedResource* resource,
+	UINT subresource,
+	UINT x, UINT y, UINT z,
+	std::byte* outTile) const
+{
+	D3D12_TILED_RESOURCE_COORDINATE coord = {};
+	coord.X = x;
+	coord.Y = y;
+	coord.Z = z;
+	coord.Subresource = subresource;
+	const UINT tile = ResourceTileIndex(resource, coord);
+
+	std::lock_guard<std::mutex> lock(m_mappingMutex);
+	auto pageTable = m_pageTables.find(resource);
+	if (tile == UINT_MAX || pageTable == m_pageTables.end()) {
+		return false;
+	}
+	auto page = pageTable->second.find(tile);
+	if (page == pageTable->second.end()) {
+		return false;
+	}
+	memcpy(outTile, m_heapMemory.get() + page->second * TILE_SIZE, TILE_SIZE);
+	return true;
+}
+
+SoftwareBackendStats SoftwareBackend::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mappingMutex);
+	return m_stats;
+}
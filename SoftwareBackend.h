@@ -0,0 +1,129 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "GpuBackend.h"
+
+struct SoftwareBackendSettings {
+	// How long after its signal a fence value completes. Values still
+	// complete in order, so a signal never overtakes an earlier one.
+	uint64_t fenceLatencyNs = 0;
+};
+
+struct SoftwareBackendStats {
+	uint64_t tilesMapped;    // Resource tiles currently backed by a heap page
+	uint64_t tilesCopied;    // Tiles CopyTiles wrote to a page
+	uint64_t tilesDropped;   // Tiles CopyTiles skipped because they were unmapped
+	uint64_t bytesCopied;    // Including packed mips
+};
+
+// Simulates the device on the CPU, for benchmarks and offline runs with no
+// GPU. Resources get the standard 64KB tile shapes and a page table per
+// resource; the tile heap is host memory, copies land in it when the batch
+// executes, and fences complete after the configured latency. One tile heap
+// at a time; residency map copies are accepted and dropped.
+class SoftwareBackend : public IGpuBackend {
+public:
+	explicit SoftwareBackend(const SoftwareBackendSettings& settings);
+
+	bool Initialize(UINT slotCount, UINT64 tileStagingBytes, UINT64 batchStagingBytes) override;
+
+	std::unique_ptr<IHeap> CreateTileHeap(UINT64 sizeInBytes) override;
+
+	std::unique_ptr<ReservedResource> CreateReservedResource(
+		UINT width, UINT height, UINT depth,
+		bool useMipMaps, UINT mipCount,
+		DXGI_FORMAT format,
+		D3D12_TEXTURE_LAYOUT layout) override;
+
+	void GetCopyableFootprints(
+		const D3D12_RESOURCE_DESC& desc,
+		UINT firstSubresource, UINT subresourceCount,
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT* outFootprints,
+		UINT* outRowCounts,
+		UINT64* outRowSizes,
+		UINT64* outTotalBytes) override;
+
+	std::byte* GetStagingMemory(StagingBuffer buffer, UINT slotIndex) const override;
+
+	void UpdateTileMappings(
+		ReservedResource* resource,
+		UINT regionCount,
+		const D3D12_TILED_RESOURCE_COORDINATE* regionCoords,
+		const D3D12_TILE_REGION_SIZE* regionSizes,
+		IHeap* heap,
+		UINT rangeCount,
+		const D3D12_TILE_RANGE_FLAGS* rangeFlags,
+		const UINT* heapRangeStartOffsets,
+		const UINT* rangeTileCounts) override;
+
+	bool ExecuteCopies(const UploadSubmission* submissions, UINT allocatorSlot) override;
+
+	void ResetAllocator(UINT /*slotIndex*/) override {}
+
+	bool Signal(UINT64 fenceValue) override;
+	UINT64 GetCompletedFenceValue() override;
+	void WaitForFence(UINT64 fenceValue) override;
+
+	ID3D12Resource* GetStagingResource(StagingBuffer /*buffer*/, UINT /*slotIndex*/) const override { return nullptr; }
+
+	// Copies the page behind one tile into outTile (64KB). False if the
+	// tile is not mapped.
+	bool ReadTile(
+		const ReservedResource* resource,
+		UINT subresource,
+		UINT x, UINT y, UINT z,
+		std::byte* outTile) const;
+
+	SoftwareBackendStats GetStats() const;
+
+	static constexpr UINT64 TILE_SIZE = 65536;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	// Index of a tile in the resource's overall tile order, or UINT_MAX
+	// if the coordinate is outside the resource
+	static UINT ResourceTileIndex(const ReservedResource* resource, const D3D12_TILED_RESOURCE_COORDINATE& coord);
+
+	// Appends the overall tile index of every tile in the region, in the
+	// order UpdateTileMappings and CopyTiles walk them
+	static void AppendRegionTiles(
+		const ReservedResource* resource,
+		const D3D12_TILED_RESOURCE_COORDINATE& coord,
+		const D3D12_TILE_REGION_SIZE& size,
+		std::vector<UINT>& outTiles);
+
+	// Writes size bytes at byteOffset into the run of tiles starting at
+	// firstTile; bytes over unmapped tiles are dropped. Caller must hold
+	// m_mappingMutex.
+	void WriteTiles(const ReservedResource* resource, UINT firstTile, UINT64 byteOffset, const std::byte* source, UINT64 size);
+
+	const SoftwareBackendSettings m_settings;
+
+	std::vector<std::unique_ptr<std::byte[]>> m_staging[2];
+
+	// Page tables map a resource's overall tile index to a heap tile.
+	// Resources are dropped once their last tile is unmapped.
+	std::unordered_map<const ReservedResource*, std::unordered_map<UINT, UINT>> m_pageTables;
+	std::unique_ptr<std::byte[]> m_heapMemory;
+	UINT64 m_heapSize = 0;
+	SoftwareBackendStats m_stats = {};
+	mutable std::mutex m_mappingMutex;
+
+	struct PendingSignal {
+		UINT64 value;
+		Clock::time_point due;
+	};
+
+	// Guarded by m_fenceMutex; ordered by value and due time
+	std::deque<PendingSignal> m_pendingSignals;
+	UINT64 m_completedValue = 0;
+	mutable std::mutex m_fenceMutex;
+
+	// Caller must hold m_fenceMutex
+	void RetireDueSignals(Clock::time_point now);
+};
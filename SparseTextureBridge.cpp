@@ -1,33 +1,22 @@
 #include "pch.h"
 #include "SparseTextureInterface.h"
-#include "ReservedResource.h"
 #include "PluginFacade.h"
 
-// C export wrapping ReservedResource::IsTileMapped.
-// Returns false on null resource.
-extern "C" {
-
-UNITY_INTERFACE_EXPORT bool IsTileMapped(
-    ReservedResource* resource,
-    UINT subresource, UINT tileX, UINT tileY, UINT tileZ)
-{
-    if (!resource) return false;
-    return resource->IsTileMapped(subresource, tileX, tileY, tileZ);
-}
-
-} // extern "C"
-
-// Bridge: converts ResourceTilingInfo (complex, from TilingInfo.h) into
-// SparseTexture_TileInfo (simple, from SparseTextureInterface.h).
-// The function table's GetResourceTilingInfo uses this; the existing
-// P/Invoke export GetResourceTilingInfo fills the complex struct instead.
+// Bridge: converts C_ResourceTilingInfo (complex, from the P/Invoke export
+// GetResourceTilingInfo) into SparseTexture_TileInfo (simple, from
+// SparseTextureInterface.h). The function table's GetResourceTilingInfo
+// uses this. IsTileMapped and the upload exports resolve handles in
+// PluginFacade.cpp.
 static void GetSimpleResourceTilingInfo(
-    ReservedResource* resource,
+    VolumeHandle volume,
     SparseTexture_TileInfo* outInfo)
 {
-    if (!resource || !outInfo) return;
+    if (!outInfo) return;
+
+    C_ResourceTilingInfo tilingInfo = {};
+    GetResourceTilingInfo(volume, &tilingInfo);
+    if (tilingInfo.SubresourceCount == 0) return;
 
-    const auto& tilingInfo = resource->GetTilingInfo();
     outInfo->TileShapeX = tilingInfo.TileWidthInTexels;
     outInfo->TileShapeY = tilingInfo.TileHeightInTexels;
     outInfo->TileShapeZ = tilingInfo.TileDepthInTexels;
@@ -37,7 +26,7 @@ static void GetSimpleResourceTilingInfo(
 extern "C" {
 
 UNITY_INTERFACE_EXPORT void GetFunctionTable(
-    ReservedResource* resource,
+    VolumeHandle volume,
     SparseTextureFunctionTable* outTable)
 {
     if (!outTable) return;
@@ -46,7 +35,7 @@ UNITY_INTERFACE_EXPORT void GetFunctionTable(
     outTable->UnmapTile             = &UnmapTile;
     outTable->IsTileMapped          = &IsTileMapped;
     outTable->GetResourceTilingInfo = &GetSimpleResourceTilingInfo;
-    outTable->resource              = resource;
+    outTable->resource              = volume;
 }
 
 } // extern "C"
@@ -1,9 +1,13 @@
 #pragma once
 #include <cstdint>
 
-// Opaque handle. Forward declaration only — neither plugin needs the full
-// definition of ReservedResource to store or pass the pointer.
-class ReservedResource;
+// Opaque handle to a volume. Handles of destroyed volumes are never
+// reissued and fail cleanly; 0 is never a valid handle.
+typedef uint64_t VolumeHandle;
+
+// Opaque handle to a set of volumes kept resident in lockstep; same rules
+// as VolumeHandle.
+typedef uint64_t VolumeSetHandle;
 
 // Hardware-dependent tile dimensions for a reserved resource's format.
 // Query once at initialization; tile coordinates are derived from these values.
@@ -17,13 +21,13 @@ struct SparseTexture_TileInfo {
 // Function pointer table for cross-plugin calls.
 // Populated by UnitySparse3DTexture's GetFunctionTable export.
 // All pointers are non-owning; the table is immutable after initialization.
-// Callers must null-check table->resource before invoking any function.
+// Callers must check table->resource is non-zero before invoking any function.
 struct SparseTextureFunctionTable {
     // Upload data to a tile. Maps the tile if not already mapped.
     // Returns true on successful submission to the D3D12 command queue.
     // The upload is GPU-async — sourceData must remain valid until the GPU copy completes.
     bool (*UploadDataToTile)(
-        ReservedResource* resource,
+        VolumeHandle resource,
         uint32_t subResource,
         uint32_t tileX,
         uint32_t tileY,
@@ -34,7 +38,7 @@ struct SparseTextureFunctionTable {
     // Unmap a tile, releasing its physical heap allocation for reuse.
     // Returns true on success.
     bool (*UnmapTile)(
-        ReservedResource* resource,
+        VolumeHandle resource,
         uint32_t subresource,
         uint32_t tileX,
         uint32_t tileY,
@@ -42,7 +46,7 @@ struct SparseTextureFunctionTable {
 
     // Query whether a tile is currently mapped in physical GPU memory.
     bool (*IsTileMapped)(
-        ReservedResource* resource,
+        VolumeHandle resource,
         uint32_t subresource,
         uint32_t tileX,
         uint32_t tileY,
@@ -51,9 +55,9 @@ struct SparseTextureFunctionTable {
     // Retrieve hardware-dependent tile dimensions for this resource.
     // Use these to convert voxel/chunk coordinates to tile coordinates.
     void (*GetResourceTilingInfo)(
-        ReservedResource* resource,
+        VolumeHandle resource,
         SparseTexture_TileInfo* outInfo);
 
     // The resource handle to pass to all other functions in this table.
-    ReservedResource* resource;
+    VolumeHandle resource;
 };
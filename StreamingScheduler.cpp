@@ -0,0 +1,217 @@
+#include "pch.h"
+#include "StreamingScheduler.h"
+#include <utility>
+
+StreamingScheduler::StreamingScheduler(float agingPerFrame)
+	: m_agingPerFrame(agingPerFrame)
+{
+}
+
+StreamingRequestId StreamingScheduler::Enqueue(void* owner, float priority, uint64_t bytes, std::function<bool()> work)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	uint32_t slot;
+	if (!m_freeSlots.empty()) {
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else {
+		slot = static_cast<uint32_t>(m_requests.size());
+		m_requests.emplace_back();
+	}
+
+	Request& request = m_requests[slot];
+	request.id = m_nextId++;
+	request.owner = owner;
+	request.priority = priority;
+	request.enqueueFrame = m_frame;
+	request.bytes = bytes;
+	request.key = ComputeKey(priority, m_frame);
+	request.work = std::move(work);
+
+	request.heapIndex = static_cast<uint32_t>(m_heap.size());
+	m_heap.push_back(slot);
+	SiftUp(request.heapIndex);
+
+	m_slots.emplace(request.id, slot);
+	m_queuedBytes += bytes;
+	return request.id;
+}
+
+bool StreamingScheduler::Reprioritize(StreamingRequestId id, float priority)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto found = m_slots.find(id);
+	if (found == m_slots.end()) {
+		return false;
+	}
+
+	Request& request = m_requests[found->second];
+	const double oldKey = request.key;
+	request.priority = priority;
+	request.key = ComputeKey(priority, request.enqueueFrame);
+	if (request.key < oldKey) {
+		SiftUp(request.heapIndex);
+	}
+	else {
+		SiftDown(request.heapIndex);
+	}
+	return true;
+}
+
+bool StreamingScheduler::Cancel(StreamingRequestId id)
+{
+	// Destroyed after the lock is released, see RemoveAt
+	std::function<bool()> cancelled;
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto found = m_slots.find(id);
+	if (found == m_slots.end()) {
+		return false;
+	}
+
+	cancelled = RemoveAt(m_requests[found->second].heapIndex);
+	return true;
+}
+
+size_t StreamingScheduler::CancelOwner(void* owner)
+{
+	std::vector<std::function<bool()>> cancelled;
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Removing reshuffles the heap, so collect the slots first
+	std::vector<uint32_t> slots;
+	for (uint32_t slot : m_heap) {
+		if (m_requests[slot].owner == owner) {
+			slots.push_back(slot);
+		}
+	}
+	for (uint32_t slot : slots) {
+		cancelled.push_back(RemoveAt(m_requests[slot].heapIndex));
+	}
+	return slots.size();
+}
+
+void StreamingScheduler::SetAgingPerFrame(float agingPerFrame)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_agingPerFrame = agingPerFrame;
+	for (uint32_t slot : m_heap) {
+		Request& request = m_requests[slot];
+		request.key = ComputeKey(request.priority, request.enqueueFrame);
+	}
+	for (uint32_t i = static_cast<uint32_t>(m_heap.size() / 2); i-- > 0;) {
+		SiftDown(i);
+	}
+}
+
+void StreamingScheduler::Drain(const StreamingBudget& budget, std::vector<ScheduledWork>& outWork)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	uint64_t bytes = 0;
+	uint32_t operations = 0;
+	while (!m_heap.empty() && operations < budget.maxOperations) {
+		Request& request = m_requests[m_heap[0]];
+		if (operations > 0 && bytes + request.bytes > budget.maxBytes) {
+			break;
+		}
+
+		bytes += request.bytes;
+		++operations;
+		outWork.push_back({ request.id, std::move(request.work) });
+		RemoveAt(0);
+	}
+
+	++m_frame;
+}
+
+size_t StreamingScheduler::QueuedCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_heap.size();
+}
+
+uint64_t StreamingScheduler::QueuedBytes() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_queuedBytes;
+}
+
+bool StreamingScheduler::Before(uint32_t a, uint32_t b) const
+{
+	const Request& ra = m_requests[m_heap[a]];
+	const Request& rb = m_requests[m_heap[b]];
+	if (ra.key != rb.key) {
+		return ra.key < rb.key;
+	}
+	// First come, first served among equals
+	return ra.id < rb.id;
+}
+
+void StreamingScheduler::SiftUp(uint32_t heapIndex)
+{
+	while (heapIndex > 0) {
+		const uint32_t parent = (heapIndex - 1) / 2;
+		if (!Before(heapIndex, parent)) {
+			break;
+		}
+		Swap(heapIndex, parent);
+		heapIndex = parent;
+	}
+}
+
+void StreamingScheduler::SiftDown(uint32_t heapIndex)
+{
+	const uint32_t count = static_cast<uint32_t>(m_heap.size());
+	for (;;) {
+		const uint32_t left = heapIndex * 2 + 1;
+		if (left >= count) {
+			break;
+		}
+		uint32_t best = left;
+		if (left + 1 < count && Before(left + 1, left)) {
+			best = left + 1;
+		}
+		if (!Before(best, heapIndex)) {
+			break;
+		}
+		Swap(heapIndex, best);
+		heapIndex = best;
+	}
+}
+
+void StreamingScheduler::Swap(uint32_t a, uint32_t b)
+{
+	std::swap(m_heap[a], m_heap[b]);
+	m_requests[m_heap[a]].heapIndex = a;
+	m_requests[m_heap[b]].heapIndex = b;
+}
+
+std::function<bool()> StreamingScheduler::RemoveAt(uint32_t heapIndex)
+{
+	const uint32_t slot = m_heap[heapIndex];
+	Request& request = m_requests[slot];
+	m_queuedBytes -= request.bytes;
+	m_slots.erase(request.id);
+	std::function<bool()> work = std::move(request.work);
+	request.work = nullptr;
+	request.heapIndex = NOT_IN_HEAP;
+	m_freeSlots.push_back(slot);
+
+	const uint32_t last = static_cast<uint32_t>(m_heap.size() - 1);
+	if (heapIndex != last) {
+		m_heap[heapIndex] = m_heap[last];
+		m_requests[m_heap[heapIndex]].heapIndex = heapIndex;
+		m_heap.pop_back();
+		SiftDown(heapIndex);
+		SiftUp(heapIndex);
+	}
+	else {
+		m_heap.pop_back();
+	}
+	return work;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using StreamingRequestId = uint64_t;
+
+struct StreamingBudget {
+	uint64_t maxBytes;
+	uint32_t maxOperations;
+};
+
+// A request taken off the queue, ready to run outside the scheduler's lock
+struct ScheduledWork {
+	StreamingRequestId id;
+	std::function<bool()> work;
+};
+
+struct StreamingResult {
+	StreamingRequestId id;
+	bool succeeded;
+};
+
+// Orders queued uploads by priority, lower first. A request's effective
+// priority drops by agingPerFrame for every frame it waits, so distant
+// requests are eventually served under sustained load. Because every
+// request ages at the same rate, the order only depends on
+// priority + agingPerFrame * enqueueFrame, which is fixed at enqueue time;
+// that key lives in an indexed binary heap so reprioritizing and
+// cancelling are O(log n).
+class StreamingScheduler {
+public:
+	explicit StreamingScheduler(float agingPerFrame);
+
+	// Returns the new request's id; ids are never 0
+	StreamingRequestId Enqueue(void* owner, float priority, uint64_t bytes, std::function<bool()> work);
+
+	// Keeps the request's age. Returns false if it is no longer queued.
+	bool Reprioritize(StreamingRequestId id, float priority);
+
+	// Cancelled work is destroyed after the scheduler's lock is released,
+	// so whatever it captured may call back into the scheduler as it goes
+	bool Cancel(StreamingRequestId id);
+
+	// Drops every request of owner, e.g. a resource being destroyed
+	size_t CancelOwner(void* owner);
+
+	// Re-keys queued requests for the new rate
+	void SetAgingPerFrame(float agingPerFrame);
+
+	// Ends a frame: pops requests in effective priority order while they fit
+	// the budget. The first request is always taken, so one larger than the
+	// whole budget cannot block the queue.
+	void Drain(const StreamingBudget& budget, std::vector<ScheduledWork>& outWork);
+
+	size_t QueuedCount() const;
+	uint64_t QueuedBytes() const;
+
+private:
+	static constexpr uint32_t NOT_IN_HEAP = UINT32_MAX;
+
+	struct Request {
+		StreamingRequestId id;
+		void* owner;
+		float priority;
+		uint64_t enqueueFrame;
+		uint64_t bytes;
+		double key;
+		uint32_t heapIndex;
+		std::function<bool()> work;
+	};
+
+	double ComputeKey(float priority, uint64_t enqueueFrame) const {
+		return static_cast<double>(priority) + static_cast<double>(m_agingPerFrame) * static_cast<double>(enqueueFrame);
+	}
+
+	bool Before(uint32_t a, uint32_t b) const;
+	void SiftUp(uint32_t heapIndex);
+	void SiftDown(uint32_t heapIndex);
+	void Swap(uint32_t a, uint32_t b);
+	// Returns the request's work for the caller to destroy unlocked
+	std::function<bool()> RemoveAt(uint32_t heapIndex);
+
+	float m_agingPerFrame;
+	uint64_t m_frame = 0;
+	StreamingRequestId m_nextId = 1;
+	uint64_t m_queuedBytes = 0;
+
+	// Heap of slot indices into m_requests
+	std::vector<uint32_t> m_heap;
+	std::vector<Request> m_requests;
+	std::vector<uint32_t> m_freeSlots;
+	std::unordered_map<StreamingRequestId, uint32_t> m_slots;
+
+	mutable std::mutex m_mutex;
+};
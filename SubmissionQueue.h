@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Lock-free multi-producer queue of intrusive nodes. T must expose a
+// `T* next` member. Producers push with a single CAS; the consumer detaches
+// everything at once with PopAll and receives the nodes in push order.
+// Nodes are owned by the producer and must outlive the PopAll that drains them.
+template <typename T>
+class SubmissionQueue {
+public:
+	void Push(T* node)
+	{
+		T* head = m_head.load(std::memory_order_relaxed);
+		do {
+			node->next = head;
+		} while (!m_head.compare_exchange_weak(
+			head, node,
+			std::memory_order_release,
+			std::memory_order_relaxed));
+	}
+
+	// Pushes count nodes with a single CAS, so they reach the consumer
+	// together and in array order.
+	void PushAll(T* const* nodes, size_t count)
+	{
+		if (count == 0) {
+			return;
+		}
+		for (size_t i = 1; i < count; ++i) {
+			nodes[i]->next = nodes[i - 1];
+		}
+		T* head = m_head.load(std::memory_order_relaxed);
+		do {
+			nodes[0]->next = head;
+		} while (!m_head.compare_exchange_weak(
+			head, nodes[count - 1],
+			std::memory_order_release,
+			std::memory_order_relaxed));
+	}
+
+	// Detaches every queued node. Returns the oldest node, or nullptr.
+	T* PopAll()
+	{
+		T* head = m_head.exchange(nullptr, std::memory_order_acquire);
+
+		// The stack is LIFO; reverse it so submissions keep their call order
+		T* ordered = nullptr;
+		while (head) {
+			T* next = head->next;
+			head->next = ordered;
+			ordered = head;
+			head = next;
+		}
+		return ordered;
+	}
+
+	bool Empty() const
+	{
+		return m_head.load(std::memory_order_acquire) == nullptr;
+	}
+
+private:
+	std::atomic<T*> m_head{ nullptr };
+};
@@ -0,0 +1,102 @@
+// Multi-volume batch uploads: boxes across volumes of different formats land
+// intact and share one fence, overlapping boxes or boxes over mapped tiles
+// fail the whole batch without mapping anything, and a batch larger than
+// one staging buffer still arrives in full
+#include "TestSupport.h"
+
+namespace {
+
+// 256^3 volumes: RGBA8 is 8x8x8 tiles, RGBA16F 8x8x16 and R8 4x8x8
+constexpr DXGI_FORMAT FORMATS[] = { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R8_UNORM };
+constexpr UINT VOLUME_COUNT = 3;
+
+std::span<std::byte> Tiles(std::vector<std::byte>& data, size_t firstTile, size_t tileCount)
+{
+	return std::span<std::byte>(data.data() + firstTile * SoftwareBackend::TILE_SIZE, tileCount * SoftwareBackend::TILE_SIZE);
+}
+
+UINT CountMatchingUploads(const SoftwareBackend& backend, std::span<const TileBoxUpload> uploads)
+{
+	UINT matches = 0;
+	for (const TileBoxUpload& upload : uploads) {
+		matches += CountMatchingTiles(backend, upload.resource, upload.box, upload.sourceData.data());
+	}
+	return matches;
+}
+
+UINT CountTiles(std::span<const TileBoxUpload> uploads)
+{
+	UINT tiles = 0;
+	for (const TileBoxUpload& upload : uploads) {
+		tiles += upload.box.TileCount();
+	}
+	return tiles;
+}
+
+} // namespace
+
+int main()
+{
+	SoftwarePlugin software;
+	RenderingPlugin& plugin = *software.plugin;
+	const SoftwareBackend& backend = *software.backend;
+
+	ReservedResource* volumes[VOLUME_COUNT];
+	for (UINT i = 0; i < VOLUME_COUNT; ++i) {
+		volumes[i] = plugin.GetVolumetricResource(plugin.CreateVolumetricResource(256, 256, 256, false, 1, FORMATS[i]));
+		CHECK(volumes[i] != nullptr);
+		if (!volumes[i]) {
+			return TestExitCode();
+		}
+	}
+
+	std::vector<std::byte> data = MakeTilePayload(64, 1);
+	UINT64 singleFence = 0;
+	CHECK(plugin.UploadDataToTileBox(volumes[0], { 0, 7, 7, 7, 1, 1, 1 }, Tiles(data, 0, 1), &singleFence));
+
+	// Four boxes in three volumes, two of them in the same volume
+	const std::vector<TileBoxUpload> batch = {
+		{ volumes[0], { 0, 1, 1, 1, 2, 2, 2 }, Tiles(data, 0, 8) },
+		{ volumes[1], { 0, 1, 1, 1, 2, 2, 2 }, Tiles(data, 0, 8) },
+		{ volumes[2], { 0, 0, 0, 0, 2, 2, 2 }, Tiles(data, 0, 8) },
+		{ volumes[0], { 0, 4, 4, 4, 2, 2, 1 }, Tiles(data, 8, 4) },
+	};
+	UINT64 batchFence = 0;
+	CHECK(plugin.UploadDataToTileBoxes(batch, &batchFence));
+	CHECK(batchFence > singleFence);
+	CHECK(CountMatchingUploads(backend, batch) == CountTiles(batch));
+	const uint64_t mappedAfterBatch = backend.GetStats().tilesMapped;
+	CHECK(mappedAfterBatch == 1 + CountTiles(batch));
+
+	// Boxes overlapping each other, then a box over a mapped tile
+	software.SetQuiet(true);
+	const std::vector<TileBoxUpload> overlapping = {
+		{ volumes[1], { 0, 5, 5, 5, 2, 2, 2 }, Tiles(data, 0, 8) },
+		{ volumes[1], { 0, 6, 6, 6, 1, 1, 1 }, Tiles(data, 0, 1) },
+	};
+	CHECK(!plugin.UploadDataToTileBoxes(overlapping));
+	const std::vector<TileBoxUpload> overMapped = {
+		{ volumes[0], { 0, 0, 0, 6, 2, 2, 2 }, Tiles(data, 0, 8) },
+		{ volumes[2], { 0, 1, 1, 1, 1, 1, 1 }, Tiles(data, 0, 1) },
+	};
+	CHECK(!plugin.UploadDataToTileBoxes(overMapped));
+	software.SetQuiet(false);
+	CHECK(backend.GetStats().tilesMapped == mappedAfterBatch);
+	CHECK(!volumes[1]->IsTileMapped(0, 5, 5, 5));
+	CHECK(!volumes[0]->IsTileMapped(0, 0, 0, 6));
+
+	// 192 tiles, more than one staging buffer holds
+	const std::vector<TileBoxUpload> large = {
+		{ volumes[0], { 0, 0, 0, 4, 4, 4, 4 }, Tiles(data, 0, 64) },
+		{ volumes[1], { 0, 4, 4, 8, 4, 4, 4 }, Tiles(data, 0, 64) },
+		{ volumes[2], { 0, 0, 4, 4, 4, 4, 4 }, Tiles(data, 0, 64) },
+	};
+	UINT64 largeFence = 0;
+	CHECK(plugin.UploadDataToTileBoxes(large, &largeFence));
+	CHECK(largeFence > batchFence);
+	CHECK(CountMatchingUploads(backend, large) == CountTiles(large));
+	CHECK(CountMatchingUploads(backend, batch) == CountTiles(batch));
+	CHECK(backend.GetStats().tilesMapped == mappedAfterBatch + CountTiles(large));
+
+	return TestExitCode();
+}
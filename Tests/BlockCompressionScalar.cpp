@@ -0,0 +1,16 @@
+// BlockCompression.cpp rebuilt on the portable lanes, inside its own
+// namespace, so BlockCompressionTest can run it against the SIMD build in
+// SparseVolumeCore. The headers it includes are pulled in first, outside the
+// namespace; their include guards keep the inner includes empty.
+#include "pch.h"
+#include "BlockCompression.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#define SPARSE_SCALAR_LANES 1
+
+namespace ScalarLanes {
+#include "../BlockCompression.cpp"
+} // namespace ScalarLanes
@@ -0,0 +1,424 @@
+// Block encoders against reference decoders written from the format specs:
+// constant, two-colour gradient and alpha ramp blocks decode within a bound
+// of their source, the SIMD lanes agree with the scalar lanes, tiles split
+// across a WorkerPool encode like one pass, and uploads of raw texels to BC
+// volumes land as the encoded blocks
+#include "TestSupport.h"
+#include "BlockCompression.h"
+#include "WorkerPool.h"
+#include <cstdlib>
+#include <random>
+
+// BlockCompression.cpp built on the scalar lanes (BlockCompressionScalar.cpp)
+namespace ScalarLanes {
+bool GetBlockEncoder(DXGI_FORMAT format, BlockEncoderInfo* outInfo);
+void EncodeTileSlices(
+	const BlockEncoderInfo& encoder,
+	const std::byte* source,
+	std::byte* destination,
+	const MipTileShape& shape,
+	uint32_t firstSlice,
+	uint32_t sliceCount);
+} // namespace ScalarLanes
+
+namespace {
+
+// 16 texels in row order, RGBA8
+struct Block {
+	uint8_t texels[16][4];
+};
+
+Block MakeConstant()
+{
+	Block block;
+	for (auto& texel : block.texels) {
+		texel[0] = 100;
+		texel[1] = 150;
+		texel[2] = 201;
+		texel[3] = 255;
+	}
+	return block;
+}
+
+Block MakeGradient()
+{
+	constexpr int from[4] = { 20, 40, 60, 255 };
+	constexpr int to[4] = { 220, 200, 180, 255 };
+	Block block;
+	for (int i = 0; i < 16; ++i) {
+		for (int c = 0; c < 4; ++c) {
+			block.texels[i][c] = static_cast<uint8_t>(from[c] + ((to[c] - from[c]) * i + 7) / 15);
+		}
+	}
+	return block;
+}
+
+Block MakeAlphaRamp()
+{
+	Block block;
+	for (int i = 0; i < 16; ++i) {
+		block.texels[i][0] = 64;
+		block.texels[i][1] = 128;
+		block.texels[i][2] = 192;
+		block.texels[i][3] = static_cast<uint8_t>(i * 17);
+	}
+	return block;
+}
+
+// ---- Reference decoders ----
+
+uint64_t ReadBits(const std::byte* block, uint32_t offset, uint32_t count)
+{
+	uint64_t value = 0;
+	for (uint32_t i = 0; i < count; ++i) {
+		const uint32_t bit = offset + i;
+		value |= static_cast<uint64_t>((static_cast<uint8_t>(block[bit / 8]) >> (bit % 8)) & 1) << i;
+	}
+	return value;
+}
+
+int Expand(uint32_t value, uint32_t bits)
+{
+	return static_cast<int>((value << (8 - bits)) | (value >> (2 * bits - 8)));
+}
+
+// Both colour modes; alpha is left alone
+void DecodeBC1(const std::byte* block, Block& out)
+{
+	const uint32_t color0 = static_cast<uint32_t>(ReadBits(block, 0, 16));
+	const uint32_t color1 = static_cast<uint32_t>(ReadBits(block, 16, 16));
+	int palette[4][3];
+	for (int k = 0; k < 2; ++k) {
+		const uint32_t color = k == 0 ? color0 : color1;
+		palette[k][0] = Expand(color >> 11, 5);
+		palette[k][1] = Expand((color >> 5) & 0x3F, 6);
+		palette[k][2] = Expand(color & 0x1F, 5);
+	}
+	for (int c = 0; c < 3; ++c) {
+		if (color0 > color1) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+		}
+		else {
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+	for (uint32_t i = 0; i < 16; ++i) {
+		const uint64_t index = ReadBits(block, 32 + 2 * i, 2);
+		for (int c = 0; c < 3; ++c) {
+			out.texels[i][c] = static_cast<uint8_t>(palette[index][c]);
+		}
+	}
+}
+
+// Both value modes, into one channel of out
+void DecodeBC4(const std::byte* block, Block& out, int channel)
+{
+	const int red0 = static_cast<int>(ReadBits(block, 0, 8));
+	const int red1 = static_cast<int>(ReadBits(block, 8, 8));
+	int palette[8] = { red0, red1 };
+	if (red0 > red1) {
+		for (int i = 2; i < 8; ++i) {
+			palette[i] = ((8 - i) * red0 + (i - 1) * red1 + 3) / 7;
+		}
+	}
+	else {
+		for (int i = 2; i < 6; ++i) {
+			palette[i] = ((6 - i) * red0 + (i - 1) * red1 + 2) / 5;
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+	for (uint32_t i = 0; i < 16; ++i) {
+		out.texels[i][channel] = static_cast<uint8_t>(palette[ReadBits(block, 16 + 3 * i, 3)]);
+	}
+}
+
+// Mode 6 only, which is all the encoder writes; false for any other mode
+bool DecodeBC7(const std::byte* block, Block& out)
+{
+	if (ReadBits(block, 0, 7) != 0x40) {
+		return false;
+	}
+
+	static constexpr int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	int endpoints[2][4];
+	uint32_t offset = 7;
+	for (int c = 0; c < 4; ++c) {
+		for (int k = 0; k < 2; ++k, offset += 7) {
+			endpoints[k][c] = static_cast<int>(ReadBits(block, offset, 7)) << 1;
+		}
+	}
+	for (int k = 0; k < 2; ++k, ++offset) {
+		const int pBit = static_cast<int>(ReadBits(block, offset, 1));
+		for (int c = 0; c < 4; ++c) {
+			endpoints[k][c] |= pBit;
+		}
+	}
+	for (uint32_t i = 0; i < 16; ++i) {
+		const uint32_t bits = i == 0 ? 3 : 4;
+		const int weight = weights[ReadBits(block, offset, bits)];
+		offset += bits;
+		for (int c = 0; c < 4; ++c) {
+			out.texels[i][c] = static_cast<uint8_t>(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+		}
+	}
+	return true;
+}
+
+// Largest per-channel difference over channels [first, first + count)
+int MaxError(const Block& a, const Block& b, int first, int count)
+{
+	int error = 0;
+	for (int i = 0; i < 16; ++i) {
+		for (int c = first; c < first + count; ++c) {
+			error = (std::max)(error, std::abs(a.texels[i][c] - b.texels[i][c]));
+		}
+	}
+	return error;
+}
+
+BlockEncoderInfo GetEncoder(DXGI_FORMAT format)
+{
+	BlockEncoderInfo info = {};
+	CHECK(GetBlockEncoder(format, &info));
+	return info;
+}
+
+// One channel of a block, as BC4 reads it
+void ExtractChannel(const Block& block, int channel, uint8_t* out)
+{
+	for (int i = 0; i < 16; ++i) {
+		out[i] = block.texels[i][channel];
+	}
+}
+
+// ---- Round trips ----
+
+// Worst error of rounding a ramp over range to levels evenly spaced values
+int HalfStep(int range, int levels)
+{
+	return (range + 2 * (levels - 1) - 1) / (2 * (levels - 1));
+}
+
+void CheckBC1()
+{
+	const BlockEncoderInfo encoder = GetEncoder(DXGI_FORMAT_BC1_UNORM);
+	std::byte encoded[8];
+
+	// 565 endpoints round each channel by at most 4; the gradient spreads
+	// its 200 shades over 4 palette entries
+	const Block constant = MakeConstant();
+	Block decoded = constant;
+	encoder.kernel(reinterpret_cast<const std::byte*>(constant.texels), encoded);
+	DecodeBC1(encoded, decoded);
+	CHECK(MaxError(constant, decoded, 0, 3) <= 4);
+
+	const Block gradient = MakeGradient();
+	decoded = gradient;
+	encoder.kernel(reinterpret_cast<const std::byte*>(gradient.texels), encoded);
+	DecodeBC1(encoded, decoded);
+	CHECK(MaxError(gradient, decoded, 0, 3) <= HalfStep(200, 4) + 4);
+
+	// Alpha is dropped; the colour is constant
+	const Block ramp = MakeAlphaRamp();
+	decoded = ramp;
+	encoder.kernel(reinterpret_cast<const std::byte*>(ramp.texels), encoded);
+	DecodeBC1(encoded, decoded);
+	CHECK(MaxError(ramp, decoded, 0, 3) <= 4);
+}
+
+void CheckBC4()
+{
+	const BlockEncoderInfo encoder = GetEncoder(DXGI_FORMAT_BC4_UNORM);
+	std::byte encoded[8];
+	uint8_t channel[16];
+
+	// Endpoints are exact, so a constant block is too, and the ramps only
+	// round to the nearest of 8 levels
+	const Block constant = MakeConstant();
+	Block decoded = constant;
+	ExtractChannel(constant, 1, channel);
+	encoder.kernel(reinterpret_cast<const std::byte*>(channel), encoded);
+	DecodeBC4(encoded, decoded, 1);
+	CHECK(MaxError(constant, decoded, 0, 4) == 0);
+
+	const Block gradient = MakeGradient();
+	decoded = gradient;
+	ExtractChannel(gradient, 0, channel);
+	encoder.kernel(reinterpret_cast<const std::byte*>(channel), encoded);
+	DecodeBC4(encoded, decoded, 0);
+	CHECK(MaxError(gradient, decoded, 0, 4) <= HalfStep(200, 8));
+
+	const Block ramp = MakeAlphaRamp();
+	decoded = ramp;
+	ExtractChannel(ramp, 3, channel);
+	encoder.kernel(reinterpret_cast<const std::byte*>(channel), encoded);
+	DecodeBC4(encoded, decoded, 3);
+	CHECK(MaxError(ramp, decoded, 0, 4) <= HalfStep(255, 8));
+}
+
+void CheckBC7()
+{
+	const BlockEncoderInfo encoder = GetEncoder(DXGI_FORMAT_BC7_UNORM);
+	std::byte encoded[16];
+
+	// 7-bit endpoints share a p-bit across channels, so each channel may be
+	// one off on top of rounding to the nearest of 16 weights
+	const Block constant = MakeConstant();
+	Block decoded = {};
+	encoder.kernel(reinterpret_cast<const std::byte*>(constant.texels), encoded);
+	CHECK(DecodeBC7(encoded, decoded));
+	CHECK(MaxError(constant, decoded, 0, 4) <= 1);
+
+	const Block gradient = MakeGradient();
+	encoder.kernel(reinterpret_cast<const std::byte*>(gradient.texels), encoded);
+	CHECK(DecodeBC7(encoded, decoded));
+	CHECK(MaxError(gradient, decoded, 0, 4) <= HalfStep(200, 16) + 1);
+
+	const Block ramp = MakeAlphaRamp();
+	encoder.kernel(reinterpret_cast<const std::byte*>(ramp.texels), encoded);
+	CHECK(DecodeBC7(encoded, decoded));
+	CHECK(MaxError(ramp, decoded, 0, 4) <= HalfStep(255, 16) + 1);
+}
+
+// ---- SIMD against scalar lanes ----
+
+void CheckLanesAgree()
+{
+	std::vector<Block> blocks = { MakeConstant(), MakeGradient(), MakeAlphaRamp() };
+	std::mt19937 rng(11);
+	for (int i = 0; i < 2000; ++i) {
+		Block block;
+		// Half the blocks are noise, half are noisy gradients
+		const int base = static_cast<int>(rng() % 256);
+		const int slope = static_cast<int>(rng() % 33) - 16;
+		for (int t = 0; t < 16; ++t) {
+			for (int c = 0; c < 4; ++c) {
+				const int value = i % 2 ? static_cast<int>(rng() % 256) : base + slope * t + static_cast<int>(rng() % 9) - 4;
+				block.texels[t][c] = static_cast<uint8_t>(std::clamp(value, 0, 255));
+			}
+		}
+		blocks.push_back(block);
+	}
+
+	for (DXGI_FORMAT format : { DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC4_UNORM, DXGI_FORMAT_BC5_UNORM, DXGI_FORMAT_BC7_UNORM }) {
+		const BlockEncoderInfo simd = GetEncoder(format);
+		BlockEncoderInfo scalar = {};
+		CHECK(ScalarLanes::GetBlockEncoder(format, &scalar));
+		CHECK(scalar.bytesPerBlock == simd.bytesPerBlock && scalar.sourceBytesPerTexel == simd.sourceBytesPerTexel);
+
+		UINT mismatches = 0;
+		for (const Block& block : blocks) {
+			std::byte simdBlock[16] = {};
+			std::byte scalarBlock[16] = {};
+			simd.kernel(reinterpret_cast<const std::byte*>(block.texels), simdBlock);
+			scalar.kernel(reinterpret_cast<const std::byte*>(block.texels), scalarBlock);
+			mismatches += memcmp(simdBlock, scalarBlock, simd.bytesPerBlock) != 0;
+		}
+		// Every lane operation is a single IEEE operation on values that are
+		// whole or half-whole, so the builds match bit for bit
+		CHECK(mismatches == 0);
+	}
+}
+
+// ---- Tiles ----
+
+std::vector<std::byte> MakeTexels(size_t count, uint32_t seed)
+{
+	std::vector<std::byte> texels(count * 4);
+	std::mt19937 rng(seed);
+	for (size_t i = 0; i < count; ++i) {
+		// Smooth along x with some noise, like real volume data
+		const uint32_t x = static_cast<uint32_t>(i % 64);
+		for (size_t c = 0; c < 4; ++c) {
+			texels[i * 4 + c] = static_cast<std::byte>((x * (c + 1) * 3 + rng() % 16) & 0xFF);
+		}
+	}
+	return texels;
+}
+
+// One pass over the whole tile, as a single thread would encode it
+std::vector<std::byte> EncodeTile(const BlockEncoderInfo& encoder, const std::byte* source, const MipTileShape& shape)
+{
+	std::vector<std::byte> encoded(SoftwareBackend::TILE_SIZE);
+	EncodeTileSlices(encoder, source, encoded.data(), shape, 0, shape.depth);
+	return encoded;
+}
+
+void CheckWorkerPool()
+{
+	// A BC7 tile is 64x64x16 texels
+	const MipTileShape shape = { 64, 64, 16 };
+	const BlockEncoderInfo encoder = GetEncoder(DXGI_FORMAT_BC7_UNORM);
+	const std::vector<std::byte> source = MakeTexels(size_t(shape.width) * shape.height * shape.depth, 3);
+	const std::vector<std::byte> expected = EncodeTile(encoder, source.data(), shape);
+
+	BlockEncoderInfo scalar = {};
+	CHECK(ScalarLanes::GetBlockEncoder(DXGI_FORMAT_BC7_UNORM, &scalar));
+	std::vector<std::byte> scalarTile(SoftwareBackend::TILE_SIZE);
+	ScalarLanes::EncodeTileSlices(scalar, source.data(), scalarTile.data(), shape, 0, shape.depth);
+	CHECK(scalarTile == expected);
+
+	// No workers leaves the caller to run every slice itself
+	for (uint32_t workers : { 0u, 3u }) {
+		WorkerPool pool(workers);
+		CHECK(pool.WorkerCount() == workers);
+		std::vector<std::byte> encoded(SoftwareBackend::TILE_SIZE);
+		pool.ParallelFor(shape.depth, [&](uint32_t slice) {
+			EncodeTileSlices(encoder, source.data(), encoded.data(), shape, slice, 1);
+		});
+		CHECK(encoded == expected);
+	}
+}
+
+void CheckConvertedUpload(DXGI_FORMAT format)
+{
+	SoftwarePlugin software;
+	RenderingPlugin& plugin = *software.plugin;
+	const VolumeHandle handle = plugin.CreateVolumetricResource(256, 256, 64, false, 1, format);
+	ReservedResource* resource = plugin.GetVolumetricResource(handle);
+	CHECK(resource != nullptr);
+	if (!resource) {
+		return;
+	}
+
+	const ResourceTilingInfo& tiling = resource->GetTilingInfo();
+	const MipTileShape shape = { tiling.TileWidthInTexels, tiling.TileHeightInTexels, tiling.TileDepthInTexels };
+	const BlockEncoderInfo encoder = GetEncoder(format);
+	const size_t sourceBytesPerTile = size_t(shape.width) * shape.height * shape.depth * encoder.sourceBytesPerTexel;
+
+	// The texel generator writes RGBA; BC4 reads the first byte of each
+	const TileBox box = { 0, 0, 0, 0, 2, 1, 1 };
+	std::vector<std::byte> source = MakeTexels(box.TileCount() * sourceBytesPerTile / 4, 7);
+	CHECK(plugin.UploadConvertedDataToTileBox(resource, box, std::span<std::byte>(source), UploadSourceFormat::Uncompressed));
+
+	std::vector<std::byte> single = MakeTexels(sourceBytesPerTile / 4, 8);
+	CHECK(plugin.UploadConvertedDataToTile(resource, 0, 0, 1, 0, std::span<std::byte>(single), UploadSourceFormat::Uncompressed));
+
+	std::vector<std::byte> tile(SoftwareBackend::TILE_SIZE);
+	for (UINT i = 0; i < box.TileCount(); ++i) {
+		CHECK(software.backend->ReadTile(resource, 0, box.startX + i, 0, 0, tile.data()));
+		CHECK(tile == EncodeTile(encoder, source.data() + i * sourceBytesPerTile, shape));
+	}
+	CHECK(software.backend->ReadTile(resource, 0, 0, 1, 0, tile.data()));
+	CHECK(tile == EncodeTile(encoder, single.data(), shape));
+
+	CHECK(plugin.DestroyVolumetricResource(handle));
+}
+
+} // namespace
+
+int main()
+{
+	CheckBC1();
+	CheckBC4();
+	CheckBC7();
+	CheckLanesAgree();
+	CheckWorkerPool();
+	CheckConvertedUpload(DXGI_FORMAT_BC7_UNORM);
+	CheckConvertedUpload(DXGI_FORMAT_BC1_UNORM);
+	CheckConvertedUpload(DXGI_FORMAT_BC4_UNORM);
+	return TestExitCode();
+}
@@ -0,0 +1,190 @@
+// Several threads upload, box-upload and unmap overlapping tiles of one
+// volume at once: afterwards every mapped tile holds its own data, the
+// backend, the heap and the pipeline counters agree on how many tiles are
+// mapped, and every tile unmapped along the way comes back to the heap once
+// its fence passes
+#include "TestSupport.h"
+#include <atomic>
+#include <random>
+#include <thread>
+
+namespace {
+
+// R8_UNORM tiles are 64x32x32 texels, so this volume is 8x8x8 tiles; the
+// threads all work in the 4x4x4 corner so they keep running into each other
+constexpr UINT TILES = 8;
+constexpr UINT REGION = 4;
+constexpr UINT THREADS = 4;
+constexpr UINT OPERATIONS = 400;
+
+// Every writer of a tile writes the same bytes, so the tile holds them
+// whichever upload lands last
+void FillTile(std::byte* tile, UINT x, UINT y, UINT z)
+{
+	uint64_t state = ((static_cast<uint64_t>(z) * TILES + y) * TILES + x + 1) * 0x9E3779B97F4A7C15ull;
+	for (size_t i = 0; i < SoftwareBackend::TILE_SIZE; i += sizeof(state)) {
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		memcpy(tile + i, &state, sizeof(state));
+	}
+}
+
+std::vector<std::byte> MakeBoxPayload(const TileBox& box)
+{
+	std::vector<std::byte> data(box.TileCount() * SoftwareBackend::TILE_SIZE);
+	size_t i = 0;
+	for (UINT z = 0; z < box.depth; ++z)
+		for (UINT y = 0; y < box.height; ++y)
+			for (UINT x = 0; x < box.width; ++x, ++i) {
+				FillTile(data.data() + i * SoftwareBackend::TILE_SIZE, box.startX + x, box.startY + y, box.startZ + z);
+			}
+	return data;
+}
+
+struct WorkerCounts {
+	UINT tileUploads = 0;
+	UINT failedTileUploads = 0;
+	UINT boxUploads = 0;
+	UINT unmaps = 0;
+};
+
+// Box uploads fail when another thread mapped part of the box first and
+// unmaps fail on tiles that are not mapped; single-tile uploads never fail
+void RunWorker(RenderingPlugin& plugin, ReservedResource* resource, UINT seed, WorkerCounts& counts)
+{
+	std::mt19937 rng(seed);
+	for (UINT op = 0; op < OPERATIONS; ++op) {
+		const UINT x = rng() % REGION;
+		const UINT y = rng() % REGION;
+		const UINT z = rng() % REGION;
+		switch (rng() % 3) {
+		case 0: {
+			std::vector<std::byte> data = MakeBoxPayload({ 0, x, y, z, 1, 1, 1 });
+			++counts.tileUploads;
+			counts.failedTileUploads += !plugin.UploadDataToTile(resource, 0, x, y, z, std::span<std::byte>(data));
+			break;
+		}
+		case 1: {
+			const TileBox box = { 0, x, y, z, 1 + rng() % 2, 1 + rng() % 2, 1 + rng() % 2 };
+			std::vector<std::byte> data = MakeBoxPayload(box);
+			counts.boxUploads += plugin.UploadDataToTileBox(resource, box, std::span<std::byte>(data));
+			break;
+		}
+		default:
+			counts.unmaps += plugin.UnmapDataFromTile(resource, 0, x, y, z);
+			break;
+		}
+	}
+}
+
+UINT CountMappedTiles(const ReservedResource* resource)
+{
+	UINT mapped = 0;
+	for (UINT z = 0; z < TILES; ++z)
+		for (UINT y = 0; y < TILES; ++y)
+			for (UINT x = 0; x < TILES; ++x) {
+				mapped += resource->IsTileMapped(0, x, y, z);
+			}
+	return mapped;
+}
+
+// Mapped tiles that do not hold their own data
+UINT CountStaleTiles(const SoftwareBackend& backend, const ReservedResource* resource)
+{
+	std::vector<std::byte> tile(SoftwareBackend::TILE_SIZE);
+	std::vector<std::byte> expected(SoftwareBackend::TILE_SIZE);
+	UINT stale = 0;
+	for (UINT z = 0; z < TILES; ++z)
+		for (UINT y = 0; y < TILES; ++y)
+			for (UINT x = 0; x < TILES; ++x) {
+				if (!resource->IsTileMapped(0, x, y, z)) {
+					continue;
+				}
+				FillTile(expected.data(), x, y, z);
+				stale += !backend.ReadTile(resource, 0, x, y, z, tile.data()) ||
+					memcmp(tile.data(), expected.data(), tile.size()) != 0;
+			}
+	return stale;
+}
+
+uint64_t ReadCounter(RenderingPlugin& plugin, PipelineCounter counter)
+{
+	C_PipelineStats stats = {};
+	CHECK(plugin.GetPipelineStats(stats));
+	return stats.counters[static_cast<uint32_t>(counter)];
+}
+
+void CheckSameVolume()
+{
+	// Fences lag their signals, so unmapped tiles sit retired for a while
+	SoftwareBackendSettings settings;
+	settings.fenceLatencyNs = 200'000;
+	SoftwarePlugin software(settings);
+	RenderingPlugin& plugin = *software.plugin;
+	const SoftwareBackend& backend = *software.backend;
+
+	const UINT heapTiles = plugin.GetFreeHeapTiles();
+	CHECK(heapTiles > 0);
+	plugin.ResetPipelineStats();
+
+	const VolumeHandle handle = plugin.CreateVolumetricResource(512, 256, 256, false, 1, DXGI_FORMAT_R8_UNORM);
+	ReservedResource* resource = plugin.GetVolumetricResource(handle);
+	CHECK(resource != nullptr);
+	if (!resource) {
+		return;
+	}
+
+	software.SetQuiet(true);
+	WorkerCounts counts[THREADS];
+	std::vector<std::thread> workers;
+	for (UINT i = 0; i < THREADS; ++i) {
+		workers.emplace_back(RunWorker, std::ref(plugin), resource, i + 1, std::ref(counts[i]));
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	software.SetQuiet(false);
+
+	WorkerCounts total;
+	for (const WorkerCounts& count : counts) {
+		total.tileUploads += count.tileUploads;
+		total.failedTileUploads += count.failedTileUploads;
+		total.boxUploads += count.boxUploads;
+		total.unmaps += count.unmaps;
+	}
+	CHECK(total.tileUploads > 0);
+	CHECK(total.failedTileUploads == 0);
+	CHECK(total.boxUploads > 0);
+	CHECK(total.unmaps > 0);
+
+	const UINT mapped = CountMappedTiles(resource);
+	CHECK(mapped > 0);
+	CHECK(CountStaleTiles(backend, resource) == 0);
+	CHECK(backend.GetStats().tilesMapped == mapped);
+
+	// Each successful unmap retired one tile and nothing else did, and every
+	// tile mapped and not unmapped is still mapped
+	const uint64_t tilesMapped = ReadCounter(plugin, PipelineCounter::TilesMapped);
+	const uint64_t tilesUnmapped = ReadCounter(plugin, PipelineCounter::TilesUnmapped);
+	CHECK(tilesUnmapped == total.unmaps);
+	CHECK(tilesMapped - tilesUnmapped == mapped);
+
+	// A heap tile is mapped, retired or free
+	CHECK(plugin.GetFreeHeapTiles() + plugin.GetRetiredTileCount() + mapped == heapTiles);
+	plugin.WaitForRetiredTiles();
+	CHECK(plugin.GetRetiredTileCount() == 0);
+	CHECK(plugin.GetFreeHeapTiles() + mapped == heapTiles);
+
+	CHECK(plugin.DestroyVolumetricResource(handle));
+	CHECK(backend.GetStats().tilesMapped == 0);
+	plugin.WaitForRetiredTiles();
+	CHECK(plugin.GetRetiredTileCount() == 0);
+	CHECK(plugin.GetFreeHeapTiles() == heapTiles);
+}
+
+} // namespace
+
+int main()
+{
+	CheckSameVolume();
+	return TestExitCode();
+}
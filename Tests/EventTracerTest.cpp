@@ -0,0 +1,58 @@
+// Event tracing: one thread alternating between more tracers than it caches
+// keeps a single buffer in each, so none runs out of thread buffers, and
+// every tracer dumps the events written to it
+#include "TestSupport.h"
+#include "EventTracer.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+size_t CountOccurrences(const std::string& text, const std::string& needle)
+{
+	size_t count = 0;
+	for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + needle.size())) {
+		++count;
+	}
+	return count;
+}
+
+void CheckSwitchingTracers()
+{
+	// More tracers than a thread caches, and more switches than MAX_THREADS
+	constexpr UINT TRACERS = 6;
+	constexpr UINT ROUNDS = 3 * EventTracer::MAX_THREADS;
+	EventTracer tracers[TRACERS];
+	for (EventTracer& tracer : tracers) {
+		tracer.SetEnabled(true);
+	}
+
+	for (UINT round = 0; round < ROUNDS; ++round) {
+		for (UINT i = 0; i < TRACERS; ++i) {
+			tracers[i].Instant(TraceEvent::FenceSignal, i, round);
+		}
+	}
+
+	const std::string path = (std::filesystem::temp_directory_path() / "EventTracerTest.json").string();
+	for (EventTracer& tracer : tracers) {
+		CHECK(tracer.DroppedEvents() == 0);
+		CHECK(tracer.Dump(path.c_str()));
+
+		std::ifstream file(path);
+		std::stringstream contents;
+		contents << file.rdbuf();
+		CHECK(CountOccurrences(contents.str(), "\"thread_name\"") == 1);
+		CHECK(CountOccurrences(contents.str(), "\"FenceSignal\"") == ROUNDS);
+	}
+	std::filesystem::remove(path);
+}
+
+} // namespace
+
+int main()
+{
+	CheckSwitchingTracers();
+	return TestExitCode();
+}
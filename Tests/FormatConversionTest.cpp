@@ -0,0 +1,116 @@
+// Upload conversion kernels against scalar expectations, including counts
+// that leave a tail after the SIMD paths
+#include "TestSupport.h"
+#include "FormatConversion.h"
+#include "HalfFloat.h"
+#include <cmath>
+
+namespace {
+
+ConversionInfo GetKernel(UploadSourceFormat source, DXGI_FORMAT destination, uint32_t bytesPerTexel)
+{
+	ConversionInfo info = {};
+	CHECK(GetConversionKernel(source, destination, bytesPerTexel, &info));
+	return info;
+}
+
+void CheckPalette8()
+{
+	std::vector<uint32_t> palette(UPLOAD_PALETTE_SIZE);
+	for (uint32_t i = 0; i < UPLOAD_PALETTE_SIZE; ++i) {
+		palette[i] = i * 0x01010101u ^ 0x5A00A500u;
+	}
+
+	for (size_t count : { size_t(16384), size_t(13), size_t(7) }) {
+		std::vector<uint8_t> indices(count);
+		for (size_t i = 0; i < count; ++i) {
+			indices[i] = static_cast<uint8_t>(i * 13 + 5);
+		}
+		std::vector<uint32_t> out(count);
+		ConversionInfo info = GetKernel(UploadSourceFormat::Palette8, DXGI_FORMAT_R8G8B8A8_UNORM, 4);
+		info.kernel(reinterpret_cast<const std::byte*>(indices.data()), reinterpret_cast<std::byte*>(out.data()),
+			count, reinterpret_cast<const std::byte*>(palette.data()));
+
+		size_t mismatches = 0;
+		for (size_t i = 0; i < count; ++i) {
+			mismatches += out[i] != palette[indices[i]];
+		}
+		CHECK(mismatches == 0);
+	}
+
+	// 2-byte texels take the scalar path
+	std::vector<uint16_t> palette16(UPLOAD_PALETTE_SIZE);
+	for (uint32_t i = 0; i < UPLOAD_PALETTE_SIZE; ++i) {
+		palette16[i] = static_cast<uint16_t>(i * 257 + 1);
+	}
+	std::vector<uint8_t> indices(100);
+	for (size_t i = 0; i < indices.size(); ++i) {
+		indices[i] = static_cast<uint8_t>(255 - i);
+	}
+	std::vector<uint16_t> out16(indices.size());
+	ConversionInfo info = GetKernel(UploadSourceFormat::Palette8, DXGI_FORMAT_R16_FLOAT, 2);
+	info.kernel(reinterpret_cast<const std::byte*>(indices.data()), reinterpret_cast<std::byte*>(out16.data()),
+		indices.size(), reinterpret_cast<const std::byte*>(palette16.data()));
+	CHECK(out16[0] == palette16[255] && out16[99] == palette16[156]);
+}
+
+void CheckRGB8()
+{
+	const size_t count = 1001;
+	std::vector<uint8_t> rgb(count * 3);
+	for (size_t i = 0; i < rgb.size(); ++i) {
+		rgb[i] = static_cast<uint8_t>(i * 7);
+	}
+	std::vector<uint8_t> rgba(count * 4);
+	ConversionInfo info = GetKernel(UploadSourceFormat::RGB8, DXGI_FORMAT_R8G8B8A8_UNORM, 4);
+	info.kernel(reinterpret_cast<const std::byte*>(rgb.data()), reinterpret_cast<std::byte*>(rgba.data()), count, nullptr);
+
+	size_t mismatches = 0;
+	for (size_t i = 0; i < count; ++i) {
+		mismatches += rgba[i * 4] != rgb[i * 3] || rgba[i * 4 + 1] != rgb[i * 3 + 1]
+			|| rgba[i * 4 + 2] != rgb[i * 3 + 2] || rgba[i * 4 + 3] != 0xFF;
+	}
+	CHECK(mismatches == 0);
+}
+
+void CheckFloat16()
+{
+	const size_t count = 4099;
+	std::vector<float> in(count * 2);
+	for (size_t i = 0; i < in.size(); ++i) {
+		in[i] = static_cast<float>(i) * 0.37f - 100.0f;
+	}
+	std::vector<uint16_t> out(in.size());
+	ConversionInfo info = GetKernel(UploadSourceFormat::Float32, DXGI_FORMAT_R16G16_FLOAT, 4);
+	info.kernel(reinterpret_cast<const std::byte*>(in.data()), reinterpret_cast<std::byte*>(out.data()), count, nullptr);
+
+	size_t mismatches = 0;
+	for (size_t i = 0; i < in.size(); ++i) {
+		mismatches += out[i] != HalfFloat::FromFloat(in[i]);
+	}
+	CHECK(mismatches == 0);
+}
+
+void CheckPackedFloats()
+{
+	CHECK(PackR11G11B10Float(1.0f, 1.0f, 1.0f) == (0x3C0u | (0x3C0u << 11) | (0x1E0u << 22)));
+
+	float rgb[3];
+	UnpackR11G11B10Float(PackR11G11B10Float(0.5f, 2.0f, 0.25f), rgb);
+	CHECK(rgb[0] == 0.5f && rgb[1] == 2.0f && rgb[2] == 0.25f);
+
+	UnpackR9G9B9E5SharedExp(PackR9G9B9E5SharedExp(3.25f, 0.125f, 1000.0f), rgb);
+	CHECK(std::fabs(rgb[2] - 1000.0f) <= 2.0f);
+	CHECK(std::fabs(rgb[0] - 3.25f) <= 2.0f);
+}
+
+} // namespace
+
+int main()
+{
+	CheckPalette8();
+	CheckRGB8();
+	CheckFloat16();
+	CheckPackedFloats();
+	return TestExitCode();
+}
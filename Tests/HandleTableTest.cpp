@@ -0,0 +1,102 @@
+// Volume handles: stale handles stop resolving, a pinned volume outlives its
+// removal from the table, DestroyVolumetricResource returns at once and the
+// last pin to go unmaps what the pinning calls mapped, and destroying a
+// volume drops its queued uploads
+#include "TestSupport.h"
+#include "HandleTable.h"
+#include <atomic>
+#include <thread>
+
+namespace {
+
+void CheckTable()
+{
+	HandleTable<int> table;
+	const uint64_t first = table.Insert(std::make_shared<int>(1));
+	CHECK(first != 0);
+	CHECK(table.Get(first) && *table.Get(first) == 1);
+
+	std::shared_ptr<int> pinned = table.Pin(first);
+	CHECK(table.Remove(first) != nullptr);
+	CHECK(table.Get(first) == nullptr);
+	CHECK(table.Pin(first) == nullptr);
+	CHECK(pinned && *pinned == 1);
+
+	// The slot is reused under a new generation
+	const uint64_t second = table.Insert(std::make_shared<int>(2));
+	CHECK(second != first);
+	CHECK(static_cast<uint32_t>(second) == static_cast<uint32_t>(first));
+	CHECK(table.Get(first) == nullptr);
+	CHECK(table.Get(second) && *table.Get(second) == 2);
+}
+
+void CheckDestroyDefersToPins()
+{
+	SoftwarePlugin software;
+	RenderingPlugin& plugin = *software.plugin;
+
+	// R8_UNORM tiles are 64x32x32 texels, so this volume is 8x8x8 tiles
+	VolumeHandle handle = plugin.CreateVolumetricResource(512, 256, 256, false, 1, DXGI_FORMAT_R8_UNORM);
+	CHECK(handle != 0);
+
+	// The worker pins the volume and only maps a box once the destroy has
+	// returned, which it could not do if the destroy waited for the pin
+	std::atomic<bool> pinned = false;
+	std::atomic<bool> destroyed = false;
+	bool uploaded = false;
+	std::thread worker([&] {
+		std::shared_ptr<ReservedResource> resource = plugin.PinVolumetricResource(handle);
+		pinned = true;
+		while (!destroyed) {
+			std::this_thread::yield();
+		}
+
+		const TileBox box = { 0, 0, 0, 0, 2, 2, 2 };
+		std::vector<std::byte> payload = MakeTilePayload(box.TileCount(), 1);
+		uploaded = resource && plugin.UploadDataToTileBox(resource.get(), box, std::span<std::byte>(payload));
+	});
+
+	while (!pinned) {
+		std::this_thread::yield();
+	}
+	CHECK(plugin.DestroyVolumetricResource(handle));
+	destroyed = true;
+	worker.join();
+
+	CHECK(uploaded);
+	CHECK(software.backend->GetStats().tilesMapped == 0);
+
+	software.SetQuiet(true);
+	CHECK(plugin.GetVolumetricResource(handle) == nullptr);
+	CHECK(plugin.PinVolumetricResource(handle) == nullptr);
+	CHECK(!plugin.DestroyVolumetricResource(handle));
+	software.SetQuiet(false);
+}
+
+void CheckDestroyCancelsQueuedUploads()
+{
+	SoftwarePlugin software;
+	RenderingPlugin& plugin = *software.plugin;
+	VolumeHandle handle = plugin.CreateVolumetricResource(512, 256, 256, false, 1, DXGI_FORMAT_R8_UNORM);
+	ReservedResource* resource = plugin.GetVolumetricResource(handle);
+
+	std::vector<std::byte> payload = MakeTilePayload(8, 2);
+	CHECK(plugin.ScheduleUploadToTile(resource, 0, 0, 0, 0, std::span<const std::byte>(payload.data(), SoftwareBackend::TILE_SIZE), 0.0f) != 0);
+	CHECK(plugin.ScheduleUploadToTileBox(resource, { 0, 2, 2, 2, 2, 2, 2 }, payload, 1.0f) != 0);
+	CHECK(plugin.DestroyVolumetricResource(handle));
+
+	std::vector<StreamingResult> results;
+	CHECK(plugin.ProcessStreamingQueue(results) == 0);
+	CHECK(results.empty());
+	CHECK(software.backend->GetStats().tilesMapped == 0);
+}
+
+} // namespace
+
+int main()
+{
+	CheckTable();
+	CheckDestroyDefersToPins();
+	CheckDestroyCancelsQueuedUploads();
+	return TestExitCode();
+}
@@ -0,0 +1,193 @@
+// Mip downsample kernels against a scalar reference, and MipChainBuilder's
+// pending-parent bookkeeping: completion, unmapped children and the cap
+#include "TestSupport.h"
+#include "FormatConversion.h"
+#include "MipChainBuilder.h"
+#include <cmath>
+
+namespace {
+
+constexpr MipTileShape RGBA8_SHAPE = { 32, 32, 16 };
+constexpr uint32_t TILE_SIZE = 65536;
+
+// Three levels of 64KB RGBA8 tiles: 4x4x4, 2x2x2, 1x1x1
+ResourceTilingInfo MakeTilingInfo()
+{
+	ResourceTilingInfo info = {};
+	info.TileWidthInTexels = RGBA8_SHAPE.width;
+	info.TileHeightInTexels = RGBA8_SHAPE.height;
+	info.TileDepthInTexels = RGBA8_SHAPE.depth;
+	info.SubresourceCount = 3;
+	info.NumStandardMips = 3;
+	info.subresourceTilingInfo = { { 4, 4, 4, 0 }, { 2, 2, 2, 64 }, { 1, 1, 1, 72 } };
+	return info;
+}
+
+void CheckUnorm8Average()
+{
+	std::vector<std::byte> child = MakeTilePayload(1, 3);
+	std::vector<std::byte> parent(TILE_SIZE);
+	MipDownsampleKernel kernel = GetMipDownsampleKernel(DXGI_FORMAT_R8G8B8A8_UNORM, 4, MipFilter::Auto);
+	CHECK(kernel != nullptr);
+	kernel(child.data(), parent.data(), RGBA8_SHAPE, 1, 0, 1);
+
+	auto at = [&](uint32_t x, uint32_t y, uint32_t z, uint32_t c) {
+		return static_cast<uint32_t>(child[((z * 32 + y) * 32 + x) * 4 + c]);
+	};
+	int mismatches = 0;
+	for (uint32_t z = 0; z < 8; ++z)
+		for (uint32_t y = 0; y < 16; ++y)
+			for (uint32_t x = 0; x < 16; ++x)
+				for (uint32_t c = 0; c < 4; ++c) {
+					uint32_t sum = 0;
+					for (uint32_t o = 0; o < 8; ++o) {
+						sum += at(2 * x + (o & 1), 2 * y + ((o >> 1) & 1), 2 * z + (o >> 2), c);
+					}
+					const uint32_t got = static_cast<uint32_t>(
+						parent[(((8 + z) * 32 + y) * 32 + 16 + x) * 4 + c]);
+					mismatches += got != (sum + 4) >> 3;
+				}
+	CHECK(mismatches == 0);
+}
+
+// Packed three-channel floats: averaging a texel with copies of itself must
+// give it back, and a mixed block must land on the float mean
+void CheckPackedFloatAverage(DXGI_FORMAT format, uint32_t (*pack)(float, float, float), void (*unpack)(uint32_t, float*))
+{
+	MipDownsampleKernel kernel = GetMipDownsampleKernel(format, 4, MipFilter::Average);
+	CHECK(kernel != nullptr);
+	if (!kernel) {
+		return;
+	}
+
+	const uint32_t texelCount = TILE_SIZE / 4;
+	std::vector<uint32_t> child(texelCount);
+	for (uint32_t i = 0; i < texelCount; ++i) {
+		// Even x holds one colour, odd x another
+		child[i] = (i & 1) ? pack(2.0f, 0.5f, 0.125f) : pack(1.0f, 0.25f, 4.0f);
+	}
+	std::vector<uint32_t> parent(texelCount);
+	kernel(reinterpret_cast<const std::byte*>(child.data()), reinterpret_cast<std::byte*>(parent.data()),
+		RGBA8_SHAPE, 0, 0, 0);
+
+	float rgb[3];
+	unpack(parent[0], rgb);
+	CHECK(std::fabs(rgb[0] - 1.5f) < 1e-3f);
+	CHECK(std::fabs(rgb[1] - 0.375f) < 1e-3f);
+	CHECK(std::fabs(rgb[2] - 2.0625f) < 1e-2f);
+
+	std::fill(child.begin(), child.end(), pack(0.75f, 3.0f, 0.0625f));
+	kernel(reinterpret_cast<const std::byte*>(child.data()), reinterpret_cast<std::byte*>(parent.data()),
+		RGBA8_SHAPE, 1, 1, 1);
+	CHECK(parent[texelCount - 1] == child[0]);
+}
+
+void CheckBuilderCompletesAndForgets()
+{
+	MipChainBuilder builder(MakeTilingInfo(), GetMipDownsampleKernel(DXGI_FORMAT_R8G8B8A8_UNORM, 4, MipFilter::Average), TILE_SIZE);
+	std::vector<std::byte> data = MakeTilePayload(1, 5);
+	std::vector<GeneratedMipTile> ready;
+
+	for (uint32_t o = 0; o < 7; ++o) {
+		builder.AddTile(0, o & 1, (o >> 1) & 1, o >> 2, data.data(), ready);
+	}
+	CHECK(ready.empty());
+	CHECK(builder.GetPendingParentCount() == 1);
+
+	builder.AddTile(0, 1, 1, 1, data.data(), ready);
+	CHECK(ready.size() == 1);
+	CHECK(ready[0].subresource == 1 && ready[0].x == 0 && ready[0].y == 0 && ready[0].z == 0);
+	// The emitted mip 1 tile is now one octant of a pending mip 2 parent
+	CHECK(builder.GetPendingParentCount() == 1);
+
+	// A re-upload of one child starts the parent over
+	ready.clear();
+	builder.AddTile(0, 0, 0, 0, data.data(), ready);
+	CHECK(ready.empty());
+	CHECK(builder.GetPendingParentCount() == 2);
+}
+
+void CheckBuilderWithdrawsUnmappedChildren()
+{
+	MipChainBuilder builder(MakeTilingInfo(), GetMipDownsampleKernel(DXGI_FORMAT_R8G8B8A8_UNORM, 4, MipFilter::Average), TILE_SIZE);
+	std::vector<std::byte> data = MakeTilePayload(1, 6);
+	std::vector<GeneratedMipTile> ready;
+
+	for (uint32_t o = 0; o < 7; ++o) {
+		builder.AddTile(0, 2 + (o & 1), (o >> 1) & 1, o >> 2, data.data(), ready);
+	}
+	builder.RemoveTile(0, 2, 0, 0);
+	builder.AddTile(0, 3, 1, 1, data.data(), ready);
+	CHECK(ready.empty());
+
+	builder.AddTile(0, 2, 0, 0, data.data(), ready);
+	CHECK(ready.size() == 1);
+
+	// Withdrawing the only child drops the parent
+	ready.clear();
+	builder.AddTile(0, 0, 2, 2, data.data(), ready);
+	const size_t pending = builder.GetPendingParentCount();
+	builder.RemoveTile(0, 0, 2, 2);
+	CHECK(builder.GetPendingParentCount() == pending - 1);
+}
+
+void CheckBuilderCap()
+{
+	MipChainBuilder builder(MakeTilingInfo(), GetMipDownsampleKernel(DXGI_FORMAT_R8G8B8A8_UNORM, 4, MipFilter::Average), TILE_SIZE, 2);
+	std::vector<std::byte> data = MakeTilePayload(1, 7);
+	std::vector<GeneratedMipTile> ready;
+
+	builder.AddTile(0, 0, 0, 0, data.data(), ready);
+	builder.AddTile(0, 2, 0, 0, data.data(), ready);
+	builder.AddTile(0, 0, 2, 0, data.data(), ready);
+	CHECK(builder.GetPendingParentCount() == 2);
+	CHECK(builder.GetDroppedParentCount() == 1);
+
+	// The oldest parent went; the two newest are still filling
+	for (uint32_t o = 1; o < 8; ++o) {
+		builder.AddTile(0, o & 1, 2 + ((o >> 1) & 1), o >> 2, data.data(), ready);
+	}
+	CHECK(ready.size() == 1);
+}
+
+// Unmapping through the plugin reaches the resource's builder
+void CheckPluginUnmapWithdraws()
+{
+	SoftwarePlugin software;
+	RenderingPlugin& plugin = *software.plugin;
+
+	VolumeHandle handle = plugin.CreateVolumetricResource(128, 128, 64, true, 3, DXGI_FORMAT_R8G8B8A8_UNORM);
+	ReservedResource* resource = plugin.GetVolumetricResource(handle);
+	CHECK(resource != nullptr);
+	if (!resource) {
+		return;
+	}
+	CHECK(plugin.SetMipGenerationMode(resource, MipFilter::Average));
+	std::shared_ptr<MipChainBuilder> builder = resource->GetMipChainBuilder();
+	CHECK(builder != nullptr);
+	if (!builder) {
+		return;
+	}
+
+	std::vector<std::byte> data = MakeTilePayload(1, 8);
+	CHECK(plugin.UploadDataToTile(resource, 0, 0, 0, 0, std::span<std::byte>(data)));
+	CHECK(builder->GetPendingParentCount() == 1);
+	CHECK(plugin.UnmapTileBox(resource, TileBox{ 0, 0, 0, 0, 1, 1, 1 }));
+	CHECK(builder->GetPendingParentCount() == 0);
+
+	CHECK(plugin.DestroyVolumetricResource(handle));
+}
+
+} // namespace
+
+int main()
+{
+	CheckUnorm8Average();
+	CheckPackedFloatAverage(DXGI_FORMAT_R11G11B10_FLOAT, &PackR11G11B10Float, &UnpackR11G11B10Float);
+	CheckPackedFloatAverage(DXGI_FORMAT_R9G9B9E5_SHAREDEXP, &PackR9G9B9E5SharedExp, &UnpackR9G9B9E5SharedExp);
+	CheckBuilderCompletesAndForgets();
+	CheckBuilderWithdrawsUnmappedChildren();
+	CheckBuilderCap();
+	CheckPluginUnmapWithdraws();
+	return TestExitCode();
+}
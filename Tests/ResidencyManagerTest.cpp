@@ -0,0 +1,123 @@
+// LRU eviction: tiles used in the current frame are never victims, a full
+// heap with nothing idle fails the upload instead of evicting, and once the
+// frame advances an upload evicts idle tiles and waits out their fence
+#include "TestSupport.h"
+#include "ResidencyManager.h"
+
+namespace {
+
+// R8_UNORM tiles are 64x32x32 texels, so each volume is 8x8x8 tiles and
+// the 512MB tile heap holds 16 of them
+constexpr UINT VOLUME_WIDTH = 512;
+constexpr UINT VOLUME_HEIGHT = 256;
+constexpr UINT VOLUME_DEPTH = 256;
+constexpr UINT TILES = 8;
+constexpr UINT HEAP_VOLUMES = 16;
+
+constexpr TileBox WHOLE_VOLUME = { 0, 0, 0, 0, TILES, TILES, TILES };
+
+UINT CountMappedTiles(const ReservedResource* resource)
+{
+	UINT mapped = 0;
+	for (UINT z = 0; z < TILES; ++z)
+		for (UINT y = 0; y < TILES; ++y)
+			for (UINT x = 0; x < TILES; ++x) {
+				mapped += resource->IsTileMapped(0, x, y, z);
+			}
+	return mapped;
+}
+
+void CheckVictimSelection()
+{
+	int owners[2];
+	ResidencyManager residency;
+	residency.SetOwnerWeight(&owners[1], 4.0f);
+	for (uint32_t x = 0; x < 3; ++x) {
+		residency.AddTile({ &owners[0], 0, x, 0, 0 });
+		residency.AddTile({ &owners[1], 0, x, 0, 0 });
+	}
+
+	// Everything was used this frame
+	std::vector<ResidentTile> victims;
+	CHECK(residency.SelectVictims(4, victims) == 0);
+	CHECK(victims.empty());
+	CHECK(residency.TrackedTileCount() == 6);
+
+	// Only tiles idle for at least a frame are chosen, lighter owner first
+	residency.AdvanceFrame();
+	CHECK(residency.Touch({ &owners[0], 0, 1, 0, 0 }));
+	CHECK(residency.Touch({ &owners[1], 0, 0, 0, 0 }));
+	CHECK(residency.Touch({ &owners[1], 0, 1, 0, 0 }));
+	CHECK(residency.SelectVictims(8, victims) == 3);
+	CHECK(victims.size() == 3);
+	if (victims.size() == 3) {
+		CHECK(victims[0].owner == &owners[0] && victims[0].x == 0);
+		CHECK(victims[1].owner == &owners[0] && victims[1].x == 2);
+		CHECK(victims[2].owner == &owners[1] && victims[2].x == 2);
+	}
+	CHECK(residency.TrackedTileCount() == 3);
+}
+
+void CheckEvictionUnderPressure()
+{
+	// Retired tiles stay on the fence for a while, so uploads have to wait
+	// for the tiles they evict
+	SoftwareBackendSettings settings;
+	settings.fenceLatencyNs = 2'000'000;
+	SoftwarePlugin software(settings);
+	RenderingPlugin& plugin = *software.plugin;
+	CHECK(plugin.EnableResidencyManagement(true));
+
+	std::vector<ReservedResource*> volumes;
+	for (UINT i = 0; i <= HEAP_VOLUMES; ++i) {
+		VolumeHandle handle = plugin.CreateVolumetricResource(VOLUME_WIDTH, VOLUME_HEIGHT, VOLUME_DEPTH, false, 1, DXGI_FORMAT_R8_UNORM);
+		volumes.push_back(plugin.GetVolumetricResource(handle));
+		CHECK(volumes.back() != nullptr);
+		if (!volumes.back()) {
+			return;
+		}
+	}
+
+	std::vector<std::byte> fill = MakeTilePayload(WHOLE_VOLUME.TileCount(), 1);
+	for (UINT i = 0; i < HEAP_VOLUMES; ++i) {
+		CHECK(plugin.UploadDataToTileBox(volumes[i], WHOLE_VOLUME, std::span<std::byte>(fill)));
+	}
+
+	// The heap is full and every tile was mapped this frame
+	const TileBox box = { 0, 2, 2, 2, 2, 2, 2 };
+	std::vector<std::byte> payload = MakeTilePayload(box.TileCount(), 2);
+	software.SetQuiet(true);
+	CHECK(!plugin.UploadDataToTileBox(volumes[HEAP_VOLUMES], box, std::span<std::byte>(payload)));
+	software.SetQuiet(false);
+	for (UINT i = 0; i < HEAP_VOLUMES; ++i) {
+		CHECK(CountMappedTiles(volumes[i]) == WHOLE_VOLUME.TileCount());
+	}
+
+	// Next frame only the first volume goes unused, so it gives up tiles
+	CHECK(plugin.AdvanceResidencyFrame());
+	for (UINT i = 1; i < HEAP_VOLUMES; ++i) {
+		CHECK(plugin.MarkTileBoxUsed(volumes[i], WHOLE_VOLUME));
+	}
+	CHECK(plugin.UploadDataToTileBox(volumes[HEAP_VOLUMES], box, std::span<std::byte>(payload)));
+	CHECK(CountMatchingTiles(*software.backend, volumes[HEAP_VOLUMES], box, payload.data()) == box.TileCount());
+	const UINT survivors = CountMappedTiles(volumes[0]);
+	CHECK(survivors < WHOLE_VOLUME.TileCount());
+	for (UINT i = 1; i < HEAP_VOLUMES; ++i) {
+		CHECK(CountMappedTiles(volumes[i]) == WHOLE_VOLUME.TileCount());
+	}
+
+	// Eviction runs in batches, so the next tile fits without another one
+	std::vector<std::byte> tile = MakeTilePayload(1, 3);
+	CHECK(plugin.UploadDataToTile(volumes[HEAP_VOLUMES], 0, 7, 7, 7, std::span<std::byte>(tile)));
+	CHECK(CountMatchingTiles(*software.backend, volumes[HEAP_VOLUMES], { 0, 7, 7, 7, 1, 1, 1 }, tile.data()) == 1);
+	CHECK(CountMappedTiles(volumes[0]) == survivors);
+}
+
+} // namespace
+
+int main()
+{
+	CheckVictimSelection();
+	CheckEvictionUnderPressure();
+	return TestExitCode();
+}
@@ -0,0 +1,41 @@
+// Uploads and unmaps through the plugin on the software backend, read back
+// from the backend's pages
+#include "TestSupport.h"
+
+int main()
+{
+	SoftwarePlugin software;
+	RenderingPlugin& plugin = *software.plugin;
+
+	VolumeHandle handle = plugin.CreateVolumetricResource(256, 256, 128, false, 1, DXGI_FORMAT_R8G8B8A8_UNORM);
+	ReservedResource* resource = plugin.GetVolumetricResource(handle);
+	CHECK(resource != nullptr);
+
+	std::vector<std::byte> data = MakeTilePayload(8, 1);
+
+	CHECK(plugin.UploadDataToTile(resource, 0, 3, 4, 5, std::span<std::byte>(data.data(), SoftwareBackend::TILE_SIZE)));
+	CHECK(CountMatchingTiles(*software.backend, resource, TileBox{ 0, 3, 4, 5, 1, 1, 1 }, data.data()) == 1);
+
+	const TileBox box = { 0, 1, 1, 1, 2, 2, 2 };
+	CHECK(plugin.UploadDataToTileBox(resource, box, std::span<std::byte>(data)));
+	CHECK(CountMatchingTiles(*software.backend, resource, box, data.data()) == 8);
+
+	// Uploading over mapped tiles is refused
+	software.SetQuiet(true);
+	CHECK(!plugin.UploadDataToTileBox(resource, box, std::span<std::byte>(data)));
+	software.SetQuiet(false);
+
+	CHECK(plugin.UnmapTileBox(resource, box));
+	std::vector<std::byte> tile(SoftwareBackend::TILE_SIZE);
+	CHECK(!software.backend->ReadTile(resource, 0, 1, 1, 1, tile.data()));
+
+	const SoftwareBackendStats stats = software.backend->GetStats();
+	CHECK(stats.tilesMapped == 1);
+	CHECK(stats.tilesCopied == 9);
+	CHECK(stats.tilesDropped == 0);
+
+	CHECK(plugin.DestroyVolumetricResource(handle));
+	software.SetQuiet(true);
+	CHECK(plugin.GetVolumetricResource(handle) == nullptr);
+	return TestExitCode();
+}
@@ -0,0 +1,86 @@
+#pragma once
+// Shared helpers for the Linux tests (see CMakeLists.txt). Each test is its
+// own executable; CHECK records a failure and carries on, and main returns
+// TestExitCode().
+#include "pch.h"
+#include "RenderingPlugin.h"
+#include "SoftwareBackend.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+inline int& TestFailureCount()
+{
+	static int failures = 0;
+	return failures;
+}
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+			++TestFailureCount(); \
+		} \
+	} while (0)
+
+inline int TestExitCode()
+{
+	if (TestFailureCount() != 0) {
+		std::fprintf(stderr, "%d check(s) failed\n", TestFailureCount());
+		return 1;
+	}
+	return 0;
+}
+
+// A plugin on its own software backend
+struct SoftwarePlugin {
+	explicit SoftwarePlugin(const SoftwareBackendSettings& settings = {})
+	{
+		auto softwareBackend = std::make_unique<SoftwareBackend>(settings);
+		backend = softwareBackend.get();
+		plugin = std::make_unique<RenderingPlugin>(std::move(softwareBackend), &log);
+	}
+
+	// Tests that expect failures silence the errors they provoke
+	void SetQuiet(bool quiet) { log.quiet = quiet; }
+
+	IUnityLog log;
+	SoftwareBackend* backend = nullptr;
+	std::unique_ptr<RenderingPlugin> plugin;
+};
+
+// Deterministic, non-repeating bytes for `tiles` tiles
+inline std::vector<std::byte> MakeTilePayload(size_t tiles, uint32_t seed)
+{
+	std::vector<std::byte> data(tiles * SoftwareBackend::TILE_SIZE);
+	uint64_t state = 0x9E3779B97F4A7C15ull * (seed + 1);
+	for (std::byte& b : data) {
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		b = static_cast<std::byte>(state >> 56);
+	}
+	return data;
+}
+
+// Number of tiles in the box whose pages hold data's tiles, in the box's
+// x-fastest order
+inline UINT CountMatchingTiles(
+	const SoftwareBackend& backend,
+	const ReservedResource* resource,
+	const TileBox& box,
+	const std::byte* data)
+{
+	std::vector<std::byte> tile(SoftwareBackend::TILE_SIZE);
+	UINT matches = 0;
+	UINT index = 0;
+	for (UINT z = 0; z < box.depth; ++z)
+		for (UINT y = 0; y < box.height; ++y)
+			for (UINT x = 0; x < box.width; ++x, ++index) {
+				if (backend.ReadTile(resource, box.subResource, box.startX + x, box.startY + y, box.startZ + z, tile.data()) &&
+					std::memcmp(tile.data(), data + size_t(index) * SoftwareBackend::TILE_SIZE, SoftwareBackend::TILE_SIZE) == 0)
+				{
+					++matches;
+				}
+			}
+	return matches;
+}
@@ -0,0 +1,254 @@
+// Camera-driven prefetching replayed along recorded camera paths: tiles are
+// queued on the streaming scheduler behind demand uploads, read from an
+// archive that was closed after prefetching was enabled, and tiles missing
+// from the archive are given up on, and destroying the volume drops its
+// queued prefetches
+#include "TestSupport.h"
+#include "TilePrefetcher.h"
+#include <filesystem>
+
+namespace {
+
+// R8_UNORM tiles are 64x32x32 texels, so this volume is 8x8x8 tiles
+constexpr UINT VOLUME_WIDTH = 512;
+constexpr UINT VOLUME_HEIGHT = 256;
+constexpr UINT VOLUME_DEPTH = 256;
+constexpr UINT TILES = 8;
+
+// The archive leaves out the x = 7 column, like an empty region
+constexpr UINT MISSING_X = 7;
+
+constexpr float FRAME_TIME = 1.0f / 30.0f;
+constexpr UINT FRAMES_PER_KEY = 10;
+
+struct CameraKey {
+	float position[3];
+	float view[3];
+};
+
+// Recorded paths, sampled at keyframes in mip 0 texel space
+const CameraKey FLYTHROUGH[] = {
+	{ { 10, 128, 128 }, { 1, 0, 0 } },
+	{ { 130, 128, 128 }, { 1, 0, 0 } },
+	{ { 250, 128, 128 }, { 1, 0, 0 } },
+	{ { 370, 128, 128 }, { 1, 0, 0 } },
+	{ { 500, 128, 128 }, { 1, 0, 0 } },
+};
+
+const CameraKey TURN[] = {
+	{ { 100, 40, 40 }, { 1, 0.2f, 0.2f } },
+	{ { 200, 60, 60 }, { 0.6f, 0.8f, 0.4f } },
+	{ { 260, 140, 100 }, { 0, 1, 0.8f } },
+	{ { 240, 220, 180 }, { -0.6f, 0.3f, 1 } },
+	{ { 150, 230, 230 }, { -1, 0, 0.2f } },
+};
+
+uint8_t TileValue(UINT x, UINT y, UINT z)
+{
+	return static_cast<uint8_t>(1 + x + y * TILES + z * TILES * TILES);
+}
+
+// Uniform tiles compress to a few bytes each
+std::string BakeArchive(RenderingPlugin& plugin)
+{
+	const std::string path = (std::filesystem::temp_directory_path() / "TilePrefetchTest.svta").string();
+	TileArchiveWriter* writer = plugin.CreateTileArchiveWriter(path.c_str(), DXGI_FORMAT_R8_UNORM);
+	CHECK(writer != nullptr);
+	std::vector<std::byte> tile(SoftwareBackend::TILE_SIZE);
+	for (UINT z = 0; z < TILES; ++z)
+		for (UINT y = 0; y < TILES; ++y)
+			for (UINT x = 0; x < MISSING_X; ++x) {
+				std::fill(tile.begin(), tile.end(), static_cast<std::byte>(TileValue(x, y, z)));
+				CHECK(plugin.AddTileToArchive(writer, 0, x, y, z, std::span<const std::byte>(tile), true));
+			}
+	CHECK(plugin.FinishTileArchive(writer));
+	return path;
+}
+
+PrefetchCamera SampleCamera(const CameraKey* keys, UINT keyCount, UINT frame)
+{
+	const UINT key = (std::min)(frame / FRAMES_PER_KEY, keyCount - 2);
+	const float t = static_cast<float>(frame - key * FRAMES_PER_KEY) / FRAMES_PER_KEY;
+	PrefetchCamera camera = {};
+	for (int a = 0; a < 3; ++a) {
+		const float from = keys[key].position[a];
+		const float to = keys[key + 1].position[a];
+		camera.position[a] = from + (to - from) * t;
+		camera.velocity[a] = (to - from) / (FRAMES_PER_KEY * FRAME_TIME);
+		camera.viewDirection[a] = keys[key].view[a];
+	}
+	camera.deltaTime = FRAME_TIME;
+	return camera;
+}
+
+UINT CountMappedTiles(const ReservedResource* resource)
+{
+	UINT mapped = 0;
+	for (UINT z = 0; z < TILES; ++z)
+		for (UINT y = 0; y < TILES; ++y)
+			for (UINT x = 0; x < TILES; ++x) {
+				mapped += resource->IsTileMapped(0, x, y, z);
+			}
+	return mapped;
+}
+
+// Every mapped tile holds the archive's tile for its coordinate
+bool MappedTilesMatchArchive(const SoftwareBackend& backend, const ReservedResource* resource)
+{
+	std::vector<std::byte> tile(SoftwareBackend::TILE_SIZE);
+	for (UINT z = 0; z < TILES; ++z)
+		for (UINT y = 0; y < TILES; ++y)
+			for (UINT x = 0; x < TILES; ++x) {
+				if (!resource->IsTileMapped(0, x, y, z)) {
+					continue;
+				}
+				if (x == MISSING_X || !backend.ReadTile(resource, 0, x, y, z, tile.data()) ||
+					tile.front() != static_cast<std::byte>(TileValue(x, y, z)) ||
+					tile.back() != static_cast<std::byte>(TileValue(x, y, z)))
+				{
+					return false;
+				}
+			}
+	return true;
+}
+
+void ReplayPath(SoftwarePlugin& software, TileArchive* archive, const CameraKey* keys, UINT keyCount, bool closeArchive)
+{
+	RenderingPlugin& plugin = *software.plugin;
+	VolumeHandle handle = plugin.CreateVolumetricResource(VOLUME_WIDTH, VOLUME_HEIGHT, VOLUME_DEPTH, false, 1, DXGI_FORMAT_R8_UNORM);
+	ReservedResource* resource = plugin.GetVolumetricResource(handle);
+	CHECK(resource != nullptr);
+	if (!resource) {
+		return;
+	}
+
+	PrefetchSettings settings;
+	settings.lookaheadFrames = 6;
+	settings.mipRadii = { 48.0f };
+	settings.maxTilesPerFrame = 8;
+	TilePrefetchSource source;
+	source.archive = plugin.FindTileArchive(archive);
+	CHECK(source.archive != nullptr);
+	CHECK(plugin.EnableTilePrefetch(resource, settings, source));
+	source = {};
+
+	// The prefetcher keeps the archive mapped after it is closed
+	if (closeArchive) {
+		CHECK(plugin.CloseTileArchive(archive));
+		CHECK(plugin.FindTileArchive(archive) == nullptr);
+	}
+
+	std::vector<StreamingResult> results;
+	const UINT frameCount = (keyCount - 1) * FRAMES_PER_KEY + 1;
+	PrefetchCamera camera = {};
+	for (UINT frame = 0; frame < frameCount; ++frame) {
+		camera = SampleCamera(keys, keyCount, frame);
+
+		const UINT mappedBefore = CountMappedTiles(resource);
+		const UINT queued = plugin.UpdateTilePrefetch(resource, camera);
+		CHECK(queued <= settings.maxTilesPerFrame);
+
+		// Nothing uploads until the streaming queue runs
+		CHECK(CountMappedTiles(resource) == mappedBefore);
+
+		// Predicting again from the same camera reuses the queued requests
+		CHECK(plugin.UpdateTilePrefetch(resource, camera) == 0);
+
+		plugin.ProcessStreamingQueue(results);
+	}
+
+	// Tiles around the end of the path are resident, except the column the
+	// archive lacks, which is not requested again
+	const UINT endX = static_cast<UINT>(camera.position[0]) / 64;
+	const UINT endY = static_cast<UINT>(camera.position[1]) / 32;
+	const UINT endZ = static_cast<UINT>(camera.position[2]) / 32;
+	if (endX == MISSING_X) {
+		CHECK(!resource->IsTileMapped(0, endX, endY, endZ));
+		CHECK(resource->IsTileMapped(0, endX - 1, endY, endZ));
+	}
+	else {
+		CHECK(resource->IsTileMapped(0, endX, endY, endZ));
+	}
+	CHECK(CountMappedTiles(resource) > 0);
+	CHECK(MappedTilesMatchArchive(*software.backend, resource));
+
+	results.clear();
+	plugin.UpdateTilePrefetch(resource, camera);
+	plugin.ProcessStreamingQueue(results);
+	CHECK(plugin.UpdateTilePrefetch(resource, camera) == 0);
+
+	// Disabling cancels whatever is still queued
+	camera.position[0] = 10;
+	camera.position[1] = 240;
+	camera.position[2] = 240;
+	CHECK(plugin.UpdateTilePrefetch(resource, camera) > 0);
+	CHECK(plugin.DisableTilePrefetch(resource));
+	results.clear();
+	CHECK(plugin.ProcessStreamingQueue(results) == 0);
+
+	CHECK(plugin.DestroyVolumetricResource(handle));
+}
+
+// With one operation per frame, a demand upload at a low priority value
+// runs before prefetches queued earlier
+void CheckDemandUploadsGoFirst(SoftwarePlugin& software, TileArchive* archive)
+{
+	RenderingPlugin& plugin = *software.plugin;
+	VolumeHandle handle = plugin.CreateVolumetricResource(VOLUME_WIDTH, VOLUME_HEIGHT, VOLUME_DEPTH, false, 1, DXGI_FORMAT_R8_UNORM);
+	ReservedResource* resource = plugin.GetVolumetricResource(handle);
+	CHECK(resource != nullptr);
+	if (!resource) {
+		return;
+	}
+
+	PrefetchSettings settings;
+	settings.lookaheadFrames = 2;
+	settings.mipRadii = { 48.0f };
+	TilePrefetchSource source;
+	source.archive = plugin.FindTileArchive(archive);
+	CHECK(plugin.EnableTilePrefetch(resource, settings, source));
+
+	CHECK(plugin.ConfigureStreaming(8 * 1024 * 1024, 1, 1.0f));
+	const PrefetchCamera camera = SampleCamera(FLYTHROUGH, 5, 0);
+	CHECK(plugin.UpdateTilePrefetch(resource, camera) > 0);
+
+	std::vector<std::byte> data = MakeTilePayload(1, 4);
+	const StreamingRequestId demand = plugin.ScheduleUploadToTile(resource, 0, 6, 6, 6, std::span<const std::byte>(data), 0.0f);
+	CHECK(demand != 0);
+
+	std::vector<StreamingResult> results;
+	CHECK(plugin.ProcessStreamingQueue(results) == 1);
+	CHECK(results.size() == 1 && results[0].id == demand && results[0].succeeded);
+
+	// The prefetches still queued go with the volume
+	CHECK(plugin.ConfigureStreaming(8 * 1024 * 1024, 64, 1.0f));
+	CHECK(plugin.DestroyVolumetricResource(handle));
+	results.clear();
+	CHECK(plugin.ProcessStreamingQueue(results) == 0);
+	CHECK(software.backend->GetStats().tilesMapped == 0);
+}
+
+} // namespace
+
+int main()
+{
+	SoftwarePlugin software;
+	RenderingPlugin& plugin = *software.plugin;
+
+	const std::string path = BakeArchive(plugin);
+	TileArchive* archive = plugin.OpenTileArchive(path.c_str());
+	CHECK(archive != nullptr);
+	if (!archive) {
+		return TestExitCode();
+	}
+
+	CheckDemandUploadsGoFirst(software, archive);
+	ReplayPath(software, archive, TURN, 5, false);
+	ReplayPath(software, archive, FLYTHROUGH, 5, true);
+
+	// An archive that is not open is refused by the facade's lookup
+	CHECK(plugin.FindTileArchive(archive) == nullptr);
+
+	std::filesystem::remove(path);
+	return TestExitCode();
+}
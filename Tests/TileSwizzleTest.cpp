@@ -0,0 +1,115 @@
+// Fast tile swizzler against the texel-at-a-time reference, for every texel
+// size and for layouts with short and long contiguous x runs
+#include "TestSupport.h"
+#include "Diagnostics.h"
+#include "TileSwizzle.h"
+#include <bit>
+
+namespace {
+
+struct Shape {
+	uint32_t bytesPerTexel, width, height, depth;
+};
+
+// 64KB tile shapes for 1, 2, 4, 8 and 16 bytes per texel
+constexpr Shape SHAPES[] = {
+	{ 1, 64, 32, 32 }, { 2, 32, 32, 32 }, { 4, 32, 32, 16 },
+	{ 8, 32, 16, 16 }, { 16, 16, 16, 16 },
+};
+
+constexpr uint32_t TILE_SIZE = 65536;
+
+uint32_t LowMask(uint32_t extent)
+{
+	return extent - 1;
+}
+
+// Plain linear order: every row is one run
+SwizzlePattern MakeLinearPattern(const Shape& shape)
+{
+	const uint32_t xBits = std::countr_zero(shape.width);
+	const uint32_t yBits = std::countr_zero(shape.height);
+	return { shape.bytesPerTexel, shape.width, shape.height, shape.depth,
+		LowMask(shape.width),
+		LowMask(shape.height) << xBits,
+		LowMask(shape.depth) << (xBits + yBits) };
+}
+
+// Linear order with the top x bit moved above z: half-row runs
+SwizzlePattern MakeSplitRowPattern(const Shape& shape)
+{
+	const uint32_t xBits = std::countr_zero(shape.width);
+	const uint32_t yBits = std::countr_zero(shape.height);
+	const uint32_t zBits = std::countr_zero(shape.depth);
+	const uint32_t lowX = LowMask(shape.width / 2);
+	return { shape.bytesPerTexel, shape.width, shape.height, shape.depth,
+		lowX | (1u << (xBits + yBits + zBits - 1)),
+		LowMask(shape.height) << (xBits - 1),
+		LowMask(shape.depth) << (xBits - 1 + yBits) };
+}
+
+void CheckPattern(const SwizzlePattern& pattern, const std::vector<std::byte>& linear)
+{
+	std::vector<std::byte> fast(TILE_SIZE);
+	std::vector<std::byte> reference(TILE_SIZE);
+	std::vector<std::byte> roundTrip(TILE_SIZE);
+
+	SwizzleTile(linear.data(), fast.data(), pattern);
+	SwizzleTileReference(linear.data(), reference.data(), pattern);
+	CHECK(fast == reference);
+
+	UnswizzleTile(fast.data(), roundTrip.data(), pattern);
+	CHECK(roundTrip == linear);
+	UnswizzleTileReference(reference.data(), roundTrip.data(), pattern);
+	CHECK(roundTrip == linear);
+}
+
+// BuildSwizzlePattern recovers the masks from the calibration readback
+void CheckBuildPattern(const SwizzlePattern& pattern)
+{
+	const uint32_t texels = pattern.width * pattern.height * pattern.depth;
+	std::vector<uint32_t> linearIndex(texels);
+	std::vector<uint32_t> swizzledIndex(texels);
+	for (uint32_t i = 0; i < texels; ++i) {
+		linearIndex[i] = i;
+	}
+	SwizzlePattern indexPattern = pattern;
+	indexPattern.bytesPerTexel = sizeof(uint32_t);
+	SwizzleTileReference(reinterpret_cast<const std::byte*>(linearIndex.data()),
+		reinterpret_cast<std::byte*>(swizzledIndex.data()), indexPattern);
+
+	uint32_t linearIndexAtBit[32] = {};
+	for (uint32_t k = 0; (1u << k) < texels; ++k) {
+		linearIndexAtBit[k] = swizzledIndex[1u << k];
+	}
+
+	SwizzlePattern built = {};
+	CHECK(BuildSwizzlePattern(linearIndexAtBit, pattern.bytesPerTexel,
+		pattern.width, pattern.height, pattern.depth, &built));
+	CHECK(built.xMask == pattern.xMask);
+	CHECK(built.yMask == pattern.yMask);
+	CHECK(built.zMask == pattern.zMask);
+}
+
+} // namespace
+
+int main()
+{
+	std::vector<std::byte> linear = MakeTilePayload(1, 11);
+
+	for (const Shape& shape : SHAPES) {
+		const SwizzlePattern patterns[] = {
+			MakeMortonSwizzlePattern(shape.bytesPerTexel, shape.width, shape.height, shape.depth),
+			MakeLinearPattern(shape),
+			MakeSplitRowPattern(shape),
+		};
+		for (const SwizzlePattern& pattern : patterns) {
+			CheckPattern(pattern, linear);
+			CheckBuildPattern(pattern);
+		}
+	}
+
+	// The startup diagnostic runs the same comparison
+	CHECK(Diagnostics::CheckSwizzleKernel(nullptr).passed);
+	return TestExitCode();
+}
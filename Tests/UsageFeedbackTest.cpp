@@ -0,0 +1,278 @@
+// Usage feedback decoding against a scalar reference over synthetic
+// buffers, sparse, dense and clustered, on a grid whose mips end mid-word so
+// the vector paths meet their tails. Then the plugin path: requests skip
+// mapped tiles and unsampled mapped tiles turn into eviction candidates.
+#include "TestSupport.h"
+#include "UsageFeedback.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+
+// 13x7x5, 7x4x3, 4x2x2 and 2x1x1 tiles; no packed tail
+ResourceTilingInfo MakeTilingInfo()
+{
+	ResourceTilingInfo info = {};
+	info.TileWidthInTexels = 64;
+	info.TileHeightInTexels = 32;
+	info.TileDepthInTexels = 32;
+	info.SubresourceCount = 4;
+	info.NumStandardMips = 4;
+	info.subresourceTilingInfo = { { 13, 7, 5, 0 }, { 7, 4, 3, 455 }, { 4, 2, 2, 539 }, { 2, 1, 1, 555 } };
+	return info;
+}
+
+uint64_t TileKey(const FeedbackTile& tile)
+{
+	return (uint64_t(tile.subresource) << 48) | (uint64_t(tile.z) << 32) | (uint64_t(tile.y) << 16) | tile.x;
+}
+
+std::vector<uint64_t> SortedKeys(const std::vector<FeedbackTile>& tiles)
+{
+	std::vector<uint64_t> keys;
+	for (const FeedbackTile& tile : tiles) {
+		keys.push_back(TileKey(tile));
+	}
+	std::sort(keys.begin(), keys.end());
+	return keys;
+}
+
+// Tile by tile, with no skipping
+class ReferenceFeedback {
+public:
+	explicit ReferenceFeedback(const ResourceTilingInfo& info)
+		: m_info(info)
+	{
+		for (const SubresourceTilingInfo& sub : info.subresourceTilingInfo) {
+			m_lastUsed.emplace_back(size_t(sub.WidthInTiles) * sub.HeightInTiles * sub.DepthInTiles, 0u);
+		}
+	}
+
+	void Process(FeedbackFormat format, const std::vector<uint8_t>& buffer, const std::vector<FeedbackTile>& mapped,
+		uint32_t idleFrames, std::vector<FeedbackTile>& outUsedMapped, FeedbackWork& outWork)
+	{
+		++m_frame;
+		std::vector<std::vector<uint8_t>> mappedBits;
+		for (const SubresourceTilingInfo& sub : m_info.subresourceTilingInfo) {
+			mappedBits.emplace_back(size_t(sub.WidthInTiles) * sub.HeightInTiles * sub.DepthInTiles, uint8_t(0));
+		}
+		for (const FeedbackTile& tile : mapped) {
+			mappedBits[tile.subresource][Index(tile.subresource, tile.x, tile.y, tile.z)] = 1;
+		}
+
+		auto use = [&](uint32_t m, uint32_t x, uint32_t y, uint32_t z) {
+			uint32_t& lastUsed = m_lastUsed[m][Index(m, x, y, z)];
+			if (lastUsed == m_frame) {
+				return;
+			}
+			lastUsed = m_frame;
+			(mappedBits[m][Index(m, x, y, z)] ? outUsedMapped : outWork.requests).push_back({ m, x, y, z });
+		};
+
+		const uint32_t mipCount = static_cast<uint32_t>(m_info.subresourceTilingInfo.size());
+		if (format == FeedbackFormat::TileBitmask) {
+			size_t firstWord = 0;
+			for (uint32_t m = 0; m < mipCount; ++m) {
+				const SubresourceTilingInfo& sub = m_info.subresourceTilingInfo[m];
+				size_t index = 0;
+				for (uint32_t z = 0; z < sub.DepthInTiles; ++z)
+					for (uint32_t y = 0; y < sub.HeightInTiles; ++y)
+						for (uint32_t x = 0; x < sub.WidthInTiles; ++x, ++index) {
+							const size_t bit = firstWord * 32 + index;
+							if (buffer[bit / 8] & (1u << (bit % 8))) {
+								use(m, x, y, z);
+							}
+						}
+				firstWord += (index + 31) / 32;
+			}
+		}
+		else {
+			const SubresourceTilingInfo& mip0 = m_info.subresourceTilingInfo[0];
+			size_t cell = 0;
+			for (uint32_t z = 0; z < mip0.DepthInTiles; ++z)
+				for (uint32_t y = 0; y < mip0.HeightInTiles; ++y)
+					for (uint32_t x = 0; x < mip0.WidthInTiles; ++x, ++cell) {
+						for (uint32_t m = buffer[cell]; m < mipCount; ++m) {
+							const SubresourceTilingInfo& sub = m_info.subresourceTilingInfo[m];
+							use(m, (std::min)(x >> m, sub.WidthInTiles - 1),
+								(std::min)(y >> m, sub.HeightInTiles - 1),
+								(std::min)(z >> m, sub.DepthInTiles - 1));
+						}
+					}
+		}
+
+		for (const FeedbackTile& tile : mapped) {
+			uint32_t& lastUsed = m_lastUsed[tile.subresource][Index(tile.subresource, tile.x, tile.y, tile.z)];
+			if (lastUsed == 0) {
+				lastUsed = m_frame;
+			}
+			if (m_frame - lastUsed >= idleFrames) {
+				outWork.evictionCandidates.push_back(tile);
+			}
+		}
+	}
+
+	uint32_t Idle(const FeedbackTile& tile) const
+	{
+		return m_frame - m_lastUsed[tile.subresource][Index(tile.subresource, tile.x, tile.y, tile.z)];
+	}
+
+private:
+	size_t Index(uint32_t m, uint32_t x, uint32_t y, uint32_t z) const
+	{
+		const SubresourceTilingInfo& sub = m_info.subresourceTilingInfo[m];
+		return (size_t(z) * sub.HeightInTiles + y) * sub.WidthInTiles + x;
+	}
+
+	const ResourceTilingInfo& m_info;
+	std::vector<std::vector<uint32_t>> m_lastUsed;
+	uint32_t m_frame = 0;
+};
+
+enum class Pattern { Sparse, Dense, Clustered };
+
+std::vector<uint8_t> MakeFeedback(FeedbackFormat format, Pattern pattern, size_t size, uint32_t mip0Width, std::mt19937& random)
+{
+	const uint32_t percent = pattern == Pattern::Sparse ? 2 : pattern == Pattern::Dense ? 50 : 0;
+	const size_t items = format == FeedbackFormat::TileBitmask ? size * 8 : size;
+	const size_t cluster = random() % items;
+	auto sampled = [&](size_t i) {
+		if (pattern == Pattern::Clustered) {
+			return i >= cluster && i < cluster + 2 * mip0Width;
+		}
+		return random() % 100 < percent;
+	};
+
+	std::vector<uint8_t> buffer(size, format == FeedbackFormat::MinMipGrid ? 0xFF : 0);
+	if (format == FeedbackFormat::TileBitmask) {
+		for (size_t bit = 0; bit < items; ++bit) {
+			if (sampled(bit)) {
+				buffer[bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+			}
+		}
+	}
+	else {
+		for (size_t cell = 0; cell < items; ++cell) {
+			if (sampled(cell)) {
+				// Mips past the last standard one stand for the packed tail
+				buffer[cell] = static_cast<uint8_t>(random() % 6);
+			}
+		}
+	}
+	return buffer;
+}
+
+void CheckAgainstReference(FeedbackFormat format)
+{
+	const ResourceTilingInfo info = MakeTilingInfo();
+	UsageFeedback feedback(info);
+	ReferenceFeedback reference(info);
+	std::mt19937 random(static_cast<uint32_t>(format) + 7);
+	const uint32_t idleFrames = 3;
+
+	const size_t size = feedback.GetBufferSize(format);
+	CHECK(size == (format == FeedbackFormat::TileBitmask ? (15 + 3 + 1 + 1) * 4u : 455u));
+
+	// Requested tiles are mapped for the next frame and a few candidates
+	// are unmapped, so mapped tiles come and go
+	std::vector<FeedbackTile> mapped;
+	for (uint32_t frame = 0; frame < 48; ++frame) {
+		const Pattern pattern = static_cast<Pattern>(frame % 3);
+		std::vector<uint8_t> buffer = MakeFeedback(format, pattern, size, info.subresourceTilingInfo[0].WidthInTiles, random);
+
+		std::vector<FeedbackTile> usedMapped;
+		FeedbackWork work;
+		CHECK(feedback.Process(format, buffer.data(), buffer.size(), mapped, idleFrames, usedMapped, work));
+
+		std::vector<FeedbackTile> expectedUsedMapped;
+		FeedbackWork expected;
+		reference.Process(format, buffer, mapped, idleFrames, expectedUsedMapped, expected);
+
+		CHECK(SortedKeys(work.requests) == SortedKeys(expected.requests));
+		CHECK(SortedKeys(usedMapped) == SortedKeys(expectedUsedMapped));
+		CHECK(SortedKeys(work.evictionCandidates) == SortedKeys(expected.evictionCandidates));
+		for (size_t i = 1; i < work.requests.size(); ++i) {
+			CHECK(work.requests[i - 1].subresource >= work.requests[i].subresource);
+		}
+		for (size_t i = 1; i < work.evictionCandidates.size(); ++i) {
+			CHECK(reference.Idle(work.evictionCandidates[i - 1]) >= reference.Idle(work.evictionCandidates[i]));
+		}
+
+		mapped.insert(mapped.end(), work.requests.begin(), work.requests.end());
+		for (size_t i = 0; i < work.evictionCandidates.size(); i += 2) {
+			const uint64_t key = TileKey(work.evictionCandidates[i]);
+			std::erase_if(mapped, [key](const FeedbackTile& tile) { return TileKey(tile) == key; });
+		}
+	}
+
+	// A buffer of the wrong size is rejected
+	std::vector<uint8_t> wrong(size + 4);
+	std::vector<FeedbackTile> usedMapped;
+	FeedbackWork work;
+	CHECK(!feedback.Process(format, wrong.data(), wrong.size(), mapped, idleFrames, usedMapped, work));
+}
+
+void CheckPluginFeedback()
+{
+	SoftwarePlugin software;
+	RenderingPlugin& plugin = *software.plugin;
+
+	// R8_UNORM tiles are 64x32x32 texels, so this volume is 8x8x8 tiles
+	VolumeHandle handle = plugin.CreateVolumetricResource(512, 256, 256, false, 1, DXGI_FORMAT_R8_UNORM);
+	ReservedResource* resource = plugin.GetVolumetricResource(handle);
+	CHECK(resource != nullptr);
+	if (!resource) {
+		return;
+	}
+	CHECK(plugin.EnableUsageFeedback(resource));
+
+	const TileBox box = { 0, 0, 0, 0, 2, 2, 2 };
+	std::vector<std::byte> payload = MakeTilePayload(box.TileCount(), 1);
+	CHECK(plugin.UploadDataToTileBox(resource, box, std::span<std::byte>(payload)));
+
+	const UINT64 size = plugin.GetUsageFeedbackSize(resource, FeedbackFormat::MinMipGrid);
+	CHECK(size == 512);
+
+	// The mapped box is sampled, and one tile outside it
+	std::vector<uint8_t> grid(size, 0xFF);
+	grid[0] = 0;
+	grid[(5 * 8 + 5) * 8 + 5] = 0;
+	FeedbackWork work;
+	CHECK(plugin.ProcessUsageFeedback(resource, FeedbackFormat::MinMipGrid, grid.data(), grid.size(), 2, work));
+	CHECK(work.requests.size() == 1);
+	if (work.requests.size() == 1) {
+		CHECK(work.requests[0].x == 5 && work.requests[0].y == 5 && work.requests[0].z == 5);
+	}
+	CHECK(work.evictionCandidates.empty());
+
+	// Two frames later, the mapped tiles that went unsampled are idle
+	std::fill(grid.begin(), grid.end(), uint8_t(0xFF));
+	grid[0] = 0;
+	for (int frame = 0; frame < 2; ++frame) {
+		work = {};
+		CHECK(plugin.ProcessUsageFeedback(resource, FeedbackFormat::MinMipGrid, grid.data(), grid.size(), 2, work));
+	}
+	CHECK(work.requests.empty());
+	CHECK(work.evictionCandidates.size() == box.TileCount() - 1);
+	for (const FeedbackTile& tile : work.evictionCandidates) {
+		CHECK(tile.x + tile.y + tile.z != 0);
+	}
+
+	software.SetQuiet(true);
+	CHECK(!plugin.ProcessUsageFeedback(resource, FeedbackFormat::MinMipGrid, grid.data(), grid.size() - 1, 2, work));
+	CHECK(plugin.DisableUsageFeedback(resource));
+	CHECK(!plugin.ProcessUsageFeedback(resource, FeedbackFormat::MinMipGrid, grid.data(), grid.size(), 2, work));
+	software.SetQuiet(false);
+
+	CHECK(plugin.DestroyVolumetricResource(handle));
+}
+
+} // namespace
+
+int main()
+{
+	CheckAgainstReference(FeedbackFormat::TileBitmask);
+	CheckAgainstReference(FeedbackFormat::MinMipGrid);
+	CheckPluginFeedback();
+	return TestExitCode();
+}
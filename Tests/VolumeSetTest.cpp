@@ -0,0 +1,174 @@
+// Volume sets: members need one tile grid and no CPU mip generation, each
+// coordinate maps to one heap run across the members, members only map and
+// unmap through the set, eviction keeps them in lockstep, and a set pinned
+// across DestroyVolumeSet stops accepting calls
+#include "TestSupport.h"
+
+namespace {
+
+// 512x512x256 RGBA8, R32_FLOAT and R16G16_FLOAT volumes tile as 16x16x16;
+// R8 tiles as 8x16x8
+constexpr UINT TILES = 16;
+constexpr DXGI_FORMAT FORMATS[] = {
+	DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R16G16_FLOAT, DXGI_FORMAT_R8_UNORM
+};
+constexpr UINT MEMBERS = 3;
+
+VolumeHandle CreateVolume(RenderingPlugin& plugin, DXGI_FORMAT format, UINT mipCount = 1)
+{
+	return plugin.CreateVolumetricResource(512, 512, 256, mipCount > 1, mipCount, format);
+}
+
+// Coordinates mapped in some members but not all, or whose mapping
+// disagrees with the set's record
+UINT CountOutOfStep(const VolumeSet& set)
+{
+	UINT outOfStep = 0;
+	for (UINT z = 0; z < TILES; ++z)
+		for (UINT y = 0; y < TILES; ++y)
+			for (UINT x = 0; x < TILES; ++x) {
+				UINT mapped = 0;
+				for (const ReservedResource* member : set.GetMembers()) {
+					mapped += member->IsTileMapped(0, x, y, z);
+				}
+				const bool recorded = set.IsMapped(0, x, y, z);
+				outOfStep += recorded ? mapped != MEMBERS : mapped != 0;
+			}
+	return outOfStep;
+}
+
+void CheckCreation()
+{
+	SoftwarePlugin software;
+	RenderingPlugin& plugin = *software.plugin;
+	VolumeHandle handles[4];
+	for (UINT i = 0; i < 4; ++i) {
+		handles[i] = CreateVolume(plugin, FORMATS[i]);
+	}
+
+	software.SetQuiet(true);
+	// R8 tiles over a different grid
+	CHECK(plugin.CreateVolumeSet(std::span<const VolumeHandle>(handles, 4)) == 0);
+
+	// CPU mips are built per volume, which set uploads do not do
+	VolumeHandle mipped[2] = { CreateVolume(plugin, FORMATS[0], 2), CreateVolume(plugin, FORMATS[1], 2) };
+	CHECK(plugin.SetMipGenerationMode(plugin.GetVolumetricResource(mipped[0]), MipFilter::Average));
+	CHECK(plugin.CreateVolumeSet(mipped) == 0);
+	CHECK(plugin.SetMipGenerationMode(plugin.GetVolumetricResource(mipped[0]), MipFilter::None));
+	VolumeSetHandle mippedSet = plugin.CreateVolumeSet(mipped);
+	CHECK(mippedSet != 0);
+	CHECK(!plugin.SetMipGenerationMode(plugin.GetVolumetricResource(mipped[1]), MipFilter::Average));
+	software.SetQuiet(false);
+	CHECK(plugin.SetMipGenerationMode(plugin.GetVolumetricResource(mipped[1]), MipFilter::None));
+	CHECK(plugin.DestroyVolumeSet(mippedSet));
+}
+
+void CheckLockstep()
+{
+	SoftwarePlugin software;
+	RenderingPlugin& plugin = *software.plugin;
+	const SoftwareBackend& backend = *software.backend;
+
+	VolumeHandle handles[MEMBERS];
+	ReservedResource* volumes[MEMBERS];
+	for (UINT i = 0; i < MEMBERS; ++i) {
+		handles[i] = CreateVolume(plugin, FORMATS[i]);
+		volumes[i] = plugin.GetVolumetricResource(handles[i]);
+	}
+	const VolumeSetHandle handle = plugin.CreateVolumeSet(handles);
+	VolumeSet* set = plugin.GetVolumeSet(handle);
+	CHECK(set != nullptr && set->MemberCount() == MEMBERS);
+	if (!set) {
+		return;
+	}
+
+	std::vector<std::byte> data[MEMBERS];
+	std::vector<std::span<std::byte>> planes;
+	std::vector<std::span<std::byte>> boxes;
+	for (UINT i = 0; i < MEMBERS; ++i) {
+		data[i] = MakeTilePayload(TILES * TILES, i);
+		planes.emplace_back(data[i]);
+		boxes.emplace_back(data[i].data(), 8 * SoftwareBackend::TILE_SIZE);
+	}
+
+	// Each coordinate's tiles sit side by side in the heap
+	const TileBox box = { 0, 2, 2, 2, 2, 2, 2 };
+	CHECK(plugin.UploadVolumeSetTileBox(set, box, boxes));
+	UINT runStart[MEMBERS] = {};
+	for (UINT i = 0; i < MEMBERS; ++i) {
+		CHECK(CountMatchingTiles(backend, volumes[i], box, data[i].data()) == box.TileCount());
+		CHECK(volumes[i]->GetMappedTileOffset(0, 2, 2, 2, &runStart[i]));
+		CHECK(runStart[i] == runStart[0] + i);
+	}
+
+	// Members map, unmap and go away only through the set
+	software.SetQuiet(true);
+	CHECK(!plugin.UploadDataToTileBox(volumes[1], { 0, 5, 5, 5, 1, 1, 1 }, boxes[1].subspan(0, SoftwareBackend::TILE_SIZE)));
+	CHECK(!plugin.UnmapDataFromTile(volumes[1], 0, 2, 2, 2));
+	CHECK(!plugin.DestroyVolumetricResource(handles[1]));
+	software.SetQuiet(false);
+
+	CHECK(plugin.UnmapVolumeSetTileBox(set, { 0, 2, 2, 2, 1, 2, 2 }));
+	for (UINT i = 0; i < MEMBERS; ++i) {
+		CHECK(!volumes[i]->IsTileMapped(0, 2, 2, 2));
+		CHECK(volumes[i]->IsTileMapped(0, 3, 2, 2));
+	}
+	CHECK(set->MappedCount() == 4);
+	CHECK(CountOutOfStep(*set) == 0);
+
+	// 16 planes of 256 coordinates are 12288 tiles, half again what the
+	// heap holds, so older planes are evicted a coordinate at a time
+	CHECK(plugin.EnableResidencyManagement(true));
+	software.SetQuiet(true);
+	UINT failures = 0;
+	for (UINT z = 0; z < TILES; ++z) {
+		CHECK(plugin.AdvanceResidencyFrame());
+		TileBox plane = { 0, 0, 0, z, TILES, TILES, 1 };
+		if (z == 2 || z == 3) {
+			// Skip the coordinates still mapped from the box
+			plane = { 0, 4, 0, z, TILES - 4, TILES, 1 };
+		}
+		std::vector<std::span<std::byte>> payloads;
+		for (std::span<std::byte> member : planes) {
+			payloads.push_back(member.subspan(0, plane.TileCount() * SoftwareBackend::TILE_SIZE));
+		}
+		failures += !plugin.UploadVolumeSetTileBox(set, plane, payloads);
+	}
+	software.SetQuiet(false);
+	CHECK(failures == 0);
+	CHECK(CountOutOfStep(*set) == 0);
+	CHECK(set->MappedCount() < TILES * TILES * TILES);
+	const TileBox lastPlane = { 0, 0, 0, TILES - 1, TILES, TILES, 1 };
+	for (UINT i = 0; i < MEMBERS; ++i) {
+		CHECK(CountMatchingTiles(backend, volumes[i], lastPlane, data[i].data()) == lastPlane.TileCount());
+	}
+
+	// A pin keeps the set alive past DestroyVolumeSet, but set calls on it fail
+	std::shared_ptr<VolumeSet> pinned = plugin.PinVolumeSet(handle);
+	CHECK(pinned.get() == set);
+	CHECK(plugin.DestroyVolumeSet(handle));
+	software.SetQuiet(true);
+	CHECK(plugin.GetVolumeSet(handle) == nullptr);
+	CHECK(plugin.PinVolumeSet(handle) == nullptr);
+	CHECK(!plugin.UnmapVolumeSetTileBox(pinned.get(), lastPlane));
+	CHECK(!plugin.UploadVolumeSetTileBox(pinned.get(), { 0, 0, 0, 0, 1, 1, 1 }, boxes));
+	software.SetQuiet(false);
+	CHECK(volumes[0]->IsTileMapped(0, 0, 0, TILES - 1));
+	pinned.reset();
+
+	// Members stand alone again and keep their tiles
+	CHECK(plugin.UnmapDataFromTile(volumes[1], 0, 0, 0, TILES - 1));
+	for (UINT i = 0; i < MEMBERS; ++i) {
+		CHECK(plugin.DestroyVolumetricResource(handles[i]));
+	}
+	CHECK(backend.GetStats().tilesMapped == 0);
+}
+
+} // namespace
+
+int main()
+{
+	CheckCreation();
+	CheckLockstep();
+	return TestExitCode();
+}
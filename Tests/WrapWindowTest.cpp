@@ -0,0 +1,180 @@
+// Wrap addressing: enabling needs a single mip and whole tiles, and over a
+// random walk of scrolls every physical tile holds its world tile's data,
+// only entering tiles are uploaded, the entering boxes never overlap or
+// exceed MAX_ENTERING_BOXES, and the texel offset tracks the origin
+#include "TestSupport.h"
+#include "WrapWindow.h"
+#include <random>
+
+namespace {
+
+// 256x256x64 RGBA8 tiles as 8x8x4, 32x32x16 texels each
+constexpr UINT EXTENT[3] = { 8, 8, 4 };
+constexpr UINT TILE_TEXELS[3] = { 32, 32, 16 };
+constexpr UINT WINDOW_TILES = EXTENT[0] * EXTENT[1] * EXTENT[2];
+
+void FillWorldTile(std::byte* tile, INT64 x, INT64 y, INT64 z)
+{
+	uint64_t state = static_cast<uint64_t>(x) * 73856093u ^ static_cast<uint64_t>(y) * 19349663u ^ static_cast<uint64_t>(z) * 83492791u;
+	for (size_t i = 0; i < SoftwareBackend::TILE_SIZE; i += sizeof(state)) {
+		state = state * 6364136223846793005ull + 1442695040888963407ull;
+		memcpy(tile + i, &state, sizeof(state));
+	}
+}
+
+bool UploadWorldBox(RenderingPlugin& plugin, ReservedResource* resource, const WrapBox& box)
+{
+	std::vector<std::byte> data(static_cast<size_t>(box.width) * box.height * box.depth * SoftwareBackend::TILE_SIZE);
+	size_t i = 0;
+	for (UINT z = 0; z < box.depth; ++z)
+		for (UINT y = 0; y < box.height; ++y)
+			for (UINT x = 0; x < box.width; ++x, ++i) {
+				FillWorldTile(data.data() + i * SoftwareBackend::TILE_SIZE, box.worldX + x, box.worldY + y, box.worldZ + z);
+			}
+	const TileBox physical = { 0, box.startX, box.startY, box.startZ, box.width, box.height, box.depth };
+	return plugin.UploadDataToTileBox(resource, physical, std::span<std::byte>(data));
+}
+
+UINT Wrap(INT64 world, UINT extent)
+{
+	return static_cast<UINT>(((world % extent) + extent) % extent);
+}
+
+// Physical tiles that do not hold the data of the world tile wrapped onto them
+UINT CountStaleTiles(const SoftwareBackend& backend, const ReservedResource* resource, const INT64 origin[3])
+{
+	std::vector<std::byte> tile(SoftwareBackend::TILE_SIZE);
+	std::vector<std::byte> expected(SoftwareBackend::TILE_SIZE);
+	UINT stale = 0;
+	for (INT64 z = origin[2]; z < origin[2] + EXTENT[2]; ++z)
+		for (INT64 y = origin[1]; y < origin[1] + EXTENT[1]; ++y)
+			for (INT64 x = origin[0]; x < origin[0] + EXTENT[0]; ++x) {
+				FillWorldTile(expected.data(), x, y, z);
+				const bool read = backend.ReadTile(resource, 0, Wrap(x, EXTENT[0]), Wrap(y, EXTENT[1]), Wrap(z, EXTENT[2]), tile.data());
+				stale += !read || memcmp(tile.data(), expected.data(), tile.size()) != 0;
+			}
+	return stale;
+}
+
+void CheckEnable()
+{
+	SoftwarePlugin software;
+	RenderingPlugin& plugin = *software.plugin;
+	ReservedResource* mipped = plugin.GetVolumetricResource(plugin.CreateVolumetricResource(256, 256, 64, true, 3, DXGI_FORMAT_R8G8B8A8_UNORM));
+	ReservedResource* partial = plugin.GetVolumetricResource(plugin.CreateVolumetricResource(250, 256, 64, false, 1, DXGI_FORMAT_R8G8B8A8_UNORM));
+	ReservedResource* plain = plugin.GetVolumetricResource(plugin.CreateVolumetricResource(256, 256, 64, false, 1, DXGI_FORMAT_R8G8B8A8_UNORM));
+
+	software.SetQuiet(true);
+	CHECK(!plugin.ScrollVolume(plain, 1, 0, 0));
+	CHECK(!plugin.EnableWrapAddressing(mipped, true));
+	CHECK(!plugin.EnableWrapAddressing(partial, true));
+	software.SetQuiet(false);
+	CHECK(plugin.EnableWrapAddressing(plain, true));
+	CHECK(plugin.EnableWrapAddressing(plain, false));
+}
+
+void CheckRandomWalk()
+{
+	SoftwarePlugin software;
+	RenderingPlugin& plugin = *software.plugin;
+	const SoftwareBackend& backend = *software.backend;
+	const VolumeHandle handle = plugin.CreateVolumetricResource(256, 256, 64, false, 1, DXGI_FORMAT_R8G8B8A8_UNORM);
+	ReservedResource* resource = plugin.GetVolumetricResource(handle);
+	CHECK(plugin.EnableWrapAddressing(resource, true));
+	CHECK(UploadWorldBox(plugin, resource, { 0, 0, 0, EXTENT[0], EXTENT[1], EXTENT[2], 0, 0, 0 }));
+
+	INT64 origin[3] = {};
+	std::mt19937 rng(5);
+	size_t uploaded = 0;
+	size_t expected = 0;
+	size_t maxBoxes = 0;
+	UINT overlaps = 0;
+	UINT stale = 0;
+	UINT failedUploads = 0;
+	UINT wrongOffsets = 0;
+	for (int step = 0; step < 60; ++step) {
+		INT64 delta[3];
+		for (int axis = 0; axis < 3; ++axis) {
+			delta[axis] = static_cast<INT64>(rng() % 7) - 3;
+		}
+		if (step == 30) {
+			// Further than the extent on one axis replaces every tile
+			delta[0] = 11;
+			delta[1] = -2;
+			delta[2] = 0;
+		}
+
+		std::vector<WrapBox> entering;
+		CHECK(plugin.ScrollVolume(resource, delta[0], delta[1], delta[2], &entering));
+
+		size_t staying = 1;
+		for (int axis = 0; axis < 3; ++axis) {
+			const INT64 distance = delta[axis] < 0 ? -delta[axis] : delta[axis];
+			staying *= distance >= EXTENT[axis] ? 0 : EXTENT[axis] - distance;
+			origin[axis] += delta[axis];
+		}
+		expected += WINDOW_TILES - staying;
+		maxBoxes = (std::max)(maxBoxes, entering.size());
+
+		std::vector<UINT> covered(WINDOW_TILES, 0);
+		for (const WrapBox& box : entering) {
+			uploaded += static_cast<size_t>(box.width) * box.height * box.depth;
+			for (UINT z = 0; z < box.depth; ++z)
+				for (UINT y = 0; y < box.height; ++y)
+					for (UINT x = 0; x < box.width; ++x) {
+						overlaps += covered[((box.startZ + z) * EXTENT[1] + box.startY + y) * EXTENT[0] + box.startX + x]++ != 0;
+					}
+			failedUploads += !UploadWorldBox(plugin, resource, box);
+		}
+		stale += CountStaleTiles(backend, resource, origin);
+
+		UINT offset[3];
+		CHECK(plugin.GetWrapOffset(resource, offset));
+		for (int axis = 0; axis < 3; ++axis) {
+			wrongOffsets += offset[axis] != Wrap(origin[axis], EXTENT[axis]) * TILE_TEXELS[axis];
+		}
+	}
+
+	CHECK(stale == 0);
+	CHECK(failedUploads == 0);
+	CHECK(wrongOffsets == 0);
+	CHECK(overlaps == 0);
+	CHECK(uploaded == expected);
+	CHECK(maxBoxes <= WrapWindow::MAX_ENTERING_BOXES);
+	CHECK(backend.GetStats().tilesMapped == WINDOW_TILES);
+
+	CHECK(plugin.EnableWrapAddressing(resource, false));
+	CHECK(plugin.DestroyVolumetricResource(handle));
+	CHECK(backend.GetStats().tilesMapped == 0);
+}
+
+// Every combination of small moves stays within the bound the ScrollVolume
+// export sizes its output for
+void CheckEnteringBoxBound()
+{
+	WrapWindow window(EXTENT[0], EXTENT[1], EXTENT[2]);
+	size_t maxBoxes = 0;
+	std::vector<WrapBox> ignored;
+	for (INT64 dz = -5; dz <= 5; ++dz)
+		for (INT64 dy = -9; dy <= 9; ++dy)
+			for (INT64 dx = -9; dx <= 9; ++dx) {
+				// Off-grid origins split boxes at the wrap seam
+				ignored.clear();
+				window.Scroll(3, 5, 1, ignored);
+				std::vector<WrapBox> entering;
+				window.Scroll(dx, dy, dz, entering);
+				maxBoxes = (std::max)(maxBoxes, entering.size());
+			}
+	CHECK(maxBoxes > 0);
+	CHECK(maxBoxes <= WrapWindow::MAX_ENTERING_BOXES);
+}
+
+} // namespace
+
+int main()
+{
+	CheckEnable();
+	CheckRandomWalk();
+	CheckEnteringBoxBound();
+	return TestExitCode();
+}
@@ -0,0 +1,342 @@
+#include "pch.h"
+
+#include "TileArchive.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <tuple>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::filesystem::path PathFromUtf8(const std::string& utf8Path)
+{
+	return std::filesystem::path(std::u8string(utf8Path.begin(), utf8Path.end()));
+}
+
+auto EntryKey(const TileArchiveEntry& entry)
+{
+	return std::make_tuple(entry.subresource, entry.z, entry.y, entry.x);
+}
+
+bool IsValidElementSize(uint32_t elementSize)
+{
+	return elementSize == 1 || elementSize == 2 || elementSize == 4 || elementSize == 8 || elementSize == 16;
+}
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+// ---- Reader ----
+
+std::unique_ptr<TileArchive> TileArchive::Open(const std::string& utf8Path, std::string* outError)
+{
+	std::unique_ptr<TileArchive> archive(new TileArchive());
+	const std::filesystem::path path = PathFromUtf8(utf8Path);
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		*outError = "cannot open file";
+		return nullptr;
+	}
+	archive->m_file = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(TileArchiveHeader))) {
+		*outError = "file is smaller than the archive header";
+		return nullptr;
+	}
+	archive->m_size = static_cast<size_t>(fileSize.QuadPart);
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		*outError = "CreateFileMapping failed";
+		return nullptr;
+	}
+	archive->m_mapping = mapping;
+
+	archive->m_data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!archive->m_data) {
+		*outError = "MapViewOfFile failed";
+		return nullptr;
+	}
+#else
+	const int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		*outError = "cannot open file";
+		return nullptr;
+	}
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(TileArchiveHeader))) {
+		close(file);
+		*outError = "file is smaller than the archive header";
+		return nullptr;
+	}
+	archive->m_size = static_cast<size_t>(info.st_size);
+
+	void* data = mmap(nullptr, archive->m_size, PROT_READ, MAP_SHARED, file, 0);
+	close(file);
+	if (data == MAP_FAILED) {
+		*outError = "mmap failed";
+		return nullptr;
+	}
+	archive->m_data = static_cast<const std::byte*>(data);
+#endif
+
+	// Validate everything Find and ReadTile rely on, once
+	std::memcpy(&archive->m_header, archive->m_data, sizeof(TileArchiveHeader));
+	const TileArchiveHeader& header = archive->m_header;
+	if (header.magic != TILE_ARCHIVE_MAGIC || header.version != TILE_ARCHIVE_VERSION) {
+		*outError = "not a tile archive, or an unfinished one";
+		return nullptr;
+	}
+	if (!IsValidElementSize(header.elementSize)) {
+		*outError = "unsupported element size";
+		return nullptr;
+	}
+
+	const uint64_t indexBytes = static_cast<uint64_t>(header.recordCount) * sizeof(TileArchiveEntry);
+	if (header.indexOffset % alignof(TileArchiveEntry) != 0 ||
+		header.indexOffset < sizeof(TileArchiveHeader) ||
+		header.indexOffset > archive->m_size ||
+		indexBytes > archive->m_size - header.indexOffset) {
+		*outError = "index lies outside the file";
+		return nullptr;
+	}
+	archive->m_index = reinterpret_cast<const TileArchiveEntry*>(archive->m_data + header.indexOffset);
+
+	for (uint32_t i = 0; i < header.recordCount; ++i) {
+		const TileArchiveEntry& entry = archive->m_index[i];
+		const bool sizeOk = entry.encoding == static_cast<uint32_t>(TileRecordEncoding::Raw)
+			? entry.size == TILE_ARCHIVE_TILE_SIZE
+			: entry.encoding == static_cast<uint32_t>(TileRecordEncoding::Encoded) && entry.size >= sizeof(EncodedTileHeader);
+		if (!sizeOk ||
+			entry.offset < sizeof(TileArchiveHeader) ||
+			entry.offset > header.indexOffset ||
+			entry.size > header.indexOffset - entry.offset) {
+			*outError = "index entry " + std::to_string(i) + " is invalid";
+			return nullptr;
+		}
+		if (i > 0 && !(EntryKey(archive->m_index[i - 1]) < EntryKey(entry))) {
+			*outError = "index is not sorted or has duplicate tiles";
+			return nullptr;
+		}
+	}
+
+	return archive;
+}
+
+TileArchive::~TileArchive()
+{
+#if defined(_WIN32)
+	if (m_data) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping) {
+		CloseHandle(m_mapping);
+	}
+	if (m_file) {
+		CloseHandle(m_file);
+	}
+#else
+	if (m_data) {
+		munmap(const_cast<std::byte*>(m_data), m_size);
+	}
+#endif
+}
+
+const TileArchiveEntry* TileArchive::Find(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z) const
+{
+	const auto key = std::make_tuple(subresource, z, y, x);
+	const TileArchiveEntry* end = m_index + m_header.recordCount;
+	const TileArchiveEntry* it = std::lower_bound(m_index, end, key,
+		[](const TileArchiveEntry& entry, const auto& k) { return EntryKey(entry) < k; });
+	return (it != end && EntryKey(*it) == key) ? it : nullptr;
+}
+
+bool TileArchive::ReadEncodedRecord(const TileArchiveEntry& entry, EncodedTileView* outView) const
+{
+	size_t offset = 0;
+	return ReadEncodedTile(m_data + entry.offset, entry.size, &offset, m_header.elementSize, outView) &&
+		offset == entry.size &&
+		ValidateEncodedTile(*outView, m_header.elementSize, TILE_ARCHIVE_TILE_SIZE);
+}
+
+bool TileArchive::ValidateRecord(const TileArchiveEntry& entry) const
+{
+	if (entry.encoding == static_cast<uint32_t>(TileRecordEncoding::Raw)) {
+		return true;
+	}
+	EncodedTileView view;
+	return ReadEncodedRecord(entry, &view);
+}
+
+bool TileArchive::ReadTile(const TileArchiveEntry& entry, std::byte* destination) const
+{
+	if (entry.encoding == static_cast<uint32_t>(TileRecordEncoding::Raw)) {
+		std::memcpy(destination, m_data + entry.offset, TILE_ARCHIVE_TILE_SIZE);
+		return true;
+	}
+
+	EncodedTileView view;
+	if (!ReadEncodedRecord(entry, &view)) {
+		std::memset(destination, 0, TILE_ARCHIVE_TILE_SIZE);
+		return false;
+	}
+	DecodeTile(view, m_header.elementSize, destination, TILE_ARCHIVE_TILE_SIZE);
+	return true;
+}
+
+void TileArchive::Prefetch(const TileArchiveEntry* const* entries, size_t count) const
+{
+#if defined(_WIN32)
+	std::vector<WIN32_MEMORY_RANGE_ENTRY> ranges(count);
+	for (size_t i = 0; i < count; ++i) {
+		ranges[i].VirtualAddress = const_cast<std::byte*>(m_data + entries[i]->offset);
+		ranges[i].NumberOfBytes = entries[i]->size;
+	}
+	if (!ranges.empty()) {
+		// Best effort: failure only means the copy faults pages in itself
+		PrefetchVirtualMemory(GetCurrentProcess(), ranges.size(), ranges.data(), 0);
+	}
+#else
+	const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+	for (size_t i = 0; i < count; ++i) {
+		const uintptr_t start = reinterpret_cast<uintptr_t>(m_data + entries[i]->offset);
+		const uintptr_t alignedStart = start & ~(pageSize - 1);
+		madvise(reinterpret_cast<void*>(alignedStart), start + entries[i]->size - alignedStart, MADV_WILLNEED);
+	}
+#endif
+}
+
+// ---- Writer ----
+
+std::unique_ptr<TileArchiveWriter> TileArchiveWriter::Create(
+	const std::string& utf8Path,
+	uint32_t format,
+	uint32_t elementSize,
+	std::string* outError)
+{
+	if (!IsValidElementSize(elementSize)) {
+		*outError = "unsupported element size";
+		return nullptr;
+	}
+
+	std::unique_ptr<TileArchiveWriter> writer(new TileArchiveWriter());
+	writer->m_file.open(PathFromUtf8(utf8Path), std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!writer->m_file) {
+		*outError = "cannot create file";
+		return nullptr;
+	}
+
+	writer->m_header.magic = TILE_ARCHIVE_MAGIC;
+	writer->m_header.version = TILE_ARCHIVE_VERSION;
+	writer->m_header.format = format;
+	writer->m_header.elementSize = elementSize;
+
+	// Zeroed until Finish, so an interrupted bake never opens
+	const TileArchiveHeader placeholder = {};
+	if (!writer->WriteAt(0, &placeholder, sizeof(placeholder))) {
+		*outError = "write failed";
+		return nullptr;
+	}
+	return writer;
+}
+
+bool TileArchiveWriter::AddTile(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z, const std::byte* tile, bool compress, std::string* outError)
+{
+	if (m_finished) {
+		*outError = "archive is already finished";
+		return false;
+	}
+
+	TileArchiveEntry entry = {};
+	entry.subresource = subresource;
+	entry.x = x;
+	entry.y = y;
+	entry.z = z;
+
+	const void* record = tile;
+	if (compress) {
+		m_scratch.clear();
+		EncodeTile(tile, TILE_ARCHIVE_TILE_SIZE, m_header.elementSize, m_scratch);
+	}
+
+	if (compress && m_scratch.size() < TILE_ARCHIVE_TILE_SIZE) {
+		entry.encoding = static_cast<uint32_t>(TileRecordEncoding::Encoded);
+		entry.size = static_cast<uint32_t>(m_scratch.size());
+		entry.offset = AlignUp(m_end, TILE_ARCHIVE_PACKED_ALIGNMENT);
+		record = m_scratch.data();
+	}
+	else {
+		entry.encoding = static_cast<uint32_t>(TileRecordEncoding::Raw);
+		entry.size = static_cast<uint32_t>(TILE_ARCHIVE_TILE_SIZE);
+		entry.offset = AlignUp(m_end, TILE_ARCHIVE_TILE_SIZE);
+	}
+
+	if (!WriteAt(entry.offset, record, entry.size)) {
+		*outError = "write failed";
+		return false;
+	}
+
+	m_end = entry.offset + entry.size;
+	m_entries.push_back(entry);
+	return true;
+}
+
+bool TileArchiveWriter::Finish(std::string* outError)
+{
+	if (m_finished) {
+		return true;
+	}
+
+	std::sort(m_entries.begin(), m_entries.end(),
+		[](const TileArchiveEntry& a, const TileArchiveEntry& b) { return EntryKey(a) < EntryKey(b); });
+	auto duplicate = std::adjacent_find(m_entries.begin(), m_entries.end(),
+		[](const TileArchiveEntry& a, const TileArchiveEntry& b) { return EntryKey(a) == EntryKey(b); });
+	if (duplicate != m_entries.end()) {
+		*outError = "tile (" + std::to_string(duplicate->x) + ", " + std::to_string(duplicate->y) + ", "
+			+ std::to_string(duplicate->z) + ") of subresource " + std::to_string(duplicate->subresource)
+			+ " was added twice";
+		return false;
+	}
+
+	m_header.recordCount = static_cast<uint32_t>(m_entries.size());
+	m_header.indexOffset = AlignUp(m_end, alignof(TileArchiveEntry));
+
+	if (!WriteAt(m_header.indexOffset, m_entries.data(), m_entries.size() * sizeof(TileArchiveEntry)) ||
+		!WriteAt(0, &m_header, sizeof(m_header))) {
+		*outError = "write failed";
+		return false;
+	}
+
+	m_file.close();
+	if (m_file.fail()) {
+		*outError = "close failed";
+		return false;
+	}
+
+	m_finished = true;
+	return true;
+}
+
+bool TileArchiveWriter::WriteAt(uint64_t offset, const void* data, size_t size)
+{
+	// Seeking past the end leaves a hole that reads back as zeros
+	m_file.seekp(static_cast<std::streamoff>(offset));
+	m_file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+	return static_cast<bool>(m_file);
+}
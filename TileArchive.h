@@ -0,0 +1,123 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TileCodec.h"
+
+// On-disk archive of prebaked tiles, read through a read-only file mapping.
+//
+//   [TileArchiveHeader]
+//   [records]  raw tiles start on 64KB boundaries so a record is whole
+//              pages of the mapping; TileCodec records are packed at
+//              TILE_ARCHIVE_PACKED_ALIGNMENT
+//   [index]    recordCount TileArchiveEntry, sorted by (subresource, z, y, x)
+//
+// All fields are little-endian.
+constexpr uint32_t TILE_ARCHIVE_MAGIC = 0x41545653; // "SVTA"
+constexpr uint32_t TILE_ARCHIVE_VERSION = 1;
+constexpr uint64_t TILE_ARCHIVE_TILE_SIZE = 65536;
+constexpr uint64_t TILE_ARCHIVE_PACKED_ALIGNMENT = 64;
+
+struct TileArchiveHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t format;        // DXGI_FORMAT the tiles were baked for
+	uint32_t elementSize;   // Texel size, or block size for BC formats
+	uint32_t recordCount;
+	uint32_t reserved;
+	uint64_t indexOffset;
+};
+static_assert(sizeof(TileArchiveHeader) == 32, "archive header is 32 bytes");
+
+enum class TileRecordEncoding : uint32_t {
+	Raw = 0,      // TILE_ARCHIVE_TILE_SIZE bytes, linear tile layout
+	Encoded = 1   // One TileCodec tile
+};
+
+struct TileArchiveEntry {
+	uint32_t subresource;
+	uint32_t x, y, z;
+	uint64_t offset;
+	uint32_t size;
+	uint32_t encoding;      // TileRecordEncoding
+};
+static_assert(sizeof(TileArchiveEntry) == 32, "archive index entry is 32 bytes");
+
+class TileArchive {
+public:
+	// Maps the file and checks the header and every index entry. Returns
+	// nullptr and sets outError if the file is missing or malformed.
+	static std::unique_ptr<TileArchive> Open(const std::string& utf8Path, std::string* outError);
+
+	~TileArchive();
+
+	TileArchive(const TileArchive&) = delete;
+	TileArchive& operator=(const TileArchive&) = delete;
+
+	const TileArchiveHeader& Header() const { return m_header; }
+
+	// Binary search of the index; nullptr if the archive lacks the tile
+	const TileArchiveEntry* Find(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z) const;
+
+	// Checks an encoded record decodes to exactly one tile. Open only
+	// checks that records lie inside the file.
+	bool ValidateRecord(const TileArchiveEntry& entry) const;
+
+	// Copies or decodes one record into TILE_ARCHIVE_TILE_SIZE bytes. Pages
+	// fault in from disk on first touch. A corrupt record zero-fills the
+	// destination and returns false.
+	bool ReadTile(const TileArchiveEntry& entry, std::byte* destination) const;
+
+	// Asks the OS to start reading the records in the background
+	void Prefetch(const TileArchiveEntry* const* entries, size_t count) const;
+
+private:
+	TileArchive() = default;
+
+	bool ReadEncodedRecord(const TileArchiveEntry& entry, EncodedTileView* outView) const;
+
+	const std::byte* m_data = nullptr;
+	size_t m_size = 0;
+	TileArchiveHeader m_header = {};
+	const TileArchiveEntry* m_index = nullptr;
+
+#if defined(_WIN32)
+	void* m_file = nullptr;
+	void* m_mapping = nullptr;
+#endif
+};
+
+// Streams tiles into a new archive. Raw records go straight to disk; only
+// the index is held in memory until Finish.
+class TileArchiveWriter {
+public:
+	// Returns nullptr and sets outError if the file cannot be created
+	static std::unique_ptr<TileArchiveWriter> Create(
+		const std::string& utf8Path,
+		uint32_t format,
+		uint32_t elementSize,
+		std::string* outError);
+
+	// tile is TILE_ARCHIVE_TILE_SIZE linear bytes. With compress set, the
+	// tile is stored TileCodec-encoded when that is smaller than raw.
+	bool AddTile(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z, const std::byte* tile, bool compress, std::string* outError);
+
+	// Writes the index and the final header; the archive is unusable until
+	// this succeeds
+	bool Finish(std::string* outError);
+
+private:
+	TileArchiveWriter() = default;
+
+	bool WriteAt(uint64_t offset, const void* data, size_t size);
+
+	std::ofstream m_file;
+	uint64_t m_end = sizeof(TileArchiveHeader);
+	TileArchiveHeader m_header = {};
+	std::vector<TileArchiveEntry> m_entries;
+	std::vector<std::byte> m_scratch;
+	bool m_finished = false;
+};
@@ -0,0 +1,475 @@
+#include "pch.h"
+
+#include "TileCodec.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// ---- Shared helpers ----
+
+size_t VarintSize(size_t value)
+{
+	size_t bytes = 1;
+	while (value >= 0x80) {
+		value >>= 7;
+		++bytes;
+	}
+	return bytes;
+}
+
+void AppendVarint(std::vector<std::byte>& out, size_t value)
+{
+	while (value >= 0x80) {
+		out.push_back(static_cast<std::byte>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<std::byte>(value));
+}
+
+// Returns false on truncation or a value wider than 32 bits
+bool ReadVarint(const std::byte* data, size_t size, size_t* position, uint32_t* outValue)
+{
+	uint32_t value = 0;
+	for (uint32_t shift = 0; shift < 35; shift += 7) {
+		if (*position >= size) {
+			return false;
+		}
+		const uint32_t byte = static_cast<uint32_t>(data[(*position)++]);
+		value |= (byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			*outValue = value;
+			return true;
+		}
+	}
+	return false;
+}
+
+uint32_t BitsForPalette(size_t entryCount)
+{
+	if (entryCount <= 2) return 1;
+	if (entryCount <= 4) return 2;
+	if (entryCount <= 16) return 4;
+	return 8;
+}
+
+size_t PaletteBodySize(size_t entryCount, uint32_t elementSize, size_t elementCount)
+{
+	return 4 + entryCount * elementSize + (elementCount * BitsForPalette(entryCount) + 7) / 8;
+}
+
+// Writes count copies of element, doubling the filled span each step
+void FillElements(std::byte* destination, const std::byte* element, uint32_t elementSize, size_t count)
+{
+	const size_t total = count * elementSize;
+	if (total == 0) {
+		return;
+	}
+	if (elementSize == 1) {
+		std::memset(destination, static_cast<int>(element[0]), total);
+		return;
+	}
+
+	std::memcpy(destination, element, elementSize);
+	size_t filled = elementSize;
+	while (filled < total) {
+		const size_t chunk = (std::min)(filled, total - filled);
+		std::memcpy(destination + filled, destination, chunk);
+		filled += chunk;
+	}
+}
+
+// ---- Run-length decode ----
+
+template <uint32_t ElementSize>
+void DecodeRunLength(const std::byte* body, uint32_t bodySize, std::byte* destination)
+{
+	size_t position = 0;
+	while (position < bodySize) {
+		uint32_t length = 0;
+		ReadVarint(body, bodySize, &position, &length);
+		const std::byte* element = body + position;
+		position += ElementSize;
+
+		// Short runs are common at material boundaries; fixed-size copies
+		// beat the doubling fill there
+		if (length <= 8) {
+			for (uint32_t i = 0; i < length; ++i) {
+				std::memcpy(destination + static_cast<size_t>(i) * ElementSize, element, ElementSize);
+			}
+		}
+		else {
+			FillElements(destination, element, ElementSize, length);
+		}
+		destination += static_cast<size_t>(length) * ElementSize;
+	}
+}
+
+// ---- Palette decode ----
+
+#if defined(SPARSE_X86)
+// 1-byte elements with 4-bit indices (up to 16 materials per tile) are a
+// pshufb table lookup: 16 texels per 8 index bytes.
+SPARSE_TARGET("ssse3")
+size_t DecodePalette4BitBytesSSSE3(const uint8_t* indices, const std::byte* table, std::byte* destination, size_t count)
+{
+	const __m128i lookup = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table));
+	const __m128i lowNibble = _mm_set1_epi8(0x0F);
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices + i / 2));
+		const __m128i low = _mm_and_si128(packed, lowNibble);
+		const __m128i high = _mm_and_si128(_mm_srli_epi16(packed, 4), lowNibble);
+		const __m128i ordered = _mm_unpacklo_epi8(low, high);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_shuffle_epi8(lookup, ordered));
+	}
+	return i;
+}
+#elif defined(SPARSE_NEON)
+size_t DecodePalette4BitBytesNeon(const uint8_t* indices, const std::byte* table, std::byte* destination, size_t count)
+{
+	const uint8x16_t lookup = vld1q_u8(reinterpret_cast<const uint8_t*>(table));
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		const uint8x8_t packed = vld1_u8(indices + i / 2);
+		const uint8x8x2_t ordered = vzip_u8(vand_u8(packed, vdup_n_u8(0x0F)), vshr_n_u8(packed, 4));
+		vst1q_u8(reinterpret_cast<uint8_t*>(destination + i),
+			vqtbl1q_u8(lookup, vcombine_u8(ordered.val[0], ordered.val[1])));
+	}
+	return i;
+}
+#endif
+
+template <uint32_t ElementSize, uint32_t Bits>
+void DecodePaletteIndices(const uint8_t* indices, const std::byte* table, std::byte* destination, size_t count)
+{
+	constexpr uint32_t perByte = 8 / Bits;
+	constexpr uint32_t mask = (1u << Bits) - 1;
+	size_t i = 0;
+
+	if constexpr (ElementSize == 1 && Bits == 4) {
+#if defined(SPARSE_X86)
+		static const bool hasSSSE3 = CpuFeatures::HasSSSE3();
+		if (hasSSSE3) {
+			i = DecodePalette4BitBytesSSSE3(indices, table, destination, count);
+		}
+#elif defined(SPARSE_NEON)
+		i = DecodePalette4BitBytesNeon(indices, table, destination, count);
+#endif
+	}
+
+	std::byte* out = destination + i * ElementSize;
+	if constexpr (Bits < 8 && ElementSize * perByte <= 16) {
+		// Everything one index byte expands to fits in 16 bytes, so expand
+		// all 256 possible bytes once and copy whole groups
+		constexpr size_t groupBytes = static_cast<size_t>(ElementSize) * perByte;
+		std::byte expanded[256][16];
+		for (uint32_t value = 0; value < 256; ++value) {
+			for (uint32_t k = 0; k < perByte; ++k) {
+				std::memcpy(expanded[value] + k * ElementSize,
+					table + static_cast<size_t>((value >> (k * Bits)) & mask) * ElementSize, ElementSize);
+			}
+		}
+		for (size_t byte = i / perByte; byte < count / perByte; ++byte) {
+			std::memcpy(out, expanded[indices[byte]], groupBytes);
+			out += groupBytes;
+		}
+	}
+	else {
+		// One index byte at a time; the inner loop unrolls to perByte lookups
+		for (size_t byte = i / perByte; byte < count / perByte; ++byte) {
+			uint32_t packed = indices[byte];
+			for (uint32_t k = 0; k < perByte; ++k) {
+				std::memcpy(out, table + static_cast<size_t>(packed & mask) * ElementSize, ElementSize);
+				packed >>= Bits;
+				out += ElementSize;
+			}
+		}
+	}
+
+	for (i = count / perByte * perByte; i < count; ++i) {
+		const uint32_t index = (indices[i / perByte] >> ((i % perByte) * Bits)) & mask;
+		std::memcpy(destination + i * ElementSize, table + static_cast<size_t>(index) * ElementSize, ElementSize);
+	}
+}
+
+template <uint32_t ElementSize>
+void DecodePalette(const std::byte* body, std::byte* destination, size_t count)
+{
+	uint16_t entryCount;
+	std::memcpy(&entryCount, body, 2);
+	const uint32_t bits = static_cast<uint32_t>(body[2]);
+	const std::byte* entries = body + 4;
+	const uint8_t* indices = reinterpret_cast<const uint8_t*>(entries + static_cast<size_t>(entryCount) * ElementSize);
+
+	// Pad to every index the bit width can express, so no index needs a
+	// bounds check
+	std::byte table[TILE_CODEC_MAX_PALETTE * ElementSize] = {};
+	std::memcpy(table, entries, static_cast<size_t>(entryCount) * ElementSize);
+
+	switch (bits)
+	{
+	case 1: DecodePaletteIndices<ElementSize, 1>(indices, table, destination, count); break;
+	case 2: DecodePaletteIndices<ElementSize, 2>(indices, table, destination, count); break;
+	case 4: DecodePaletteIndices<ElementSize, 4>(indices, table, destination, count); break;
+	default: DecodePaletteIndices<ElementSize, 8>(indices, table, destination, count); break;
+	}
+}
+
+template <uint32_t ElementSize>
+void DecodeTileTyped(const EncodedTileView& view, std::byte* destination, size_t tileBytes)
+{
+	switch (view.encoding)
+	{
+	case TileEncoding::Raw:
+		std::memcpy(destination, view.body, tileBytes);
+		break;
+	case TileEncoding::Uniform:
+		FillElements(destination, view.body, ElementSize, tileBytes / ElementSize);
+		break;
+	case TileEncoding::RunLength:
+		DecodeRunLength<ElementSize>(view.body, view.bodySize, destination);
+		break;
+	case TileEncoding::Palette:
+		DecodePalette<ElementSize>(view.body, destination, tileBytes / ElementSize);
+		break;
+	}
+}
+
+// ---- Encode ----
+
+// Open-addressed map from element bytes to palette slot; 4x the palette
+// limit keeps probe chains short
+class PaletteBuilder {
+public:
+	explicit PaletteBuilder(uint32_t elementSize) : m_elementSize(elementSize)
+	{
+		std::fill(std::begin(m_slots), std::end(m_slots), EMPTY);
+	}
+
+	// Returns the palette index, or -1 once the palette is full
+	int Find(const std::byte* element)
+	{
+		uint32_t hash = 2166136261u;
+		for (uint32_t i = 0; i < m_elementSize; ++i) {
+			hash = (hash ^ static_cast<uint32_t>(element[i])) * 16777619u;
+		}
+
+		for (uint32_t slot = hash & SLOT_MASK;; slot = (slot + 1) & SLOT_MASK) {
+			const uint16_t entry = m_slots[slot];
+			if (entry == EMPTY) {
+				if (m_entries.size() >= static_cast<size_t>(TILE_CODEC_MAX_PALETTE) * m_elementSize) {
+					return -1;
+				}
+				const int index = static_cast<int>(m_entries.size() / m_elementSize);
+				m_entries.insert(m_entries.end(), element, element + m_elementSize);
+				m_slots[slot] = static_cast<uint16_t>(index);
+				return index;
+			}
+			if (std::memcmp(m_entries.data() + static_cast<size_t>(entry) * m_elementSize, element, m_elementSize) == 0) {
+				return entry;
+			}
+		}
+	}
+
+	size_t EntryCount() const { return m_entries.size() / m_elementSize; }
+	const std::vector<std::byte>& Entries() const { return m_entries; }
+
+private:
+	static constexpr uint32_t SLOT_COUNT = TILE_CODEC_MAX_PALETTE * 4;
+	static constexpr uint32_t SLOT_MASK = SLOT_COUNT - 1;
+	static constexpr uint16_t EMPTY = 0xFFFF;
+
+	uint32_t m_elementSize;
+	uint16_t m_slots[SLOT_COUNT];
+	std::vector<std::byte> m_entries;
+};
+
+void AppendHeader(std::vector<std::byte>& out, TileEncoding encoding, uint32_t elementSize, size_t bodySize)
+{
+	EncodedTileHeader header = {};
+	header.encoding = static_cast<uint8_t>(encoding);
+	header.elementSize = static_cast<uint8_t>(elementSize);
+	header.bodySize = static_cast<uint32_t>(bodySize);
+
+	const size_t start = out.size();
+	out.resize(start + sizeof(header));
+	std::memcpy(out.data() + start, &header, sizeof(header));
+}
+
+} // namespace
+
+void EncodeTile(const std::byte* tile, size_t tileBytes, uint32_t elementSize, std::vector<std::byte>& out)
+{
+	const size_t count = tileBytes / elementSize;
+
+	// One pass gathers both the run structure and the palette
+	PaletteBuilder palette(elementSize);
+	std::vector<uint8_t> indices(count);
+	bool paletteFits = true;
+	size_t runCount = 0;
+	size_t runBytes = 0;
+	size_t runLength = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		const std::byte* element = tile + i * elementSize;
+		if (i > 0 && std::memcmp(element, element - elementSize, elementSize) == 0) {
+			++runLength;
+		}
+		else {
+			if (runLength > 0) {
+				runBytes += VarintSize(runLength) + elementSize;
+			}
+			++runCount;
+			runLength = 1;
+		}
+
+		if (paletteFits) {
+			const int index = palette.Find(element);
+			paletteFits = index >= 0;
+			indices[i] = static_cast<uint8_t>(index);
+		}
+	}
+	runBytes += VarintSize(runLength) + elementSize;
+
+	if (runCount == 1) {
+		AppendHeader(out, TileEncoding::Uniform, elementSize, elementSize);
+		out.insert(out.end(), tile, tile + elementSize);
+		return;
+	}
+
+	const size_t paletteBytes = paletteFits
+		? PaletteBodySize(palette.EntryCount(), elementSize, count)
+		: SIZE_MAX;
+
+	if (runBytes <= paletteBytes && runBytes < tileBytes) {
+		AppendHeader(out, TileEncoding::RunLength, elementSize, runBytes);
+		out.reserve(out.size() + runBytes);
+		for (size_t i = 0; i < count;) {
+			size_t end = i + 1;
+			while (end < count && std::memcmp(tile + end * elementSize, tile + i * elementSize, elementSize) == 0) {
+				++end;
+			}
+			AppendVarint(out, end - i);
+			out.insert(out.end(), tile + i * elementSize, tile + (i + 1) * elementSize);
+			i = end;
+		}
+		return;
+	}
+
+	if (paletteBytes < tileBytes) {
+		const uint32_t bits = BitsForPalette(palette.EntryCount());
+		const uint16_t entryCount = static_cast<uint16_t>(palette.EntryCount());
+		AppendHeader(out, TileEncoding::Palette, elementSize, paletteBytes);
+
+		const size_t bodyStart = out.size();
+		out.resize(bodyStart + paletteBytes);
+		std::byte* body = out.data() + bodyStart;
+		std::memcpy(body, &entryCount, 2);
+		body[2] = static_cast<std::byte>(bits);
+		body[3] = std::byte{ 0 };
+		std::memcpy(body + 4, palette.Entries().data(), palette.Entries().size());
+
+		uint8_t* packed = reinterpret_cast<uint8_t*>(body + 4 + palette.Entries().size());
+		const uint32_t perByte = 8 / bits;
+		for (size_t i = 0; i < count; ++i) {
+			packed[i / perByte] |= static_cast<uint8_t>(indices[i] << ((i % perByte) * bits));
+		}
+		return;
+	}
+
+	AppendHeader(out, TileEncoding::Raw, elementSize, tileBytes);
+	out.insert(out.end(), tile, tile + tileBytes);
+}
+
+bool ReadEncodedTile(
+	const std::byte* payload,
+	size_t payloadSize,
+	size_t* offset,
+	uint32_t elementSize,
+	EncodedTileView* outView)
+{
+	if (*offset > payloadSize || payloadSize - *offset < sizeof(EncodedTileHeader)) {
+		return false;
+	}
+
+	EncodedTileHeader header;
+	std::memcpy(&header, payload + *offset, sizeof(header));
+	const size_t bodyStart = *offset + sizeof(header);
+
+	if (header.encoding > static_cast<uint8_t>(TileEncoding::Palette) ||
+		header.elementSize != elementSize ||
+		header.reserved != 0 ||
+		header.bodySize > payloadSize - bodyStart) {
+		return false;
+	}
+
+	outView->encoding = static_cast<TileEncoding>(header.encoding);
+	outView->body = payload + bodyStart;
+	outView->bodySize = header.bodySize;
+	*offset = bodyStart + header.bodySize;
+	return true;
+}
+
+bool ValidateEncodedTile(const EncodedTileView& view, uint32_t elementSize, size_t tileBytes)
+{
+	const size_t count = tileBytes / elementSize;
+
+	switch (view.encoding)
+	{
+	case TileEncoding::Raw:
+		return view.bodySize == tileBytes;
+
+	case TileEncoding::Uniform:
+		return view.bodySize == elementSize;
+
+	case TileEncoding::RunLength: {
+		size_t position = 0;
+		size_t covered = 0;
+		while (position < view.bodySize) {
+			uint32_t length = 0;
+			if (!ReadVarint(view.body, view.bodySize, &position, &length) ||
+				length == 0 ||
+				view.bodySize - position < elementSize ||
+				length > count - covered) {
+				return false;
+			}
+			position += elementSize;
+			covered += length;
+		}
+		return covered == count;
+	}
+
+	case TileEncoding::Palette: {
+		if (view.bodySize < 4) {
+			return false;
+		}
+		uint16_t entryCount;
+		std::memcpy(&entryCount, view.body, 2);
+		const uint32_t bits = static_cast<uint32_t>(view.body[2]);
+		if (entryCount == 0 || entryCount > TILE_CODEC_MAX_PALETTE ||
+			(bits != 1 && bits != 2 && bits != 4 && bits != 8) ||
+			entryCount > (1u << bits)) {
+			return false;
+		}
+		const size_t expected = 4 + static_cast<size_t>(entryCount) * elementSize + (count * bits + 7) / 8;
+		return view.bodySize == expected;
+	}
+	}
+
+	return false;
+}
+
+void DecodeTile(const EncodedTileView& view, uint32_t elementSize, std::byte* destination, size_t tileBytes)
+{
+	switch (elementSize)
+	{
+	case 1:  DecodeTileTyped<1>(view, destination, tileBytes); break;
+	case 2:  DecodeTileTyped<2>(view, destination, tileBytes); break;
+	case 4:  DecodeTileTyped<4>(view, destination, tileBytes); break;
+	case 8:  DecodeTileTyped<8>(view, destination, tileBytes); break;
+	case 16: DecodeTileTyped<16>(view, destination, tileBytes); break;
+	default: break;
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compact wire format for tile payloads. A payload is one encoded tile per
+// tile, back to back, each an 8-byte header followed by its body. An element
+// is one texel, or one 4x4 block for BC formats; a tile is always 64KB of
+// elements once decoded. All fields are little-endian.
+//
+//   Raw        body = the tile verbatim
+//   Uniform    body = one element repeated over the tile
+//   RunLength  body = runs of [LEB128 length][element] in linear tile order
+//   Palette    body = [uint16 entryCount][uint8 bitsPerIndex][uint8 0]
+//                     [entryCount elements][indices, LSB-first bit-packed]
+enum class TileEncoding : uint8_t {
+	Raw = 0,
+	Uniform = 1,
+	RunLength = 2,
+	Palette = 3
+};
+
+struct EncodedTileHeader {
+	uint8_t encoding;      // TileEncoding
+	uint8_t elementSize;   // Must match the resource
+	uint16_t reserved;     // 0
+	uint32_t bodySize;
+};
+static_assert(sizeof(EncodedTileHeader) == 8, "wire header is 8 bytes");
+
+constexpr uint32_t TILE_CODEC_MAX_PALETTE = 256;
+
+struct EncodedTileView {
+	TileEncoding encoding;
+	const std::byte* body;
+	uint32_t bodySize;
+};
+
+// Appends the smallest encoding of one tile to out
+void EncodeTile(const std::byte* tile, size_t tileBytes, uint32_t elementSize, std::vector<std::byte>& out);
+
+// Reads the tile at *offset and advances past it. Returns false if the
+// header is unknown, names a different element size, or runs past size.
+bool ReadEncodedTile(
+	const std::byte* payload,
+	size_t payloadSize,
+	size_t* offset,
+	uint32_t elementSize,
+	EncodedTileView* outView);
+
+// Checks that a body decodes to exactly tileBytes, without writing anything.
+// DecodeTile trusts views that passed this.
+bool ValidateEncodedTile(const EncodedTileView& view, uint32_t elementSize, size_t tileBytes);
+
+void DecodeTile(const EncodedTileView& view, uint32_t elementSize, std::byte* destination, size_t tileBytes);
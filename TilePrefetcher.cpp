@@ -0,0 +1,184 @@
+#include "pch.h"
+#include "TilePrefetcher.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+TilePrefetcher::TilePrefetcher(const ResourceTilingInfo& tilingInfo, const PrefetchSettings& settings, const TilePrefetchSource& source)
+	: m_tilingInfo(tilingInfo),
+	m_settings(settings),
+	m_source(source)
+{
+}
+
+void TilePrefetcher::Predict(
+	const PrefetchCamera& camera,
+	const TileResidencyQuery& isResident,
+	std::vector<PrefetchRequest>& outQueue)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	outQueue.clear();
+
+	const uint32_t frames = m_settings.lookaheadFrames;
+	const float* position = camera.position;
+	float step[3];
+	for (int a = 0; a < 3; ++a) {
+		step[a] = camera.velocity[a] * camera.deltaTime;
+	}
+
+	float view[3] = { camera.viewDirection[0], camera.viewDirection[1], camera.viewDirection[2] };
+	const float viewLength = std::sqrt(view[0] * view[0] + view[1] * view[1] + view[2] * view[2]);
+	const bool useView = viewLength > 1e-6f && m_settings.viewWeight > 0.0f;
+	if (useView) {
+		for (float& v : view) {
+			v /= viewLength;
+		}
+	}
+	const float viewPenaltyScale = m_settings.viewWeight * static_cast<float>((std::max)(frames, 1u));
+
+	const uint32_t mipCount = (std::min)(
+		static_cast<uint32_t>(m_settings.mipRadii.size()),
+		m_tilingInfo.NumStandardMips);
+
+	for (uint32_t mip = 0; mip < mipCount; ++mip) {
+		const float radius = m_settings.mipRadii[mip];
+		if (!(radius > 0.0f)) {
+			continue;
+		}
+
+		const SubresourceTilingInfo& tiling = m_tilingInfo.subresourceTilingInfo[mip];
+		const uint32_t tileCounts[3] = { tiling.WidthInTiles, tiling.HeightInTiles, tiling.DepthInTiles };
+		const float scale = static_cast<float>(1u << mip);
+		const float extent[3] = {
+			m_tilingInfo.TileWidthInTexels * scale,
+			m_tilingInfo.TileHeightInTexels * scale,
+			m_tilingInfo.TileDepthInTexels * scale
+		};
+
+		// Tiles touched by the sphere swept along the predicted path
+		uint32_t first[3], last[3];
+		bool outside = false;
+		for (int a = 0; a < 3; ++a) {
+			const float end = position[a] + step[a] * frames;
+			const double lo = std::floor(((std::min)(position[a], end) - radius) / extent[a]);
+			const double hi = std::floor(((std::max)(position[a], end) + radius) / extent[a]);
+			if (hi < 0.0 || lo >= tileCounts[a]) {
+				outside = true;
+				break;
+			}
+			first[a] = static_cast<uint32_t>((std::max)(lo, 0.0));
+			last[a] = static_cast<uint32_t>((std::min)(hi, static_cast<double>(tileCounts[a] - 1)));
+		}
+		if (outside) {
+			continue;
+		}
+
+		const float halfDiagonal = 0.5f * std::sqrt(
+			extent[0] * extent[0] + extent[1] * extent[1] + extent[2] * extent[2]);
+		const double reach = radius + halfDiagonal;
+		const double stepLengthSq = static_cast<double>(step[0]) * step[0]
+			+ static_cast<double>(step[1]) * step[1]
+			+ static_cast<double>(step[2]) * step[2];
+
+		for (uint32_t z = first[2]; z <= last[2]; ++z) {
+			for (uint32_t y = first[1]; y <= last[1]; ++y) {
+				for (uint32_t x = first[0]; x <= last[0]; ++x) {
+					const float boxMin[3] = { x * extent[0], y * extent[1], z * extent[2] };
+					float center[3];
+					double offset[3];
+					for (int a = 0; a < 3; ++a) {
+						center[a] = boxMin[a] + 0.5f * extent[a];
+						offset[a] = static_cast<double>(position[a]) - center[a];
+					}
+
+					// Frames in which the tile's bounding sphere is within
+					// reach: |offset + k * step| <= reach, a quadratic in k
+					const double b = 2.0 * (offset[0] * step[0] + offset[1] * step[1] + offset[2] * step[2]);
+					const double c = offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2] - reach * reach;
+					uint32_t kFirst = 0, kLast = frames;
+					if (stepLengthSq < 1e-12) {
+						if (c > 0.0) {
+							continue;
+						}
+					}
+					else {
+						const double discriminant = b * b - 4.0 * stepLengthSq * c;
+						if (discriminant < 0.0) {
+							continue;
+						}
+						const double root = std::sqrt(discriminant);
+						const double enter = std::ceil((-b - root) / (2.0 * stepLengthSq));
+						const double exit = std::floor((-b + root) / (2.0 * stepLengthSq));
+						if (exit < 0.0 || enter > frames || enter > exit) {
+							continue;
+						}
+						kFirst = static_cast<uint32_t>((std::max)(enter, 0.0));
+						kLast = static_cast<uint32_t>((std::min)(exit, static_cast<double>(frames)));
+					}
+
+					// First predicted frame whose position is within radius
+					// of the tile's actual bounds
+					int64_t arrival = -1;
+					for (uint32_t k = kFirst; k <= kLast; ++k) {
+						float distanceSq = 0.0f;
+						for (int a = 0; a < 3; ++a) {
+							const float p = position[a] + step[a] * k;
+							const float d = (std::max)({ boxMin[a] - p, 0.0f, p - (boxMin[a] + extent[a]) });
+							distanceSq += d * d;
+						}
+						if (distanceSq <= radius * radius) {
+							arrival = k;
+							break;
+						}
+					}
+					if (arrival < 0) {
+						continue;
+					}
+
+					if (m_unavailable.count(GetTileKey(mip, x, y, z)) != 0 || isResident(mip, x, y, z)) {
+						continue;
+					}
+
+					float score = static_cast<float>(arrival);
+					if (useView) {
+						const float distance = static_cast<float>(std::sqrt(
+							offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]));
+						if (distance > 1e-6f) {
+							const float cosine = -static_cast<float>(
+								offset[0] * view[0] + offset[1] * view[1] + offset[2] * view[2]) / distance;
+							score += viewPenaltyScale * 0.5f * (1.0f - cosine);
+						}
+					}
+
+					outQueue.push_back({ mip, x, y, z, score });
+				}
+			}
+		}
+	}
+
+	std::sort(outQueue.begin(), outQueue.end(), [](const PrefetchRequest& a, const PrefetchRequest& b) {
+		if (a.score != b.score) return a.score < b.score;
+		if (a.subresource != b.subresource) return a.subresource > b.subresource;
+		if (a.z != b.z) return a.z < b.z;
+		if (a.y != b.y) return a.y < b.y;
+		return a.x < b.x;
+	});
+}
+
+void TilePrefetcher::MarkUnavailable(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_unavailable.insert(GetTileKey(subresource, x, y, z));
+}
+
+std::unordered_map<uint64_t, StreamingRequestId> TilePrefetcher::TakeQueuedRequests()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return std::exchange(m_queued, {});
+}
+
+void TilePrefetcher::SetQueuedRequest(const PrefetchRequest& request, StreamingRequestId id)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_queued[GetTileKey(request.subresource, request.x, request.y, request.z)] = id;
+}
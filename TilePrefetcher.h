@@ -0,0 +1,113 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "StreamingScheduler.h"
+#include "TilingInfo.h"
+
+class TileArchive;
+
+// Fills one 64KB linear tile for the prefetcher. Returns false if the source
+// has no data for the tile; the prefetcher then stops asking for it.
+using TileSourceCallback = bool (*)(
+	void* userData,
+	uint32_t subresource,
+	uint32_t x, uint32_t y, uint32_t z,
+	void* destination,
+	uint32_t destinationSize);
+
+// Where prefetched tiles come from: an archive, or a callback. The archive
+// stays mapped while the prefetcher or any of its queued work holds it, even
+// after CloseTileArchive.
+struct TilePrefetchSource {
+	std::shared_ptr<TileArchive> archive;
+	TileSourceCallback callback = nullptr;
+	void* userData = nullptr;
+};
+
+// Camera state for one frame, in the volume's mip 0 texel space
+struct PrefetchCamera {
+	float position[3];
+	float velocity[3];        // Texels per second
+	float viewDirection[3];   // Need not be normalized; zero disables view weighting
+	float deltaTime;          // Seconds per frame
+};
+
+struct PrefetchSettings {
+	// Frames of camera motion to extrapolate
+	uint32_t lookaheadFrames = 30;
+
+	// Per mip, in mip 0 texels: a tile is wanted once a predicted camera
+	// position comes this close to its bounds. Mips without a positive
+	// radius are not prefetched.
+	std::vector<float> mipRadii;
+
+	// How far a tile straight behind the camera is pushed back, as a
+	// fraction of the lookahead
+	float viewWeight = 0.5f;
+
+	// Tiles kept queued per UpdateTilePrefetch
+	uint32_t maxTilesPerFrame = 8;
+
+	// Prefetches are scheduled at this priority plus their score, so they
+	// queue behind demand uploads scheduled at lower values and only move
+	// up by aging
+	float basePriority = 1000.0f;
+};
+
+struct PrefetchRequest {
+	uint32_t subresource;
+	uint32_t x, y, z;
+
+	// Frames until the camera is predicted to need the tile, plus the view
+	// penalty. Lower is more urgent.
+	float score;
+};
+
+using TileResidencyQuery = std::function<bool(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z)>;
+
+// Predicts which tiles the camera will reach over the next few frames by
+// extrapolating its velocity. Holds no GPU state, so recorded camera paths
+// can be replayed against it anywhere.
+class TilePrefetcher {
+public:
+	TilePrefetcher(const ResourceTilingInfo& tilingInfo, const PrefetchSettings& settings, const TilePrefetchSource& source);
+
+	// Replaces outQueue with every predicted tile that is neither resident
+	// nor known to be missing from the source, most urgent first. Ties go to
+	// coarser mips, which cover more of the volume per tile.
+	void Predict(
+		const PrefetchCamera& camera,
+		const TileResidencyQuery& isResident,
+		std::vector<PrefetchRequest>& outQueue
+	);
+
+	// Records that the source cannot provide a tile so it is not requested again
+	void MarkUnavailable(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z);
+
+	// The streaming request queued for each tile last frame, keyed by
+	// GetTileKey. Taking them lets the caller reprioritize tiles that are
+	// still wanted and cancel the rest.
+	std::unordered_map<uint64_t, StreamingRequestId> TakeQueuedRequests();
+	void SetQueuedRequest(const PrefetchRequest& request, StreamingRequestId id);
+
+	static uint64_t GetTileKey(uint32_t subresource, uint32_t x, uint32_t y, uint32_t z) {
+		return ((uint64_t)subresource << 48) | ((uint64_t)x << 32) | ((uint64_t)y << 16) | z;
+	}
+
+	const PrefetchSettings& Settings() const { return m_settings; }
+	const TilePrefetchSource& Source() const { return m_source; }
+
+private:
+	ResourceTilingInfo m_tilingInfo;
+	PrefetchSettings m_settings;
+	TilePrefetchSource m_source;
+
+	std::unordered_set<uint64_t> m_unavailable;
+	std::unordered_map<uint64_t, StreamingRequestId> m_queued;
+	std::mutex m_mutex;
+};
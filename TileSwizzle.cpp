@@ -0,0 +1,234 @@
+#include "pch.h"
+
+#include "TileSwizzle.h"
+#include "CpuFeatures.h"
+#include <bit>
+#include <cstring>
+
+namespace {
+
+// Scatters the low bits of value into the set bits of mask (software pdep)
+uint32_t DepositBits(uint32_t value, uint32_t mask)
+{
+	uint32_t result = 0;
+	for (uint32_t bit = 1; mask != 0; bit <<= 1) {
+		const uint32_t lowest = mask & (0u - mask);
+		if (value & bit) {
+			result |= lowest;
+		}
+		mask &= mask - 1;
+	}
+	return result;
+}
+
+// Advances a deposited coordinate by one without re-depositing it
+inline uint32_t MaskedIncrement(uint32_t offset, uint32_t mask)
+{
+	return ((offset | ~mask) + 1) & mask;
+}
+
+#if defined(SPARSE_X86)
+// Runs of 32 bytes or more, a 256-bit move at a time; returns bytes copied
+SPARSE_TARGET("avx2")
+uint32_t CopyRunAVX2(std::byte* destination, const std::byte* source, uint32_t runBytes)
+{
+	uint32_t i = 0;
+	for (; i + 32 <= runBytes; i += 32) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i),
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i)));
+	}
+	return i;
+}
+#endif
+
+// Copies one run of texels that are contiguous in both layouts. wideRuns is
+// set once per tile when AVX2 is available and runs are at least 32 bytes.
+inline void CopyRun(std::byte* destination, const std::byte* source, uint32_t runBytes, [[maybe_unused]] bool wideRuns)
+{
+	// Short runs: constant-size copies compile to a single move
+	switch (runBytes)
+	{
+	case 1: std::memcpy(destination, source, 1); return;
+	case 2: std::memcpy(destination, source, 2); return;
+	case 4: std::memcpy(destination, source, 4); return;
+	case 8: std::memcpy(destination, source, 8); return;
+	default: break;
+	}
+
+	uint32_t i = 0;
+#if defined(SPARSE_X86)
+	if (wideRuns) {
+		i = CopyRunAVX2(destination, source, runBytes);
+	}
+	for (; i + 16 <= runBytes; i += 16) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+	}
+#elif defined(SPARSE_NEON)
+	for (; i + 16 <= runBytes; i += 16) {
+		vst1q_u8(reinterpret_cast<uint8_t*>(destination + i),
+			vld1q_u8(reinterpret_cast<const uint8_t*>(source + i)));
+	}
+#endif
+	if (i < runBytes) {
+		std::memcpy(destination + i, source + i, runBytes - i);
+	}
+}
+
+// Walks the tile in linear order one run at a time. A run is the stretch of
+// texels whose x bits occupy the lowest swizzle bits, so they are contiguous
+// in both layouts; every other step is a masked increment.
+template <uint32_t BytesPerTexel, bool ToSwizzled>
+void ConvertTile(const std::byte* source, std::byte* destination, const SwizzlePattern& pattern)
+{
+	const uint32_t runTexels = 1u << std::countr_one(pattern.xMask);
+	const uint32_t runBytes = runTexels * BytesPerTexel;
+	const uint32_t xStepMask = pattern.xMask & ~(runTexels - 1);
+	const uint32_t rowBytes = pattern.width * BytesPerTexel;
+	static const bool hasAVX2 = CpuFeatures::HasAVX2();
+	const bool wideRuns = hasAVX2 && runBytes >= 32;
+
+	uint32_t zOffset = 0;
+	for (uint32_t z = 0; z < pattern.depth; ++z) {
+		uint32_t yOffset = 0;
+		for (uint32_t y = 0; y < pattern.height; ++y) {
+			const size_t linearRowOffset = (static_cast<size_t>(z) * pattern.height + y) * rowBytes;
+			const uint32_t rowBase = zOffset | yOffset;
+
+			uint32_t xOffset = 0;
+			for (uint32_t x = 0; x < pattern.width; x += runTexels) {
+				const size_t swizzledOffset = static_cast<size_t>(rowBase | xOffset) * BytesPerTexel;
+				const size_t linearOffset = linearRowOffset + static_cast<size_t>(x) * BytesPerTexel;
+				if constexpr (ToSwizzled) {
+					CopyRun(destination + swizzledOffset, source + linearOffset, runBytes, wideRuns);
+				}
+				else {
+					CopyRun(destination + linearOffset, source + swizzledOffset, runBytes, wideRuns);
+				}
+				xOffset = MaskedIncrement(xOffset, xStepMask);
+			}
+			yOffset = MaskedIncrement(yOffset, pattern.yMask);
+		}
+		zOffset = MaskedIncrement(zOffset, pattern.zMask);
+	}
+}
+
+template <bool ToSwizzled>
+void ConvertTileReference(const std::byte* source, std::byte* destination, const SwizzlePattern& pattern)
+{
+	const uint32_t bpp = pattern.bytesPerTexel;
+	for (uint32_t z = 0; z < pattern.depth; ++z) {
+		for (uint32_t y = 0; y < pattern.height; ++y) {
+			for (uint32_t x = 0; x < pattern.width; ++x) {
+				const size_t linearIndex = (static_cast<size_t>(z) * pattern.height + y) * pattern.width + x;
+				const size_t swizzledIndex =
+					DepositBits(x, pattern.xMask) | DepositBits(y, pattern.yMask) | DepositBits(z, pattern.zMask);
+				if constexpr (ToSwizzled) {
+					std::memcpy(destination + swizzledIndex * bpp, source + linearIndex * bpp, bpp);
+				}
+				else {
+					std::memcpy(destination + linearIndex * bpp, source + swizzledIndex * bpp, bpp);
+				}
+			}
+		}
+	}
+}
+
+template <bool ToSwizzled>
+void ConvertTileDispatch(const std::byte* source, std::byte* destination, const SwizzlePattern& pattern)
+{
+	switch (pattern.bytesPerTexel)
+	{
+	case 1:  ConvertTile<1, ToSwizzled>(source, destination, pattern); break;
+	case 2:  ConvertTile<2, ToSwizzled>(source, destination, pattern); break;
+	case 4:  ConvertTile<4, ToSwizzled>(source, destination, pattern); break;
+	case 8:  ConvertTile<8, ToSwizzled>(source, destination, pattern); break;
+	case 16: ConvertTile<16, ToSwizzled>(source, destination, pattern); break;
+	default: ConvertTileReference<ToSwizzled>(source, destination, pattern); break;
+	}
+}
+
+} // namespace
+
+bool BuildSwizzlePattern(
+	const uint32_t* linearIndexAtBit,
+	uint32_t bytesPerTexel,
+	uint32_t width, uint32_t height, uint32_t depth,
+	SwizzlePattern* outPattern)
+{
+	if (!std::has_single_bit(width) || !std::has_single_bit(height) || !std::has_single_bit(depth)) {
+		return false;
+	}
+
+	const uint32_t xBits = std::countr_zero(width);
+	const uint32_t yBits = std::countr_zero(height);
+	const uint32_t zBits = std::countr_zero(depth);
+	const uint32_t addressBits = xBits + yBits + zBits;
+
+	SwizzlePattern pattern = { bytesPerTexel, width, height, depth, 0, 0, 0 };
+
+	// Coordinate bits must appear in increasing order for deposit to apply
+	uint32_t nextX = 0, nextY = 0, nextZ = 0;
+	for (uint32_t k = 0; k < addressBits; ++k) {
+		const uint32_t linear = linearIndexAtBit[k];
+		if (!std::has_single_bit(linear)) {
+			return false;
+		}
+
+		const uint32_t linearBit = std::countr_zero(linear);
+		if (linearBit < xBits) {
+			if (linearBit != nextX++) return false;
+			pattern.xMask |= 1u << k;
+		}
+		else if (linearBit < xBits + yBits) {
+			if (linearBit - xBits != nextY++) return false;
+			pattern.yMask |= 1u << k;
+		}
+		else if (linearBit < addressBits) {
+			if (linearBit - xBits - yBits != nextZ++) return false;
+			pattern.zMask |= 1u << k;
+		}
+		else {
+			return false;
+		}
+	}
+
+	*outPattern = pattern;
+	return true;
+}
+
+SwizzlePattern MakeMortonSwizzlePattern(uint32_t bytesPerTexel, uint32_t width, uint32_t height, uint32_t depth)
+{
+	SwizzlePattern pattern = { bytesPerTexel, width, height, depth, 0, 0, 0 };
+
+	uint32_t xLeft = std::countr_zero(width);
+	uint32_t yLeft = std::countr_zero(height);
+	uint32_t zLeft = std::countr_zero(depth);
+	uint32_t bit = 0;
+	while (xLeft + yLeft + zLeft > 0) {
+		if (xLeft) { pattern.xMask |= 1u << bit++; --xLeft; }
+		if (yLeft) { pattern.yMask |= 1u << bit++; --yLeft; }
+		if (zLeft) { pattern.zMask |= 1u << bit++; --zLeft; }
+	}
+	return pattern;
+}
+
+void SwizzleTile(const std::byte* linear, std::byte* swizzled, const SwizzlePattern& pattern)
+{
+	ConvertTileDispatch<true>(linear, swizzled, pattern);
+}
+
+void UnswizzleTile(const std::byte* swizzled, std::byte* linear, const SwizzlePattern& pattern)
+{
+	ConvertTileDispatch<false>(swizzled, linear, pattern);
+}
+
+void SwizzleTileReference(const std::byte* linear, std::byte* swizzled, const SwizzlePattern& pattern)
+{
+	ConvertTileReference<true>(linear, swizzled, pattern);
+}
+
+void UnswizzleTileReference(const std::byte* swizzled, std::byte* linear, const SwizzlePattern& pattern)
+{
+	ConvertTileReference<false>(swizzled, linear, pattern);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Bit-interleave layout of one 64KB standard-swizzle tile. A texel's index
+// within the swizzled tile is its x, y and z coordinates deposited into the
+// bits of xMask, yMask and zMask (byte offset = index * bytesPerTexel).
+struct SwizzlePattern {
+	uint32_t bytesPerTexel;
+	uint32_t width, height, depth;   // Tile shape in texels
+	uint32_t xMask, yMask, zMask;
+};
+
+// Builds a pattern from the linear index found at each power-of-two texel
+// index of a swizzled tile: linearIndexAtBit[k] is the linear index
+// (x + width * (y + height * z)) of the texel stored at swizzled index 1 << k.
+// Fails if the layout is not a bit interleave of x, y and z.
+bool BuildSwizzlePattern(
+	const uint32_t* linearIndexAtBit,
+	uint32_t bytesPerTexel,
+	uint32_t width, uint32_t height, uint32_t depth,
+	SwizzlePattern* outPattern);
+
+// Interleaves x, y, z bits round-robin from bit 0. Not the D3D pattern; used
+// to exercise the kernels without a device.
+SwizzlePattern MakeMortonSwizzlePattern(uint32_t bytesPerTexel, uint32_t width, uint32_t height, uint32_t depth);
+
+// Converts one tile between linear (x fastest, then y, then z) and swizzled
+// order. Safe to call from any thread; source and destination must not overlap.
+void SwizzleTile(const std::byte* linear, std::byte* swizzled, const SwizzlePattern& pattern);
+void UnswizzleTile(const std::byte* swizzled, std::byte* linear, const SwizzlePattern& pattern);
+
+// Texel-at-a-time versions used to check the fast kernels
+void SwizzleTileReference(const std::byte* linear, std::byte* swizzled, const SwizzlePattern& pattern);
+void UnswizzleTileReference(const std::byte* swizzled, std::byte* linear, const SwizzlePattern& pattern);
@@ -17,7 +17,17 @@ public:
 	unsigned int TileDepthInTexels;
 	unsigned int SubresourceCount;
 	unsigned int NumPackedMips;
+
+	// Mips [NumStandardMips, SubresourceCount) share one packed tail that is
+	// mapped and uploaded as a unit rather than addressed by tile coordinate
+	unsigned int NumStandardMips;
+	unsigned int NumTilesForPackedMips;
+	unsigned int PackedMipStartTileIndex;
 	std::vector<SubresourceTilingInfo> subresourceTilingInfo;
+
+	bool IsPackedMip(unsigned int subresource) const {
+		return NumPackedMips > 0 && subresource >= NumStandardMips;
+	}
 };
 
 
@@ -28,4 +38,11 @@ struct C_ResourceTilingInfo {
 	unsigned int SubresourceCount;
 	unsigned int NumPackedMips;
 	SubresourceTilingInfo* pSubresourceTilingInfo;
+};
+
+struct C_PackedMipInfo {
+	unsigned int NumStandardMips;
+	unsigned int NumPackedMips;
+	unsigned int NumTilesForPackedMips;
+	unsigned int StartTileIndexInOverallResource;
 };
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include "pch.h"
+#include "UsageFeedback.h"
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+UsageFeedback::UsageFeedback(const ResourceTilingInfo& tilingInfo)
+{
+	const uint32_t mipCount = tilingInfo.NumPackedMips > 0 ? tilingInfo.NumStandardMips : tilingInfo.SubresourceCount;
+	m_mips.resize(mipCount);
+
+	for (uint32_t m = 0; m < mipCount; ++m) {
+		const SubresourceTilingInfo& sub = tilingInfo.subresourceTilingInfo[m];
+		MipState& mip = m_mips[m];
+		mip.tileCounts[0] = sub.WidthInTiles;
+		mip.tileCounts[1] = sub.HeightInTiles;
+		mip.tileCounts[2] = sub.DepthInTiles;
+		mip.tileCount = static_cast<size_t>(sub.WidthInTiles) * sub.HeightInTiles * sub.DepthInTiles;
+		mip.firstWord = m_bitmaskWords;
+		m_bitmaskWords += (mip.tileCount + 31) / 32;
+		mip.lastUsed.assign(mip.tileCount, NEVER);
+		mip.mapped.assign((mip.tileCount + 63) / 64, 0);
+	}
+}
+
+size_t UsageFeedback::GetBufferSize(FeedbackFormat format) const
+{
+	switch (format) {
+	case FeedbackFormat::TileBitmask:
+		return m_bitmaskWords * sizeof(uint32_t);
+	case FeedbackFormat::MinMipGrid:
+		return m_mips.empty() ? 0 : m_mips[0].tileCount;
+	}
+	return 0;
+}
+
+bool UsageFeedback::Process(
+	FeedbackFormat format,
+	const void* data,
+	size_t size,
+	const std::vector<FeedbackTile>& mappedTiles,
+	uint32_t idleFrames,
+	std::vector<FeedbackTile>& outUsedMapped,
+	FeedbackWork& outWork)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_mips.empty() || size != GetBufferSize(format)) {
+		return false;
+	}
+
+	++m_frame;
+
+	for (MipState& mip : m_mips) {
+		std::fill(mip.mapped.begin(), mip.mapped.end(), 0ull);
+	}
+	for (const FeedbackTile& tile : mappedTiles) {
+		if (tile.subresource >= m_mips.size()) {
+			continue;
+		}
+		MipState& mip = m_mips[tile.subresource];
+		const size_t index = (static_cast<size_t>(tile.z) * mip.tileCounts[1] + tile.y) * mip.tileCounts[0] + tile.x;
+		mip.mapped[index / 64] |= 1ull << (index % 64);
+	}
+
+	const size_t firstRequest = outWork.requests.size();
+	if (format == FeedbackFormat::TileBitmask) {
+		DecodeBitmask(static_cast<const uint32_t*>(data), outUsedMapped, outWork);
+	}
+	else {
+		DecodeMinMipGrid(static_cast<const uint8_t*>(data), outUsedMapped, outWork);
+	}
+
+	std::stable_sort(outWork.requests.begin() + firstRequest, outWork.requests.end(),
+		[](const FeedbackTile& a, const FeedbackTile& b) {
+			return a.subresource > b.subresource;
+		});
+
+	struct Candidate {
+		FeedbackTile tile;
+		uint32_t idle;
+	};
+	std::vector<Candidate> candidates;
+	for (const FeedbackTile& tile : mappedTiles) {
+		if (tile.subresource >= m_mips.size()) {
+			continue;
+		}
+		MipState& mip = m_mips[tile.subresource];
+		uint32_t& lastUsed = mip.lastUsed[(static_cast<size_t>(tile.z) * mip.tileCounts[1] + tile.y) * mip.tileCounts[0] + tile.x];
+		if (lastUsed == NEVER) {
+			lastUsed = m_frame;
+		}
+		const uint32_t idle = m_frame - lastUsed;
+		if (idle >= idleFrames) {
+			candidates.push_back({ tile, idle });
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+		return a.idle > b.idle;
+	});
+	for (const Candidate& candidate : candidates) {
+		outWork.evictionCandidates.push_back(candidate.tile);
+	}
+	return true;
+}
+
+void UsageFeedback::DecodeBitmask(const uint32_t* words, std::vector<FeedbackTile>& outUsedMapped, FeedbackWork& outWork)
+{
+	for (uint32_t m = 0; m < m_mips.size(); ++m) {
+		const MipState& mip = m_mips[m];
+		const uint32_t* mipWords = words + mip.firstWord;
+		const size_t wordCount = (mip.tileCount + 31) / 32;
+		const size_t tilesPerSlice = static_cast<size_t>(mip.tileCounts[0]) * mip.tileCounts[1];
+
+		// Feedback is mostly zero, so skip it four words (128 tiles) at a time
+		size_t w = 0;
+		for (; w < wordCount; ++w) {
+#if defined(SPARSE_X86)
+			if ((w & 3) == 0) {
+				while (w + 4 <= wordCount) {
+					const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mipWords + w));
+					if (_mm_movemask_epi8(_mm_cmpeq_epi32(v, _mm_setzero_si128())) != 0xFFFF) {
+						break;
+					}
+					w += 4;
+				}
+				if (w >= wordCount) {
+					break;
+				}
+			}
+#elif defined(SPARSE_NEON)
+			if ((w & 3) == 0) {
+				while (w + 4 <= wordCount && vmaxvq_u32(vld1q_u32(mipWords + w)) == 0) {
+					w += 4;
+				}
+				if (w >= wordCount) {
+					break;
+				}
+			}
+#endif
+			uint32_t bits;
+			std::memcpy(&bits, mipWords + w, sizeof(bits));
+			while (bits) {
+				const size_t index = w * 32 + std::countr_zero(bits);
+				bits &= bits - 1;
+				if (index >= mip.tileCount) {
+					// Padding bits of the mip's last word
+					break;
+				}
+				const uint32_t z = static_cast<uint32_t>(index / tilesPerSlice);
+				const size_t inSlice = index % tilesPerSlice;
+				const uint32_t y = static_cast<uint32_t>(inSlice / mip.tileCounts[0]);
+				const uint32_t x = static_cast<uint32_t>(inSlice % mip.tileCounts[0]);
+				MarkUsed(m, x, y, z, index, outUsedMapped, outWork);
+			}
+		}
+	}
+}
+
+void UsageFeedback::DecodeMinMipGrid(const uint8_t* cells, std::vector<FeedbackTile>& outUsedMapped, FeedbackWork& outWork)
+{
+	const MipState& mip0 = m_mips[0];
+	const uint32_t mipCount = static_cast<uint32_t>(m_mips.size());
+	const size_t tilesPerSlice = static_cast<size_t>(mip0.tileCounts[0]) * mip0.tileCounts[1];
+
+	// Unsampled cells (0xFF) are the common case: skip them 64 at a time,
+	// then take a mask of the sampled ones 16 at a time
+	size_t i = 0;
+	while (i < mip0.tileCount) {
+#if defined(SPARSE_X86)
+		const __m128i unsampled = _mm_set1_epi8(-1);
+		while (i + 64 <= mip0.tileCount) {
+			const __m128i* block = reinterpret_cast<const __m128i*>(cells + i);
+			const __m128i all = _mm_and_si128(
+				_mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128(block), unsampled), _mm_cmpeq_epi8(_mm_loadu_si128(block + 1), unsampled)),
+				_mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128(block + 2), unsampled), _mm_cmpeq_epi8(_mm_loadu_si128(block + 3), unsampled)));
+			if (_mm_movemask_epi8(all) != 0xFFFF) {
+				break;
+			}
+			i += 64;
+		}
+		if (i >= mip0.tileCount) {
+			break;
+		}
+#endif
+		uint32_t sampled = cells[i] != 0xFF ? 1u : 0u;
+		size_t chunk = 1;
+#if defined(SPARSE_X86)
+		if (i + 16 <= mip0.tileCount) {
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + i));
+			sampled = ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, unsampled))) & 0xFFFF;
+			chunk = 16;
+		}
+#elif defined(SPARSE_NEON)
+		if (i + 16 <= mip0.tileCount && vminvq_u8(vceqq_u8(vld1q_u8(cells + i), vdupq_n_u8(0xFF))) == 0xFF) {
+			i += 16;
+			continue;
+		}
+#endif
+
+		while (sampled) {
+			const size_t cell = i + std::countr_zero(sampled);
+			sampled &= sampled - 1;
+
+			const uint32_t finest = cells[cell];
+			if (finest >= mipCount) {
+				// Only the packed tail was sampled here
+				continue;
+			}
+
+			const uint32_t cz = static_cast<uint32_t>(cell / tilesPerSlice);
+			const size_t inSlice = cell % tilesPerSlice;
+			const uint32_t cy = static_cast<uint32_t>(inSlice / mip0.tileCounts[0]);
+			const uint32_t cx = static_cast<uint32_t>(inSlice % mip0.tileCounts[0]);
+
+			// Coarser mips are reached through every cell under them, so stop
+			// at the first tile already marked this frame: its parents are too
+			for (uint32_t m = finest; m < mipCount; ++m) {
+				const MipState& mip = m_mips[m];
+				const uint32_t x = (std::min)(cx >> m, mip.tileCounts[0] - 1);
+				const uint32_t y = (std::min)(cy >> m, mip.tileCounts[1] - 1);
+				const uint32_t z = (std::min)(cz >> m, mip.tileCounts[2] - 1);
+				const size_t index = (static_cast<size_t>(z) * mip.tileCounts[1] + y) * mip.tileCounts[0] + x;
+				if (!MarkUsed(m, x, y, z, index, outUsedMapped, outWork)) {
+					break;
+				}
+			}
+		}
+		i += chunk;
+	}
+}
+
+bool UsageFeedback::MarkUsed(uint32_t mip, uint32_t x, uint32_t y, uint32_t z, size_t index,
+	std::vector<FeedbackTile>& outUsedMapped, FeedbackWork& outWork)
+{
+	MipState& state = m_mips[mip];
+	if (state.lastUsed[index] == m_frame) {
+		return false;
+	}
+	state.lastUsed[index] = m_frame;
+
+	if (state.mapped[index / 64] & (1ull << (index % 64))) {
+		outUsedMapped.push_back({ mip, x, y, z });
+	}
+	else {
+		outWork.requests.push_back({ mip, x, y, z });
+	}
+	return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "TilingInfo.h"
+
+enum class FeedbackFormat : uint32_t {
+	// One bit per tile of every standard mip in turn, x fastest, then y,
+	// then z, packed LSB first into 32-bit words. Each mip starts on a new
+	// word. Shaders set bits with InterlockedOr.
+	TileBitmask = 0,
+
+	// One byte per mip 0 tile, x fastest: the finest mip sampled over that
+	// tile, or 0xFF where nothing was. As with a sampler feedback MinMip
+	// map, mip m being sampled means mips m and coarser are in use there.
+	MinMipGrid = 1
+};
+
+struct FeedbackTile {
+	uint32_t subresource;
+	uint32_t x, y, z;
+};
+
+struct FeedbackWork {
+	// Sampled but not mapped, coarser mips first
+	std::vector<FeedbackTile> requests;
+
+	// Mapped but not sampled for at least idleFrames, longest idle first
+	std::vector<FeedbackTile> evictionCandidates;
+};
+
+// Turns one frame's usage buffer, read back from the GPU, into tile requests
+// and eviction candidates. Keeps a last-sampled frame per tile so tiles that
+// stay mapped while occluded show up as idle. The packed tail is mapped as a
+// unit and never reported.
+class UsageFeedback {
+public:
+	explicit UsageFeedback(const ResourceTilingInfo& tilingInfo);
+
+	// Buffer size in bytes Process expects for format
+	size_t GetBufferSize(FeedbackFormat format) const;
+
+	// mappedTiles lists the resource's mapped tiles; packed tail tiles in it
+	// are ignored. Sampled tiles that are mapped are appended to
+	// outUsedMapped, once each. A tile mapped without ever being sampled
+	// counts as sampled when first seen mapped, so fresh uploads get
+	// idleFrames to show up in the feedback. Returns false if size does not
+	// match the format.
+	bool Process(
+		FeedbackFormat format,
+		const void* data,
+		size_t size,
+		const std::vector<FeedbackTile>& mappedTiles,
+		uint32_t idleFrames,
+		std::vector<FeedbackTile>& outUsedMapped,
+		FeedbackWork& outWork
+	);
+
+private:
+	static constexpr uint32_t NEVER = 0;
+
+	struct MipState {
+		uint32_t tileCounts[3];
+		size_t tileCount;
+		size_t firstWord;                 // Offset of this mip in a TileBitmask buffer
+		std::vector<uint32_t> lastUsed;   // Frame each tile was last sampled
+		std::vector<uint64_t> mapped;     // Bit per tile, rebuilt every Process
+	};
+
+	void DecodeBitmask(const uint32_t* words, std::vector<FeedbackTile>& outUsedMapped, FeedbackWork& outWork);
+	void DecodeMinMipGrid(const uint8_t* cells, std::vector<FeedbackTile>& outUsedMapped, FeedbackWork& outWork);
+
+	// Stamps the tile as sampled this frame and reports it. Returns false if
+	// it was already stamped this frame.
+	bool MarkUsed(uint32_t mip, uint32_t x, uint32_t y, uint32_t z, size_t index,
+		std::vector<FeedbackTile>& outUsedMapped, FeedbackWork& outWork);
+
+	std::vector<MipState> m_mips;
+	size_t m_bitmaskWords = 0;
+	uint32_t m_frame = NEVER;
+
+	std::mutex m_mutex;
+};
@@ -0,0 +1,87 @@
+#include "pch.h"
+#include "VolumeSet.h"
+#include "ReservedResource.h"
+#include <algorithm>
+#include <format>
+
+VolumeSet::VolumeSet(std::vector<std::shared_ptr<ReservedResource>> members)
+	: m_owners(std::move(members))
+{
+	for (const std::shared_ptr<ReservedResource>& member : m_owners) {
+		m_members.push_back(member.get());
+	}
+}
+
+std::unique_ptr<VolumeSet> VolumeSet::Create(std::vector<std::shared_ptr<ReservedResource>> members, std::string* outError)
+{
+	if (members.size() < 2) {
+		*outError = std::format("a set needs at least two volumes, got {}", members.size());
+		return nullptr;
+	}
+
+	const ReservedResource* primary = members.front().get();
+	const ResourceTilingInfo& primaryTiling = primary->GetTilingInfo();
+	for (size_t i = 1; i < members.size(); ++i) {
+		const ReservedResource* member = members[i].get();
+		if (std::find(members.begin(), members.begin() + i, members[i]) != members.begin() + i) {
+			*outError = std::format("volume {} is listed twice", i);
+			return nullptr;
+		}
+
+		if (member->width != primary->width || member->height != primary->height || member->depth != primary->depth) {
+			*outError = std::format(
+				"volume {} is {}x{}x{}, the first is {}x{}x{}",
+				i, member->width, member->height, member->depth,
+				primary->width, primary->height, primary->depth);
+			return nullptr;
+		}
+
+		const ResourceTilingInfo& tiling = member->GetTilingInfo();
+		if (tiling.NumStandardMips != primaryTiling.NumStandardMips) {
+			*outError = std::format(
+				"volume {} has {} standard mips, the first has {}",
+				i, tiling.NumStandardMips, primaryTiling.NumStandardMips);
+			return nullptr;
+		}
+		for (UINT sub = 0; sub < primaryTiling.NumStandardMips; ++sub) {
+			const SubresourceTilingInfo& a = primaryTiling.subresourceTilingInfo[sub];
+			const SubresourceTilingInfo& b = tiling.subresourceTilingInfo[sub];
+			if (a.WidthInTiles != b.WidthInTiles || a.HeightInTiles != b.HeightInTiles || a.DepthInTiles != b.DepthInTiles) {
+				*outError = std::format(
+					"volume {} mip {} is {}x{}x{} tiles, the first is {}x{}x{}; its format tiles differently",
+					i, sub, b.WidthInTiles, b.HeightInTiles, b.DepthInTiles,
+					a.WidthInTiles, a.HeightInTiles, a.DepthInTiles);
+				return nullptr;
+			}
+		}
+	}
+
+	return std::unique_ptr<VolumeSet>(new VolumeSet(std::move(members)));
+}
+
+bool VolumeSet::IsMapped(UINT subresource, UINT x, UINT y, UINT z) const
+{
+	return m_runs.find(GetTileKey(subresource, x, y, z)) != m_runs.end();
+}
+
+void VolumeSet::Register(UINT subresource, UINT x, UINT y, UINT z, UINT runStart)
+{
+	m_runs[GetTileKey(subresource, x, y, z)] = runStart;
+}
+
+void VolumeSet::UnregisterBox(
+	UINT subresource,
+	UINT startX, UINT startY, UINT startZ,
+	UINT boxWidth, UINT boxHeight, UINT boxDepth,
+	std::vector<UINT>& outRunStarts)
+{
+	for (UINT z = startZ; z < startZ + boxDepth; ++z)
+		for (UINT y = startY; y < startY + boxHeight; ++y)
+			for (UINT x = startX; x < startX + boxWidth; ++x) {
+				auto it = m_runs.find(GetTileKey(subresource, x, y, z));
+				if (it != m_runs.end()) {
+					outRunStarts.push_back(it->second);
+					m_runs.erase(it);
+				}
+			}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <d3d12.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ReservedResource;
+
+// Channel volumes (albedo, lighting, material, ...) over one tile grid that
+// are made resident in lockstep. A standard-mip coordinate is mapped in
+// every member or in none: each mapped coordinate owns one run of
+// MemberCount() consecutive heap tiles, member i's tile at the run start
+// plus i, and the set's table of runs is the record of what is resident.
+// Only the primary (first) member reports tiles to the residency manager,
+// so use, pins and eviction are decided once per coordinate for the set.
+//
+// Members need the same dimensions and tile grid; formats may differ when
+// their tiles cover the same texels (R8G8B8A8_UNORM with R32_FLOAT, say).
+// Packed mip tails stay per member. The set holds a reference to each
+// member, so a pinned set keeps its members alive. Not thread-safe; the
+// plugin only touches a set under its mapping lock.
+class VolumeSet {
+public:
+	// nullptr with outError set if there are fewer than two members, one
+	// repeats, or their dimensions or standard-mip tile grids differ
+	static std::unique_ptr<VolumeSet> Create(std::vector<std::shared_ptr<ReservedResource>> members, std::string* outError);
+
+	const std::vector<ReservedResource*>& GetMembers() const { return m_members; }
+	UINT MemberCount() const { return static_cast<UINT>(m_members.size()); }
+	ReservedResource* GetPrimary() const { return m_members.front(); }
+
+	bool IsMapped(UINT subresource, UINT x, UINT y, UINT z) const;
+
+	void Register(UINT subresource, UINT x, UINT y, UINT z, UINT runStart);
+
+	// Forgets every mapped coordinate in the box and appends its run start.
+	// Unmapped coordinates are skipped.
+	void UnregisterBox(
+		UINT subresource,
+		UINT startX, UINT startY, UINT startZ,
+		UINT boxWidth, UINT boxHeight, UINT boxDepth,
+		std::vector<UINT>& outRunStarts);
+
+	size_t MappedCount() const { return m_runs.size(); }
+
+	// Set handle, assigned when the plugin registers the set
+	UINT64 handle = 0;
+
+private:
+	explicit VolumeSet(std::vector<std::shared_ptr<ReservedResource>> members);
+
+	static UINT64 GetTileKey(UINT subresource, UINT x, UINT y, UINT z) {
+		return ((UINT64)subresource << 48) | ((UINT64)x << 32) | ((UINT64)y << 16) | z;
+	}
+
+	std::vector<std::shared_ptr<ReservedResource>> m_owners;
+	std::vector<ReservedResource*> m_members;
+	std::unordered_map<UINT64, UINT> m_runs;
+};
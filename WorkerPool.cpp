@@ -0,0 +1,101 @@
+#include "pch.h"
+
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(uint32_t workerCount)
+{
+	m_workers.reserve(workerCount);
+	for (uint32_t i = 0; i < workerCount; ++i) {
+		m_workers.emplace_back(&WorkerPool::WorkerLoop, this);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_workAvailable.notify_all();
+	for (std::thread& worker : m_workers) {
+		worker.join();
+	}
+}
+
+void WorkerPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& task)
+{
+	if (count == 0) {
+		return;
+	}
+	if (count == 1 || m_workers.empty()) {
+		for (uint32_t i = 0; i < count; ++i) {
+			task(i);
+		}
+		return;
+	}
+
+	auto job = std::make_shared<Job>();
+	job->task = &task;
+	job->count = count;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(job);
+	}
+	m_workAvailable.notify_all();
+
+	RunJob(*job);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_jobFinished.wait(lock, [&] {
+		return job->finished.load(std::memory_order_acquire) == job->count;
+	});
+
+	// Workers drop exhausted jobs lazily; make sure ours is gone before
+	// the task it points at goes out of scope
+	for (auto it = m_jobs.begin(); it != m_jobs.end(); ++it) {
+		if (*it == job) {
+			m_jobs.erase(it);
+			break;
+		}
+	}
+}
+
+void WorkerPool::WorkerLoop()
+{
+	for (;;) {
+		std::shared_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_workAvailable.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+			if (m_stopping) {
+				return;
+			}
+
+			job = m_jobs.front();
+			if (job->next.load(std::memory_order_relaxed) >= job->count) {
+				// Every index is claimed; the owner waits for the stragglers
+				m_jobs.pop_front();
+				continue;
+			}
+		}
+
+		RunJob(*job);
+	}
+}
+
+void WorkerPool::RunJob(Job& job)
+{
+	for (;;) {
+		const uint32_t index = job.next.fetch_add(1, std::memory_order_relaxed);
+		if (index >= job.count) {
+			return;
+		}
+
+		(*job.task)(index);
+
+		if (job.finished.fetch_add(1, std::memory_order_acq_rel) + 1 == job.count) {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_jobFinished.notify_all();
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for CPU-heavy staging work (block encoding).
+// Several upload threads may call ParallelFor at once; their jobs queue up
+// and each caller also works on its own job, so a busy pool never stalls a
+// caller completely.
+class WorkerPool {
+public:
+	explicit WorkerPool(uint32_t workerCount);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	// Runs task(i) for every i in [0, count) and returns once all have
+	// finished. task must not throw.
+	void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& task);
+
+	uint32_t WorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+
+private:
+	struct Job {
+		const std::function<void(uint32_t)>* task;
+		uint32_t count;
+		std::atomic<uint32_t> next{ 0 };
+		std::atomic<uint32_t> finished{ 0 };
+	};
+
+	void WorkerLoop();
+	void RunJob(Job& job);
+
+	std::vector<std::thread> m_workers;
+	std::deque<std::shared_ptr<Job>> m_jobs;
+	std::mutex m_mutex;
+	std::condition_variable m_workAvailable;
+	std::condition_variable m_jobFinished;
+	bool m_stopping = false;
+};
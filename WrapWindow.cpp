@@ -0,0 +1,109 @@
+#include "pch.h"
+#include "WrapWindow.h"
+#include <algorithm>
+
+namespace {
+	INT64 WrapCoordinate(INT64 value, INT64 extent)
+	{
+		INT64 wrapped = value % extent;
+		return wrapped < 0 ? wrapped + extent : wrapped;
+	}
+}
+
+WrapWindow::WrapWindow(UINT extentX, UINT extentY, UINT extentZ)
+	: m_extent{ extentX, extentY, extentZ }
+{
+}
+
+void WrapWindow::GetOffset(UINT outOffset[3]) const
+{
+	for (UINT a = 0; a < 3; ++a) {
+		outOffset[a] = static_cast<UINT>(WrapCoordinate(m_origin[a], m_extent[a]));
+	}
+}
+
+UINT WrapWindow::SplitInterval(UINT axis, const Interval& world, Interval outPieces[2], INT64 outWorldStarts[2]) const
+{
+	const INT64 extent = m_extent[axis];
+	const INT64 start = WrapCoordinate(world.start, extent);
+	const INT64 firstLength = (std::min)(world.length, extent - start);
+
+	outPieces[0] = { start, firstLength };
+	outWorldStarts[0] = world.start;
+	if (firstLength == world.length) {
+		return 1;
+	}
+
+	outPieces[1] = { 0, world.length - firstLength };
+	outWorldStarts[1] = world.start + firstLength;
+	return 2;
+}
+
+void WrapWindow::AppendBox(const Interval axes[3], std::vector<WrapBox>& outBoxes) const
+{
+	if (axes[0].length == 0 || axes[1].length == 0 || axes[2].length == 0) {
+		return;
+	}
+
+	Interval pieces[3][2];
+	INT64 worldStarts[3][2];
+	UINT pieceCounts[3];
+	for (UINT a = 0; a < 3; ++a) {
+		pieceCounts[a] = SplitInterval(a, axes[a], pieces[a], worldStarts[a]);
+	}
+
+	for (UINT k = 0; k < pieceCounts[2]; ++k)
+		for (UINT j = 0; j < pieceCounts[1]; ++j)
+			for (UINT i = 0; i < pieceCounts[0]; ++i) {
+				WrapBox box;
+				box.startX = static_cast<UINT>(pieces[0][i].start);
+				box.startY = static_cast<UINT>(pieces[1][j].start);
+				box.startZ = static_cast<UINT>(pieces[2][k].start);
+				box.width = static_cast<UINT>(pieces[0][i].length);
+				box.height = static_cast<UINT>(pieces[1][j].length);
+				box.depth = static_cast<UINT>(pieces[2][k].length);
+				box.worldX = worldStarts[0][i];
+				box.worldY = worldStarts[1][j];
+				box.worldZ = worldStarts[2][k];
+				outBoxes.push_back(box);
+			}
+}
+
+void WrapWindow::Scroll(INT64 dx, INT64 dy, INT64 dz, std::vector<WrapBox>& outEntering)
+{
+	const INT64 delta[3] = { dx, dy, dz };
+
+	// Per axis, the new window splits into the world tiles that were already
+	// in view and the ones entering
+	Interval window[3], staying[3], entering[3];
+	for (UINT a = 0; a < 3; ++a) {
+		const INT64 extent = m_extent[a];
+		const INT64 oldOrigin = m_origin[a];
+		const INT64 newOrigin = oldOrigin + delta[a];
+		window[a] = { newOrigin, extent };
+
+		if (delta[a] >= extent || delta[a] <= -extent) {
+			staying[a] = { newOrigin, 0 };
+			entering[a] = window[a];
+		}
+		else if (delta[a] >= 0) {
+			staying[a] = { newOrigin, extent - delta[a] };
+			entering[a] = { oldOrigin + extent, delta[a] };
+		}
+		else {
+			staying[a] = { oldOrigin, extent + delta[a] };
+			entering[a] = { newOrigin, -delta[a] };
+		}
+		m_origin[a] = newOrigin;
+	}
+
+	// Entering along x over the whole window, then along y over the x tiles
+	// that stayed, then along z over the x and y tiles that stayed, so no
+	// tile lands in two boxes
+	const Interval xSlab[3] = { entering[0], window[1], window[2] };
+	const Interval ySlab[3] = { staying[0], entering[1], window[2] };
+	const Interval zSlab[3] = { staying[0], staying[1], entering[2] };
+	AppendBox(xSlab, outEntering);
+	AppendBox(ySlab, outEntering);
+	AppendBox(zSlab, outEntering);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <d3d12.h>
+#include <vector>
+
+// A physical box of tiles entering the window, and the world tile
+// coordinate of its first tile. Payloads are laid out as for the world box,
+// which has the same shape.
+struct WrapBox {
+	UINT startX, startY, startZ;
+	UINT width, height, depth;
+	INT64 worldX, worldY, worldZ;
+};
+
+// Toroidal addressing for a volume that holds a window onto a larger world,
+// such as one level of a clipmap. World tile w lives at physical tile
+// w mod extent on each axis, so when the window moves, tiles that stay in
+// view keep their mappings and data; only tiles entering the window take
+// over the physical tiles of the ones that left. Shaders sample physical
+// coordinates frac(windowUVW + offset / size), with offset from GetOffset
+// scaled to texels. Not thread-safe; the plugin only touches a window under
+// its mapping lock.
+class WrapWindow {
+public:
+	// extent is the volume's size in tiles
+	WrapWindow(UINT extentX, UINT extentY, UINT extentZ);
+
+	// World tile coordinate of the window's first tile
+	INT64 OriginX() const { return m_origin[0]; }
+	INT64 OriginY() const { return m_origin[1]; }
+	INT64 OriginZ() const { return m_origin[2]; }
+
+	// Physical tile holding the window's first tile
+	void GetOffset(UINT outOffset[3]) const;
+
+	// Moves the window by whole tiles and appends the boxes of tiles that
+	// entered it. They sit exactly where the tiles that left were, so the
+	// boxes are both what to unmap and what to upload. The boxes never
+	// overlap; a move of a full extent or more on any axis replaces every
+	// tile.
+	void Scroll(INT64 dx, INT64 dy, INT64 dz, std::vector<WrapBox>& outEntering);
+
+	// Upper bound on the boxes a single Scroll appends
+	static constexpr UINT MAX_ENTERING_BOXES = 24;
+
+private:
+	struct Interval {
+		INT64 start;
+		INT64 length;
+	};
+
+	// Splits a world interval no longer than the extent into its physical
+	// pieces, at most two
+	UINT SplitInterval(UINT axis, const Interval& world, Interval outPieces[2], INT64 outWorldStarts[2]) const;
+
+	void AppendBox(const Interval axes[3], std::vector<WrapBox>& outBoxes) const;
+
+	UINT m_extent[3];
+	INT64 m_origin[3] = {};
+};